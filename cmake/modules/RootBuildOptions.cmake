@@ -128,6 +128,7 @@ ROOT_BUILD_OPTION(mathmore ON "Build the new libMathMore extended math library,
 ROOT_BUILD_OPTION(memory_termination OFF "Free internal ROOT memory before process termination (experimental, used for leak checking)")
 ROOT_BUILD_OPTION(memstat OFF "A memory statistics utility, helps to detect memory leaks")
 ROOT_BUILD_OPTION(minuit2 OFF "Build the new libMinuit2 minimizer library")
+ROOT_BUILD_OPTION(minuit2_blas OFF "Use external BLAS/LAPACK for the Minuit2 linear algebra, requires minuit2")
 ROOT_BUILD_OPTION(monalisa OFF "Monalisa monitoring support, requires libapmoncpp")
 ROOT_BUILD_OPTION(mysql ON "MySQL support, requires libmysqlclient")
 ROOT_BUILD_OPTION(odbc OFF "ODBC support, requires libiodbc or libodbc")
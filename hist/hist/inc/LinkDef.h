@@ -62,6 +62,9 @@
 #pragma link C++ class TH1S+;
 #pragma link C++ class TH1I+;
 #pragma link C++ class TH1K+;
+#pragma link C++ class TH1Comparator;
+#pragma link C++ class TH1Comparator::Result+;
+#pragma link C++ class TH1IncrementalMerger;
 #pragma link C++ class TH2-;
 #pragma link C++ class TH2C-;
 #pragma link C++ class TH2D-;
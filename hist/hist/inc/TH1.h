@@ -81,6 +81,7 @@ public:
    };
 
    friend class TH1Merger;
+   friend class TH1Comparator;
 
 protected:
     Int_t         fNcells;          ///< number of bins(1D), cells (2D) +U/Overflows
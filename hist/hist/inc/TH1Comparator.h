@@ -0,0 +1,74 @@
+// @(#)root/hist:$Id$
+
+/**********************************************************************
+ *                                                                    *
+ * Copyright (c) 2018  ROOT  Team, CERN/PH-SFT                        *
+ *                                                                    *
+ *                                                                    *
+ **********************************************************************/
+
+#ifndef ROOT_TH1Comparator
+#define ROOT_TH1Comparator
+
+#include "Rtypes.h"
+
+#include <map>
+#include <memory>
+#include <vector>
+
+class TH1;
+
+class TH1Comparator {
+
+public:
+
+   /// Tests to be performed in a comparison
+   enum ETest {
+      kChi2 = 1,        ///< TH1::Chi2Test
+      kKolmogorov = 2,  ///< TH1::KolmogorovTest
+      kAll = 3
+   };
+
+   /// Result of the comparison of a histogram with its reference
+   struct Result {
+      Double_t fChi2Prob = 0;    ///< p-value of the chi2 test
+      Double_t fChi2 = 0;        ///< chi2 value
+      Int_t    fNdf = 0;         ///< number of degrees of freedom of the chi2 test
+      Int_t    fIgood = 0;       ///< quality flag of the chi2 test (see TH1::Chi2TestX)
+      Double_t fKolmoProb = 0;   ///< probability of the Kolmogorov test
+      Double_t fKolmoDist = 0;   ///< maximum Kolmogorov distance
+      Int_t    fStatus = 0;      ///< 0 if successful, otherwise the ETest bits of the failed tests
+   };
+
+   TH1Comparator(Int_t tests = kAll, Option_t *chi2Option = "", Option_t *kolmoOption = "");
+   ~TH1Comparator();
+
+   Result Compare(const TH1 *h, const TH1 *ref);
+   std::vector<Result> Compare(const std::vector<const TH1 *> &hists, const std::vector<const TH1 *> &refs);
+   std::vector<Result> Compare(const std::vector<const TH1 *> &hists, const TH1 *ref);
+
+   void ClearCache(const TH1 *ref = nullptr);
+   UInt_t GetCacheSize() const { return fCache.size(); }
+
+   struct RefData;
+
+private:
+
+   TH1Comparator(const TH1Comparator &) = delete;
+   TH1Comparator &operator=(const TH1Comparator &) = delete;
+
+   const RefData *GetRefData(const TH1 *ref);
+   Result DoCompare(const TH1 *h, const RefData &ref) const;
+
+   Int_t  fTests;             ///< tests to be performed (ETest bits)
+   Int_t  fChi2Mode;          ///< chi2 comparison type: 0 automatic, 1 UU, 2 UW, 3 WW
+   Bool_t fChi2Norm;          ///< NORM option of the chi2 test
+   Bool_t fChi2Underflow;     ///< UF option of the chi2 test
+   Bool_t fChi2Overflow;      ///< OF option of the chi2 test
+   Bool_t fKolmoUnderflow;    ///< U option of the Kolmogorov test
+   Bool_t fKolmoOverflow;     ///< O option of the Kolmogorov test
+   Bool_t fKolmoNorm;         ///< N option of the Kolmogorov test
+   std::map<const TH1 *, std::unique_ptr<RefData>> fCache;   ///<! cached reference contents and cumulative distributions
+};
+
+#endif
@@ -0,0 +1,64 @@
+// @(#)root/hist:$Id$
+
+/**********************************************************************
+ *                                                                    *
+ * Copyright (c) 2018  ROOT  Team, CERN/PH-SFT                        *
+ *                                                                    *
+ *                                                                    *
+ **********************************************************************/
+
+#ifndef ROOT_TH1IncrementalMerger
+#define ROOT_TH1IncrementalMerger
+
+#include "Rtypes.h"
+
+#include <atomic>
+#include <memory>
+#include <mutex>
+
+class TH1;
+
+class TH1IncrementalMerger {
+
+public:
+
+   TH1IncrementalMerger(const TH1 &model);
+   ~TH1IncrementalMerger();
+
+   Bool_t Add(const TH1 *delta);
+   TH1 *CreateSnapshot(const char *name = nullptr);
+   Bool_t Snapshot(TH1 &target);
+
+   Long64_t GetNDeltas() const { return fNDeltas.load(); }
+   const TH1 *GetModel() const { return fModel.get(); }
+
+private:
+
+   /// Bin contents and statistics accumulated by the producers between two snapshots
+   struct Buffer {
+      std::unique_ptr<std::atomic<Double_t>[]> fContent;   ///<! bin contents
+      std::unique_ptr<std::atomic<Double_t>[]> fSumw2;     ///<! sum of squared weights
+      std::unique_ptr<std::atomic<Double_t>[]> fStats;     ///<! statistics (see TH1::GetStats)
+      std::atomic<Double_t> fEntries;                      ///<! number of entries
+      std::atomic<Int_t> fActive;                          ///<! number of producers currently adding to the buffer
+   };
+
+   TH1IncrementalMerger(const TH1IncrementalMerger &) = delete;
+   TH1IncrementalMerger &operator=(const TH1IncrementalMerger &) = delete;
+
+   Bool_t IsCompatible(const TH1 &delta) const;
+   void Fold(Buffer &buffer);
+
+   std::unique_ptr<TH1> fModel;          ///<! empty histogram defining the binning
+   Int_t fNcells;                        ///<! number of cells of the histograms
+   Buffer fBuffers[2];                   ///<! buffers alternatively filled by the producers
+   std::atomic<Int_t> fCurrent;          ///<! index of the buffer currently filled by the producers
+   std::atomic<Long64_t> fNDeltas;       ///<! number of merged deltas
+   std::unique_ptr<Double_t[]> fContent; ///<! accumulated bin contents
+   std::unique_ptr<Double_t[]> fSumw2;   ///<! accumulated sum of squared weights
+   std::unique_ptr<Double_t[]> fStats;   ///<! accumulated statistics (see TH1::GetStats)
+   Double_t fEntries;                    ///<! accumulated number of entries
+   std::mutex fSnapshotMutex;            ///<! serializes the snapshots
+};
+
+#endif
@@ -191,6 +191,24 @@ void FillData(BinData & dv, const TH1 * hfit, TF1 * func)
    const TAxis *yaxis  = hfit->GetYaxis();
    const TAxis *zaxis  = hfit->GetZaxis();
 
+   // compute once the bin coordinates (centers or edges) of the inner axes,
+   // instead of recomputing them for each bin of the outer loops
+   auto binCoordinates = [&](const TAxis * axis, int first, int last, std::vector<double> & low, std::vector<double> & up) {
+      low.resize(last-first+1);
+      if (useBinEdges) up.resize(last-first+1);
+      for (int ibin = first; ibin <= last; ++ibin) {
+         if (useBinEdges) {
+            low[ibin-first] = axis->GetBinLowEdge(ibin);
+            up[ibin-first] = axis->GetBinUpEdge(ibin);
+         }
+         else
+            low[ibin-first] = axis->GetBinCenter(ibin);
+      }
+   };
+   std::vector<double> ylow, yup, zlow, zup;
+   binCoordinates(yaxis, hyfirst, hylast, ylow, yup);
+   binCoordinates(zaxis, hzfirst, hzlast, zlow, zup);
+
    for ( binx = hxfirst; binx <= hxlast; ++binx) {
       if (useBinEdges) {
          x[0] = xaxis->GetBinLowEdge(binx);
@@ -201,20 +219,12 @@ void FillData(BinData & dv, const TH1 * hfit, TF1 * func)
 
 
       for ( biny = hyfirst; biny <= hylast; ++biny) {
-         if (useBinEdges) {
-            x[1] = yaxis->GetBinLowEdge(biny);
-            s[1] = yaxis->GetBinUpEdge(biny);
-         }
-         else
-            x[1] = yaxis->GetBinCenter(biny);
+         x[1] = ylow[biny-hyfirst];
+         if (useBinEdges) s[1] = yup[biny-hyfirst];
 
          for ( binz = hzfirst; binz <= hzlast; ++binz) {
-            if (useBinEdges) {
-               x[2] = zaxis->GetBinLowEdge(binz);
-               s[2] = zaxis->GetBinUpEdge(binz);
-            }
-            else
-               x[2] = zaxis->GetBinCenter(binz);
+            x[2] = zlow[binz-hzfirst];
+            if (useBinEdges) s[2] = zup[binz-hzfirst];
 
             // need to evaluate function to know about rejected points
             // hugly but no other solutions
@@ -225,8 +235,9 @@ void FillData(BinData & dv, const TH1 * hfit, TF1 * func)
             }
 
 
-            double value =  hfit->GetBinContent(binx, biny, binz);
-            double error =  hfit->GetBinError(binx, biny, binz);
+            int bin = hfit->GetBin(binx, biny, binz);
+            double value =  hfit->GetBinContent(bin);
+            double error =  hfit->GetBinError(bin);
             if (!HFitInterface::AdjustError(fitOpt,error,value) ) continue;
 
             if (ndim == hdim -1) {
@@ -0,0 +1,536 @@
+// @(#)root/hist:$Id$
+
+/**********************************************************************
+ *                                                                    *
+ * Copyright (c) 2018  ROOT  Team, CERN/PH-SFT                        *
+ *                                                                    *
+ *                                                                    *
+ **********************************************************************/
+
+#include "TH1Comparator.h"
+#include "TH1.h"
+#include "TMath.h"
+#include "TString.h"
+#include "TError.h"
+
+#ifdef R__USE_IMT
+#include "ROOT/TThreadExecutor.hxx"
+#include "TROOT.h"
+#endif
+
+/** \class TH1Comparator
+    \ingroup Hist
+Compare many histograms with their references using the chi2 and/or the Kolmogorov test.
+
+The results are the same as those returned by `h->Chi2TestX(ref, ...)` and
+`h->KolmogorovTest(ref, ...)` for each histogram `h` and reference `ref`, but:
+  - the contents, the statistics and the normalized cumulative distributions of the
+    references are computed only once and cached, so that a reference can be compared
+    with many histograms (or many times, e.g. in an online monitoring cycle) at the cost
+    of a single pass on the bins of the compared histogram;
+  - the comparisons of a batch are run in parallel when implicit multi-threading is
+    enabled (see ROOT::EnableImplicitMT);
+  - nothing is printed: the failures and the quality flags are reported in the returned
+    TH1Comparator::Result structures.
+
+The chi2 options are those of TH1::Chi2Test ("UU", "UW", "WW", "NORM", "UF", "OF"),
+the Kolmogorov options are "U", "O" and "N" (see TH1::KolmogorovTest).
+The Kolmogorov test is performed only for 1-D histograms. As for TH1::Chi2Test, the axis
+ranges of the compared histogram (not of the reference) define the bins used in the chi2 test.
+
+The references are identified by their address: if a reference is modified or deleted,
+ClearCache(ref) must be called before using it again.
+
+Example:
+~~~ {.cpp}
+   TH1Comparator comp(TH1Comparator::kAll, "UU");
+   auto results = comp.Compare(hists, refs);
+   for (auto & r : results)
+      if (r.fStatus == 0 && r.fKolmoProb < 0.01) { ... }
+~~~
+*/
+
+struct TH1Comparator::RefData {
+   Int_t fDim = 0;
+   Int_t fNbinsX = 0;
+   Int_t fNbinsY = 0;
+   Int_t fNbinsZ = 0;
+   std::vector<Double_t> fContent;   ///< bin contents (all cells)
+   std::vector<Double_t> fErrorSq;   ///< squared bin errors (all cells)
+   Double_t fSumw = 0;               ///< sum of weights (from GetStats)
+   Double_t fSumw2 = 0;              ///< sum of squared weights (from GetStats)
+   std::vector<Double_t> fEdges;     ///< low edges of the x bins, for the Kolmogorov test
+   std::vector<Double_t> fCumul;     ///< normalized cumulative distribution for the Kolmogorov test
+   Double_t fKolmoSum = 0;           ///< sum of the bin contents used in the Kolmogorov test
+   Double_t fKolmoSumErrSq = 0;      ///< sum of the squared bin errors used in the Kolmogorov test
+};
+
+namespace {
+
+////////////////////////////////////////////////////////////////////////////////
+/// Chi2 test kernel on the given bins, see TH1::Chi2TestX.
+/// Mode is 1 for UU, 2 for UW and 3 for WW comparisons.
+/// Return kFALSE if the test cannot be performed.
+
+Bool_t Chi2Kernel(Int_t mode, Bool_t scaledHistogram, const std::vector<Int_t> &bins,
+                  const Double_t *content1, const Double_t *errorSq1,
+                  const Double_t *content2, const Double_t *errorSq2,
+                  Double_t &chi2, Int_t &ndf, Int_t &igood)
+{
+   const Bool_t comparisonUU = (mode == 1);
+   const Bool_t comparisonUW = (mode == 2);
+   const Bool_t comparisonWW = (mode == 3);
+   scaledHistogram &= comparisonUU;
+
+   Double_t sum1 = 0.0, sumw1 = 0.0;
+   Double_t sum2 = 0.0, sumw2 = 0.0;
+
+   chi2 = 0.0;
+   ndf = bins.size() - 1;
+
+   // get number of events in histogram
+   if (scaledHistogram) {
+      for (auto bin : bins) {
+         Double_t cnt1 = content1[bin];
+         Double_t cnt2 = content2[bin];
+         Double_t e1sq = errorSq1[bin];
+         Double_t e2sq = errorSq2[bin];
+
+         cnt1 = (e1sq > 0.0) ? TMath::Floor(cnt1 * cnt1 / e1sq + 0.5) : 0.0;
+         cnt2 = (e2sq > 0.0) ? TMath::Floor(cnt2 * cnt2 / e2sq + 0.5) : 0.0;
+
+         sum1 += cnt1;
+         sum2 += cnt2;
+         sumw1 += e1sq;
+         sumw2 += e2sq;
+      }
+      if (sumw1 <= 0.0 || sumw2 <= 0.0) return kFALSE;
+   } else {
+      for (auto bin : bins) {
+         sum1 += content1[bin];
+         sum2 += content2[bin];
+         if (comparisonWW) sumw1 += errorSq1[bin];
+         if (comparisonUW || comparisonWW) sumw2 += errorSq2[bin];
+      }
+   }
+   if (sum1 == 0.0 || sum2 == 0.0) return kFALSE;
+   if (comparisonWW && (sumw1 <= 0.0 && sumw2 <= 0.0)) return kFALSE;
+
+   Int_t m = 0, n = 0;
+
+   // experiment - experiment comparison
+   if (comparisonUU) {
+      for (auto bin : bins) {
+         Double_t cnt1 = content1[bin];
+         Double_t cnt2 = content2[bin];
+
+         if (scaledHistogram) {
+            // scale bin value to effective bin entries
+            Double_t e1sq = errorSq1[bin];
+            Double_t e2sq = errorSq2[bin];
+            cnt1 = (e1sq > 0) ? TMath::Floor(cnt1 * cnt1 / e1sq + 0.5) : 0;
+            cnt2 = (e2sq > 0) ? TMath::Floor(cnt2 * cnt2 / e2sq + 0.5) : 0;
+         }
+
+         if (Int_t(cnt1) == 0 && Int_t(cnt2) == 0) {
+            --ndf; // no data means one degree of freedom less
+            continue;
+         }
+         if (cnt1 < 1) ++m;
+         if (cnt2 < 1) ++n;
+
+         Double_t delta = sum2 * cnt1 - sum1 * cnt2;
+         chi2 += delta * delta / (cnt1 + cnt2);
+      }
+      chi2 /= sum1 * sum2;
+   }
+
+   // unweighted - weighted comparison
+   if (comparisonUW) {
+      for (auto bin : bins) {
+         Double_t cnt1 = content1[bin];
+         Double_t cnt2 = content2[bin];
+         Double_t e2sq = errorSq2[bin];
+
+         // case both histogram have zero bin contents
+         if (cnt1 * cnt1 == 0 && cnt2 * cnt2 == 0) {
+            --ndf;
+            continue;
+         }
+
+         // case weighted histogram has zero bin content and error
+         if (cnt2 * cnt2 == 0 && e2sq == 0) {
+            // infinite discrepancy if the histogram has all errors zero
+            if (sumw2 <= 0) return kFALSE;
+            e2sq = sumw2 / sum2;
+         }
+
+         if (cnt1 < 1) m++;
+         if (e2sq > 0 && cnt2 * cnt2 / e2sq < 10) n++;
+
+         Double_t var1 = sum2 * cnt2 - sum1 * e2sq;
+         Double_t var2 = var1 * var1 + 4. * sum2 * sum2 * cnt1 * e2sq;
+
+         // same approximation as in TH1::Chi2TestX when var1 and var2 vanish
+         while (var1 * var1 + cnt1 == 0 || var1 + var2 == 0) {
+            sum1++;
+            cnt1++;
+            var1 = sum2 * cnt2 - sum1 * e2sq;
+            var2 = var1 * var1 + 4. * sum2 * sum2 * cnt1 * e2sq;
+         }
+         var2 = TMath::Sqrt(var2);
+
+         while (var1 + var2 == 0) {
+            sum1++;
+            cnt1++;
+            var1 = sum2 * cnt2 - sum1 * e2sq;
+            var2 = var1 * var1 + 4. * sum2 * sum2 * cnt1 * e2sq;
+            while (var1 * var1 + cnt1 == 0 || var1 + var2 == 0) {
+               sum1++;
+               cnt1++;
+               var1 = sum2 * cnt2 - sum1 * e2sq;
+               var2 = var1 * var1 + 4. * sum2 * sum2 * cnt1 * e2sq;
+            }
+            var2 = TMath::Sqrt(var2);
+         }
+
+         Double_t probb = (var1 + var2) / (2. * sum2 * sum2);
+
+         Double_t nexp1 = probb * sum1;
+         Double_t nexp2 = probb * sum2;
+
+         Double_t delta1 = cnt1 - nexp1;
+         Double_t delta2 = cnt2 - nexp2;
+
+         chi2 += delta1 * delta1 / nexp1;
+         if (e2sq > 0) chi2 += delta2 * delta2 / e2sq;
+      }
+   }
+
+   // weighted - weighted comparison
+   if (comparisonWW) {
+      for (auto bin : bins) {
+         Double_t cnt1 = content1[bin];
+         Double_t cnt2 = content2[bin];
+         Double_t e1sq = errorSq1[bin];
+         Double_t e2sq = errorSq2[bin];
+
+         if (cnt1 * cnt1 == 0 && cnt2 * cnt2 == 0) {
+            --ndf;
+            continue;
+         }
+         // cannot treat case of both histograms having zero errors
+         if (e1sq == 0 && e2sq == 0) return kFALSE;
+
+         Double_t sigma = sum1 * sum1 * e2sq + sum2 * sum2 * e1sq;
+         Double_t delta = sum2 * cnt1 - sum1 * cnt2;
+         chi2 += delta * delta / sigma;
+
+         if (e1sq > 0 && cnt1 * cnt1 / e1sq < 10) m++;
+         if (e2sq > 0 && cnt2 * cnt2 / e2sq < 10) n++;
+      }
+   }
+
+   if (m) igood += 1;
+   if (n) igood += 2;
+   return kTRUE;
+}
+
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// Constructor from the tests to perform (TH1Comparator::ETest bits) and the
+/// options of the chi2 and of the Kolmogorov tests.
+
+TH1Comparator::TH1Comparator(Int_t tests, Option_t *chi2Option, Option_t *kolmoOption) : fTests(tests), fChi2Mode(0)
+{
+   TString opt = chi2Option;
+   opt.ToUpper();
+   if (opt.Contains("UU")) fChi2Mode = 1;
+   else if (opt.Contains("UW")) fChi2Mode = 2;
+   else if (opt.Contains("WW")) fChi2Mode = 3;
+   fChi2Norm = opt.Contains("NORM");
+   fChi2Underflow = opt.Contains("UF");
+   fChi2Overflow = opt.Contains("OF");
+   if (fChi2Norm && fChi2Mode != 1)
+      Info("TH1Comparator", "NORM option should be used together with UU option. It is ignored");
+
+   opt = kolmoOption;
+   opt.ToUpper();
+   fKolmoUnderflow = opt.Contains("U");
+   fKolmoOverflow = opt.Contains("O");
+   fKolmoNorm = opt.Contains("N");
+   if (opt.Contains("X") || opt.Contains("M"))
+      Warning("TH1Comparator", "Kolmogorov options X and M are not supported and are ignored");
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// Destructor.
+
+TH1Comparator::~TH1Comparator() {}
+
+////////////////////////////////////////////////////////////////////////////////
+/// Remove the cached data of the given reference, or of all references if ref is null.
+
+void TH1Comparator::ClearCache(const TH1 *ref)
+{
+   if (ref) fCache.erase(ref);
+   else fCache.clear();
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// Return the cached data of a reference histogram, computing them if needed.
+
+const TH1Comparator::RefData *TH1Comparator::GetRefData(const TH1 *ref)
+{
+   auto itr = fCache.find(ref);
+   if (itr != fCache.end()) return itr->second.get();
+
+   if (ref->fBuffer) const_cast<TH1 *>(ref)->BufferEmpty();
+
+   std::unique_ptr<RefData> data(new RefData);
+   data->fDim = ref->GetDimension();
+   data->fNbinsX = ref->GetXaxis()->GetNbins();
+   data->fNbinsY = ref->GetYaxis()->GetNbins();
+   data->fNbinsZ = ref->GetZaxis()->GetNbins();
+
+   const Int_t ncells = ref->fNcells;
+   data->fContent.resize(ncells);
+   for (Int_t bin = 0; bin < ncells; ++bin) data->fContent[bin] = ref->RetrieveBinContent(bin);
+
+   if (fTests & kChi2) {
+      data->fErrorSq.resize(ncells);
+      for (Int_t bin = 0; bin < ncells; ++bin) data->fErrorSq[bin] = ref->GetBinErrorSqUnchecked(bin);
+      Double_t s[TH1::kNstat];
+      ref->GetStats(s);
+      data->fSumw = s[0];
+      data->fSumw2 = s[1];
+   }
+
+   if ((fTests & kKolmogorov) && data->fDim == 1) {
+      const TAxis *axis = ref->GetXaxis();
+      const Int_t ncx = data->fNbinsX;
+      data->fEdges.resize(ncx + 1);
+      for (Int_t i = 1; i <= ncx + 1; ++i) data->fEdges[i - 1] = axis->GetBinLowEdge(i);
+
+      const Int_t ifirst = fKolmoUnderflow ? 0 : 1;
+      const Int_t ilast = fKolmoOverflow ? ncx + 1 : ncx;
+      for (Int_t bin = ifirst; bin <= ilast; ++bin) {
+         Double_t ew = ref->GetBinError(bin);
+         data->fKolmoSum += data->fContent[bin];
+         data->fKolmoSumErrSq += ew * ew;
+      }
+      if (data->fKolmoSum != 0) {
+         const Double_t s = 1 / data->fKolmoSum;
+         Double_t rsum = 0;
+         data->fCumul.resize(ilast - ifirst + 1);
+         for (Int_t bin = ifirst; bin <= ilast; ++bin) {
+            rsum += s * data->fContent[bin];
+            data->fCumul[bin - ifirst] = rsum;
+         }
+      }
+   }
+
+   const RefData *result = data.get();
+   fCache[ref] = std::move(data);
+   return result;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// Compare a histogram with the cached data of its reference.
+
+TH1Comparator::Result TH1Comparator::DoCompare(const TH1 *h, const RefData &ref) const
+{
+   Result result;
+
+   const TAxis *xaxis = h->GetXaxis();
+   const TAxis *yaxis = h->GetYaxis();
+   const TAxis *zaxis = h->GetZaxis();
+   const Int_t dim = h->GetDimension();
+   if (dim != ref.fDim || xaxis->GetNbins() != ref.fNbinsX || yaxis->GetNbins() != ref.fNbinsY ||
+       zaxis->GetNbins() != ref.fNbinsZ || h->fNcells != Int_t(ref.fContent.size())) {
+      result.fStatus = fTests;
+      return result;
+   }
+
+   // read once the bin contents of the histogram
+   const Int_t ncells = h->fNcells;
+   std::vector<Double_t> content(ncells);
+   for (Int_t bin = 0; bin < ncells; ++bin) content[bin] = h->RetrieveBinContent(bin);
+
+   if (fTests & kChi2) {
+      std::vector<Double_t> errorSq(ncells);
+      for (Int_t bin = 0; bin < ncells; ++bin) errorSq[bin] = h->GetBinErrorSqUnchecked(bin);
+
+      // bins used in the test, in the same order as in TH1::Chi2TestX
+      Int_t i_start = 1, i_end = ref.fNbinsX;
+      Int_t j_start = 1, j_end = ref.fNbinsY;
+      Int_t k_start = 1, k_end = ref.fNbinsZ;
+      if (xaxis->TestBit(TAxis::kAxisRange)) {
+         i_start = xaxis->GetFirst();
+         i_end = xaxis->GetLast();
+      }
+      if (yaxis->TestBit(TAxis::kAxisRange)) {
+         j_start = yaxis->GetFirst();
+         j_end = yaxis->GetLast();
+      }
+      if (zaxis->TestBit(TAxis::kAxisRange)) {
+         k_start = zaxis->GetFirst();
+         k_end = zaxis->GetLast();
+      }
+      if (fChi2Overflow) {
+         if (dim == 3) k_end = ref.fNbinsZ + 1;
+         if (dim >= 2) j_end = ref.fNbinsY + 1;
+         i_end = ref.fNbinsX + 1;
+      }
+      if (fChi2Underflow) {
+         if (dim == 3) k_start = 0;
+         if (dim >= 2) j_start = 0;
+         i_start = 0;
+      }
+      std::vector<Int_t> bins;
+      bins.reserve((i_end - i_start + 1) * (j_end - j_start + 1) * (k_end - k_start + 1));
+      const Int_t nx = ref.fNbinsX + 2;
+      const Int_t ny = ref.fNbinsY + 2;
+      for (Int_t i = i_start; i <= i_end; ++i)
+         for (Int_t j = j_start; j <= j_end; ++j)
+            for (Int_t k = k_start; k <= k_end; ++k)
+               bins.push_back((dim == 1) ? i : ((dim == 2) ? i + nx * j : i + nx * (j + ny * k)));
+
+      Int_t mode = fChi2Mode;
+      if (mode == 0) {
+         // deduce automatically from type of histogram
+         Double_t s[TH1::kNstat];
+         h->GetStats(s);
+         Double_t effEntries1 = (s[1] ? s[0] * s[0] / s[1] : 0.0);
+         Double_t effEntries2 = (ref.fSumw2 ? ref.fSumw * ref.fSumw / ref.fSumw2 : 0.0);
+         if (TMath::Abs(s[0] - effEntries1) < 1)
+            mode = (TMath::Abs(ref.fSumw - effEntries2) < 1) ? 1 : 2;
+         else
+            mode = 3;
+      }
+
+      if (Chi2Kernel(mode, fChi2Norm, bins, content.data(), errorSq.data(), ref.fContent.data(),
+                     ref.fErrorSq.data(), result.fChi2, result.fNdf, result.fIgood)) {
+         result.fChi2Prob = TMath::Prob(result.fChi2, result.fNdf);
+      } else {
+         result.fChi2 = 0;
+         result.fStatus |= kChi2;
+      }
+   }
+
+   if (fTests & kKolmogorov) {
+      Bool_t ok = (dim == 1 && !ref.fCumul.empty());
+      const Int_t ncx = ref.fNbinsX;
+      for (Int_t i = 1; ok && i <= ncx + 1; ++i)
+         ok = TMath::AreEqualRel(xaxis->GetBinLowEdge(i), ref.fEdges[i - 1], 1.E-15);
+
+      const Int_t ifirst = fKolmoUnderflow ? 0 : 1;
+      const Int_t ilast = fKolmoOverflow ? ncx + 1 : ncx;
+      Double_t sum1 = 0, w1 = 0;
+      if (ok) {
+         for (Int_t bin = ifirst; bin <= ilast; ++bin) {
+            Double_t ew1 = h->GetBinError(bin);
+            sum1 += content[bin];
+            w1 += ew1 * ew1;
+         }
+         ok = (sum1 != 0);
+      }
+
+      // effective entries, a zero error is equivalent to a comparison with a function
+      const Double_t sum2 = ref.fKolmoSum;
+      const Double_t w2 = ref.fKolmoSumErrSq;
+      const Bool_t afunc1 = (w1 <= 0);
+      const Bool_t afunc2 = (w2 <= 0);
+      const Double_t esum1 = afunc1 ? 0 : sum1 * sum1 / w1;
+      const Double_t esum2 = afunc2 ? 0 : sum2 * sum2 / w2;
+      if (afunc1 && afunc2) ok = kFALSE;
+
+      if (ok) {
+         // largest difference between the cumulative distributions
+         const Double_t s1 = 1 / sum1;
+         Double_t dfmax = 0, rsum1 = 0;
+         for (Int_t bin = ifirst; bin <= ilast; ++bin) {
+            rsum1 += s1 * content[bin];
+            dfmax = TMath::Max(dfmax, TMath::Abs(rsum1 - ref.fCumul[bin - ifirst]));
+         }
+
+         Double_t z;
+         if (afunc1) z = dfmax * TMath::Sqrt(esum2);
+         else if (afunc2) z = dfmax * TMath::Sqrt(esum1);
+         else z = dfmax * TMath::Sqrt(esum1 * esum2 / (esum1 + esum2));
+
+         Double_t prob = TMath::KolmogorovProb(z);
+         if (fKolmoNorm && !(afunc1 || afunc2)) {
+            // combine probabilities for shape and normalization
+            Double_t d12 = esum1 - esum2;
+            Double_t prb2 = TMath::Prob(d12 * d12 / (esum1 + esum2), 1);
+            if (prob > 0 && prb2 > 0) prob *= prb2 * (1 - TMath::Log(prob * prb2));
+            else prob = 0;
+         }
+         result.fKolmoProb = prob;
+         result.fKolmoDist = dfmax;
+      } else {
+         result.fStatus |= kKolmogorov;
+      }
+   }
+
+   return result;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// Compare the histogram h with the reference ref.
+
+TH1Comparator::Result TH1Comparator::Compare(const TH1 *h, const TH1 *ref)
+{
+   return Compare(std::vector<const TH1 *>(1, h), std::vector<const TH1 *>(1, ref)).front();
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// Compare all the given histograms with the same reference.
+
+std::vector<TH1Comparator::Result> TH1Comparator::Compare(const std::vector<const TH1 *> &hists, const TH1 *ref)
+{
+   return Compare(hists, std::vector<const TH1 *>(hists.size(), ref));
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// Compare each histogram hists[i] with the reference refs[i].
+/// The comparisons are done in parallel when implicit multi-threading is enabled.
+/// The histograms must not be modified during the call.
+
+std::vector<TH1Comparator::Result>
+TH1Comparator::Compare(const std::vector<const TH1 *> &hists, const std::vector<const TH1 *> &refs)
+{
+   if (hists.size() != refs.size()) {
+      Error("Compare", "Different number of histograms (%d) and references (%d)", (Int_t)hists.size(),
+            (Int_t)refs.size());
+      return std::vector<Result>();
+   }
+
+   // prepare serially the reference data and the histogram buffers
+   const UInt_t n = hists.size();
+   std::vector<const RefData *> refData(n, nullptr);
+   for (UInt_t i = 0; i < n; ++i) {
+      if (!hists[i] || !refs[i]) continue;
+      if (hists[i]->fBuffer) const_cast<TH1 *>(hists[i])->BufferEmpty();
+      refData[i] = GetRefData(refs[i]);
+   }
+
+   std::vector<Result> results(n);
+   auto compare = [&](UInt_t i) {
+      if (refData[i]) results[i] = DoCompare(hists[i], *refData[i]);
+      else results[i].fStatus = fTests;
+   };
+
+#ifdef R__USE_IMT
+   if (n > 1 && ROOT::IsImplicitMTEnabled()) {
+      ROOT::TThreadExecutor pool;
+      pool.Foreach(compare, ROOT::TSeq<UInt_t>(0, n));
+      return results;
+   }
+#endif
+
+   for (UInt_t i = 0; i < n; ++i) compare(i);
+   return results;
+}
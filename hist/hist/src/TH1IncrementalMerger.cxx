@@ -0,0 +1,258 @@
+// @(#)root/hist:$Id$
+
+/**********************************************************************
+ *                                                                    *
+ * Copyright (c) 2018  ROOT  Team, CERN/PH-SFT                        *
+ *                                                                    *
+ *                                                                    *
+ **********************************************************************/
+
+#include "TH1IncrementalMerger.h"
+#include "TH1.h"
+#include "TH2Poly.h"
+#include "TProfile.h"
+#include "TProfile2D.h"
+#include "TProfile3D.h"
+#include "TMath.h"
+#include "TError.h"
+
+#include <thread>
+
+/** \class TH1IncrementalMerger
+    \ingroup Hist
+Merge incrementally and concurrently histogram deltas sent by many producers.
+
+The merger keeps the accumulated histogram resident: each call to Add() adds the non-empty
+bins of a delta histogram (e.g. the histogram filled by a producer since its last update)
+to the accumulated contents, without creating temporary histograms and with a single
+compatibility check of the axes. Add() can be called concurrently from any number of
+threads: the bins are updated with atomic operations and the producers never wait for
+each other.
+
+The accumulated histogram is made available with Snapshot() and CreateSnapshot().
+The producers add to one of two buffers: a snapshot switches the producers to the other
+buffer, waits for the producers still adding to the first one, and folds it into the
+accumulated contents. Each delta is therefore either entirely contained in a snapshot
+or not at all, and the producers are never stopped.
+
+To publish the merged histogram with THttpServer, register the histogram returned by
+CreateSnapshot() and refresh it with Snapshot() in the thread processing the requests:
+~~~ {.cpp}
+   TH1IncrementalMerger merger(model);
+   std::unique_ptr<TH1> h(merger.CreateSnapshot("merged"));
+   serv->Register("/merged", h.get());
+   // producer threads call merger.Add(delta);
+   while (!gSystem->ProcessEvents()) {
+      merger.Snapshot(*h);
+      serv->ProcessRequests();
+   }
+~~~
+
+Profiles, TH2Poly and histograms with alphanumeric labels are not supported:
+use TH1::Merge for them.
+*/
+
+namespace {
+
+inline void AtomicAdd(std::atomic<Double_t> &x, Double_t value)
+{
+   Double_t old = x.load(std::memory_order_relaxed);
+   while (!x.compare_exchange_weak(old, old + value, std::memory_order_relaxed)) {
+   }
+}
+
+Bool_t SameAxis(const TAxis &a1, const TAxis &a2)
+{
+   if (a1.GetNbins() != a2.GetNbins()) return kFALSE;
+   if (!TMath::AreEqualRel(a1.GetXmin(), a2.GetXmin(), 1.E-12) ||
+       !TMath::AreEqualRel(a1.GetXmax(), a2.GetXmax(), 1.E-12))
+      return kFALSE;
+   if (a1.GetLabels() || a2.GetLabels()) return kFALSE;
+   const TArrayD *bins1 = a1.GetXbins();
+   const TArrayD *bins2 = a2.GetXbins();
+   if (bins1->fN == 0 && bins2->fN == 0) return kTRUE;
+   for (Int_t i = 1; i <= a1.GetNbins() + 1; ++i) {
+      if (!TMath::AreEqualRel(a1.GetBinLowEdge(i), a2.GetBinLowEdge(i), 1.E-12)) return kFALSE;
+   }
+   return kTRUE;
+}
+
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// Constructor from a model histogram defining the binning of the merged histogram.
+/// The contents of the model are not used.
+
+TH1IncrementalMerger::TH1IncrementalMerger(const TH1 &model) : fNcells(0), fCurrent(0), fNDeltas(0), fEntries(0)
+{
+   if (model.InheritsFrom(TProfile::Class()) || model.InheritsFrom(TProfile2D::Class()) ||
+       model.InheritsFrom(TProfile3D::Class()) || model.InheritsFrom(TH2Poly::Class())) {
+      Error("TH1IncrementalMerger", "Histograms of type %s are not supported", model.ClassName());
+      return;
+   }
+   if (model.GetXaxis()->GetLabels() || model.GetYaxis()->GetLabels() || model.GetZaxis()->GetLabels()) {
+      Error("TH1IncrementalMerger", "Histograms with alphanumeric labels are not supported");
+      return;
+   }
+
+   fModel.reset((TH1 *)model.Clone());
+   fModel->SetDirectory(nullptr);
+   fModel->Reset();
+   fNcells = fModel->GetNcells();
+
+   fContent.reset(new Double_t[fNcells]());
+   fSumw2.reset(new Double_t[fNcells]());
+   fStats.reset(new Double_t[TH1::kNstat]());
+   for (auto &buffer : fBuffers) {
+      buffer.fContent.reset(new std::atomic<Double_t>[fNcells]);
+      buffer.fSumw2.reset(new std::atomic<Double_t>[fNcells]);
+      buffer.fStats.reset(new std::atomic<Double_t>[TH1::kNstat]);
+      for (Int_t bin = 0; bin < fNcells; ++bin) {
+         buffer.fContent[bin].store(0);
+         buffer.fSumw2[bin].store(0);
+      }
+      for (Int_t i = 0; i < TH1::kNstat; ++i) buffer.fStats[i].store(0);
+      buffer.fEntries.store(0);
+      buffer.fActive.store(0);
+   }
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// Destructor. No producer must be adding deltas.
+
+TH1IncrementalMerger::~TH1IncrementalMerger() {}
+
+////////////////////////////////////////////////////////////////////////////////
+/// Check that the histogram has the same type of binning as the model.
+
+Bool_t TH1IncrementalMerger::IsCompatible(const TH1 &h) const
+{
+   if (!fModel || h.GetDimension() != fModel->GetDimension() || h.GetNcells() != fNcells) return kFALSE;
+   if (h.InheritsFrom(TProfile::Class()) || h.InheritsFrom(TProfile2D::Class()) ||
+       h.InheritsFrom(TProfile3D::Class()))
+      return kFALSE;
+   return SameAxis(*h.GetXaxis(), *fModel->GetXaxis()) && SameAxis(*h.GetYaxis(), *fModel->GetYaxis()) &&
+          SameAxis(*h.GetZaxis(), *fModel->GetZaxis());
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// Add the content of the delta histogram to the merged histogram.
+/// Only the non-empty bins of the delta are used. This function can be called
+/// concurrently by different threads, the delta must not be modified during the call.
+/// Return kFALSE if the delta is not compatible with the model histogram.
+
+Bool_t TH1IncrementalMerger::Add(const TH1 *delta)
+{
+   if (!delta || !IsCompatible(*delta)) {
+      Error("Add", "Histogram %s is not compatible with the merged histogram", delta ? delta->GetName() : "");
+      return kFALSE;
+   }
+   if (delta->GetBuffer()) const_cast<TH1 *>(delta)->BufferEmpty();
+
+   Double_t stats[TH1::kNstat] = {0};
+   delta->GetStats(stats);
+
+   // direct access to the bin contents when the histogram stores them as double
+   const TArrayD *array = dynamic_cast<const TArrayD *>(delta);
+   const Double_t *content = array ? array->GetArray() : nullptr;
+   const Double_t *sumw2 = delta->GetSumw2N() ? delta->GetSumw2()->GetArray() : nullptr;
+
+   // register as producer of the current buffer, retrying if a snapshot switches the buffers in between
+   Buffer *buffer = nullptr;
+   while (true) {
+      Int_t current = fCurrent.load();
+      buffer = &fBuffers[current];
+      ++buffer->fActive;
+      if (fCurrent.load() == current) break;
+      --buffer->fActive;
+   }
+
+   for (Int_t bin = 0; bin < fNcells; ++bin) {
+      Double_t c = content ? content[bin] : delta->GetBinContent(bin);
+      Double_t e2 = sumw2 ? sumw2[bin] : c;
+      if (c == 0 && e2 == 0) continue;
+      AtomicAdd(buffer->fContent[bin], c);
+      AtomicAdd(buffer->fSumw2[bin], e2);
+   }
+   for (Int_t i = 0; i < TH1::kNstat; ++i) {
+      if (stats[i] != 0) AtomicAdd(buffer->fStats[i], stats[i]);
+   }
+   AtomicAdd(buffer->fEntries, delta->GetEntries());
+
+   --buffer->fActive;
+   ++fNDeltas;
+   return kTRUE;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// Add the content of a buffer to the accumulated contents and reset it.
+/// No producer must be using the buffer.
+
+void TH1IncrementalMerger::Fold(Buffer &buffer)
+{
+   for (Int_t bin = 0; bin < fNcells; ++bin) {
+      Double_t c = buffer.fContent[bin].load(std::memory_order_relaxed);
+      Double_t e2 = buffer.fSumw2[bin].load(std::memory_order_relaxed);
+      if (c == 0 && e2 == 0) continue;
+      fContent[bin] += c;
+      fSumw2[bin] += e2;
+      buffer.fContent[bin].store(0, std::memory_order_relaxed);
+      buffer.fSumw2[bin].store(0, std::memory_order_relaxed);
+   }
+   for (Int_t i = 0; i < TH1::kNstat; ++i) {
+      fStats[i] += buffer.fStats[i].load(std::memory_order_relaxed);
+      buffer.fStats[i].store(0, std::memory_order_relaxed);
+   }
+   fEntries += buffer.fEntries.load(std::memory_order_relaxed);
+   buffer.fEntries.store(0, std::memory_order_relaxed);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// Copy the merged histogram into target, which must have the same binning as
+/// the model histogram (e.g. a histogram created by CreateSnapshot).
+/// The producers can keep adding deltas during the call: the snapshot contains
+/// all the deltas whose Add call completed before this call.
+
+Bool_t TH1IncrementalMerger::Snapshot(TH1 &target)
+{
+   if (!IsCompatible(target)) {
+      Error("Snapshot", "Histogram %s is not compatible with the merged histogram", target.GetName());
+      return kFALSE;
+   }
+
+   std::lock_guard<std::mutex> lock(fSnapshotMutex);
+
+   // switch the producers to the other buffer and wait for the ones still using this one
+   Int_t current = fCurrent.load();
+   fCurrent.store(1 - current);
+   while (fBuffers[current].fActive.load() > 0) std::this_thread::yield();
+   Fold(fBuffers[current]);
+
+   if (target.GetSumw2N() == 0) target.Sumw2();
+   TArrayD *array = dynamic_cast<TArrayD *>(&target);
+   Double_t *sumw2 = target.GetSumw2()->GetArray();
+   for (Int_t bin = 0; bin < fNcells; ++bin) {
+      if (array) array->fArray[bin] = fContent[bin];
+      else target.SetBinContent(bin, fContent[bin]);
+      sumw2[bin] = fSumw2[bin];
+   }
+   target.PutStats(fStats.get());
+   target.SetEntries(fEntries);
+   return kTRUE;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// Create a new histogram with the content of the merged histogram.
+/// The histogram is not attached to any directory and is owned by the caller.
+
+TH1 *TH1IncrementalMerger::CreateSnapshot(const char *name)
+{
+   if (!fModel) return nullptr;
+   TH1 *h = (TH1 *)fModel->Clone(name);
+   h->SetDirectory(nullptr);
+   if (!Snapshot(*h)) {
+      delete h;
+      return nullptr;
+   }
+   return h;
+}
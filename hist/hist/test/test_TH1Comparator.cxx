@@ -0,0 +1,71 @@
+#include "gtest/gtest.h"
+
+#include "TH1Comparator.h"
+#include "TH1D.h"
+#include "TH2D.h"
+#include "TRandom3.h"
+
+#include <memory>
+#include <vector>
+
+// Compare the results of TH1Comparator with TH1::Chi2TestX and TH1::KolmogorovTest
+TEST(TH1Comparator, SameAsTH1Tests)
+{
+   TRandom3 rndm(4357);
+   TH1D ref("ref", "ref", 50, -3, 3);
+   for (int i = 0; i < 10000; ++i) ref.Fill(rndm.Gaus());
+
+   std::vector<std::unique_ptr<TH1D>> hists;
+   std::vector<const TH1 *> hptrs;
+   for (int ih = 0; ih < 20; ++ih) {
+      hists.emplace_back(new TH1D(TString::Format("h%d", ih), "h", 50, -3, 3));
+      for (int i = 0; i < 1000; ++i) hists.back()->Fill(rndm.Gaus(0.01 * ih, 1.));
+      hptrs.push_back(hists.back().get());
+   }
+
+   TH1Comparator comp(TH1Comparator::kAll, "UU", "N");
+   auto results = comp.Compare(hptrs, &ref);
+   ASSERT_EQ(hptrs.size(), results.size());
+   EXPECT_EQ(1u, comp.GetCacheSize());
+
+   for (unsigned int ih = 0; ih < hists.size(); ++ih) {
+      Double_t chi2 = 0;
+      Int_t ndf = 0, igood = 0;
+      Double_t prob = hists[ih]->Chi2TestX(&ref, chi2, ndf, igood, "UU");
+      EXPECT_EQ(0, results[ih].fStatus);
+      EXPECT_DOUBLE_EQ(prob, results[ih].fChi2Prob);
+      EXPECT_DOUBLE_EQ(chi2, results[ih].fChi2);
+      EXPECT_EQ(ndf, results[ih].fNdf);
+      EXPECT_EQ(igood, results[ih].fIgood);
+      EXPECT_DOUBLE_EQ(hists[ih]->KolmogorovTest(&ref, "N"), results[ih].fKolmoProb);
+      EXPECT_DOUBLE_EQ(hists[ih]->KolmogorovTest(&ref, "M"), results[ih].fKolmoDist);
+   }
+}
+
+// Weighted histograms and 2-D histograms (chi2 test only)
+TEST(TH1Comparator, WeightedAndMultiDim)
+{
+   TRandom3 rndm(4357);
+   TH2D ref("ref2", "ref", 20, -3, 3, 20, -3, 3);
+   TH2D h("h2", "h", 20, -3, 3, 20, -3, 3);
+   ref.Sumw2();
+   h.Sumw2();
+   for (int i = 0; i < 20000; ++i) ref.Fill(rndm.Gaus(), rndm.Gaus(), rndm.Uniform(0.5, 1.5));
+   for (int i = 0; i < 5000; ++i) h.Fill(rndm.Gaus(), rndm.Gaus(), rndm.Uniform(0.5, 1.5));
+
+   TH1Comparator comp(TH1Comparator::kAll, "WW");
+   auto result = comp.Compare(&h, &ref);
+
+   Double_t chi2 = 0;
+   Int_t ndf = 0, igood = 0;
+   Double_t prob = h.Chi2TestX(&ref, chi2, ndf, igood, "WW");
+   EXPECT_EQ(TH1Comparator::kKolmogorov, result.fStatus);
+   EXPECT_DOUBLE_EQ(prob, result.fChi2Prob);
+   EXPECT_DOUBLE_EQ(chi2, result.fChi2);
+   EXPECT_EQ(ndf, result.fNdf);
+
+   // incompatible binning
+   TH2D h3("h3", "h", 10, -3, 3, 20, -3, 3);
+   h3.Fill(0., 0.);
+   EXPECT_EQ(TH1Comparator::kAll, comp.Compare(&h3, &ref).fStatus);
+}
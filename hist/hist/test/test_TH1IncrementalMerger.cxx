@@ -0,0 +1,73 @@
+#include "gtest/gtest.h"
+
+#include "TH1IncrementalMerger.h"
+#include "TH1D.h"
+#include "TH2F.h"
+#include "TRandom3.h"
+
+#include <memory>
+#include <thread>
+#include <vector>
+
+// Deltas added concurrently give the same result as TH1::Add
+TEST(TH1IncrementalMerger, ConcurrentAdd)
+{
+   const int nproducers = 4;
+   const int ndeltas = 50;
+   TH1D model("model", "model", 100, -5, 5);
+   TH1IncrementalMerger merger(model);
+
+   std::vector<std::unique_ptr<TH1D>> deltas;
+   TRandom3 rndm(4357);
+   for (int i = 0; i < nproducers * ndeltas; ++i) {
+      deltas.emplace_back(new TH1D(TString::Format("d%d", i), "d", 100, -5, 5));
+      deltas.back()->SetDirectory(nullptr);
+      for (int j = 0; j < 100; ++j) deltas.back()->Fill(rndm.Gaus(), rndm.Uniform(0.5, 1.5));
+   }
+
+   std::unique_ptr<TH1> snapshot(merger.CreateSnapshot("snapshot"));
+   ASSERT_TRUE(snapshot != nullptr);
+
+   std::vector<std::thread> producers;
+   for (int ip = 0; ip < nproducers; ++ip) {
+      producers.emplace_back([&, ip]() {
+         for (int i = 0; i < ndeltas; ++i) EXPECT_TRUE(merger.Add(deltas[ip * ndeltas + i].get()));
+      });
+   }
+   // snapshots taken while the producers are running
+   for (int i = 0; i < 10; ++i) EXPECT_TRUE(merger.Snapshot(*snapshot));
+   for (auto &t : producers) t.join();
+
+   EXPECT_EQ(nproducers * ndeltas, merger.GetNDeltas());
+   EXPECT_TRUE(merger.Snapshot(*snapshot));
+
+   TH1D expected("expected", "expected", 100, -5, 5);
+   expected.SetDirectory(nullptr);
+   for (auto &d : deltas) expected.Add(d.get());
+
+   for (int bin = 0; bin <= 101; ++bin) {
+      EXPECT_NEAR(expected.GetBinContent(bin), snapshot->GetBinContent(bin), 1.E-9);
+      EXPECT_NEAR(expected.GetBinError(bin), snapshot->GetBinError(bin), 1.E-9);
+   }
+   EXPECT_NEAR(expected.GetEntries(), snapshot->GetEntries(), 1.E-6);
+   EXPECT_NEAR(expected.GetMean(), snapshot->GetMean(), 1.E-9);
+   EXPECT_NEAR(expected.GetStdDev(), snapshot->GetStdDev(), 1.E-9);
+}
+
+// Deltas with a different binning are rejected
+TEST(TH1IncrementalMerger, IncompatibleDelta)
+{
+   TH2F model("model2", "model", 10, 0, 1, 10, 0, 1);
+   TH1IncrementalMerger merger(model);
+
+   TH2F good("good", "good", 10, 0, 1, 10, 0, 1);
+   TH2F bad("bad", "bad", 10, 0, 2, 10, 0, 1);
+   good.Fill(0.5, 0.5);
+   bad.Fill(0.5, 0.5);
+   EXPECT_TRUE(merger.Add(&good));
+   EXPECT_FALSE(merger.Add(&bad));
+
+   std::unique_ptr<TH1> snapshot(merger.CreateSnapshot());
+   EXPECT_DOUBLE_EQ(1., snapshot->GetBinContent(snapshot->FindBin(0.5, 0.5)));
+   EXPECT_DOUBLE_EQ(1., snapshot->GetEntries());
+}
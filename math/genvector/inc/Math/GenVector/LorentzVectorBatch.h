@@ -0,0 +1,698 @@
+// @(#)root/mathcore:$Id$
+
+/**********************************************************************
+ *                                                                    *
+ * Copyright (c) 2018 , LCG ROOT MathLib Team                         *
+ *                                                                    *
+ *                                                                    *
+ **********************************************************************/
+
+// Header file for class LorentzVectorBatch, a structure of arrays of
+// Lorentz vectors, and for the vector utility functions operating on it
+//
+#ifndef ROOT_Math_GenVector_LorentzVectorBatch
+#define ROOT_Math_GenVector_LorentzVectorBatch  1
+
+#include "Math/GenVector/LorentzVector.h"
+
+#include "Math/GenVector/PxPyPzE4D.h"
+
+#include "Math/GenVector/PxPyPzM4D.h"
+
+#include "Math/GenVector/PtEtaPhiE4D.h"
+
+#include "Math/GenVector/PtEtaPhiM4D.h"
+
+#include "Math/GenVector/Boost.h"
+
+#include "Math/GenVector/LorentzRotation.h"
+
+#include "Math/GenVector/Rotation3D.h"
+
+#include "Math/GenVector/etaMax.h"
+
+#include "Math/GenVector/GenVector_exception.h"
+
+#include "Math/Types.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <type_traits>
+#include <vector>
+
+namespace ROOT {
+
+namespace Math {
+
+template <class CoordSystem>
+class LorentzVectorBatch;
+
+namespace Impl {
+
+/**
+   Building blocks of the operations on batches of Lorentz vectors.
+   The elements of the batches are processed by SIMD vectors of
+   ROOT::Double_v (ROOT::Float_v for float coordinates), which are those
+   of the VecCore backend ROOT was built with, and one by one for the
+   remaining elements.
+ */
+namespace Batch {
+
+template <class T>
+struct SIMDType;
+
+template <>
+struct SIMDType<double> {
+   typedef ROOT::Double_v Type;
+};
+
+template <>
+struct SIMDType<float> {
+   typedef ROOT::Float_v Type;
+};
+
+#ifdef R__HAS_VECCORE
+
+template <class V>
+inline std::size_t VectorSize() { return vecCore::VectorSize<V>(); }
+
+template <class V, class T>
+inline V Load(const T *p) { V v; vecCore::Load(v, p); return v; }
+
+template <class V, class T>
+inline void Store(const V &v, T *p) { vecCore::Store(v, p); }
+
+template <class V, class M>
+inline V Select(const M &mask, const V &a, const V &b) { return vecCore::Blend(mask, a, b); }
+
+using vecCore::math::Abs;
+using vecCore::math::ATan2;
+using vecCore::math::Cos;
+using vecCore::math::Exp;
+using vecCore::math::Floor;
+using vecCore::math::Log;
+using vecCore::math::Max;
+using vecCore::math::Sin;
+using vecCore::math::Sqrt;
+
+#else
+
+template <class V>
+inline std::size_t VectorSize() { return 1; }
+
+template <class V, class T>
+inline V Load(const T *p) { return *p; }
+
+template <class V, class T>
+inline void Store(const V &v, T *p) { *p = v; }
+
+template <class V>
+inline V Select(bool mask, const V &a, const V &b) { return mask ? a : b; }
+
+template <class T> inline T Abs(T x) { return std::abs(x); }
+template <class T> inline T ATan2(T y, T x) { return std::atan2(y, x); }
+template <class T> inline T Cos(T x) { return std::cos(x); }
+template <class T> inline T Exp(T x) { return std::exp(x); }
+template <class T> inline T Floor(T x) { return std::floor(x); }
+template <class T> inline T Log(T x) { return std::log(x); }
+template <class T> inline T Max(T x, T y) { return x > y ? x : y; }
+template <class T> inline T Sin(T x) { return std::sin(x); }
+template <class T> inline T Sqrt(T x) { return std::sqrt(x); }
+
+#endif
+
+/**
+   Call op.Apply<V>(i) for the SIMD vectors of elements starting at i,
+   then op.Apply<T>(i) for the remaining n % VectorSize elements
+ */
+template <class T, class Op>
+inline void Loop(std::size_t n, const Op &op)
+{
+   typedef typename SIMDType<T>::Type V;
+   const std::size_t vsize = VectorSize<V>();
+   std::size_t i = 0;
+   for (; i + vsize <= n; i += vsize)
+      op.template Apply<V>(i);
+   for (; i < n; ++i)
+      op.template Apply<T>(i);
+}
+
+/// pseudorapidity from rho and z, following Impl::Eta_FromRhoZ
+template <class T, class V>
+inline V EtaFromRhoZ(const V &rho, const V &z)
+{
+   const V zero(T(0));
+   const V zs = Abs(z / rho);
+   const V eta = Log(zs + Sqrt(zs * zs + V(T(1))));
+   const V maxEta(etaMax<T>());
+   return Select(rho > zero, Select(z < zero, -eta, eta),
+                 Select(z > zero, z + maxEta, Select(z < zero, z - maxEta, zero)));
+}
+
+/// z from pt and eta, following PtEtaPhiM4D::Pz
+template <class T, class V>
+inline V PzFromPtEta(const V &pt, const V &eta)
+{
+   const V zero(T(0));
+   const V expEta = Exp(eta);
+   const V pz = pt * V(T(0.5)) * (expEta - V(T(1)) / expEta);
+   const V maxEta(etaMax<T>());
+   return Select(pt > zero, pz, Select(eta > zero, eta - maxEta, Select(eta < zero, eta + maxEta, zero)));
+}
+
+/// energy from the square of the momentum and a mass, negative for space-like vectors
+template <class T, class V>
+inline V EFromP2M(const V &p2, const V &m)
+{
+   const V zero(T(0));
+   return Sqrt(Max(p2 + Select(m < zero, -m * m, m * m), zero));
+}
+
+/// signed mass, negative for space-like vectors, from the square of the mass
+template <class T, class V>
+inline V MFromM2(const V &m2)
+{
+   const V m = Sqrt(Abs(m2));
+   return Select(m2 < V(T(0)), -m, m);
+}
+
+/// azimuthal angle in [-pi, pi], 0 for vectors along z
+template <class T, class V>
+inline V PhiFromXY(const V &x, const V &y)
+{
+   const V zero(T(0));
+   return Select(x == zero && y == zero, zero, ATan2(y, x));
+}
+
+/// difference of two azimuthal angles, in [-pi, pi)
+template <class T, class V>
+inline V DeltaPhi(const V &phi1, const V &phi2)
+{
+   const V pi(T(M_PI));
+   const V twoPi(T(2 * M_PI));
+   const V dphi = phi2 - phi1;
+   return dphi - twoPi * Floor((dphi + pi) / twoPi);
+}
+
+// Load the elements i of a batch as Cartesian coordinates
+
+template <class V, class T>
+inline void LoadPxPyPzE(const LorentzVectorBatch<PxPyPzE4D<T> > &b, std::size_t i, V &x, V &y, V &z, V &e)
+{
+   x = Load<V>(b.Coordinate(0) + i);
+   y = Load<V>(b.Coordinate(1) + i);
+   z = Load<V>(b.Coordinate(2) + i);
+   e = Load<V>(b.Coordinate(3) + i);
+}
+
+template <class V, class T>
+inline void LoadPxPyPzE(const LorentzVectorBatch<PxPyPzM4D<T> > &b, std::size_t i, V &x, V &y, V &z, V &e)
+{
+   x = Load<V>(b.Coordinate(0) + i);
+   y = Load<V>(b.Coordinate(1) + i);
+   z = Load<V>(b.Coordinate(2) + i);
+   e = EFromP2M<T>(x * x + y * y + z * z, Load<V>(b.Coordinate(3) + i));
+}
+
+template <class V, class T>
+inline void LoadPxPyPzE(const LorentzVectorBatch<PtEtaPhiE4D<T> > &b, std::size_t i, V &x, V &y, V &z, V &e)
+{
+   const V pt = Load<V>(b.Coordinate(0) + i);
+   const V phi = Load<V>(b.Coordinate(2) + i);
+   x = pt * Cos(phi);
+   y = pt * Sin(phi);
+   z = PzFromPtEta<T>(pt, Load<V>(b.Coordinate(1) + i));
+   e = Load<V>(b.Coordinate(3) + i);
+}
+
+template <class V, class T>
+inline void LoadPxPyPzE(const LorentzVectorBatch<PtEtaPhiM4D<T> > &b, std::size_t i, V &x, V &y, V &z, V &e)
+{
+   const V pt = Load<V>(b.Coordinate(0) + i);
+   const V phi = Load<V>(b.Coordinate(2) + i);
+   x = pt * Cos(phi);
+   y = pt * Sin(phi);
+   z = PzFromPtEta<T>(pt, Load<V>(b.Coordinate(1) + i));
+   e = EFromP2M<T>(pt * pt + z * z, Load<V>(b.Coordinate(3) + i));
+}
+
+// Store Cartesian coordinates into the elements i of a batch
+
+template <class V, class T>
+inline void StorePxPyPzE(LorentzVectorBatch<PxPyPzE4D<T> > &b, std::size_t i, const V &x, const V &y, const V &z,
+                         const V &e)
+{
+   Store(x, b.Coordinate(0) + i);
+   Store(y, b.Coordinate(1) + i);
+   Store(z, b.Coordinate(2) + i);
+   Store(e, b.Coordinate(3) + i);
+}
+
+template <class V, class T>
+inline void StorePxPyPzE(LorentzVectorBatch<PxPyPzM4D<T> > &b, std::size_t i, const V &x, const V &y, const V &z,
+                         const V &e)
+{
+   Store(x, b.Coordinate(0) + i);
+   Store(y, b.Coordinate(1) + i);
+   Store(z, b.Coordinate(2) + i);
+   Store(MFromM2<T>(e * e - x * x - y * y - z * z), b.Coordinate(3) + i);
+}
+
+template <class V, class T>
+inline void StorePxPyPzE(LorentzVectorBatch<PtEtaPhiE4D<T> > &b, std::size_t i, const V &x, const V &y, const V &z,
+                         const V &e)
+{
+   const V pt = Sqrt(x * x + y * y);
+   Store(pt, b.Coordinate(0) + i);
+   Store(EtaFromRhoZ<T>(pt, z), b.Coordinate(1) + i);
+   Store(PhiFromXY<T>(x, y), b.Coordinate(2) + i);
+   Store(e, b.Coordinate(3) + i);
+}
+
+template <class V, class T>
+inline void StorePxPyPzE(LorentzVectorBatch<PtEtaPhiM4D<T> > &b, std::size_t i, const V &x, const V &y, const V &z,
+                         const V &e)
+{
+   const V pt = Sqrt(x * x + y * y);
+   Store(pt, b.Coordinate(0) + i);
+   Store(EtaFromRhoZ<T>(pt, z), b.Coordinate(1) + i);
+   Store(PhiFromXY<T>(x, y), b.Coordinate(2) + i);
+   Store(MFromM2<T>(e * e - x * x - y * y - z * z), b.Coordinate(3) + i);
+}
+
+// Load the pseudorapidity and azimuthal angle of the elements i of a batch
+
+template <class V, class CoordSystem>
+inline void LoadEtaPhi(const LorentzVectorBatch<CoordSystem> &b, std::size_t i, V &eta, V &phi)
+{
+   typedef typename CoordSystem::Scalar T;
+   const V x = Load<V>(b.Coordinate(0) + i);
+   const V y = Load<V>(b.Coordinate(1) + i);
+   eta = EtaFromRhoZ<T>(Sqrt(x * x + y * y), Load<V>(b.Coordinate(2) + i));
+   phi = PhiFromXY<T>(x, y);
+}
+
+template <class V, class T>
+inline void LoadEtaPhi(const LorentzVectorBatch<PtEtaPhiE4D<T> > &b, std::size_t i, V &eta, V &phi)
+{
+   eta = Load<V>(b.Coordinate(1) + i);
+   phi = Load<V>(b.Coordinate(2) + i);
+}
+
+template <class V, class T>
+inline void LoadEtaPhi(const LorentzVectorBatch<PtEtaPhiM4D<T> > &b, std::size_t i, V &eta, V &phi)
+{
+   eta = Load<V>(b.Coordinate(1) + i);
+   phi = Load<V>(b.Coordinate(2) + i);
+}
+
+// Operations applied by Loop
+
+template <class C1, class C2>
+struct ConvertOp {
+   const LorentzVectorBatch<C1> &fIn;
+   LorentzVectorBatch<C2> &fOut;
+   template <class V>
+   void Apply(std::size_t i) const
+   {
+      V x, y, z, e;
+      LoadPxPyPzE(fIn, i, x, y, z, e);
+      StorePxPyPzE(fOut, i, x, y, z, e);
+   }
+};
+
+/// product by a 4x4 matrix acting on (x, y, z, t), as in LorentzRotation
+template <class CoordSystem>
+struct TransformOp {
+   typedef typename CoordSystem::Scalar T;
+   const LorentzVectorBatch<CoordSystem> &fIn;
+   LorentzVectorBatch<CoordSystem> &fOut;
+   T fM[16];
+   template <class V>
+   void Apply(std::size_t i) const
+   {
+      V x, y, z, e;
+      LoadPxPyPzE(fIn, i, x, y, z, e);
+      StorePxPyPzE(fOut, i, V(fM[0]) * x + V(fM[1]) * y + V(fM[2]) * z + V(fM[3]) * e,
+                   V(fM[4]) * x + V(fM[5]) * y + V(fM[6]) * z + V(fM[7]) * e,
+                   V(fM[8]) * x + V(fM[9]) * y + V(fM[10]) * z + V(fM[11]) * e,
+                   V(fM[12]) * x + V(fM[13]) * y + V(fM[14]) * z + V(fM[15]) * e);
+   }
+};
+
+template <class C1, class C2>
+struct InvariantMassOp {
+   typedef typename C1::Scalar T;
+   const LorentzVectorBatch<C1> &fV1;
+   const LorentzVectorBatch<C2> &fV2;
+   T *fOut;
+   template <class V>
+   void Apply(std::size_t i) const
+   {
+      V x1, y1, z1, e1, x2, y2, z2, e2;
+      LoadPxPyPzE(fV1, i, x1, y1, z1, e1);
+      LoadPxPyPzE(fV2, i, x2, y2, z2, e2);
+      const V x = x1 + x2;
+      const V y = y1 + y2;
+      const V z = z1 + z2;
+      const V e = e1 + e2;
+      Store(MFromM2<T>(e * e - x * x - y * y - z * z), fOut + i);
+   }
+};
+
+template <class CoordSystem>
+struct EtaPhiOp {
+   typedef typename CoordSystem::Scalar T;
+   const LorentzVectorBatch<CoordSystem> &fIn;
+   T *fEta;
+   T *fPhi;
+   template <class V>
+   void Apply(std::size_t i) const
+   {
+      V eta, phi;
+      LoadEtaPhi(fIn, i, eta, phi);
+      Store(eta, fEta + i);
+      Store(phi, fPhi + i);
+   }
+};
+
+/// distance of the elements of two arrays of eta and phi
+template <class T>
+struct DeltaROp {
+   const T *fEta1;
+   const T *fPhi1;
+   const T *fEta2;
+   const T *fPhi2;
+   T *fOut;
+   template <class V>
+   void Apply(std::size_t i) const
+   {
+      const V deta = Load<V>(fEta2 + i) - Load<V>(fEta1 + i);
+      const V dphi = DeltaPhi<T>(Load<V>(fPhi1 + i), Load<V>(fPhi2 + i));
+      Store(Sqrt(deta * deta + dphi * dphi), fOut + i);
+   }
+};
+
+/// distance of one direction to the elements of an array of eta and phi
+template <class T>
+struct DeltaRRowOp {
+   T fEta1;
+   T fPhi1;
+   const T *fEta2;
+   const T *fPhi2;
+   T *fOut;
+   template <class V>
+   void Apply(std::size_t i) const
+   {
+      const V deta = Load<V>(fEta2 + i) - V(fEta1);
+      const V dphi = DeltaPhi<T>(V(fPhi1), Load<V>(fPhi2 + i));
+      Store(Sqrt(deta * deta + dphi * dphi), fOut + i);
+   }
+};
+
+/// convert the vectors of a batch to another coordinate system with the same scalar type
+template <class C1, class C2>
+inline void Convert(const LorentzVectorBatch<C1> &in, LorentzVectorBatch<C2> &out, std::true_type)
+{
+   ConvertOp<C1, C2> op = {in, out};
+   Loop<typename C2::Scalar>(in.size(), op);
+}
+
+/// convert the vectors of a batch to another scalar type, one by one
+template <class C1, class C2>
+inline void Convert(const LorentzVectorBatch<C1> &in, LorentzVectorBatch<C2> &out, std::false_type)
+{
+   for (std::size_t i = 0; i < in.size(); ++i)
+      out.Set(i, in[i]);
+}
+
+template <class C1, class C2>
+inline bool CheckSizes(const LorentzVectorBatch<C1> &v1, const LorentzVectorBatch<C2> &v2)
+{
+   if (v1.size() == v2.size())
+      return true;
+   GenVector::Throw("Operation on batches of Lorentz vectors of different sizes");
+   return false;
+}
+
+} // namespace Batch
+
+} // namespace Impl
+
+//__________________________________________________________________________________________
+/**
+    Class storing a batch of Lorentz vectors as a structure of arrays: the
+    first coordinates of all the vectors are contiguous in memory, then the
+    second ones, and so on. The coordinate system is given by the template
+    parameter, e.g. PxPyPzE4D<double> or PtEtaPhiM4D<float>.
+
+    The functions of VectorUtil taking batches (boost, Rotate, Transform,
+    InvariantMass, DeltaR and DeltaRMatrix), as well as the conversion between
+    coordinate systems, process the vectors by SIMD vectors of ROOT::Double_v
+    (ROOT::Float_v for float coordinates). Without VecCore, they process one
+    vector at a time. The binary operations require batches of the same size
+    and scalar type.
+
+    @ingroup GenVector
+*/
+template <class CoordSystem>
+class LorentzVectorBatch {
+
+public:
+   typedef typename CoordSystem::Scalar Scalar;
+   typedef CoordSystem CoordinateType;
+   typedef LorentzVector<CoordSystem> Vector;
+
+   /**
+      Empty batch
+   */
+   LorentzVectorBatch() {}
+
+   /**
+      Batch of n null vectors
+   */
+   explicit LorentzVectorBatch(std::size_t n) { resize(n); }
+
+   /**
+      Batch with the vectors of another batch, in another coordinate system
+   */
+   template <class OtherCoords>
+   explicit LorentzVectorBatch(const LorentzVectorBatch<OtherCoords> &v)
+   {
+      resize(v.size());
+      Impl::Batch::Convert(v, *this, std::is_same<typename OtherCoords::Scalar, Scalar>());
+   }
+
+   std::size_t size() const { return fC[0].size(); }
+   bool empty() const { return fC[0].empty(); }
+
+   void resize(std::size_t n)
+   {
+      for (unsigned int k = 0; k < 4; ++k)
+         fC[k].resize(n);
+   }
+
+   void reserve(std::size_t n)
+   {
+      for (unsigned int k = 0; k < 4; ++k)
+         fC[k].reserve(n);
+   }
+
+   void clear()
+   {
+      for (unsigned int k = 0; k < 4; ++k)
+         fC[k].clear();
+   }
+
+   /**
+      Append a vector given by its coordinates
+   */
+   void push_back(Scalar a, Scalar b, Scalar c, Scalar d)
+   {
+      fC[0].push_back(a);
+      fC[1].push_back(b);
+      fC[2].push_back(c);
+      fC[3].push_back(d);
+   }
+
+   /**
+      Append a Lorentz vector, converted to the coordinate system of the batch
+   */
+   template <class OtherCoords>
+   void push_back(const LorentzVector<OtherCoords> &v)
+   {
+      Scalar c[4];
+      Vector(v).GetCoordinates(c);
+      push_back(c[0], c[1], c[2], c[3]);
+   }
+
+   /**
+      Lorentz vector i of the batch
+   */
+   Vector operator[](std::size_t i) const { return Vector(fC[0][i], fC[1][i], fC[2][i], fC[3][i]); }
+
+   /**
+      Set the vector i of the batch
+   */
+   template <class OtherCoords>
+   void Set(std::size_t i, const LorentzVector<OtherCoords> &v)
+   {
+      Scalar c[4];
+      Vector(v).GetCoordinates(c);
+      for (unsigned int k = 0; k < 4; ++k)
+         fC[k][i] = c[k];
+   }
+
+   /**
+      Array of the coordinate k (0 to 3) of all the vectors
+   */
+   const Scalar *Coordinate(unsigned int k) const { return fC[k].data(); }
+   Scalar *Coordinate(unsigned int k) { return fC[k].data(); }
+
+private:
+   std::vector<Scalar> fC[4]; ///< the coordinates, in the order of CoordSystem
+};
+
+namespace VectorUtil {
+
+/**
+   Apply a Boost to all the vectors of a batch
+*/
+template <class CoordSystem>
+LorentzVectorBatch<CoordSystem> boost(const LorentzVectorBatch<CoordSystem> &v, const Boost &b)
+{
+   LorentzVectorBatch<CoordSystem> r(v.size());
+   double m[16];
+   b.GetLorentzRotation(m);
+   Impl::Batch::TransformOp<CoordSystem> op = {v, r, {}};
+   std::copy(m, m + 16, op.fM);
+   Impl::Batch::Loop<typename CoordSystem::Scalar>(v.size(), op);
+   return r;
+}
+
+/**
+   Boost all the vectors of a batch using a generic 3D vector describing the
+   boost, as boost(v, b) does for a single vector. The beta of the boost must be
+   < 1 or a batch of null Lorentz vectors will be returned
+*/
+template <class CoordSystem, class BoostVector>
+LorentzVectorBatch<CoordSystem> boost(const LorentzVectorBatch<CoordSystem> &v, const BoostVector &b)
+{
+   const double b2 = b.X() * b.X() + b.Y() * b.Y() + b.Z() * b.Z();
+   if (b2 >= 1) {
+      GenVector::Throw("Beta Vector supplied to set Boost represents speed >= c");
+      return LorentzVectorBatch<CoordSystem>(v.size());
+   }
+   return boost(v, Boost(b.X(), b.Y(), b.Z()));
+}
+
+/**
+   Apply a LorentzRotation to all the vectors of a batch
+*/
+template <class CoordSystem>
+LorentzVectorBatch<CoordSystem> Transform(const LorentzVectorBatch<CoordSystem> &v, const LorentzRotation &rot)
+{
+   LorentzVectorBatch<CoordSystem> r(v.size());
+   double m[16];
+   rot.GetComponents(m);
+   Impl::Batch::TransformOp<CoordSystem> op = {v, r, {}};
+   std::copy(m, m + 16, op.fM);
+   Impl::Batch::Loop<typename CoordSystem::Scalar>(v.size(), op);
+   return r;
+}
+
+/**
+   Rotate the spatial components of all the vectors of a batch
+*/
+template <class CoordSystem>
+LorentzVectorBatch<CoordSystem> Rotate(const LorentzVectorBatch<CoordSystem> &v, const Rotation3D &rot)
+{
+   LorentzVectorBatch<CoordSystem> r(v.size());
+   double m[9];
+   rot.GetComponents(m);
+   typedef typename CoordSystem::Scalar T;
+   Impl::Batch::TransformOp<CoordSystem> op = {v, r, {T(m[0]), T(m[1]), T(m[2]), T(0),
+                                                       T(m[3]), T(m[4]), T(m[5]), T(0),
+                                                       T(m[6]), T(m[7]), T(m[8]), T(0),
+                                                       T(0), T(0), T(0), T(1)}};
+   Impl::Batch::Loop<T>(v.size(), op);
+   return r;
+}
+
+/**
+   Invariant masses of the pairs of vectors with the same index in two batches
+   of the same size, as InvariantMass(v1, v2) for single vectors
+*/
+template <class C1, class C2>
+std::vector<typename C1::Scalar> InvariantMass(const LorentzVectorBatch<C1> &v1, const LorentzVectorBatch<C2> &v2)
+{
+   static_assert(std::is_same<typename C1::Scalar, typename C2::Scalar>::value,
+                 "The batches must have the same scalar type");
+   if (!Impl::Batch::CheckSizes(v1, v2))
+      return std::vector<typename C1::Scalar>();
+   std::vector<typename C1::Scalar> r(v1.size());
+   Impl::Batch::InvariantMassOp<C1, C2> op = {v1, v2, r.data()};
+   Impl::Batch::Loop<typename C1::Scalar>(v1.size(), op);
+   return r;
+}
+
+/**
+   Distances in (eta, phi) of the pairs of vectors with the same index in two
+   batches of the same size, as DeltaR(v1, v2) for single vectors
+*/
+template <class C1, class C2>
+std::vector<typename C1::Scalar> DeltaR(const LorentzVectorBatch<C1> &v1, const LorentzVectorBatch<C2> &v2)
+{
+   static_assert(std::is_same<typename C1::Scalar, typename C2::Scalar>::value,
+                 "The batches must have the same scalar type");
+   typedef typename C1::Scalar T;
+   if (!Impl::Batch::CheckSizes(v1, v2))
+      return std::vector<T>();
+   const std::size_t n = v1.size();
+   std::vector<T> etaPhi(4 * n);
+   Impl::Batch::EtaPhiOp<C1> op1 = {v1, etaPhi.data(), etaPhi.data() + n};
+   Impl::Batch::Loop<T>(n, op1);
+   Impl::Batch::EtaPhiOp<C2> op2 = {v2, etaPhi.data() + 2 * n, etaPhi.data() + 3 * n};
+   Impl::Batch::Loop<T>(n, op2);
+   std::vector<T> r(n);
+   Impl::Batch::DeltaROp<T> op = {etaPhi.data(), etaPhi.data() + n, etaPhi.data() + 2 * n, etaPhi.data() + 3 * n,
+                                  r.data()};
+   Impl::Batch::Loop<T>(n, op);
+   return r;
+}
+
+/**
+   Distances in (eta, phi) of all the pairs made of a vector of the batch v1
+   and a vector of the batch v2. The distance of v1[i] and v2[j] is the element
+   i * v2.size() + j of the returned array
+*/
+template <class C1, class C2>
+std::vector<typename C1::Scalar> DeltaRMatrix(const LorentzVectorBatch<C1> &v1, const LorentzVectorBatch<C2> &v2)
+{
+   static_assert(std::is_same<typename C1::Scalar, typename C2::Scalar>::value,
+                 "The batches must have the same scalar type");
+   typedef typename C1::Scalar T;
+   const std::size_t n1 = v1.size();
+   const std::size_t n2 = v2.size();
+   std::vector<T> etaPhi1(2 * n1), etaPhi2(2 * n2);
+   Impl::Batch::EtaPhiOp<C1> op1 = {v1, etaPhi1.data(), etaPhi1.data() + n1};
+   Impl::Batch::Loop<T>(n1, op1);
+   Impl::Batch::EtaPhiOp<C2> op2 = {v2, etaPhi2.data(), etaPhi2.data() + n2};
+   Impl::Batch::Loop<T>(n2, op2);
+   std::vector<T> r(n1 * n2);
+   for (std::size_t i = 0; i < n1; ++i) {
+      Impl::Batch::DeltaRRowOp<T> op = {etaPhi1[i], etaPhi1[n1 + i], etaPhi2.data(), etaPhi2.data() + n2,
+                                        r.data() + i * n2};
+      Impl::Batch::Loop<T>(n2, op);
+   }
+   return r;
+}
+
+} // namespace VectorUtil
+
+} // namespace Math
+
+} // namespace ROOT
+
+#endif /* ROOT_Math_GenVector_LorentzVectorBatch  */
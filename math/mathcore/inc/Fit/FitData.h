@@ -199,24 +199,20 @@ namespace ROOT {
          template<class Iterator>
          void InitFromRange(Iterator dataItr)
          {
-            for (unsigned int i = 0; i < fMaxPoints; i++) {
-               bool isInside = true;
-               Iterator tmpItr = dataItr;
+            std::vector<const double *> columns(fDim);
+            for (unsigned int j = 0; j < fDim; j++)
+               columns[j] = *dataItr++;
 
-               for (unsigned int j = 0; j < fDim; j++)
-                  isInside &= fRange.IsInside((*tmpItr++)[i], j);
-
-               if (isInside) {
-                  tmpItr = dataItr;
-
-                  for (unsigned int k = 0; k < fDim; k++)
-                     fpTmpCoordVector[k] = (*tmpItr++)[i];
-
-                  Add(fpTmpCoordVector);
-               }
-            }
+            InitFromColumns(columns);
          }
 
+         /**
+          * copy from the given columns (one per coordinate) the first fMaxPoints points
+          * which are inside the range. The selection and the copy are done column-wise,
+          * in parallel when implicit multi-threading is enabled and the data set is large
+         */
+         void InitFromColumns(const std::vector<const double *> & columns);
+
 
       public:
 
@@ -353,7 +349,7 @@ namespace ROOT {
                assert(fCoordsPtr[i]);
                unsigned padding = VectorPadding(fNPoints);
                fCoords[i].resize(fNPoints + padding);
-               std::copy(fCoordsPtr[i], fCoordsPtr[i] + fNPoints + padding, fCoords[i].begin());
+               std::copy(fCoordsPtr[i], fCoordsPtr[i] + fNPoints, fCoords[i].begin());
                fCoordsPtr[i] = fCoords[i].empty() ? nullptr : &fCoords[i].front();
             }
 
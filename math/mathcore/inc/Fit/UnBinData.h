@@ -165,10 +165,11 @@ public :
     constructor for multi-dim external data and a range (data are copied inside according to the range)
     Uses as argument an iterator of a list (or vector) containing the const double * of the data
     An example could be the std::vector<const double *>::begin
+    In case of weighted data, the external data must have a dim+1 lists of data
   */
   template<class Iterator>
   UnBinData( unsigned int maxpoints, unsigned int dim, Iterator dataItr, const DataRange & range, bool isWeighted = false ) :
-    FitData( range, maxpoints, dim, dataItr ),
+    FitData( range, maxpoints, isWeighted ? dim + 1 : dim, dataItr ),
     fWeighted( isWeighted )
   {
   }
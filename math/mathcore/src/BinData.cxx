@@ -772,7 +772,7 @@ namespace ROOT {
       std::copy( fDataPtr, fDataPtr + fNPoints, fData.begin() );
       fDataPtr = fData.empty() ? nullptr : &fData.front();
 
-      for ( unsigned int i=0; i < fDim; i++ )
+      for ( unsigned int i=0; i < fCoordErrorsPtr.size(); i++ )
       {
         assert( fCoordErrorsPtr[i] );
         assert( fCoordErrors.empty() || &fCoordErrors[i].front() == fCoordErrorsPtr[i] );
@@ -784,7 +784,7 @@ namespace ROOT {
         assert( fDataErrorPtr );
 
         fDataError.resize(fNPoints + vectorPadding);
-        std::copy(fDataErrorPtr, fDataErrorPtr + fNPoints + vectorPadding, fDataError.begin());
+        std::copy(fDataErrorPtr, fDataErrorPtr + fNPoints, fDataError.begin());
         fDataErrorPtr = fDataError.empty() ? nullptr : &fDataError.front();
       }
 
@@ -803,7 +803,7 @@ namespace ROOT {
         {
           assert( fCoordErrorsPtr[i] );
           fCoordErrors[i].resize(fNPoints + vectorPadding);
-          std::copy(fCoordErrorsPtr[i], fCoordErrorsPtr[i] + fNPoints + vectorPadding, fCoordErrors[i].begin());
+          std::copy(fCoordErrorsPtr[i], fCoordErrorsPtr[i] + fNPoints, fCoordErrors[i].begin());
           fCoordErrorsPtr[i] = fCoordErrors[i].empty() ? nullptr : &fCoordErrors[i].front();
         }
 
@@ -815,8 +815,8 @@ namespace ROOT {
 
           fDataErrorHigh.resize(fNPoints + vectorPadding);
           fDataErrorLow.resize(fNPoints + vectorPadding);
-          std::copy(fDataErrorHighPtr, fDataErrorHighPtr + fNPoints + vectorPadding, fDataErrorHigh.begin());
-          std::copy(fDataErrorLowPtr, fDataErrorLowPtr + fNPoints + vectorPadding, fDataErrorLow.begin());
+          std::copy(fDataErrorHighPtr, fDataErrorHighPtr + fNPoints, fDataErrorHigh.begin());
+          std::copy(fDataErrorLowPtr, fDataErrorLowPtr + fNPoints, fDataErrorLow.begin());
           fDataErrorHighPtr = fDataErrorHigh.empty() ? nullptr : &fDataErrorHigh.front();
           fDataErrorLowPtr = fDataErrorLow.empty() ? nullptr : &fDataErrorLow.front();
         }
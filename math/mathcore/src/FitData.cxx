@@ -12,6 +12,13 @@
 
 #include "Fit/FitData.h"
 
+#ifdef R__USE_IMT
+#include "ROOT/TThreadExecutor.hxx"
+#include "TROOT.h"
+#endif
+
+#include <algorithm>
+
 // Implementation file for class FitData
 
 namespace ROOT {
@@ -245,6 +252,79 @@ namespace ROOT {
          return *this;
       }
 
+      void FitData::InitFromColumns(const std::vector<const double *> & columns)
+      {
+         assert(!fWrapped);
+         assert(columns.size() == fDim);
+
+         // the data are processed in blocks of points: for each block the points inside the
+         // range are first flagged coordinate by coordinate and then copied column-wise.
+         // The blocks are independent and can be processed in parallel
+         const unsigned int blockSize = 16384;
+         const unsigned int nBlocks = (fMaxPoints + blockSize - 1) / blockSize;
+
+         std::vector<unsigned int> ranged;
+         for (unsigned int j = 0; j < fDim; j++)
+            if (fRange.Size(j) > 0) ranged.push_back(j);
+
+         std::vector<unsigned int> nSelected(nBlocks, 0);
+         std::vector<std::vector<unsigned int> > selected(ranged.empty() ? 0 : nBlocks);
+
+         auto selectBlock = [&](unsigned int iblock) {
+            const unsigned int first = iblock * blockSize;
+            const unsigned int last = std::min(first + blockSize, fMaxPoints);
+            if (ranged.empty()) {
+               nSelected[iblock] = last - first;
+               return;
+            }
+            std::vector<char> inside(last - first, 1);
+            for (auto j : ranged) {
+               const double * x = columns[j];
+               for (unsigned int i = first; i < last; i++)
+                  inside[i - first] &= fRange.IsInside(x[i], j);
+            }
+            std::vector<unsigned int> & index = selected[iblock];
+            for (unsigned int i = first; i < last; i++)
+               if (inside[i - first]) index.push_back(i);
+            nSelected[iblock] = index.size();
+         };
+
+         // offsets of the blocks in the output vectors
+         std::vector<unsigned int> offset(nBlocks + 1, 0);
+
+         auto copyBlock = [&](unsigned int iblock) {
+            const unsigned int first = iblock * blockSize;
+            for (unsigned int j = 0; j < fDim; j++) {
+               const double * x = columns[j];
+               double * y = fCoords[j].data() + offset[iblock];
+               if (ranged.empty()) {
+                  std::copy(x + first, x + first + nSelected[iblock], y);
+               } else {
+                  for (auto i : selected[iblock]) *y++ = x[i];
+               }
+            }
+         };
+
+#ifdef R__USE_IMT
+         if (nBlocks > 1 && ROOT::IsImplicitMTEnabled()) {
+            ROOT::TThreadExecutor pool;
+            pool.Foreach(selectBlock, ROOT::TSeq<unsigned int>(0, nBlocks));
+            for (unsigned int iblock = 0; iblock < nBlocks; iblock++)
+               offset[iblock + 1] = offset[iblock] + nSelected[iblock];
+            pool.Foreach(copyBlock, ROOT::TSeq<unsigned int>(0, nBlocks));
+            fNPoints = offset[nBlocks];
+            return;
+         }
+#endif
+
+         for (unsigned int iblock = 0; iblock < nBlocks; iblock++) {
+            selectBlock(iblock);
+            offset[iblock + 1] = offset[iblock] + nSelected[iblock];
+            copyBlock(iblock);
+         }
+         fNPoints = offset[nBlocks];
+      }
+
       void FitData::Append(unsigned int newPoints, unsigned int dim)
       {
          assert(!fWrapped);
@@ -0,0 +1,214 @@
+// Tests of the fill of the fit data: range selection of external data, histograms and wrapped external data
+
+#include "Fit/BinData.h"
+#include "Fit/DataOptions.h"
+#include "Fit/DataRange.h"
+#include "Fit/UnBinData.h"
+#include "HFitInterface.h"
+#include "TH1.h"
+#include "TH2.h"
+#include "TRandom3.h"
+#include "TROOT.h"
+
+#include "gtest/gtest.h"
+
+#include <memory>
+#include <vector>
+
+using ROOT::Fit::BinData;
+using ROOT::Fit::DataOptions;
+using ROOT::Fit::DataRange;
+using ROOT::Fit::FitData;
+using ROOT::Fit::UnBinData;
+
+// more points than the blocks of the parallel range selection
+static const unsigned int kNPoints = 100000;
+
+static void ExpectEqualCoords(const FitData &a, const FitData &b)
+{
+   ASSERT_EQ(a.Size(), b.Size());
+   ASSERT_EQ(a.NDim(), b.NDim());
+   for (unsigned int i = 0; i < a.Size(); ++i) {
+      for (unsigned int j = 0; j < a.NDim(); ++j)
+         EXPECT_EQ(*a.GetCoordComponent(i, j), *b.GetCoordComponent(i, j)) << "point " << i << " coordinate " << j;
+   }
+}
+
+static void ExpectEqual(const BinData &a, const BinData &b)
+{
+   ExpectEqualCoords(a, b);
+   for (unsigned int i = 0; i < a.Size(); ++i) {
+      EXPECT_EQ(a.Value(i), b.Value(i)) << "point " << i;
+      EXPECT_EQ(a.Error(i), b.Error(i)) << "point " << i;
+   }
+}
+
+// call fill() with implicit multi-threading disabled and enabled
+template <class F>
+static void FillSerialAndParallel(F fill)
+{
+   ROOT::DisableImplicitMT();
+   fill(false);
+#ifdef R__USE_IMT
+   ROOT::EnableImplicitMT(4);
+   fill(true);
+   ROOT::DisableImplicitMT();
+#endif
+}
+
+TEST(FitData, RangedFill)
+{
+   TRandom3 r(1);
+   std::vector<double> x(kNPoints), y(kNPoints), w(kNPoints);
+   for (unsigned int i = 0; i < kNPoints; ++i) {
+      x[i] = r.Gaus(0, 2);
+      y[i] = r.Gaus(1, 1);
+      w[i] = r.Uniform(0.5, 1.5);
+   }
+   DataRange range;
+   range.SetRange(0, -1., 2.);
+   range.AddRange(0, 3., 4.);
+   range.SetRange(1, 0.5, 1.5);
+
+   // the points inside the range, selected one by one
+   std::vector<unsigned int> inside;
+   for (unsigned int i = 0; i < kNPoints; ++i) {
+      if (range.IsInside(x[i], 0) && range.IsInside(y[i], 1))
+         inside.push_back(i);
+   }
+   ASSERT_GT(inside.size(), 0u);
+   ASSERT_LT(inside.size(), kNPoints);
+
+   std::unique_ptr<UnBinData> data[2];
+   std::unique_ptr<UnBinData> weighted[2];
+   FillSerialAndParallel([&](bool parallel) {
+      const double *columns[] = {x.data(), y.data()};
+      data[parallel].reset(new UnBinData(kNPoints, 2, columns, range));
+      // the weights are not subject to the range
+      DataRange rangeX(-1., 2.);
+      weighted[parallel].reset(new UnBinData(kNPoints, x.data(), w.data(), rangeX, true));
+   });
+
+   ASSERT_EQ(data[0]->Size(), inside.size());
+   for (unsigned int k = 0; k < inside.size(); ++k) {
+      EXPECT_EQ(*data[0]->GetCoordComponent(k, 0), x[inside[k]]);
+      EXPECT_EQ(*data[0]->GetCoordComponent(k, 1), y[inside[k]]);
+   }
+   unsigned int k = 0;
+   for (unsigned int i = 0; i < kNPoints; ++i) {
+      if (x[i] < -1. || x[i] > 2.)
+         continue;
+      ASSERT_LT(k, weighted[0]->Size());
+      EXPECT_EQ(*weighted[0]->GetCoordComponent(k, 0), x[i]);
+      EXPECT_EQ(weighted[0]->Weight(k), w[i]);
+      ++k;
+   }
+   EXPECT_EQ(k, weighted[0]->Size());
+
+#ifdef R__USE_IMT
+   ExpectEqualCoords(*data[0], *data[1]);
+   ExpectEqualCoords(*weighted[0], *weighted[1]);
+#endif
+}
+
+TEST(FitData, RangedHistogramFill)
+{
+   TH1D h1("h1", "h1", 100, -5, 5);
+   TH2D h2("h2", "h2", 50, -5, 5, 40, -4, 4);
+   TRandom3 r(1);
+   for (int i = 0; i < 20000; ++i) {
+      h1.Fill(r.Gaus(0, 2));
+      h2.Fill(r.Gaus(0, 2), r.Gaus(0, 1.5));
+   }
+
+   // the range limits are bin edges
+   DataRange range1(-2., 3.);
+   DataRange range2(-2., 3., -1., 2.);
+   DataOptions integral;
+   integral.fIntegral = true;
+   std::unique_ptr<BinData> d1[2], d2[2];
+   FillSerialAndParallel([&](bool parallel) {
+      d1[parallel].reset(new BinData(integral, range1));
+      ROOT::Fit::FillData(*d1[parallel], &h1);
+      d2[parallel].reset(new BinData(DataOptions(), range2));
+      ROOT::Fit::FillData(*d2[parallel], &h2);
+   });
+
+   // the non-empty bins inside the range, in the order of the bins
+   unsigned int k = 0;
+   ASSERT_TRUE(d1[0]->HasBinEdges());
+   for (int i = h1.GetXaxis()->FindBin(-1.95); i <= h1.GetXaxis()->FindBin(2.95); ++i) {
+      if (h1.GetBinContent(i) == 0)
+         continue;
+      ASSERT_LT(k, d1[0]->Size());
+      EXPECT_EQ(*d1[0]->GetCoordComponent(k, 0), h1.GetXaxis()->GetBinLowEdge(i));
+      EXPECT_EQ(d1[0]->GetBinUpEdgeComponent(k, 0), h1.GetXaxis()->GetBinUpEdge(i));
+      EXPECT_EQ(d1[0]->Value(k), h1.GetBinContent(i));
+      EXPECT_DOUBLE_EQ(d1[0]->Error(k), h1.GetBinError(i));
+      ++k;
+   }
+   EXPECT_EQ(k, d1[0]->Size());
+
+   k = 0;
+   for (int i = h2.GetXaxis()->FindBin(-1.9); i <= h2.GetXaxis()->FindBin(2.9); ++i) {
+      for (int j = h2.GetYaxis()->FindBin(-0.9); j <= h2.GetYaxis()->FindBin(1.9); ++j) {
+         if (h2.GetBinContent(i, j) == 0)
+            continue;
+         ASSERT_LT(k, d2[0]->Size());
+         EXPECT_EQ(*d2[0]->GetCoordComponent(k, 0), h2.GetXaxis()->GetBinCenter(i));
+         EXPECT_EQ(*d2[0]->GetCoordComponent(k, 1), h2.GetYaxis()->GetBinCenter(j));
+         EXPECT_EQ(d2[0]->Value(k), h2.GetBinContent(i, j));
+         EXPECT_DOUBLE_EQ(d2[0]->Error(k), h2.GetBinError(i, j));
+         ++k;
+      }
+   }
+   EXPECT_EQ(k, d2[0]->Size());
+
+#ifdef R__USE_IMT
+   ExpectEqual(*d1[0], *d1[1]);
+   ExpectEqual(*d2[0], *d2[1]);
+#endif
+}
+
+TEST(FitData, BinDataExternal)
+{
+   const unsigned int n = 1000;
+   std::vector<double> x(n), y(n), val(n), err(n);
+   for (unsigned int i = 0; i < n; ++i) {
+      x[i] = i;
+      y[i] = 0.5 * i;
+      val[i] = 1. + i % 7;
+      err[i] = 0.1 + 0.01 * (i % 5);
+   }
+   double sum = 0;
+   for (auto v : val)
+      sum += v;
+
+   {
+      // the data refer to the external arrays, without copying them
+      BinData data(n, x.data(), y.data(), val.data(), nullptr, nullptr, err.data());
+      ASSERT_EQ(data.Size(), n);
+      EXPECT_EQ(data.NDim(), 2u);
+      EXPECT_EQ(data.GetCoordComponent(3, 0), &x[3]);
+      EXPECT_EQ(data.GetCoordComponent(3, 1), &y[3]);
+      EXPECT_EQ(data.ValuePtr(3), &val[3]);
+      EXPECT_EQ(data.Error(3), err[3]);
+      EXPECT_DOUBLE_EQ(data.SumOfContent(), sum);
+      val[3] = 42.;
+      EXPECT_EQ(data.Value(3), 42.);
+
+      // transforming the data copies them first: the external data are left untouched
+      const std::vector<double> valBefore(val);
+      data.LogTransform();
+      EXPECT_NE(data.ValuePtr(0), &val[0]);
+      EXPECT_EQ(val, valBefore);
+      for (unsigned int i = 0; i < n; ++i) {
+         EXPECT_DOUBLE_EQ(data.Value(i), std::log(val[i]));
+         EXPECT_EQ(*data.GetCoordComponent(i, 0), x[i]);
+      }
+   }
+
+   // the destruction of the data does not release the external arrays
+   EXPECT_EQ(val[3], 42.);
+   EXPECT_EQ(x[n - 1], n - 1);
+}
@@ -0,0 +1,149 @@
+// Tests of the batches of Lorentz vectors against the operations on single vectors
+
+#include "Math/GenVector/LorentzVectorBatch.h"
+#include "Math/GenVector/VectorUtil.h"
+#include "Math/Vector3D.h"
+#include "Math/Vector4D.h"
+#include "Math/Rotation3D.h"
+#include "Math/EulerAngles.h"
+
+#include "gtest/gtest.h"
+
+#include <random>
+
+using namespace ROOT::Math;
+
+// more vectors than the widest SIMD vector, to test the remainder loop too
+static const std::size_t kNVectors = 37;
+
+template <class CoordSystem>
+LorentzVectorBatch<CoordSystem> MakeBatch(unsigned int seed)
+{
+   std::default_random_engine gen(seed);
+   std::uniform_real_distribution<double> pt(1, 100), eta(-4, 4), phi(-M_PI, M_PI), m(0, 10);
+   LorentzVectorBatch<CoordSystem> b;
+   for (std::size_t i = 0; i < kNVectors; ++i)
+      b.push_back(PtEtaPhiMVector(pt(gen), eta(gen), phi(gen), m(gen)));
+   return b;
+}
+
+template <class CoordSystem>
+class LorentzVectorBatchTest : public ::testing::Test {
+protected:
+   typedef typename CoordSystem::Scalar Scalar;
+   LorentzVectorBatchTest() : fV1(MakeBatch<CoordSystem>(1)), fV2(MakeBatch<CoordSystem>(2)) {}
+
+   // relative precision of the comparisons
+   Scalar Tolerance() const { return sizeof(Scalar) == sizeof(double) ? 1e-10 : 1e-3; }
+
+   template <class V1, class V2>
+   void ExpectNear(const V1 &v1, const V2 &v2) const
+   {
+      const Scalar tolerance = Tolerance() * v1.E();
+      EXPECT_NEAR(v1.Px(), v2.Px(), tolerance);
+      EXPECT_NEAR(v1.Py(), v2.Py(), tolerance);
+      EXPECT_NEAR(v1.Pz(), v2.Pz(), tolerance);
+      EXPECT_NEAR(v1.E(), v2.E(), tolerance);
+   }
+
+   LorentzVectorBatch<CoordSystem> fV1;
+   LorentzVectorBatch<CoordSystem> fV2;
+};
+
+typedef ::testing::Types<PxPyPzE4D<double>, PxPyPzM4D<double>, PtEtaPhiE4D<double>, PtEtaPhiM4D<double>,
+                         PxPyPzE4D<float>, PtEtaPhiM4D<float>>
+   CoordSystems;
+TYPED_TEST_CASE(LorentzVectorBatchTest, CoordSystems);
+
+TYPED_TEST(LorentzVectorBatchTest, Conversion)
+{
+   LorentzVectorBatch<PxPyPzE4D<double>> xyzt(this->fV1);
+   LorentzVectorBatch<PtEtaPhiM4D<double>> ptEtaPhiM(this->fV1);
+   LorentzVectorBatch<TypeParam> back(ptEtaPhiM);
+   ASSERT_EQ(xyzt.size(), kNVectors);
+   for (std::size_t i = 0; i < kNVectors; ++i) {
+      this->ExpectNear(this->fV1[i], xyzt[i]);
+      this->ExpectNear(this->fV1[i], ptEtaPhiM[i]);
+      this->ExpectNear(this->fV1[i], back[i]);
+      EXPECT_NEAR(this->fV1[i].Eta(), ptEtaPhiM[i].Eta(), this->Tolerance());
+   }
+}
+
+TYPED_TEST(LorentzVectorBatchTest, Boost)
+{
+   XYZVector beta(0.2, -0.3, 0.4);
+   auto boosted = VectorUtil::boost(this->fV1, beta);
+   auto boosted2 = VectorUtil::boost(this->fV1, Boost(beta));
+   ASSERT_EQ(boosted.size(), kNVectors);
+   for (std::size_t i = 0; i < kNVectors; ++i) {
+      auto ref = VectorUtil::boost(XYZTVector(this->fV1[i]), beta);
+      this->ExpectNear(ref, boosted[i]);
+      this->ExpectNear(ref, boosted2[i]);
+   }
+}
+
+TYPED_TEST(LorentzVectorBatchTest, Rotation)
+{
+   Rotation3D rot(EulerAngles(0.3, 1.2, -0.7));
+   auto rotated = VectorUtil::Rotate(this->fV1, rot);
+   LorentzRotation lrot(Boost(0.1, 0.5, -0.2));
+   auto transformed = VectorUtil::Transform(this->fV1, lrot);
+   for (std::size_t i = 0; i < kNVectors; ++i) {
+      XYZTVector v(this->fV1[i]);
+      this->ExpectNear(rot * v, rotated[i]);
+      this->ExpectNear(lrot(v), transformed[i]);
+   }
+}
+
+TYPED_TEST(LorentzVectorBatchTest, InvariantMass)
+{
+   auto m = VectorUtil::InvariantMass(this->fV1, this->fV2);
+   ASSERT_EQ(m.size(), kNVectors);
+   for (std::size_t i = 0; i < kNVectors; ++i) {
+      const double ref = (XYZTVector(this->fV1[i]) + XYZTVector(this->fV2[i])).M();
+      EXPECT_NEAR(ref, m[i], this->Tolerance() * (this->fV1[i].E() + this->fV2[i].E()));
+   }
+}
+
+TYPED_TEST(LorentzVectorBatchTest, DeltaR)
+{
+   auto dr = VectorUtil::DeltaR(this->fV1, this->fV2);
+   ASSERT_EQ(dr.size(), kNVectors);
+   for (std::size_t i = 0; i < kNVectors; ++i)
+      EXPECT_NEAR(VectorUtil::DeltaR(this->fV1[i], this->fV2[i]), dr[i], 10 * this->Tolerance());
+
+   // all the pairs of a batch of kNVectors and a batch of 5 vectors
+   LorentzVectorBatch<TypeParam> v3;
+   for (std::size_t j = 0; j < 5; ++j)
+      v3.push_back(this->fV2[j]);
+   auto drMatrix = VectorUtil::DeltaRMatrix(this->fV1, v3);
+   ASSERT_EQ(drMatrix.size(), 5 * kNVectors);
+   for (std::size_t i = 0; i < kNVectors; ++i) {
+      for (std::size_t j = 0; j < 5; ++j)
+         EXPECT_NEAR(VectorUtil::DeltaR(this->fV1[i], v3[j]), drMatrix[i * 5 + j], 10 * this->Tolerance());
+   }
+}
+
+TEST(LorentzVectorBatch, Limits)
+{
+   // vectors along the z axis, at rest, and space-like
+   LorentzVectorBatch<PxPyPzE4D<double>> v;
+   v.push_back(0., 0., 5., 6.);
+   v.push_back(0., 0., -5., 6.);
+   v.push_back(0., 0., 0., 1.);
+   v.push_back(1., 2., 3., 1.);
+   LorentzVectorBatch<PtEtaPhiM4D<double>> w(v);
+   LorentzVectorBatch<PxPyPzE4D<double>> back(w);
+   for (std::size_t i = 0; i < v.size(); ++i) {
+      EXPECT_DOUBLE_EQ(v[i].Eta(), w[i].Eta());
+      EXPECT_DOUBLE_EQ(v[i].Phi(), w[i].Phi());
+      EXPECT_NEAR(v[i].Pz(), back[i].Pz(), 1e-12);
+      EXPECT_NEAR(v[i].E(), back[i].E(), 1e-12);
+   }
+   EXPECT_DOUBLE_EQ(w[3].M(), -std::sqrt(13.));
+
+   // different sizes
+   LorentzVectorBatch<PxPyPzE4D<double>> u(2);
+   EXPECT_TRUE(VectorUtil::InvariantMass(v, u).empty());
+   EXPECT_TRUE(VectorUtil::DeltaR(v, u).empty());
+}
@@ -0,0 +1,196 @@
+// Tests of the batches of SMatrix and SVector against the operations on single matrices
+
+#include "Math/SMatrixBatch.h"
+
+#include "gtest/gtest.h"
+
+#include <random>
+
+using namespace ROOT::Math;
+
+typedef SMatrix<double, 5, 5, MatRepSym<double, 5> > SMatrixSym5;
+typedef SMatrix<double, 5, 5> SMatrix5;
+typedef SMatrix<double, 2, 5> SMatrix25;
+
+// more matrices than the widest SIMD vector, to test the padding of the last block too
+static const std::size_t kNMatrices = 37;
+
+// batch of random positive definite matrices
+static SMatrixBatch<double, 5, 5, MatRepSym<double, 5> > MakeSymBatch(unsigned int seed)
+{
+   std::default_random_engine gen(seed);
+   std::uniform_real_distribution<double> x(-1, 1);
+   SMatrixBatch<double, 5, 5, MatRepSym<double, 5> > b(kNMatrices);
+   for (std::size_t i = 0; i < kNMatrices; ++i) {
+      SMatrix5 a;
+      for (unsigned int k = 0; k < 5; ++k) {
+         for (unsigned int l = 0; l < 5; ++l)
+            a(k, l) = x(gen);
+      }
+      SMatrixSym5 m = SimilarityT(a, SMatrixSym5(SMatrixIdentity()));
+      for (unsigned int k = 0; k < 5; ++k)
+         m(k, k) += 0.1;
+      b.Set(i, m);
+   }
+   return b;
+}
+
+template <class B>
+static B MakeBatch(unsigned int seed)
+{
+   std::default_random_engine gen(seed);
+   std::uniform_real_distribution<double> x(-1, 1);
+   B b(kNMatrices);
+   for (std::size_t i = 0; i < kNMatrices; ++i) {
+      typename B::SMatrix_t m;
+      for (unsigned int k = 0; k < B::SMatrix_t::kRows; ++k) {
+         for (unsigned int l = 0; l < B::SMatrix_t::kCols; ++l)
+            m(k, l) = x(gen);
+      }
+      b.Set(i, m);
+   }
+   return b;
+}
+
+static SVectorBatch<double, 5> MakeVectorBatch(unsigned int seed)
+{
+   std::default_random_engine gen(seed);
+   std::uniform_real_distribution<double> x(-1, 1);
+   SVectorBatch<double, 5> b(kNMatrices);
+   for (std::size_t i = 0; i < kNMatrices; ++i) {
+      SVector<double, 5> v;
+      for (unsigned int k = 0; k < 5; ++k)
+         v(k) = x(gen);
+      b.Set(i, v);
+   }
+   return b;
+}
+
+template <class M1, class M2>
+static void ExpectNear(const M1 &m1, const M2 &m2, double tolerance = 1e-12)
+{
+   for (unsigned int k = 0; k < M1::kRows; ++k) {
+      for (unsigned int l = 0; l < M1::kCols; ++l)
+         EXPECT_NEAR(m1(k, l), m2(k, l), tolerance);
+   }
+}
+
+TEST(SMatrixBatch, Storage)
+{
+   auto a = MakeBatch<SMatrixBatch<double, 2, 5> >(1);
+   ASSERT_EQ(a.size(), kNMatrices);
+   EXPECT_EQ(a.NBlocks(), (kNMatrices + a.BlockSize() - 1) / a.BlockSize());
+   SMatrix25 m = a[3];
+   m(1, 4) = 42;
+   a.Set(3, m);
+   EXPECT_EQ(a[3](1, 4), 42);
+   EXPECT_EQ(SMatrixBatchHelpers::Lane(a.GetBlock(3 / a.BlockSize())(1, 4), 3 % a.BlockSize()), 42);
+
+   a.resize(kNMatrices + 1);
+   EXPECT_EQ(a[kNMatrices], SMatrix25());
+   EXPECT_EQ(a[3], m);
+
+   // the matrices added after shrinking the batch are null too
+   a.resize(2);
+   a.resize(kNMatrices);
+   for (std::size_t i = 2; i < kNMatrices; ++i)
+      EXPECT_EQ(a[i], SMatrix25());
+}
+
+TEST(SMatrixBatch, Sizes)
+{
+   auto a = MakeBatch<SMatrixBatch<double, 5> >(1);
+   auto v = MakeVectorBatch(2);
+   SMatrixBatch<double, 5> b(kNMatrices - 1);
+   SVectorBatch<double, 5> u(kNMatrices - 1);
+   SMatrixBatch<double, 5, 5, MatRepSym<double, 5> > cov(kNMatrices - 1);
+   EXPECT_THROW(a + b, std::invalid_argument);
+   EXPECT_THROW(a - b, std::invalid_argument);
+   EXPECT_THROW(a * b, std::invalid_argument);
+   EXPECT_THROW(a * u, std::invalid_argument);
+   EXPECT_THROW(v + u, std::invalid_argument);
+   EXPECT_THROW(v - u, std::invalid_argument);
+   EXPECT_THROW(Similarity(a, cov), std::invalid_argument);
+   EXPECT_THROW(SimilarityT(a, cov), std::invalid_argument);
+   EXPECT_THROW(Similarity(v, cov), std::invalid_argument);
+}
+
+TEST(SMatrixBatch, Arithmetic)
+{
+   auto a = MakeBatch<SMatrixBatch<double, 5> >(1);
+   auto b = MakeBatch<SMatrixBatch<double, 5> >(2);
+   auto h = MakeBatch<SMatrixBatch<double, 2, 5> >(3);
+   auto v = MakeVectorBatch(4);
+   auto u = MakeVectorBatch(5);
+   auto sum = a + b;
+   auto diff = a - b;
+   auto prod = a * b;
+   auto hv = h * v;
+   auto vsum = u + v;
+   auto vdiff = u - v;
+   auto ht = Transpose(h);
+   ASSERT_EQ(prod.size(), kNMatrices);
+   ASSERT_EQ(hv.size(), kNMatrices);
+   for (std::size_t i = 0; i < kNMatrices; ++i) {
+      ExpectNear(SMatrix5(a[i] + b[i]), sum[i]);
+      ExpectNear(SMatrix5(a[i] - b[i]), diff[i]);
+      ExpectNear(SMatrix5(a[i] * b[i]), prod[i]);
+      ExpectNear(Transpose(h[i]), ht[i]);
+      const SVector<double, 2> ref = h[i] * v[i];
+      for (unsigned int k = 0; k < 2; ++k)
+         EXPECT_NEAR(ref(k), hv[i](k), 1e-12);
+      for (unsigned int k = 0; k < 5; ++k) {
+         EXPECT_NEAR(u[i](k) + v[i](k), vsum[i](k), 1e-12);
+         EXPECT_NEAR(u[i](k) - v[i](k), vdiff[i](k), 1e-12);
+      }
+   }
+}
+
+TEST(SMatrixBatch, Similarity)
+{
+   auto cov = MakeSymBatch(1);
+   auto h = MakeBatch<SMatrixBatch<double, 2, 5> >(2);
+   auto f = MakeBatch<SMatrixBatch<double, 5> >(3);
+   auto r = MakeVectorBatch(4);
+   auto projected = Similarity(h, cov);
+   auto propagated = Similarity(f, cov);
+   auto transposed = SimilarityT(f, cov);
+   auto chi2 = Similarity(r, cov);
+   ASSERT_EQ(chi2.size(), kNMatrices);
+   for (std::size_t i = 0; i < kNMatrices; ++i) {
+      ExpectNear(Similarity(h[i], cov[i]), projected[i]);
+      ExpectNear(Similarity(f[i], cov[i]), propagated[i]);
+      ExpectNear(SimilarityT(f[i], cov[i]), transposed[i]);
+      EXPECT_NEAR(Similarity(cov[i], r[i]), chi2[i], 1e-12);
+   }
+}
+
+TEST(SMatrixBatch, Inversion)
+{
+   auto cov = MakeSymBatch(1);
+   auto inv = cov;
+   EXPECT_TRUE(inv.InvertChol());
+   auto inv2 = cov;
+   EXPECT_TRUE(inv2.Invert());
+   auto a = MakeBatch<SMatrixBatch<double, 5> >(2);
+   auto ainv = a;
+   EXPECT_TRUE(ainv.Invert());
+   for (std::size_t i = 0; i < kNMatrices; ++i) {
+      SMatrixSym5 ref = cov[i];
+      ASSERT_TRUE(ref.InvertChol());
+      ExpectNear(ref, inv[i], 1e-8 * ref(0, 0));
+      ExpectNear(ref, inv2[i], 1e-8 * ref(0, 0));
+      ExpectNear(SMatrix5(ainv[i] * a[i]), SMatrix5(SMatrixIdentity()), 1e-10);
+   }
+
+   // the matrices which are not positive definite are left unchanged
+   SMatrixSym5 m = cov[5];
+   m(2, 2) = -1;
+   cov.Set(5, m);
+   EXPECT_FALSE(cov.InvertChol());
+   EXPECT_EQ(cov[5], m);
+   for (std::size_t i = 0; i < kNMatrices; ++i) {
+      if (i != 5)
+         ExpectNear(inv[i], cov[i], 1e-8 * inv[i](0, 0));
+   }
+}
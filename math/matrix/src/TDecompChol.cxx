@@ -25,6 +25,7 @@
 */
 
 #include "TDecompChol.h"
+#include "TMatrixTParallel.h"
 #include "TMath.h"
 
 ClassImp(TDecompChol);
@@ -112,7 +113,7 @@ Bool_t TDecompChol::Decompose()
       return kFALSE;
    }
 
-   Int_t i,j,icol,irow;
+   Int_t icol,irow;
    const Int_t     n  = fU.GetNrows();
          Double_t *pU = fU.GetMatrixArray();
    for (icol = 0; icol < n; icol++) {
@@ -132,14 +133,22 @@ Bool_t TDecompChol::Decompose()
       pU[rowOff+icol] = ujj;
 
       if (icol < n-1) {
-         for (j = icol+1; j < n; j++) {
-            for (i = 0; i < icol; i++) {
+         // The columns j > icol of the row are independent. They are updated
+         // with the rows above one after the other, so that the memory is
+         // scanned contiguously, on several threads for large matrices.
+         auto updateCols = [&](Int_t j0,Int_t j1) {
+            j0 += icol+1;
+            j1 += icol+1;
+            for (Int_t i = 0; i < icol; i++) {
                const Int_t rowOff2 = i*n;
-               pU[rowOff+j] -= pU[rowOff2+j]*pU[rowOff2+icol];
+               const Double_t uicol = pU[rowOff2+icol];
+               for (Int_t j = j0; j < j1; j++)
+                  pU[rowOff+j] -= pU[rowOff2+j]*uicol;
             }
-         }
-         for (j = icol+1; j < n; j++)
-            pU[rowOff+j] /= ujj;
+            for (Int_t j = j0; j < j1; j++)
+               pU[rowOff+j] /= ujj;
+         };
+         TMatrixTParallel::Foreach(updateCols,n-icol-1,2.*icol*(n-icol-1));
       }
    }
 
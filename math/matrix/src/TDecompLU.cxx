@@ -10,6 +10,7 @@
  *************************************************************************/
 
 #include "TDecompLU.h"
+#include "TMatrixTParallel.h"
 #include "TMath.h"
 
 ClassImp(TDecompLU);
@@ -602,13 +603,15 @@ Bool_t TDecompLU::DecomposeLUCrout(TMatrixD &lu,Int_t *index,Double_t &sign,
    const Int_t     n     = lu.GetNcols();
    Double_t *pLU   = lu.GetMatrixArray();
 
-   Double_t work[kWorkMax];
+   Double_t work[2*kWorkMax];
    Bool_t isAllocated = kFALSE;
    Double_t *scale = work;
    if (n > kWorkMax) {
       isAllocated = kTRUE;
-      scale = new Double_t[n];
+      scale = new Double_t[2*n];
    }
+   // copy of the current column, to scan it contiguously together with the rows
+   Double_t *col = scale+n;
 
    sign    = 1.0;
    nrZeros = 0;
@@ -626,33 +629,43 @@ Bool_t TDecompLU::DecomposeLUCrout(TMatrixD &lu,Int_t *index,Double_t &sign,
 
    for (Int_t j = 0; j < n; j++) {
       const Int_t off_j = j*n;
+      for (Int_t i = 0; i < n; i++)
+         col[i] = pLU[i*n+j];
+
       // Run down jth column from top to diag, to form the elements of U.
       for (Int_t i = 0; i < j; i++) {
          const Int_t off_i = i*n;
-         Double_t r = pLU[off_i+j];
-         for (Int_t k = 0; k < i; k++) {
-            const Int_t off_k = k*n;
-            r -= pLU[off_i+k]*pLU[off_k+j];
-         }
-         pLU[off_i+j] = r;
+         Double_t r = col[i];
+         for (Int_t k = 0; k < i; k++)
+            r -= pLU[off_i+k]*col[k];
+         col[i] = r;
       }
 
       // Run down jth subdiag to form the residuals after the elimination of
       // the first j-1 subdiags.  These residuals divided by the appropriate
       // diagonal term will become the multipliers in the elimination of the jth.
-      // subdiag. Find fIndex of largest scaled term in imax.
+      // subdiag. The rows are independent, and processed on several threads
+      // for large matrices.
+
+      auto residuals = [&](Int_t i0,Int_t i1) {
+         for (Int_t i = j+i0; i < j+i1; i++) {
+            const Int_t off_i = i*n;
+            Double_t r = col[i];
+            for (Int_t k = 0; k < j; k++)
+               r -= pLU[off_i+k]*col[k];
+            col[i] = r;
+         }
+      };
+      TMatrixTParallel::Foreach(residuals,n-j,2.*j*(n-j));
+
+      // Find fIndex of largest scaled term in imax.
 
       Double_t max = 0.0;
       Int_t imax = 0;
+      for (Int_t i = 0; i < n; i++)
+         pLU[i*n+j] = col[i];
       for (Int_t i = j; i < n; i++) {
-         const Int_t off_i = i*n;
-         Double_t r = pLU[off_i+j];
-         for (Int_t k = 0; k < j; k++) {
-            const Int_t off_k = k*n;
-            r -= pLU[off_i+k]*pLU[off_k+j];
-         }
-         pLU[off_i+j] = r;
-         const Double_t tmp = scale[i]*TMath::Abs(r);
+         const Double_t tmp = scale[i]*TMath::Abs(col[i]);
          if (tmp >= max) {
             max = tmp;
             imax = i;
@@ -811,6 +824,14 @@ Bool_t TDecompLU::InvertLU(TMatrixD &lu,Double_t tol,Double_t *det)
       *det = d1*TMath::Power(2.0,d2);
    }
 
+   Double_t workd[2*kWorkMax];
+   Bool_t isAllocatedD = kFALSE;
+   Double_t *pWorkd = workd;
+   if (n > kWorkMax) {
+      isAllocatedD = kTRUE;
+      pWorkd = new Double_t[2*n];
+   }
+
    //  Form inv(U).
 
    Int_t j;
@@ -821,37 +842,36 @@ Bool_t TDecompLU::InvertLU(TMatrixD &lu,Double_t tol,Double_t *det)
       pLU[off_j+j] = 1./pLU[off_j+j];
       const Double_t mLU_jj = -pLU[off_j+j];
 
-//    Compute elements 0:j-1 of j-th column.
+//    Compute elements 0:j-1 of j-th column, the product of the upper left
+//    j x j block of inv(U) with the column. The elements are independent
+//    dot products of the rows with a copy of the column in pX.
 
-      Double_t *pX = pLU+j;
-      Int_t k;
-      for (k = 0; k <= j-1; k++) {
-         const Int_t off_k = k*n;
-         if ( pX[off_k] != 0.0 ) {
-            const Double_t tmp = pX[off_k];
-            for (Int_t i = 0; i <= k-1; i++) {
-               const Int_t off_i = i*n;
-               pX[off_i] += tmp*pLU[off_i+k];
+      Double_t *pX = pWorkd;
+      Double_t *pY = pWorkd+n;
+      for (Int_t k = 0; k < j; k++)
+         pX[k] = pLU[k*n+j];
+
+      auto multRows = [&](Int_t i0,Int_t i1) {
+         for (Int_t i = i0; i < i1; i++) {
+            const Int_t off_i = i*n;
+            Double_t r = pX[i];
+            if (r != 0.0)
+               r *= pLU[off_i+i];
+            for (Int_t k = i+1; k < j; k++) {
+               if (pX[k] != 0.0)
+                  r += pX[k]*pLU[off_i+k];
             }
-            pX[off_k] *= pLU[off_k+k];
+            pY[i] = r;
          }
-      }
-      for (k = 0; k <= j-1; k++) {
-         const Int_t off_k = k*n;
-         pX[off_k] *= mLU_jj;
-      }
+      };
+      TMatrixTParallel::Foreach(multRows,j,1.*j*j);
+
+      for (Int_t k = 0; k < j; k++)
+         pLU[k*n+j] = pY[k]*mLU_jj;
    }
 
    // Solve the equation inv(A)*L = inv(U) for inv(A).
 
-   Double_t workd[kWorkMax];
-   Bool_t isAllocatedD = kFALSE;
-   Double_t *pWorkd = workd;
-   if (n > kWorkMax) {
-      isAllocatedD = kTRUE;
-      pWorkd = new Double_t[n];
-   }
-
    for (j = n-1; j >= 0; j--) {
 
       // Copy current column j of L to WORK and replace with zeros.
@@ -864,18 +884,21 @@ Bool_t TDecompLU::InvertLU(TMatrixD &lu,Double_t tol,Double_t *det)
       // Compute current column of inv(A).
 
       if (j < n-1) {
-         const Double_t *mp = pLU+j+1;  // Matrix row ptr
-         Double_t *tp = pLU+j;          // Target vector ptr
-
-         for (Int_t irow = 0; irow < n; irow++) {
-            Double_t sum = 0.;
-            const Double_t *sp = pWorkd+j+1; // Source vector ptr
-            for (Int_t icol = 0; icol < n-1-j ; icol++)
-               sum += *mp++ * *sp++;
-            *tp = -sum + *tp;
-            mp += j+1;
-            tp += n;
-         }
+         auto updateRows = [&](Int_t irow0,Int_t irow1) {
+            const Double_t *mp = pLU+irow0*n+j+1;  // Matrix row ptr
+            Double_t *tp = pLU+irow0*n+j;          // Target vector ptr
+
+            for (Int_t irow = irow0; irow < irow1; irow++) {
+               Double_t sum = 0.;
+               const Double_t *sp = pWorkd+j+1; // Source vector ptr
+               for (Int_t icol = 0; icol < n-1-j ; icol++)
+                  sum += *mp++ * *sp++;
+               *tp = -sum + *tp;
+               mp += j+1;
+               tp += n;
+            }
+         };
+         TMatrixTParallel::Foreach(updateRows,n,2.*n*(n-1-j));
       }
    }
 
@@ -24,8 +24,11 @@
 */
 
 #include "TMatrixDSymEigen.h"
+#include "TMatrixTParallel.h"
 #include "TMath.h"
 
+#include <vector>
+
 ClassImp(TMatrixDSymEigen);
 
 ////////////////////////////////////////////////////////////////////////////////
@@ -116,23 +119,31 @@ void TMatrixDSymEigen::MakeTridiagonal(TMatrixD &v,TVectorD &d,TVectorD &e)
          pE[i]   = scale*g;
          h       = h-f*g;
          pD[i-1] = f-g;
-         for (j = 0; j < i; j++)
-            pE[j] = 0.0;
 
-         // Apply similarity transformation to remaining columns.
+         // Apply similarity transformation to remaining columns:
+         // e = A*d with A the lower triangle of V. The elements of e are
+         // independent, and summed over rows and then columns of A, so
+         // that the memory is scanned contiguously.
 
-         for (j = 0; j < i; j++) {
-            const Int_t off_j = j*n;
-            f = pD[j];
-            pV[off_j+i] = f;
-            g = pE[j]+pV[off_j+j]*f;
-            for (k = j+1; k <= i-1; k++) {
-               const Int_t off_k = k*n;
-               g += pV[off_k+j]*pD[k];
-               pE[k] += pV[off_k+j]*f;
+         for (j = 0; j < i; j++)
+            pV[j*n+i] = pD[j];
+         auto multCols = [&](Int_t j0,Int_t j1) {
+            for (Int_t jj = j0; jj < j1; jj++) {
+               const Int_t off_j = jj*n;
+               Double_t ej = 0.0;
+               for (Int_t kk = 0; kk < jj; kk++)
+                  ej += pV[off_j+kk]*pD[kk];
+               pE[jj] = ej+pV[off_j+jj]*pD[jj];
             }
-            pE[j] = g;
-         }
+            for (Int_t kk = j0+1; kk <= i-1; kk++) {
+               const Int_t off_k = kk*n;
+               const Double_t dk = pD[kk];
+               const Int_t jend = TMath::Min(kk,j1);
+               for (Int_t jj = j0; jj < jend; jj++)
+                  pE[jj] += pV[off_k+jj]*dk;
+            }
+         };
+         TMatrixTParallel::Foreach(multCols,i,2.*i*i);
          f = 0.0;
          for (j = 0; j < i; j++) {
             pE[j] /= h;
@@ -141,13 +152,17 @@ void TMatrixDSymEigen::MakeTridiagonal(TMatrixD &v,TVectorD &d,TVectorD &e)
          Double_t hh = f/(h+h);
          for (j = 0; j < i; j++)
             pE[j] -= hh*pD[j];
-         for (j = 0; j < i; j++) {
-            f = pD[j];
-            g = pE[j];
-            for (k = j; k <= i-1; k++) {
-               const Int_t off_k = k*n;
-               pV[off_k+j] -= (f*pE[k]+g*pD[k]);
+         auto updateRows = [&](Int_t k0,Int_t k1) {
+            for (Int_t kk = k0; kk < k1; kk++) {
+               const Int_t off_k = kk*n;
+               const Double_t ek = pE[kk];
+               const Double_t dk = pD[kk];
+               for (Int_t jj = 0; jj <= kk; jj++)
+                  pV[off_k+jj] -= (pD[jj]*ek+pE[jj]*dk);
             }
+         };
+         TMatrixTParallel::Foreach(updateRows,i,2.*i*i);
+         for (j = 0; j < i; j++) {
             pD[j] = pV[off_i1+j];
             pV[off_i+j] = 0.0;
          }
@@ -157,6 +172,8 @@ void TMatrixDSymEigen::MakeTridiagonal(TMatrixD &v,TVectorD &d,TVectorD &e)
 
    // Accumulate transformations.
 
+   std::vector<Double_t> work(n);
+   Double_t *pG = work.data();
    for (i = 0; i < n-1; i++) {
       const Int_t off_i  = i*n;
       pV[off_n1+i] = pV[off_i+i];
@@ -167,17 +184,28 @@ void TMatrixDSymEigen::MakeTridiagonal(TMatrixD &v,TVectorD &d,TVectorD &e)
             const Int_t off_k = k*n;
             pD[k] = pV[off_k+i+1]/h;
          }
-         for (j = 0; j <= i; j++) {
-            Double_t g = 0.0;
-            for (k = 0; k <= i; k++) {
-               const Int_t off_k = k*n;
-               g += pV[off_k+i+1]*pV[off_k+j];
+         // g = V^T * v(i+1) and V -= d * g^T, on the upper left (i+1) x (i+1)
+         // block of V, scanning the rows of V
+         auto multCols = [&](Int_t j0,Int_t j1) {
+            for (Int_t jj = j0; jj < j1; jj++)
+               pG[jj] = 0.0;
+            for (Int_t kk = 0; kk <= i; kk++) {
+               const Int_t off_k = kk*n;
+               const Double_t vk = pV[off_k+i+1];
+               for (Int_t jj = j0; jj < j1; jj++)
+                  pG[jj] += vk*pV[off_k+jj];
             }
-            for (k = 0; k <= i; k++) {
-               const Int_t off_k = k*n;
-               pV[off_k+j] -= g*pD[k];
+         };
+         TMatrixTParallel::Foreach(multCols,i+1,2.*(i+1)*(i+1));
+         auto updateRows = [&](Int_t k0,Int_t k1) {
+            for (Int_t kk = k0; kk < k1; kk++) {
+               const Int_t off_k = kk*n;
+               const Double_t dk = pD[kk];
+               for (Int_t jj = 0; jj <= i; jj++)
+                  pV[off_k+jj] -= pG[jj]*dk;
             }
-         }
+         };
+         TMatrixTParallel::Foreach(updateRows,i+1,2.*(i+1)*(i+1));
       }
       for (k = 0; k <= i; k++) {
          const Int_t off_k = k*n;
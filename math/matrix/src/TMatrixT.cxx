@@ -25,6 +25,7 @@
 #include "TMatrixTSym.h"
 #include "TMatrixTLazy.h"
 #include "TMatrixTCramerInv.h"
+#include "TMatrixTParallel.h"
 #include "TDecompLU.h"
 #include "TMatrixDEigen.h"
 #include "TClass.h"
@@ -3071,73 +3072,127 @@ TMatrixT<Element> &ElementDiv(TMatrixT<Element> &target,const TMatrixTSym<Elemen
 }
 
 ////////////////////////////////////////////////////////////////////////////////
-/// Elementary routine to calculate matrix multiplication A*B
+/// Elementary routine to calculate matrix multiplication A*B .
+/// The rows of C are computed by blocks of A and B which stay in the cache, on
+/// several threads for large matrices when implicit multi-threading is enabled.
+/// Each element of C is summed in the same order as in a straight loop.
 
 template<class Element>
 void AMultB(const Element * const ap,Int_t na,Int_t ncolsa,
-            const Element * const bp,Int_t nb,Int_t ncolsb,Element *cp)
+            const Element * const bp,Int_t /*nb*/,Int_t ncolsb,Element *cp)
 {
-   const Element *arp0 = ap;                     // Pointer to  A[i,0];
-   while (arp0 < ap+na) {
-      for (const Element *bcp = bp; bcp < bp+ncolsb; ) { // Pointer to the j-th column of B, Start bcp = B[0,0]
-         const Element *arp = arp0;                       // Pointer to the i-th row of A, reset to A[i,0]
-         Element cij = 0;
-         while (bcp < bp+nb) {                     // Scan the i-th row of A and
-            cij += *arp++ * *bcp;                   // the j-th col of B
-            bcp += ncolsb;
+   if (ncolsa == 0 || ncolsb == 0)
+      return;
+
+   const Int_t kBlock = TMatrixTParallel::kBlock;
+   auto multRows = [&](Int_t irow0,Int_t irow1) {
+      std::fill(cp+irow0*ncolsb,cp+irow1*ncolsb,Element(0));
+      for (Int_t k0 = 0; k0 < ncolsa; k0 += kBlock) {
+         const Int_t k1 = std::min(ncolsa,k0+kBlock);
+         for (Int_t j0 = 0; j0 < ncolsb; j0 += 4*kBlock) {
+            const Int_t j1 = std::min(ncolsb,j0+4*kBlock);
+            for (Int_t irow = irow0; irow < irow1; irow++) {
+               const Element * const arp = ap+irow*ncolsa;   // Pointer to A[i,0]
+                     Element * const crp = cp+irow*ncolsb;   // Pointer to C[i,0]
+               for (Int_t k = k0; k < k1; k++) {
+                  const Element aik = arp[k];
+                  const Element * const brp = bp+k*ncolsb;   // Pointer to B[k,0]
+                  for (Int_t j = j0; j < j1; j++)
+                     crp[j] += aik*brp[j];
+               }
+            }
          }
-         *cp++ = cij;
-         bcp -= nb-1;                              // Set bcp to the (j+1)-th col
       }
-      arp0 += ncolsa;                             // Set ap to the (i+1)-th row
-   }
+   };
+   TMatrixTParallel::Foreach(multRows,na/ncolsa,2.*na*ncolsb);
 }
 
 ////////////////////////////////////////////////////////////////////////////////
-/// Elementary routine to calculate matrix multiplication A^T*B
+/// Elementary routine to calculate matrix multiplication A^T*B , see AMultB
 
 template<class Element>
 void AtMultB(const Element * const ap,Int_t ncolsa,
              const Element * const bp,Int_t nb,Int_t ncolsb,Element *cp)
 {
-   const Element *acp0 = ap;           // Pointer to  A[i,0];
-   while (acp0 < ap+ncolsa) {
-      for (const Element *bcp = bp; bcp < bp+ncolsb; ) { // Pointer to the j-th column of B, Start bcp = B[0,0]
-         const Element *acp = acp0;                       // Pointer to the i-th column of A, reset to A[0,i]
-         Element cij = 0;
-         while (bcp < bp+nb) {           // Scan the i-th column of A and
-            cij += *acp * *bcp;           // the j-th col of B
-            acp += ncolsa;
-            bcp += ncolsb;
+   if (ncolsa == 0 || ncolsb == 0)
+      return;
+
+   const Int_t kBlock = TMatrixTParallel::kBlock;
+   const Int_t nrowsb = nb/ncolsb;
+   auto multRows = [&](Int_t irow0,Int_t irow1) {
+      std::fill(cp+irow0*ncolsb,cp+irow1*ncolsb,Element(0));
+      for (Int_t k0 = 0; k0 < nrowsb; k0 += kBlock) {
+         const Int_t k1 = std::min(nrowsb,k0+kBlock);
+         for (Int_t j0 = 0; j0 < ncolsb; j0 += 4*kBlock) {
+            const Int_t j1 = std::min(ncolsb,j0+4*kBlock);
+            for (Int_t irow = irow0; irow < irow1; irow++) {
+               Element * const crp = cp+irow*ncolsb;         // Pointer to C[i,0]
+               for (Int_t k = k0; k < k1; k++) {
+                  const Element aki = ap[k*ncolsa+irow];
+                  const Element * const brp = bp+k*ncolsb;   // Pointer to B[k,0]
+                  for (Int_t j = j0; j < j1; j++)
+                     crp[j] += aki*brp[j];
+               }
+            }
          }
-         *cp++ = cij;
-         bcp -= nb-1;                    // Set bcp to the (j+1)-th col
       }
-      acp0++;                           // Set acp0 to the (i+1)-th col
-   }
+   };
+   TMatrixTParallel::Foreach(multRows,ncolsa,2.*ncolsa*nb);
 }
 
 ////////////////////////////////////////////////////////////////////////////////
-/// Elementary routine to calculate matrix multiplication A*B^T
+/// Elementary routine to calculate matrix multiplication A*B^T , see AMultB
 
 template<class Element>
 void AMultBt(const Element * const ap,Int_t na,Int_t ncolsa,
              const Element * const bp,Int_t nb,Int_t ncolsb,Element *cp)
 {
-   const Element *arp0 = ap;                    // Pointer to  A[i,0];
-   while (arp0 < ap+na) {
-      const Element *brp0 = bp;                  // Pointer to  B[j,0];
-      while (brp0 < bp+nb) {
-         const Element *arp = arp0;               // Pointer to the i-th row of A, reset to A[i,0]
-         const Element *brp = brp0;               // Pointer to the j-th row of B, reset to B[j,0]
-         Element cij = 0;
-         while (brp < brp0+ncolsb)                 // Scan the i-th row of A and
-            cij += *arp++ * *brp++;                 // the j-th row of B
-         *cp++ = cij;
-         brp0 += ncolsb;                           // Set brp0 to the (j+1)-th row
+   if (ncolsa == 0 || ncolsb == 0)
+      return;
+
+   const Int_t kBlock = TMatrixTParallel::kBlock;
+   const Int_t nrowsb = nb/ncolsb;
+   auto multRows = [&](Int_t irow0,Int_t irow1) {
+      std::fill(cp+irow0*nrowsb,cp+irow1*nrowsb,Element(0));
+      for (Int_t k0 = 0; k0 < ncolsb; k0 += 4*kBlock) {
+         const Int_t k1 = std::min(ncolsb,k0+4*kBlock);
+         for (Int_t j0 = 0; j0 < nrowsb; j0 += kBlock) {
+            const Int_t j1 = std::min(nrowsb,j0+kBlock);
+            for (Int_t irow = irow0; irow < irow1; irow++) {
+               const Element * const arp = ap+irow*ncolsa;   // Pointer to A[i,0]
+                     Element * const crp = cp+irow*nrowsb;   // Pointer to C[i,0]
+               Int_t j = j0;
+               // four independent sums at a time, to keep the pipeline busy
+               for (; j+4 <= j1; j += 4) {
+                  const Element * const brp = bp+j*ncolsb;   // Pointer to B[j,0]
+                  Element cij0 = crp[j];
+                  Element cij1 = crp[j+1];
+                  Element cij2 = crp[j+2];
+                  Element cij3 = crp[j+3];
+                  for (Int_t k = k0; k < k1; k++) {
+                     const Element aik = arp[k];
+                     cij0 += aik*brp[k];
+                     cij1 += aik*brp[ncolsb+k];
+                     cij2 += aik*brp[2*ncolsb+k];
+                     cij3 += aik*brp[3*ncolsb+k];
+                  }
+                  crp[j]   = cij0;
+                  crp[j+1] = cij1;
+                  crp[j+2] = cij2;
+                  crp[j+3] = cij3;
+               }
+               for (; j < j1; j++) {
+                  const Element * const brp = bp+j*ncolsb;   // Pointer to B[j,0]
+                  Element cij = crp[j];
+                  for (Int_t k = k0; k < k1; k++)
+                     cij += arp[k]*brp[k];
+                  crp[j] = cij;
+               }
+            }
+         }
       }
-      arp0 += ncolsa;                             // Set arp0 to the (i+1)-th row
-   }
+   };
+   TMatrixTParallel::Foreach(multRows,na/ncolsa,2.*na*nrowsb);
 }
 
 ////////////////////////////////////////////////////////////////////////////////
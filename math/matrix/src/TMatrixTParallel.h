@@ -0,0 +1,81 @@
+// @(#)root/matrix:$Id$
+
+/*************************************************************************
+ * Copyright (C) 1995-2018, Rene Brun and Fons Rademakers.               *
+ * All rights reserved.                                                  *
+ *                                                                       *
+ * For the licensing terms see $ROOTSYS/LICENSE.                         *
+ * For the list of contributors see $ROOTSYS/README/CREDITS.             *
+ *************************************************************************/
+
+#ifndef ROOT_TMatrixTParallel
+#define ROOT_TMatrixTParallel
+
+//////////////////////////////////////////////////////////////////////////
+//                                                                      //
+// TMatrixTParallel                                                     //
+//                                                                      //
+// Helpers running the kernels of the linear algebra package on ranges  //
+// of rows (or columns), on several threads when implicit               //
+// multi-threading is enabled and the kernel is large enough.           //
+//                                                                      //
+//////////////////////////////////////////////////////////////////////////
+
+#include "RtypesCore.h"
+#include "RConfigure.h"
+
+#ifdef R__USE_IMT
+#include "ROOT/TThreadExecutor.hxx"
+#include "ROOT/TSeq.hxx"
+#include "TROOT.h"
+#endif
+
+#include <algorithm>
+
+namespace TMatrixTParallel {
+
+   // Minimal number of floating point operations of a kernel to run it on several threads
+   const Double_t kMinWork = 1e6;
+
+   // Number of rows (or columns) of the blocks of the cache-blocked kernels
+   const Int_t kBlock = 64;
+
+   ////////////////////////////////////////////////////////////////////////////////
+   /// Number of ranges in which n rows are split, 1 if the kernel runs on a single thread.
+   /// work is the number of floating point operations of the whole kernel.
+
+   inline Int_t NChunks(Int_t n,Double_t work)
+   {
+#ifdef R__USE_IMT
+      if (n > 1 && work >= kMinWork && ROOT::IsImplicitMTEnabled())
+         return std::min(n,Int_t(4*ROOT::GetImplicitMTPoolSize()));
+#else
+      (void)n;
+      (void)work;
+#endif
+      return 1;
+   }
+
+   ////////////////////////////////////////////////////////////////////////////////
+   /// Call func(begin,end) on consecutive ranges of rows covering [0,n), on
+   /// several threads if NChunks(n,work) > 1. The ranges must be independent.
+
+   template<class F>
+   void Foreach(F func,Int_t n,Double_t work)
+   {
+#ifdef R__USE_IMT
+      const Int_t nChunks = NChunks(n,work);
+      if (nChunks > 1) {
+         const Int_t step = (n+nChunks-1)/nChunks;
+         ROOT::TThreadExecutor pool;
+         pool.Foreach([&](Int_t i) { func(i*step,std::min(n,(i+1)*step)); },ROOT::TSeq<Int_t>(0,(n+step-1)/step));
+         return;
+      }
+#else
+      (void)work;
+#endif
+      func(0,n);
+   }
+}
+
+#endif
@@ -80,10 +80,59 @@
 #include "TMatrixTSparse.h"
 #include "TBuffer.h"
 #include "TMatrixT.h"
+#include "TMatrixTParallel.h"
 #include "TMath.h"
 
+#include <vector>
+
 templateClassImp(TMatrixTSparse);
 
+namespace {
+
+////////////////////////////////////////////////////////////////////////////////
+/// Fill the nrows rows of a sparse matrix. multRow(irow,pColIndex,pData) writes
+/// the (at most ncols) non-zero elements of row irow and returns their number.
+/// The rows are independent: for large products they are computed on several
+/// threads in temporary buffers, which are then copied in order.
+/// Return the number of non-zero elements.
+
+template<class Element,class F>
+Int_t FillSparseRows(F multRow,Int_t nrows,Int_t ncols,Double_t work,
+                     Int_t *pRowIndex,Int_t *pColIndex,Element *pData)
+{
+   Int_t index = 0;
+   if (TMatrixTParallel::NChunks(nrows,work) == 1) {
+      for (Int_t irow = 0; irow < nrows; irow++) {
+         index += multRow(irow,pColIndex+index,pData+index);
+         pRowIndex[irow+1] = index;
+      }
+      return index;
+   }
+
+   std::vector<std::vector<Int_t> > colIndex(nrows);
+   std::vector<std::vector<Element> > data(nrows);
+   auto fillRows = [&](Int_t irow0,Int_t irow1) {
+      std::vector<Int_t> colIndexRow(ncols);
+      std::vector<Element> dataRow(ncols);
+      for (Int_t irow = irow0; irow < irow1; irow++) {
+         const Int_t n = multRow(irow,colIndexRow.data(),dataRow.data());
+         colIndex[irow].assign(colIndexRow.begin(),colIndexRow.begin()+n);
+         data[irow].assign(dataRow.begin(),dataRow.begin()+n);
+      }
+   };
+   TMatrixTParallel::Foreach(fillRows,nrows,work);
+
+   for (Int_t irow = 0; irow < nrows; irow++) {
+      std::copy(colIndex[irow].begin(),colIndex[irow].end(),pColIndex+index);
+      std::copy(data[irow].begin(),data[irow].end(),pData+index);
+      index += colIndex[irow].size();
+      pRowIndex[irow+1] = index;
+   }
+   return index;
+}
+
+}
+
 
 ////////////////////////////////////////////////////////////////////////////////
 /// Space is allocated for row/column indices and data, but the sparse structure
@@ -558,12 +607,12 @@ void TMatrixTSparse<Element>::AMultBt(const TMatrixTSparse<Element> &a,const TMa
 
    const Element * const pDataa = a.GetMatrixArray();
    const Element * const pDatab = b.GetMatrixArray();
-   Element * const pDatac = this->GetMatrixArray();
-   Int_t indexc_r = 0;
-   for (Int_t irowc = 0; irowc < this->GetNrows(); irowc++) {
+   const Int_t ncolsc = this->GetNcols();
+   auto multRow = [&](Int_t irowc,Int_t *pColIndexRow,Element *pDataRow) {
+      Int_t nr = 0;
       const Int_t sIndexa = pRowIndexa[irowc];
       const Int_t eIndexa = pRowIndexa[irowc+1];
-      for (Int_t icolc = 0; icolc < this->GetNcols(); icolc++) {
+      for (Int_t icolc = 0; icolc < ncolsc; icolc++) {
          const Int_t sIndexb = pRowIndexb[icolc];
          const Int_t eIndexb = pRowIndexb[icolc+1];
          Element sum = 0.0;
@@ -579,13 +628,16 @@ void TMatrixTSparse<Element>::AMultBt(const TMatrixTSparse<Element> &a,const TMa
             }
          }
          if (sum != 0.0) {
-            pColIndexc[indexc_r] = icolc;
-            pDatac[indexc_r] = sum;
-            indexc_r++;
+            pColIndexRow[nr] = icolc;
+            pDataRow[nr] = sum;
+            nr++;
          }
       }
-      pRowIndexc[irowc+1] = indexc_r;
-   }
+      return nr;
+   };
+   const Int_t indexc_r = FillSparseRows(multRow,this->GetNrows(),ncolsc,
+                                         2.*(a.GetNoElements()*Double_t(ncolsc)+b.GetNoElements()*Double_t(a.GetNrows())),
+                                         pRowIndexc,pColIndexc,this->GetMatrixArray());
 
    if (constr)
       SetSparseIndex(indexc_r);
@@ -657,26 +709,29 @@ void TMatrixTSparse<Element>::AMultBt(const TMatrixTSparse<Element> &a,const TMa
 
    const Element * const pDataa = a.GetMatrixArray();
    const Element * const pDatab = b.GetMatrixArray();
-   Element * const pDatac = this->GetMatrixArray();
-   Int_t indexc_r = 0;
-   for (Int_t irowc = 0; irowc < this->GetNrows(); irowc++) {
+   const Int_t ncolsb = b.GetNcols();
+   const Int_t ncolsc = this->GetNcols();
+   auto multRow = [&](Int_t irowc,Int_t *pColIndexRow,Element *pDataRow) {
+      Int_t nr = 0;
       const Int_t sIndexa = pRowIndexa[irowc];
       const Int_t eIndexa = pRowIndexa[irowc+1];
-      for (Int_t icolc = 0; icolc < this->GetNcols(); icolc++) {
-         const Int_t off = icolc*b.GetNcols();
+      for (Int_t icolc = 0; icolc < ncolsc; icolc++) {
+         const Int_t off = icolc*ncolsb;
          Element sum = 0.0;
          for (Int_t indexa = sIndexa; indexa < eIndexa; indexa++) {
             const Int_t icola = pColIndexa[indexa];
             sum += pDataa[indexa]*pDatab[off+icola];
          }
          if (sum != 0.0) {
-            pColIndexc[indexc_r] = icolc;
-            pDatac[indexc_r] = sum;
-            indexc_r++;
+            pColIndexRow[nr] = icolc;
+            pDataRow[nr] = sum;
+            nr++;
          }
       }
-      pRowIndexc[irowc+1]= indexc_r;
-   }
+      return nr;
+   };
+   const Int_t indexc_r = FillSparseRows(multRow,this->GetNrows(),ncolsc,2.*a.GetNoElements()*ncolsc,
+                                         pRowIndexc,pColIndexc,this->GetMatrixArray());
 
    if (constr)
       SetSparseIndex(indexc_r);
@@ -749,11 +804,12 @@ void TMatrixTSparse<Element>::AMultBt(const TMatrixT<Element> &a,const TMatrixTS
 
    const Element * const pDataa = a.GetMatrixArray();
    const Element * const pDatab = b.GetMatrixArray();
-   Element * const pDatac = this->GetMatrixArray();
-   Int_t indexc_r = 0;
-   for (Int_t irowc = 0; irowc < this->GetNrows(); irowc++) {
-      const Int_t off = irowc*a.GetNcols();
-      for (Int_t icolc = 0; icolc < this->GetNcols(); icolc++) {
+   const Int_t ncolsa = a.GetNcols();
+   const Int_t ncolsc = this->GetNcols();
+   auto multRow = [&](Int_t irowc,Int_t *pColIndexRow,Element *pDataRow) {
+      Int_t nr = 0;
+      const Int_t off = irowc*ncolsa;
+      for (Int_t icolc = 0; icolc < ncolsc; icolc++) {
          const Int_t sIndexb = pRowIndexb[icolc];
          const Int_t eIndexb = pRowIndexb[icolc+1];
          Element sum = 0.0;
@@ -762,13 +818,15 @@ void TMatrixTSparse<Element>::AMultBt(const TMatrixT<Element> &a,const TMatrixTS
             sum += pDataa[off+icolb]*pDatab[indexb];
          }
          if (sum != 0.0) {
-            pColIndexc[indexc_r] = icolc;
-            pDatac[indexc_r] = sum;
-            indexc_r++;
+            pColIndexRow[nr] = icolc;
+            pDataRow[nr] = sum;
+            nr++;
          }
       }
-      pRowIndexc[irowc+1] = indexc_r;
-   }
+      return nr;
+   };
+   const Int_t indexc_r = FillSparseRows(multRow,this->GetNrows(),ncolsc,2.*a.GetNrows()*b.GetNoElements(),
+                                         pRowIndexc,pColIndexc,this->GetMatrixArray());
 
    if (constr)
       SetSparseIndex(indexc_r);
@@ -0,0 +1,128 @@
+// Tests that the kernels of the matrix package give the same results with and without implicit multi-threading
+
+#include "TDecompChol.h"
+#include "TDecompLU.h"
+#include "TMatrixD.h"
+#include "TMatrixDSparse.h"
+#include "TMatrixDSym.h"
+#include "TMatrixDSymEigen.h"
+#include "TRandom3.h"
+#include "TROOT.h"
+#include "TVectorD.h"
+
+#include "gtest/gtest.h"
+
+// The products run on several threads from about 1e6 floating point operations. The decompositions
+// split each of their steps, which need larger matrices to reach this threshold.
+static const Int_t kNSmall = 200;
+static const Int_t kNMedium = 800;
+static const Int_t kNDecomp = 1500;
+
+static TMatrixD RandomMatrix(Int_t nrows, Int_t ncols, UInt_t seed, Double_t fill = 1.)
+{
+   TRandom3 r(seed);
+   TMatrixD m(nrows, ncols);
+   for (Int_t i = 0; i < nrows; ++i) {
+      for (Int_t j = 0; j < ncols; ++j)
+         m(i, j) = r.Rndm() < fill ? r.Uniform(-1, 1) : 0.;
+   }
+   return m;
+}
+
+// positive definite symmetric matrix
+static TMatrixDSym RandomSymMatrix(Int_t n, UInt_t seed)
+{
+   TMatrixDSym m(TMatrixDSym::kAtA, RandomMatrix(n, n, seed));
+   for (Int_t i = 0; i < n; ++i)
+      m(i, i) += 1.;
+   return m;
+}
+
+static void ExpectEqual(const TMatrixDBase &a, const TMatrixDBase &b)
+{
+   ASSERT_EQ(a.GetNrows(), b.GetNrows());
+   ASSERT_EQ(a.GetNcols(), b.GetNcols());
+   for (Int_t i = 0; i < a.GetNrows(); ++i) {
+      for (Int_t j = 0; j < a.GetNcols(); ++j)
+         EXPECT_EQ(a(i, j), b(i, j)) << "element (" << i << "," << j << ")";
+   }
+}
+
+static void ExpectEqual(const TVectorD &a, const TVectorD &b)
+{
+   ASSERT_EQ(a.GetNrows(), b.GetNrows());
+   for (Int_t i = 0; i < a.GetNrows(); ++i)
+      EXPECT_EQ(a(i), b(i)) << "element " << i;
+}
+
+// compute f() on a single thread and with implicit multi-threading, and compare the results
+template <class F>
+static void ExpectSameWithIMT(F f)
+{
+   ROOT::DisableImplicitMT();
+   const auto serial = f();
+   ROOT::EnableImplicitMT(4);
+   const auto parallel = f();
+   ROOT::DisableImplicitMT();
+   ExpectEqual(serial, parallel);
+}
+
+TEST(MatrixParallel, Products)
+{
+   const TMatrixD a = RandomMatrix(kNSmall, kNSmall + 3, 1);
+   const TMatrixD b = RandomMatrix(kNSmall + 3, kNSmall - 5, 2);
+   const TMatrixD at = RandomMatrix(kNSmall + 3, kNSmall, 3);
+   const TMatrixD bt = RandomMatrix(kNSmall - 5, kNSmall + 3, 4);
+   const TMatrixDSym s = RandomSymMatrix(kNSmall + 3, 5);
+
+   ExpectSameWithIMT([&]() { return TMatrixD(a, TMatrixD::kMult, b); });
+   ExpectSameWithIMT([&]() { return TMatrixD(at, TMatrixD::kTransposeMult, b); });
+   ExpectSameWithIMT([&]() { return TMatrixD(a, TMatrixD::kMultTranspose, bt); });
+   ExpectSameWithIMT([&]() { return TMatrixD(a, TMatrixD::kMult, s); });
+}
+
+TEST(MatrixParallel, SparseProducts)
+{
+   const TMatrixDSparse a(RandomMatrix(kNSmall, kNSmall + 3, 1, 0.2));
+   const TMatrixDSparse bs(RandomMatrix(kNSmall + 3, kNSmall - 5, 2, 0.2));
+   const TMatrixD b = RandomMatrix(kNSmall + 3, kNSmall - 5, 3);
+   const TMatrixD bt = RandomMatrix(kNSmall - 5, kNSmall + 3, 4);
+   const TMatrixD d = RandomMatrix(kNSmall - 5, kNSmall, 5);
+
+   ExpectSameWithIMT([&]() { return TMatrixDSparse(a, TMatrixDSparse::kMult, b); });
+   ExpectSameWithIMT([&]() { return TMatrixDSparse(a, TMatrixDSparse::kMultTranspose, bt); });
+   ExpectSameWithIMT([&]() { return TMatrixDSparse(d, TMatrixDSparse::kMult, a); });
+   ExpectSameWithIMT([&]() { return TMatrixDSparse(a, TMatrixDSparse::kMult, bs); });
+}
+
+TEST(MatrixParallel, Inversion)
+{
+   const TMatrixD a = RandomMatrix(kNDecomp, kNDecomp, 1);
+   ExpectSameWithIMT([&]() {
+      TDecompLU lu(a);
+      TMatrixD inv(kNDecomp, kNDecomp);
+      EXPECT_TRUE(lu.Invert(inv));
+      return inv;
+   });
+   ExpectSameWithIMT([&]() { return TMatrixD(a).Invert(); });
+
+   const TMatrixDSym s = RandomSymMatrix(kNMedium, 2);
+   ExpectSameWithIMT([&]() { return TMatrixDSym(s).Invert(); });
+}
+
+TEST(MatrixParallel, Cholesky)
+{
+   const TMatrixDSym s = RandomSymMatrix(kNDecomp, 1);
+   ExpectSameWithIMT([&]() {
+      TDecompChol chol(s);
+      EXPECT_TRUE(chol.Decompose());
+      return chol.GetU();
+   });
+}
+
+TEST(MatrixParallel, SymEigen)
+{
+   const TMatrixDSym s = RandomSymMatrix(kNMedium, 1);
+   ExpectSameWithIMT([&]() { return TMatrixDSymEigen(s).GetEigenValues(); });
+   ExpectSameWithIMT([&]() { return TMatrixDSymEigen(s).GetEigenVectors(); });
+}
@@ -65,6 +65,10 @@ endif()
 add_library(Minuit2Common INTERFACE)
 add_library(Minuit2::Common ALIAS Minuit2Common)
 
+# Threads are used for the concurrent evaluation of the numerical derivatives
+find_package(Threads REQUIRED)
+target_link_libraries(Minuit2Common INTERFACE Threads::Threads)
+
 # OpenMP support
 if(minuit2_omp)
     if(CMAKE_PROJECT_NAME STREQUAL PROJECT_NAME)
@@ -84,6 +88,14 @@ if(minuit2_mpi)
     target_link_libraries(Minuit2Common INTERFACE MPI::MPI_CXX)
 endif()
 
+# BLAS/LAPACK support (used privately by the Minuit2 library)
+if(minuit2_blas)
+    if(CMAKE_PROJECT_NAME STREQUAL PROJECT_NAME)
+        message(STATUS "Building Minuit2 with BLAS/LAPACK support")
+    endif()
+    find_package(LAPACK REQUIRED)
+endif()
+
 # Add the libraries
 add_subdirectory(src)
 
@@ -157,6 +169,7 @@ endif()
 # Setup package info
 add_feature_info(minuit2_openmp minuit2_openmp "OpenMP (Thread safe FCNs only)")
 add_feature_info(minuit2_mpi minuit2_mpi "MPI (Thread safe FCNs only)")
+add_feature_info(minuit2_blas minuit2_blas "BLAS/LAPACK linear algebra")
 set_package_properties(OpenMP PROPERTIES
     URL "http://www.openmp.org"
     DESCRIPTION "Parallel compiler directives"
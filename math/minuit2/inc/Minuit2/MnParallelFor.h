@@ -0,0 +1,77 @@
+// @(#)root/minuit2:$Id$
+// Authors: M. Winkler, F. James, L. Moneta, A. Zsenei   2003-2005
+
+/**********************************************************************
+ *                                                                    *
+ * Copyright (c) 2005 LCG ROOT Math team,  CERN/PH-SFT                *
+ *                                                                    *
+ **********************************************************************/
+
+#ifndef ROOT_Minuit2_MnParallelFor
+#define ROOT_Minuit2_MnParallelFor
+
+#include <exception>
+#include <thread>
+#include <vector>
+
+namespace ROOT {
+
+   namespace Minuit2 {
+
+/**
+   Return the number of threads to be used for a given user request:
+   0 means all the available hardware threads, and the result is never
+   larger than the number of elements to process.
+ */
+inline unsigned int MnNumberOfThreads(unsigned int nthreads, unsigned int nelements) {
+   if (nthreads == 0) nthreads = std::thread::hardware_concurrency();
+   if (nthreads > nelements) nthreads = nelements;
+   return (nthreads > 0) ? nthreads : 1;
+}
+
+/**
+   Call func(i) for all the indices i in [begin, end) using nthreads
+   concurrent threads (see MnNumberOfThreads). The indices are distributed
+   in an interleaved way among the threads. When a single thread is
+   requested the loop is executed in the calling thread.
+   Func must be safe to call concurrently for different indices; the first
+   exception thrown by a worker is re-thrown in the calling thread.
+ */
+template<class Func>
+void MnParallelFor(unsigned int begin, unsigned int end, unsigned int nthreads, Func func) {
+
+   if (end <= begin) return;
+   nthreads = MnNumberOfThreads(nthreads, end - begin);
+
+   if (nthreads == 1) {
+      for (unsigned int i = begin; i < end; ++i) func(i);
+      return;
+   }
+
+   std::vector<std::exception_ptr> errors(nthreads);
+   auto work = [&](unsigned int ith) {
+      try {
+         for (unsigned int i = begin + ith; i < end; i += nthreads) func(i);
+      }
+      catch (...) {
+         errors[ith] = std::current_exception();
+      }
+   };
+
+   std::vector<std::thread> workers;
+   workers.reserve(nthreads-1);
+   for (unsigned int ith = 1; ith < nthreads; ++ith)
+      workers.emplace_back(work, ith);
+   // the calling thread takes its share
+   work(0);
+   for (auto & w : workers) w.join();
+
+   for (auto & e : errors)
+      if (e) std::rethrow_exception(e);
+}
+
+  }  // namespace Minuit2
+
+}  // namespace ROOT
+
+#endif  // ROOT_Minuit2_MnParallelFor
@@ -49,6 +49,8 @@ public:
 
    int StorageLevel() const { return fStoreLevel; }
 
+   unsigned int NThreads() const { return fNThreads; }
+
    bool IsLow() const {return fStrategy == 0;}
    bool IsMedium() const {return fStrategy == 1;}
    bool IsHigh() const {return fStrategy >= 2;}
@@ -69,6 +71,12 @@ public:
    // set storage level of iteration quantities
    // 0 = store only last iterations 1 = full storage (default)
    void SetStorageLevel(unsigned int level) { fStoreLevel = level; }
+
+   // set number of threads used to evaluate the FCN concurrently in the
+   // numerical gradient and Hessian calculations (1 = serial, the default;
+   // 0 = all available hardware threads).
+   // When different from 1 the FCN must be thread safe
+   void SetNThreads(unsigned int n) { fNThreads = n; }
 private:
 
    unsigned int fStrategy;
@@ -81,6 +89,7 @@ private:
    double fHessTlrG2;
    unsigned int fHessGradNCyc;
    int fStoreLevel;
+   unsigned int fNThreads;
 };
 
   }  // namespace Minuit2
@@ -30,63 +30,6 @@ double inner_product(const LAVector&, const LAVector&);
 double similarity(const LAVector&, const LASymMatrix&);
 double sum_of_elements(const LASymMatrix&);
 
-// define here a square matrix that it is needed for computingthe BFGS update
-//  define just the class, no need for defining operatipons as dane for the Symmetric matrices
-// since the square matrix will be converted in a symmetric one afterwards
-
-class LASquareMatrix {
-public:
-   LASquareMatrix(unsigned int n) :
-      fNRow(n),
-      fData(std::vector<double> (n*n) )
-   {}
-
-   double operator()(unsigned int row, unsigned int col) const {
-      assert(row<fNRow && col < fNRow);
-      return fData[col+row*fNRow];
-   }
-
-   double& operator()(unsigned int row, unsigned int col) {
-      assert(row<fNRow && col < fNRow);
-      return fData[col+row*fNRow];
-   }
-
-   unsigned int Nrow() const { return fNRow; }
-private:
-   unsigned int fNRow;
-   std::vector<double> fData;
-};
-
-// compute outer product of two vector of same size to return a square matrix
-LASquareMatrix OuterProduct(const LAVector& v1, const LAVector& v2) {
-   assert(v1.size() == v2.size() );
-   LASquareMatrix a(v1.size() );
-   for (unsigned int i = 0; i < v1.size() ; ++i) {
-      for (unsigned int j = 0; j < v2.size() ; ++j) {
-         a(i,j) = v1[i]*v2[j];
-      }
-   }
-   return a;
-}
-// compute product of symmetric matrix with square matrix 
-      
-LASquareMatrix MatrixProduct(const LASymMatrix& m1, const LASquareMatrix& m2) {
-   unsigned int n = m1.Nrow();
-   assert(n == m2.Nrow() );
-   LASquareMatrix a( n );
-   for (unsigned int i = 0; i < n ; ++i) {
-      for (unsigned int j = 0; j < n ; ++j) {
-         a(i,j) = 0;
-         for (unsigned int k = 0; k < n ; ++k) {
-            a(i,j) += m1(i,k)*m2(k,j);
-         }
-      }
-   }
-   return a;
-}
-
-
-
 MinimumError BFGSErrorUpdator::Update(const MinimumState& s0,
                                          const MinimumParameters& p1,
                                          const FunctionGradient& g1) const {
@@ -130,22 +73,14 @@ MinimumError BFGSErrorUpdator::Update(const MinimumState& s0,
 
    // compute update formula for BFGS
    // see wikipedia  https://en.wikipedia.org/wiki/Broyden–Fletcher–Goldfarb–Shanno_algorithm
-   // need to compute outer product dg . dx and it is not symmetric anymore
-
-   LASquareMatrix a = OuterProduct(dg,dx);
-   LASquareMatrix b = MatrixProduct(v0, a);
+   // the term (V0*dg*dx' + dx*dg'*V0)/delgam is a symmetric rank-2 update
+   // with the vector V0*dg, so no product of full matrices is needed
 
-   unsigned int n = v0.Nrow(); 
-   MnAlgebraicSymMatrix v2( n );
-   for (unsigned int i = 0; i < n; ++i)  { 
-      for (unsigned int j = i; j < n; ++j)  {
-         v2(i,j) = (b(i,j) + b(j,i))/(delgam);
-      }
-   }
+   MnAlgebraicVector vg = v0*dg;
 
-   MnAlgebraicSymMatrix vUpd = ( delgam + gvg) * Outer_product(dx) / (delgam * delgam);
-   vUpd -= v2; 
-   
+   MnAlgebraicSymMatrix vUpd( v0.Nrow() );
+   Outer_prod(vUpd, dx, (delgam + gvg)/(delgam * delgam));
+   Outer_prod2(vUpd, vg, dx, -1./delgam);
 
    double sum_upd = sum_of_elements(vUpd);
    vUpd += v0;
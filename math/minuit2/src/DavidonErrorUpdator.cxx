@@ -72,11 +72,14 @@ MinimumError DavidonErrorUpdator::Update(const MinimumState& s0,
 
    MnAlgebraicVector vg = v0*dg;
 
-   MnAlgebraicSymMatrix vUpd = Outer_product(dx)/delgam - Outer_product(vg)/gvg;
+   // accumulate the rank-one terms directly in the update matrix
+   MnAlgebraicSymMatrix vUpd( v0.Nrow() );
+   Outer_prod(vUpd, dx, 1./delgam);
+   Outer_prod(vUpd, vg, -1./gvg);
 
    if(delgam > gvg) {
       // use rank 1 formula
-      vUpd += gvg*Outer_product(MnAlgebraicVector(dx/delgam - vg/gvg));
+      Outer_prod(vUpd, MnAlgebraicVector(dx/delgam - vg/gvg), gvg);
    }
 
    double sum_upd = sum_of_elements(vUpd);
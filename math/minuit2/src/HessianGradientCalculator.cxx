@@ -15,6 +15,7 @@
 #include "Minuit2/MinimumParameters.h"
 #include "Minuit2/FunctionGradient.h"
 #include "Minuit2/MnStrategy.h"
+#include "Minuit2/MnParallelFor.h"
 
 #include <math.h>
 
@@ -90,7 +91,8 @@ std::pair<FunctionGradient, MnAlgebraicVector> HessianGradientCalculator::DeltaG
    unsigned int startElementIndex = mpiproc.StartElementIndex();
    unsigned int endElementIndex = mpiproc.EndElementIndex();
 
-   for(unsigned int i = startElementIndex; i < endElementIndex; i++) {
+   // compute the derivative for the parameter i, x is the work vector
+   auto derivative = [&](unsigned int i, MnAlgebraicVector & x) {
       double xtf = x(i);
       double dmin = 4.*Precision().Eps2()*(xtf + Precision().Eps2());
       double epspri = Precision().Eps2() + fabs(grd(i)*Precision().Eps2());
@@ -135,6 +137,19 @@ std::pair<FunctionGradient, MnAlgebraicVector> HessianGradientCalculator::DeltaG
       std::cout << "HGC Param : " << i << "\t new g1 = " << grd(i) << " gstep = " << d << " dgrd = " << dgrd(i) << std::endl;
 #endif
 
+   };
+
+   if (Strategy().NThreads() == 1) {
+      for(unsigned int i = startElementIndex; i < endElementIndex; i++)
+         derivative(i, x);
+   }
+   else {
+      // evaluate the parameters concurrently (requires a thread safe FCN)
+      MnParallelFor(startElementIndex, endElementIndex, Strategy().NThreads(),
+                    [&](unsigned int i) {
+                       MnAlgebraicVector xi = par.Vec();
+                       derivative(i, xi);
+                    } );
    }
 
    mpiproc.SyncVector(grd);
@@ -9,6 +9,7 @@
 
 #include "Minuit2/LAVector.h"
 #include "Minuit2/LASymMatrix.h"
+#include "MnLapack.h"
 
 namespace ROOT {
 
@@ -21,6 +22,20 @@ LAVector eigenvalues(const LASymMatrix& mat) {
    // calculate eigenvalues of symmetric matrices using mneigen function (transalte from fortran Minuit)
    unsigned int nrow = mat.Nrow();
 
+#ifdef MINUIT2_BLAS
+   // use LAPACK directly on the packed matrix (eigenvalues returned in ascending order)
+   {
+      LASymMatrix ap(mat);
+      LAVector result(nrow);
+      LAVector work(3*nrow);
+      int n = nrow;
+      int ldz = 1;
+      int info = 0;
+      dspev_("N", "U", &n, ap.Data(), result.Data(), 0, &ldz, work.Data(), &info);
+      if (info == 0) return result;
+   }
+#endif
+
    LAVector tmp(nrow*nrow);
    LAVector work(2*nrow);
 
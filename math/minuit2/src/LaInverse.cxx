@@ -9,6 +9,9 @@
 
 #include "Minuit2/LaInverse.h"
 #include "Minuit2/LASymMatrix.h"
+#include "MnLapack.h"
+
+#include <cstring>
 
 namespace ROOT {
 
@@ -21,7 +24,7 @@ int mnvert(LASymMatrix& t);
 
 int Invert(LASymMatrix& t) {
    // function for inversion of symmetric matrices using  mnvert function
-   // (from Fortran Minuit)
+   // (from Fortran Minuit) or LAPACK when Minuit2 is built with BLAS support
 
    int ifail = 0;
 
@@ -30,6 +33,17 @@ int Invert(LASymMatrix& t) {
       if(!(tmp > 0.)) ifail = 1;
       else t.Data()[0] = 1./tmp;
    } else {
+#ifdef MINUIT2_BLAS
+      // use the Cholesky decomposition from LAPACK for positive definite matrices
+      // and fall back to mnvert, starting from the original matrix, otherwise
+      LASymMatrix tmp(t);
+      int n = t.Nrow();
+      int info = 0;
+      dpptrf_("U", &n, t.Data(), &info);
+      if (info == 0) dpptri_("U", &n, t.Data(), &info);
+      if (info == 0) return 0;
+      std::memcpy(t.Data(), tmp.Data(), t.size()*sizeof(double));
+#endif
       ifail = mnvert(t);
    }
 
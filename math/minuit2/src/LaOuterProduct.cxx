@@ -10,6 +10,7 @@
 #include "Minuit2/LaOuterProduct.h"
 #include "Minuit2/LAVector.h"
 #include "Minuit2/LASymMatrix.h"
+#include "MnLapack.h"
 
 namespace ROOT {
 
@@ -49,7 +50,37 @@ LASymMatrix& LASymMatrix::operator=(const ABObj<sym, VectorOuterProduct<ABObj<ve
 
 void Outer_prod(LASymMatrix& A, const LAVector& v, double f) {
    // function performing outer product using mndspr (DSPR) routine from BLAS
+   // (or the external BLAS when available)
+#ifdef MINUIT2_BLAS
+   int n = v.size();
+   int incx = 1;
+   dspr_("U", &n, &f, v.Data(), &incx, A.Data());
+#else
    mndspr("U", v.size(), f, v.Data(), 1, A.Data());
+#endif
+}
+
+void Outer_prod2(LASymMatrix& A, const LAVector& v1, const LAVector& v2, double f) {
+   // function performing the symmetric rank-2 update A += f*(v1*v2' + v2*v1')
+   // directly on the packed (upper) storage, using DSPR2 from BLAS when available
+   assert(v1.size() == A.Nrow() && v2.size() == A.Nrow());
+#ifdef MINUIT2_BLAS
+   int n = A.Nrow();
+   int inc = 1;
+   dspr2_("U", &n, &f, v1.Data(), &inc, v2.Data(), &inc, A.Data());
+#else
+   unsigned int n = A.Nrow();
+   const double * x = v1.Data();
+   const double * y = v2.Data();
+   double * ap = A.Data();
+   for (unsigned int j = 0; j < n; ++j) {
+      double fxj = f*x[j];
+      double fyj = f*y[j];
+      double * col = ap + j*(j+1)/2;
+      for (unsigned int i = 0; i <= j; ++i)
+         col[i] += x[i]*fyj + y[i]*fxj;
+   }
+#endif
 }
 
    }  // namespace Minuit2
@@ -76,6 +76,18 @@ void RestoreGlobalPrintLevel(int value) {
    void RestoreGlobalPrintLevel(int ) {}
 #endif
 
+   // set the number of threads for the numerical derivatives from the "NThreads"
+   // Minuit2 option (the FCN must then be thread safe); negative values are rejected
+   static void SetNThreadsFromOptions(const ROOT::Math::IOptions & opt, MnStrategy & strategy) {
+      int nThreads = 0;
+      if (!opt.GetValue("NThreads",nThreads)) return;
+      if (nThreads < 0) {
+         MN_ERROR_VAL2("Minuit2Minimizer: invalid negative NThreads option, it is ignored",nThreads);
+         return;
+      }
+      strategy.SetNThreads(nThreads);
+   }
+
 
 
 
@@ -467,6 +479,8 @@ bool Minuit2Minimizer::Minimize() {
       bool ret = minuit2Opt->GetValue("StorageLevel",storageLevel);
       if (ret) SetStorageLevel(storageLevel);
 
+      SetNThreadsFromOptions(*minuit2Opt, strategy);
+
       if (printLevel > 0) {
          std::cout << "Minuit2Minimizer::Minuit  - Changing default options" << std::endl;
          minuit2Opt->Print();
@@ -1054,7 +1068,13 @@ bool Minuit2Minimizer::Hesse( ) {
    // set the precision if needed
    if (Precision() > 0) fState.SetPrecision(Precision());
 
-   ROOT::Minuit2::MnHesse hesse( strategy );
+   ROOT::Minuit2::MnStrategy mnStrategy(strategy);
+   ROOT::Math::IOptions * minuit2Opt = ROOT::Math::MinimizerOptions::FindDefault("Minuit2");
+   if (minuit2Opt) {
+      SetNThreadsFromOptions(*minuit2Opt, mnStrategy);
+   }
+
+   ROOT::Minuit2::MnHesse hesse( mnStrategy );
 
 
    // case when function minimum exists
@@ -18,6 +18,7 @@
 #include "Minuit2/MinimumState.h"
 #include "Minuit2/VariableMetricEDMEstimator.h"
 #include "Minuit2/FunctionMinimum.h"
+#include "Minuit2/MnParallelFor.h"
 
 //#define DEBUG
 
@@ -30,6 +31,8 @@
 
 #include "Minuit2/MPIProcess.h"
 
+#include <atomic>
+
 namespace ROOT {
 
    namespace Minuit2 {
@@ -130,9 +133,21 @@ MinimumState MnHesse::operator()(const MnFcn& mfcn, const MinimumState& st, cons
 #endif
 
 
-   for(unsigned int i = 0; i < n; i++) {
+   // the matrix returned when the calculation fails
+   auto failedState = [&]() {
+      for(unsigned int j = 0; j < n; j++) {
+         double tmp = g2(j) < prec.Eps2() ? 1. : 1./g2(j);
+         vhmat(j,j) = tmp < prec.Eps2() ? 1. : tmp;
+      }
+      return MinimumState(st.Parameters(), MinimumError(vhmat, MinimumError::MnHesseFailed()), st.Gradient(), st.Edm(), mfcn.NumOfCalls());
+   };
+
+   // second derivative of parameter i, computed around xv (restored on return)
+   // returns 0 on success, 1 if the second derivative is zero and 2 if the
+   // maximum number of calls is exhausted
+   auto diagonal = [&](unsigned int i, MnAlgebraicVector & xv) -> int {
 
-      double xtf = x(i);
+      double xtf = xv(i);
       double dmin = 8.*prec.Eps2()*(fabs(xtf) + prec.Eps2());
       double d = fabs(gst(i));
       if(d < dmin) d = dmin;
@@ -147,11 +162,11 @@ MinimumState MnHesse::operator()(const MnFcn& mfcn, const MinimumState& st, cons
          double fs1 = 0.;
          double fs2 = 0.;
          for(unsigned int multpy = 0; multpy < 5; multpy++) {
-            x(i) = xtf + d;
-            fs1 = mfcn(x);
-            x(i) = xtf - d;
-            fs2 = mfcn(x);
-            x(i) = xtf;
+            xv(i) = xtf + d;
+            fs1 = mfcn(xv);
+            xv(i) = xtf - d;
+            fs2 = mfcn(xv);
+            xv(i) = xtf;
             sag = 0.5*(fs1+fs2-2.*amin);
 
 #ifdef DEBUG
@@ -180,12 +195,7 @@ L26:
          }
 #endif
 
-         for(unsigned int j = 0; j < n; j++) {
-            double tmp = g2(j) < prec.Eps2() ? 1. : 1./g2(j);
-            vhmat(j,j) = tmp < prec.Eps2() ? 1. : tmp;
-         }
-
-         return MinimumState(st.Parameters(), MinimumError(vhmat, MinimumError::MnHesseFailed()), st.Gradient(), st.Edm(), mfcn.NumOfCalls());
+         return 1;
 
 L30:
             double g2bfor = g2(i);
@@ -212,23 +222,37 @@ L30:
          d = std::max(d, 0.1*dlast);
       }
       vhmat(i,i) = g2(i);
-      if(mfcn.NumOfCalls()  > maxcalls) {
+      if(mfcn.NumOfCalls()  > maxcalls) return 2;
+      return 0;
+   };
+
+   int iret = 0;
+   if (fStrategy.NThreads() != 1) {
+      // evaluate the parameters concurrently (requires a thread safe FCN),
+      // each on its own copy of the parameter values
+      std::vector<int> status(n, 0);
+      std::atomic<bool> failed(false);
+      MnParallelFor(0, n, fStrategy.NThreads(),
+                    [&](unsigned int i) {
+                       if (failed) return;
+                       MnAlgebraicVector xi = x;
+                       status[i] = diagonal(i, xi);
+                       if (status[i] != 0) failed = true;
+                    } );
+      for (unsigned int i = 0; i < n && iret == 0; i++) iret = status[i];
+   }
+   else {
+      for (unsigned int i = 0; i < n && iret == 0; i++) iret = diagonal(i, x);
+   }
 
+   if (iret == 2) {
 #ifdef WARNINGMSG
-         //std::cout<<"maxcalls " << maxcalls << " " << mfcn.NumOfCalls() << "  " <<   st.NFcn() << std::endl;
-         MN_INFO_MSG("MnHesse: maximum number of allowed function calls exhausted.");
-         MN_INFO_MSG("MnHesse fails and will return diagonal matrix ");
+      //std::cout<<"maxcalls " << maxcalls << " " << mfcn.NumOfCalls() << "  " <<   st.NFcn() << std::endl;
+      MN_INFO_MSG("MnHesse: maximum number of allowed function calls exhausted.");
+      MN_INFO_MSG("MnHesse fails and will return diagonal matrix ");
 #endif
-
-         for(unsigned int j = 0; j < n; j++) {
-            double tmp = g2(j) < prec.Eps2() ? 1. : 1./g2(j);
-            vhmat(j,j) = tmp < prec.Eps2() ? 1. : tmp;
-         }
-
-         return MinimumState(st.Parameters(), MinimumError(vhmat, MinimumError::MnHesseFailed()), st.Gradient(), st.Edm(), mfcn.NumOfCalls());
-      }
-
    }
+   if (iret != 0) return failedState();
 
 #ifdef DEBUG
    std::cout << "\n Second derivatives " << g2 << std::endl;
@@ -250,31 +274,53 @@ L30:
       unsigned int startParIndexOffDiagonal = mpiprocOffDiagonal.StartElementIndex();
       unsigned int endParIndexOffDiagonal = mpiprocOffDiagonal.EndElementIndex();
 
-      unsigned int offsetVect = 0;
-      for (unsigned int in = 0; in<startParIndexOffDiagonal; in++)
-         if ((in+offsetVect)%(n-1)==0) offsetVect += (in+offsetVect)/(n-1);
+      if (fStrategy.NThreads() != 1) {
+         // evaluate the elements concurrently (requires a thread safe FCN)
+         // the elements are numbered row-wise as in the serial case
+         std::vector<std::pair<unsigned int, unsigned int> > elements;
+         elements.reserve(n*(n-1)/2);
+         for (unsigned int i = 0; i < n; i++)
+            for (unsigned int j = i+1; j < n; j++)
+               elements.push_back(std::make_pair(i,j));
+
+         MnParallelFor(startParIndexOffDiagonal, endParIndexOffDiagonal, fStrategy.NThreads(),
+                       [&](unsigned int in) {
+                          unsigned int i = elements[in].first;
+                          unsigned int j = elements[in].second;
+                          MnAlgebraicVector xij = x;
+                          xij(i) += dirin(i);
+                          xij(j) += dirin(j);
+                          double fs1 = mfcn(xij);
+                          vhmat(i,j) = (fs1 + amin - yy(i) - yy(j))/(dirin(i)*dirin(j));
+                       } );
+      }
+      else {
+         unsigned int offsetVect = 0;
+         for (unsigned int in = 0; in<startParIndexOffDiagonal; in++)
+            if ((in+offsetVect)%(n-1)==0) offsetVect += (in+offsetVect)/(n-1);
 
-      for (unsigned int in = startParIndexOffDiagonal;
-           in<endParIndexOffDiagonal; in++) {
+         for (unsigned int in = startParIndexOffDiagonal;
+              in<endParIndexOffDiagonal; in++) {
 
-         int i = (in+offsetVect)/(n-1);
-         if ((in+offsetVect)%(n-1)==0) offsetVect += i;
-         int j = (in+offsetVect)%(n-1)+1;
+            int i = (in+offsetVect)/(n-1);
+            if ((in+offsetVect)%(n-1)==0) offsetVect += i;
+            int j = (in+offsetVect)%(n-1)+1;
 
-         if ((i+1)==j || in==startParIndexOffDiagonal)
-            x(i) += dirin(i);
+            if ((i+1)==j || in==startParIndexOffDiagonal)
+               x(i) += dirin(i);
 
-         x(j) += dirin(j);
+            x(j) += dirin(j);
 
-         double fs1 = mfcn(x);
-         double elem = (fs1 + amin - yy(i) - yy(j))/(dirin(i)*dirin(j));
-         vhmat(i,j) = elem;
+            double fs1 = mfcn(x);
+            double elem = (fs1 + amin - yy(i) - yy(j))/(dirin(i)*dirin(j));
+            vhmat(i,j) = elem;
 
-         x(j) -= dirin(j);
+            x(j) -= dirin(j);
 
-         if (j%(n-1)==0 || in==endParIndexOffDiagonal-1)
-            x(i) -= dirin(i);
+            if (j%(n-1)==0 || in==endParIndexOffDiagonal-1)
+               x(i) -= dirin(i);
 
+         }
       }
 
       mpiprocOffDiagonal.SyncSymMatrixOffDiagonal(vhmat);
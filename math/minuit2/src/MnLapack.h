@@ -0,0 +1,45 @@
+// @(#)root/minuit2:$Id$
+// Authors: M. Winkler, F. James, L. Moneta, A. Zsenei   2003-2005
+
+/**********************************************************************
+ *                                                                    *
+ * Copyright (c) 2005 LCG ROOT Math team,  CERN/PH-SFT                *
+ *                                                                    *
+ **********************************************************************/
+
+#ifndef ROOT_Minuit2_MnLapack
+#define ROOT_Minuit2_MnLapack
+
+// Declarations of the external BLAS/LAPACK (Fortran interface) routines
+// used when Minuit2 is built with MINUIT2_BLAS (cmake option minuit2_blas).
+// All the symmetric matrices are in the packed upper-triangular format of
+// LASymMatrix, which is the LAPACK "U" packed storage.
+
+#ifdef MINUIT2_BLAS
+
+extern "C" {
+
+   // y := alpha*A*x + beta*y
+   void dspmv_(const char * uplo, const int * n, const double * alpha, const double * ap,
+               const double * x, const int * incx, const double * beta, double * y, const int * incy);
+
+   // A := alpha*x*x' + A
+   void dspr_(const char * uplo, const int * n, const double * alpha, const double * x,
+              const int * incx, double * ap);
+
+   // A := alpha*x*y' + alpha*y*x' + A
+   void dspr2_(const char * uplo, const int * n, const double * alpha, const double * x,
+               const int * incx, const double * y, const int * incy, double * ap);
+
+   // Cholesky factorization and inversion of a positive definite packed matrix
+   void dpptrf_(const char * uplo, const int * n, double * ap, int * info);
+   void dpptri_(const char * uplo, const int * n, double * ap, int * info);
+
+   // eigenvalues (and optionally eigenvectors) of a packed symmetric matrix
+   void dspev_(const char * jobz, const char * uplo, const int * n, double * ap, double * w,
+               double * z, const int * ldz, double * work, int * info);
+}
+
+#endif
+
+#endif  // ROOT_Minuit2_MnLapack
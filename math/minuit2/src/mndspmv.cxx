@@ -12,6 +12,8 @@
    -lf2c -lm   (in that order)
 */
 
+#include "MnLapack.h"
+
 namespace ROOT {
 
    namespace Minuit2 {
@@ -23,6 +25,12 @@ int mnxerbla(const char*, int);
 int Mndspmv(const char* uplo, unsigned int n, double alpha,
             const double* ap, const double* x, int incx, double beta,
             double* y, int incy) {
+#ifdef MINUIT2_BLAS
+   // use the external BLAS implementation
+   int nn = n;
+   dspmv_(uplo, &nn, &alpha, ap, x, &incx, &beta, y, &incy);
+   return 0;
+#else
    /* System generated locals */
    int i__1, i__2;
 
@@ -313,6 +321,7 @@ int Mndspmv(const char* uplo, unsigned int n, double alpha,
    return 0;
 
    /*     End of DSPMV . */
+#endif
 
 } /* dspmv_ */
 
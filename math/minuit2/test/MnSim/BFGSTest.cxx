@@ -0,0 +1,129 @@
+// @(#)root/minuit2:$Id$
+
+/**********************************************************************
+ *                                                                    *
+ * Copyright (c) 2005 LCG ROOT Math team,  CERN/PH-SFT                *
+ *                                                                    *
+ **********************************************************************/
+
+#include "Minuit2/FunctionMinimum.h"
+#include "Minuit2/FCNGradientBase.h"
+#include "Minuit2/MnUserParameterState.h"
+#include "Minuit2/MnUserCovariance.h"
+#include "Minuit2/MnPrint.h"
+#include "Minuit2/VariableMetricMinimizer.h"
+
+#include <cmath>
+#include <iostream>
+#include <vector>
+
+// Minimization of a quadratic form with the BFGS error updator. The covariance
+// it estimates is compared with the known one. Run in the builds with and without
+// the minuit2_blas option, it checks both implementations of the update.
+
+using namespace ROOT::Minuit2;
+
+// chi2 = (x - mean)^T V^-1 (x - mean), where V is the covariance of
+// a first order autoregressive process, whose inverse is tridiagonal
+class QuadFormFCN : public FCNGradientBase {
+
+public:
+
+   QuadFormFCN(unsigned int n, double rho) : fMean(n), fSigma(n), fRho(rho) {
+      for (unsigned int i = 0; i < n; ++i) {
+         fMean[i] = 0.3 * i - 1.;
+         fSigma[i] = 1. + 0.1 * i;
+      }
+   }
+
+   double Covariance(unsigned int i, unsigned int j) const {
+      const unsigned int d = i > j ? i - j : j - i;
+      return fSigma[i] * fSigma[j] * std::pow(fRho, int(d));
+   }
+
+   double operator()(const std::vector<double> &x) const {
+      std::vector<double> g = Gradient(x);
+      double chi2 = 0;
+      for (unsigned int i = 0; i < x.size(); ++i)
+         chi2 += 0.5 * g[i] * (x[i] - fMean[i]);
+      return chi2;
+   }
+
+   // 2 V^-1 (x - mean)
+   std::vector<double> Gradient(const std::vector<double> &x) const {
+      const unsigned int n = x.size();
+      std::vector<double> y(n);
+      for (unsigned int i = 0; i < n; ++i)
+         y[i] = (x[i] - fMean[i]) / fSigma[i];
+      std::vector<double> g(n);
+      const double norm = 2. / (1. - fRho * fRho);
+      for (unsigned int i = 0; i < n; ++i) {
+         double r = (i == 0 || i == n - 1) ? y[i] : (1. + fRho * fRho) * y[i];
+         if (i > 0) r -= fRho * y[i - 1];
+         if (i < n - 1) r -= fRho * y[i + 1];
+         g[i] = norm * r / fSigma[i];
+      }
+      return g;
+   }
+
+   double Up() const { return 1.; }
+
+   const std::vector<double> &Mean() const { return fMean; }
+
+private:
+
+   std::vector<double> fMean;
+   std::vector<double> fSigma;
+   double fRho;
+};
+
+int testBFGS(unsigned int n, double rho) {
+   QuadFormFCN fcn(n, rho);
+   // start from a point which is not along an eigenvector: the exact covariance is then
+   // built by the n updates needed to reach the minimum
+   std::vector<double> par(n);
+   for (unsigned int i = 0; i < n; ++i)
+      par[i] = fcn.Mean()[i] + 2. * std::sin(1.7 * i + 0.5) * std::sqrt(fcn.Covariance(i, i));
+   std::vector<double> err(n, 0.1);
+
+   // strategy 0, so that the covariance is the one of the updator, not the one of Hesse
+   VariableMetricMinimizer minimizer((VariableMetricMinimizer::BFGSType()));
+   FunctionMinimum min = minimizer.Minimize(fcn, par, err, 0, 0, 1.E-6);
+   std::cout << "BFGS minimization of a quadratic form of dimension " << n << " : " << min << std::endl;
+   if (!min.IsValid() || !min.UserState().HasCovariance()) {
+      std::cout << "Error: invalid minimum or no covariance" << std::endl;
+      return 1;
+   }
+
+   int iret = 0;
+   const MnUserCovariance &cov = min.UserState().Covariance();
+   for (unsigned int i = 0; i < n; ++i) {
+      const double sigma = std::sqrt(fcn.Covariance(i, i));
+      if (std::fabs(min.UserState().Value(i) - fcn.Mean()[i]) > 1.E-3 * sigma) {
+         std::cout << "Error: wrong value of parameter " << i << " : " << min.UserState().Value(i)
+                   << " instead of " << fcn.Mean()[i] << std::endl;
+         iret = 2;
+      }
+      for (unsigned int j = 0; j <= i; ++j) {
+         const double ref = fcn.Covariance(i, j);
+         const double scale = sigma * std::sqrt(fcn.Covariance(j, j));
+         if (std::fabs(cov(i, j) - ref) > 0.01 * scale) {
+            std::cout << "Error: wrong covariance (" << i << "," << j << ") : " << cov(i, j)
+                      << " instead of " << ref << std::endl;
+            iret = 3;
+         }
+      }
+   }
+   return iret;
+}
+
+int main() {
+   int iret = testBFGS(5, 0.5);
+   if (iret == 0)
+      iret = testBFGS(10, 0.8);
+   if (iret == 0)
+      iret = testBFGS(20, 0.8);
+   if (iret != 0)
+      std::cerr << "ERROR: BFGSTest failed" << std::endl;
+   return iret;
+}
@@ -0,0 +1,162 @@
+// @(#)root/minuit2:$Id$
+
+/**********************************************************************
+ *                                                                    *
+ * Copyright (c) 2005 LCG ROOT Math team,  CERN/PH-SFT                *
+ *                                                                    *
+ **********************************************************************/
+
+#include "Minuit2/FCNBase.h"
+#include "Minuit2/FunctionGradient.h"
+#include "Minuit2/FunctionMinimum.h"
+#include "Minuit2/HessianGradientCalculator.h"
+#include "Minuit2/MinimumParameters.h"
+#include "Minuit2/MnHesse.h"
+#include "Minuit2/MnMigrad.h"
+#include "Minuit2/MnStrategy.h"
+#include "Minuit2/MnUserFcn.h"
+#include "Minuit2/MnUserParameterState.h"
+#include "Minuit2/Numerical2PGradientCalculator.h"
+
+#include <cmath>
+#include <iostream>
+#include <string>
+#include <vector>
+
+// Comparison of the numerical derivatives computed with several threads
+// (MnStrategy::SetNThreads) with the serial ones: the gradient, its refinement
+// for Hesse, the Hessian matrix and a full minimization. Each parameter is
+// computed by the same code in both cases, so the results must agree.
+
+using namespace ROOT::Minuit2;
+
+// a generalized Rosenbrock function, with a coupling between all the
+// parameters, so that the Hessian has no zero element
+class CoupledRosenbrockFCN : public FCNBase {
+
+public:
+
+   double operator()(const std::vector<double> &x) const {
+      double f = 0;
+      double sum = 0;
+      for (unsigned int i = 0; i < x.size(); ++i) {
+         sum += x[i];
+         if (i + 1 < x.size())
+            f += 100. * (x[i + 1] - x[i] * x[i]) * (x[i + 1] - x[i] * x[i]) + (1. - x[i]) * (1. - x[i]);
+      }
+      return f + 0.1 * (sum - x.size()) * (sum - x.size());
+   }
+
+   double Up() const { return 1.; }
+};
+
+// initial state, with limits on some of the parameters to check the transformations
+MnUserParameterState InitialState(unsigned int n) {
+   MnUserParameterState state;
+   for (unsigned int i = 0; i < n; ++i) {
+      const std::string name = "x" + std::to_string(i);
+      const double val = 0.8 + 0.05 * std::sin(1.3 * i);
+      if (i % 3 == 1)
+         state.Add(name, val, 0.1, -2., 3.);
+      else
+         state.Add(name, val, 0.1);
+   }
+   return state;
+}
+
+bool IsSame(double a, double b, double tol, const char *what, unsigned int i, unsigned int nthreads) {
+   if (std::fabs(a - b) <= tol * std::fabs(b))
+      return true;
+   std::cout << "Error: different " << what << " for parameter " << i << " with " << nthreads
+             << " threads : " << a << " instead of " << b << std::endl;
+   return false;
+}
+
+int testGradient(unsigned int n, unsigned int nthreads) {
+   CoupledRosenbrockFCN fcn;
+   MnUserParameterState state = InitialState(n);
+   MnUserFcn mfcn(fcn, state.Trafo());
+   MnAlgebraicVector x(n);
+   for (unsigned int i = 0; i < n; ++i)
+      x(i) = state.IntParameters()[i];
+   MinimumParameters par(x, mfcn(x));
+
+   MnStrategy serial(2);
+   MnStrategy parallel(2);
+   parallel.SetNThreads(nthreads);
+
+   int iret = 0;
+
+   // the gradients are computed by the same operations, they must be identical
+   FunctionGradient g1 = Numerical2PGradientCalculator(mfcn, state.Trafo(), serial)(par);
+   FunctionGradient gn = Numerical2PGradientCalculator(mfcn, state.Trafo(), parallel)(par);
+   for (unsigned int i = 0; i < n; ++i) {
+      if (!IsSame(gn.Grad()(i), g1.Grad()(i), 0., "gradient", i, nthreads) ||
+          !IsSame(gn.G2()(i), g1.G2()(i), 0., "second derivative", i, nthreads) ||
+          !IsSame(gn.Gstep()(i), g1.Gstep()(i), 0., "gradient step", i, nthreads))
+         iret = 1;
+   }
+
+   FunctionGradient h1 = HessianGradientCalculator(mfcn, state.Trafo(), serial)(par, g1);
+   FunctionGradient hn = HessianGradientCalculator(mfcn, state.Trafo(), parallel)(par, g1);
+   for (unsigned int i = 0; i < n; ++i) {
+      if (!IsSame(hn.Grad()(i), h1.Grad()(i), 0., "Hesse gradient", i, nthreads) ||
+          !IsSame(hn.Gstep()(i), h1.Gstep()(i), 0., "Hesse gradient step", i, nthreads))
+         iret = 2;
+   }
+
+   // the serial Hesse moves the point along the parameters back and forth, which
+   // can change the last bits of the off-diagonal elements
+   MnUserParameterState hesse1 = MnHesse(serial)(fcn, state);
+   MnUserParameterState hessen = MnHesse(parallel)(fcn, state);
+   if (!hesse1.HasCovariance() || !hessen.HasCovariance()) {
+      std::cout << "Error: Hesse failed with " << nthreads << " threads" << std::endl;
+      return 3;
+   }
+   for (unsigned int i = 0; i < n; ++i) {
+      for (unsigned int j = 0; j <= i; ++j) {
+         const double scale = std::sqrt(hesse1.Covariance()(i, i) * hesse1.Covariance()(j, j));
+         if (std::fabs(hessen.Covariance()(i, j) - hesse1.Covariance()(i, j)) > 1.E-8 * scale) {
+            std::cout << "Error: different Hesse covariance (" << i << "," << j << ") with " << nthreads
+                      << " threads : " << hessen.Covariance()(i, j) << " instead of " << hesse1.Covariance()(i, j)
+                      << std::endl;
+            iret = 3;
+         }
+      }
+   }
+
+   // the minimizations follow the same path
+   FunctionMinimum min1 = MnMigrad(fcn, state, serial)();
+   FunctionMinimum minn = MnMigrad(fcn, state, parallel)();
+   if (!min1.IsValid() || !minn.IsValid()) {
+      std::cout << "Error: invalid minimum with " << nthreads << " threads" << std::endl;
+      return 4;
+   }
+   if (!IsSame(minn.Fval(), min1.Fval(), 1.E-8, "minimum", 0, nthreads))
+      iret = 4;
+   for (unsigned int i = 0; i < n; ++i) {
+      if (!IsSame(minn.UserState().Value(i), min1.UserState().Value(i), 1.E-6, "value at the minimum", i,
+                  nthreads))
+         iret = 4;
+   }
+
+   return iret;
+}
+
+int main() {
+   int iret = 0;
+   // 0 means all the hardware threads
+   const unsigned int nthreads[] = {2, 3, 0};
+   for (unsigned int nt : nthreads) {
+      for (unsigned int n : {1u, 5u, 12u}) {
+         int ret = testGradient(n, nt);
+         if (ret != 0) {
+            std::cout << "Error: test of dimension " << n << " with " << nt << " threads failed" << std::endl;
+            iret = ret;
+         }
+      }
+   }
+   if (iret != 0)
+      std::cerr << "ERROR: GradientTest failed" << std::endl;
+   return iret;
+}
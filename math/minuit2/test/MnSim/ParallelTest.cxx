@@ -14,6 +14,8 @@
 #include "Minuit2/MnPrint.h"
 #include "Minuit2/MnMigrad.h"
 #include "Minuit2/MnMinos.h"
+#include "Minuit2/MnHesse.h"
+#include "Minuit2/MnStrategy.h"
 #include "Minuit2/MnPlot.h"
 #include "Minuit2/MinosError.h"
 #include "Minuit2/FCNBase.h"
@@ -24,14 +26,18 @@
 // to speed up the result
 // define the environment variable OMP_NUM_THREADS to the number of desired threads
 // By default it will have thenumber of core of the machine
+// When OpenMP is not used the number of threads for the numerical derivatives is set
+// in MnStrategy (default is 1, i.e. serial, and 0 means all the hardware threads); this
+// test uses 2 threads by default
 // The default number of dimension is 20 (fit in 40 parameters) on 1000 data events.
-// One can change the dimension and the number of events by doing:
-// ./test_Minuit2_Parallel    ndim  nevents
+// One can change the dimension, the number of events and the number of threads by doing:
+// ./test_Minuit2_Parallel    ndim  nevents  nthreads
 
 using namespace ROOT::Minuit2;
 
 const int default_ndim = 20;
 const int default_ndata = 1000;
+const int default_nthreads = 2;
 
 
 double GaussPdf(double x, double x0, double sigma) {
@@ -70,7 +76,7 @@ struct LogLikeFCN  : public FCNBase {
    const Data & fData;
 };
 
-int doFit(int ndim, int ndata) {
+int doFit(int ndim, int ndata, int nthreads) {
 
   // generate the data (1000 data points) in 100 dimension
 
@@ -107,15 +113,36 @@ int doFit(int ndim, int ndata) {
   for (int k = 0; k < 2*ndim; ++k) {
      init_err[k] = 0.1;
   }
-  // create minimizer (default constructor)
-  VariableMetricMinimizer fMinimizer;
+  // evaluate the numerical derivatives concurrently (the FCN is thread safe)
+  MnStrategy strategy(1);
+  strategy.SetNThreads(nthreads);
 
   // Minimize
-  FunctionMinimum min = fMinimizer.Minimize(fcn, init_par, init_err);
+  MnMigrad migrad(fcn, MnUserParameterState(init_par, init_err), strategy);
+  FunctionMinimum min = migrad();
 
   // output
   std::cout<<"minimum: "<<min<<std::endl;
 
+  // compare the parallel Hessian with the serial one
+  MnHesse hesse(strategy);
+  MnUserParameterState state = hesse(fcn, min.UserParameters());
+  MnStrategy serialStrategy(1);
+  MnHesse serialHesse(serialStrategy);
+  MnUserParameterState serialState = serialHesse(fcn, min.UserParameters());
+
+  int iret = 0;
+  if (!min.IsValid() || !state.HasCovariance()) iret = 1;
+  for (int i = 0; i < 2*ndim; ++i) {
+     double err = state.Error(i);
+     double serialErr = serialState.Error(i);
+     if (std::fabs(err - serialErr) > 1.E-6 * std::fabs(serialErr)) {
+        std::cout << "Error: different Hesse error for parameter " << i << " : "
+                  << err << "  " << serialErr << std::endl;
+        iret = 2;
+     }
+  }
+
 
 //     // create MINOS Error factory
 //     MnMinos Minos(fFCN, min);
@@ -141,18 +168,23 @@ int doFit(int ndim, int ndata) {
 //   }
 
 
-  return 0;
+  return iret;
 }
 
 int main(int argc, char **argv) {
    int ndim = default_ndim;
    int ndata = default_ndata;
+   int nthreads = default_nthreads;
    if (argc > 1) {
       ndim = atoi(argv[1] );
    }
    if (argc > 2) {
       ndata = atoi(argv[2] );
    }
-   std::cout << "do fit of " << ndim << " dimensional data on " << ndata << " events " << std::endl;
-   doFit(ndim,ndata);
+   if (argc > 3) {
+      nthreads = atoi(argv[3] );
+   }
+   std::cout << "do fit of " << ndim << " dimensional data on " << ndata << " events "
+             << " using " << nthreads << " threads " << std::endl;
+   return doFit(ndim,ndata,nthreads);
 }
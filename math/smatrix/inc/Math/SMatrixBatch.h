@@ -0,0 +1,565 @@
+// @(#)root/smatrix:$Id$
+
+/**********************************************************************
+ *                                                                    *
+ * Copyright (c) 2018 , LCG ROOT MathLib Team                         *
+ *                                                                    *
+ *                                                                    *
+ **********************************************************************/
+
+#ifndef ROOT_Math_SMatrixBatch
+#define ROOT_Math_SMatrixBatch
+
+/** @file
+ * header file containing the classes SMatrixBatch and SVectorBatch, storing
+ * many SMatrix and SVector objects of the same type interleaved in memory,
+ * and the operations acting on all the elements of a batch at once
+ */
+
+#include "Math/SMatrix.h"
+
+#include "Math/SVector.h"
+
+#include "Math/Types.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <stdexcept>
+#include <vector>
+
+namespace ROOT {
+
+namespace Math {
+
+/// helpers for SMatrixBatch and SVectorBatch
+namespace SMatrixBatchHelpers {
+
+/// SIMD vector type used to process the batches of a given scalar type
+template <class T>
+struct SIMDType;
+
+template <>
+struct SIMDType<double> {
+   typedef ROOT::Double_v Type;
+};
+
+template <>
+struct SIMDType<float> {
+   typedef ROOT::Float_v Type;
+};
+
+#ifdef R__HAS_VECCORE
+
+template <class V>
+inline std::size_t VectorSize() { return vecCore::VectorSize<V>(); }
+
+template <class V, class T>
+inline void Load(V &v, const T *p) { vecCore::Load(v, p); }
+
+template <class V, class T>
+inline void Store(const V &v, T *p) { vecCore::Store(v, p); }
+
+template <class V>
+inline typename vecCore::ScalarType<V>::Type Lane(const V &v, std::size_t i) { return vecCore::Get(v, i); }
+
+template <class V, class M>
+inline V Select(const M &mask, const V &a, const V &b) { return vecCore::Blend(mask, a, b); }
+
+using vecCore::math::Sqrt;
+
+#else
+
+template <class V>
+inline std::size_t VectorSize() { return 1; }
+
+template <class V, class T>
+inline void Load(V &v, const T *p) { v = *p; }
+
+template <class V, class T>
+inline void Store(const V &v, T *p) { *p = v; }
+
+template <class V>
+inline V Lane(const V &v, std::size_t) { return v; }
+
+template <class V>
+inline V Select(bool mask, const V &a, const V &b) { return mask ? a : b; }
+
+template <class T> inline T Sqrt(T x) { return std::sqrt(x); }
+
+#endif
+
+/// representation R of a matrix of scalars, for a matrix of SIMD vectors V
+template <class R, class V>
+struct RebindRep;
+
+template <class T, unsigned int D1, unsigned int D2, class V>
+struct RebindRep<MatRepStd<T, D1, D2>, V> {
+   typedef MatRepStd<V, D1, D2> Type;
+};
+
+template <class T, unsigned int D, class V>
+struct RebindRep<MatRepSym<T, D>, V> {
+   typedef MatRepSym<V, D> Type;
+};
+
+/**
+   Storage of n objects of N scalars each. The objects are grouped in blocks
+   of VectorSize consecutive objects, and the element k of the objects of a
+   block are contiguous, so that they can be loaded in a single SIMD vector.
+   The last block is padded with zeros.
+ */
+template <class T, unsigned int N>
+class BatchStorage {
+public:
+   typedef typename SIMDType<T>::Type SIMD_t;
+
+   explicit BatchStorage(std::size_t n = 0) : fSize(0) { Resize(n); }
+
+   /// number of objects per block
+   static std::size_t BlockSize() { return VectorSize<SIMD_t>(); }
+
+   std::size_t Size() const { return fSize; }
+
+   std::size_t NBlocks() const { return (fSize + BlockSize() - 1) / BlockSize(); }
+
+   void Resize(std::size_t n)
+   {
+      const std::size_t oldSize = fSize;
+      fSize = n;
+      fData.resize(NBlocks() * N * BlockSize(), T(0));
+      // the objects removed from the last block are reset, to keep its padding null
+      const std::size_t end = std::min(oldSize, NBlocks() * BlockSize());
+      for (std::size_t i = n; i < end; ++i) {
+         for (unsigned int k = 0; k < N; ++k)
+            *Element(i, k) = T(0);
+      }
+   }
+
+   /// copy the N scalars of object i to a
+   void Get(std::size_t i, T *a) const
+   {
+      const T *p = Element(i, 0);
+      for (unsigned int k = 0; k < N; ++k)
+         a[k] = p[k * BlockSize()];
+   }
+
+   /// set the N scalars of object i from a
+   void Set(std::size_t i, const T *a)
+   {
+      T *p = Element(i, 0);
+      for (unsigned int k = 0; k < N; ++k)
+         p[k * BlockSize()] = a[k];
+   }
+
+   /// load the N SIMD vectors of block b into a
+   void GetBlock(std::size_t b, SIMD_t *a) const
+   {
+      const T *p = &fData[b * N * BlockSize()];
+      for (unsigned int k = 0; k < N; ++k)
+         Load(a[k], p + k * BlockSize());
+   }
+
+   /// store the N SIMD vectors of a into block b
+   void SetBlock(std::size_t b, const SIMD_t *a)
+   {
+      T *p = &fData[b * N * BlockSize()];
+      for (unsigned int k = 0; k < N; ++k)
+         Store(a[k], p + k * BlockSize());
+   }
+
+private:
+   const T *Element(std::size_t i, unsigned int k) const
+   {
+      return &fData[((i / BlockSize()) * N + k) * BlockSize() + i % BlockSize()];
+   }
+   T *Element(std::size_t i, unsigned int k)
+   {
+      return &fData[((i / BlockSize()) * N + k) * BlockSize() + i % BlockSize()];
+   }
+
+   std::size_t fSize;
+   std::vector<T> fData;
+};
+
+/// throw if the sizes n1 and n2 of the two operands of an operation on batches differ
+inline void CheckSizes(std::size_t n1, std::size_t n2)
+{
+   if (n1 != n2)
+      throw std::invalid_argument("Operation on batches of matrices or vectors of different sizes");
+}
+
+/**
+   Inversion of the symmetric positive definite matrix m by Cholesky
+   decomposition, without branches so that it works on matrices of SIMD
+   vectors. The matrices which are not positive definite are left unchanged.
+   Return a vector whose lanes are 1 for the inverted matrices, 0 otherwise.
+ */
+template <class T, class V, unsigned int D, class R>
+V InvertChol(SMatrix<V, D, D, R> &m)
+{
+   const V zero(T(0));
+   const V one(T(1));
+   // lower triangular L with A = L * L^T and its inverse, packed by rows,
+   // with the inverse of the diagonal elements of L
+   V l[D * (D + 1) / 2];
+   V linv[D * (D + 1) / 2];
+   V invDiag[D];
+   V ok(one);
+   for (unsigned int i = 0; i < D; ++i) {
+      for (unsigned int j = 0; j <= i; ++j) {
+         V s = m(i, j);
+         for (unsigned int k = 0; k < j; ++k)
+            s -= l[i * (i + 1) / 2 + k] * l[j * (j + 1) / 2 + k];
+         if (j < i) {
+            l[i * (i + 1) / 2 + j] = s * invDiag[j];
+         } else {
+            ok = Select(s > zero, ok, zero);
+            // the failing lanes continue with a unit pivot
+            invDiag[i] = one / Sqrt(Select(s > zero, s, one));
+            l[i * (i + 1) / 2 + i] = one / invDiag[i];
+         }
+      }
+   }
+   for (unsigned int i = 0; i < D; ++i) {
+      linv[i * (i + 1) / 2 + i] = invDiag[i];
+      for (unsigned int j = 0; j < i; ++j) {
+         V s = zero;
+         for (unsigned int k = j; k < i; ++k)
+            s += l[i * (i + 1) / 2 + k] * linv[k * (k + 1) / 2 + j];
+         linv[i * (i + 1) / 2 + j] = -invDiag[i] * s;
+      }
+   }
+   // A^-1 = L^-T * L^-1
+   for (unsigned int i = 0; i < D; ++i) {
+      for (unsigned int j = 0; j <= i; ++j) {
+         V s = zero;
+         for (unsigned int k = i; k < D; ++k)
+            s += linv[k * (k + 1) / 2 + i] * linv[k * (k + 1) / 2 + j];
+         const V inv = Select(ok > zero, s, m(i, j));
+         m(i, j) = inv;
+         m(j, i) = inv;
+      }
+   }
+   return ok;
+}
+
+} // namespace SMatrixBatchHelpers
+
+/**
+   Batch of n SMatrix<T,D1,D2,R>, stored interleaved so that the operations on
+   all the matrices of the batch are computed using the SIMD vectors
+   ROOT::Double_v (ROOT::Float_v for float matrices) of the VecCore backend
+   ROOT was built with. Without VecCore the matrices are processed one by one.
+
+   The matrices are processed by blocks of BlockSize() matrices, each block
+   being loaded in a SMatrix<SIMD_t,D1,D2> on which all the SMatrix
+   operations are available.
+
+   Usage example, for the covariance matrices of many track states:
+   @code
+   SMatrixBatch<double, 5, 5, MatRepSym<double, 5> > cov(n);
+   for (std::size_t i = 0; i < n; ++i)
+      cov.Set(i, covariance[i]);
+   SMatrixBatch<double, 5> jacobian = ...;
+   auto propagated = Similarity(jacobian, cov);
+   bool ok = propagated.InvertChol();
+   @endcode
+
+   @ingroup SMatrixSVector
+ */
+template <class T, unsigned int D1, unsigned int D2 = D1, class R = MatRepStd<T, D1, D2> >
+class SMatrixBatch {
+public:
+   /** contained scalar type */
+   typedef T value_type;
+
+   /** storage representation type */
+   typedef R rep_type;
+
+   /** type of the elements of the batch */
+   typedef SMatrix<T, D1, D2, R> SMatrix_t;
+
+   /** SIMD vector type */
+   typedef typename SMatrixBatchHelpers::SIMDType<T>::Type SIMD_t;
+
+   /** type of a block of matrices */
+   typedef SMatrix<SIMD_t, D1, D2, typename SMatrixBatchHelpers::RebindRep<R, SIMD_t>::Type> Block_t;
+
+   /**
+      Construct a batch of n null matrices
+   */
+   explicit SMatrixBatch(std::size_t n = 0) : fStorage(n) {}
+
+   /** number of matrices */
+   std::size_t size() const { return fStorage.Size(); }
+
+   bool empty() const { return size() == 0; }
+
+   /** change the number of matrices, the new matrices are null */
+   void resize(std::size_t n) { fStorage.Resize(n); }
+
+   /** matrix i */
+   SMatrix_t Get(std::size_t i) const
+   {
+      SMatrix_t m(SMatrixNoInit{});
+      fStorage.Get(i, m.Array());
+      return m;
+   }
+
+   SMatrix_t operator[](std::size_t i) const { return Get(i); }
+
+   /** set the matrix i */
+   void Set(std::size_t i, const SMatrix_t &m) { fStorage.Set(i, m.Array()); }
+
+   /** number of matrices per block */
+   static std::size_t BlockSize() { return SMatrixBatchHelpers::BatchStorage<T, R::kSize>::BlockSize(); }
+
+   /** number of blocks, the last one being padded with null matrices */
+   std::size_t NBlocks() const { return fStorage.NBlocks(); }
+
+   /** block b, containing the matrices b * BlockSize() to (b + 1) * BlockSize() - 1 */
+   Block_t GetBlock(std::size_t b) const
+   {
+      Block_t m(SMatrixNoInit{});
+      fStorage.GetBlock(b, m.Array());
+      return m;
+   }
+
+   /** set the block b */
+   void SetBlock(std::size_t b, const Block_t &m) { fStorage.SetBlock(b, m.Array()); }
+
+   /**
+      Invert the symmetric positive definite matrices by Cholesky decomposition,
+      vectorised across the batch. The matrices which are not positive definite
+      are left unchanged.
+      \return true if all the matrices have been inverted
+   */
+   bool InvertChol()
+   {
+      STATIC_CHECK(D1 == D2, SMatrix_not_square);
+      bool ok = true;
+      for (std::size_t b = 0; b < NBlocks(); ++b) {
+         Block_t m = GetBlock(b);
+         const SIMD_t inverted = SMatrixBatchHelpers::InvertChol<T>(m);
+         SetBlock(b, m);
+         for (std::size_t l = 0; l < BlockSize() && b * BlockSize() + l < size(); ++l)
+            ok = ok && SMatrixBatchHelpers::Lane(inverted, l) > 0;
+      }
+      return ok;
+   }
+
+   /**
+      Invert the matrices one by one with SMatrix::Invert, for the matrices
+      which are not positive definite. The matrices which cannot be inverted
+      are left unchanged.
+      \return true if all the matrices have been inverted
+   */
+   bool Invert()
+   {
+      bool ok = true;
+      for (std::size_t i = 0; i < size(); ++i) {
+         SMatrix_t m = Get(i);
+         if (m.Invert())
+            Set(i, m);
+         else
+            ok = false;
+      }
+      return ok;
+   }
+
+private:
+   SMatrixBatchHelpers::BatchStorage<T, R::kSize> fStorage;
+};
+
+/**
+   Batch of n SVector<T,D>, stored interleaved like the matrices of a SMatrixBatch
+
+   @ingroup SMatrixSVector
+ */
+template <class T, unsigned int D>
+class SVectorBatch {
+public:
+   /** contained scalar type */
+   typedef T value_type;
+
+   /** type of the elements of the batch */
+   typedef SVector<T, D> SVector_t;
+
+   /** SIMD vector type */
+   typedef typename SMatrixBatchHelpers::SIMDType<T>::Type SIMD_t;
+
+   /** type of a block of vectors */
+   typedef SVector<SIMD_t, D> Block_t;
+
+   /**
+      Construct a batch of n null vectors
+   */
+   explicit SVectorBatch(std::size_t n = 0) : fStorage(n) {}
+
+   /** number of vectors */
+   std::size_t size() const { return fStorage.Size(); }
+
+   bool empty() const { return size() == 0; }
+
+   /** change the number of vectors, the new vectors are null */
+   void resize(std::size_t n) { fStorage.Resize(n); }
+
+   /** vector i */
+   SVector_t Get(std::size_t i) const
+   {
+      SVector_t v;
+      fStorage.Get(i, v.Array());
+      return v;
+   }
+
+   SVector_t operator[](std::size_t i) const { return Get(i); }
+
+   /** set the vector i */
+   void Set(std::size_t i, const SVector_t &v) { fStorage.Set(i, v.Array()); }
+
+   /** number of vectors per block */
+   static std::size_t BlockSize() { return SMatrixBatchHelpers::BatchStorage<T, D>::BlockSize(); }
+
+   /** number of blocks, the last one being padded with null vectors */
+   std::size_t NBlocks() const { return fStorage.NBlocks(); }
+
+   /** block b, containing the vectors b * BlockSize() to (b + 1) * BlockSize() - 1 */
+   Block_t GetBlock(std::size_t b) const
+   {
+      Block_t v;
+      fStorage.GetBlock(b, v.Array());
+      return v;
+   }
+
+   /** set the block b */
+   void SetBlock(std::size_t b, const Block_t &v) { fStorage.SetBlock(b, v.Array()); }
+
+private:
+   SMatrixBatchHelpers::BatchStorage<T, D> fStorage;
+};
+
+// Operations on batches of matrices and vectors, computed block by block.
+// The operands must have the same size, std::invalid_argument is thrown otherwise.
+
+/// matrix sums: A_i + B_i
+template <class T, unsigned int D1, unsigned int D2, class R>
+SMatrixBatch<T, D1, D2, R> operator+(const SMatrixBatch<T, D1, D2, R> &a, const SMatrixBatch<T, D1, D2, R> &b)
+{
+   SMatrixBatchHelpers::CheckSizes(a.size(), b.size());
+   SMatrixBatch<T, D1, D2, R> ret(a.size());
+   for (std::size_t i = 0; i < ret.NBlocks(); ++i)
+      ret.SetBlock(i, a.GetBlock(i) + b.GetBlock(i));
+   return ret;
+}
+
+/// matrix differences: A_i - B_i
+template <class T, unsigned int D1, unsigned int D2, class R>
+SMatrixBatch<T, D1, D2, R> operator-(const SMatrixBatch<T, D1, D2, R> &a, const SMatrixBatch<T, D1, D2, R> &b)
+{
+   SMatrixBatchHelpers::CheckSizes(a.size(), b.size());
+   SMatrixBatch<T, D1, D2, R> ret(a.size());
+   for (std::size_t i = 0; i < ret.NBlocks(); ++i)
+      ret.SetBlock(i, a.GetBlock(i) - b.GetBlock(i));
+   return ret;
+}
+
+/// matrix products: A_i * B_i
+template <class T, unsigned int D1, unsigned int D, unsigned int D2, class R1, class R2>
+SMatrixBatch<T, D1, D2> operator*(const SMatrixBatch<T, D1, D, R1> &a, const SMatrixBatch<T, D, D2, R2> &b)
+{
+   SMatrixBatchHelpers::CheckSizes(a.size(), b.size());
+   SMatrixBatch<T, D1, D2> ret(a.size());
+   for (std::size_t i = 0; i < ret.NBlocks(); ++i)
+      ret.SetBlock(i, a.GetBlock(i) * b.GetBlock(i));
+   return ret;
+}
+
+/// matrix-vector products: A_i * v_i
+template <class T, unsigned int D1, unsigned int D2, class R>
+SVectorBatch<T, D1> operator*(const SMatrixBatch<T, D1, D2, R> &a, const SVectorBatch<T, D2> &v)
+{
+   SMatrixBatchHelpers::CheckSizes(a.size(), v.size());
+   SVectorBatch<T, D1> ret(a.size());
+   for (std::size_t i = 0; i < ret.NBlocks(); ++i)
+      ret.SetBlock(i, a.GetBlock(i) * v.GetBlock(i));
+   return ret;
+}
+
+/// vector sums: u_i + v_i
+template <class T, unsigned int D>
+SVectorBatch<T, D> operator+(const SVectorBatch<T, D> &u, const SVectorBatch<T, D> &v)
+{
+   SMatrixBatchHelpers::CheckSizes(u.size(), v.size());
+   SVectorBatch<T, D> ret(u.size());
+   for (std::size_t i = 0; i < ret.NBlocks(); ++i)
+      ret.SetBlock(i, u.GetBlock(i) + v.GetBlock(i));
+   return ret;
+}
+
+/// vector differences: u_i - v_i
+template <class T, unsigned int D>
+SVectorBatch<T, D> operator-(const SVectorBatch<T, D> &u, const SVectorBatch<T, D> &v)
+{
+   SMatrixBatchHelpers::CheckSizes(u.size(), v.size());
+   SVectorBatch<T, D> ret(u.size());
+   for (std::size_t i = 0; i < ret.NBlocks(); ++i)
+      ret.SetBlock(i, u.GetBlock(i) - v.GetBlock(i));
+   return ret;
+}
+
+/// transposed matrices: A_i^T
+template <class T, unsigned int D1, unsigned int D2, class R>
+SMatrixBatch<T, D2, D1, typename TranspPolicy<T, D1, D2, R>::RepType> Transpose(const SMatrixBatch<T, D1, D2, R> &a)
+{
+   SMatrixBatch<T, D2, D1, typename TranspPolicy<T, D1, D2, R>::RepType> ret(a.size());
+   for (std::size_t i = 0; i < ret.NBlocks(); ++i)
+      ret.SetBlock(i, Transpose(a.GetBlock(i)));
+   return ret;
+}
+
+/// similarity products of symmetric matrices: U_i * A_i * U_i^T
+template <class T, unsigned int D1, unsigned int D2, class R>
+SMatrixBatch<T, D1, D1, MatRepSym<T, D1> >
+Similarity(const SMatrixBatch<T, D1, D2, R> &u, const SMatrixBatch<T, D2, D2, MatRepSym<T, D2> > &a)
+{
+   SMatrixBatchHelpers::CheckSizes(u.size(), a.size());
+   SMatrixBatch<T, D1, D1, MatRepSym<T, D1> > ret(u.size());
+   for (std::size_t i = 0; i < ret.NBlocks(); ++i)
+      ret.SetBlock(i, Similarity(u.GetBlock(i), a.GetBlock(i)));
+   return ret;
+}
+
+/// transpose similarity products of symmetric matrices: U_i^T * A_i * U_i
+template <class T, unsigned int D1, unsigned int D2, class R>
+SMatrixBatch<T, D2, D2, MatRepSym<T, D2> >
+SimilarityT(const SMatrixBatch<T, D1, D2, R> &u, const SMatrixBatch<T, D1, D1, MatRepSym<T, D1> > &a)
+{
+   SMatrixBatchHelpers::CheckSizes(u.size(), a.size());
+   SMatrixBatch<T, D2, D2, MatRepSym<T, D2> > ret(u.size());
+   for (std::size_t i = 0; i < ret.NBlocks(); ++i)
+      ret.SetBlock(i, SimilarityT(u.GetBlock(i), a.GetBlock(i)));
+   return ret;
+}
+
+/// similarity products of vectors: v_i^T * A_i * v_i, e.g. the chi2 of many residuals
+template <class T, unsigned int D, class R>
+std::vector<T> Similarity(const SVectorBatch<T, D> &v, const SMatrixBatch<T, D, D, R> &a)
+{
+   typedef typename SMatrixBatchHelpers::SIMDType<T>::Type SIMD_t;
+   SMatrixBatchHelpers::CheckSizes(v.size(), a.size());
+   std::vector<T> ret(v.size());
+   const std::size_t bsize = SVectorBatch<T, D>::BlockSize();
+   for (std::size_t i = 0; i < v.NBlocks(); ++i) {
+      const SIMD_t s = Similarity(a.GetBlock(i), v.GetBlock(i));
+      for (std::size_t l = 0; l < bsize && i * bsize + l < ret.size(); ++l)
+         ret[i * bsize + l] = SMatrixBatchHelpers::Lane(s, l);
+   }
+   return ret;
+}
+
+} // namespace Math
+
+} // namespace ROOT
+
+#endif // ROOT_Math_SMatrixBatch
@@ -45,6 +45,14 @@ Upon a second allocation, the vector *v* ceases to be a proxy
 v.emplace_back(0.);
 ~~~
 now the vector *v* owns its memory as a regular vector.
+
+The RAdoptAllocator can also be given an inline storage, i.e. a memory region of a fixed
+capacity which belongs to the container itself. The allocations which fit in it are served
+from it, as long as it is not in use, and only the larger ones reach the heap. The flag
+telling whether the storage is in use is owned by the container too, so that all the
+copies of the allocator agree on it. Copies of the allocator made to copy the container
+(select_on_container_copy_construction) do not know about the inline storage, and an
+allocator keeps its own inline storage when it is assigned.
 **/
 
 template <typename T>
@@ -73,17 +81,46 @@ private:
    pointer fInitialAddress = nullptr;
    EAllocType fAllocType = EAllocType::kOwning;
    StdAlloc_t fStdAllocator;
+   pointer fInlineAddress = nullptr; ///< Address of the inline storage of the container, if any
+   size_type fInlineSize = 0;        ///< Capacity of the inline storage, in number of elements
+   bool *fInlineInUse = nullptr;     ///< Flag, owned by the container, set while the inline storage is allocated
 
 public:
    /// This is the constructor which allows the allocator to adopt a certain memory region.
    RAdoptAllocator(pointer p) : fInitialAddress(p), fAllocType(EAllocType::kAdoptingNoAllocYet){};
+   /// This constructor lets the allocator serve the allocations of at most inlineSize elements
+   /// from the inline storage at inlineAddress while *inlineInUse is false. If p is not null,
+   /// the memory region it points to is adopted as well.
+   RAdoptAllocator(pointer p, pointer inlineAddress, size_type inlineSize, bool *inlineInUse)
+      : fInitialAddress(p), fAllocType(p ? EAllocType::kAdoptingNoAllocYet : EAllocType::kOwning),
+        fInlineAddress(inlineAddress), fInlineSize(inlineSize), fInlineInUse(inlineInUse){};
    RAdoptAllocator() = default;
    RAdoptAllocator(const RAdoptAllocator &) = default;
    RAdoptAllocator(RAdoptAllocator &&) = default;
-   RAdoptAllocator &operator=(const RAdoptAllocator &) = default;
-   RAdoptAllocator &operator=(RAdoptAllocator &&) = default;
    RAdoptAllocator(const RAdoptAllocator<bool> &);
 
+   /// The inline storage belongs to the container: an allocator keeps its own one, if any.
+   RAdoptAllocator &operator=(const RAdoptAllocator &other)
+   {
+      fInitialAddress = other.fInitialAddress;
+      fAllocType = other.fAllocType;
+      fStdAllocator = other.fStdAllocator;
+      if (!fInlineAddress) {
+         fInlineAddress = other.fInlineAddress;
+         fInlineSize = other.fInlineSize;
+         fInlineInUse = other.fInlineInUse;
+      }
+      return *this;
+   }
+
+   RAdoptAllocator &operator=(RAdoptAllocator &&other) { return *this = other; }
+
+   /// Whether the allocator provides a view on adopted memory to its container.
+   bool IsAdopting() const { return EAllocType::kOwning != fAllocType; }
+
+   /// The copy of a container owns its memory, on the heap.
+   RAdoptAllocator select_on_container_copy_construction() const { return RAdoptAllocator(); }
+
    /// Construct an object at a certain memory address
    /// \tparam U The type of the memory address at which the object needs to be constructed
    /// \tparam Args The arguments' types necessary for the construction of the object
@@ -101,7 +138,8 @@ public:
 
    /// \brief Allocate some memory
    /// If an address has been adopted, at the first call, that address is returned.
-   /// Subsequent calls will make "decay" the allocator to a regular stl allocator.
+   /// Subsequent calls will make "decay" the allocator to a regular stl allocator, which
+   /// uses the inline storage, if any, for the allocations fitting in it.
    pointer allocate(std::size_t n)
    {
       if (n > std::size_t(-1) / sizeof(T))
@@ -111,14 +149,24 @@ public:
          return fInitialAddress;
       }
       fAllocType = EAllocType::kOwning;
+      if (fInlineInUse && !*fInlineInUse && n <= fInlineSize) {
+         *fInlineInUse = true;
+         return fInlineAddress;
+      }
       return StdAllocTraits_t::allocate(fStdAllocator, n);
    }
 
-   /// \brief Dellocate some memory if that had not been adopted.
+   /// \brief Dellocate some memory if that had not been adopted nor taken from the inline storage.
    void deallocate(pointer p, std::size_t n)
    {
-      if (p != fInitialAddress)
-         StdAllocTraits_t::deallocate(fStdAllocator, p, n);
+      if (p == fInitialAddress)
+         return;
+      if (p == fInlineAddress) {
+         if (fInlineInUse)
+            *fInlineInUse = false;
+         return;
+      }
+      StdAllocTraits_t::deallocate(fStdAllocator, p, n);
    }
 
    template <class U>
@@ -26,6 +26,8 @@
 
 #include <algorithm>
 #include <cmath>
+#include <cstddef>
+#include <iterator>
 #include <numeric> // for inner_product
 #include <sstream>
 #include <stdexcept>
@@ -40,6 +42,78 @@
 namespace ROOT {
 
 namespace VecOps {
+
+/// \brief Number of elements of type T which a RVec stores inline, without allocating memory on the heap
+/// By default, it is the number of elements fitting in 64 bytes for the types up to 16 bytes, and zero
+/// for the larger ones. It can be changed for a type specializing this class template before any RVec of that
+/// type is used. The RVecs of the fundamental types are compiled in the library, hence their value is fixed.
+template <typename T>
+struct RVecInlineSize {
+   static constexpr std::size_t value = sizeof(T) <= 16 ? 64 / sizeof(T) : 0;
+};
+
+} // End of VecOps NS
+
+namespace Detail {
+namespace VecOps {
+
+/// Inline storage of the first elements of a RVec, made available to the RAdoptAllocator of its std::vector.
+/// It belongs to one RVec: copies and assignments leave it untouched.
+template <typename T, std::size_t N>
+class RInlineStorage {
+   typename std::aligned_storage<N * sizeof(T), alignof(T)>::type fBuffer;
+   bool fInUse = false;
+
+public:
+   RInlineStorage() = default;
+   RInlineStorage(const RInlineStorage &) {}
+   RInlineStorage &operator=(const RInlineStorage &) { return *this; }
+
+   static constexpr std::size_t GetSize() { return N; }
+   bool IsInUse() const { return fInUse; }
+
+   template <typename Alloc_t = RAdoptAllocator<T>>
+   Alloc_t MakeAllocator(T *adopted = nullptr)
+   {
+      return Alloc_t(adopted, reinterpret_cast<T *>(&fBuffer), N, &fInUse);
+   }
+};
+
+template <typename T>
+class RInlineStorage<T, 0> {
+public:
+   static constexpr std::size_t GetSize() { return 0; }
+   bool IsInUse() const { return false; }
+
+   template <typename Alloc_t = RAdoptAllocator<T>>
+   Alloc_t MakeAllocator()
+   {
+      return Alloc_t();
+   }
+
+   RAdoptAllocator<T> MakeAllocator(T *adopted) { return RAdoptAllocator<T>(adopted); }
+};
+
+/// Whether a container using the allocator a is a view on adopted memory
+template <typename Alloc_t>
+bool IsAdopting(const Alloc_t &)
+{
+   return false;
+}
+
+template <typename T>
+bool IsAdopting(const RAdoptAllocator<T> &a)
+{
+   return a.IsAdopting();
+}
+
+} // End of VecOps NS
+} // End of Detail NS
+
+namespace VecOps {
+template <typename Node_t>
+class RVecExpr;
+
 // clang-format off
 /**
 \class ROOT::VecOps::RVec
@@ -59,7 +133,9 @@ the manipulation and analysis of the data in the RVec.
 ## Table of Contents
 - [Example](#example)
 - [Owning and adopting memory](#owningandadoptingmemory)
+- [Inline storage](#inlinestorage)
 - [Sorting and manipulation of indices](#sorting)
+- [Lazy expressions](#lazyexpressions)
 - [Usage in combination with RDataFrame](#usagetdataframe)
 - [Reference for the RVec class](#RVecdoxyref)
 
@@ -107,6 +183,18 @@ If any method which implies a re-allocation is called, e.g. *emplace_back* or *r
 memory is released and new one is allocated. The previous content is copied in the new memory and
 preserved.
 
+## <a name="inlinestorage"></a>Inline storage
+The first elements of a RVec are stored in a buffer which is part of the RVec object itself, so that
+short collections, e.g. the handful of jets or muons of an event, and the temporaries produced by the
+operations on them do not allocate memory on the heap. Memory is allocated on the heap only once the RVec
+grows beyond the capacity of its inline storage, given by ROOT::VecOps::RVecInlineSize<T>::value
+(8 elements for double, 16 for float). The price is a larger object: sizeof(RVec<double>) is 136 bytes,
+instead of the 24 bytes of a std::vector. Moving a RVec whose elements are stored inline moves the elements
+one by one rather than its buffer. For the same reason, swap is done with three moves and is linear in the
+number of elements stored inline, rather than constant. A RVec which adopts memory uses its inline storage when
+it needs to allocate, if the new elements fit in it. Moving a RVec into one which adopts memory releases
+the adopted memory, which is left untouched. RVec<bool> has no inline storage.
+
 ## <a name="#sorting"></a>Sorting and manipulation of indices
 
 ### Sorting
@@ -151,6 +239,37 @@ auto vf_2 = Take(vf, 2); // The content is {1.f, 2.f}
 auto vf_3 = Take(vf, -3); // The content is {2.f, 3.f, 4.f}
 ~~~
 
+`ArgMax` and `ArgMin` return the index of the greatest and smallest element. `Combinations` produces
+the indices of all the pairs or triplets of elements of two or three RVecs, or of all the unique
+combinations of n elements of one RVec, which can then be given to `Take`:
+~~~{.cpp}
+RVec<float> pt {50.f, 30.f, 20.f}, eta {0.1f, -1.2f, 2.0f}, phi {0.f, 2.5f, -1.f}, m {0.f, 0.f, 0.f};
+auto pairs = Combinations(pt, 2); // {{0, 0, 1}, {1, 2, 2}}
+auto masses = InvariantMasses(Take(pt, pairs[0]), Take(eta, pairs[0]), Take(phi, pairs[0]), Take(m, pairs[0]),
+                              Take(pt, pairs[1]), Take(eta, pairs[1]), Take(phi, pairs[1]), Take(m, pairs[1]));
+auto bestPair = ArgMin(abs(masses - 91.2f));
+~~~
+The helpers `SegmentedSum`, `SegmentedMean`, `SegmentedMax`, `SegmentedMin` and `SegmentedReduce` reduce
+each of the inner RVecs of a RVec<RVec<T>>.
+
+## <a name="lazyexpressions"></a>Lazy expressions
+Each operation on RVecs produces a new RVec. An expression such as
+~~~{.cpp}
+auto goodJets = sqrt(px * px + py * py) > 10 && abs(eta) < 2.4;
+~~~
+creates one temporary RVec per operator and function. Starting the expression with Lazy() makes it a
+ROOT::VecOps::RVecExpr instead, which records the operations and computes them in a single loop over the
+elements when it is converted to a RVec, or when it is reduced, e.g. with Sum or Any:
+~~~{.cpp}
+RVec<int> goodJets = sqrt(Lazy(px) * px + Lazy(py) * py) > 10 && abs(Lazy(eta)) < 2.4;
+auto nGoodJets = Sum(goodJets);
+auto goodJetsPt = pt[sqrt(Lazy(px) * px + Lazy(py) * py) > 10 && abs(Lazy(eta)) < 2.4];
+~~~
+Only the operations applied to a lazy expression are fused: in `Lazy(px) * px + py * py`, `py * py` is
+still computed into a temporary RVec, so each independent sub-expression must start from a Lazy() operand.
+Take, Argsort and Filter accept lazy expressions too. An expression refers to the RVecs it was built
+from, which must outlive it, except for the temporary RVecs, e.g. `Lazy(v * 2.)`, which it takes over.
+
 ## <a name="usagetdataframe"></a>Usage in combination with RDataFrame
 RDataFrame leverages internally RVecs. Suppose to have a dataset stored in a
 TTree which holds these columns (here we choose C arrays to represent the
@@ -213,28 +332,60 @@ public:
    using const_reverse_iterator = typename Impl_t::const_reverse_iterator;
 
 private:
+   using Alloc_t = typename Impl_t::allocator_type;
+   using Storage_t = ::ROOT::Detail::VecOps::RInlineStorage<T, IsVecBool ? 0 : RVecInlineSize<T>::value>;
+
+   Storage_t fInline; //! The allocator of fData points to it: it must be constructed first
    Impl_t fData;
 
+   Alloc_t MakeAllocator() { return fInline.template MakeAllocator<Alloc_t>(); }
+   // Give to fData the capacity of the inline storage, without allocating on the heap
+   void ReserveInline() { fData.reserve(fInline.GetSize()); }
+
 public:
    // constructors
-   RVec() {}
+   RVec() : fData(MakeAllocator()) { ReserveInline(); }
 
-   explicit RVec(size_type count) : fData(count) {}
+   explicit RVec(size_type count) : fData(MakeAllocator())
+   {
+      ReserveInline();
+      fData.resize(count);
+   }
 
-   RVec(size_type count, const T &value) : fData(count, value) {}
+   RVec(size_type count, const T &value) : fData(MakeAllocator())
+   {
+      ReserveInline();
+      fData.assign(count, value);
+   }
 
-   RVec(const RVec<T> &v) : fData(v.fData) {}
+   RVec(const RVec<T> &v) : fData(MakeAllocator())
+   {
+      ReserveInline();
+      fData = v.fData;
+   }
 
-   RVec(RVec<T> &&v) : fData(std::move(v.fData)) {}
+   RVec(RVec<T> &&v) : fData(MakeAllocator()) { *this = std::move(v); }
 
-   RVec(const std::vector<T> &v) : fData(v.cbegin(), v.cend()) {}
+   RVec(const std::vector<T> &v) : fData(MakeAllocator())
+   {
+      ReserveInline();
+      fData.assign(v.cbegin(), v.cend());
+   }
 
-   RVec(pointer p, size_type n) : fData(n, T(), ROOT::Detail::VecOps::RAdoptAllocator<T>(p)) {}
+   RVec(pointer p, size_type n) : fData(n, T(), fInline.MakeAllocator(p)) {}
 
    template <class InputIt>
-   RVec(InputIt first, InputIt last) : fData(first, last) {}
+   RVec(InputIt first, InputIt last) : fData(MakeAllocator())
+   {
+      ReserveInline();
+      fData.assign(first, last);
+   }
 
-   RVec(std::initializer_list<T> init) : fData(init) {}
+   RVec(std::initializer_list<T> init) : fData(MakeAllocator())
+   {
+      ReserveInline();
+      fData.assign(init);
+   }
 
    // assignment
    RVec<T> &operator=(const RVec<T> &v)
@@ -245,7 +396,22 @@ public:
 
    RVec<T> &operator=(RVec<T> &&v)
    {
-      std::swap(fData, v.fData);
+      if (this == &v)
+         return *this;
+      if (v.fInline.IsInUse()) {
+         // the elements of v live in its inline storage: they are moved one by one, into a
+         // buffer of this RVec, not into the memory it adopted, if any
+         if (::ROOT::Detail::VecOps::IsAdopting(fData.get_allocator())) {
+            fData = Impl_t(MakeAllocator());
+            ReserveInline();
+         }
+         fData.assign(std::make_move_iterator(v.fData.begin()), std::make_move_iterator(v.fData.end()));
+         v.fData.clear();
+      } else {
+         // the buffer of v is taken over, fData keeps its own inline storage
+         fData = std::move(v.fData);
+         v.ReserveInline();
+      }
       return *this;
    }
 
@@ -289,6 +455,23 @@ public:
       return ret;
    }
 
+   /// Select the elements with a lazy expression, computed in the same loop
+   template <typename Node_t>
+   RVec operator[](const RVecExpr<Node_t> &conds) const
+   {
+      const size_type n = conds.size();
+
+      if (n != size())
+         throw std::runtime_error("Cannot index RVec with condition vector of different size");
+
+      RVec<T> ret;
+      ret.reserve(n);
+      for (size_type i = 0; i < n; ++i)
+         if (conds[i])
+            ret.emplace_back(fData[i]);
+      return ret;
+   }
+
    reference front() { return fData.front(); }
    const_reference front() const { return fData.front(); }
    reference back() { return fData.back(); }
@@ -337,7 +520,13 @@ public:
    void pop_back() { fData.pop_back(); }
    void resize(size_type count) { fData.resize(count); }
    void resize(size_type count, const value_type &value) { fData.resize(count, value); }
-   void swap(RVec<T> &other) { std::swap(fData, other.fData); }
+   /// Linear in the number of elements stored inline, which are moved one by one
+   void swap(RVec<T> &other)
+   {
+      RVec<T> tmp(std::move(other));
+      other = std::move(*this);
+      *this = std::move(tmp);
+   }
 };
 
 ///@name RVec Unary Arithmetic Operators
@@ -638,6 +827,32 @@ TVEC_VDT_UNARY_FUNCTION(fast_atan)
 
 ///@}
 
+///@name RVec Vectorised Mathematical Functions
+///@{
+/// The overloads of these functions for RVecs of float and double are compiled in the library, where
+/// they process the elements by SIMD vectors of ROOT::Float_v and ROOT::Double_v. These are provided by
+/// VecCore, with the Vc backend if available, for the instruction set ROOT was built for; without VecCore
+/// the elements are processed one by one. The overloads are preferred to the generic templates above.
+
+RVec<float> exp(const RVec<float> &v);
+RVec<double> exp(const RVec<double> &v);
+RVec<float> log(const RVec<float> &v);
+RVec<double> log(const RVec<double> &v);
+RVec<float> sin(const RVec<float> &v);
+RVec<double> sin(const RVec<double> &v);
+RVec<float> cos(const RVec<float> &v);
+RVec<double> cos(const RVec<double> &v);
+RVec<float> sqrt(const RVec<float> &v);
+RVec<double> sqrt(const RVec<double> &v);
+RVec<float> atan2(const RVec<float> &v0, const RVec<float> &v1);
+RVec<double> atan2(const RVec<double> &v0, const RVec<double> &v1);
+RVec<float> pow(const RVec<float> &v0, const RVec<float> &v1);
+RVec<double> pow(const RVec<double> &v0, const RVec<double> &v1);
+RVec<float> pow(const RVec<float> &v, float y);
+RVec<double> pow(const RVec<double> &v, double y);
+
+///@}
+
 /// Inner product
 ///
 /// Example code, at the ROOT prompt:
@@ -732,6 +947,92 @@ double StdDev(const RVec<T> &v)
    return std::sqrt(Var(v));
 }
 
+/// Reduce each of the RVecs of a RVec<RVec<T>> with a binary callable, starting from init
+///
+/// The callable is invoked as f(accumulated, element) and its result has the type of init.
+/// Example code, at the ROOT prompt:
+/// ~~~{.cpp}
+/// using namespace ROOT::VecOps;
+/// RVec<RVec<int>> v {{1, 2}, {}, {3, 4, 5}};
+/// auto v_prod = SegmentedReduce(v, [](int a, int b) { return a * b; }, 1);
+/// v_prod
+/// // (ROOT::VecOps::RVec<int>) { 2, 1, 60 }
+/// ~~~
+template <typename T, typename F, typename R>
+RVec<R> SegmentedReduce(const RVec<RVec<T>> &v, F &&f, R init)
+{
+   const auto size = v.size();
+   RVec<R> r(size);
+   for (std::size_t i = 0; i < size; i++)
+      r[i] = std::accumulate(v[i].begin(), v[i].end(), init, f);
+   return r;
+}
+
+/// Sum the elements of each of the RVecs of a RVec<RVec<T>>
+///
+/// Example code, at the ROOT prompt:
+/// ~~~{.cpp}
+/// using namespace ROOT::VecOps;
+/// RVec<RVec<float>> v {{1.f, 2.f}, {}, {3.f, 4.f, 5.f}};
+/// auto v_sum = SegmentedSum(v);
+/// v_sum
+/// // (ROOT::VecOps::RVec<float>) { 3.00000f, 0.00000f, 12.0000f }
+/// ~~~
+template <typename T>
+RVec<T> SegmentedSum(const RVec<RVec<T>> &v)
+{
+   const auto size = v.size();
+   RVec<T> r(size);
+   for (std::size_t i = 0; i < size; i++)
+      r[i] = Sum(v[i]);
+   return r;
+}
+
+/// Get the mean of the elements of each of the RVecs of a RVec<RVec<T>>
+///
+/// The mean of an empty RVec is 0.
+template <typename T>
+RVec<double> SegmentedMean(const RVec<RVec<T>> &v)
+{
+   const auto size = v.size();
+   RVec<double> r(size);
+   for (std::size_t i = 0; i < size; i++)
+      r[i] = Mean(v[i]);
+   return r;
+}
+
+/// Get the greatest element of each of the RVecs of a RVec<RVec<T>>
+///
+/// An exception is thrown if one of the RVecs is empty.
+template <typename T>
+RVec<T> SegmentedMax(const RVec<RVec<T>> &v)
+{
+   const auto size = v.size();
+   RVec<T> r(size);
+   for (std::size_t i = 0; i < size; i++) {
+      if (v[i].empty())
+         throw std::runtime_error("Cannot compute the maximum of an empty vector");
+      r[i] = *std::max_element(v[i].begin(), v[i].end());
+   }
+   return r;
+}
+
+/// Get the smallest element of each of the RVecs of a RVec<RVec<T>>
+///
+/// An exception is thrown if one of the RVecs is empty.
+template <typename T>
+RVec<T> SegmentedMin(const RVec<RVec<T>> &v)
+{
+   const auto size = v.size();
+   RVec<T> r(size);
+   for (std::size_t i = 0; i < size; i++) {
+      if (v[i].empty())
+         throw std::runtime_error("Cannot compute the minimum of an empty vector");
+      r[i] = *std::min_element(v[i].begin(), v[i].end());
+   }
+   return r;
+}
+
 /// Create new collection applying a callable to the elements of the input collection
 ///
 /// Example code, at the ROOT prompt:
@@ -750,6 +1051,32 @@ auto Map(const RVec<T> &v, F &&f) -> RVec<decltype(f(v[0]))>
    return ret;
 }
 
+/// Build a RVec of objects from the elements of RVecs, e.g. 4-vectors from the columns of their components
+///
+/// The i-th object is constructed as T(args[i]...). An exception is thrown if the RVecs have different sizes.
+/// Example code, at the ROOT prompt:
+/// ~~~{.cpp}
+/// using namespace ROOT::VecOps;
+/// RVec<float> pt {15.5f, 34.32f}, eta {0.3f, 2.4f}, phi {-0.1f, 1.8f}, mass {0.105f, 0.105f};
+/// auto p4 = Construct<ROOT::Math::PtEtaPhiMVector>(pt, eta, phi, mass);
+/// (p4[0] + p4[1]).M();
+/// ~~~
+template <typename T, typename Arg0_t, typename... Args_t>
+RVec<T> Construct(const RVec<Arg0_t> &arg0, const RVec<Args_t> &... args)
+{
+   const auto size = arg0.size();
+   const std::size_t sizes[] = {size, args.size()...};
+   for (auto argSize : sizes) {
+      if (argSize != size)
+         throw std::runtime_error("Cannot construct objects from vectors of different sizes");
+   }
+   RVec<T> r;
+   r.reserve(size);
+   for (std::size_t i = 0; i < size; i++)
+      r.emplace_back(arg0[i], args[i]...);
+   return r;
+}
+
 /// Create a new collection with the elements passing the filter expressed by the predicate
 ///
 /// Example code, at the ROOT prompt:
@@ -837,6 +1164,44 @@ RVec<typename RVec<T>::size_type> Argsort(const RVec<T> &v)
    return i;
 }
 
+/// Return the index of the greatest element of a RVec, the first one if there are several
+///
+/// An exception is thrown if the RVec is empty.
+/// Example code, at the ROOT prompt:
+/// ~~~{.cpp}
+/// using namespace ROOT::VecOps;
+/// RVec<double> v {2., 3., 1., 3.};
+/// auto maxIndex = ArgMax(v);
+/// maxIndex
+/// // (unsigned long) 1
+/// ~~~
+template <typename T>
+typename RVec<T>::size_type ArgMax(const RVec<T> &v)
+{
+   if (v.empty())
+      throw std::runtime_error("Cannot compute ArgMax of an empty vector");
+   return std::distance(v.begin(), std::max_element(v.begin(), v.end()));
+}
+
+/// Return the index of the smallest element of a RVec, the first one if there are several
+///
+/// An exception is thrown if the RVec is empty.
+/// Example code, at the ROOT prompt:
+/// ~~~{.cpp}
+/// using namespace ROOT::VecOps;
+/// RVec<double> v {2., 1., 3., 1.};
+/// auto minIndex = ArgMin(v);
+/// minIndex
+/// // (unsigned long) 1
+/// ~~~
+template <typename T>
+typename RVec<T>::size_type ArgMin(const RVec<T> &v)
+{
+   if (v.empty())
+      throw std::runtime_error("Cannot compute ArgMin of an empty vector");
+   return std::distance(v.begin(), std::min_element(v.begin(), v.end()));
+}
+
 /// Return elements of a vector at given indices
 ///
 /// Example code, at the ROOT prompt:
@@ -959,6 +1324,34 @@ RVec<T> Sort(const RVec<T> &v, Compare &&c)
    return r;
 }
 
+/// Return copy of RVec with the elements satisfying a predicate placed before the others
+///
+/// The relative order of the elements is preserved in both groups.
+///
+/// Example code, at the ROOT prompt:
+/// ~~~{.cpp}
+/// using namespace ROOT::VecOps;
+/// RVec<int> v {1, 2, 3, 4, 5};
+/// auto v_partitioned = StablePartition(v, [](int i) { return 0 == i % 2; });
+/// v_partitioned
+/// // (ROOT::VecOps::RVec<int>) { 2, 4, 1, 3, 5 }
+/// ~~~
+template <typename T, typename F>
+RVec<T> StablePartition(const RVec<T> &v, F &&f)
+{
+   RVec<T> r;
+   r.reserve(v.size());
+   for (auto &&val : v) {
+      if (f(val))
+         r.emplace_back(val);
+   }
+   for (auto &&val : v) {
+      if (!f(val))
+         r.emplace_back(val);
+   }
+   return r;
+}
+
 /// Return the indices that represent all combinations of the elements of two
 /// RVecs.
 ///
@@ -993,6 +1386,45 @@ RVec<RVec<typename RVec<T1>::size_type>> Combinations(const RVec<T1> &v1, const
    return r;
 }
 
+/// Return the indices that represent all combinations of the elements of three
+/// RVecs.
+///
+/// The type of the return value is an RVec of three RVecs containing indices.
+///
+/// Example code, at the ROOT prompt:
+/// ~~~{.cpp}
+/// using namespace ROOT::VecOps;
+/// RVec<double> v1 {1., 2.};
+/// RVec<double> v2 {-4., -5.};
+/// RVec<double> v3 {7.};
+/// auto comb_idx = Combinations(v1, v2, v3);
+/// comb_idx
+/// // (ROOT::VecOps::RVec<ROOT::VecOps::RVec<ROOT::VecOps::RVec<double>::size_type> >) { { 0, 0, 1, 1 }, { 0, 1, 0, 1 }, { 0, 0, 0, 0 } }
+/// ~~~
+template <typename T1, typename T2, typename T3>
+RVec<RVec<typename RVec<T1>::size_type>> Combinations(const RVec<T1> &v1, const RVec<T2> &v2, const RVec<T3> &v3)
+{
+   using size_type = typename RVec<T1>::size_type;
+   const size_type size1 = v1.size();
+   const size_type size2 = v2.size();
+   const size_type size3 = v3.size();
+   RVec<RVec<size_type>> r(3);
+   for (auto &idx : r)
+      idx.resize(size1 * size2 * size3);
+   size_type c = 0;
+   for (size_type i = 0; i < size1; i++) {
+      for (size_type j = 0; j < size2; j++) {
+         for (size_type k = 0; k < size3; k++) {
+            r[0][c] = i;
+            r[1][c] = j;
+            r[2][c] = k;
+            c++;
+         }
+      }
+   }
+   return r;
+}
+
 /// Return the indices that represent all unique combinations of the
 /// elements of a given RVec.
 ///
@@ -1025,9 +1457,15 @@ RVec<RVec<typename RVec<T>::size_type>> Combinations(const RVec<T>& v, const typ
    RVec<size_type> indices(s);
    for(size_type k=0; k<s; k++)
       indices[k] = k;
+   // number of combinations, s! / (n! (s - n)!), to allocate the indices once
+   size_type nCombinations = 1;
+   for (size_type k = 0; k < n; k++)
+      nCombinations = nCombinations * (s - k) / (k + 1);
    RVec<RVec<size_type>> c(n);
-   for(size_type k=0; k<n; k++)
+   for(size_type k=0; k<n; k++) {
+      c[k].reserve(nCombinations);
       c[k].emplace_back(indices[k]);
+   }
    while (true) {
       bool run_through = true;
       long i = n - 1;
@@ -1218,6 +1656,715 @@ RVec<T> Where(const RVec<int>& c, T v1, T v2)
    return r;
 }
 
+///@}
+///@name RVec Kinematics
+///@{
+
+/// Return the angle difference \f$\Delta \phi\f$ of two scalars, v2 - v1, in \f$[-c, c]\f$
+///
+/// By default the angles are in radian, with c = \f$\pi\f$.
+template <typename T>
+T DeltaPhi(T v1, T v2, const T c = T(3.14159265358979323846))
+{
+   const T d = v2 - v1;
+   return d - T(2) * c * std::floor(d / (T(2) * c) + T(0.5));
+}
+
+/// Return the angle differences \f$\Delta \phi\f$ of the elements of two RVecs
+///
+/// Example code, at the ROOT prompt:
+/// ~~~{.cpp}
+/// using namespace ROOT::VecOps;
+/// RVec<double> phi1 {0.1, 3.};
+/// RVec<double> phi2 {0.3, -3.};
+/// auto dphi = DeltaPhi(phi1, phi2);
+/// dphi
+/// // (ROOT::VecOps::RVec<double> &) { 0.20000000, 0.28318531 }
+/// ~~~
+template <typename T>
+RVec<T> DeltaPhi(const RVec<T> &v1, const RVec<T> &v2, const T c = T(3.14159265358979323846))
+{
+   const auto size = v1.size();
+   if (size != v2.size())
+      throw std::runtime_error("Cannot compute DeltaPhi of vectors of different sizes");
+   RVec<T> r(size);
+   for (std::size_t i = 0; i < size; i++)
+      r[i] = DeltaPhi(v1[i], v2[i], c);
+   return r;
+}
+
+/// Return the angle differences \f$\Delta \phi\f$ of the elements of a RVec and a scalar
+template <typename T>
+RVec<T> DeltaPhi(const RVec<T> &v1, T v2, const T c = T(3.14159265358979323846))
+{
+   const auto size = v1.size();
+   RVec<T> r(size);
+   for (std::size_t i = 0; i < size; i++)
+      r[i] = DeltaPhi(v1[i], v2, c);
+   return r;
+}
+
+/// Return the angle differences \f$\Delta \phi\f$ of a scalar and the elements of a RVec
+template <typename T>
+RVec<T> DeltaPhi(T v1, const RVec<T> &v2, const T c = T(3.14159265358979323846))
+{
+   const auto size = v2.size();
+   RVec<T> r(size);
+   for (std::size_t i = 0; i < size; i++)
+      r[i] = DeltaPhi(v1, v2[i], c);
+   return r;
+}
+
+/// Return the distance \f$\Delta R = \sqrt{\Delta \eta^2 + \Delta \phi^2}\f$ of two directions
+template <typename T>
+T DeltaR(T eta1, T eta2, T phi1, T phi2, const T c = T(3.14159265358979323846))
+{
+   const T deta = eta2 - eta1;
+   const T dphi = DeltaPhi(phi1, phi2, c);
+   return std::sqrt(deta * deta + dphi * dphi);
+}
+
+/// Return the distances \f$\Delta R\f$ of the directions given by the elements of the RVecs
+///
+/// Example code, at the ROOT prompt:
+/// ~~~{.cpp}
+/// using namespace ROOT::VecOps;
+/// RVec<double> eta1 {0.1, 1.}, eta2 {0.4, 1.}, phi1 {0., 3.}, phi2 {0.4, -3.};
+/// auto dr = DeltaR(eta1, eta2, phi1, phi2);
+/// dr
+/// // (ROOT::VecOps::RVec<double> &) { 0.50000000, 0.28318531 }
+/// ~~~
+template <typename T>
+RVec<T> DeltaR(const RVec<T> &eta1, const RVec<T> &eta2, const RVec<T> &phi1, const RVec<T> &phi2,
+               const T c = T(3.14159265358979323846))
+{
+   const auto size = eta1.size();
+   if (size != eta2.size() || size != phi1.size() || size != phi2.size())
+      throw std::runtime_error("Cannot compute DeltaR of vectors of different sizes");
+   RVec<T> r(size);
+   for (std::size_t i = 0; i < size; i++)
+      r[i] = DeltaR(eta1[i], eta2[i], phi1[i], phi2[i], c);
+   return r;
+}
+
+/// Return the invariant masses of the pairs of particles given by the elements of the RVecs
+///
+/// The particles are given by their transverse momentum, pseudorapidity, azimuthal angle and mass.
+/// Example code, at the ROOT prompt:
+/// ~~~{.cpp}
+/// using namespace ROOT::VecOps;
+/// RVec<double> pt1 {40., 20.}, eta1 {0., 1.}, phi1 {0., 0.}, mass1 {0., 0.};
+/// RVec<double> pt2 {40., 20.}, eta2 {0., -1.}, phi2 {3.14159265358979323846, 0.}, mass2 {0., 0.};
+/// auto m = InvariantMasses(pt1, eta1, phi1, mass1, pt2, eta2, phi2, mass2);
+/// m
+/// // (ROOT::VecOps::RVec<double> &) { 80.000000, 47.008048 }
+/// ~~~
+template <typename T>
+RVec<T> InvariantMasses(const RVec<T> &pt1, const RVec<T> &eta1, const RVec<T> &phi1, const RVec<T> &mass1,
+                        const RVec<T> &pt2, const RVec<T> &eta2, const RVec<T> &phi2, const RVec<T> &mass2)
+{
+   const auto size = pt1.size();
+   if (size != eta1.size() || size != phi1.size() || size != mass1.size() || size != pt2.size() ||
+       size != eta2.size() || size != phi2.size() || size != mass2.size())
+      throw std::runtime_error("Cannot compute InvariantMasses of vectors of different sizes");
+   RVec<T> r(size);
+   for (std::size_t i = 0; i < size; i++) {
+      const T px = pt1[i] * std::cos(phi1[i]) + pt2[i] * std::cos(phi2[i]);
+      const T py = pt1[i] * std::sin(phi1[i]) + pt2[i] * std::sin(phi2[i]);
+      const T pz1 = pt1[i] * std::sinh(eta1[i]);
+      const T pz2 = pt2[i] * std::sinh(eta2[i]);
+      const T e1 = std::sqrt(pt1[i] * pt1[i] + pz1 * pz1 + mass1[i] * mass1[i]);
+      const T e2 = std::sqrt(pt2[i] * pt2[i] + pz2 * pz2 + mass2[i] * mass2[i]);
+      const T pz = pz1 + pz2;
+      const T e = e1 + e2;
+      r[i] = std::sqrt(std::max(e * e - px * px - py * py - pz * pz, T(0)));
+   }
+   return r;
+}
+
+/// Return the invariant mass of all the particles given by the elements of the RVecs
+///
+/// The particles are given by their transverse momentum, pseudorapidity, azimuthal angle and mass.
+template <typename T>
+T InvariantMass(const RVec<T> &pt, const RVec<T> &eta, const RVec<T> &phi, const RVec<T> &mass)
+{
+   const auto size = pt.size();
+   if (size != eta.size() || size != phi.size() || size != mass.size())
+      throw std::runtime_error("Cannot compute InvariantMass of vectors of different sizes");
+   T px(0), py(0), pz(0), e(0);
+   for (std::size_t i = 0; i < size; i++) {
+      const T pzi = pt[i] * std::sinh(eta[i]);
+      px += pt[i] * std::cos(phi[i]);
+      py += pt[i] * std::sin(phi[i]);
+      pz += pzi;
+      e += std::sqrt(pt[i] * pt[i] + pzi * pzi + mass[i] * mass[i]);
+   }
+   return std::sqrt(std::max(e * e - px * px - py * py - pz * pz, T(0)));
+}
+
+/// \cond
+// Vectorised overloads, compiled in the library
+RVec<float> DeltaPhi(const RVec<float> &v1, const RVec<float> &v2, const float c = float(3.14159265358979323846));
+RVec<double> DeltaPhi(const RVec<double> &v1, const RVec<double> &v2, const double c = 3.14159265358979323846);
+RVec<float> DeltaR(const RVec<float> &eta1, const RVec<float> &eta2, const RVec<float> &phi1,
+                   const RVec<float> &phi2, const float c = float(3.14159265358979323846));
+RVec<double> DeltaR(const RVec<double> &eta1, const RVec<double> &eta2, const RVec<double> &phi1,
+                    const RVec<double> &phi2, const double c = 3.14159265358979323846);
+RVec<float> InvariantMasses(const RVec<float> &pt1, const RVec<float> &eta1, const RVec<float> &phi1,
+                            const RVec<float> &mass1, const RVec<float> &pt2, const RVec<float> &eta2,
+                            const RVec<float> &phi2, const RVec<float> &mass2);
+RVec<double> InvariantMasses(const RVec<double> &pt1, const RVec<double> &eta1, const RVec<double> &phi1,
+                             const RVec<double> &mass1, const RVec<double> &pt2, const RVec<double> &eta2,
+                             const RVec<double> &phi2, const RVec<double> &mass2);
+/// \endcond
+
+///@}
+///@name RVec Lazy Expressions
+///@{
+
+} // End of VecOps NS
+
+namespace Detail {
+namespace VecOps {
+
+/// \cond
+// Nodes of the lazy RVec expressions. A node has a size, an element access operator computing the element on the
+// fly and the static member IsScalar, true for the scalars which are combined with every element of the vectors.
+
+template <typename T>
+class RVecRefNode {
+   using Vec_t = ::ROOT::VecOps::RVec<T>;
+   typename Vec_t::const_iterator fBegin;
+   std::size_t fSize;
+
+public:
+   static constexpr bool IsScalar = false;
+   using value_type = T;
+   RVecRefNode(const Vec_t &v) : fBegin(v.begin()), fSize(v.size()) {}
+   std::size_t size() const { return fSize; }
+   typename Vec_t::const_reference operator[](std::size_t i) const { return fBegin[i]; }
+};
+
+// Takes ownership of a temporary RVec, so that the expression does not refer to it once destroyed
+template <typename T>
+class RVecValueNode {
+   ::ROOT::VecOps::RVec<T> fVec;
+
+public:
+   static constexpr bool IsScalar = false;
+   using value_type = T;
+   RVecValueNode(::ROOT::VecOps::RVec<T> &&v) : fVec(std::move(v)) {}
+   std::size_t size() const { return fVec.size(); }
+   typename ::ROOT::VecOps::RVec<T>::const_reference operator[](std::size_t i) const { return fVec[i]; }
+};
+
+template <typename T>
+class RScalarNode {
+   T fValue;
+
+public:
+   static constexpr bool IsScalar = true;
+   using value_type = T;
+   RScalarNode(const T &value) : fValue(value) {}
+   std::size_t size() const { return 0; }
+   const T &operator[](std::size_t) const { return fValue; }
+};
+
+template <typename F, typename E>
+class RUnaryNode {
+   E fE;
+
+public:
+   static constexpr bool IsScalar = false;
+   using value_type = typename std::decay<decltype(F()(std::declval<typename E::value_type>()))>::type;
+   RUnaryNode(const E &e) : fE(e) {}
+   std::size_t size() const { return fE.size(); }
+   value_type operator[](std::size_t i) const { return F()(fE[i]); }
+};
+
+template <typename F, typename L, typename R>
+class RBinaryNode {
+   L fL;
+   R fR;
+
+public:
+   static constexpr bool IsScalar = false;
+   using value_type = typename std::decay<decltype(
+      F()(std::declval<typename L::value_type>(), std::declval<typename R::value_type>()))>::type;
+   template <typename LArg, typename RArg>
+   RBinaryNode(LArg &&l, RArg &&r, const char *errorMessage) : fL(std::forward<LArg>(l)), fR(std::forward<RArg>(r))
+   {
+      if (!L::IsScalar && !R::IsScalar && fL.size() != fR.size())
+         throw std::runtime_error(errorMessage);
+   }
+   std::size_t size() const { return L::IsScalar ? fR.size() : fL.size(); }
+   value_type operator[](std::size_t i) const { return F()(fL[i], fR[i]); }
+};
+
+// Function objects applying the operators and the mathematical functions to the elements
+namespace ExprOps {
+
+#define TVEC_EXPR_UNARY_OPERATOR_OP(NAME, OP)                                  \
+   struct NAME {                                                               \
+      template <typename A>                                                    \
+      auto operator()(const A &a) const -> decltype(OP a)                      \
+      {                                                                        \
+         return OP a;                                                          \
+      }                                                                        \
+   };
+
+#define TVEC_EXPR_BINARY_OPERATOR_OP(NAME, OP)                                 \
+   struct NAME {                                                               \
+      template <typename A, typename B>                                        \
+      auto operator()(const A &a, const B &b) const -> decltype(a OP b)        \
+      {                                                                        \
+         return a OP b;                                                        \
+      }                                                                        \
+   };
+
+// As the eager ones, comparisons and logical operators give int, not bool
+#define TVEC_EXPR_LOGICAL_OPERATOR_OP(NAME, OP)                                \
+   struct NAME {                                                               \
+      template <typename A, typename B>                                        \
+      int operator()(const A &a, const B &b) const                             \
+      {                                                                        \
+         return a OP b;                                                        \
+      }                                                                        \
+   };
+
+#define TVEC_EXPR_UNARY_FUNCTION_OP(NAME, FUNC)                                \
+   struct NAME {                                                               \
+      template <typename A>                                                    \
+      ::ROOT::VecOps::PromoteType<A> operator()(const A &a) const              \
+      {                                                                        \
+         return FUNC(a);                                                       \
+      }                                                                        \
+   };
+
+#define TVEC_EXPR_BINARY_FUNCTION_OP(NAME, FUNC)                               \
+   struct NAME {                                                               \
+      template <typename A, typename B>                                        \
+      ::ROOT::VecOps::PromoteTypes<A, B> operator()(const A &a, const B &b) const \
+      {                                                                        \
+         return FUNC(a, b);                                                    \
+      }                                                                        \
+   };
+
+TVEC_EXPR_UNARY_OPERATOR_OP(UnaryPlus, +)
+TVEC_EXPR_UNARY_OPERATOR_OP(Negate, -)
+TVEC_EXPR_UNARY_OPERATOR_OP(BitNot, ~)
+TVEC_EXPR_UNARY_OPERATOR_OP(Not, !)
+
+TVEC_EXPR_BINARY_OPERATOR_OP(Plus, +)
+TVEC_EXPR_BINARY_OPERATOR_OP(Minus, -)
+TVEC_EXPR_BINARY_OPERATOR_OP(Multiplies, *)
+TVEC_EXPR_BINARY_OPERATOR_OP(Divides, /)
+TVEC_EXPR_BINARY_OPERATOR_OP(Modulus, %)
+TVEC_EXPR_BINARY_OPERATOR_OP(BitXor, ^)
+TVEC_EXPR_BINARY_OPERATOR_OP(BitOr, |)
+TVEC_EXPR_BINARY_OPERATOR_OP(BitAnd, &)
+
+TVEC_EXPR_LOGICAL_OPERATOR_OP(Less, <)
+TVEC_EXPR_LOGICAL_OPERATOR_OP(Greater, >)
+TVEC_EXPR_LOGICAL_OPERATOR_OP(EqualTo, ==)
+TVEC_EXPR_LOGICAL_OPERATOR_OP(NotEqualTo, !=)
+TVEC_EXPR_LOGICAL_OPERATOR_OP(LessEqual, <=)
+TVEC_EXPR_LOGICAL_OPERATOR_OP(GreaterEqual, >=)
+TVEC_EXPR_LOGICAL_OPERATOR_OP(LogicalAnd, &&)
+TVEC_EXPR_LOGICAL_OPERATOR_OP(LogicalOr, ||)
+
+#define TVEC_EXPR_STD_UNARY_FUNCTION_OP(F) TVEC_EXPR_UNARY_FUNCTION_OP(F, std::F)
+#define TVEC_EXPR_STD_BINARY_FUNCTION_OP(F) TVEC_EXPR_BINARY_FUNCTION_OP(F, std::F)
+
+TVEC_EXPR_STD_UNARY_FUNCTION_OP(abs)
+TVEC_EXPR_STD_BINARY_FUNCTION_OP(fdim)
+TVEC_EXPR_STD_BINARY_FUNCTION_OP(fmod)
+TVEC_EXPR_STD_BINARY_FUNCTION_OP(remainder)
+TVEC_EXPR_STD_UNARY_FUNCTION_OP(exp)
+TVEC_EXPR_STD_UNARY_FUNCTION_OP(exp2)
+TVEC_EXPR_STD_UNARY_FUNCTION_OP(expm1)
+TVEC_EXPR_STD_UNARY_FUNCTION_OP(log)
+TVEC_EXPR_STD_UNARY_FUNCTION_OP(log10)
+TVEC_EXPR_STD_UNARY_FUNCTION_OP(log2)
+TVEC_EXPR_STD_UNARY_FUNCTION_OP(log1p)
+TVEC_EXPR_STD_BINARY_FUNCTION_OP(pow)
+TVEC_EXPR_STD_UNARY_FUNCTION_OP(sqrt)
+TVEC_EXPR_STD_UNARY_FUNCTION_OP(cbrt)
+TVEC_EXPR_STD_BINARY_FUNCTION_OP(hypot)
+TVEC_EXPR_STD_UNARY_FUNCTION_OP(sin)
+TVEC_EXPR_STD_UNARY_FUNCTION_OP(cos)
+TVEC_EXPR_STD_UNARY_FUNCTION_OP(tan)
+TVEC_EXPR_STD_UNARY_FUNCTION_OP(asin)
+TVEC_EXPR_STD_UNARY_FUNCTION_OP(acos)
+TVEC_EXPR_STD_UNARY_FUNCTION_OP(atan)
+TVEC_EXPR_STD_BINARY_FUNCTION_OP(atan2)
+TVEC_EXPR_STD_UNARY_FUNCTION_OP(sinh)
+TVEC_EXPR_STD_UNARY_FUNCTION_OP(cosh)
+TVEC_EXPR_STD_UNARY_FUNCTION_OP(tanh)
+TVEC_EXPR_STD_UNARY_FUNCTION_OP(asinh)
+TVEC_EXPR_STD_UNARY_FUNCTION_OP(acosh)
+TVEC_EXPR_STD_UNARY_FUNCTION_OP(atanh)
+TVEC_EXPR_STD_UNARY_FUNCTION_OP(floor)
+TVEC_EXPR_STD_UNARY_FUNCTION_OP(ceil)
+TVEC_EXPR_STD_UNARY_FUNCTION_OP(trunc)
+TVEC_EXPR_STD_UNARY_FUNCTION_OP(round)
+TVEC_EXPR_STD_UNARY_FUNCTION_OP(erf)
+TVEC_EXPR_STD_UNARY_FUNCTION_OP(erfc)
+TVEC_EXPR_STD_UNARY_FUNCTION_OP(lgamma)
+TVEC_EXPR_STD_UNARY_FUNCTION_OP(tgamma)
+
+#undef TVEC_EXPR_STD_UNARY_FUNCTION_OP
+#undef TVEC_EXPR_STD_BINARY_FUNCTION_OP
+#undef TVEC_EXPR_UNARY_OPERATOR_OP
+#undef TVEC_EXPR_BINARY_OPERATOR_OP
+#undef TVEC_EXPR_LOGICAL_OPERATOR_OP
+#undef TVEC_EXPR_UNARY_FUNCTION_OP
+#undef TVEC_EXPR_BINARY_FUNCTION_OP
+
+} // End of ExprOps NS
+/// \endcond
+
+} // End of VecOps NS
+} // End of Detail NS
+
+namespace VecOps {
+
+// clang-format off
+/**
+\class ROOT::VecOps::RVecExpr
+\ingroup vecops
+\brief A lazily evaluated expression of RVecs
+\tparam Node_t The type of the tree of operations of the expression
+
+A RVecExpr records the operations applied to its operands, RVecs and scalars, without computing them.
+Its elements are computed on demand: converting the expression to a RVec evaluates all of them in a
+single loop, without allocating one temporary RVec per operation. Reductions such as Sum, Mean, Any and
+All are computed without materialising the expression at all.
+
+An expression is started from a RVec with Lazy(). The arithmetic, comparison and logical operators, as
+well as the mathematical functions offered for RVecs, then build expressions when one of their
+operands is an expression:
+~~~{.cpp}
+using namespace ROOT::VecOps;
+RVec<float> px {10.f, 2.f, 30.f}, py {5.f, 1.f, 4.f}, eta {1.f, 0.5f, 3.f};
+RVec<int> goodJet = sqrt(Lazy(px) * px + Lazy(py) * py) > 10.f && abs(Lazy(eta)) < 2.4f;
+auto nGoodJets = Sum(sqrt(Lazy(px) * px + Lazy(py) * py) > 10.f);
+auto goodPx = px[sqrt(Lazy(px) * px + Lazy(py) * py) > 10.f];
+~~~
+Operations between plain RVecs are computed eagerly as usual, e.g. `py * py` in `Lazy(px) * px + py * py`,
+and enter the expression as temporary RVecs: every sub-expression to be fused must start from Lazy().
+An expression refers to the RVecs it was built from, which must outlive it, except for the temporary
+RVecs, which it takes over. The usual rules of the element types apply: comparisons and logical
+operators give int, mathematical functions give floating point numbers. Operands of different sizes
+are reported as soon as the expression is built.
+**/
+// clang-format on
+template <typename Node_t>
+class RVecExpr {
+   Node_t fNode;
+
+public:
+   using value_type = typename Node_t::value_type;
+   using size_type = std::size_t;
+
+   explicit RVecExpr(const Node_t &node) : fNode(node) {}
+   explicit RVecExpr(Node_t &&node) : fNode(std::move(node)) {}
+
+   size_type size() const { return fNode.size(); }
+   bool empty() const { return fNode.size() == 0; }
+   /// Compute one element of the expression
+   value_type operator[](size_type i) const { return fNode[i]; }
+   const Node_t &GetNode() const { return fNode; }
+
+   /// Compute all the elements of the expression, in a single loop
+   template <typename T = value_type>
+   RVec<T> Eval() const
+   {
+      const size_type n = fNode.size();
+      RVec<T> ret(n);
+      for (size_type i = 0; i < n; ++i)
+         ret[i] = fNode[i];
+      return ret;
+   }
+
+   template <typename T>
+   operator RVec<T>() const
+   {
+      return Eval<T>();
+   }
+};
+
+/// Start a lazily evaluated expression with the elements of an RVec
+///
+/// Example code, at the ROOT prompt:
+/// ~~~{.cpp}
+/// using namespace ROOT::VecOps;
+/// RVec<double> v {1., 2., 3.};
+/// RVec<double> w = 2. * Lazy(v) + v * v;
+/// w
+/// // (ROOT::VecOps::RVec<double> &) { 3.0000000, 8.0000000, 15.000000 }
+/// ~~~
+template <typename T>
+RVecExpr<Detail::VecOps::RVecRefNode<T>> Lazy(const RVec<T> &v)
+{
+   return RVecExpr<Detail::VecOps::RVecRefNode<T>>(v);
+}
+
+/// Start a lazily evaluated expression with the elements of a temporary RVec, which the expression takes over
+template <typename T>
+RVecExpr<Detail::VecOps::RVecValueNode<T>> Lazy(RVec<T> &&v)
+{
+   return RVecExpr<Detail::VecOps::RVecValueNode<T>>(Detail::VecOps::RVecValueNode<T>(std::move(v)));
+}
+
+/// The expression itself: it is already lazy
+template <typename Node_t>
+const RVecExpr<Node_t> &Lazy(const RVecExpr<Node_t> &e)
+{
+   return e;
+}
+
+#define TVEC_EXPR_UNARY(NAME, OP)                                              \
+template <typename N>                                                          \
+auto NAME(const RVecExpr<N> &e)                                                \
+  -> RVecExpr<Detail::VecOps::RUnaryNode<Detail::VecOps::ExprOps::OP, N>>      \
+{                                                                              \
+   using Node_t = Detail::VecOps::RUnaryNode<Detail::VecOps::ExprOps::OP, N>;  \
+   return RVecExpr<Node_t>(Node_t(e.GetNode()));                               \
+}                                                                              \
+
+#define TVEC_EXPR_BINARY(NAME, OP, MSG)                                        \
+template <typename L, typename R>                                              \
+auto NAME(const RVecExpr<L> &l, const RVecExpr<R> &r)                          \
+  -> RVecExpr<Detail::VecOps::RBinaryNode<Detail::VecOps::ExprOps::OP, L, R>>  \
+{                                                                              \
+   using Node_t = Detail::VecOps::RBinaryNode<Detail::VecOps::ExprOps::OP, L, R>; \
+   return RVecExpr<Node_t>(Node_t(l.GetNode(), r.GetNode(), MSG));             \
+}                                                                              \
+                                                                               \
+template <typename L, typename T>                                              \
+auto NAME(const RVecExpr<L> &l, const RVec<T> &v)                              \
+  -> RVecExpr<Detail::VecOps::RBinaryNode<Detail::VecOps::ExprOps::OP, L,      \
+                                          Detail::VecOps::RVecRefNode<T>>>     \
+{                                                                              \
+   using Node_t = Detail::VecOps::RBinaryNode<Detail::VecOps::ExprOps::OP, L,  \
+                                              Detail::VecOps::RVecRefNode<T>>; \
+   return RVecExpr<Node_t>(Node_t(l.GetNode(), v, MSG));                       \
+}                                                                              \
+                                                                               \
+template <typename T, typename R>                                              \
+auto NAME(const RVec<T> &v, const RVecExpr<R> &r)                              \
+  -> RVecExpr<Detail::VecOps::RBinaryNode<Detail::VecOps::ExprOps::OP,         \
+                                          Detail::VecOps::RVecRefNode<T>, R>>  \
+{                                                                              \
+   using Node_t = Detail::VecOps::RBinaryNode<Detail::VecOps::ExprOps::OP,     \
+                                              Detail::VecOps::RVecRefNode<T>, R>; \
+   return RVecExpr<Node_t>(Node_t(v, r.GetNode(), MSG));                       \
+}                                                                              \
+                                                                               \
+template <typename L, typename T>                                              \
+auto NAME(const RVecExpr<L> &l, RVec<T> &&v)                                   \
+  -> RVecExpr<Detail::VecOps::RBinaryNode<Detail::VecOps::ExprOps::OP, L,      \
+                                          Detail::VecOps::RVecValueNode<T>>>   \
+{                                                                              \
+   using Node_t = Detail::VecOps::RBinaryNode<Detail::VecOps::ExprOps::OP, L,  \
+                                              Detail::VecOps::RVecValueNode<T>>; \
+   return RVecExpr<Node_t>(Node_t(l.GetNode(), std::move(v), MSG));            \
+}                                                                              \
+                                                                               \
+template <typename T, typename R>                                              \
+auto NAME(RVec<T> &&v, const RVecExpr<R> &r)                                   \
+  -> RVecExpr<Detail::VecOps::RBinaryNode<Detail::VecOps::ExprOps::OP,         \
+                                          Detail::VecOps::RVecValueNode<T>, R>> \
+{                                                                              \
+   using Node_t = Detail::VecOps::RBinaryNode<Detail::VecOps::ExprOps::OP,     \
+                                              Detail::VecOps::RVecValueNode<T>, R>; \
+   return RVecExpr<Node_t>(Node_t(std::move(v), r.GetNode(), MSG));            \
+}                                                                              \
+                                                                               \
+template <typename L, typename T>                                              \
+auto NAME(const RVecExpr<L> &l, const T &y)                                    \
+  -> RVecExpr<Detail::VecOps::RBinaryNode<Detail::VecOps::ExprOps::OP, L,      \
+                                          Detail::VecOps::RScalarNode<T>>>     \
+{                                                                              \
+   using Node_t = Detail::VecOps::RBinaryNode<Detail::VecOps::ExprOps::OP, L,  \
+                                              Detail::VecOps::RScalarNode<T>>; \
+   return RVecExpr<Node_t>(Node_t(l.GetNode(), y, MSG));                       \
+}                                                                              \
+                                                                               \
+template <typename T, typename R>                                              \
+auto NAME(const T &x, const RVecExpr<R> &r)                                    \
+  -> RVecExpr<Detail::VecOps::RBinaryNode<Detail::VecOps::ExprOps::OP,         \
+                                          Detail::VecOps::RScalarNode<T>, R>>  \
+{                                                                              \
+   using Node_t = Detail::VecOps::RBinaryNode<Detail::VecOps::ExprOps::OP,     \
+                                              Detail::VecOps::RScalarNode<T>, R>; \
+   return RVecExpr<Node_t>(Node_t(x, r.GetNode(), MSG));                       \
+}                                                                              \
+
+TVEC_EXPR_UNARY(operator+, UnaryPlus)
+TVEC_EXPR_UNARY(operator-, Negate)
+TVEC_EXPR_UNARY(operator~, BitNot)
+TVEC_EXPR_UNARY(operator!, Not)
+
+TVEC_EXPR_BINARY(operator+, Plus, ERROR_MESSAGE(+))
+TVEC_EXPR_BINARY(operator-, Minus, ERROR_MESSAGE(-))
+TVEC_EXPR_BINARY(operator*, Multiplies, ERROR_MESSAGE(*))
+TVEC_EXPR_BINARY(operator/, Divides, ERROR_MESSAGE(/))
+TVEC_EXPR_BINARY(operator%, Modulus, ERROR_MESSAGE(%))
+TVEC_EXPR_BINARY(operator^, BitXor, ERROR_MESSAGE(^))
+TVEC_EXPR_BINARY(operator|, BitOr, ERROR_MESSAGE(|))
+TVEC_EXPR_BINARY(operator&, BitAnd, ERROR_MESSAGE(&))
+
+TVEC_EXPR_BINARY(operator<, Less, ERROR_MESSAGE(<))
+TVEC_EXPR_BINARY(operator>, Greater, ERROR_MESSAGE(>))
+TVEC_EXPR_BINARY(operator==, EqualTo, ERROR_MESSAGE(==))
+TVEC_EXPR_BINARY(operator!=, NotEqualTo, ERROR_MESSAGE(!=))
+TVEC_EXPR_BINARY(operator<=, LessEqual, ERROR_MESSAGE(<=))
+TVEC_EXPR_BINARY(operator>=, GreaterEqual, ERROR_MESSAGE(>=))
+TVEC_EXPR_BINARY(operator&&, LogicalAnd, ERROR_MESSAGE(&&))
+TVEC_EXPR_BINARY(operator||, LogicalOr, ERROR_MESSAGE(||))
+
+#define TVEC_EXPR_STD_UNARY_FUNCTION(F) TVEC_EXPR_UNARY(F, F)
+#define TVEC_EXPR_STD_BINARY_FUNCTION(F) TVEC_EXPR_BINARY(F, F, ERROR_MESSAGE(F))
+
+TVEC_EXPR_STD_UNARY_FUNCTION(abs)
+TVEC_EXPR_STD_BINARY_FUNCTION(fdim)
+TVEC_EXPR_STD_BINARY_FUNCTION(fmod)
+TVEC_EXPR_STD_BINARY_FUNCTION(remainder)
+TVEC_EXPR_STD_UNARY_FUNCTION(exp)
+TVEC_EXPR_STD_UNARY_FUNCTION(exp2)
+TVEC_EXPR_STD_UNARY_FUNCTION(expm1)
+TVEC_EXPR_STD_UNARY_FUNCTION(log)
+TVEC_EXPR_STD_UNARY_FUNCTION(log10)
+TVEC_EXPR_STD_UNARY_FUNCTION(log2)
+TVEC_EXPR_STD_UNARY_FUNCTION(log1p)
+TVEC_EXPR_STD_BINARY_FUNCTION(pow)
+TVEC_EXPR_STD_UNARY_FUNCTION(sqrt)
+TVEC_EXPR_STD_UNARY_FUNCTION(cbrt)
+TVEC_EXPR_STD_BINARY_FUNCTION(hypot)
+TVEC_EXPR_STD_UNARY_FUNCTION(sin)
+TVEC_EXPR_STD_UNARY_FUNCTION(cos)
+TVEC_EXPR_STD_UNARY_FUNCTION(tan)
+TVEC_EXPR_STD_UNARY_FUNCTION(asin)
+TVEC_EXPR_STD_UNARY_FUNCTION(acos)
+TVEC_EXPR_STD_UNARY_FUNCTION(atan)
+TVEC_EXPR_STD_BINARY_FUNCTION(atan2)
+TVEC_EXPR_STD_UNARY_FUNCTION(sinh)
+TVEC_EXPR_STD_UNARY_FUNCTION(cosh)
+TVEC_EXPR_STD_UNARY_FUNCTION(tanh)
+TVEC_EXPR_STD_UNARY_FUNCTION(asinh)
+TVEC_EXPR_STD_UNARY_FUNCTION(acosh)
+TVEC_EXPR_STD_UNARY_FUNCTION(atanh)
+TVEC_EXPR_STD_UNARY_FUNCTION(floor)
+TVEC_EXPR_STD_UNARY_FUNCTION(ceil)
+TVEC_EXPR_STD_UNARY_FUNCTION(trunc)
+TVEC_EXPR_STD_UNARY_FUNCTION(round)
+TVEC_EXPR_STD_UNARY_FUNCTION(erf)
+TVEC_EXPR_STD_UNARY_FUNCTION(erfc)
+TVEC_EXPR_STD_UNARY_FUNCTION(lgamma)
+TVEC_EXPR_STD_UNARY_FUNCTION(tgamma)
+
+#undef TVEC_EXPR_STD_UNARY_FUNCTION
+#undef TVEC_EXPR_STD_BINARY_FUNCTION
+#undef TVEC_EXPR_UNARY
+#undef TVEC_EXPR_BINARY
+
+/// Sum the elements of a lazy expression, computing them in a single loop
+template <typename N>
+typename RVecExpr<N>::value_type Sum(const RVecExpr<N> &e)
+{
+   using T = typename RVecExpr<N>::value_type;
+   const std::size_t n = e.size();
+   T sum(0);
+   for (std::size_t i = 0; i < n; ++i)
+      sum += e[i];
+   return sum;
+}
+
+/// Get the mean of the elements of a lazy expression
+template <typename N>
+double Mean(const RVecExpr<N> &e)
+{
+   if (e.empty()) return 0.;
+   return double(Sum(e)) / e.size();
+}
+
+/// Return true if any of the elements of a lazy expression equates to true, computing them until one does
+template <typename N>
+bool Any(const RVecExpr<N> &e)
+{
+   const std::size_t n = e.size();
+   for (std::size_t i = 0; i < n; ++i)
+      if (e[i] == true)
+         return true;
+   return false;
+}
+
+/// Return true if all of the elements of a lazy expression equate to true, computing them until one does not
+template <typename N>
+bool All(const RVecExpr<N> &e)
+{
+   const std::size_t n = e.size();
+   for (std::size_t i = 0; i < n; ++i)
+      if (e[i] == false)
+         return false;
+   return true;
+}
+
+/// Return the elements of a lazy expression passing the filter expressed by the predicate
+template <typename N, typename F>
+RVec<typename RVecExpr<N>::value_type> Filter(const RVecExpr<N> &e, F &&f)
+{
+   const std::size_t n = e.size();
+   RVec<typename RVecExpr<N>::value_type> w;
+   w.reserve(n);
+   for (std::size_t i = 0; i < n; ++i) {
+      auto val = e[i];
+      if (f(val))
+         w.emplace_back(val);
+   }
+   return w;
+}
+
+/// Return the indices that sort the elements of a lazy expression
+template <typename N>
+RVec<std::size_t> Argsort(const RVecExpr<N> &e)
+{
+   return Argsort(e.Eval());
+}
+
+/// Return the elements of a lazy expression at the given indices: only these are computed
+template <typename N>
+RVec<typename RVecExpr<N>::value_type> Take(const RVecExpr<N> &e, const RVec<std::size_t> &i)
+{
+   const std::size_t isize = i.size();
+   RVec<typename RVecExpr<N>::value_type> r(isize);
+   for (std::size_t k = 0; k < isize; k++)
+      r[k] = e[i[k]];
+   return r;
+}
+
+/// Return the first `n` elements of a lazy expression if `n > 0`, its last ones if `n < 0`: only these are computed
+template <typename N>
+RVec<typename RVecExpr<N>::value_type> Take(const RVecExpr<N> &e, const int n)
+{
+   const std::size_t size = e.size();
+   const std::size_t absn = std::abs(n);
+   if (absn > size) {
+      std::stringstream ss;
+      ss << "Try to take " << absn << " elements but vector has only size " << size << ".";
+      throw std::runtime_error(ss.str());
+   }
+   RVec<typename RVecExpr<N>::value_type> r(absn);
+   const std::size_t offset = n < 0 ? size - absn : 0;
+   for (std::size_t k = 0; k < absn; k++)
+      r[k] = e[offset + k];
+   return r;
+}
+
+///@}
+
 ////////////////////////////////////////////////////////////////////////////////
 /// Print a RVec at the prompt:
 template <class T>
@@ -0,0 +1,345 @@
+/*************************************************************************
+ * Copyright (C) 1995-2018, Rene Brun and Fons Rademakers.               *
+ * All rights reserved.                                                  *
+ *                                                                       *
+ * For the licensing terms see $ROOTSYS/LICENSE.                         *
+ * For the list of contributors see $ROOTSYS/README/CREDITS.             *
+ *************************************************************************/
+
+// Overloads of the RVec mathematical functions for float and double, processing the elements by SIMD
+// vectors of ROOT::Float_v and ROOT::Double_v.
+
+#include "ROOT/RVec.hxx"
+#include "Math/Types.h"
+
+#include <algorithm>
+#include <cmath>
+#include <stdexcept>
+
+namespace {
+
+using ROOT::VecOps::RVec;
+
+#ifdef R__HAS_VECCORE
+
+template <typename V>
+constexpr std::size_t VectorSize()
+{
+   return vecCore::VectorSize<V>();
+}
+
+template <typename V, typename T>
+V Load(const T *p)
+{
+   V v;
+   vecCore::Load(v, p);
+   return v;
+}
+
+template <typename V, typename T>
+void Store(const V &v, T *p)
+{
+   vecCore::Store(v, p);
+}
+
+using vecCore::math::ATan2;
+using vecCore::math::Cos;
+using vecCore::math::Exp;
+using vecCore::math::Floor;
+using vecCore::math::Log;
+using vecCore::math::Max;
+using vecCore::math::Pow;
+using vecCore::math::Sin;
+using vecCore::math::Sqrt;
+
+#else // R__HAS_VECCORE
+
+// ROOT::Float_v and ROOT::Double_v are float and double: one element at a time
+
+template <typename V>
+constexpr std::size_t VectorSize()
+{
+   return 1;
+}
+
+template <typename V, typename T>
+V Load(const T *p)
+{
+   return *p;
+}
+
+template <typename V, typename T>
+void Store(const V &v, T *p)
+{
+   *p = v;
+}
+
+template <typename T>
+T ATan2(T y, T x)
+{
+   return std::atan2(y, x);
+}
+
+template <typename T>
+T Cos(T x)
+{
+   return std::cos(x);
+}
+
+template <typename T>
+T Exp(T x)
+{
+   return std::exp(x);
+}
+
+template <typename T>
+T Floor(T x)
+{
+   return std::floor(x);
+}
+
+template <typename T>
+T Log(T x)
+{
+   return std::log(x);
+}
+
+template <typename T>
+T Max(T x, T y)
+{
+   return std::max(x, y);
+}
+
+template <typename T>
+T Pow(T x, T y)
+{
+   return std::pow(x, y);
+}
+
+template <typename T>
+T Sin(T x)
+{
+   return std::sin(x);
+}
+
+template <typename T>
+T Sqrt(T x)
+{
+   return std::sqrt(x);
+}
+
+#endif // R__HAS_VECCORE
+
+template <typename T>
+struct VectorType;
+
+template <>
+struct VectorType<float> {
+   using Type = ROOT::Float_v;
+};
+
+template <>
+struct VectorType<double> {
+   using Type = ROOT::Double_v;
+};
+
+void CheckSizes(std::size_t, const char *) {}
+
+template <typename T, typename... Args>
+void CheckSizes(std::size_t size, const char *name, const RVec<T> &v, const Args &... args)
+{
+   if (v.size() != size)
+      throw std::runtime_error(std::string("Cannot compute ") + name + " of vectors of different sizes");
+   CheckSizes(size, name, args...);
+}
+
+// Apply the function object f, whose call operator is a template, to the SIMD vectors of elements of the
+// RVecs, then to the remaining elements
+template <typename F, typename T, typename... Args>
+RVec<T> Map(const char *name, F f, const RVec<T> &v, const Args &... args)
+{
+   using V = typename VectorType<T>::Type;
+   const std::size_t size = v.size();
+   CheckSizes(size, name, args...);
+
+   RVec<T> r(size);
+   const std::size_t vsize = VectorSize<V>();
+   std::size_t i = 0;
+   for (; i + vsize <= size; i += vsize)
+      Store(f(Load<V>(&v[i]), Load<V>(&args[i])...), &r[i]);
+   for (; i < size; ++i)
+      r[i] = f(v[i], args[i]...);
+   return r;
+}
+
+#define TVEC_VECTORISED_UNARY_OP(NAME, FUNC) \
+   struct NAME {                              \
+      template <typename V>                   \
+      V operator()(const V &x) const          \
+      {                                       \
+         return FUNC(x);                      \
+      }                                       \
+   };
+
+TVEC_VECTORISED_UNARY_OP(ExpOp, Exp)
+TVEC_VECTORISED_UNARY_OP(LogOp, Log)
+TVEC_VECTORISED_UNARY_OP(SinOp, Sin)
+TVEC_VECTORISED_UNARY_OP(CosOp, Cos)
+TVEC_VECTORISED_UNARY_OP(SqrtOp, Sqrt)
+#undef TVEC_VECTORISED_UNARY_OP
+
+struct ATan2Op {
+   template <typename V>
+   V operator()(const V &y, const V &x) const
+   {
+      return ATan2(y, x);
+   }
+};
+
+struct PowOp {
+   template <typename V>
+   V operator()(const V &x, const V &y) const
+   {
+      return Pow(x, y);
+   }
+};
+
+template <typename T>
+struct PowScalarOp {
+   T fY;
+   template <typename V>
+   V operator()(const V &x) const
+   {
+      return Pow(x, V(fY));
+   }
+};
+
+template <typename T>
+struct DeltaPhiOp {
+   T fC;
+   template <typename V>
+   V operator()(const V &v1, const V &v2) const
+   {
+      const V d = v2 - v1;
+      return d - V(T(2) * fC) * Floor(d / V(T(2) * fC) + V(T(0.5)));
+   }
+};
+
+template <typename T>
+struct DeltaROp {
+   T fC;
+   template <typename V>
+   V operator()(const V &eta1, const V &eta2, const V &phi1, const V &phi2) const
+   {
+      const V deta = eta2 - eta1;
+      const V dphi = DeltaPhiOp<T>{fC}(phi1, phi2);
+      return Sqrt(deta * deta + dphi * dphi);
+   }
+};
+
+template <typename T>
+struct InvariantMassesOp {
+   template <typename V>
+   V operator()(const V &pt1, const V &eta1, const V &phi1, const V &mass1, const V &pt2, const V &eta2,
+                const V &phi2, const V &mass2) const
+   {
+      const V half(T(0.5));
+      // sinh computed from exp, which all the backends vectorise
+      const V expEta1 = Exp(eta1);
+      const V expEta2 = Exp(eta2);
+      const V pz1 = pt1 * half * (expEta1 - V(T(1)) / expEta1);
+      const V pz2 = pt2 * half * (expEta2 - V(T(1)) / expEta2);
+      const V e1 = Sqrt(pt1 * pt1 + pz1 * pz1 + mass1 * mass1);
+      const V e2 = Sqrt(pt2 * pt2 + pz2 * pz2 + mass2 * mass2);
+      const V px = pt1 * Cos(phi1) + pt2 * Cos(phi2);
+      const V py = pt1 * Sin(phi1) + pt2 * Sin(phi2);
+      const V pz = pz1 + pz2;
+      const V e = e1 + e2;
+      return Sqrt(Max(e * e - px * px - py * py - pz * pz, V(T(0))));
+   }
+};
+
+} // namespace
+
+namespace ROOT {
+namespace VecOps {
+
+#define TVEC_VECTORISED_UNARY_FUNCTION(NAME, OP)                          \
+   RVec<float> NAME(const RVec<float> &v) { return Map(#NAME, OP(), v); } \
+   RVec<double> NAME(const RVec<double> &v) { return Map(#NAME, OP(), v); }
+
+TVEC_VECTORISED_UNARY_FUNCTION(exp, ExpOp)
+TVEC_VECTORISED_UNARY_FUNCTION(log, LogOp)
+TVEC_VECTORISED_UNARY_FUNCTION(sin, SinOp)
+TVEC_VECTORISED_UNARY_FUNCTION(cos, CosOp)
+TVEC_VECTORISED_UNARY_FUNCTION(sqrt, SqrtOp)
+#undef TVEC_VECTORISED_UNARY_FUNCTION
+
+RVec<float> atan2(const RVec<float> &v0, const RVec<float> &v1)
+{
+   return Map("atan2", ATan2Op(), v0, v1);
+}
+
+RVec<double> atan2(const RVec<double> &v0, const RVec<double> &v1)
+{
+   return Map("atan2", ATan2Op(), v0, v1);
+}
+
+RVec<float> pow(const RVec<float> &v0, const RVec<float> &v1)
+{
+   return Map("pow", PowOp(), v0, v1);
+}
+
+RVec<double> pow(const RVec<double> &v0, const RVec<double> &v1)
+{
+   return Map("pow", PowOp(), v0, v1);
+}
+
+RVec<float> pow(const RVec<float> &v, float y)
+{
+   return Map("pow", PowScalarOp<float>{y}, v);
+}
+
+RVec<double> pow(const RVec<double> &v, double y)
+{
+   return Map("pow", PowScalarOp<double>{y}, v);
+}
+
+RVec<float> DeltaPhi(const RVec<float> &v1, const RVec<float> &v2, const float c)
+{
+   return Map("DeltaPhi", DeltaPhiOp<float>{c}, v1, v2);
+}
+
+RVec<double> DeltaPhi(const RVec<double> &v1, const RVec<double> &v2, const double c)
+{
+   return Map("DeltaPhi", DeltaPhiOp<double>{c}, v1, v2);
+}
+
+RVec<float> DeltaR(const RVec<float> &eta1, const RVec<float> &eta2, const RVec<float> &phi1,
+                   const RVec<float> &phi2, const float c)
+{
+   return Map("DeltaR", DeltaROp<float>{c}, eta1, eta2, phi1, phi2);
+}
+
+RVec<double> DeltaR(const RVec<double> &eta1, const RVec<double> &eta2, const RVec<double> &phi1,
+                    const RVec<double> &phi2, const double c)
+{
+   return Map("DeltaR", DeltaROp<double>{c}, eta1, eta2, phi1, phi2);
+}
+
+RVec<float> InvariantMasses(const RVec<float> &pt1, const RVec<float> &eta1, const RVec<float> &phi1,
+                            const RVec<float> &mass1, const RVec<float> &pt2, const RVec<float> &eta2,
+                            const RVec<float> &phi2, const RVec<float> &mass2)
+{
+   return Map("InvariantMasses", InvariantMassesOp<float>(), pt1, eta1, phi1, mass1, pt2, eta2, phi2, mass2);
+}
+
+RVec<double> InvariantMasses(const RVec<double> &pt1, const RVec<double> &eta1, const RVec<double> &phi1,
+                             const RVec<double> &mass1, const RVec<double> &pt2, const RVec<double> &eta2,
+                             const RVec<double> &phi2, const RVec<double> &mass2)
+{
+   return Map("InvariantMasses", InvariantMassesOp<double>(), pt1, eta1, phi1, mass1, pt2, eta2, phi2, mass2);
+}
+
+} // namespace VecOps
+} // namespace ROOT
@@ -98,3 +98,35 @@ TEST(RAdoptAllocator, Traits)
 
 }
 
+
+TEST(RAdoptAllocator, InlineStorage)
+{
+   double buffer[4];
+   bool inUse = false;
+   RAdoptAllocator<double> alloc(nullptr, buffer, 4, &inUse);
+   std::vector<double, RAdoptAllocator<double>> v(alloc);
+   v.reserve(4);
+   EXPECT_EQ(buffer, v.data());
+   EXPECT_TRUE(inUse);
+   for (int i = 0; i < 4; ++i)
+      v.emplace_back(i);
+   EXPECT_EQ(buffer, v.data());
+
+   v.emplace_back(4.);
+   EXPECT_NE(buffer, v.data());
+   EXPECT_FALSE(inUse);
+   for (int i = 0; i < 5; ++i)
+      EXPECT_EQ(i, v[i]);
+
+   // copies of the vector do not use the inline storage
+   v.resize(2);
+   v.shrink_to_fit();
+   EXPECT_EQ(buffer, v.data());
+   auto copy = v;
+   EXPECT_NE(buffer, copy.data());
+   EXPECT_EQ(2u, copy.size());
+
+   v.clear();
+   v.shrink_to_fit();
+   EXPECT_FALSE(inUse);
+}
@@ -5,6 +5,8 @@
 #include <TInterpreter.h>
 #include <TTree.h>
 #include <TSystem.h>
+#include <cmath>
+#include <limits>
 #include <vector>
 #include <sstream>
 
@@ -101,6 +103,119 @@ TEST(VecOps, MoveCtor)
    EXPECT_EQ(v2.size(), 3u);
 }
 
+// true if the elements of v are stored inside the RVec object itself
+template <typename T>
+bool IsInline(const RVec<T> &v)
+{
+   auto begin = reinterpret_cast<const char *>(&v);
+   auto data = reinterpret_cast<const char *>(v.data());
+   return data >= begin && data < begin + sizeof(v);
+}
+
+TEST(VecOps, InlineStorage)
+{
+   const auto n = RVecInlineSize<double>::value;
+   EXPECT_EQ(n, 8u);
+   RVec<double> v;
+   EXPECT_EQ(v.capacity(), n);
+   for (unsigned int i = 0; i < n; ++i)
+      v.push_back(i);
+   EXPECT_TRUE(IsInline(v));
+   v.push_back(n);
+   EXPECT_FALSE(IsInline(v));
+   for (unsigned int i = 0; i <= n; ++i)
+      EXPECT_EQ(v[i], i);
+
+   RVec<double> w{1., 2., 3.};
+   EXPECT_TRUE(IsInline(w));
+   auto sum = w + v[2];
+   EXPECT_TRUE(IsInline(sum));
+   CheckEqual(sum, RVec<double>{3., 4., 5.});
+   auto copy = v;
+   EXPECT_FALSE(IsInline(copy));
+   CheckEqual(copy, v);
+
+   // large types are not stored inline
+   RVec<RVec<double>> vv{w, w};
+   EXPECT_FALSE(IsInline(vv));
+   CheckEqual(vv[1], w);
+}
+
+TEST(VecOps, InlineStorageMove)
+{
+   RVec<int> small{1, 2, 3};
+   RVec<int> large(100u, 7);
+   const auto largeData = large.data();
+
+   RVec<int> a(std::move(small));
+   EXPECT_TRUE(IsInline(a));
+   EXPECT_EQ(small.size(), 0u);
+   CheckEqual(a, RVec<int>{1, 2, 3});
+
+   RVec<int> b(std::move(large));
+   EXPECT_EQ(b.data(), largeData);
+   EXPECT_EQ(large.size(), 0u);
+
+   a.swap(b);
+   EXPECT_EQ(a.data(), largeData);
+   EXPECT_TRUE(IsInline(b));
+   CheckEqual(b, RVec<int>{1, 2, 3});
+   EXPECT_EQ(a.size(), 100u);
+
+   b = std::move(a);
+   EXPECT_EQ(b.data(), largeData);
+   b.resize(2);
+   b.shrink_to_fit();
+   EXPECT_TRUE(IsInline(b));
+   CheckEqual(b, RVec<int>{7, 7});
+
+   // moved-from RVecs are still usable, with their inline storage
+   a.push_back(4);
+   EXPECT_TRUE(IsInline(a));
+   small = a;
+   CheckEqual(small, RVec<int>{4});
+
+   std::vector<RVec<int>> vs;
+   for (int i = 0; i < 10; ++i)
+      vs.emplace_back(RVec<int>(std::size_t(i), i));
+   for (int i = 0; i < 10; ++i) {
+      EXPECT_TRUE(IsInline(vs[i]));
+      CheckEqual(vs[i], RVec<int>(std::size_t(i), i));
+   }
+}
+
+TEST(VecOps, InlineStorageAdopt)
+{
+   std::vector<float> model{1.f, 2.f, 3.f};
+   RVec<float> v(model.data(), model.size());
+   EXPECT_EQ(v.data(), model.data());
+   v.push_back(4.f);
+   EXPECT_TRUE(IsInline(v));
+   CheckEqual(v, RVec<float>{1.f, 2.f, 3.f, 4.f});
+   CheckEqual(model, std::vector<float>{1.f, 2.f, 3.f});
+
+   RVec<float> proxy(model.data(), model.size());
+   RVec<float> moved(std::move(proxy));
+   EXPECT_EQ(moved.data(), model.data());
+   moved[0] = 42.f;
+   EXPECT_EQ(model[0], 42.f);
+
+   // moving into a RVec which adopts memory does not write into the adopted memory
+   float ext[4] = {1.f, 2.f, 3.f, 4.f};
+   RVec<float> view(ext, 4);
+   RVec<float> tmp{10.f, 20.f};
+   view = std::move(tmp);
+   CheckEqual(view, RVec<float>{10.f, 20.f});
+   EXPECT_TRUE(IsInline(view));
+   CheckEqual(RVec<float>(ext, 4), RVec<float>{1.f, 2.f, 3.f, 4.f});
+   RVec<float> view2(ext, 4);
+   RVec<float> other{5.f};
+   view2.swap(other);
+   CheckEqual(view2, RVec<float>{5.f});
+   CheckEqual(other, RVec<float>{1.f, 2.f, 3.f, 4.f});
+   CheckEqual(RVec<float>(ext, 4), RVec<float>{1.f, 2.f, 3.f, 4.f});
+}
+
 TEST(VecOps, Conversion)
 {
    ROOT::VecOps::RVec<float> fvec{1.0f, 2.0f, 3.0f};
@@ -262,6 +377,60 @@ TEST(VecOps, MathVectorInPlace)
    CheckEqual(div, ref / vec);
 }
 
+TEST(VecOps, LazyExpressions)
+{
+   RVec<float> px{10.f, 2.f, 30.f}, py{5.f, 1.f, 4.f}, eta{1.f, 0.5f, 3.f};
+
+   RVec<float> pt = sqrt(Lazy(px) * px + py * py);
+   CheckEqual(pt, sqrt(px * px + py * py));
+   RVec<int> good = sqrt(Lazy(px) * px + py * py) > 10.f && abs(Lazy(eta)) < 2.4f;
+   CheckEqual(good, RVec<int>{1, 0, 0});
+
+   // scalars on both sides, temporary RVecs, unary operators and binary functions
+   RVec<double> d = 1. - pow(Lazy(px), 2) / (px * 2.f) + atan2(-Lazy(py), px);
+   CheckEqual(d, 1. - pow(px, 2) / (px * 2.f) + atan2(-py, px));
+   auto e = Lazy(px) + px * 2.f;
+   RVec<float> ev;
+   ev = e;
+   CheckEqual(ev, RVec<float>{30.f, 6.f, 90.f});
+   EXPECT_EQ(e.size(), 3u);
+   EXPECT_FLOAT_EQ(e[1], 6.f);
+
+   // an expression started from a temporary RVec takes it over
+   auto t = Lazy(px * 2.f) + 1.f;
+   const RVec<float> tv = t;
+   CheckEqual(tv, RVec<float>{21.f, 5.f, 61.f});
+   RVec<double> large(100u, 1.);
+   auto tl = Lazy(large * 2.) + 1.;
+   const RVec<double> tlv = tl;
+   CheckEqual(tlv, RVec<double>(100u, 3.));
+
+   int ret = 0;
+   try {
+      RVec<float> bad = Lazy(px) + RVec<float>{1.f};
+   } catch (const std::runtime_error &) {
+      ret = 1;
+   }
+   EXPECT_EQ(ret, 1);
+}
+
+TEST(VecOps, LazyExpressionsHelpers)
+{
+   RVec<float> px{10.f, 2.f, 30.f}, py{5.f, 1.f, 4.f};
+   auto pt = sqrt(Lazy(px) * px + py * py);
+   const RVec<float> ptv = pt;
+
+   EXPECT_FLOAT_EQ(Sum(pt), Sum(ptv));
+   EXPECT_DOUBLE_EQ(Mean(pt), Mean(ptv));
+   EXPECT_TRUE(Any(pt > 20.f));
+   EXPECT_FALSE(All(pt > 20.f));
+   CheckEqual(px[pt > 10.f], RVec<float>{10.f, 30.f});
+   CheckEqual(Take(pt, {2, 0}), Take(ptv, {2, 0}));
+   CheckEqual(Take(pt, -2), Take(ptv, -2));
+   CheckEqual(Argsort(-pt), Argsort(-ptv));
+   CheckEqual(Filter(pt, [](float x) { return x > 3.f; }), Filter(ptv, [](float x) { return x > 3.f; }));
+}
+
 TEST(VecOps, Filter)
 {
    ROOT::VecOps::RVec<int> v{0, 1, 2, 3, 4, 5};
@@ -450,6 +619,142 @@ TEST(VecOps, MathFuncs)
 #endif
 }
 
+template <typename T, typename F>
+void CheckVectorisedFunction(const RVec<T> &r, const RVec<T> &v, F f, std::string_view msg)
+{
+   EXPECT_EQ(r.size(), v.size());
+   for (std::size_t i = 0; i < v.size(); ++i) {
+      const T ref = f(v[i]);
+      EXPECT_NEAR(r[i], ref, std::abs(ref) * 16 * std::numeric_limits<T>::epsilon()) << msg;
+   }
+}
+
+template <typename T>
+void CheckVectorisedFunctions()
+{
+   // more elements than the widest SIMD vector, to check the remainder loop too
+   RVec<T> v(37);
+   for (std::size_t i = 0; i < v.size(); ++i)
+      v[i] = T(0.1) + T(0.25) * i;
+   RVec<T> w(37, T(1.5));
+
+   CheckVectorisedFunction(exp(v), v, [](T x) { return std::exp(x); }, "exp");
+   CheckVectorisedFunction(log(v), v, [](T x) { return std::log(x); }, "log");
+   CheckVectorisedFunction(sin(v), v, [](T x) { return std::sin(x); }, "sin");
+   CheckVectorisedFunction(cos(v), v, [](T x) { return std::cos(x); }, "cos");
+   CheckVectorisedFunction(sqrt(v), v, [](T x) { return std::sqrt(x); }, "sqrt");
+   CheckVectorisedFunction(atan2(v, w), v, [](T x) { return std::atan2(x, T(1.5)); }, "atan2");
+   CheckVectorisedFunction(pow(v, w), v, [](T x) { return std::pow(x, T(1.5)); }, "pow");
+   CheckVectorisedFunction(pow(v, T(1.5)), v, [](T x) { return std::pow(x, T(1.5)); }, "pow");
+
+   EXPECT_ANY_THROW(pow(v, RVec<T>(3)));
+   EXPECT_ANY_THROW(atan2(v, RVec<T>(3)));
+}
+
+TEST(VecOps, VectorisedMathFuncs)
+{
+   CheckVectorisedFunctions<float>();
+   CheckVectorisedFunctions<double>();
+}
+
+TEST(VecOps, DeltaPhi)
+{
+   const auto pi = M_PI;
+   EXPECT_DOUBLE_EQ(DeltaPhi(0.1, 0.3), 0.2);
+   EXPECT_NEAR(DeltaPhi(3., -3.), 2 * pi - 6, 1e-15);
+   EXPECT_NEAR(DeltaPhi(-3., 3.), 6 - 2 * pi, 1e-15);
+   EXPECT_NEAR(DeltaPhi(0., 270., 180.), -90., 1e-12);
+
+   RVec<double> phi1{0.1, 3., -3., 0.};
+   RVec<double> phi2{0.3, -3., 3., 7.};
+   RVec<double> ref{0.2, 2 * pi - 6, 6 - 2 * pi, 7 - 2 * pi};
+   auto dphi = DeltaPhi(phi1, phi2);
+   ASSERT_EQ(dphi.size(), ref.size());
+   for (std::size_t i = 0; i < ref.size(); ++i)
+      EXPECT_NEAR(dphi[i], ref[i], 1e-12);
+
+   RVec<float> phi1f{0.1f, 3.f, -3.f, 0.f};
+   RVec<float> phi2f{0.3f, -3.f, 3.f, 7.f};
+   auto dphif = DeltaPhi(phi1f, phi2f);
+   for (std::size_t i = 0; i < ref.size(); ++i)
+      EXPECT_NEAR(dphif[i], ref[i], 1e-5);
+
+   auto dphi1 = DeltaPhi(phi1, 0.3);
+   auto dphi2 = DeltaPhi(0.3, phi2);
+   for (std::size_t i = 0; i < ref.size(); ++i) {
+      EXPECT_DOUBLE_EQ(dphi1[i], DeltaPhi(phi1[i], 0.3));
+      EXPECT_DOUBLE_EQ(dphi2[i], DeltaPhi(0.3, phi2[i]));
+   }
+
+   EXPECT_ANY_THROW(DeltaPhi(phi1, RVec<double>(2)));
+}
+
+TEST(VecOps, DeltaR)
+{
+   RVec<double> eta1{0.1, -1.};
+   RVec<double> eta2{0.4, -1.};
+   RVec<double> phi1{0.1, 3.};
+   RVec<double> phi2{0.5, -3.};
+   auto dr = DeltaR(eta1, eta2, phi1, phi2);
+   ASSERT_EQ(dr.size(), 2u);
+   EXPECT_NEAR(dr[0], 0.5, 1e-12);
+   EXPECT_NEAR(dr[1], 2 * M_PI - 6, 1e-12);
+   EXPECT_NEAR(DeltaR(0.1, 0.4, 0.1, 0.5), 0.5, 1e-12);
+
+   RVec<float> eta1f{0.1f, -1.f};
+   RVec<float> eta2f{0.4f, -1.f};
+   RVec<float> phi1f{0.1f, 3.f};
+   RVec<float> phi2f{0.5f, -3.f};
+   auto drf = DeltaR(eta1f, eta2f, phi1f, phi2f);
+   EXPECT_NEAR(drf[0], 0.5f, 1e-5);
+   EXPECT_NEAR(drf[1], 2 * M_PI - 6, 1e-5);
+}
+
+TEST(VecOps, InvariantMasses)
+{
+   // a Z decaying at rest in two massless leptons, and two massless back-to-back particles
+   RVec<double> pt1{45.6, 20.};
+   RVec<double> eta1{0., 1.};
+   RVec<double> phi1{0., 0.};
+   RVec<double> mass1{0., 0.};
+   RVec<double> pt2{45.6, 20.};
+   RVec<double> eta2{0., -1.};
+   RVec<double> phi2{M_PI, 0.};
+   RVec<double> mass2{0., 0.};
+   auto m = InvariantMasses(pt1, eta1, phi1, mass1, pt2, eta2, phi2, mass2);
+   ASSERT_EQ(m.size(), 2u);
+   EXPECT_NEAR(m[0], 91.2, 1e-9);
+   // m^2 = 2 pt1 pt2 (cosh(deta) - cos(dphi))
+   EXPECT_NEAR(m[1], std::sqrt(2. * 20. * 20. * (std::cosh(2.) - 1.)), 1e-9);
+
+   RVec<float> pt1f{45.6f, 20.f};
+   RVec<float> eta1f{0.f, 1.f};
+   RVec<float> phi1f{0.f, 0.f};
+   RVec<float> mass1f{0.f, 0.f};
+   RVec<float> pt2f{45.6f, 20.f};
+   RVec<float> eta2f{0.f, -1.f};
+   RVec<float> phi2f{float(M_PI), 0.f};
+   RVec<float> mass2f{0.f, 0.f};
+   auto mf = InvariantMasses(pt1f, eta1f, phi1f, mass1f, pt2f, eta2f, phi2f, mass2f);
+   EXPECT_NEAR(mf[0], m[0], 1e-3);
+   EXPECT_NEAR(mf[1], m[1], 1e-3);
+
+   // masses of the particles are taken into account
+   RVec<double> pt{0.};
+   RVec<double> eta{0.};
+   RVec<double> phi{0.};
+   RVec<double> mass{1.};
+   EXPECT_NEAR(InvariantMasses(pt, eta, phi, mass, pt, eta, phi, mass)[0], 2., 1e-12);
+
+   RVec<double> ptAll{45.6, 45.6};
+   RVec<double> etaAll{0., 0.};
+   RVec<double> phiAll{0., M_PI};
+   RVec<double> massAll{0., 0.};
+   EXPECT_NEAR(InvariantMass(ptAll, etaAll, phiAll, massAll), 91.2, 1e-9);
+
+   EXPECT_ANY_THROW(InvariantMasses(pt1, eta1, phi1, mass1, pt, eta2, phi2, mass2));
+}
+
 TEST(VecOps, PhysicsSelections)
 {
    // We emulate 8 muons
@@ -786,6 +1091,112 @@ TEST(VecOps, UnqiueCombinationsSingleVector)
    EXPECT_EQ(idx5.size(), 0u);
 }
 
+TEST(VecOps, CombinationsThreeVectors)
+{
+   ROOT::VecOps::RVec<int> v1{1, 2};
+   ROOT::VecOps::RVec<int> v2{-4, -5};
+   ROOT::VecOps::RVec<int> v3{7, 8, 9};
+
+   auto idx = Combinations(v1, v2, v3);
+   EXPECT_EQ(idx.size(), 3u);
+   auto v4 = Take(v1, idx[0]) * Take(v2, idx[1]) * Take(v3, idx[2]);
+
+   RVec<int> ref;
+   for (auto x1 : v1)
+      for (auto x2 : v2)
+         for (auto x3 : v3)
+            ref.emplace_back(x1 * x2 * x3);
+   CheckEqual(v4, ref);
+
+   // Corner-case: One collection is empty
+   RVec<int> empty_int{};
+   auto idx2 = Combinations(v1, empty_int, v3);
+   RVec<size_t> empty_size{};
+   for (auto &i : idx2)
+      CheckEqual(i, empty_size);
+}
+
+TEST(VecOps, UniqueTriplets)
+{
+   ROOT::VecOps::RVec<int> v{1, 2, 3, 4, 5};
+   auto idx = Combinations(v, 3);
+   EXPECT_EQ(idx.size(), 3u);
+   for (auto &i : idx)
+      EXPECT_EQ(i.size(), 10u);
+   auto sums = Take(v, idx[0]) + Take(v, idx[1]) + Take(v, idx[2]);
+   RVec<int> ref{6, 7, 8, 8, 9, 10, 9, 10, 11, 12};
+   CheckEqual(sums, ref);
+}
+
+TEST(VecOps, ArgMaxArgMin)
+{
+   RVec<double> v{2., 3., 1., 3., 1.};
+   EXPECT_EQ(ArgMax(v), 1u);
+   EXPECT_EQ(ArgMin(v), 2u);
+
+   RVec<int> one{4};
+   EXPECT_EQ(ArgMax(one), 0u);
+   EXPECT_EQ(ArgMin(one), 0u);
+
+   RVec<int> empty{};
+   EXPECT_ANY_THROW(ArgMax(empty));
+   EXPECT_ANY_THROW(ArgMin(empty));
+}
+
+TEST(VecOps, StablePartition)
+{
+   RVec<int> v{1, 2, 3, 4, 5, 6, 7};
+   auto isEven = [](int i) { return 0 == i % 2; };
+   CheckEqual(StablePartition(v, isEven), RVec<int>{2, 4, 6, 1, 3, 5, 7});
+   CheckEqual(StablePartition(v, [](int) { return true; }), v);
+   CheckEqual(StablePartition(RVec<int>{}, isEven), RVec<int>{});
+
+   // the relative order of the sorted indices is preserved
+   RVec<double> pt{10., 50., 30., 20.};
+   auto idx = Argsort(pt);
+   auto partIdx = StablePartition(idx, [&pt](std::size_t i) { return pt[i] > 15.; });
+   CheckEqual(partIdx, RVec<std::size_t>{3, 2, 1, 0});
+}
+
+TEST(VecOps, SegmentedReductions)
+{
+   RVec<RVec<float>> v{{1.f, 2.f}, {}, {3.f, 4.f, 5.f}};
+   CheckEqual(SegmentedSum(v), RVec<float>{3.f, 0.f, 12.f});
+   CheckEqual(SegmentedMean(v), RVec<double>{1.5, 0., 4.});
+   CheckEqual(SegmentedReduce(v, [](int n, float) { return n + 1; }, 0), RVec<int>{2, 0, 3});
+   auto maxAbs = SegmentedReduce(v, [](float m, float x) { return std::max(m, std::abs(x)); }, 0.f);
+   CheckEqual(maxAbs, RVec<float>{2.f, 0.f, 5.f});
+
+   EXPECT_ANY_THROW(SegmentedMax(v));
+   EXPECT_ANY_THROW(SegmentedMin(v));
+   RVec<RVec<int>> w{{3, 1, 2}, {-1}, {4, 4}};
+   CheckEqual(SegmentedMax(w), RVec<int>{3, -1, 4});
+   CheckEqual(SegmentedMin(w), RVec<int>{1, -1, 4});
+   CheckEqual(SegmentedSum(RVec<RVec<int>>{}), RVec<int>{});
+}
+
+struct TestPxPy {
+   double fPx, fPy;
+   TestPxPy(float pt, float phi) : fPx(pt * std::cos(phi)), fPy(pt * std::sin(phi)) {}
+};
+
+TEST(VecOps, Construct)
+{
+   RVec<float> pt{10.f, 20.f};
+   RVec<float> phi{0.f, 1.f};
+   auto p = Construct<TestPxPy>(pt, phi);
+   ASSERT_EQ(p.size(), 2u);
+   EXPECT_DOUBLE_EQ(p[0].fPx, 10.);
+   EXPECT_DOUBLE_EQ(p[0].fPy, 0.);
+   EXPECT_DOUBLE_EQ(p[1].fPx, 20.f * std::cos(1.f));
+   EXPECT_DOUBLE_EQ(p[1].fPy, 20.f * std::sin(1.f));
+
+   auto s = Construct<std::string>(RVec<int>{2, 3}, RVec<char>{'a', 'b'});
+   CheckEqual(s, RVec<std::string>{"aa", "bbb"});
+
+   EXPECT_ANY_THROW(Construct<TestPxPy>(pt, RVec<float>{1.f}));
+}
+
 TEST(VecOps, PrintCollOfNonPrintable)
 {
    auto code = "class A{};ROOT::VecOps::RVec<A> v(1);v";
@@ -24,6 +24,7 @@
 #pragma link C++ class RooStats::HistFactory::HistoToWorkspaceFactory+ ;
 #pragma link C++ class RooStats::HistFactory::HistoToWorkspaceFactoryFast+ ;
 #pragma link C++ class RooStats::HistFactory::RooBarlowBeestonLL+ ;  
+#pragma link C++ class RooStats::HistFactory::HistFactoryNLL+ ;
 #pragma link C++ class RooStats::HistFactory::HistFactorySimultaneous+ ;  
 #pragma link C++ class RooStats::HistFactory::HistFactoryNavigation+ ;  
 
@@ -50,6 +50,13 @@ namespace HistFactory{
 
     void printAllInterpCodes();
 
+    const RooArgList& variables() const { return _paramList ; }
+    double nominal() const { return _nominal ; }
+    const std::vector<double>& low() const { return _low ; }
+    const std::vector<double>& high() const { return _high ; }
+    const std::vector<int>& interpolationCodes() const { return _interpCode ; }
+    double globalBoundary() const { return _interpBoundary ; }
+
     virtual TObject* clone(const char* newname) const { return new FlexibleInterpVar(*this, newname); }
     virtual ~FlexibleInterpVar() ;
 
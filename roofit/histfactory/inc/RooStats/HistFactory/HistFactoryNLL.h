@@ -0,0 +1,199 @@
+// @(#)root/roostats:$Id$
+/*************************************************************************
+ * Copyright (C) 1995-2018, Rene Brun and Fons Rademakers.               *
+ * All rights reserved.                                                  *
+ *                                                                       *
+ * For the licensing terms see $ROOTSYS/LICENSE.                         *
+ * For the list of contributors see $ROOTSYS/README/CREDITS.             *
+ *************************************************************************/
+
+#ifndef ROOSTATS_HISTFACTORY_HISTFACTORYNLL
+#define ROOSTATS_HISTFACTORY_HISTFACTORYNLL
+
+#include "RooAbsReal.h"
+#include "RooArgSet.h"
+#include "RooListProxy.h"
+#include "Math/IFunction.h"
+
+#include <map>
+#include <memory>
+#include <vector>
+
+class RooAbsPdf ;
+class RooAbsData ;
+class RooRealVar ;
+class PiecewiseInterpolation ;
+class ParamHistFunc ;
+
+namespace RooStats{
+  namespace HistFactory{
+
+class HistFactoryNLL : public RooAbsReal {
+public:
+
+  HistFactoryNLL() ;
+  HistFactoryNLL(const char *name, const char *title, RooAbsPdf& pdf, RooAbsData& data, const RooArgSet* globalObservables=0) ;
+  HistFactoryNLL(const HistFactoryNLL& other, const char* name=0) ;
+  virtual TObject* clone(const char* newname) const { return new HistFactoryNLL(*this,newname); }
+  virtual ~HistFactoryNLL() ;
+
+  // true if the model could be compiled
+  Bool_t isValid() const { return _valid ; }
+
+  // replace the observed data (same observables and binning)
+  virtual Bool_t setData(RooAbsData& data, Bool_t cloneData=kTRUE) ;
+
+  // all the parameters of the model, in the order used for the gradient
+  const RooArgList& parameters() const { return _params ; }
+
+  // value of the NLL and its derivatives w.r.t. all the parameters()
+  Double_t evaluateWithGradient(Double_t* grad) const ;
+  void gradient(Double_t* grad) const { evaluateWithGradient(grad) ; }
+
+  // NLL as a function of the floating parameters with analytic gradient,
+  // e.g. for ROOT::Math::Minimizer::SetFunction
+  class GradFunction : public ROOT::Math::IMultiGradFunction {
+  public:
+    GradFunction(const HistFactoryNLL& nll) ;
+    virtual ROOT::Math::IMultiGradFunction* Clone() const { return new GradFunction(*this) ; }
+    virtual unsigned int NDim() const { return _floating.size() ; }
+    virtual void Gradient(const double* x, double* grad) const ;
+    virtual void FdF(const double* x, double& f, double* df) const ;
+    const std::vector<RooRealVar*>& floatingParameters() const { return _floating ; }
+  private:
+    virtual double DoEval(const double* x) const ;
+    virtual double DoDerivative(const double* x, unsigned int icoord) const ;
+    void setParameters(const double* x) const ;
+    const HistFactoryNLL* _nll ;
+    std::vector<RooRealVar*> _floating ; // floating parameters
+    std::vector<Int_t> _index ;          // index of the floating parameters in parameters()
+    mutable std::vector<Double_t> _grad ; // gradient w.r.t. all parameters
+  } ;
+
+protected:
+
+  // Value of a parameter of a constraint: a parameter or a constant
+  struct Arg {
+    Int_t param ;     // index in _params, -1 for a constant
+    Double_t value ;  // value of the constant
+    Double_t scale ;  // the argument is scale*parameter
+  } ;
+
+  // FlexibleInterpVar
+  struct NormInterp {
+    Double_t nominal ;
+    std::vector<Int_t> param ;      // index of the parameters in _params
+    std::vector<Int_t> code ;       // interpolation codes
+    std::vector<Double_t> low ;
+    std::vector<Double_t> high ;
+    std::vector<Double_t> poly ;    // polynomial coefficients for code 4 (6 per parameter)
+    Double_t boundary ;             // boundary of the polynomial interpolation
+  } ;
+
+  // PiecewiseInterpolation of bin-wise constant functions
+  struct ShapeInterp {
+    std::vector<Double_t> nominal ; // nominal value per bin
+    std::vector<Int_t> param ;      // index of the parameters in _params
+    std::vector<Int_t> code ;       // interpolation codes
+    std::vector<Double_t> up ;      // high-nominal per parameter and bin (log(high/nominal) for code 1)
+    std::vector<Double_t> down ;    // nominal-low per parameter and bin (log(low/nominal) for code 1)
+    Bool_t positiveDefinite ;
+  } ;
+
+  // Product of factors giving the contents of one sample in one channel
+  struct Sample {
+    std::vector<Int_t> normParams ;   // scalar parameters (norm factors, luminosity, bin width)
+    std::vector<NormInterp> normInterps ;
+    std::vector<Double_t> shape ;     // product of the constant factors per bin
+    std::vector<ShapeInterp> shapeInterps ;
+    std::vector<Int_t> binParams ;    // parameter per bin of each ParamHistFunc
+    // evaluation buffers
+    std::vector<Double_t> normValues ; // values of the scalar factors
+    std::vector<Double_t> normDerivs ; // derivatives of the FlexibleInterpVars
+    std::vector<Double_t> factors ;   // values per bin of the non-constant factors
+    std::vector<Double_t> derivs ;    // derivatives per bin of the interpolations
+    std::vector<Double_t> contents ;  // product of the per-bin factors
+  } ;
+
+  // Functions of a sample evaluated bin by bin when compiling the model
+  struct BinFuncs {
+    std::vector<RooAbsReal*> constFactors ;
+    std::vector<PiecewiseInterpolation*> interps ;
+    std::vector<ParamHistFunc*> paramHists ;
+  } ;
+
+  // Binned extended (or not) likelihood of one channel
+  struct Channel {
+    Int_t catIndex ;                  // state of the index category, -1 without RooSimultaneous
+    Bool_t extended ;
+    std::vector<TString> obsNames ;   // observables
+    std::vector<std::vector<Double_t> > edges ; // bin boundaries of the observables
+    std::vector<Double_t> volume ;    // bin volume
+    std::vector<Double_t> counts ;    // observed counts
+    std::vector<Sample> samples ;
+    // evaluation buffers
+    std::vector<Double_t> density ;   // sum of the samples
+    std::vector<Double_t> residual ;  // derivative of the NLL w.r.t. the density
+    std::vector<Double_t> weights ;   // derivative of the NLL w.r.t. a factor
+  } ;
+
+  enum ConstraintType { kGaussian, kPoisson, kGeneric } ;
+
+  // Constraint term
+  struct Constraint {
+    Int_t type ;
+    Arg x ;
+    Arg mean ;
+    Arg sigma ;
+    Bool_t noRounding ;
+    Int_t pdf ;                       // index in _constraints for a generic constraint
+    std::vector<Int_t> params ;       // parameters of a generic constraint
+    RooArgSet normSet ;               // normalization set of a generic constraint
+  } ;
+
+  // Private copy of a generic constraint term and of its parameters, which are
+  // changed for the numerical derivatives instead of the parameters of the model
+  struct ConstraintClone {
+    std::unique_ptr<RooArgSet> nodes ; // the cloned term and its servers
+    RooAbsPdf* pdf ;
+    std::vector<RooRealVar*> params ; // clones of the Constraint::params
+    RooArgSet normSet ;
+  } ;
+
+  Bool_t compile(RooAbsPdf& pdf, RooAbsData& data, const RooArgSet* globalObservables) ;
+  Bool_t addChannel(RooAbsPdf& pdf, RooAbsData& data, Int_t catIndex, const RooArgSet* globalObservables) ;
+  Bool_t addFactor(RooAbsReal& func, Sample& sample, BinFuncs& funcs, const RooArgSet& obs) ;
+  Bool_t addConstraint(RooAbsPdf& pdf, const RooArgSet* globalObservables) ;
+  void fillBin(Sample& sample, const BinFuncs& funcs, Int_t bin, Int_t nBins) ;
+  Arg makeArg(const RooAbsReal& arg, Bool_t allowScale) ;
+  Int_t paramIndex(RooRealVar& var) ;
+  Int_t findBin(const Channel& channel, const RooArgSet& row) const ;
+
+  Double_t evaluate() const ;
+  Double_t evaluateChannel(Channel& channel, Double_t* grad) const ;
+  Double_t evaluateConstraint(const Constraint& constraint, Double_t* grad) const ;
+  ConstraintClone& constraintClone(const Constraint& constraint) const ;
+  Double_t normInterpValue(const NormInterp& interp, Double_t* deriv) const ;
+  void shapeInterpValues(const ShapeInterp& interp, Int_t nBins, Double_t* values, Double_t* derivs) const ;
+  Double_t argValue(const Arg& arg) const { return arg.param<0 ? arg.value : arg.scale*_values[arg.param] ; }
+
+  RooListProxy _params ;             // parameters of the model
+  RooListProxy _constraints ;        // constraint terms
+  Bool_t _valid ;                    //! the model could be compiled
+  std::vector<Constraint> _constraintTerms ; //!
+  std::map<Int_t,Int_t> _channelIndex ; //! channel for a state of the index category
+  TString _catName ;                 // name of the index category
+  mutable std::vector<Channel> _channels ; //!
+  mutable std::vector<Double_t> _values ; //! values of the parameters
+  mutable std::vector<std::unique_ptr<ConstraintClone> > _constraintClones ; //! copies of the generic constraint terms
+  std::map<const RooAbsArg*,Int_t> _paramIndex ; //! index of the parameters while compiling
+
+private:
+
+  ClassDef(RooStats::HistFactory::HistFactoryNLL,1) // Binned NLL of a HistFactory model with analytic gradient
+};
+
+  }
+}
+
+#endif
@@ -0,0 +1,1108 @@
+// @(#)root/roostats:$Id$
+/*************************************************************************
+ * Copyright (C) 1995-2018, Rene Brun and Fons Rademakers.               *
+ * All rights reserved.                                                  *
+ *                                                                       *
+ * For the licensing terms see $ROOTSYS/LICENSE.                         *
+ * For the list of contributors see $ROOTSYS/README/CREDITS.             *
+ *************************************************************************/
+
+//////////////////////////////////////////////////////////////////////////////
+/** \class RooStats::HistFactory::HistFactoryNLL
+ * \ingroup HistFactory
+ * Binned negative log-likelihood of a HistFactory model, evaluated by a
+ * compiled kernel instead of the RooFit computation graph.
+ *
+ * When it is constructed, the model is flattened into contiguous arrays: for
+ * each channel and sample, the product of the constant functions of the
+ * observables (RooHistFunc, bin widths) is tabulated per bin, the
+ * PiecewiseInterpolation are stored as per-bin nominal values and variations,
+ * the ParamHistFunc as the index of the parameter of each bin and the
+ * FlexibleInterpVar and the parameters (norm factors, luminosity) as scalar
+ * factors. The evaluation loops over the bins of these arrays, without any
+ * virtual call or cache lookup per bin, and computes the analytic gradient of
+ * the NLL w.r.t. all the parameters at the same time.
+ *
+ * The supported models are a RooSimultaneous (or a single channel) of
+ * RooProdPdf of one RooRealSumPdf of the observables and constraint terms,
+ * as built by HistoToWorkspaceFactoryFast. RooGaussian and RooPoisson
+ * constraints are evaluated analytically, other constraint terms with RooFit,
+ * on a private copy of which the parameters are varied for numerical derivatives.
+ * The value is the same as the one of RooAbsPdf::createNLL up to a constant
+ * that does not depend on the parameters. isValid() is false when the model
+ * contains functions that cannot be compiled.
+ *
+ * The NLL can be minimized with RooMinimizer like any other function, or
+ * with its analytic gradient through GradFunction:
+ * ~~~ {.cpp}
+ *    RooStats::HistFactory::HistFactoryNLL nll("nll", "nll", *mc->GetPdf(), *data, mc->GetGlobalObservables());
+ *    RooStats::HistFactory::HistFactoryNLL::GradFunction func(nll);
+ *    std::unique_ptr<ROOT::Math::Minimizer> minimizer(ROOT::Math::Factory::CreateMinimizer("Minuit2"));
+ *    minimizer->SetFunction(func);
+ * ~~~
+ */
+
+#include "RooStats/HistFactory/HistFactoryNLL.h"
+
+#include "RooStats/HistFactory/FlexibleInterpVar.h"
+#include "RooStats/HistFactory/ParamHistFunc.h"
+#include "RooStats/HistFactory/PiecewiseInterpolation.h"
+
+#include "RooAbsBinning.h"
+#include "RooAbsCategoryLValue.h"
+#include "RooAbsData.h"
+#include "RooAbsPdf.h"
+#include "RooCatType.h"
+#include "RooGaussian.h"
+#include "RooMsgService.h"
+#include "RooPoisson.h"
+#include "RooProdPdf.h"
+#include "RooProduct.h"
+#include "RooRealSumPdf.h"
+#include "RooRealVar.h"
+#include "RooSimultaneous.h"
+#include "TMath.h"
+
+#include <algorithm>
+#include <cmath>
+#include <memory>
+
+using namespace std ;
+
+ClassImp(RooStats::HistFactory::HistFactoryNLL);
+
+namespace {
+
+////////////////////////////////////////////////////////////////////////////////
+/// Collect the factors of nested RooProdPdf
+
+void factorize(RooAbsPdf& pdf, RooArgList& terms)
+{
+  RooProdPdf* prod = dynamic_cast<RooProdPdf*>(&pdf) ;
+  if (!prod) {
+    terms.add(pdf) ;
+    return ;
+  }
+  RooFIter iter = prod->pdfList().fwdIterator() ;
+  RooAbsArg* arg ;
+  while ((arg = iter.next())) {
+    factorize(*(RooAbsPdf*)arg, terms) ;
+  }
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// Return true if the function depends on no other variable than the observables
+
+Bool_t dependsOnlyOn(const RooAbsArg& func, const RooArgSet& obs)
+{
+  std::unique_ptr<RooArgSet> vars(func.getVariables()) ;
+  RooFIter iter = vars->fwdIterator() ;
+  RooAbsArg* var ;
+  while ((var = iter.next())) {
+    if (obs.find(var->GetName())) continue ;
+    if (dynamic_cast<RooAbsRealLValue*>(var) || dynamic_cast<RooAbsCategory*>(var)) return kFALSE ;
+  }
+  return kTRUE ;
+}
+
+}
+
+namespace RooStats {
+namespace HistFactory {
+
+////////////////////////////////////////////////////////////////////////////////
+/// Default constructor, for I/O only
+
+HistFactoryNLL::HistFactoryNLL() : _valid(kFALSE)
+{
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// Compile the NLL of the model for the data. The global observables are not
+/// included in the normalization of the constraint terms evaluated with RooFit.
+
+HistFactoryNLL::HistFactoryNLL(const char *name, const char *title, RooAbsPdf& pdf, RooAbsData& data,
+                               const RooArgSet* globalObservables) :
+  RooAbsReal(name,title),
+  _params("params","Parameters",this),
+  _constraints("constraints","Constraint terms",this),
+  _valid(kFALSE)
+{
+  _valid = compile(pdf,data,globalObservables) ;
+  _paramIndex.clear() ;
+  if (!_valid) {
+    coutE(InputArguments) << "HistFactoryNLL::HistFactoryNLL(" << GetName() << ") ERROR: the model " << pdf.GetName()
+                          << " cannot be compiled, use RooAbsPdf::createNLL instead" << endl ;
+  }
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// Copy constructor
+
+HistFactoryNLL::HistFactoryNLL(const HistFactoryNLL& other, const char* name) :
+  RooAbsReal(other,name),
+  _params("params",this,other._params),
+  _constraints("constraints",this,other._constraints),
+  _valid(other._valid),
+  _constraintTerms(other._constraintTerms),
+  _channelIndex(other._channelIndex),
+  _catName(other._catName),
+  _channels(other._channels),
+  _values(other._values)
+{
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// Destructor
+
+HistFactoryNLL::~HistFactoryNLL()
+{
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// Flatten the model into the channels and constraint terms
+
+Bool_t HistFactoryNLL::compile(RooAbsPdf& pdf, RooAbsData& data, const RooArgSet* globalObservables)
+{
+  RooSimultaneous* simPdf = dynamic_cast<RooSimultaneous*>(&pdf) ;
+  if (simPdf) {
+    const RooAbsCategoryLValue& cat = simPdf->indexCat() ;
+    _catName = cat.GetName() ;
+    std::unique_ptr<TIterator> iter(cat.typeIterator()) ;
+    RooCatType* type ;
+    while ((type = (RooCatType*)iter->Next())) {
+      RooAbsPdf* chanPdf = simPdf->getPdf(type->GetName()) ;
+      if (!chanPdf) continue ;
+      if (!addChannel(*chanPdf,data,type->getVal(),globalObservables)) return kFALSE ;
+    }
+  } else if (!addChannel(pdf,data,-1,globalObservables)) {
+    return kFALSE ;
+  }
+
+  _values.resize(_params.getSize()) ;
+  return setData(data) ;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// Add the channel modelled by the product of a RooRealSumPdf and constraint terms
+
+Bool_t HistFactoryNLL::addChannel(RooAbsPdf& pdf, RooAbsData& data, Int_t catIndex, const RooArgSet* globalObservables)
+{
+  RooArgList terms ;
+  factorize(pdf,terms) ;
+
+  RooRealSumPdf* sumPdf = 0 ;
+  RooFIter termIter = terms.fwdIterator() ;
+  RooAbsArg* term ;
+  while ((term = termIter.next())) {
+    if (term->dependsOn(*data.get())) {
+      RooRealSumPdf* sum = dynamic_cast<RooRealSumPdf*>(term) ;
+      if (!sum || sumPdf) {
+        coutE(InputArguments) << "HistFactoryNLL::compile(" << GetName() << ") ERROR: the observables of " << pdf.GetName()
+                              << " must be modelled by a single RooRealSumPdf, found " << term->GetName() << endl ;
+        return kFALSE ;
+      }
+      sumPdf = sum ;
+    } else if (!addConstraint(*(RooAbsPdf*)term,globalObservables)) {
+      return kFALSE ;
+    }
+  }
+  if (!sumPdf) {
+    coutE(InputArguments) << "HistFactoryNLL::compile(" << GetName() << ") ERROR: no RooRealSumPdf in " << pdf.GetName() << endl ;
+    return kFALSE ;
+  }
+
+  Channel channel ;
+  channel.catIndex = catIndex ;
+  channel.extended = sumPdf->extendMode()!=RooAbsPdf::CanNotBeExtended ;
+
+  // binning of the observables
+  std::unique_ptr<RooArgSet> obsSet(sumPdf->getObservables(data)) ;
+  std::vector<RooRealVar*> obs ;
+  Int_t nBins = 1 ;
+  RooFIter obsIter = obsSet->fwdIterator() ;
+  RooAbsArg* arg ;
+  while ((arg = obsIter.next())) {
+    RooRealVar* var = dynamic_cast<RooRealVar*>(arg) ;
+    if (!var) {
+      coutE(InputArguments) << "HistFactoryNLL::compile(" << GetName() << ") ERROR: observable " << arg->GetName()
+                            << " is not a RooRealVar" << endl ;
+      return kFALSE ;
+    }
+    const RooAbsBinning& binning = var->getBinning() ;
+    std::vector<Double_t> edges(binning.numBins()+1) ;
+    for (Int_t i=0 ; i<binning.numBins() ; ++i) edges[i] = binning.binLow(i) ;
+    edges[binning.numBins()] = binning.highBound() ;
+    obs.push_back(var) ;
+    channel.obsNames.push_back(var->GetName()) ;
+    channel.edges.push_back(edges) ;
+    nBins *= binning.numBins() ;
+  }
+  if (obs.empty()) {
+    coutE(InputArguments) << "HistFactoryNLL::compile(" << GetName() << ") ERROR: " << sumPdf->GetName() << " has no observables" << endl ;
+    return kFALSE ;
+  }
+
+  // structure of the samples
+  const RooArgList& funcList = sumPdf->funcList() ;
+  const RooArgList& coefList = sumPdf->coefList() ;
+  if (funcList.getSize()!=coefList.getSize()) {
+    coutE(InputArguments) << "HistFactoryNLL::compile(" << GetName() << ") ERROR: " << sumPdf->GetName()
+                          << " must have one coefficient per function" << endl ;
+    return kFALSE ;
+  }
+  const Int_t nSamples = funcList.getSize() ;
+  channel.samples.resize(nSamples) ;
+  std::vector<BinFuncs> funcs(nSamples) ;
+  for (Int_t s=0 ; s<nSamples ; ++s) {
+    if (!addFactor((RooAbsReal&)*coefList.at(s),channel.samples[s],funcs[s],*obsSet) ||
+        !addFactor((RooAbsReal&)*funcList.at(s),channel.samples[s],funcs[s],*obsSet)) {
+      return kFALSE ;
+    }
+
+    Sample& sample = channel.samples[s] ;
+    for (auto interp : funcs[s].interps) {
+      ShapeInterp shapeInterp ;
+      RooFIter paramIter = interp->paramList().fwdIterator() ;
+      while ((arg = paramIter.next())) {
+        shapeInterp.param.push_back(paramIndex(*(RooRealVar*)arg)) ;
+      }
+      const Int_t nParams = shapeInterp.param.size() ;
+      shapeInterp.code = interp->interpolationCodes() ;
+      shapeInterp.positiveDefinite = interp->positiveDefinite() ;
+      shapeInterp.nominal.resize(nBins) ;
+      shapeInterp.up.resize(nParams*nBins) ;
+      shapeInterp.down.resize(nParams*nBins) ;
+      sample.shapeInterps.push_back(shapeInterp) ;
+    }
+    sample.shape.assign(nBins,1.) ;
+    sample.binParams.resize(funcs[s].paramHists.size()*nBins) ;
+  }
+
+  // tabulate the functions of the observables at the bin centers
+  std::vector<Double_t> saveObs ;
+  for (auto var : obs) saveObs.push_back(var->getVal()) ;
+  channel.volume.assign(nBins,1.) ;
+  for (Int_t bin=0 ; bin<nBins ; ++bin) {
+    Int_t rest = bin ;
+    for (Int_t k=obs.size()-1 ; k>=0 ; --k) {
+      const RooAbsBinning& binning = obs[k]->getBinning() ;
+      const Int_t i = rest % binning.numBins() ;
+      rest /= binning.numBins() ;
+      obs[k]->setVal(binning.binCenter(i)) ;
+      channel.volume[bin] *= binning.binWidth(i) ;
+    }
+    for (Int_t s=0 ; s<nSamples ; ++s) fillBin(channel.samples[s],funcs[s],bin,nBins) ;
+  }
+  for (UInt_t k=0 ; k<obs.size() ; ++k) obs[k]->setVal(saveObs[k]) ;
+
+  // evaluation buffers
+  for (auto& sample : channel.samples) {
+    Int_t nDerivs = 0 ;
+    for (auto& interp : sample.shapeInterps) nDerivs += interp.param.size() ;
+    Int_t nNormDerivs = 0 ;
+    for (auto& interp : sample.normInterps) nNormDerivs += interp.param.size() ;
+    sample.normValues.resize(sample.normParams.size()+sample.normInterps.size()) ;
+    sample.normDerivs.resize(nNormDerivs) ;
+    sample.factors.resize((sample.shapeInterps.size()+sample.binParams.size()/nBins)*nBins) ;
+    sample.derivs.resize(nDerivs*nBins) ;
+    sample.contents.resize(nBins) ;
+  }
+  channel.counts.resize(nBins) ;
+  channel.density.resize(nBins) ;
+  channel.residual.resize(nBins) ;
+  channel.weights.resize(nBins) ;
+
+  _channelIndex[catIndex] = _channels.size() ;
+  _channels.push_back(channel) ;
+  return kTRUE ;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// Classify a factor of the contents of a sample
+
+Bool_t HistFactoryNLL::addFactor(RooAbsReal& func, Sample& sample, BinFuncs& funcs, const RooArgSet& obs)
+{
+  RooRealVar* var = dynamic_cast<RooRealVar*>(&func) ;
+  if (var && !obs.find(var->GetName())) {
+    sample.normParams.push_back(paramIndex(*var)) ;
+    return kTRUE ;
+  }
+
+  FlexibleInterpVar* flexInterp = dynamic_cast<FlexibleInterpVar*>(&func) ;
+  if (flexInterp) {
+    NormInterp interp ;
+    interp.nominal = flexInterp->nominal() ;
+    interp.low = flexInterp->low() ;
+    interp.high = flexInterp->high() ;
+    interp.code = flexInterp->interpolationCodes() ;
+    interp.boundary = flexInterp->globalBoundary() ;
+    RooFIter iter = flexInterp->variables().fwdIterator() ;
+    RooAbsArg* arg ;
+    while ((arg = iter.next())) {
+      RooRealVar* param = dynamic_cast<RooRealVar*>(arg) ;
+      if (!param) {
+        coutE(InputArguments) << "HistFactoryNLL::compile(" << GetName() << ") ERROR: parameter " << arg->GetName()
+                              << " of " << func.GetName() << " is not a RooRealVar" << endl ;
+        return kFALSE ;
+      }
+      interp.param.push_back(paramIndex(*param)) ;
+    }
+    const UInt_t n = interp.param.size() ;
+    for (UInt_t i=0 ; i<n ; ++i) {
+      if (interp.code[i]<0 || interp.code[i]>4) {
+        coutE(InputArguments) << "HistFactoryNLL::compile(" << GetName() << ") ERROR: unknown interpolation code "
+                              << interp.code[i] << " in " << func.GetName() << endl ;
+        return kFALSE ;
+      }
+    }
+
+    // polynomial coefficients of code 4, as in FlexibleInterpVar::PolyInterpValue
+    const Double_t x0 = interp.boundary ;
+    interp.poly.resize(6*n) ;
+    for (UInt_t j=0 ; j<n ; ++j) {
+      Double_t* coeff = &interp.poly[6*j] ;
+      const Double_t pow_up = std::pow(interp.high[j]/interp.nominal, x0) ;
+      const Double_t pow_down = std::pow(interp.low[j]/interp.nominal, x0) ;
+      const Double_t logHi = std::log(interp.high[j]) ;
+      const Double_t logLo = std::log(interp.low[j]) ;
+      const Double_t pow_up_log = interp.high[j] <= 0.0 ? 0.0 : pow_up * logHi ;
+      const Double_t pow_down_log = interp.low[j] <= 0.0 ? 0.0 : -pow_down * logLo ;
+      const Double_t pow_up_log2 = interp.high[j] <= 0.0 ? 0.0 : pow_up_log * logHi ;
+      const Double_t pow_down_log2 = interp.low[j] <= 0.0 ? 0.0 : -pow_down_log * logLo ;
+      const Double_t S0 = (pow_up+pow_down)/2 ;
+      const Double_t A0 = (pow_up-pow_down)/2 ;
+      const Double_t S1 = (pow_up_log+pow_down_log)/2 ;
+      const Double_t A1 = (pow_up_log-pow_down_log)/2 ;
+      const Double_t S2 = (pow_up_log2+pow_down_log2)/2 ;
+      const Double_t A2 = (pow_up_log2-pow_down_log2)/2 ;
+      coeff[0] = 1./(8*x0)        *(      15*A0 -  7*x0*S1 + x0*x0*A2) ;
+      coeff[1] = 1./(8*x0*x0)     *(-24 + 24*S0 -  9*x0*A1 + x0*x0*S2) ;
+      coeff[2] = 1./(4*pow(x0, 3))*(    -  5*A0 +  5*x0*S1 - x0*x0*A2) ;
+      coeff[3] = 1./(4*pow(x0, 4))*( 12 - 12*S0 +  7*x0*A1 - x0*x0*S2) ;
+      coeff[4] = 1./(8*pow(x0, 5))*(    +  3*A0 -  3*x0*S1 + x0*x0*A2) ;
+      coeff[5] = 1./(8*pow(x0, 6))*( -8 +  8*S0 -  5*x0*A1 + x0*x0*S2) ;
+    }
+    sample.normInterps.push_back(interp) ;
+    return kTRUE ;
+  }
+
+  ParamHistFunc* paramHist = dynamic_cast<ParamHistFunc*>(&func) ;
+  if (paramHist) {
+    funcs.paramHists.push_back(paramHist) ;
+    return kTRUE ;
+  }
+
+  PiecewiseInterpolation* interp = dynamic_cast<PiecewiseInterpolation*>(&func) ;
+  if (interp) {
+    Bool_t ok = dependsOnlyOn(*interp->nominalHist(),obs) ;
+    RooFIter lowIter = interp->lowList().fwdIterator() ;
+    RooFIter highIter = interp->highList().fwdIterator() ;
+    RooFIter paramIter = interp->paramList().fwdIterator() ;
+    RooAbsArg* param ;
+    while ((param = paramIter.next())) {
+      ok = ok && dynamic_cast<RooRealVar*>(param) ;
+      ok = ok && dependsOnlyOn(*lowIter.next(),obs) && dependsOnlyOn(*highIter.next(),obs) ;
+    }
+    for (auto code : interp->interpolationCodes()) ok = ok && code>=0 && code<=5 ;
+    if (!ok) {
+      coutE(InputArguments) << "HistFactoryNLL::compile(" << GetName() << ") ERROR: " << func.GetName()
+                            << " must interpolate functions of the observables with RooRealVar parameters and codes 0 to 5" << endl ;
+      return kFALSE ;
+    }
+    funcs.interps.push_back(interp) ;
+    return kTRUE ;
+  }
+
+  RooProduct* prod = dynamic_cast<RooProduct*>(&func) ;
+  if (prod) {
+    RooArgList components(prod->components()) ;
+    RooFIter iter = components.fwdIterator() ;
+    RooAbsArg* arg ;
+    while ((arg = iter.next())) {
+      RooAbsReal* comp = dynamic_cast<RooAbsReal*>(arg) ;
+      if (!comp || !addFactor(*comp,sample,funcs,obs)) return kFALSE ;
+    }
+    return kTRUE ;
+  }
+
+  if (dependsOnlyOn(func,obs)) {
+    funcs.constFactors.push_back(&func) ;
+    return kTRUE ;
+  }
+
+  coutE(InputArguments) << "HistFactoryNLL::compile(" << GetName() << ") ERROR: function " << func.GetName()
+                        << " of type " << func.ClassName() << " is not supported" << endl ;
+  return kFALSE ;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// Tabulate the functions of a sample for one bin. The observables are at the
+/// center of the bin.
+
+void HistFactoryNLL::fillBin(Sample& sample, const BinFuncs& funcs, Int_t bin, Int_t nBins)
+{
+  Double_t value = 1 ;
+  for (auto func : funcs.constFactors) value *= func->getVal() ;
+  sample.shape[bin] = value ;
+
+  for (UInt_t k=0 ; k<funcs.interps.size() ; ++k) {
+    const PiecewiseInterpolation* func = funcs.interps[k] ;
+    ShapeInterp& interp = sample.shapeInterps[k] ;
+    const Double_t nominal = func->nominalHist()->getVal() ;
+    interp.nominal[bin] = nominal ;
+    for (UInt_t i=0 ; i<interp.param.size() ; ++i) {
+      const Double_t low = ((RooAbsReal*)func->lowList().at(i))->getVal() ;
+      const Double_t high = ((RooAbsReal*)func->highList().at(i))->getVal() ;
+      if (interp.code[i]==1) {
+        interp.up[i*nBins+bin] = nominal!=0 ? std::log(high/nominal) : 0 ;
+        interp.down[i*nBins+bin] = nominal!=0 ? std::log(low/nominal) : 0 ;
+      } else {
+        interp.up[i*nBins+bin] = high-nominal ;
+        interp.down[i*nBins+bin] = nominal-low ;
+      }
+    }
+  }
+
+  for (UInt_t h=0 ; h<funcs.paramHists.size() ; ++h) {
+    sample.binParams[h*nBins+bin] = paramIndex(funcs.paramHists[h]->getParameter()) ;
+  }
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// Add a constraint term. Terms shared by several channels are added once.
+
+Bool_t HistFactoryNLL::addConstraint(RooAbsPdf& pdf, const RooArgSet* globalObservables)
+{
+  if (_constraints.index(&pdf)>=0) return kTRUE ;
+  _constraints.add(pdf) ;
+
+  Constraint constraint ;
+  constraint.type = kGeneric ;
+  constraint.pdf = _constraints.getSize()-1 ;
+  constraint.noRounding = kFALSE ;
+
+  RooGaussian* gauss = dynamic_cast<RooGaussian*>(&pdf) ;
+  RooPoisson* pois = dynamic_cast<RooPoisson*>(&pdf) ;
+  if (gauss) {
+    constraint.x = makeArg(gauss->getX(),kFALSE) ;
+    constraint.mean = makeArg(gauss->getMean(),kFALSE) ;
+    constraint.sigma = makeArg(gauss->getSigma(),kFALSE) ;
+    if (constraint.x.param>-2 && constraint.mean.param>-2 && constraint.sigma.param>-2) constraint.type = kGaussian ;
+  } else if (pois) {
+    // the observed value is a global observable: no derivative
+    constraint.x = makeArg(pois->getX(),kFALSE) ;
+    constraint.mean = makeArg(pois->getMean(),kTRUE) ;
+    constraint.noRounding = pois->getNoRounding() ;
+    Bool_t fixedX = constraint.x.param==-1 ||
+      (constraint.x.param>=0 && ((RooRealVar*)_params.at(constraint.x.param))->isConstant()) ;
+    if (fixedX && constraint.mean.param>-2) constraint.type = kPoisson ;
+  }
+
+  if (constraint.type==kGeneric) {
+    std::unique_ptr<RooArgSet> vars(pdf.getVariables()) ;
+    RooFIter iter = vars->fwdIterator() ;
+    RooAbsArg* var ;
+    while ((var = iter.next())) {
+      RooRealVar* param = dynamic_cast<RooRealVar*>(var) ;
+      if (!param) continue ;
+      constraint.params.push_back(paramIndex(*param)) ;
+      if (!globalObservables || !globalObservables->find(param->GetName())) constraint.normSet.add(*param) ;
+    }
+  }
+
+  _constraintTerms.push_back(constraint) ;
+  return kTRUE ;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// Argument of a constraint: a parameter, a constant, or (with allowScale) the
+/// product of a parameter with constants. The index of the parameter is -2 if
+/// the argument is none of these.
+
+HistFactoryNLL::Arg HistFactoryNLL::makeArg(const RooAbsReal& arg, Bool_t allowScale)
+{
+  Arg result ;
+  result.param = -1 ;
+  result.value = 0 ;
+  result.scale = 1 ;
+
+  RooRealVar* var = dynamic_cast<RooRealVar*>(const_cast<RooAbsReal*>(&arg)) ;
+  if (var) {
+    result.param = paramIndex(*var) ;
+    return result ;
+  }
+
+  const RooArgSet noObs ;
+  if (dependsOnlyOn(arg,noObs)) {
+    result.value = arg.getVal() ;
+    return result ;
+  }
+
+  RooProduct* prod = dynamic_cast<RooProduct*>(const_cast<RooAbsReal*>(&arg)) ;
+  if (allowScale && prod) {
+    RooArgList components(prod->components()) ;
+    RooFIter iter = components.fwdIterator() ;
+    RooAbsArg* comp ;
+    while ((comp = iter.next())) {
+      RooRealVar* param = dynamic_cast<RooRealVar*>(comp) ;
+      RooAbsReal* func = dynamic_cast<RooAbsReal*>(comp) ;
+      if (param && result.param==-1) {
+        result.param = paramIndex(*param) ;
+      } else if (func && dependsOnlyOn(*func,noObs)) {
+        result.scale *= func->getVal() ;
+      } else {
+        result.param = -2 ;
+        return result ;
+      }
+    }
+    return result ;
+  }
+
+  result.param = -2 ;
+  return result ;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// Index of the parameter, which is added to the parameters if needed
+
+Int_t HistFactoryNLL::paramIndex(RooRealVar& var)
+{
+  std::map<const RooAbsArg*,Int_t>::iterator iter = _paramIndex.find(&var) ;
+  if (iter!=_paramIndex.end()) return iter->second ;
+  _params.add(var) ;
+  Int_t index = _params.getSize()-1 ;
+  _paramIndex[&var] = index ;
+  return index ;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// Replace the observed data. The data must have the observables (and index
+/// category) of the model, entries outside the bins are ignored.
+
+Bool_t HistFactoryNLL::setData(RooAbsData& data, Bool_t /*cloneData*/)
+{
+  for (auto& channel : _channels) std::fill(channel.counts.begin(),channel.counts.end(),0.) ;
+
+  for (Int_t i=0 ; i<data.numEntries() ; ++i) {
+    const RooArgSet* row = data.get(i) ;
+    const Double_t weight = data.weight() ;
+    if (weight==0) continue ;
+    Int_t catIndex = -1 ;
+    if (_catName.Length()>0) {
+      const RooAbsCategory* cat = dynamic_cast<const RooAbsCategory*>(row->find(_catName)) ;
+      if (!cat) {
+        coutE(InputArguments) << "HistFactoryNLL::setData(" << GetName() << ") ERROR: the data have no category "
+                              << _catName << endl ;
+        return kFALSE ;
+      }
+      catIndex = cat->getIndex() ;
+    }
+    std::map<Int_t,Int_t>::const_iterator channel = _channelIndex.find(catIndex) ;
+    if (channel==_channelIndex.end()) continue ;
+    const Int_t bin = findBin(_channels[channel->second],*row) ;
+    if (bin>=0) _channels[channel->second].counts[bin] += weight ;
+  }
+
+  setValueDirty() ;
+  return kTRUE ;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// Bin of the channel for the values in row, -1 if outside the bins
+
+Int_t HistFactoryNLL::findBin(const Channel& channel, const RooArgSet& row) const
+{
+  Int_t bin = 0 ;
+  for (UInt_t k=0 ; k<channel.obsNames.size() ; ++k) {
+    const RooAbsReal* var = dynamic_cast<const RooAbsReal*>(row.find(channel.obsNames[k])) ;
+    if (!var) return -1 ;
+    const std::vector<Double_t>& edges = channel.edges[k] ;
+    const Int_t nBins = edges.size()-1 ;
+    const Double_t x = var->getVal() ;
+    if (x<edges.front() || x>edges.back()) return -1 ;
+    Int_t i = std::upper_bound(edges.begin(),edges.end(),x)-edges.begin()-1 ;
+    if (i>=nBins) i = nBins-1 ;
+    bin = bin*nBins+i ;
+  }
+  return bin ;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+Double_t HistFactoryNLL::evaluate() const
+{
+  return evaluateWithGradient(0) ;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// Return the NLL and, if grad is not null, fill it with the derivatives of the
+/// NLL w.r.t. all the parameters(), constant or not.
+
+Double_t HistFactoryNLL::evaluateWithGradient(Double_t* grad) const
+{
+  if (!_valid) {
+    logEvalError("the model could not be compiled") ;
+    return 0 ;
+  }
+
+  RooFIter iter = _params.fwdIterator() ;
+  RooAbsArg* arg ;
+  Int_t i = 0 ;
+  while ((arg = iter.next())) _values[i++] = ((RooAbsReal*)arg)->getVal() ;
+  if (grad) std::fill(grad,grad+_values.size(),0.) ;
+
+  Double_t result = 0 ;
+  for (auto& channel : _channels) result += evaluateChannel(channel,grad) ;
+  for (auto& constraint : _constraintTerms) result += evaluateConstraint(constraint,grad) ;
+  return result ;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// NLL of a channel: sum of the expected events minus sum of the observed
+/// counts times the log of the density (or the non-extended equivalent)
+
+Double_t HistFactoryNLL::evaluateChannel(Channel& channel, Double_t* grad) const
+{
+  const Int_t nBins = channel.volume.size() ;
+  Double_t* density = channel.density.data() ;
+  std::fill(density,density+nBins,0.) ;
+
+  for (auto& sample : channel.samples) {
+    // per-bin factors
+    Double_t* contents = sample.contents.data() ;
+    std::copy(sample.shape.begin(),sample.shape.end(),contents) ;
+    Double_t* factors = sample.factors.data() ;
+    Double_t* derivs = sample.derivs.data() ;
+    for (auto& interp : sample.shapeInterps) {
+      shapeInterpValues(interp,nBins,factors,grad ? derivs : 0) ;
+      for (Int_t b=0 ; b<nBins ; ++b) contents[b] *= factors[b] ;
+      factors += nBins ;
+      derivs += interp.param.size()*nBins ;
+    }
+    const Int_t nHists = sample.binParams.size()/nBins ;
+    for (Int_t h=0 ; h<nHists ; ++h) {
+      const Int_t* index = &sample.binParams[h*nBins] ;
+      for (Int_t b=0 ; b<nBins ; ++b) {
+        factors[b] = _values[index[b]] ;
+        contents[b] *= factors[b] ;
+      }
+      factors += nBins ;
+    }
+
+    // scalar factors
+    Double_t norm = 1 ;
+    Int_t j = 0 ;
+    for (auto param : sample.normParams) norm *= (sample.normValues[j++] = _values[param]) ;
+    Double_t* normDerivs = sample.normDerivs.data() ;
+    for (auto& interp : sample.normInterps) {
+      norm *= (sample.normValues[j++] = normInterpValue(interp,grad ? normDerivs : 0)) ;
+      normDerivs += interp.param.size() ;
+    }
+
+    for (Int_t b=0 ; b<nBins ; ++b) density[b] += norm*contents[b] ;
+  }
+
+  const Double_t* volume = channel.volume.data() ;
+  const Double_t* counts = channel.counts.data() ;
+  Double_t expected = 0 ;
+  Double_t observed = 0 ;
+  Double_t logSum = 0 ;
+  Bool_t negative = kFALSE ;
+  for (Int_t b=0 ; b<nBins ; ++b) {
+    expected += volume[b]*density[b] ;
+    observed += counts[b] ;
+    if (counts[b]!=0) {
+      negative |= density[b]<=0 ;
+      logSum += counts[b]*std::log(density[b]) ;
+    }
+  }
+  if (negative) logEvalError("density is not positive in a bin with observed events") ;
+  const Double_t nll = channel.extended ? expected-logSum : observed*std::log(expected)-logSum ;
+  if (!grad) return nll ;
+
+  // derivative w.r.t. the density in each bin
+  Double_t* residual = channel.residual.data() ;
+  const Double_t scale = channel.extended ? 1. : observed/expected ;
+  for (Int_t b=0 ; b<nBins ; ++b) {
+    residual[b] = scale*volume[b]-(counts[b]!=0 ? counts[b]/density[b] : 0.) ;
+  }
+
+  Double_t* weights = channel.weights.data() ;
+  for (auto& sample : channel.samples) {
+    const Double_t* contents = sample.contents.data() ;
+
+    // scalar factors: derivative of the NLL w.r.t. the product of the scalar factors
+    Double_t dNorm = 0 ;
+    for (Int_t b=0 ; b<nBins ; ++b) dNorm += residual[b]*contents[b] ;
+    const Int_t nNorm = sample.normValues.size() ;
+    const Int_t nNormParams = sample.normParams.size() ;
+    const Double_t* normDerivs = sample.normDerivs.data() ;
+    Double_t norm = 1 ;
+    for (Int_t j=0 ; j<nNorm ; ++j) {
+      Double_t others = 1 ;
+      for (Int_t k=0 ; k<nNorm ; ++k) if (k!=j) others *= sample.normValues[k] ;
+      norm *= sample.normValues[j] ;
+      if (j<nNormParams) {
+        grad[sample.normParams[j]] += dNorm*others ;
+      } else {
+        const NormInterp& interp = sample.normInterps[j-nNormParams] ;
+        for (UInt_t i=0 ; i<interp.param.size() ; ++i) grad[interp.param[i]] += dNorm*others*normDerivs[i] ;
+        normDerivs += interp.param.size() ;
+      }
+    }
+
+    // per-bin factors: derivative of the NLL w.r.t. each factor in each bin
+    const Int_t nInterps = sample.shapeInterps.size() ;
+    const Int_t nFactors = sample.factors.size()/nBins ;
+    const Double_t* derivs = sample.derivs.data() ;
+    for (Int_t k=0 ; k<nFactors ; ++k) {
+      for (Int_t b=0 ; b<nBins ; ++b) weights[b] = norm*residual[b]*sample.shape[b] ;
+      for (Int_t j=0 ; j<nFactors ; ++j) {
+        if (j==k) continue ;
+        const Double_t* factors = &sample.factors[j*nBins] ;
+        for (Int_t b=0 ; b<nBins ; ++b) weights[b] *= factors[b] ;
+      }
+      if (k<nInterps) {
+        const ShapeInterp& interp = sample.shapeInterps[k] ;
+        for (UInt_t i=0 ; i<interp.param.size() ; ++i) {
+          Double_t sum = 0 ;
+          for (Int_t b=0 ; b<nBins ; ++b) sum += weights[b]*derivs[b] ;
+          grad[interp.param[i]] += sum ;
+          derivs += nBins ;
+        }
+      } else {
+        const Int_t* index = &sample.binParams[(k-nInterps)*nBins] ;
+        for (Int_t b=0 ; b<nBins ; ++b) grad[index[b]] += weights[b] ;
+      }
+    }
+  }
+
+  return nll ;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// Values of a PiecewiseInterpolation in all the bins, and the derivatives
+/// w.r.t. its parameters if derivs is not null (nBins values per parameter).
+/// Same interpolations as PiecewiseInterpolation::evaluate.
+
+void HistFactoryNLL::shapeInterpValues(const ShapeInterp& interp, Int_t nBins, Double_t* values, Double_t* derivs) const
+{
+  const Double_t* nominal = interp.nominal.data() ;
+  std::copy(nominal,nominal+nBins,values) ;
+
+  const Int_t nParams = interp.param.size() ;
+  for (Int_t i=0 ; i<nParams ; ++i) {
+    const Double_t x = _values[interp.param[i]] ;
+    const Double_t* up = &interp.up[i*nBins] ;
+    const Double_t* down = &interp.down[i*nBins] ;
+    Double_t* d = derivs ? derivs+i*nBins : 0 ;
+
+    switch (interp.code[i]) {
+    case 0: {
+      // piece-wise linear
+      const Double_t* slope = x>0 ? up : down ;
+      for (Int_t b=0 ; b<nBins ; ++b) values[b] += x*slope[b] ;
+      if (d) std::copy(slope,slope+nBins,d) ;
+      break ;
+    }
+    case 1: {
+      // piece-wise log: also scales the derivatives w.r.t. the previous parameters
+      const Double_t* logRatio = x>=0 ? up : down ;
+      const Double_t sign = x>=0 ? 1. : -1. ;
+      for (Int_t b=0 ; b<nBins ; ++b) {
+        const Double_t factor = std::exp(sign*x*logRatio[b]) ;
+        values[b] *= factor ;
+        if (d) {
+          for (Int_t j=0 ; j<i ; ++j) derivs[j*nBins+b] *= factor ;
+          d[b] = sign*values[b]*logRatio[b] ;
+        }
+      }
+      break ;
+    }
+    case 2:
+    case 3: {
+      // parabolic with linear extrapolation
+      for (Int_t b=0 ; b<nBins ; ++b) {
+        const Double_t a = 0.5*(up[b]-down[b]) ;
+        const Double_t c = 0.5*(up[b]+down[b]) ;
+        if (x>1) {
+          values[b] += (2*a+c)*(x-1)+up[b] ;
+          if (d) d[b] = 2*a+c ;
+        } else if (x<-1) {
+          values[b] += -(2*a-c)*(x+1)-down[b] ;
+          if (d) d[b] = -(2*a-c) ;
+        } else {
+          values[b] += a*x*x+c*x ;
+          if (d) d[b] = 2*a*x+c ;
+        }
+      }
+      break ;
+    }
+    case 4: {
+      // 6th order polynomial with linear extrapolation
+      if (x>1 || x<-1) {
+        const Double_t* slope = x>1 ? up : down ;
+        for (Int_t b=0 ; b<nBins ; ++b) values[b] += x*slope[b] ;
+        if (d) std::copy(slope,slope+nBins,d) ;
+        break ;
+      }
+      for (Int_t b=0 ; b<nBins ; ++b) {
+        const Double_t S = 0.5*(up[b]+down[b]) ;
+        const Double_t A = 0.0625*(up[b]-down[b]) ;
+        const Double_t delta = x*(S+x*A*(15+x*x*(-10+x*x*3))) ;
+        const Bool_t clamped = nominal[b]+delta<0 ;
+        values[b] += clamped ? -nominal[b] : delta ;
+        if (d) d[b] = clamped ? 0. : S+A*x*(30+x*x*(-40+x*x*18)) ;
+      }
+      break ;
+    }
+    case 5: {
+      // 4th order polynomial with linear extrapolation
+      if (x>1 || x<-1) {
+        const Double_t* slope = x>0 ? up : down ;
+        for (Int_t b=0 ; b<nBins ; ++b) values[b] += x*slope[b] ;
+        if (d) std::copy(slope,slope+nBins,d) ;
+        break ;
+      }
+      for (Int_t b=0 ; b<nBins ; ++b) {
+        const Double_t S = 0.5*(up[b]+down[b]) ;
+        const Double_t A = 0.5*(up[b]-down[b]) ;
+        const Double_t delta = x*(S+x*A*(1.5-0.5*x*x)) ;
+        const Bool_t clamped = nominal[b]==0 || nominal[b]+delta<0 ;
+        values[b] += clamped ? (nominal[b]==0 ? 0. : -nominal[b]) : delta ;
+        if (d) d[b] = clamped ? 0. : S+A*x*(3-2*x*x) ;
+      }
+      break ;
+    }
+    }
+  }
+
+  if (interp.positiveDefinite) {
+    for (Int_t b=0 ; b<nBins ; ++b) {
+      if (values[b]>=0) continue ;
+      values[b] = 0 ;
+      if (derivs) {
+        for (Int_t i=0 ; i<nParams ; ++i) derivs[i*nBins+b] = 0 ;
+      }
+    }
+  }
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// Value of a FlexibleInterpVar, and its derivatives w.r.t. its parameters if
+/// deriv is not null. Same interpolations as FlexibleInterpVar::evaluate.
+
+Double_t HistFactoryNLL::normInterpValue(const NormInterp& interp, Double_t* deriv) const
+{
+  const Double_t nominal = interp.nominal ;
+  Double_t total = nominal ;
+  const Int_t nParams = interp.param.size() ;
+  for (Int_t i=0 ; i<nParams ; ++i) {
+    const Double_t x = _values[interp.param[i]] ;
+    const Double_t low = interp.low[i] ;
+    const Double_t high = interp.high[i] ;
+    Double_t slope = 0 ;
+    Double_t factor = 1 ;
+    Bool_t multiplicative = kFALSE ;
+
+    switch (interp.code[i]) {
+    case 0:
+      // piece-wise linear
+      slope = x>0 ? high-nominal : nominal-low ;
+      total += x*slope ;
+      break ;
+    case 2:
+    case 3: {
+      // parabolic with linear extrapolation
+      const Double_t a = 0.5*(high+low)-nominal ;
+      const Double_t b = 0.5*(high-low) ;
+      if (x>1) {
+        total += (2*a+b)*(x-1)+high-nominal ;
+        slope = 2*a+b ;
+      } else if (x<-1) {
+        total += -(2*a-b)*(x+1)+low-nominal ;
+        slope = -(2*a-b) ;
+      } else {
+        total += a*x*x+b*x ;
+        slope = 2*a*x+b ;
+      }
+      break ;
+    }
+    case 1:
+    case 4:
+      multiplicative = kTRUE ;
+      if (interp.code[i]==4 && x>-interp.boundary && x<interp.boundary) {
+        // 6th order polynomial
+        const Double_t* c = &interp.poly[6*i] ;
+        factor = 1.+x*(c[0]+x*(c[1]+x*(c[2]+x*(c[3]+x*(c[4]+x*c[5]))))) ;
+        slope = c[0]+x*(2*c[1]+x*(3*c[2]+x*(4*c[3]+x*(5*c[4]+x*6*c[5])))) ;
+      } else if (x>=0) {
+        // piece-wise log
+        const Double_t logRatio = std::log(high/nominal) ;
+        factor = std::exp(x*logRatio) ;
+        slope = factor*logRatio ;
+      } else {
+        const Double_t logRatio = std::log(low/nominal) ;
+        factor = std::exp(-x*logRatio) ;
+        slope = -factor*logRatio ;
+      }
+      break ;
+    }
+
+    if (multiplicative) {
+      if (deriv) {
+        for (Int_t j=0 ; j<i ; ++j) deriv[j] *= factor ;
+        deriv[i] = total*slope ;
+      }
+      total *= factor ;
+    } else if (deriv) {
+      deriv[i] = slope ;
+    }
+  }
+
+  if (total<=0) {
+    total = TMath::Limits<double>::Min() ;
+    if (deriv) std::fill(deriv,deriv+nParams,0.) ;
+  }
+  return total ;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// -log of a constraint term, without the constant terms for the analytic ones
+
+Double_t HistFactoryNLL::evaluateConstraint(const Constraint& constraint, Double_t* grad) const
+{
+  switch (constraint.type) {
+  case kGaussian: {
+    const Double_t sigma = argValue(constraint.sigma) ;
+    const Double_t z = (argValue(constraint.x)-argValue(constraint.mean))/sigma ;
+    if (grad) {
+      if (constraint.x.param>=0) grad[constraint.x.param] += constraint.x.scale*z/sigma ;
+      if (constraint.mean.param>=0) grad[constraint.mean.param] -= constraint.mean.scale*z/sigma ;
+      if (constraint.sigma.param>=0) grad[constraint.sigma.param] += constraint.sigma.scale*(1-z*z)/sigma ;
+    }
+    return 0.5*z*z+std::log(sigma) ;
+  }
+  case kPoisson: {
+    Double_t k = argValue(constraint.x) ;
+    if (!constraint.noRounding) k = std::floor(k) ;
+    const Double_t mean = argValue(constraint.mean) ;
+    if (mean<=0 && k>0) logEvalError("mean of Poisson constraint is not positive") ;
+    if (grad && constraint.mean.param>=0) grad[constraint.mean.param] += constraint.mean.scale*(1-k/mean) ;
+    return mean-(k>0 ? k*std::log(mean) : 0.)+std::lgamma(k+1) ;
+  }
+  }
+
+  // generic constraint evaluated with RooFit on a private copy, numerical derivatives
+  ConstraintClone& clone = constraintClone(constraint) ;
+  for (UInt_t i=0 ; i<constraint.params.size() ; ++i) clone.params[i]->setVal(_values[constraint.params[i]]) ;
+  const Double_t value = -std::log(clone.pdf->getVal(&clone.normSet)) ;
+  if (grad) {
+    for (UInt_t i=0 ; i<constraint.params.size() ; ++i) {
+      const RooRealVar* param = (RooRealVar*)_params.at(constraint.params[i]) ;
+      if (param->isConstant()) continue ;
+      RooRealVar* cloneParam = clone.params[i] ;
+      const Double_t x0 = cloneParam->getVal() ;
+      const Double_t h = 1e-4*(param->getError()>0 ? param->getError() : std::max(1.,std::fabs(x0))) ;
+      cloneParam->setVal(x0+h) ;
+      const Double_t xUp = cloneParam->getVal() ;
+      const Double_t up = -std::log(clone.pdf->getVal(&clone.normSet)) ;
+      cloneParam->setVal(x0-h) ;
+      const Double_t xDown = cloneParam->getVal() ;
+      const Double_t down = -std::log(clone.pdf->getVal(&clone.normSet)) ;
+      cloneParam->setVal(x0) ;
+      if (xUp>xDown) grad[constraint.params[i]] += (up-down)/(xUp-xDown) ;
+    }
+  }
+  return value ;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// Private copy of a generic constraint term, made at its first evaluation. The
+/// numerical derivatives change the parameters of the copy only, so that they
+/// do not affect the model nor the other users of its parameters (e.g. other
+/// threads).
+
+HistFactoryNLL::ConstraintClone& HistFactoryNLL::constraintClone(const Constraint& constraint) const
+{
+  if (_constraintClones.size()<(UInt_t)_constraints.getSize()) _constraintClones.resize(_constraints.getSize()) ;
+  std::unique_ptr<ConstraintClone>& clone = _constraintClones[constraint.pdf] ;
+  if (clone) return *clone ;
+
+  const RooAbsArg* pdf = _constraints.at(constraint.pdf) ;
+  clone.reset(new ConstraintClone) ;
+  clone->nodes.reset((RooArgSet*)RooArgSet(*pdf).snapshot(kTRUE)) ;
+  clone->pdf = (RooAbsPdf*)clone->nodes->find(pdf->GetName()) ;
+  for (auto index : constraint.params) {
+    clone->params.push_back((RooRealVar*)clone->nodes->find(_params.at(index)->GetName())) ;
+  }
+  RooFIter iter = constraint.normSet.fwdIterator() ;
+  RooAbsArg* arg ;
+  while ((arg = iter.next())) clone->normSet.add(*clone->nodes->find(arg->GetName())) ;
+  return *clone ;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// Function of the parameters of nll that are floating at construction time
+
+HistFactoryNLL::GradFunction::GradFunction(const HistFactoryNLL& nll) :
+  _nll(&nll),
+  _grad(nll.parameters().getSize())
+{
+  RooFIter iter = nll.parameters().fwdIterator() ;
+  RooAbsArg* arg ;
+  Int_t i = 0 ;
+  while ((arg = iter.next())) {
+    RooRealVar* var = (RooRealVar*)arg ;
+    if (!var->isConstant()) {
+      _floating.push_back(var) ;
+      _index.push_back(i) ;
+    }
+    ++i ;
+  }
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+void HistFactoryNLL::GradFunction::setParameters(const double* x) const
+{
+  for (UInt_t i=0 ; i<_floating.size() ; ++i) _floating[i]->setVal(x[i]) ;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+double HistFactoryNLL::GradFunction::DoEval(const double* x) const
+{
+  setParameters(x) ;
+  return _nll->getVal() ;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+void HistFactoryNLL::GradFunction::FdF(const double* x, double& f, double* df) const
+{
+  setParameters(x) ;
+  f = _nll->evaluateWithGradient(_grad.data()) ;
+  for (UInt_t i=0 ; i<_index.size() ; ++i) df[i] = _grad[_index[i]] ;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+void HistFactoryNLL::GradFunction::Gradient(const double* x, double* grad) const
+{
+  double f ;
+  FdF(x,f,grad) ;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+double HistFactoryNLL::GradFunction::DoDerivative(const double* x, unsigned int icoord) const
+{
+  setParameters(x) ;
+  _nll->evaluateWithGradient(_grad.data()) ;
+  return _grad[_index[icoord]] ;
+}
+
+}
+}
@@ -0,0 +1,214 @@
+// Tests of HistFactoryNLL against the likelihood computed by RooFit, and of the RooFit
+// likelihood of HistFactory models
+
+#include "RooStats/HistFactory/Channel.h"
+#include "RooStats/HistFactory/FlexibleInterpVar.h"
+#include "RooStats/HistFactory/HistFactoryNLL.h"
+#include "RooStats/HistFactory/HistoToWorkspaceFactoryFast.h"
+#include "RooStats/HistFactory/Measurement.h"
+#include "RooStats/HistFactory/Sample.h"
+#include "RooStats/HistFactory/Systematics.h"
+#include "RooStats/ModelConfig.h"
+
+#include "RooAbsData.h"
+#include "RooAbsPdf.h"
+#include "RooArgSet.h"
+#include "RooGlobalFunc.h"
+#include "RooMsgService.h"
+#include "RooNLLVar.h"
+#include "RooRealVar.h"
+#include "RooWorkspace.h"
+#include "TH1D.h"
+
+#include "gtest/gtest.h"
+
+#include <algorithm>
+#include <cmath>
+#include <memory>
+#include <vector>
+
+using namespace RooStats;
+using namespace RooStats::HistFactory;
+
+// One channel with a signal of which the normalization has a log-normal constraint, and a
+// background with a shape systematic and statistical uncertainties with Poisson constraints
+class HistFactoryNLLTest : public ::testing::Test {
+protected:
+   HistFactoryNLLTest()
+   {
+      RooMsgService::instance().setGlobalKillBelow(RooFit::WARNING);
+
+      const int nBins = 5;
+      const double signal[nBins] = {2, 10, 20, 10, 2};
+      const double background[nBins] = {50, 45, 40, 35, 30};
+      const double data[nBins] = {55, 60, 57, 48, 30};
+      fSignal.reset(new TH1D("signal", "signal", nBins, 0, 5));
+      fBackground.reset(new TH1D("background", "background", nBins, 0, 5));
+      fBackgroundLow.reset(new TH1D("backgroundLow", "backgroundLow", nBins, 0, 5));
+      fBackgroundHigh.reset(new TH1D("backgroundHigh", "backgroundHigh", nBins, 0, 5));
+      fData.reset(new TH1D("data", "data", nBins, 0, 5));
+      for (int i = 0; i < nBins; ++i) {
+         fSignal->SetBinContent(i + 1, signal[i]);
+         fBackground->SetBinContent(i + 1, background[i]);
+         fBackground->SetBinError(i + 1, 0.1 * background[i]);
+         fBackgroundLow->SetBinContent(i + 1, background[i] * (0.9 + 0.04 * i));
+         fBackgroundHigh->SetBinContent(i + 1, background[i] * (1.1 - 0.03 * i));
+         fData->SetBinContent(i + 1, data[i]);
+      }
+
+      Measurement meas("meas", "meas");
+      meas.SetPOI("mu");
+      meas.SetLumi(1.0);
+      meas.SetLumiRelErr(0.02);
+      meas.AddConstantParam("Lumi");
+      meas.AddLogNormSyst("sigNorm", 0.1);
+
+      Channel channel("channel");
+      channel.SetData(fData.get());
+      channel.SetStatErrorConfig(0.01, Constraint::Poisson);
+
+      Sample sig("signal");
+      sig.SetHisto(fSignal.get());
+      sig.AddNormFactor("mu", 1, 0, 5);
+      sig.AddOverallSys("sigNorm", 0.9, 1.1);
+      channel.AddSample(sig);
+
+      Sample bkg("background");
+      bkg.SetHisto(fBackground.get());
+      bkg.ActivateStatError();
+      HistoSys shape("bkgShape");
+      shape.SetHistoLow(fBackgroundLow.get());
+      shape.SetHistoHigh(fBackgroundHigh.get());
+      bkg.AddHistoSys(shape);
+      channel.AddSample(bkg);
+
+      meas.AddChannel(channel);
+      fWorkspace.reset(HistoToWorkspaceFactoryFast::MakeCombinedModel(meas));
+      fModel = static_cast<ModelConfig *>(fWorkspace->obj("ModelConfig"));
+      fObsData = fWorkspace->data("obsData");
+   }
+
+   // set the interpolation code of all the FlexibleInterpVar of a function, return their number
+   int SetAllInterpCodes(const RooAbsArg &func, int code)
+   {
+      int n = 0;
+      std::unique_ptr<RooArgSet> components(func.getComponents());
+      RooFIter iter = components->fwdIterator();
+      while (RooAbsArg *arg = iter.next()) {
+         if (auto interp = dynamic_cast<FlexibleInterpVar *>(arg)) {
+            interp->setAllInterpCodes(code);
+            ++n;
+         }
+      }
+      return n;
+   }
+
+   // floating parameters of the model
+   std::vector<RooRealVar *> FloatingParameters(const HistFactoryNLL &nll)
+   {
+      std::vector<RooRealVar *> result;
+      RooFIter iter = nll.parameters().fwdIterator();
+      while (RooAbsArg *arg = iter.next()) {
+         auto var = static_cast<RooRealVar *>(arg);
+         if (!var->isConstant())
+            result.push_back(var);
+      }
+      return result;
+   }
+
+   std::unique_ptr<TH1D> fSignal;
+   std::unique_ptr<TH1D> fBackground;
+   std::unique_ptr<TH1D> fBackgroundLow;
+   std::unique_ptr<TH1D> fBackgroundHigh;
+   std::unique_ptr<TH1D> fData;
+   std::unique_ptr<RooWorkspace> fWorkspace;
+   ModelConfig *fModel = nullptr;
+   RooAbsData *fObsData = nullptr;
+};
+
+TEST_F(HistFactoryNLLTest, Value)
+{
+   ASSERT_NE(fModel, nullptr);
+   ASSERT_NE(fObsData, nullptr);
+   HistFactoryNLL nll("nll", "nll", *fModel->GetPdf(), *fObsData, fModel->GetGlobalObservables());
+   ASSERT_TRUE(nll.isValid());
+   std::unique_ptr<RooAbsReal> reference(fModel->GetPdf()->createNLL(
+      *fObsData, RooFit::Constrain(*fModel->GetNuisanceParameters()),
+      RooFit::GlobalObservables(*fModel->GetGlobalObservables())));
+
+   // the values differ by a constant only
+   const double offset = nll.getVal() - reference->getVal();
+   for (auto param : FloatingParameters(nll)) {
+      param->setVal(std::min(param->getVal() + 0.05 * (param->getMax() - param->getMin()), param->getMax()));
+      EXPECT_NEAR(offset, nll.getVal() - reference->getVal(), 1e-8 * std::abs(reference->getVal()))
+         << param->GetName();
+   }
+}
+
+TEST_F(HistFactoryNLLTest, Gradient)
+{
+   ASSERT_NE(fModel, nullptr);
+   ASSERT_NE(fObsData, nullptr);
+   HistFactoryNLL nll("nll", "nll", *fModel->GetPdf(), *fObsData, fModel->GetGlobalObservables());
+   ASSERT_TRUE(nll.isValid());
+
+   // away from the minimum, so that the derivatives are not all close to zero
+   std::vector<RooRealVar *> params = FloatingParameters(nll);
+   for (auto param : params)
+      param->setVal(std::min(param->getVal() + 0.03 * (param->getMax() - param->getMin()), param->getMax()));
+
+   // the gradient does not change the parameters of the model, including those of the
+   // constraint terms with numerical derivatives
+   std::vector<double> values;
+   for (auto param : params)
+      values.push_back(param->getVal());
+   std::vector<double> grad(nll.parameters().getSize());
+   const double value = nll.evaluateWithGradient(grad.data());
+   EXPECT_DOUBLE_EQ(value, nll.getVal());
+   for (std::size_t i = 0; i < params.size(); ++i)
+      EXPECT_EQ(values[i], params[i]->getVal()) << params[i]->GetName();
+
+   HistFactoryNLL::GradFunction func(nll);
+   ASSERT_EQ(func.NDim(), params.size());
+   std::vector<double> x(values);
+   std::vector<double> analytic(func.NDim());
+   func.Gradient(x.data(), analytic.data());
+   for (std::size_t i = 0; i < x.size(); ++i) {
+      const double h = 1e-5 * std::max(1., std::abs(values[i]));
+      x[i] = values[i] + h;
+      const double up = func(x.data());
+      x[i] = values[i] - h;
+      const double down = func(x.data());
+      x[i] = values[i];
+      const double numeric = (up - down) / (2 * h);
+      EXPECT_NEAR(analytic[i], numeric, 1e-4 * std::max(1., std::abs(numeric))) << params[i]->GetName();
+   }
+}
+
+// The values of the parameter states kept by the likelihood must be forgotten when the
+// interpolation code changes, even if the parameters then come back to a known state
+TEST_F(HistFactoryNLLTest, InterpCodeChangeAtSameParameters)
+{
+   ASSERT_NE(fObsData, nullptr);
+   RooAbsPdf *pdf = fWorkspace->pdf("model_channel");
+   RooRealVar *alpha = fWorkspace->var("alpha_sigNorm");
+   ASSERT_NE(pdf, nullptr);
+   ASSERT_NE(alpha, nullptr);
+
+   RooNLLVar nll("nll", "nll", *pdf, *fObsData);
+   nll.setCacheParameterStates(true);
+   alpha->setVal(0.5);
+   const double before = nll.getVal();
+   alpha->setVal(0.6);
+   nll.getVal();
+
+   // change the interpolation in the clone of the model evaluated by the likelihood
+   ASSERT_GT(SetAllInterpCodes(nll.function(), 0), 0);
+   alpha->setVal(0.5);
+   const double after = nll.getVal();
+
+   ASSERT_GT(SetAllInterpCodes(*pdf, 0), 0);
+   RooNLLVar reference("reference", "reference", *pdf, *fObsData);
+   EXPECT_NE(before, after);
+   EXPECT_NEAR(reference.getVal(), after, 1e-10 * std::abs(after));
+}
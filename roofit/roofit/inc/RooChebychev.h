@@ -45,6 +45,7 @@ private:
   mutable TNamed* _refRangeName ; 
 
   Double_t evaluate() const;
+  RooSpan<double> evaluateBatch(std::size_t begin, std::size_t batchSize) const;
   Double_t evalAnaInt(const Double_t x) const;
 
   ClassDef(RooChebychev,2) // Chebychev polynomial PDF
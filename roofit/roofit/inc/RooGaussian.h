@@ -39,6 +39,10 @@ public:
 
   Double_t getLogVal(const RooArgSet* set) const ;
 
+  const RooAbsReal& getX() const { return x.arg() ; }
+  const RooAbsReal& getMean() const { return mean.arg() ; }
+  const RooAbsReal& getSigma() const { return sigma.arg() ; }
+
 protected:
 
   RooRealProxy x ;
@@ -46,6 +50,7 @@ protected:
   RooRealProxy sigma ;
 
   Double_t evaluate() const ;
+  RooSpan<double> evaluateBatch(std::size_t begin, std::size_t batchSize) const ;
 
 private:
 
@@ -35,6 +35,10 @@ public:
 
   Double_t getLogVal(const RooArgSet* set=0) const ;
 
+  const RooAbsReal& getX() const { return x.arg() ; }
+  const RooAbsReal& getMean() const { return mean.arg() ; }
+  Bool_t getNoRounding() const { return _noRounding ; }
+
 protected:
 
   RooRealProxy x ;
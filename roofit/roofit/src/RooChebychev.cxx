@@ -129,6 +129,48 @@ Double_t RooChebychev::evaluate() const
   return sum;
 }
 
+////////////////////////////////////////////////////////////////////////////////
+/// Compute the polynomial for a batch of entries. The coefficients must be
+/// constant in the batch, otherwise the entries are evaluated one by one.
+
+RooSpan<double> RooChebychev::evaluateBatch(std::size_t begin, std::size_t batchSize) const
+{
+  const Int_t order = _coefList.getSize();
+  if (order > 7) return RooSpan<double>();
+
+  Double_t coef[7] = { 0., 0., 0., 0., 0., 0., 0. };
+  for (Int_t k = 0; k < order; ++k) {
+    RooSpan<const double> c = ((RooAbsReal&)_coefList[k]).getValBatch(begin, batchSize);
+    if (c.size() != 1) return RooSpan<double>();
+    coef[k] = c[0];
+  }
+
+  Double_t xmin = _x.min(_refRangeName?_refRangeName->GetName():0) ; Double_t xmax = _x.max(_refRangeName?_refRangeName->GetName():0);
+  RooSpan<const double> xData = _x.getValBatch(begin, batchSize);
+  RooSpan<double> output = makeBatch(xData.size());
+  const std::size_t n = output.size();
+
+  for (std::size_t i = 0; i < n; ++i) {
+    const Double_t x(-1+2*(xData[i]-xmin)/(xmax-xmin));
+    const Double_t x2(x*x);
+    Double_t sum(0) ;
+    switch (order) {
+    // the terms of the lower orders are added by falling through the cases
+    case  7: sum+=coef[6]*x*p3(x2,64,-112,56,-7); // fall through
+    case  6: sum+=coef[5]*p3(x2,32,-48,18,-1);    // fall through
+    case  5: sum+=coef[4]*x*p2(x2,16,-20,5);      // fall through
+    case  4: sum+=coef[3]*p2(x2,8,-8,1);          // fall through
+    case  3: sum+=coef[2]*x*p1(x2,4,-3);          // fall through
+    case  2: sum+=coef[1]*p1(x2,2,-1);            // fall through
+    case  1: sum+=coef[0]*x;                      // fall through
+    case  0: sum+=1; break;
+    }
+    output[i] = sum;
+  }
+
+  return output;
+}
+
 ////////////////////////////////////////////////////////////////////////////////
 
 Int_t RooChebychev::getAnalyticalIntegral(RooArgSet& allVars, RooArgSet& analVars, const char* /* rangeName */) const
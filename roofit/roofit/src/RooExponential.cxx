@@ -28,6 +28,7 @@ Exponential p.d.f
 
 #include "RooExponential.h"
 #include "RooRealVar.h"
+#include "BatchHelpers.h"
 
 using namespace std;
 
@@ -57,6 +58,39 @@ Double_t RooExponential::evaluate() const{
   return exp(c*x);
 }
 
+namespace {
+
+template<class Tx, class Tc>
+void compute(RooSpan<double> output, Tx x, Tc c)
+{
+  const std::size_t n = output.size();
+  for (std::size_t i = 0; i < n; ++i) {
+    output[i] = exp(c[i]*x[i]);
+  }
+}
+
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// Compute the exponential for a batch of entries.
+
+RooSpan<double> RooExponential::evaluateBatch(std::size_t begin, std::size_t batchSize) const {
+  using namespace BatchHelpers;
+
+  RooSpan<const double> xData = x.getValBatch(begin, batchSize);
+  RooSpan<const double> cData = c.getValBatch(begin, batchSize);
+
+  RooSpan<double> output = makeBatch(findSize({xData, cData}));
+
+  if (isBatch(xData) && !isBatch(cData)) {
+    compute(output, xData.data(), BracketAdapter(cData));
+  } else {
+    compute(output, BracketAdapterWithMask(xData), BracketAdapterWithMask(cData));
+  }
+
+  return output;
+}
+
 ////////////////////////////////////////////////////////////////////////////////
 
 Int_t RooExponential::getAnalyticalIntegral(RooArgSet& allVars, RooArgSet& analVars, const char* /*rangeName*/) const
@@ -31,6 +31,7 @@ Plain Gaussian p.d.f
 #include "RooRealVar.h"
 #include "RooRandom.h"
 #include "RooMath.h"
+#include "BatchHelpers.h"
 
 using namespace std;
 
@@ -69,6 +70,44 @@ Double_t RooGaussian::evaluate() const
   return ret ;
 }
 
+namespace {
+
+template<class Tx, class TMean, class TSig>
+void compute(RooSpan<double> output, Tx x, TMean mean, TSig sigma)
+{
+  const std::size_t n = output.size() ;
+  for (std::size_t i=0 ; i<n ; ++i) {
+    const double arg = x[i] - mean[i] ;
+    const double sig = sigma[i] ;
+    output[i] = exp(-0.5*arg*arg/(sig*sig)) ;
+  }
+}
+
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// Compute the Gaussian for a batch of entries. The loop is specialized for the
+/// common case of an observable and constant mean and width.
+
+RooSpan<double> RooGaussian::evaluateBatch(std::size_t begin, std::size_t batchSize) const
+{
+  using namespace BatchHelpers ;
+
+  RooSpan<const double> xData = x.getValBatch(begin,batchSize) ;
+  RooSpan<const double> meanData = mean.getValBatch(begin,batchSize) ;
+  RooSpan<const double> sigmaData = sigma.getValBatch(begin,batchSize) ;
+
+  RooSpan<double> output = makeBatch(findSize({xData,meanData,sigmaData})) ;
+
+  if (isBatch(xData) && !isBatch(meanData) && !isBatch(sigmaData)) {
+    compute(output,xData.data(),BracketAdapter(meanData),BracketAdapter(sigmaData)) ;
+  } else {
+    compute(output,BracketAdapterWithMask(xData),BracketAdapterWithMask(meanData),BracketAdapterWithMask(sigmaData)) ;
+  }
+
+  return output ;
+}
+
 ////////////////////////////////////////////////////////////////////////////////
 /// calculate and return the negative log-likelihood of the Poisson
 
@@ -123,6 +123,53 @@ Double_t RooPolynomial::evaluate() const
   return retVal * std::pow(x, lowestOrder) + (lowestOrder ? 1.0 : 0.0);
 }
 
+////////////////////////////////////////////////////////////////////////////////
+/// Compute the polynomial for a batch of entries. The coefficients must be
+/// constant in the batch, otherwise the entries are evaluated one by one.
+
+RooSpan<double> RooPolynomial::evaluateBatch(std::size_t begin, std::size_t batchSize) const
+{
+  const unsigned sz = _coefList.getSize();
+  const int lowestOrder = _lowestOrder;
+  _wksp.clear();
+  _wksp.reserve(sz);
+  {
+    const RooArgSet* nset = _coefList.nset();
+    RooFIter it = _coefList.fwdIterator();
+    RooAbsReal* c;
+    while ((c = (RooAbsReal*) it.next())) {
+      RooSpan<const double> coef = c->getValBatch(begin, batchSize, nset);
+      if (coef.size() != 1) return RooSpan<double>();
+      _wksp.push_back(coef[0]);
+    }
+  }
+
+  RooSpan<const double> xData = _x.getValBatch(begin, batchSize);
+  const double* x = xData.data();
+  RooSpan<double> output = makeBatch(xData.size());
+  const std::size_t n = output.size();
+
+  if (!sz) {
+    for (std::size_t i = 0; i < n; ++i) output[i] = lowestOrder ? 1. : 0.;
+    return output;
+  }
+
+  // Horner scheme, one coefficient at a time for all entries
+  for (std::size_t i = 0; i < n; ++i) output[i] = _wksp[sz - 1];
+  for (unsigned k = sz - 1; k--; ) {
+    const Double_t coef = _wksp[k];
+    for (std::size_t i = 0; i < n; ++i) output[i] = coef + x[i] * output[i];
+  }
+
+  if (lowestOrder == 1) {
+    for (std::size_t i = 0; i < n; ++i) output[i] = output[i] * x[i] + 1.0;
+  } else if (lowestOrder > 1) {
+    for (std::size_t i = 0; i < n; ++i) output[i] = output[i] * std::pow(x[i], lowestOrder) + 1.0;
+  }
+
+  return output;
+}
+
 ////////////////////////////////////////////////////////////////////////////////
 
 Int_t RooPolynomial::getAnalyticalIntegral(RooArgSet& allVars, RooArgSet& analVars, const char* /*rangeName*/) const
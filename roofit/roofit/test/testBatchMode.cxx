@@ -0,0 +1,185 @@
+// Tests of the batch evaluation of the likelihood against the evaluation entry by entry
+
+#include "RooAddPdf.h"
+#include "RooArgSet.h"
+#include "RooChebychev.h"
+#include "RooDataSet.h"
+#include "RooExponential.h"
+#include "RooFitResult.h"
+#include "RooGaussian.h"
+#include "RooGenericPdf.h"
+#include "RooGlobalFunc.h"
+#include "RooMsgService.h"
+#include "RooPolynomial.h"
+#include "RooProdPdf.h"
+#include "RooRandom.h"
+#include "RooRealVar.h"
+#include "RooSpan.h"
+#include "RooVectorDataStore.h"
+
+#include "gtest/gtest.h"
+
+#include <cmath>
+#include <memory>
+
+using namespace RooFit;
+
+// Compare the likelihoods with and without batch evaluations at the initial and at modified
+// parameter values, and the results of a fit with both.
+static void ExpectSameWithBatchMode(RooAbsPdf &pdf, const RooArgSet &observables, int nEvents = 10000)
+{
+   RooMsgService::instance().setGlobalKillBelow(RooFit::WARNING);
+   RooRandom::randomGenerator()->SetSeed(1337);
+   std::unique_ptr<RooDataSet> data(pdf.generate(observables, nEvents));
+   std::unique_ptr<RooArgSet> params(pdf.getParameters(observables));
+   std::unique_ptr<RooArgSet> initial(static_cast<RooArgSet *>(params->snapshot()));
+
+   std::unique_ptr<RooAbsReal> nll(pdf.createNLL(*data));
+   std::unique_ptr<RooAbsReal> nllBatch(pdf.createNLL(*data, BatchMode(true)));
+   EXPECT_NEAR(nll->getVal(), nllBatch->getVal(), 1e-10 * std::abs(nll->getVal()));
+
+   // move the parameters away from the generated values
+   RooFIter paramIter = params->fwdIterator();
+   while (RooAbsArg *param = paramIter.next()) {
+      auto var = static_cast<RooRealVar *>(param);
+      var->setVal(var->getVal() + 0.1 * (var->getMax() - var->getVal()));
+   }
+   EXPECT_NEAR(nll->getVal(), nllBatch->getVal(), 1e-10 * std::abs(nll->getVal()));
+
+   std::unique_ptr<RooArgSet> start(static_cast<RooArgSet *>(params->snapshot()));
+   std::unique_ptr<RooFitResult> result(pdf.fitTo(*data, Save(), PrintLevel(-1)));
+   *params = *start;
+   std::unique_ptr<RooFitResult> resultBatch(pdf.fitTo(*data, Save(), PrintLevel(-1), BatchMode(true)));
+   ASSERT_NE(result, nullptr);
+   ASSERT_NE(resultBatch, nullptr);
+   EXPECT_EQ(result->status(), 0);
+   EXPECT_EQ(resultBatch->status(), 0);
+   EXPECT_NEAR(result->minNll(), resultBatch->minNll(), 1e-9 * std::abs(result->minNll()));
+   RooFIter resultIter = result->floatParsFinal().fwdIterator();
+   while (RooAbsArg *param = resultIter.next()) {
+      auto var = static_cast<RooRealVar *>(param);
+      auto varBatch = static_cast<RooRealVar *>(resultBatch->floatParsFinal().find(var->GetName()));
+      ASSERT_NE(varBatch, nullptr);
+      EXPECT_NEAR(var->getVal(), varBatch->getVal(), 1e-3 * var->getError()) << var->GetName();
+      EXPECT_NEAR(var->getError(), varBatch->getError(), 1e-3 * var->getError()) << var->GetName();
+   }
+
+   *params = *initial;
+}
+
+TEST(BatchMode, Gaussian)
+{
+   RooRealVar x("x", "x", -10, 10);
+   RooRealVar mean("mean", "mean", 1, -5, 5);
+   RooRealVar sigma("sigma", "sigma", 2, 0.1, 5);
+   RooGaussian gauss("gauss", "gauss", x, mean, sigma);
+   ExpectSameWithBatchMode(gauss, x);
+}
+
+TEST(BatchMode, Exponential)
+{
+   RooRealVar x("x", "x", 0, 10);
+   RooRealVar c("c", "c", -0.4, -2, -0.01);
+   RooExponential expo("expo", "expo", x, c);
+   ExpectSameWithBatchMode(expo, x);
+}
+
+TEST(BatchMode, Polynomial)
+{
+   RooRealVar x("x", "x", -1, 1);
+   RooRealVar a1("a1", "a1", 0.3, -1, 1);
+   RooRealVar a2("a2", "a2", 0.5, 0, 2);
+   RooPolynomial poly("poly", "poly", x, RooArgList(a1, a2));
+   ExpectSameWithBatchMode(poly, x);
+}
+
+TEST(BatchMode, Chebychev)
+{
+   RooRealVar x("x", "x", 2, 6);
+   RooRealVar c1("c1", "c1", 0.3, -1, 1);
+   RooRealVar c2("c2", "c2", -0.2, -1, 1);
+   RooRealVar c3("c3", "c3", 0.1, -1, 1);
+   RooChebychev cheby("cheby", "cheby", x, RooArgList(c1, c2, c3));
+   ExpectSameWithBatchMode(cheby, x);
+}
+
+TEST(BatchMode, AddPdf)
+{
+   RooRealVar x("x", "x", 0, 10);
+   RooRealVar mean("mean", "mean", 5, 2, 8);
+   RooRealVar sigma("sigma", "sigma", 0.5, 0.1, 2);
+   RooGaussian gauss("gauss", "gauss", x, mean, sigma);
+   RooRealVar c("c", "c", -0.3, -2, -0.01);
+   RooExponential expo("expo", "expo", x, c);
+   RooRealVar frac("frac", "frac", 0.3, 0, 1);
+   RooAddPdf sum("sum", "sum", gauss, expo, frac);
+   ExpectSameWithBatchMode(sum, x);
+}
+
+TEST(BatchMode, ProdPdf)
+{
+   RooRealVar x("x", "x", -10, 10);
+   RooRealVar mean("mean", "mean", 1, -5, 5);
+   RooRealVar sigma("sigma", "sigma", 2, 0.1, 5);
+   RooGaussian gauss("gauss", "gauss", x, mean, sigma);
+   RooRealVar y("y", "y", 0, 10);
+   RooRealVar c("c", "c", -0.4, -2, -0.01);
+   RooExponential expo("expo", "expo", y, c);
+   RooProdPdf prod("prod", "prod", gauss, expo);
+   ExpectSameWithBatchMode(prod, RooArgSet(x, y));
+}
+
+// A node evaluated for several normalisation sets in the same expression tree keeps the
+// values of each of them
+TEST(BatchMode, NormSetsOfSharedNode)
+{
+   RooRealVar x("x", "x", -10, 10);
+   RooRealVar mean("mean", "mean", 1, -5, 5);
+   RooRealVar sigma("sigma", "sigma", 2, 0.1, 5);
+   RooGaussian gauss("gauss", "gauss", x, mean, sigma);
+   const std::size_t n = 100;
+   std::unique_ptr<RooDataSet> data(gauss.generate(x, n));
+   gauss.attachDataSet(*data);
+   auto store = dynamic_cast<RooVectorDataStore *>(data->store());
+   ASSERT_NE(store, nullptr);
+   ASSERT_TRUE(store->attachBatchInputs());
+
+   RooArgSet normSet(*data->get());
+   RooSpan<const double> normalised = gauss.getValBatch(0, n, &normSet);
+   RooSpan<const double> unnormalised = gauss.getValBatch(0, n, nullptr);
+   ASSERT_EQ(normalised.size(), n);
+   ASSERT_EQ(unnormalised.size(), n);
+   for (std::size_t i = 0; i < n; ++i) {
+      data->get(i);
+      EXPECT_DOUBLE_EQ(normalised[i], gauss.getVal(normSet)) << "entry " << i;
+      EXPECT_DOUBLE_EQ(unnormalised[i], gauss.getVal()) << "entry " << i;
+   }
+   store->attachBatchInputs(kFALSE);
+}
+
+// The entry by entry evaluation of the classes without batch kernel leaves the observables
+// at their values
+TEST(BatchMode, ScalarFallbackRestoresObservables)
+{
+   RooRealVar x("x", "x", -10, 10);
+   RooGenericPdf generic("generic", "generic", "exp(-0.5*x*x/4)", x);
+   const std::size_t n = 100;
+   std::unique_ptr<RooDataSet> data(generic.generate(x, n));
+   generic.attachDataSet(*data);
+   auto store = dynamic_cast<RooVectorDataStore *>(data->store());
+   ASSERT_NE(store, nullptr);
+   ASSERT_TRUE(store->attachBatchInputs());
+
+   const RooArgSet *row = data->get(5);
+   auto xData = static_cast<RooRealVar *>(row->find("x"));
+   const double before = xData->getVal();
+   ASSERT_NE(before, data->get(n - 1)->getRealValue("x"));
+   data->get(5);
+
+   RooArgSet normSet(*row);
+   RooSpan<const double> values = generic.getValBatch(0, n, &normSet);
+   ASSERT_EQ(values.size(), n);
+   EXPECT_EQ(xData->getVal(), before);
+   EXPECT_DOUBLE_EQ(generic.getVal(normSet), values[5]);
+   store->attachBatchInputs(kFALSE);
+}
@@ -0,0 +1,76 @@
+/*****************************************************************************
+ * Project: RooFit                                                           *
+ * Package: RooFitCore                                                       *
+ *    File: $Id$
+ *                                                                           *
+ * Copyright (c) 2018, CERN                                                  *
+ *                                                                           *
+ * Redistribution and use in source and binary forms,                        *
+ * with or without modification, are permitted according to the terms        *
+ * listed in LICENSE (http://roofit.sourceforge.net/license.txt)             *
+ *****************************************************************************/
+#ifndef ROO_BATCH_HELPERS
+#define ROO_BATCH_HELPERS
+
+#include "RooSpan.h"
+
+#include <cstddef>
+#include <initializer_list>
+
+////////////////////////////////////////////////////////////////////////////////
+/// Helpers for the implementation of RooAbsReal::evaluateBatch().
+///
+/// The inputs of a batch computation are spans that either hold one value per
+/// entry (e.g. an observable) or a single value for the whole batch (e.g. a
+/// parameter). The computation kernels are written as templates using the
+/// bracket operator on their inputs, and are instantiated with
+/// - plain pointers for the inputs holding one value per entry,
+/// - BracketAdapter for the inputs that are constant in the batch,
+/// - BracketAdapterWithMask for the general case.
+/// The combination of pointers and BracketAdapter gives loops that the
+/// compiler can vectorize.
+
+namespace BatchHelpers {
+
+/// Gives a bracket operator to a value that is constant in the batch.
+class BracketAdapter {
+public:
+  BracketAdapter(double payload) : _payload(payload) {}
+  BracketAdapter(RooSpan<const double> batch) : _payload(batch[0]) {}
+  double operator[](std::size_t) const { return _payload ; }
+private:
+  double _payload ;
+} ;
+
+/// Gives a bracket operator to a span holding either one value or one value per entry.
+class BracketAdapterWithMask {
+public:
+  BracketAdapterWithMask(RooSpan<const double> batch) :
+    _pointer(batch.data()), _mask(batch.size() > 1 ? ~static_cast<std::size_t>(0) : 0) {}
+  double operator[](std::size_t i) const { return _pointer[i & _mask] ; }
+private:
+  const double* _pointer ;
+  std::size_t _mask ;
+} ;
+
+/// Return the size of the batch to be computed from a list of inputs: 1 if all
+/// the inputs are constant in the batch, 0 if any of the inputs is empty.
+inline std::size_t findSize(std::initializer_list<RooSpan<const double> > inputs)
+{
+  std::size_t size = 1 ;
+  for (auto& input : inputs) {
+    if (input.empty()) return 0 ;
+    if (input.size() > size) size = input.size() ;
+  }
+  return size ;
+}
+
+/// Return true if the input holds one value per entry.
+inline bool isBatch(RooSpan<const double> input)
+{
+  return input.size() > 1 ;
+}
+
+}
+
+#endif
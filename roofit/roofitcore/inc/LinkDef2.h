@@ -32,6 +32,7 @@
 #pragma link C++ class RooIntegrator2D+ ;
 #pragma link C++ class RooIntegratorBinding+ ;
 #pragma link C++ class RooInt+ ;
+#pragma link C++ class RooIntegralTable+ ;
 #pragma link C++ class RooInvTransform+ ;
 #pragma link C++ class RooLinearVar+ ;
 #pragma link C++ class RooLinkedListElem+ ;
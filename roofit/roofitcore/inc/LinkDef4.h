@@ -52,6 +52,9 @@
 #pragma link C++ class RooVectorDataStore::RealVector- ;
 #pragma link C++ class RooVectorDataStore::RealFullVector- ;
 #pragma link C++ class RooVectorDataStore::CatVector- ;
+#pragma link C++ class RooCompactDataStore- ;
+#pragma link C++ class RooCompactDataStore::RealColumn+ ;
+#pragma link C++ class RooCompactDataStore::CatColumn+ ;
 #pragma link C++ class std::pair<std::string,RooAbsData*>+ ;
 #pragma link C++ class std::pair<int,RooLinkedListElem*>+ ;
 #pragma link C++ class RooUnitTest+ ;
@@ -40,6 +40,7 @@ class RooAbsCollection ;
 class RooTreeData ;
 class RooTreeDataStore ;
 class RooVectorDataStore ;
+class RooCompactDataStore ;
 class RooAbsData ;
 class RooAbsDataStore ;
 class RooAbsProxy ;
@@ -282,6 +283,9 @@ public:
 
   static void setDirtyInhibit(Bool_t flag) ;
 
+  static void registerConfigChange() ;
+  static ULong64_t configChangeCount() ;
+
   virtual Bool_t operator==(const RooAbsArg& other) = 0 ;
   virtual Bool_t isIdentical(const RooAbsArg& other, Bool_t assumeSameType=kFALSE) = 0 ;
 
@@ -535,6 +539,7 @@ public:
   friend class RooCompositeDataStore ;
   friend class RooTreeDataStore ;
   friend class RooVectorDataStore ;
+  friend class RooCompactDataStore ;
   friend class RooTreeData ;
   friend class RooDataSet ;
   friend class RooRealMPFE ;
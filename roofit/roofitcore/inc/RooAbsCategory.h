@@ -99,6 +99,7 @@ protected:
   virtual Bool_t isValid(const RooCatType& value) const ;
 
   friend class RooVectorDataStore ;
+  friend class RooCompactDataStore ;
   virtual void syncCache(const RooArgSet* set=0) ;
   virtual void copyCache(const RooAbsArg* source, Bool_t valueOnly=kFALSE, Bool_t setValueDirty=kTRUE) ;
   virtual void attachToTree(TTree& t, Int_t bufSize=32000) ;
@@ -213,7 +213,7 @@ public:
   static void claimVars(RooAbsData*) ;
   static Bool_t releaseVars(RooAbsData*) ;
 
-  enum StorageType { Tree, Vector, Composite };
+  enum StorageType { Tree, Vector, Composite, Compact };
 
   static void setDefaultStorageType(StorageType s) ;
 
@@ -201,6 +201,8 @@ public:
   virtual Double_t getValV(const RooArgSet* set=0) const ;
   virtual Double_t getLogVal(const RooArgSet* set=0) const ;
 
+  virtual RooSpan<const double> getValBatch(std::size_t begin, std::size_t batchSize, const RooArgSet* normSet=0) const ;
+
   Double_t getNorm(const RooArgSet& nset) const { 
     // Get p.d.f normalization term needed for observables 'nset'
     return getNorm(&nset) ; 
@@ -22,6 +22,7 @@
 #include "RooArgSet.h"
 #include "RooArgList.h"
 #include "RooGlobalFunc.h"
+#include "RooSpan.h"
 
 class RooArgList ;
 class RooDataSet ;
@@ -47,8 +48,10 @@ class TH2F;
 class TH3F;
 
 #include <list>
+#include <map>
 #include <string>
 #include <iostream>
+#include <vector>
 
 class RooAbsReal : public RooAbsArg {
 public:
@@ -73,6 +76,8 @@ public:
 
   virtual Double_t getValV(const RooArgSet* set=0) const ;
 
+  virtual RooSpan<const double> getValBatch(std::size_t begin, std::size_t batchSize, const RooArgSet* normSet=0) const ;
+
   Double_t getPropagatedError(const RooFitResult &fr, const RooArgSet &nset = RooArgSet());
 
   Bool_t operator==(Double_t value) const ;
@@ -372,9 +377,15 @@ protected:
   }
   virtual Double_t evaluate() const = 0 ;
 
+  // Batch evaluation, see getValBatch()
+  virtual RooSpan<double> evaluateBatch(std::size_t begin, std::size_t batchSize) const ;
+  RooSpan<double> makeBatch(std::size_t batchSize) const ;
+  RooSpan<const double> evaluateBatchScalar(std::size_t begin, std::size_t batchSize, const RooArgSet* normSet) const ;
+
   // Hooks for RooDataSet interface
   friend class RooRealIntegral ;
   friend class RooVectorDataStore ;
+  friend class RooCompactDataStore ;
   virtual void syncCache(const RooArgSet* set=0) { getVal(set) ; }
   virtual void copyCache(const RooAbsArg* source, Bool_t valueOnly=kFALSE, Bool_t setValDirty=kTRUE) ;
   virtual void attachToTree(TTree& t, Int_t bufSize=32000) ;
@@ -482,6 +493,13 @@ protected:
   mutable RooArgSet* _lastNSet ; //!
   static Bool_t _hideOffset ; // Offset hiding flag
 
+  // Values computed by the last batch evaluation, for each normalisation set: a node
+  // used more than once in an expression tree, e.g. by pdfs normalised over different
+  // observables, does not overwrite the values returned to its other clients
+  mutable std::map<const RooArgSet*,std::vector<double> > _batchValues ; //!
+  mutable const RooArgSet* _batchNormSet ; //! Normalisation set of the batch evaluation in progress
+  const double* _batchInput ; //! Values of this object for all entries of a dataset, set during batch evaluations
+
   ClassDef(RooAbsReal,2) // Abstract real-valued variable
 };
 
@@ -21,6 +21,7 @@
 #include "RooRealProxy.h"
 #include "TStopwatch.h"
 #include <string>
+#include <functional>
 
 class RooArgSet ;
 class RooAbsData ;
@@ -33,6 +34,10 @@ typedef RooAbsTestStatistic* pRooAbsTestStatistic ;
 typedef RooAbsData* pRooAbsData ;
 typedef RooRealMPFE* pRooRealMPFE ;
 
+namespace ROOT {
+  class TThreadExecutor ;
+}
+
 class RooAbsTestStatistic : public RooAbsReal {
     friend class RooRealMPFE;
 public:
@@ -60,8 +65,16 @@ public:
 
   void enableOffsetting(Bool_t flag) ;
   Bool_t isOffsetting() const { return _doOffset ; }
-  virtual Double_t offset() const { return _offset ; }
-  virtual Double_t offsetCarry() const { return _offsetCarry; }
+  virtual Double_t offset() const ;
+  virtual Double_t offsetCarry() const ;
+
+  void setNumThreads(Int_t nThreads) ;
+  Int_t numThreads() const {
+    // Return number of threads used to calculate the test statistic
+    return _nThreads ;
+  }
+
+  void setCacheParameterStates(Bool_t flag) ;
 
 protected:
 
@@ -121,6 +134,13 @@ protected:
   Bool_t initialize() ;
   void initSimMode(RooSimultaneous* pdf, RooAbsData* data, const RooArgSet* projDeps, const char* rangeName, const char* addCoefRangeName) ;    
   void initMPMode(RooAbsReal* real, RooAbsData* data, const RooArgSet* projDeps, const char* rangeName, const char* addCoefRangeName) ;
+  void initMTMode() ;
+  Double_t evaluateWorkers() const ;
+  void runTasks(Int_t nTasks, const std::function<void(Int_t)>& task) const ;
+
+  Bool_t findCachedState(Double_t& value) const ;
+  void cacheState(Double_t value) const ;
+  void clearStateCache() const ;
 
   mutable Bool_t _init ;          //! Is object initialized  
   GOFOpMode   _gofOpMode ;        // Operation mode of test statistic instance 
@@ -139,13 +159,29 @@ protected:
   Int_t          _nCPU ;      //  Number of processors to use in parallel calculation mode
   pRooRealMPFE*  _mpfeArray ; //! Array of parallel execution frond ends
 
+  // Multi-threaded mode data
+  Int_t          _nThreads ;  //  Number of threads to use in multi-threaded calculation mode
+  Int_t          _nWorkers ;  //! Number of entries in _workerArray
+  pRooAbsTestStatistic* _workerArray ; //! Clones of this test statistic calculating the other partitions in multi-threaded mode
+  ROOT::TThreadExecutor* _executor ; //! Thread pool for multi-threaded calculation mode
+  Bool_t         _ownExecutor ; //! True if _executor belongs to this instance, false if shared with the top-level test statistic
+  mutable Bool_t _threadsWarm ; //! True after the first, sequential, evaluation in multi-threaded mode
+
+  // Values of the last calculated parameter states
+  mutable Bool_t _cacheStates ;             //! Reuse the value of a recently calculated parameter state
+  mutable std::vector<Double_t> _states ;    //! Parameter values, value and carry of the cached states
+  mutable std::vector<Double_t> _curState ;  //! Parameter values of the current state
+  mutable Int_t _nStates ;                   //! Number of cached states
+  mutable Int_t _nextState ;                 //! Index of the next state to be replaced
+  mutable ULong64_t _stateConfig ;           //! RooAbsArg::configChangeCount() when the cached states were calculated
+
   RooFit::MPSplit        _mpinterl ; // Use interleaving strategy rather than N-wise split for partioning of dataset for multiprocessor-split
   Bool_t         _doOffset ; // Apply interval value offset to control numeric precision?
   mutable Double_t _offset ; //! Offset
   mutable Double_t _offsetCarry; //! avoids loss of precision
   mutable Double_t _evalCarry; //! carry of Kahan sum in evaluatePartition
 
-  ClassDef(RooAbsTestStatistic,2) // Abstract base class for real-valued test statistics
+  ClassDef(RooAbsTestStatistic,3) // Abstract base class for real-valued test statistics
 
 };
 
@@ -0,0 +1,270 @@
+/*****************************************************************************
+ * Project: RooFit                                                           *
+ * Package: RooFitCore                                                       *
+ *    File: $Id$
+ *                                                                           *
+ * Copyright (c) 2018, CERN                                                  *
+ *                                                                           *
+ * Redistribution and use in source and binary forms,                        *
+ * with or without modification, are permitted according to the terms        *
+ * listed in LICENSE (http://roofit.sourceforge.net/license.txt)             *
+ *****************************************************************************/
+#ifndef ROO_COMPACT_DATA_STORE
+#define ROO_COMPACT_DATA_STORE
+
+#include <list>
+#include <vector>
+#include "RooAbsDataStore.h"
+#include "RooCatType.h"
+
+class RooAbsArg ;
+class RooAbsReal ;
+class RooAbsCategory ;
+class RooArgList ;
+class RooFormulaVar ;
+class RooRealVar ;
+class RooVectorDataStore ;
+class TTree ;
+
+class RooCompactDataStore : public RooAbsDataStore {
+public:
+
+  // Encoding of the columns of real values
+  enum Encoding { Double, Float, Fixed16 } ;
+
+  static void setDefaultEncoding(Encoding encoding) ;
+  static Encoding defaultEncoding() ;
+
+  RooCompactDataStore() ;
+
+  // Empty ctor
+  RooCompactDataStore(const char* name, const char* title, const RooArgSet& vars, const char* wgtVarName=0) ;
+  virtual RooAbsDataStore* clone(const char* newname=0) const { return new RooCompactDataStore(*this,newname) ; }
+  virtual RooAbsDataStore* clone(const RooArgSet& vars, const char* newname=0) const { return new RooCompactDataStore(*this,vars,newname) ; }
+
+  RooCompactDataStore(const RooCompactDataStore& other, const char* newname=0) ;
+  RooCompactDataStore(const RooCompactDataStore& other, const RooArgSet& vars, const char* newname=0) ;
+
+  RooCompactDataStore(const char *name, const char *title, RooAbsDataStore& ads,
+		      const RooArgSet& vars, const RooFormulaVar* cutVar, const char* cutRange,
+		      Int_t nStart, Int_t nStop, Bool_t /*copyCache*/, const char* wgtVarName=0) ;
+
+  // Ctor reading the branches of a TTree
+  RooCompactDataStore(const char* name, const char* title, const RooArgSet& vars, TTree& t,
+		      const RooFormulaVar* select=0, const char* wgtVarName=0) ;
+
+  virtual ~RooCompactDataStore() ;
+
+  // Write current row
+  virtual Int_t fill() ;
+
+  // reserve storage for nEvt entries
+  void reserve(Int_t nEvt) ;
+
+  // Retrieve a row
+  using RooAbsDataStore::get ;
+  virtual const RooArgSet* get(Int_t index) const ;
+  const RooArgSet* getNative(Int_t index) const ;
+  virtual Double_t weight() const ;
+  virtual Double_t weightError(RooAbsData::ErrorType etype=RooAbsData::Poisson) const ;
+  virtual void weightError(Double_t& lo, Double_t& hi, RooAbsData::ErrorType etype=RooAbsData::Poisson) const ;
+  virtual Double_t weight(Int_t index) const ;
+  virtual Bool_t isWeighted() const { return _wgtVar!=0 ; }
+  const RooRealVar* weightVar() const { return _wgtVar ; }
+
+  // Change observable name
+  virtual Bool_t changeObservableName(const char* from, const char* to) ;
+
+  // Add one or more columns
+  virtual RooAbsArg* addColumn(RooAbsArg& var, Bool_t adjustRange=kTRUE) ;
+  virtual RooArgSet* addColumns(const RooArgList& varList) ;
+
+  // Merge column-wise
+  RooAbsDataStore* merge(const RooArgSet& allvars, std::list<RooAbsDataStore*> dstoreList) ;
+
+  // Add rows
+  virtual void append(RooAbsDataStore& other) ;
+
+  // Take over the values of a column without copying them
+  Bool_t adoptColumn(const RooAbsArg& var, std::vector<Float_t>&& values) ;
+  Bool_t adoptColumn(const RooAbsArg& var, std::vector<Double_t>&& values) ;
+  Bool_t setCategoryColumn(const RooAbsArg& var, const std::vector<Int_t>& indices) ;
+
+  // General & bookkeeping methods
+  virtual Bool_t valid() const ;
+  virtual Int_t numEntries() const { return _nEntries ; }
+  virtual Double_t sumEntries() const { return _sumWeight ; }
+  virtual void reset() ;
+
+  // Size of the stored values in bytes
+  std::size_t memorySize() const ;
+
+  // Buffer redirection routines used in inside RooAbsOptTestStatistics
+  virtual void attachBuffers(const RooArgSet& extObs) ;
+  virtual void resetBuffers() ;
+
+  // Constant term  optimizer interface
+  virtual const RooAbsArg* cacheOwner() { return _cacheOwner ; }
+  virtual void cacheArgs(const RooAbsArg* owner, RooArgSet& varSet, const RooArgSet* nset=0, Bool_t skipZeroWeights=kTRUE) ;
+  virtual void attachCache(const RooAbsArg* newOwner, const RooArgSet& cachedVars) ;
+  virtual void resetCache() ;
+  virtual void setArgStatus(const RooArgSet& set, Bool_t active) ;
+  virtual Bool_t hasFilledCache() const { return _cache ? kTRUE : kFALSE ; }
+
+  void loadValues(const RooAbsDataStore *tds, const RooFormulaVar* select=0, const char* rangeName=0, Int_t nStart=0, Int_t nStop=2000000000) ;
+  void loadValues(TTree& t, const RooFormulaVar* select=0) ;
+
+  virtual void dump() ;
+
+  virtual void setDirtyProp(Bool_t flag) ;
+
+  // Column of real values, optionally with (asymmetric) errors
+  class RealColumn {
+  public:
+    RealColumn() ;
+    RealColumn(RooAbsReal* real, Int_t encoding) ;
+    RealColumn(const RealColumn& other, RooAbsReal* real=0) ;
+    virtual ~RealColumn() {}
+
+    void setBuffer(Double_t* buf, Double_t* bufE, Double_t* bufEL, Double_t* bufEH) ;
+    void setNativeBuffer() ;
+    const RooAbsReal* bufArg() const { return _nativeReal ; }
+    Int_t encoding() const { return _encoding ; }
+
+    // Value of entry idx
+    inline Double_t value(Int_t idx) const {
+      switch (_encoding) {
+      case Float: return _fvec[idx] ;
+      case Fixed16: return _offset + _step*_svec[idx] ;
+      default: return _dvec[idx] ;
+      }
+    }
+
+    inline void get(Int_t idx) const { load(idx,_buf,_bufE,_bufEL,_bufEH) ; }
+    inline void getNative(Int_t idx) const { load(idx,_nativeBuf,_nativeBufE,_nativeBufEL,_nativeBufEH) ; }
+
+    void fill() ;
+    void write(Int_t i) ;
+    void reset() ;
+    void reserve(Int_t siz) ;
+    void resize(Int_t siz) ;
+    Int_t size() const ;
+    std::size_t memorySize() const ;
+
+  private:
+    friend class RooCompactDataStore ;
+
+    inline void load(Int_t idx, Double_t* buf, Double_t* bufE, Double_t* bufEL, Double_t* bufEH) const {
+      *buf = value(idx) ;
+      if (_storeError) *bufE = _vecE[idx] ;
+      if (_storeAsymError) {
+	*bufEL = _vecEL[idx] ;
+	*bufEH = _vecEH[idx] ;
+      }
+    }
+    Double_t encode(Double_t value) const ;
+    void enableErrors(Bool_t symError, Bool_t asymError) ;
+
+    RooAbsReal* _nativeReal ;
+    Int_t _encoding ;
+    Double_t _offset ;              // Fixed16: value = _offset + _step*code
+    Double_t _step ;
+    std::vector<Double_t> _dvec ;
+    std::vector<Float_t> _fvec ;
+    std::vector<UShort_t> _svec ;
+    Bool_t _storeError ;
+    Bool_t _storeAsymError ;
+    std::vector<Float_t> _vecE ;
+    std::vector<Float_t> _vecEL ;
+    std::vector<Float_t> _vecEH ;
+    Double_t* _buf ;         //!
+    Double_t* _bufE ;        //!
+    Double_t* _bufEL ;       //!
+    Double_t* _bufEH ;       //!
+    Double_t* _nativeBuf ;   //!
+    Double_t* _nativeBufE ;  //!
+    Double_t* _nativeBufEL ; //!
+    Double_t* _nativeBufEH ; //!
+    Double_t _noError[3] ;   //! Error buffers of objects without errors
+    ClassDef(RealColumn,1) // Column of real values of RooCompactDataStore
+  } ;
+
+  // Column of category states, stored as indices in the list of distinct states
+  class CatColumn {
+  public:
+    CatColumn() ;
+    CatColumn(RooAbsCategory* cat) ;
+    CatColumn(const CatColumn& other, RooAbsCategory* cat=0) ;
+    virtual ~CatColumn() {}
+
+    void setBuffer(RooCatType* buf) ;
+    void setNativeBuffer() { _nativeBuf = _buf ; }
+    const RooAbsCategory* bufArg() const { return _cat ; }
+
+    inline void get(Int_t idx) const { _buf->assignFast(_dict[_codes[idx]]) ; }
+    inline void getNative(Int_t idx) const { _nativeBuf->assignFast(_dict[_codes[idx]]) ; }
+
+    Bool_t fill() ;
+    Bool_t write(Int_t i) ;
+    void reset() ;
+    void reserve(Int_t siz) { _codes.reserve(siz) ; }
+    void resize(Int_t siz) { _codes.resize(siz) ; }
+    Int_t size() const { return _codes.size() ; }
+    std::size_t memorySize() const ;
+
+  private:
+    friend class RooCompactDataStore ;
+
+    Int_t code(const RooCatType& type) ;
+
+    RooAbsCategory* _cat ;
+    std::vector<RooCatType> _dict ;  // Distinct states
+    std::vector<UShort_t> _codes ;   // Position of the state of each entry in _dict
+    RooCatType* _buf ;       //!
+    RooCatType* _nativeBuf ; //!
+    Int_t _last ;            //! Position of the last state looked up
+    ClassDef(CatColumn,1) // Column of category states of RooCompactDataStore
+  } ;
+
+protected:
+
+  friend class RooAbsArg ;
+  void attachArg(RooAbsArg& arg) ;
+
+  RealColumn* findReal(const char* name) const ;
+  CatColumn* findCategory(const char* name) const ;
+  void addArg(RooAbsArg* arg) ;
+  void updateWeight() const ;
+  Int_t checkColumnSizes() ;
+
+private:
+
+  RooArgSet varsNoWeight(const RooArgSet& allVars, const char* wgtName) ;
+  RooRealVar* weightVar(const RooArgSet& allVars, const char* wgtName) ;
+
+  RooArgSet _varsww ;
+  RooRealVar* _wgtVar ;     // Pointer to weight variable (if set)
+
+  std::vector<RealColumn*> _realColumns ;
+  std::vector<CatColumn*> _catColumns ;
+  RealColumn* _wgtColumn ;  //! Column of the weight variable
+
+  Int_t _nEntries ;
+  Double_t _sumWeight ;
+  Double_t _sumWeightCarry ;
+
+  mutable Double_t  _curWgt ;      // Weight of current event
+  mutable Double_t  _curWgtErrLo ; // Weight of current event
+  mutable Double_t  _curWgtErrHi ; // Weight of current event
+  mutable Double_t  _curWgtErr ;   // Weight of current event
+
+  RooVectorDataStore* _cache ; //! Optimization cache of constant expressions
+  RooAbsArg* _cacheOwner ;     //! Cache owner
+
+  static Encoding _defaultEncoding ;
+
+  ClassDef(RooCompactDataStore,1) // Memory-compact column-wise data storage class
+};
+
+
+#endif
@@ -0,0 +1,80 @@
+/*****************************************************************************
+ * Project: RooFit                                                           *
+ * Package: RooFitCore                                                       *
+ *    File: $Id$
+ *                                                                           *
+ * Copyright (c) 2018, CERN                                                  *
+ *                                                                           *
+ * Redistribution and use in source and binary forms,                        *
+ * with or without modification, are permitted according to the terms        *
+ * listed in LICENSE (http://roofit.sourceforge.net/license.txt)             *
+ *****************************************************************************/
+#ifndef ROO_INTEGRAL_TABLE
+#define ROO_INTEGRAL_TABLE
+
+#include "TNamed.h"
+#include "TString.h"
+
+#include <functional>
+#include <map>
+#include <vector>
+
+class RooAbsCollection ;
+
+class RooIntegralTable : public TNamed {
+public:
+
+  // Function returning the exact value at the given parameter values
+  typedef std::function<Double_t(const Double_t*)> Function ;
+
+  RooIntegralTable() ;
+  RooIntegralTable(const char* name, const RooAbsCollection& params, Int_t nBins, Int_t maxDepth, Double_t precision) ;
+  RooIntegralTable(const RooIntegralTable& other) ;
+  virtual ~RooIntegralTable() {}
+
+  Bool_t isValid() const { return _valid ; }
+
+  // True if the table was made for these parameters (names and ranges) and settings
+  Bool_t matches(const RooAbsCollection& params, Int_t nBins, Int_t maxDepth, Double_t precision) const ;
+
+  // Tabulate the function on the base grid
+  void fill(const Function& func) ;
+
+  // Interpolated value at x, refining the table if needed
+  Double_t value(const Double_t* x, const Function& func) ;
+
+  Int_t numNodes() const { return _nodes.size() ; }
+  Int_t numCells() const { return _cells.size() ; }
+  Int_t numExact() const { return _nExact ; }
+
+  virtual void Print(Option_t* options=0) const ;
+
+protected:
+
+  enum CellStatus { Unknown=0, Accepted=1, Split=2, Exact=3 } ;
+
+  Long64_t nodeKey(const Long64_t* c) const ;
+  Long64_t cellKey(const Long64_t* c, Int_t depth) const { return nodeKey(c)*16 + depth ; }
+  Double_t node(const Long64_t* c, const Function& func) ;
+  Int_t testCell(const Long64_t* c, Long64_t size, Int_t depth, const Function& func) ;
+  Double_t interpolate(const Long64_t* c, Long64_t size, const Double_t* u, const Function& func) ;
+
+  std::vector<TString> _names ; // Names of the parameters
+  std::vector<Double_t> _lo ;   // Lower bounds of the parameters
+  std::vector<Double_t> _hi ;   // Upper bounds of the parameters
+  Int_t _nBins ;                // Number of bins of the base grid per parameter
+  Int_t _maxDepth ;             // Maximum number of refinements of a base cell
+  Double_t _precision ;         // Relative precision required from the interpolation
+  Long64_t _nLattice ;          // Number of intervals per parameter of the finest lattice
+  Bool_t _valid ;               // Table could be set up
+
+  std::map<Long64_t,Double_t> _nodes ; // Exact values at the nodes of the lattice
+  std::map<Long64_t,Char_t> _cells ;   // Status of the cells
+
+  std::vector<Double_t> _x ;    //! Work space
+  Int_t _nExact ;               //! Number of exact evaluations outside the table
+
+  ClassDef(RooIntegralTable,1) // Adaptive table of the values of an integral in parameter space
+};
+
+#endif
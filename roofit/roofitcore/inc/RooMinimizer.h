@@ -96,6 +96,8 @@ protected:
   void profileStart() ;
   void profileStop() ;
 
+  void setFloatParamsDirty() ;
+
   inline Int_t getNPar() const { return fitterFcn()->NDim() ; }
   inline std::ofstream* logfile() { return fitterFcn()->GetLogFile(); }
   inline Double_t& maxFCN() { return fitterFcn()->GetMaxFCN() ; }
@@ -54,7 +54,9 @@ public:
   virtual ~RooProdPdf() ;
 
   virtual Double_t getValV(const RooArgSet* set=0) const ;
+  virtual RooSpan<const double> getValBatch(std::size_t begin, std::size_t batchSize, const RooArgSet* normSet=0) const ;
   Double_t evaluate() const ;
+  RooSpan<double> evaluateBatch(std::size_t begin, std::size_t batchSize) const ;
   virtual Bool_t checkObservables(const RooArgSet* nset) const ;	
 
   virtual Bool_t forceAnalyticalInt(const RooAbsArg& dep) const ; 
@@ -70,6 +70,25 @@ public:
 
   static Int_t getCacheAllNumeric() ;
 
+  void setTabulateNumeric(Bool_t flag) {
+    // If true, numeric integrals are tabulated in the parameters of the integrand,
+    // if these all have a finite range. Tables are not used during HESSE.
+    _tabulateNum = flag ;
+  }
+
+  Bool_t getTabulateNumeric() {
+    // If true, numeric integrals are tabulated in the parameters of the integrand
+    return _tabulateNum ;
+  }
+
+  static void setTabulateAllNumeric(Bool_t flag) ;
+
+  static Bool_t getTabulateAllNumeric() ;
+
+  static void setTabulationConfig(Int_t nBins=4, Int_t maxDepth=5, Double_t precision=1e-5, Int_t maxDim=3) ;
+
+  static Bool_t suspendTabulation(Bool_t flag) ;
+
   virtual std::list<Double_t>* plotSamplingHint(RooAbsRealLValue& obs, Double_t xlo, Double_t xhi) const {
     // Forward plot sampling hint of integrand
     return _function.arg().plotSamplingHint(obs,xlo,xhi) ;
@@ -96,6 +115,8 @@ protected:
   virtual Double_t sum() const ;
   virtual Double_t integrate() const ;
   virtual Double_t jacobianProduct() const ;
+  Bool_t tabulatedValue(Double_t& value) const ;
+  Double_t numericValue() const ;
 
   // Evaluation and validation implementation
   Double_t evaluate() const ;
@@ -141,10 +162,21 @@ protected:
   Bool_t _cacheNum ;           // Cache integral if numeric
   static Int_t _cacheAllNDim ; //! Cache all integrals with given numeric dimension
 
+  Bool_t _tabulateNum ;        // Tabulate integral in the parameters if numeric
+  mutable RooArgSet* _tabLeaves ; //! Leaf parameters of the integral
+  mutable RooArgSet* _tabNodes ; //! Private copy of the integral used to fill the tables
+  Bool_t _tabFill ;            //! This is the private copy, do not tabulate
+  static Bool_t _tabulateAll ; //! Tabulate all numeric integrals
+  static Int_t _tabNBins ;     //! Number of bins per parameter of the tables
+  static Int_t _tabMaxDepth ;  //! Maximum number of refinements of the tables
+  static Double_t _tabPrecision ; //! Relative precision of the tables
+  static Int_t _tabMaxDim ;    //! Maximum number of parameters of the tables
+  static Bool_t _tabSuspended ; //! Tabulation temporarily switched off
+
 
   virtual void operModeHook() ; // cache operation mode
 
-  ClassDef(RooRealIntegral,3) // Real-valued function representing an integral over a RooAbsReal object
+  ClassDef(RooRealIntegral,4) // Real-valued function representing an integral over a RooAbsReal object
 };
 
 #endif
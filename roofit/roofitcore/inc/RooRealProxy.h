@@ -42,6 +42,11 @@ public:
 
   inline const RooAbsReal& arg() const { return (RooAbsReal&)*_arg ; }
 
+  // Values for a batch of entries (see RooAbsReal::getValBatch())
+  inline RooSpan<const double> getValBatch(std::size_t begin, std::size_t batchSize) const {
+    return ((RooAbsReal*)_arg)->getValBatch(begin,batchSize,_nset) ;
+  }
+
   // Modifier
   virtual Bool_t setArg(RooAbsReal& newRef) ;
 
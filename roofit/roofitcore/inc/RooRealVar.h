@@ -128,6 +128,7 @@ public:
   virtual void setVal(Double_t value, const char* rangeName) ;
 
   friend class RooAbsRealLValue ;
+  friend class RooCompactDataStore ;
   virtual void setValFast(Double_t value) { _value = value ; setValueDirty() ; }
 
 
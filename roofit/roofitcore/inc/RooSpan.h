@@ -0,0 +1,53 @@
+/*****************************************************************************
+ * Project: RooFit                                                           *
+ * Package: RooFitCore                                                       *
+ *    File: $Id$
+ *                                                                           *
+ * Copyright (c) 2018, CERN                                                  *
+ *                                                                           *
+ * Redistribution and use in source and binary forms,                        *
+ * with or without modification, are permitted according to the terms        *
+ * listed in LICENSE (http://roofit.sourceforge.net/license.txt)             *
+ *****************************************************************************/
+#ifndef ROO_SPAN
+#define ROO_SPAN
+
+#include <cstddef>
+#include <type_traits>
+#include <vector>
+
+////////////////////////////////////////////////////////////////////////////////
+/// A simple, non-owning view of a contiguous range of values, used to pass
+/// batches of values between RooFit objects (see RooAbsReal::getValBatch()).
+/// A span can be empty (no values), hold a single value that applies to all
+/// entries of a batch, or hold one value per entry.
+
+template<class T>
+class RooSpan {
+public:
+  typedef typename std::remove_cv<T>::type value_type ;
+
+  RooSpan() : _begin(0), _size(0) {}
+  RooSpan(T* begin, std::size_t size) : _begin(begin), _size(size) {}
+
+  /// Construct from a vector. The vector must not be resized while the span is used.
+  RooSpan(std::vector<value_type>& vec) : _begin(vec.data()), _size(vec.size()) {}
+
+  /// Conversion of a span of non-const values into a span of const values.
+  template<class U, class = typename std::enable_if<std::is_convertible<U*, T*>::value>::type>
+  RooSpan(const RooSpan<U>& other) : _begin(other.data()), _size(other.size()) {}
+
+  T* begin() const { return _begin ; }
+  T* end() const { return _begin + _size ; }
+  T* data() const { return _begin ; }
+  std::size_t size() const { return _size ; }
+  bool empty() const { return _size==0 ; }
+
+  T& operator[](std::size_t i) const { return _begin[i] ; }
+
+private:
+  T* _begin ;        // First value of the range
+  std::size_t _size ; // Number of values in the range
+} ;
+
+#endif
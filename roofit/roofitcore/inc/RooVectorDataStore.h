@@ -110,6 +110,10 @@ public:
 
   const RooVectorDataStore* cache() const { return _cache ; }
 
+  // Batch evaluation interface
+  Bool_t attachBatchInputs(Bool_t attach=kTRUE) ;
+  RooSpan<const double> getWeightBatch(std::size_t first, std::size_t batchSize) const ;
+
   void loadValues(const RooAbsDataStore *tds, const RooFormulaVar* select=0, const char* rangeName=0, Int_t nStart=0, Int_t nStop=2000000000) ;
   
   void dump() ;
@@ -64,11 +64,13 @@ setting/clearing/testing named attributes.
 #include "RooAbsDataStore.h"
 #include "RooResolutionModel.h"
 #include "RooVectorDataStore.h"
+#include "RooCompactDataStore.h"
 #include "RooTreeDataStore.h"
 
 #include <sstream>
 #include <string.h>
 #include <algorithm>
+#include <atomic>
 
 using namespace std ;
 
@@ -86,6 +88,12 @@ Bool_t RooAbsArg::inhibitDirty() const { return _inhibitDirty && !_localNoInhibi
 std::map<RooAbsArg*,TRefArray*> RooAbsArg::_ioEvoList ;
 std::stack<RooAbsArg*> RooAbsArg::_ioReadStack ;
 
+namespace {
+  // Number of changes of values that do not come from the value of a fundamental object,
+  // see RooAbsArg::registerConfigChange()
+  std::atomic<ULong64_t> gConfigChangeCount(0) ;
+}
+
 
 ////////////////////////////////////////////////////////////////////////////////
 /// Default constructor
@@ -217,6 +225,30 @@ void RooAbsArg::setDirtyInhibit(Bool_t flag)
 }
 
 
+////////////////////////////////////////////////////////////////////////////////
+/// Register a change of configuration, i.e. a change of the value of objects
+/// that does not come from the value of the fundamental objects (parameters and
+/// observables) they depend on. This is done automatically when a non-fundamental
+/// object raises its own value dirty flag (e.g. after a change of interpolation
+/// code) or when any object raises its own shape dirty flag (e.g. after a change
+/// of range). Caches indexed by the values of the parameters must be invalidated
+/// when configChangeCount() changes.
+
+void RooAbsArg::registerConfigChange()
+{
+  ++gConfigChangeCount ;
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+/// Return the number of changes of configuration registered so far, see registerConfigChange()
+
+ULong64_t RooAbsArg::configChangeCount()
+{
+  return gConfigChangeCount ;
+}
+
+
 ////////////////////////////////////////////////////////////////////////////////
 /// Activate verbose messaging related to dirty flag propagation
 
@@ -835,6 +867,10 @@ void RooAbsArg::setValueDirty(const RooAbsArg* source) const
 {
   if (_operMode!=Auto || _inhibitDirty) return ;
 
+  if (source==0 && !isFundamental()) {
+    registerConfigChange() ;
+  }
+
   // Handle no-propagation scenarios first
   if (_clientListValue.GetSize()==0) {
     _valueDirty = kTRUE ;
@@ -882,6 +918,10 @@ void RooAbsArg::setShapeDirty(const RooAbsArg* source) const
 			   << "): dirty flag " << (_shapeDirty?"already ":"") << "raised" << endl ;
   }
 
+  if (source==0) {
+    registerConfigChange() ;
+  }
+
   if (_clientListShape.GetSize()==0) {
     _shapeDirty = kTRUE ;
     return ;
@@ -2324,6 +2364,8 @@ void RooAbsArg::attachToStore(RooAbsDataStore& store)
     attachToTree(((RooTreeDataStore&)store).tree()) ;
   } else if (dynamic_cast<RooVectorDataStore*>(&store)) {
     attachToVStore((RooVectorDataStore&)store) ;
+  } else if (dynamic_cast<RooCompactDataStore*>(&store)) {
+    ((RooCompactDataStore&)store).attachArg(*this) ;
   }
 }
 
@@ -45,6 +45,7 @@ points for its contents and provides an iterator over its elements
 #include "RooAbsDataStore.h"
 #include "RooVectorDataStore.h"
 #include "RooTreeDataStore.h"
+#include "RooCompactDataStore.h"
 #include "RooDataHist.h"
 #include "RooCompositeDataStore.h"
 #include "RooCategory.h"
@@ -136,6 +137,8 @@ RooAbsData::RooAbsData(const char *name, const char *title, const RooArgSet& var
       storageType = RooAbsData::Tree;
    } else if (dynamic_cast<RooVectorDataStore *>(dstore)) {
       storageType = RooAbsData::Vector;
+   } else if (dynamic_cast<RooCompactDataStore *>(dstore)) {
+      storageType = RooAbsData::Compact;
    } else {
       storageType = RooAbsData::Composite;
    }
@@ -248,7 +251,7 @@ RooAbsData::~RooAbsData()
 }
 
 ////////////////////////////////////////////////////////////////////////////////
-/// Convert tree-based storage to vector-based storage
+/// Convert tree-based or compact storage to vector-based storage
 
 void RooAbsData::convertToVectorStore()
 {
@@ -257,6 +260,13 @@ void RooAbsData::convertToVectorStore()
       delete _dstore;
       _dstore = newStore;
       storageType = RooAbsData::Vector;
+   } else if (storageType == RooAbsData::Compact) {
+      const RooRealVar *wgtVar = ((RooCompactDataStore *)_dstore)->weightVar();
+      RooVectorDataStore *newStore = new RooVectorDataStore(GetName(), GetTitle(), *_dstore, _vars, 0, 0, 0, 2000000000,
+                                                            kFALSE, wgtVar ? wgtVar->GetName() : 0);
+      delete _dstore;
+      _dstore = newStore;
+      storageType = RooAbsData::Vector;
    }
 }
 
@@ -312,6 +312,105 @@ Double_t RooAbsPdf::getValV(const RooArgSet* nset) const
 
 
 
+////////////////////////////////////////////////////////////////////////////////
+/// Return the normalized values of the p.d.f for a batch of entries, see
+/// RooAbsReal::getValBatch(). As in getValV(), the values of the p.d.f that are
+/// negative or not-a-number are set to zero and the normalization integral is
+/// computed once for the whole batch.
+
+RooSpan<const double> RooAbsPdf::getValBatch(std::size_t begin, std::size_t batchSize, const RooArgSet* normSet) const
+{
+  // Values read from the data (e.g. cached by the constant term optimizer)
+  if (_batchInput) {
+    return RooAbsReal::getValBatch(begin,batchSize,normSet) ;
+  }
+
+  // The values of each normalization set are stored separately
+  _batchNormSet = normSet ;
+
+  // Special handling of case without normalization set (used in numeric integration of pdfs)
+  if (!normSet) {
+    RooArgSet* tmp = _normSet ;
+    _normSet = 0 ;
+    RooSpan<double> values = evaluateBatch(begin,batchSize) ;
+    _normSet = tmp ;
+
+    if (values.empty()) {
+      return evaluateBatchScalar(begin,batchSize,0) ;
+    }
+    for (std::size_t i=0 ; i<values.size() ; i++) {
+      if (!(values[i]>=0)) {
+	traceEvalPdf(values[i]) ;
+	values[i] = 0 ;
+      }
+    }
+    return values ;
+  }
+
+  // Process change in last data set used
+  if (normSet!=_normSet || _norm==0) {
+    syncNormalization(normSet) ;
+  }
+
+  // Evaluate numerator
+  RooSpan<double> values = evaluateBatch(begin,batchSize) ;
+  if (values.empty()) {
+    return evaluateBatchScalar(begin,batchSize,normSet) ;
+  }
+
+  // Error checking and printing
+  Bool_t error(kFALSE) ;
+  for (std::size_t i=0 ; i<values.size() ; i++) {
+    error |= !(values[i]>=0) ;
+  }
+  if (error) {
+    for (std::size_t i=0 ; i<values.size() ; i++) {
+      if (!(values[i]>=0)) {
+	traceEvalPdf(values[i]) ;
+	values[i] = 0 ;
+      }
+    }
+  }
+
+  // Evaluate denominator, which depends on the data only for conditional observables
+  RooSpan<const double> normVal = _norm->getValBatch(begin,batchSize) ;
+
+  if (normVal.size()==1) {
+    if (normVal[0]<=0.) {
+      logEvalError("p.d.f normalization integral is zero or negative") ;
+      for (std::size_t i=0 ; i<values.size() ; i++) {
+	values[i] = 0 ;
+      }
+      return values ;
+    }
+    for (std::size_t i=0 ; i<values.size() ; i++) {
+      values[i] /= normVal[0] ;
+    }
+    return values ;
+  }
+
+  // Per-entry normalization: the result has one value per entry
+  if (values.size()<normVal.size()) {
+    const double value = values[0] ;
+    values = makeBatch(normVal.size()) ;
+    for (std::size_t i=0 ; i<values.size() ; i++) {
+      values[i] = value ;
+    }
+  }
+  for (std::size_t i=0 ; i<values.size() ; i++) {
+    if (normVal[i]<=0.) {
+      logEvalError("p.d.f normalization integral is zero or negative") ;
+      values[i] = 0 ;
+    } else {
+      values[i] /= normVal[i] ;
+    }
+  }
+
+  return values ;
+}
+
+
+
 ////////////////////////////////////////////////////////////////////////////////
 /// Analytical integral with normalization (see RooAbsReal::analyticalIntegralWN() for further information)
 ///
@@ -738,6 +837,8 @@ Double_t RooAbsPdf::extendedTerm(Double_t observed, const RooArgSet* nset) const
 ///   <tr><td> 3 = RooFit::Hybrid <td> Follow strategy 0 for all RooSimultaneous components, except those with less than
 ///                     30 dataset entries, for which strategy 2 is followed.
 ///   </table>
+/// <tr><td> `NumThreads(int num)`             <td> Calculate the NLL in num threads of this process instead of forked processes (see RooAbsTestStatistic::setNumThreads()).
+///                                              Cannot be combined with NumCPU
 /// <tr><td> `Optimize(Bool_t flag)`           <td> Activate constant term optimization (on by default)
 /// <tr><td> `SplitRange(Bool_t flag)`         <td> Use separate fit ranges in a simultaneous fit. Actual range name for each subsample is assumed to
 ///                                               by rangeName_{indexState} where indexState is the state of the master index category of the simultaneous fit
@@ -752,6 +853,8 @@ Double_t RooAbsPdf::extendedTerm(Double_t observed, const RooArgSet* nset) const
 /// <tr><td> `CloneData(Bool flag)`           <td> Use clone of dataset in NLL (default is true)
 /// <tr><td> `Offset(Bool_t)`                 <td> Offset likelihood by initial value (so that starting value of FCN in minuit is zero).
 ///                                              This can improve numeric stability in simultaneously fits with components with large likelihood values
+/// <tr><td> `BatchMode(Bool_t)`              <td> Evaluate the p.d.f for batches of events of unbinned datasets (see RooAbsReal::getValBatch()).
+///                                              This is faster for p.d.fs that implement batch evaluations, e.g. RooGaussian, RooAddPdf, RooProdPdf
 /// </table>
 /// 
 /// 
@@ -793,6 +896,7 @@ RooAbsReal* RooAbsPdf::createNLL(RooAbsData& data, const RooLinkedList& cmdList)
   pc.defineInt("ext","Extended",0,2) ;
   pc.defineInt("numcpu","NumCPU",0,1) ;
   pc.defineInt("interleave","NumCPU",1,0) ;
+  pc.defineInt("numthreads","NumThreads",0,1) ;
   pc.defineInt("verbose","Verbose",0,0) ;
   pc.defineInt("optConst","Optimize",0,0) ;
   pc.defineInt("cloneData","CloneData",2,0) ;
@@ -801,10 +905,12 @@ RooAbsReal* RooAbsPdf::createNLL(RooAbsData& data, const RooLinkedList& cmdList)
   pc.defineSet("glObs","GlobalObservables",0,0) ;
   pc.defineInt("constrAll","Constrained",0,0) ;
   pc.defineInt("doOffset","OffsetLikelihood",0,0) ;
+  pc.defineInt("batchMode","BatchMode",0,0) ;
   pc.defineSet("extCons","ExternalConstraints",0,0) ;
   pc.defineMutex("Range","RangeWithName") ;
   pc.defineMutex("Constrain","Constrained") ;
   pc.defineMutex("GlobalObservables","GlobalObservablesTag") ;
+  pc.defineMutex("NumCPU","NumThreads") ;
     
   // Process and check varargs 
   pc.process(cmdList) ;
@@ -819,12 +925,14 @@ RooAbsReal* RooAbsPdf::createNLL(RooAbsData& data, const RooLinkedList& cmdList)
   Int_t ext      = pc.getInt("ext") ;
   Int_t numcpu   = pc.getInt("numcpu") ;
   RooFit::MPSplit interl = (RooFit::MPSplit) pc.getInt("interleave") ;
+  Int_t numthreads = pc.getInt("numthreads") ;
 
   Int_t splitr   = pc.getInt("splitRange") ;
   Bool_t verbose = pc.getInt("verbose") ;
   Int_t optConst = pc.getInt("optConst") ;
   Int_t cloneData = pc.getInt("cloneData") ;
   Int_t doOffset = pc.getInt("doOffset") ;
+  Bool_t batchMode = pc.getInt("batchMode") ;
   
   // If no explicit cloneData command is specified, cloneData is set to true if optimization is activated
   if (cloneData==2) {
@@ -903,7 +1011,10 @@ RooAbsReal* RooAbsPdf::createNLL(RooAbsData& data, const RooLinkedList& cmdList)
     // Simple case: default range, or single restricted range
     //cout<<"FK: Data test 1: "<<data.sumEntries()<<endl;
 
-    nll = new RooNLLVar(baseName.c_str(),"-log(likelihood)",*this,data,projDeps,ext,rangeName,addCoefRangeName,numcpu,interl,verbose,splitr,cloneData) ;
+    RooNLLVar* nllVar = new RooNLLVar(baseName.c_str(),"-log(likelihood)",*this,data,projDeps,ext,rangeName,addCoefRangeName,numcpu,interl,verbose,splitr,cloneData) ;
+    nllVar->batchMode(batchMode) ;
+    nllVar->setNumThreads(numthreads) ;
+    nll = nllVar ;
 
   } else {
     // Composite case: multiple ranges
@@ -913,7 +1024,9 @@ RooAbsReal* RooAbsPdf::createNLL(RooAbsData& data, const RooLinkedList& cmdList)
     strlcpy(buf,rangeName,bufSize) ;
     char* token = strtok(buf,",") ;
     while(token) {
-      RooAbsReal* nllComp = new RooNLLVar(Form("%s_%s",baseName.c_str(),token),"-log(likelihood)",*this,data,projDeps,ext,token,addCoefRangeName,numcpu,interl,verbose,splitr,cloneData) ;
+      RooNLLVar* nllComp = new RooNLLVar(Form("%s_%s",baseName.c_str(),token),"-log(likelihood)",*this,data,projDeps,ext,token,addCoefRangeName,numcpu,interl,verbose,splitr,cloneData) ;
+      nllComp->batchMode(batchMode) ;
+      nllComp->setNumThreads(numthreads) ;
       nllList.add(*nllComp) ;
       token = strtok(0,",") ;
     }
@@ -1027,6 +1140,8 @@ RooAbsReal* RooAbsPdf::createNLL(RooAbsData& data, const RooLinkedList& cmdList)
 ///   <tr><td> 3 = RooFit::Hybrid <td> Follow strategy 0 for all RooSimultaneous components, except those with less than
 ///                     30 dataset entries, for which strategy 2 is followed.
 ///   </table>
+/// <tr><td> `NumThreads(int num)`             <td> Calculate the NLL in num threads of this process instead of forked processes (see RooAbsTestStatistic::setNumThreads()).
+///                                              Cannot be combined with NumCPU
 /// <tr><td> `SplitRange(Bool_t flag)`          <td>  Use separate fit ranges in a simultaneous fit. Actual range name for each subsample is assumed
 ///                                                 to by rangeName_{indexState} where indexState is the state of the master index category of the simultaneous fit
 /// <tr><td> `Constrained()`                    <td>  Apply all constrained contained in the p.d.f. in the likelihood 
@@ -1036,6 +1151,7 @@ RooAbsReal* RooAbsPdf::createNLL(RooAbsData& data, const RooLinkedList& cmdList)
 /// <tr><td> `ExternalConstraints(const RooArgSet& )`   <td>  Include given external constraints to likelihood
 /// <tr><td> `Offset(Bool_t)`                           <td>  Offset likelihood by initial value (so that starting value of FCN in minuit is zero).
 ///                                                         This can improve numeric stability in simultaneously fits with components with large likelihood values
+/// <tr><td> `BatchMode(Bool_t)`                        <td>  Evaluate the p.d.f for batches of events of unbinned datasets (see RooAbsReal::getValBatch())
 ///
 /// <tr><th><th> Options to control flow of fit procedure
 /// <tr><td> `Minimizer(type,algo)`   <td>  Choose minimization package and algorithm to use. Default is MINUIT/MIGRAD through the RooMinimizer interface,
@@ -1107,7 +1223,7 @@ RooFitResult* RooAbsPdf::fitTo(RooAbsData& data, const RooLinkedList& cmdList)
   RooCmdConfig pc(Form("RooAbsPdf::fitTo(%s)",GetName())) ;
 
   RooLinkedList fitCmdList(cmdList) ;
-  RooLinkedList nllCmdList = pc.filterCmdList(fitCmdList,"ProjectedObservables,Extended,Range,RangeWithName,SumCoefRange,NumCPU,SplitRange,Constrained,Constrain,ExternalConstraints,CloneData,GlobalObservables,GlobalObservablesTag,OffsetLikelihood") ;
+  RooLinkedList nllCmdList = pc.filterCmdList(fitCmdList,"ProjectedObservables,Extended,Range,RangeWithName,SumCoefRange,NumCPU,NumThreads,SplitRange,Constrained,Constrain,ExternalConstraints,CloneData,GlobalObservables,GlobalObservablesTag,OffsetLikelihood,BatchMode") ;
 
   pc.defineString("fitOpt","FitOptions",0,"") ;
   pc.defineInt("optConst","Optimize",0,2) ;
@@ -1479,7 +1595,7 @@ RooFitResult* RooAbsPdf::chi2FitTo(RooDataHist& data, const RooLinkedList& cmdLi
 
   // Pull arguments to be passed to chi2 construction from list
   RooLinkedList fitCmdList(cmdList) ;
-  RooLinkedList chi2CmdList = pc.filterCmdList(fitCmdList,"Range,RangeWithName,NumCPU,Optimize,ProjectedObservables,AddCoefRange,SplitRange,DataError,Extended") ;
+  RooLinkedList chi2CmdList = pc.filterCmdList(fitCmdList,"Range,RangeWithName,NumCPU,NumThreads,Optimize,ProjectedObservables,AddCoefRange,SplitRange,DataError,Extended") ;
 
   RooAbsReal* chi2 = createChi2(data,chi2CmdList) ;
   RooFitResult* ret = chi2FitDriver(*chi2,fitCmdList) ;
@@ -104,6 +104,7 @@
 #include "TVector.h"
 
 #include <sstream>
+#include <mutex>
 
 using namespace std ;
 
@@ -121,12 +122,19 @@ RooAbsReal::ErrorLoggingMode RooAbsReal::_evalErrorMode = RooAbsReal::PrintError
 Int_t RooAbsReal::_evalErrorCount = 0 ;
 map<const RooAbsArg*,pair<string,list<RooAbsReal::EvalError> > > RooAbsReal::_evalErrorList ;
 
+namespace {
+  std::recursive_mutex& evalErrorMutex() {
+    static std::recursive_mutex mutex ;
+    return mutex ;
+  }
+}
+
 
 ////////////////////////////////////////////////////////////////////////////////
 /// coverity[UNINIT_CTOR]
 /// Default constructor
 
-RooAbsReal::RooAbsReal() : _specIntegratorConfig(0), _treeVar(kFALSE), _selectComp(kTRUE), _lastNSet(0)
+RooAbsReal::RooAbsReal() : _specIntegratorConfig(0), _treeVar(kFALSE), _selectComp(kTRUE), _lastNSet(0), _batchNormSet(0), _batchInput(0)
 {
 }
 
@@ -137,7 +145,7 @@ RooAbsReal::RooAbsReal() : _specIntegratorConfig(0), _treeVar(kFALSE), _selectCo
 
 RooAbsReal::RooAbsReal(const char *name, const char *title, const char *unit) :
   RooAbsArg(name,title), _plotMin(0), _plotMax(0), _plotBins(100),
-  _value(0),  _unit(unit), _forceNumInt(kFALSE), _specIntegratorConfig(0), _treeVar(kFALSE), _selectComp(kTRUE), _lastNSet(0)
+  _value(0),  _unit(unit), _forceNumInt(kFALSE), _specIntegratorConfig(0), _treeVar(kFALSE), _selectComp(kTRUE), _lastNSet(0), _batchNormSet(0), _batchInput(0)
 {
   setValueDirty() ;
   setShapeDirty() ;
@@ -152,7 +160,7 @@ RooAbsReal::RooAbsReal(const char *name, const char *title, const char *unit) :
 RooAbsReal::RooAbsReal(const char *name, const char *title, Double_t inMinVal,
 		       Double_t inMaxVal, const char *unit) :
   RooAbsArg(name,title), _plotMin(inMinVal), _plotMax(inMaxVal), _plotBins(100),
-  _value(0), _unit(unit), _forceNumInt(kFALSE), _specIntegratorConfig(0), _treeVar(kFALSE), _selectComp(kTRUE), _lastNSet(0)
+  _value(0), _unit(unit), _forceNumInt(kFALSE), _specIntegratorConfig(0), _treeVar(kFALSE), _selectComp(kTRUE), _lastNSet(0), _batchNormSet(0), _batchInput(0)
 {
   setValueDirty() ;
   setShapeDirty() ;
@@ -168,7 +176,7 @@ RooAbsReal::RooAbsReal(const char *name, const char *title, Double_t inMinVal,
 RooAbsReal::RooAbsReal(const RooAbsReal& other, const char* name) :
   RooAbsArg(other,name), _plotMin(other._plotMin), _plotMax(other._plotMax),
   _plotBins(other._plotBins), _value(other._value), _unit(other._unit), _label(other._label),
-  _forceNumInt(other._forceNumInt), _treeVar(other._treeVar), _selectComp(other._selectComp), _lastNSet(0)
+  _forceNumInt(other._forceNumInt), _treeVar(other._treeVar), _selectComp(other._selectComp), _lastNSet(0), _batchNormSet(0), _batchInput(0)
 {
   if (other._specIntegratorConfig) {
     _specIntegratorConfig = new RooNumIntConfig(*other._specIntegratorConfig) ;
@@ -265,6 +273,133 @@ Double_t RooAbsReal::getValV(const RooArgSet* nset) const
 }
 
 
+////////////////////////////////////////////////////////////////////////////////
+/// Return the values of this object for the entries [begin, begin+batchSize)
+/// of the dataset whose observables are attached as batch inputs (see
+/// RooVectorDataStore::attachBatchInputs()).
+///
+/// The returned span holds either batchSize values, or a single value if this
+/// object does not depend on any of the observables of the dataset. It remains
+/// valid until the next batch evaluation of this object with the same
+/// normalisation set.
+///
+/// Objects implementing evaluateBatch() compute all values in one go, reading
+/// the values of their servers with getValBatch(). For the other objects, the
+/// values are computed one by one with getVal() after loading the values of the
+/// observables for each entry.
+
+RooSpan<const double> RooAbsReal::getValBatch(std::size_t begin, std::size_t batchSize, const RooArgSet* normSet) const
+{
+  // Observables read directly from the data
+  if (_batchInput) {
+    return RooSpan<const double>(_batchInput + begin, batchSize) ;
+  }
+
+  _batchNormSet = normSet ;
+
+  // Parameters are constant in a batch
+  if (!isDerived()) {
+    RooSpan<double> value = makeBatch(1) ;
+    value[0] = getVal(normSet) ;
+    return value ;
+  }
+
+  if (normSet && normSet!=_lastNSet) {
+    ((RooAbsReal*) this)->setProxyNormSet(normSet) ;
+    _lastNSet = (RooArgSet*) normSet ;
+  }
+
+  RooSpan<const double> values = evaluateBatch(begin, batchSize) ;
+  if (values.empty()) {
+    return evaluateBatchScalar(begin, batchSize, normSet) ;
+  }
+
+  return values ;
+}
+
+
+
+////////////////////////////////////////////////////////////////////////////////
+/// Compute the values of this object for the entries [begin, begin+batchSize)
+/// of the dataset attached as batch input. Implementations obtain the values of
+/// their servers with getValBatch(), store the results in the span returned by
+/// makeBatch() and return it, or an output of size 1 if none of the inputs
+/// depends on the observables. The default implementation returns an empty
+/// span, meaning that batch evaluation is not supported by this class.
+
+RooSpan<double> RooAbsReal::evaluateBatch(std::size_t /*begin*/, std::size_t /*batchSize*/) const
+{
+  return RooSpan<double>() ;
+}
+
+
+
+////////////////////////////////////////////////////////////////////////////////
+/// Return a span of size batchSize to store the output of evaluateBatch(). The
+/// values of each normalisation set are stored separately.
+
+RooSpan<double> RooAbsReal::makeBatch(std::size_t batchSize) const
+{
+  std::vector<double>& values = _batchValues[_batchNormSet] ;
+  values.resize(batchSize) ;
+  return values ;
+}
+
+
+
+////////////////////////////////////////////////////////////////////////////////
+/// Compute the values of this object for a batch of entries using the scalar
+/// interface: the observables attached as batch input are loaded entry by entry
+/// and getVal() is called for each of them. The values of the observables are
+/// restored afterwards.
+
+RooSpan<const double> RooAbsReal::evaluateBatchScalar(std::size_t begin, std::size_t batchSize, const RooArgSet* normSet) const
+{
+  _batchNormSet = normSet ;
+
+  // Find the value servers reading their values from the data
+  RooArgSet nodes ;
+  treeNodeServerList(&nodes,0,kTRUE,kTRUE,kTRUE) ;
+  std::vector<RooAbsReal*> inputs ;
+  RooFIter iter = nodes.fwdIterator() ;
+  RooAbsArg* node ;
+  while ((node=iter.next())) {
+    RooAbsReal* real = dynamic_cast<RooAbsReal*>(node) ;
+    if (real && real->_batchInput) {
+      inputs.push_back(real) ;
+    }
+  }
+
+  if (inputs.empty()) {
+    RooSpan<double> value = makeBatch(1) ;
+    value[0] = getVal(normSet) ;
+    return value ;
+  }
+
+  std::vector<double> saved ;
+  for (std::vector<RooAbsReal*>::iterator input = inputs.begin() ; input!=inputs.end() ; ++input) {
+    saved.push_back((*input)->_value) ;
+  }
+
+  RooSpan<double> values = makeBatch(batchSize) ;
+  for (std::size_t i=0 ; i<batchSize ; i++) {
+    for (std::vector<RooAbsReal*>::iterator input = inputs.begin() ; input!=inputs.end() ; ++input) {
+      (*input)->_value = (*input)->_batchInput[begin+i] ;
+      (*input)->setValueDirty() ;
+    }
+    values[i] = getVal(normSet) ;
+  }
+
+  for (std::size_t j=0 ; j<inputs.size() ; j++) {
+    inputs[j]->_value = saved[j] ;
+    inputs[j]->setValueDirty() ;
+  }
+
+  return values ;
+}
+
+
+
 ////////////////////////////////////////////////////////////////////////////////
 
 Int_t RooAbsReal::numEvalErrorItems()
@@ -3596,6 +3731,9 @@ void RooAbsReal::logEvalError(const RooAbsReal* originator, const char* origName
     return ;
   }
 
+  // Errors may be logged concurrently by the threads calculating a test statistic
+  std::lock_guard<std::recursive_mutex> lock(evalErrorMutex()) ;
+
   if (_evalErrorMode==CountErrors) {
     _evalErrorCount++ ;
     return ;
@@ -3651,6 +3789,9 @@ void RooAbsReal::logEvalError(const char* message, const char* serverValueString
     return ;
   }
 
+  // Errors may be logged concurrently by the threads calculating a test statistic
+  std::lock_guard<std::recursive_mutex> lock(evalErrorMutex()) ;
+
   if (_evalErrorMode==CountErrors) {
     _evalErrorCount++ ;
     return ;
@@ -4318,7 +4459,7 @@ RooFitResult* RooAbsReal::chi2FitTo(RooDataHist& data, const RooLinkedList& cmdL
 
   // Pull arguments to be passed to chi2 construction from list
   RooLinkedList fitCmdList(cmdList) ;
-  RooLinkedList chi2CmdList = pc.filterCmdList(fitCmdList,"Range,RangeWithName,NumCPU,Optimize") ;
+  RooLinkedList chi2CmdList = pc.filterCmdList(fitCmdList,"Range,RangeWithName,NumCPU,NumThreads,Optimize") ;
 
   RooAbsReal* chi2 = createChi2(data,chi2CmdList) ;
   RooFitResult* ret = chi2FitDriver(*chi2,fitCmdList) ;
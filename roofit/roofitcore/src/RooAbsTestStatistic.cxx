@@ -32,6 +32,24 @@ organizes multi-processor parallel calculation of test statistic
 values. For the latter, the test statistic value is calculated in
 partitions in parallel executing processes and a posteriori
 combined in the main thread.
+
+Alternatively, the partitions can be calculated in threads of the
+same process (see setNumThreads()). Each thread then works with its
+own clone of the function and of the data, and all clones share the
+parameters of the test statistic, so that no communication is needed
+when the parameters change. For a RooSimultaneous, the component test
+statistics are calculated one after the other, each of them split in
+partitions calculated on the thread pool of the top-level test statistic.
+
+In a simultaneous fit, a change of parameter only marks as dirty the
+component test statistics that depend on it, and only these components
+are recalculated.
+In multi-threaded mode, or on request (see setCacheParameterStates()),
+the components also keep the values of their last few parameter
+states, so that e.g. restoring a parameter after a step of a numerical
+derivative does not trigger a recalculation. These values are forgotten
+after any change of configuration (see RooAbsArg::registerConfigChange()),
+and values calculated with evaluation errors are never kept.
 **/
 
 
@@ -44,6 +62,7 @@ combined in the main thread.
 #include "RooAbsData.h"
 #include "RooArgSet.h"
 #include "RooRealVar.h"
+#include "RooAbsCategory.h"
 #include "RooNLLVar.h"
 #include "RooRealMPFE.h"
 #include "RooErrorHandler.h"
@@ -52,6 +71,16 @@ combined in the main thread.
 #include "RooProdPdf.h"
 #include "RooRealSumPdf.h"
 #include <string>
+#include <algorithm>
+
+#ifdef R__USE_IMT
+#include "ROOT/TThreadExecutor.hxx"
+#endif
+
+namespace {
+  // Number of parameter states of which the value is cached, see RooAbsTestStatistic::cacheState()
+  const Int_t kNumCachedStates = 3 ;
+}
 
 using namespace std;
 
@@ -64,6 +93,8 @@ RooAbsTestStatistic::RooAbsTestStatistic() :
   _func(0), _data(0), _projDeps(0), _splitRange(0), _simCount(0),
   _verbose(kFALSE), _init(kFALSE), _gofOpMode(Slave), _nEvents(0), _setNum(0),
   _numSets(0), _extSet(0), _nGof(0), _gofArray(0), _nCPU(1), _mpfeArray(0),
+  _nThreads(1), _nWorkers(0), _workerArray(0), _executor(0), _ownExecutor(kFALSE), _threadsWarm(kFALSE),
+  _cacheStates(kFALSE), _nStates(0), _nextState(0), _stateConfig(0),
   _mpinterl(RooFit::BulkPartition), _doOffset(kFALSE), _offset(0),
   _offsetCarry(0), _evalCarry(0)
 {
@@ -102,6 +133,16 @@ RooAbsTestStatistic::RooAbsTestStatistic(const char *name, const char *title, Ro
   _gofArray(0),
   _nCPU(nCPU),
   _mpfeArray(0),
+  _nThreads(1),
+  _nWorkers(0),
+  _workerArray(0),
+  _executor(0),
+  _ownExecutor(kFALSE),
+  _threadsWarm(kFALSE),
+  _cacheStates(kFALSE),
+  _nStates(0),
+  _nextState(0),
+  _stateConfig(0),
   _mpinterl(interleave),
   _doOffset(kFALSE),
   _offset(0),
@@ -161,6 +202,16 @@ RooAbsTestStatistic::RooAbsTestStatistic(const RooAbsTestStatistic& other, const
   _gofSplitMode(other._gofSplitMode),
   _nCPU(other._nCPU),
   _mpfeArray(0),
+  _nThreads(other._nThreads),
+  _nWorkers(0),
+  _workerArray(0),
+  _executor(0),
+  _ownExecutor(kFALSE),
+  _threadsWarm(kFALSE),
+  _cacheStates(kFALSE),
+  _nStates(0),
+  _nextState(0),
+  _stateConfig(0),
   _mpinterl(other._mpinterl),
   _doOffset(other._doOffset),
   _offset(other._offset),
@@ -216,6 +267,12 @@ RooAbsTestStatistic::~RooAbsTestStatistic()
     delete[] _gofArray ;
   }
 
+  for (Int_t i = 0; i < _nWorkers; ++i) delete _workerArray[i];
+  delete[] _workerArray ;
+#ifdef R__USE_IMT
+  if (_ownExecutor) delete _executor ;
+#endif
+
   delete _projDeps ;
 
 }
@@ -289,6 +346,11 @@ Double_t RooAbsTestStatistic::evaluate() const
 
   } else {
 
+    Double_t ret ;
+    if (_cacheStates && findCachedState(ret)) {
+      return ret ;
+    }
+
     // Evaluate as straight FUNC
     Int_t nFirst(0), nLast(_nEvents), nStep(1) ;
     
@@ -316,13 +378,23 @@ Double_t RooAbsTestStatistic::evaluate() const
       break ;
     }
 
-    Double_t ret = evaluatePartition(nFirst,nLast,nStep);
+    if (_nWorkers>0) {
+      ret = evaluateWorkers() ;
+    } else {
+      ret = evaluatePartition(nFirst,nLast,nStep);
+    }
 
     if (numSets()==1) {
       const Double_t norm = globalNormalization();
       ret /= norm;
       _evalCarry /= norm;
     }
+
+    // Values calculated with evaluation errors are not kept, so that the errors
+    // are reported again to the minimizer when going back to the same state
+    if (_cacheStates && RooAbsReal::numEvalErrors()==0 && !RooAbsPdf::evalError()) {
+      cacheState(ret) ;
+    }
     
     return ret ;
 
@@ -345,17 +417,252 @@ Bool_t RooAbsTestStatistic::initialize()
   } else if (SimMaster == _gofOpMode) {
     initSimMode((RooSimultaneous*)_func,_data,_projDeps,_rangeName.size()?_rangeName.c_str():0,_addCoefRangeName.size()?_addCoefRangeName.c_str():0) ;
   }
+  if (_nThreads > 1 && MPMaster != _gofOpMode) {
+    initMTMode() ;
+  }
   _init = kTRUE;
   return kFALSE;
 }
 
 
 
+////////////////////////////////////////////////////////////////////////////////
+/// Calculate the test statistic in multi-threaded mode. The events are split
+/// in _nWorkers+1 partitions: the clones in _workerArray calculate the first
+/// partitions and this instance calculates the last one.
+
+Double_t RooAbsTestStatistic::evaluateWorkers() const
+{
+  const Int_t nParts = _nWorkers + 1 ;
+  std::vector<Double_t> values(nParts), carries(nParts) ;
+
+  runTasks(nParts,[&](Int_t i) {
+    const RooAbsTestStatistic* part = i < _nWorkers ? _workerArray[i] : this ;
+    Int_t nFirst, nLast, nStep ;
+    if (_mpinterl == RooFit::Interleave) {
+      nFirst = i ;
+      nLast  = part->_nEvents ;
+      nStep  = nParts ;
+    } else {
+      nFirst = part->_nEvents * i / nParts ;
+      nLast  = part->_nEvents * (i+1) / nParts ;
+      nStep  = 1 ;
+    }
+    values[i] = part->evaluatePartition(nFirst,nLast,nStep) ;
+    carries[i] = part->getCarry() ;
+  }) ;
+
+  Double_t sum(0), carry = 0.;
+  for (Int_t i = 0; i < nParts; ++i) {
+    Double_t y = values[i];
+    carry += carries[i];
+    y -= carry;
+    const Double_t t = sum + y;
+    carry = (t - sum) - y;
+    sum = t;
+  }
+  _evalCarry = carry;
+  return sum ;
+}
+
+
+
+////////////////////////////////////////////////////////////////////////////////
+/// Run task(i) for i in [0,nTasks) on the thread pool of the multi-threaded
+/// mode. The first call is executed sequentially, in order to set up in the calling
+/// thread the caches that the function clones create lazily (normalization
+/// integrals, component test statistics, ...). Without thread pool, the tasks
+/// are always executed sequentially.
+
+void RooAbsTestStatistic::runTasks(Int_t nTasks, const std::function<void(Int_t)>& task) const
+{
+#ifdef R__USE_IMT
+  if (_executor && _threadsWarm) {
+    _executor->Foreach(task, ROOT::TSeqI(nTasks)) ;
+    return ;
+  }
+#endif
+  for (Int_t i = 0; i < nTasks; ++i) {
+    task(i) ;
+  }
+  _threadsWarm = kTRUE ;
+}
+
+
+
+////////////////////////////////////////////////////////////////////////////////
+/// Look for the current values of the parameters in the cached parameter states.
+/// If found, return kTRUE and set value and the evaluation carry to the values
+/// calculated for this state. The current state is kept for cacheState().
+/// The cached states are forgotten if the configuration changed since they were
+/// calculated, see RooAbsArg::registerConfigChange().
+
+Bool_t RooAbsTestStatistic::findCachedState(Double_t& value) const
+{
+  if (_stateConfig != RooAbsArg::configChangeCount()) {
+    clearStateCache() ;
+    _stateConfig = RooAbsArg::configChangeCount() ;
+  }
+
+  _curState.clear() ;
+  RooFIter iter = _paramSet.fwdIterator() ;
+  RooAbsArg* arg ;
+  while ((arg = iter.next())) {
+    RooAbsReal* real = dynamic_cast<RooAbsReal*>(arg) ;
+    RooAbsCategory* cat = real ? 0 : dynamic_cast<RooAbsCategory*>(arg) ;
+    if (real) {
+      _curState.push_back(real->getVal()) ;
+    } else if (cat) {
+      _curState.push_back(cat->getIndex()) ;
+    } else {
+      // The state cannot be described by the values of the parameters
+      _cacheStates = kFALSE ;
+      return kFALSE ;
+    }
+  }
+
+  const std::size_t stride = _curState.size() + 2 ;
+  for (Int_t i = 0; i < _nStates; ++i) {
+    const Double_t* state = &_states[i * stride] ;
+    if (std::equal(_curState.begin(), _curState.end(), state)) {
+      value = state[stride - 2] ;
+      _evalCarry = state[stride - 1] ;
+      return kTRUE ;
+    }
+  }
+  return kFALSE ;
+}
+
+
+
+////////////////////////////////////////////////////////////////////////////////
+/// Cache the value calculated for the current parameter state (as filled by
+/// findCachedState()), replacing the oldest cached state. Nothing is cached if
+/// the configuration changed during the calculation.
+
+void RooAbsTestStatistic::cacheState(Double_t value) const
+{
+  if (_stateConfig != RooAbsArg::configChangeCount()) {
+    return ;
+  }
+
+  const std::size_t stride = _curState.size() + 2 ;
+  _states.resize(kNumCachedStates * stride) ;
+  Double_t* state = &_states[_nextState * stride] ;
+  std::copy(_curState.begin(), _curState.end(), state) ;
+  state[stride - 2] = value ;
+  state[stride - 1] = _evalCarry ;
+  _nextState = (_nextState + 1) % kNumCachedStates ;
+  _nStates = std::min(_nStates + 1, kNumCachedStates) ;
+}
+
+
+
+////////////////////////////////////////////////////////////////////////////////
+/// Forget the cached parameter states. To be called when the value of the test
+/// statistic changes for reasons other than its parameters (data, offsetting, ...)
+
+void RooAbsTestStatistic::clearStateCache() const
+{
+  _nStates = 0 ;
+  _nextState = 0 ;
+  _states.clear() ;
+}
+
+
+
+////////////////////////////////////////////////////////////////////////////////
+/// Return the offset subtracted from the value of the test statistic. In
+/// multi-threaded mode, the offsets of the partitions are added.
+
+Double_t RooAbsTestStatistic::offset() const
+{
+  Double_t ret = _offset ;
+  for (Int_t i = 0; i < _nWorkers; ++i) {
+    ret += _workerArray[i]->offset() ;
+  }
+  return ret ;
+}
+
+
+
+////////////////////////////////////////////////////////////////////////////////
+/// Return the carry of the Kahan summation of offset()
+
+Double_t RooAbsTestStatistic::offsetCarry() const
+{
+  Double_t ret = _offsetCarry ;
+  for (Int_t i = 0; i < _nWorkers; ++i) {
+    ret += _workerArray[i]->offsetCarry() ;
+  }
+  return ret ;
+}
+
+
+
+////////////////////////////////////////////////////////////////////////////////
+/// Calculate the test statistic with nThreads threads instead of a single thread.
+/// For a test statistic on a single p.d.f, the events are split in nThreads partitions
+/// with the strategy given to the constructor (RooFit::BulkPartition or RooFit::Interleave).
+/// Each partition is calculated by a clone of this test statistic, with its own clone
+/// of the function and of the data, that reads the parameters of this test statistic.
+/// For a RooSimultaneous, the component test statistics are calculated one after the other,
+/// and each of them is split in nThreads partitions. All partitions run on the thread pool
+/// of the top-level test statistic, so that the thread pools are never nested.
+///
+/// The threads are taken from the ROOT thread pool: if implicit multi-threading is already
+/// enabled, the size of its pool is not changed. The number of threads must be set before
+/// the first evaluation, and cannot be combined with the multi-process mode (NumCPU).
+
+void RooAbsTestStatistic::setNumThreads(Int_t nThreads)
+{
+  if (_init) {
+    coutE(Eval) << "RooAbsTestStatistic::setNumThreads(" << GetName()
+		<< ") ERROR: the number of threads must be set before the first evaluation" << endl ;
+    return ;
+  }
+  if (nThreads > 1 && MPMaster == _gofOpMode) {
+    coutE(Eval) << "RooAbsTestStatistic::setNumThreads(" << GetName()
+		<< ") ERROR: multi-threaded mode cannot be combined with multi-process mode" << endl ;
+    return ;
+  }
+#ifndef R__USE_IMT
+  if (nThreads > 1) {
+    coutW(Eval) << "RooAbsTestStatistic::setNumThreads(" << GetName()
+		<< ") WARNING: ROOT was built without multi-threading support, using a single thread" << endl ;
+    return ;
+  }
+#endif
+  _nThreads = nThreads > 1 ? nThreads : 1 ;
+}
+
+
+
+////////////////////////////////////////////////////////////////////////////////
+/// Keep the values calculated for the last few parameter states, so that going back
+/// to one of them, e.g. after a step of a numerical derivative, does not trigger a
+/// recalculation. For a RooSimultaneous, the values are kept by the component test
+/// statistics, which do so by default in multi-threaded mode (see setNumThreads()).
+
+void RooAbsTestStatistic::setCacheParameterStates(Bool_t flag)
+{
+  _cacheStates = flag ;
+  clearStateCache() ;
+  if (SimMaster == _gofOpMode && _init) {
+    for (Int_t i = 0; i < _nGof; ++i) {
+      if (_gofArray[i]) _gofArray[i]->setCacheParameterStates(flag) ;
+    }
+  }
+}
+
+
+
 ////////////////////////////////////////////////////////////////////////////////
 /// Forward server redirect calls to component test statistics
 
 Bool_t RooAbsTestStatistic::redirectServersHook(const RooAbsCollection& newServerList, Bool_t mustReplaceAll, Bool_t nameChange, Bool_t)
 {
+  clearStateCache() ;
   if (SimMaster == _gofOpMode && _gofArray) {
     // Forward to slaves
     for (Int_t i = 0; i < _nGof; ++i) {
@@ -372,6 +679,9 @@ Bool_t RooAbsTestStatistic::redirectServersHook(const RooAbsCollection& newServe
       }
     }
   }
+  for (Int_t i = 0; i < _nWorkers; ++i) {
+    _workerArray[i]->recursiveRedirectServers(newServerList,mustReplaceAll,nameChange);
+  }
   return kFALSE;
 }
 
@@ -408,6 +718,7 @@ void RooAbsTestStatistic::printCompactTreeHook(ostream& os, const char* indent)
 void RooAbsTestStatistic::constOptimizeTestStatistic(ConstOpCode opcode, Bool_t doAlsoTrackingOpt)
 {
   initialize();
+  clearStateCache();
   if (SimMaster == _gofOpMode) {
     // Forward to slaves
     for (Int_t i = 0; i < _nGof; ++i) {
@@ -422,6 +733,9 @@ void RooAbsTestStatistic::constOptimizeTestStatistic(ConstOpCode opcode, Bool_t
       _mpfeArray[i]->constOptimizeTestStatistic(opcode,doAlsoTrackingOpt);
     }
   }
+  for (Int_t i = 0; i < _nWorkers; ++i) {
+    _workerArray[i]->constOptimizeTestStatistic(opcode,doAlsoTrackingOpt);
+  }
 }
 
 
@@ -478,6 +792,43 @@ void RooAbsTestStatistic::initMPMode(RooAbsReal* real, RooAbsData* data, const R
 
 
 
+////////////////////////////////////////////////////////////////////////////////
+/// Initialize multi-threaded calculation mode. Create the thread pool and, for
+/// a test statistic on a single p.d.f, the clones calculating the partitions of
+/// the events other than the one calculated by this instance. The components of
+/// a RooSimultaneous are set up in initSimMode().
+
+void RooAbsTestStatistic::initMTMode()
+{
+#ifdef R__USE_IMT
+  // The components of a RooSimultaneous share the thread pool of the top-level test statistic
+  if (!_executor) {
+    _executor = new ROOT::TThreadExecutor(_nThreads) ;
+    _ownExecutor = kTRUE ;
+  }
+  if (SimMaster == _gofOpMode) {
+    for (Int_t i = 0; i < _nGof; ++i) _gofArray[i]->_executor = _executor ;
+  }
+
+  if (Slave != _gofOpMode || _numSets != 1 ||
+      (_mpinterl != RooFit::BulkPartition && _mpinterl != RooFit::Interleave)) {
+    return ;
+  }
+
+  _nWorkers = _nThreads - 1 ;
+  _workerArray = new pRooAbsTestStatistic[_nWorkers] ;
+  for (Int_t i = 0; i < _nWorkers; ++i) {
+    RooAbsTestStatistic* worker = (RooAbsTestStatistic*) Clone(Form("%s_thread%d",GetName(),i)) ;
+    worker->_nThreads = 1 ;
+    worker->setMPSet(i,_nThreads) ;
+    _workerArray[i] = worker ;
+  }
+  coutI(Eval) << "RooAbsTestStatistic::initMTMode(" << GetName() << ") calculating " << _nThreads << " partitions in parallel threads" << endl;
+#endif
+}
+
+
+
 ////////////////////////////////////////////////////////////////////////////////
 /// Initialize simultaneous p.d.f processing mode. Strip simultaneous
 /// p.d.f into individual components, split dataset in subset
@@ -565,6 +916,17 @@ void RooAbsTestStatistic::initSimMode(RooSimultaneous* simpdf, RooAbsData* data,
       _gofArray[n]->setSimCount(_nGof);
       // *** END HERE
 
+      // In multi-threaded mode, or on request, components remember the values of their
+      // last parameter states, as only the components depending on a changed parameter
+      // are recalculated
+      _gofArray[n]->_cacheStates = _cacheStates || _nThreads > 1;
+
+      // The components are calculated one after the other, each of them in as many
+      // partitions as there are threads
+      if (_nThreads > 1) {
+	_gofArray[n]->setNumThreads(std::min(_nThreads,std::max(dset->numEntries(),1))) ;
+      }
+
       // Fill per-component split mode with Bulk Partition for now so that Auto will map to bulk-splitting of all components
       if (_mpinterl==RooFit::Hybrid) {
 	if (dset->numEntries()<10) {
@@ -615,6 +977,13 @@ void RooAbsTestStatistic::initSimMode(RooSimultaneous* simpdf, RooAbsData* data,
 
 Bool_t RooAbsTestStatistic::setData(RooAbsData& indata, Bool_t cloneData) 
 { 
+  clearStateCache();
+  if (SimMaster == _gofOpMode) {
+    for (Int_t i = 0; i < _nGof; ++i) {
+      if (_gofArray[i]) _gofArray[i]->clearStateCache();
+    }
+  }
+
   // Trigger refresh of likelihood offsets 
   if (isOffsetting()) {
     enableOffsetting(kFALSE);
@@ -623,6 +992,10 @@ Bool_t RooAbsTestStatistic::setData(RooAbsData& indata, Bool_t cloneData)
 
   switch(operMode()) {
   case Slave:
+    // Forward to the clones calculating the other partitions, which always need their own copy of the data
+    for (Int_t i = 0; i < _nWorkers; ++i) {
+      _workerArray[i]->setDataSlave(indata, kTRUE);
+    }
     // Delegate to implementation
     return setDataSlave(indata, cloneData);
   case SimMaster:
@@ -671,6 +1044,7 @@ void RooAbsTestStatistic::enableOffsetting(Bool_t flag)
   if (!_init) {
     const_cast<RooAbsTestStatistic*>(this)->initialize() ;
   }
+  clearStateCache() ;
   
   switch(operMode()) {
   case Slave:
@@ -680,6 +1054,9 @@ void RooAbsTestStatistic::enableOffsetting(Bool_t flag)
       _offset = 0 ;
       _offsetCarry = 0;
     }
+    for (Int_t i = 0; i < _nWorkers; ++i) {
+      _workerArray[i]->enableOffsetting(flag);
+    }
     setValueDirty() ;
     break ;
   case SimMaster:
@@ -75,6 +75,7 @@ of each coefficient_i.
 #include "RooGlobalFunc.h"
 #include "RooRealIntegral.h"
 #include "RooTrace.h"
+#include "BatchHelpers.h"
 
 #include "Riostream.h"
 #include <algorithm>
@@ -860,6 +861,84 @@ Double_t RooAddPdf::evaluate() const
 }
 
 
+namespace {
+
+template<class T>
+void addScaled(RooSpan<double> output, T values, Double_t coef)
+{
+  const std::size_t n = output.size() ;
+  for (std::size_t i=0 ; i<n ; ++i) {
+    output[i] += values[i]*coef ;
+  }
+}
+
+template<class T, class TNorm>
+void addScaled(RooSpan<double> output, T values, Double_t coef, TNorm snorm)
+{
+  const std::size_t n = output.size() ;
+  for (std::size_t i=0 ; i<n ; ++i) {
+    output[i] += values[i]*coef/snorm[i] ;
+  }
+}
+
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+/// Calculate the sum of the components for a batch of entries, see evaluate().
+/// The coefficients are computed once for the whole batch, which requires them
+/// to be independent of the observables. Otherwise, the entries are evaluated
+/// one by one.
+
+RooSpan<double> RooAddPdf::evaluateBatch(std::size_t begin, std::size_t batchSize) const
+{
+  using namespace BatchHelpers ;
+
+  const RooArgSet* nset = _normSet ;
+  if (nset==0 || nset->getSize()==0) {
+    if (_refCoefNorm.getSize()!=0) {
+      nset = &_refCoefNorm ;
+    }
+  }
+
+  RooFIter ci = _coefList.fwdIterator() ;
+  RooAbsReal* coef ;
+  while((coef = (RooAbsReal*)ci.next())) {
+    if (isBatch(coef->getValBatch(begin,batchSize,nset))) return RooSpan<double>() ;
+  }
+
+  CacheElem* cache = getProjCache(nset) ;
+  updateCoefficients(*cache,nset) ;
+
+  RooSpan<double> output = makeBatch(batchSize) ;
+  for (std::size_t i=0 ; i<batchSize ; ++i) {
+    output[i] = 0 ;
+  }
+
+  // Running sum of coef/pdf pairs. The values of each component are
+  // accumulated before the next component is evaluated.
+  RooAbsPdf* pdf ;
+  Int_t i(0) ;
+  RooFIter pi = _pdfList.fwdIterator() ;
+  while((pdf = (RooAbsPdf*)pi.next())) {
+    if (pdf->isSelectedComp()) {
+      RooSpan<const double> pdfVal = pdf->getValBatch(begin,batchSize,nset) ;
+      if (cache->_needSupNorm) {
+	RooSpan<const double> snormVal = ((RooAbsReal*)cache->_suppNormList.at(i))->getValBatch(begin,batchSize) ;
+	addScaled(output,BracketAdapterWithMask(pdfVal),_coefCache[i],BracketAdapterWithMask(snormVal)) ;
+      } else if (isBatch(pdfVal)) {
+	addScaled(output,pdfVal.data(),_coefCache[i]) ;
+      } else {
+	addScaled(output,BracketAdapter(pdfVal),_coefCache[i]) ;
+      }
+    }
+    i++ ;
+  }
+
+  return output ;
+}
+
+
 ////////////////////////////////////////////////////////////////////////////////
 /// Reset error counter to given value, limiting the number
 /// of future error messages for this pdf to 'resetValue'
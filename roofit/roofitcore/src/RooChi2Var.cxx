@@ -67,18 +67,22 @@ RooChi2Var::RooChi2Var(const char *name, const char* title, RooAbsReal& func, Ro
   //
   //  DataError()  -- Choose between Poisson errors and Sum-of-weights errors
   //  NumCPU()     -- Activate parallel processing feature
+  //  NumThreads() -- Activate multi-threaded processing feature
   //  Range()      -- Fit only selected region
   //  Verbose()    -- Verbose output of GOF framework
 {
   RooCmdConfig pc("RooChi2Var::RooChi2Var") ;
   pc.defineInt("etype","DataError",0,(Int_t)RooDataHist::Auto) ;  
   pc.defineInt("extended","Extended",0,kFALSE) ;
+  pc.defineInt("numthreads","NumThreads",0,1) ;
   pc.allowUndefined() ;
 
   pc.process(arg1) ;  pc.process(arg2) ;  pc.process(arg3) ;
   pc.process(arg4) ;  pc.process(arg5) ;  pc.process(arg6) ;
   pc.process(arg7) ;  pc.process(arg8) ;  pc.process(arg9) ;
 
+  setNumThreads(pc.getInt("numthreads")) ;
+
   if (func.IsA()->InheritsFrom(RooAbsPdf::Class())) {
     _funcMode = pc.getInt("extended") ? ExtendedPdf : Pdf ;
   } else {
@@ -114,6 +118,7 @@ RooChi2Var::RooChi2Var(const char *name, const char* title, RooAbsPdf& pdf, RooD
   //  Extended()   -- Include extended term in calculation
   //  DataError()  -- Choose between Poisson errors and Sum-of-weights errors
   //  NumCPU()     -- Activate parallel processing feature
+  //  NumThreads() -- Activate multi-threaded processing feature
   //  Range()      -- Fit only selected region
   //  SumCoefRange() -- Set the range in which to interpret the coefficients of RooAddPdf components 
   //  SplitRange() -- Fit range is split by index catory of simultaneous PDF
@@ -123,12 +128,15 @@ RooChi2Var::RooChi2Var(const char *name, const char* title, RooAbsPdf& pdf, RooD
   RooCmdConfig pc("RooChi2Var::RooChi2Var") ;
   pc.defineInt("extended","Extended",0,kFALSE) ;
   pc.defineInt("etype","DataError",0,(Int_t)RooDataHist::Auto) ;  
+  pc.defineInt("numthreads","NumThreads",0,1) ;
   pc.allowUndefined() ;
 
   pc.process(arg1) ;  pc.process(arg2) ;  pc.process(arg3) ;
   pc.process(arg4) ;  pc.process(arg5) ;  pc.process(arg6) ;
   pc.process(arg7) ;  pc.process(arg8) ;  pc.process(arg9) ;
 
+  setNumThreads(pc.getInt("numthreads")) ;
+
   _funcMode = pc.getInt("extended") ? ExtendedPdf : Pdf ;
   _etype = (RooDataHist::ErrorType) pc.getInt("etype") ;
   if (_etype==RooAbsData::Auto) {
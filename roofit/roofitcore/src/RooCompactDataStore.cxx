@@ -0,0 +1,1550 @@
+/*****************************************************************************
+ * Project: RooFit                                                           *
+ * Package: RooFitCore                                                       *
+ * @(#)root/roofitcore:$Id$
+ *                                                                           *
+ * Copyright (c) 2018, CERN                                                  *
+ *                                                                           *
+ * Redistribution and use in source and binary forms,                        *
+ * with or without modification, are permitted according to the terms        *
+ * listed in LICENSE (http://roofit.sourceforge.net/license.txt)             *
+ *****************************************************************************/
+
+/**
+\file RooCompactDataStore.cxx
+\class RooCompactDataStore
+\ingroup Roofitcore
+
+RooCompactDataStore is a column-wise data store that minimizes the memory
+used by large unbinned datasets.
+
+- The real values are stored in single precision by default. The encoding of
+  each column can be chosen with the string attribute `StorageEncoding` of the
+  variable: `Double`, `Float`, or `Fixed16` for 16-bit fixed-point values
+  spanning the range of a RooRealVar with finite limits (resolution
+  (max-min)/65535). The default for variables without this attribute is set
+  with setDefaultEncoding(). Errors requested with the StoreError and
+  StoreAsymError attributes are stored in single precision.
+- The category states are stored as 16-bit indices in the list of distinct
+  states of the column, instead of one RooCatType per entry.
+- A dataset can be read from a TTree without an intermediate in-memory copy of
+  the tree. The branch addresses of the tree are reset afterwards.
+- Columns can be taken over without copying from vectors, e.g. the results of
+  RDataFrame::Take().
+
+The values loaded by get() are converted to double precision, so a store can
+use about 2 (Float) or 4 (Fixed16) times less memory than a RooVectorDataStore
+for the real values and over a hundred times less for categories, which also
+reduces the memory traffic of the likelihood loops.
+
+Datasets use this store when the default storage type is
+RooAbsData::Compact:
+~~~ {.cpp}
+RooAbsData::setDefaultStorageType(RooAbsData::Compact) ;
+x.setStringAttribute("StorageEncoding","Fixed16") ;
+RooDataSet data("data","data",tree,RooArgSet(x,y,cat)) ;
+
+// Without copy from RDataFrame columns
+RooDataSet data2("data2","data2",RooArgSet(x,y)) ;
+RooCompactDataStore* store = static_cast<RooCompactDataStore*>(data2.store()) ;
+store->adoptColumn(x,std::move(*df.Take<float>("x"))) ;
+store->adoptColumn(y,std::move(*df.Take<float>("y"))) ;
+~~~
+Adopted values are not checked against the ranges of the variables. The
+entries of the store are available once all the columns have the same size.
+
+The constant terms of a likelihood are cached in double precision. The
+cache-and-track optimization (Optimize level 2) and the batch evaluation
+interface require a RooVectorDataStore, see RooAbsData::convertToVectorStore().
+**/
+
+#include "RooFit.h"
+#include "RooMsgService.h"
+#include "RooCompactDataStore.h"
+#include "RooVectorDataStore.h"
+#include "RooTreeDataStore.h"
+
+#include "Riostream.h"
+#include "TTree.h"
+#include "TBuffer.h"
+#include "RooFormulaVar.h"
+#include "RooRealVar.h"
+#include "RooCategory.h"
+#include "RooHistError.h"
+#include "RooTrace.h"
+
+#include <cmath>
+using namespace std ;
+
+ClassImp(RooCompactDataStore);
+ClassImp(RooCompactDataStore::RealColumn);
+ClassImp(RooCompactDataStore::CatColumn);
+
+RooCompactDataStore::Encoding RooCompactDataStore::_defaultEncoding = RooCompactDataStore::Float ;
+
+
+////////////////////////////////////////////////////////////////////////////////
+/// Set the encoding of the columns of real values whose variable has no
+/// StorageEncoding attribute
+
+void RooCompactDataStore::setDefaultEncoding(Encoding encoding)
+{
+  _defaultEncoding = encoding ;
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+
+RooCompactDataStore::Encoding RooCompactDataStore::defaultEncoding()
+{
+  return _defaultEncoding ;
+}
+
+
+
+////////////////////////////////////////////////////////////////////////////////
+
+RooCompactDataStore::RooCompactDataStore() :
+  _wgtVar(0),
+  _wgtColumn(0),
+  _nEntries(0),
+  _sumWeight(0),
+  _sumWeightCarry(0),
+  _curWgt(1),
+  _curWgtErrLo(0),
+  _curWgtErrHi(0),
+  _curWgtErr(0),
+  _cache(0),
+  _cacheOwner(0)
+{
+  TRACE_CREATE
+}
+
+
+
+////////////////////////////////////////////////////////////////////////////////
+
+RooCompactDataStore::RooCompactDataStore(const char* name, const char* title, const RooArgSet& vars, const char* wgtVarName) :
+  RooAbsDataStore(name,title,varsNoWeight(vars,wgtVarName)),
+  _varsww(vars),
+  _wgtVar(weightVar(vars,wgtVarName)),
+  _wgtColumn(0),
+  _nEntries(0),
+  _sumWeight(0),
+  _sumWeightCarry(0),
+  _curWgt(1),
+  _curWgtErrLo(0),
+  _curWgtErrHi(0),
+  _curWgtErr(0),
+  _cache(0),
+  _cacheOwner(0)
+{
+  RooFIter iter = _varsww.fwdIterator() ;
+  RooAbsArg* arg ;
+  while((arg=iter.next())) {
+    addArg(arg) ;
+  }
+  TRACE_CREATE
+}
+
+
+
+////////////////////////////////////////////////////////////////////////////////
+/// Regular copy ctor
+
+RooCompactDataStore::RooCompactDataStore(const RooCompactDataStore& other, const char* newname) :
+  RooAbsDataStore(other,newname),
+  _varsww(other._varsww),
+  _wgtVar(other._wgtVar),
+  _wgtColumn(0),
+  _nEntries(other._nEntries),
+  _sumWeight(other._sumWeight),
+  _sumWeightCarry(other._sumWeightCarry),
+  _curWgt(other._curWgt),
+  _curWgtErrLo(other._curWgtErrLo),
+  _curWgtErrHi(other._curWgtErrHi),
+  _curWgtErr(other._curWgtErr),
+  _cache(0),
+  _cacheOwner(0)
+{
+  for (auto column : other._realColumns) {
+    _realColumns.push_back(new RealColumn(*column,(RooAbsReal*)_varsww.find(column->bufArg()->GetName()))) ;
+  }
+  for (auto column : other._catColumns) {
+    _catColumns.push_back(new CatColumn(*column,(RooAbsCategory*)_varsww.find(column->bufArg()->GetName()))) ;
+  }
+  resetBuffers() ;
+  TRACE_CREATE
+}
+
+
+
+////////////////////////////////////////////////////////////////////////////////
+/// Clone ctor, must connect internal storage to given new external set of vars
+
+RooCompactDataStore::RooCompactDataStore(const RooCompactDataStore& other, const RooArgSet& vars, const char* newname) :
+  RooAbsDataStore(other,varsNoWeight(vars,other._wgtVar?other._wgtVar->GetName():0),newname),
+  _varsww(vars),
+  _wgtVar(other._wgtVar?weightVar(vars,other._wgtVar->GetName()):0),
+  _wgtColumn(0),
+  _nEntries(other._nEntries),
+  _sumWeight(other._sumWeight),
+  _sumWeightCarry(other._sumWeightCarry),
+  _curWgt(other._curWgt),
+  _curWgtErrLo(other._curWgtErrLo),
+  _curWgtErrHi(other._curWgtErrHi),
+  _curWgtErr(other._curWgtErr),
+  _cache(0),
+  _cacheOwner(0)
+{
+  for (auto column : other._realColumns) {
+    RooAbsReal* real = (RooAbsReal*) vars.find(column->bufArg()->GetName()) ;
+    if (real) _realColumns.push_back(new RealColumn(*column,real)) ;
+  }
+  for (auto column : other._catColumns) {
+    RooAbsCategory* cat = (RooAbsCategory*) vars.find(column->bufArg()->GetName()) ;
+    if (cat) _catColumns.push_back(new CatColumn(*column,cat)) ;
+  }
+  resetBuffers() ;
+  TRACE_CREATE
+}
+
+
+
+////////////////////////////////////////////////////////////////////////////////
+/// Ctor copying the entries of another store that pass the selection
+
+RooCompactDataStore::RooCompactDataStore(const char *name, const char *title, RooAbsDataStore& ads,
+					 const RooArgSet& vars, const RooFormulaVar* cutVar, const char* cutRange,
+					 Int_t nStart, Int_t nStop, Bool_t /*copyCache*/, const char* wgtVarName) :
+  RooAbsDataStore(name,title,varsNoWeight(vars,wgtVarName)),
+  _varsww(vars),
+  _wgtVar(weightVar(vars,wgtVarName)),
+  _wgtColumn(0),
+  _nEntries(0),
+  _sumWeight(0),
+  _sumWeightCarry(0),
+  _curWgt(1),
+  _curWgtErrLo(0),
+  _curWgtErrHi(0),
+  _curWgtErr(0),
+  _cache(0),
+  _cacheOwner(0)
+{
+  RooFIter iter = _varsww.fwdIterator() ;
+  RooAbsArg* arg ;
+  while((arg=iter.next())) {
+    addArg(arg) ;
+  }
+
+  // Deep clone cutVar and attach clone to this dataset
+  RooFormulaVar* cloneVar = 0;
+  if (cutVar) {
+    cloneVar = (RooFormulaVar*) cutVar->cloneTree() ;
+    cloneVar->attachDataStore(ads) ;
+  }
+
+  loadValues(&ads,cloneVar,cutRange,nStart,nStop);
+
+  delete cloneVar ;
+  TRACE_CREATE
+}
+
+
+
+////////////////////////////////////////////////////////////////////////////////
+/// Ctor reading the entries of a TTree that pass the selection. The tree must
+/// have a branch for each variable, see RooDataSet
+
+RooCompactDataStore::RooCompactDataStore(const char* name, const char* title, const RooArgSet& vars, TTree& t,
+					 const RooFormulaVar* select, const char* wgtVarName) :
+  RooAbsDataStore(name,title,varsNoWeight(vars,wgtVarName)),
+  _varsww(vars),
+  _wgtVar(weightVar(vars,wgtVarName)),
+  _wgtColumn(0),
+  _nEntries(0),
+  _sumWeight(0),
+  _sumWeightCarry(0),
+  _curWgt(1),
+  _curWgtErrLo(0),
+  _curWgtErrHi(0),
+  _curWgtErr(0),
+  _cache(0),
+  _cacheOwner(0)
+{
+  RooFIter iter = _varsww.fwdIterator() ;
+  RooAbsArg* arg ;
+  while((arg=iter.next())) {
+    addArg(arg) ;
+  }
+
+  loadValues(t,select) ;
+  TRACE_CREATE
+}
+
+
+
+////////////////////////////////////////////////////////////////////////////////
+/// Destructor
+
+RooCompactDataStore::~RooCompactDataStore()
+{
+  for (auto column : _realColumns) delete column ;
+  for (auto column : _catColumns) delete column ;
+  delete _cache ;
+  TRACE_DESTROY
+}
+
+
+
+////////////////////////////////////////////////////////////////////////////////
+/// Utility function for constructors
+/// Return RooArgSet that is copy of allVars minus variable matching wgtName if specified
+
+RooArgSet RooCompactDataStore::varsNoWeight(const RooArgSet& allVars, const char* wgtName)
+{
+  RooArgSet ret(allVars) ;
+  if(wgtName) {
+    RooAbsArg* wgt = allVars.find(wgtName) ;
+    if (wgt) {
+      ret.remove(*wgt,kTRUE,kTRUE) ;
+    }
+  }
+  return ret ;
+}
+
+
+
+////////////////////////////////////////////////////////////////////////////////
+/// Utility function for constructors
+/// Return pointer to weight variable if it is defined
+
+RooRealVar* RooCompactDataStore::weightVar(const RooArgSet& allVars, const char* wgtName)
+{
+  if(wgtName) {
+    RooRealVar* wgt = dynamic_cast<RooRealVar*>(allVars.find(wgtName)) ;
+    return wgt ;
+  }
+  return 0 ;
+}
+
+
+
+////////////////////////////////////////////////////////////////////////////////
+/// Create the column holding the values of arg, and attach arg to it.
+/// The encoding of a real column is taken from the StorageEncoding attribute
+/// of arg, or the default encoding.
+
+void RooCompactDataStore::addArg(RooAbsArg* arg)
+{
+  RooAbsReal* real = dynamic_cast<RooAbsReal*>(arg) ;
+  RooAbsCategory* cat = dynamic_cast<RooAbsCategory*>(arg) ;
+
+  if (real) {
+    Int_t encoding = _defaultEncoding ;
+    const char* attrib = arg->getStringAttribute("StorageEncoding") ;
+    if (attrib) {
+      TString enc(attrib) ;
+      if (enc=="Double") {
+	encoding = Double ;
+      } else if (enc=="Float") {
+	encoding = Float ;
+      } else if (enc=="Fixed16") {
+	encoding = Fixed16 ;
+      } else {
+	coutW(InputArguments) << "RooCompactDataStore::addArg(" << GetName() << ") unknown StorageEncoding " << attrib
+			      << " of " << arg->GetName() << ", using the default encoding" << endl ;
+      }
+    }
+
+    RooAbsRealLValue* lvalue = dynamic_cast<RooAbsRealLValue*>(real) ;
+    if (encoding==Fixed16 && (!lvalue || !lvalue->hasMin() || !lvalue->hasMax())) {
+      coutW(InputArguments) << "RooCompactDataStore::addArg(" << GetName() << ") fixed-point encoding of " << arg->GetName()
+			    << " requires a finite range, using single precision" << endl ;
+      encoding = Float ;
+    }
+
+    RealColumn* column = new RealColumn(real,encoding) ;
+    if (encoding==Fixed16) {
+      column->_offset = lvalue->getMin() ;
+      column->_step = (lvalue->getMax()-lvalue->getMin())/65535. ;
+    }
+    _realColumns.push_back(column) ;
+    attachArg(*arg) ;
+
+  } else if (cat) {
+
+    _catColumns.push_back(new CatColumn(cat)) ;
+    attachArg(*arg) ;
+
+  }
+
+  if (arg==_wgtVar) _wgtColumn = findReal(arg->GetName()) ;
+}
+
+
+
+////////////////////////////////////////////////////////////////////////////////
+/// Attach the value (and error) buffers of arg to the column of the same
+/// name. Error columns are created if arg has the StoreError or
+/// StoreAsymError attribute.
+
+void RooCompactDataStore::attachArg(RooAbsArg& arg)
+{
+  Bool_t native = _varsww.find(arg.GetName())==&arg ;
+
+  RealColumn* rc = findReal(arg.GetName()) ;
+  if (rc) {
+    RooRealVar* var = dynamic_cast<RooRealVar*>(&arg) ;
+    if (var) {
+      if (native) rc->enableErrors(arg.getAttribute("StoreError"),arg.getAttribute("StoreAsymError")) ;
+      rc->setBuffer(&var->_value,&var->_error,&var->_asymErrLo,&var->_asymErrHi) ;
+    } else {
+      rc->setBuffer(&((RooAbsReal&)arg)._value,0,0,0) ;
+    }
+    if (native) rc->setNativeBuffer() ;
+    return ;
+  }
+
+  CatColumn* cc = findCategory(arg.GetName()) ;
+  if (cc) {
+    cc->setBuffer(&((RooAbsCategory&)arg)._value) ;
+    if (native) cc->setNativeBuffer() ;
+  }
+}
+
+
+
+////////////////////////////////////////////////////////////////////////////////
+
+RooCompactDataStore::RealColumn* RooCompactDataStore::findReal(const char* name) const
+{
+  for (auto column : _realColumns) {
+    if (!strcmp(column->bufArg()->GetName(),name)) return column ;
+  }
+  return 0 ;
+}
+
+
+
+////////////////////////////////////////////////////////////////////////////////
+
+RooCompactDataStore::CatColumn* RooCompactDataStore::findCategory(const char* name) const
+{
+  for (auto column : _catColumns) {
+    if (!strcmp(column->bufArg()->GetName(),name)) return column ;
+  }
+  return 0 ;
+}
+
+
+
+////////////////////////////////////////////////////////////////////////////////
+/// Return true if currently loaded coordinate is considered valid within
+/// the current range definitions of all observables
+
+Bool_t RooCompactDataStore::valid() const
+{
+  return kTRUE ;
+}
+
+
+
+////////////////////////////////////////////////////////////////////////////////
+/// Append the current values of the variables
+
+Int_t RooCompactDataStore::fill()
+{
+  for (auto column : _realColumns) column->fill() ;
+  for (auto column : _catColumns) {
+    if (!column->fill()) {
+      coutE(InputArguments) << "RooCompactDataStore::fill(" << GetName() << ") ERROR: too many states in category "
+			    << column->bufArg()->GetName() << endl ;
+      throw std::string("RooCompactDataStore::fill() too many category states") ;
+    }
+  }
+
+  // use Kahan's algorithm to sum up the stored weights
+  Double_t y = (_wgtColumn ? _wgtColumn->value(_nEntries) : 1.) - _sumWeightCarry;
+  Double_t t = _sumWeight + y;
+  _sumWeightCarry = (t - _sumWeight) - y;
+  _sumWeight = t;
+  _nEntries++ ;
+
+  return 0 ;
+}
+
+
+
+////////////////////////////////////////////////////////////////////////////////
+
+void RooCompactDataStore::reserve(Int_t nEvts)
+{
+  for (auto column : _realColumns) column->reserve(nEvts) ;
+  for (auto column : _catColumns) column->reserve(nEvts) ;
+}
+
+
+
+////////////////////////////////////////////////////////////////////////////////
+/// Load the n-th data point (n='index') in memory
+/// and return a pointer to the internal RooArgSet
+/// holding its coordinates.
+
+const RooArgSet* RooCompactDataStore::get(Int_t index) const
+{
+  if (index>=_nEntries) return 0 ;
+
+  for (auto column : _realColumns) column->get(index) ;
+  for (auto column : _catColumns) column->get(index) ;
+
+  if (_doDirtyProp) {
+    // Raise all dirty flags
+    _iterator->Reset() ;
+    RooAbsArg* var = 0;
+    while ((var=(RooAbsArg*)_iterator->Next())) {
+      var->setValueDirty() ; // This triggers recalculation of all clients
+    }
+  }
+
+  if (_wgtColumn) {
+    _curWgt = _wgtColumn->value(index) ;
+    updateWeight() ;
+  }
+
+  if (_cache) {
+    _cache->get(index) ;
+  }
+
+  return &_vars;
+}
+
+
+
+////////////////////////////////////////////////////////////////////////////////
+/// Load the n-th data point (n='index') in the variables of this store
+
+const RooArgSet* RooCompactDataStore::getNative(Int_t index) const
+{
+  if (index>=_nEntries) return 0 ;
+
+  for (auto column : _realColumns) column->getNative(index) ;
+  for (auto column : _catColumns) column->getNative(index) ;
+
+  if (_doDirtyProp) {
+    _iterator->Reset() ;
+    RooAbsArg* var = 0;
+    while ((var=(RooAbsArg*)_iterator->Next())) {
+      var->setValueDirty() ;
+    }
+  }
+
+  if (_wgtColumn) {
+    _curWgt = _wgtColumn->value(index) ;
+    updateWeight() ;
+  } else {
+    _curWgt = 1.0 ;
+    _curWgtErrLo = _curWgtErrHi = _curWgtErr = 0 ;
+  }
+
+  return &_vars;
+}
+
+
+
+////////////////////////////////////////////////////////////////////////////////
+/// Update the errors of the current weight from the weight variable
+
+void RooCompactDataStore::updateWeight() const
+{
+  _curWgtErrLo = _wgtVar->getAsymErrorLo() ;
+  _curWgtErrHi = _wgtVar->getAsymErrorHi() ;
+  _curWgtErr   = _wgtVar->hasAsymError() ? ((_wgtVar->getAsymErrorHi() - _wgtVar->getAsymErrorLo())/2)  : _wgtVar->getError() ;
+}
+
+
+
+////////////////////////////////////////////////////////////////////////////////
+/// Return the weight of the n-th data point (n='index') in memory
+
+Double_t RooCompactDataStore::weight(Int_t index) const
+{
+  get(index) ;
+  return weight() ;
+}
+
+
+
+////////////////////////////////////////////////////////////////////////////////
+/// Return the weight of the current data point
+
+Double_t RooCompactDataStore::weight() const
+{
+  return _curWgt ;
+}
+
+
+
+////////////////////////////////////////////////////////////////////////////////
+
+Double_t RooCompactDataStore::weightError(RooAbsData::ErrorType /*etype*/) const
+{
+  if (!_wgtVar) return 0 ;
+  if (_wgtVar->hasAsymError()) {
+    return ( _wgtVar->getAsymErrorHi() - _wgtVar->getAsymErrorLo() ) / 2 ;
+  } else if (_wgtVar->hasError(kFALSE)) {
+    return _wgtVar->getError() ;
+  }
+  return 0 ;
+}
+
+
+
+////////////////////////////////////////////////////////////////////////////////
+
+void RooCompactDataStore::weightError(Double_t& lo, Double_t& hi, RooAbsData::ErrorType /*etype*/) const
+{
+  if (!_wgtVar) {
+    lo = 0 ;
+    hi = 0 ;
+  } else if (_wgtVar->hasAsymError()) {
+    hi = _wgtVar->getAsymErrorHi() ;
+    lo = _wgtVar->getAsymErrorLo() ;
+  } else {
+    hi = _wgtVar->getError() ;
+    lo = _wgtVar->getError() ;
+  }
+}
+
+
+
+////////////////////////////////////////////////////////////////////////////////
+/// Load values from another data store into this store, optionally
+/// selecting events using 'select' RooFormulaVar
+
+void RooCompactDataStore::loadValues(const RooAbsDataStore *ads, const RooFormulaVar* select, const char* rangeName, Int_t nStart, Int_t nStop)
+{
+  // Redirect formula servers to source data row
+  RooFormulaVar* selectClone(0) ;
+  if (select) {
+    selectClone = (RooFormulaVar*) select->cloneTree() ;
+    selectClone->recursiveRedirectServers(*ads->get()) ;
+    selectClone->setOperMode(RooAbsArg::ADirty,kTRUE) ;
+  }
+
+  // Force DS internal initialization
+  ads->get(0) ;
+
+  Int_t nevent = nStop < ads->numEntries() ? nStop : ads->numEntries() ;
+  Bool_t newWeightVar = _wgtVar ? _wgtVar->getAttribute("NewWeight") : kFALSE ;
+
+  reserve(numEntries() + (nevent - nStart));
+  for(Int_t i=nStart; i < nevent ; ++i) {
+    ads->get(i) ;
+
+    // Does this event pass the cuts?
+    if (selectClone && selectClone->getVal()==0) {
+      continue ;
+    }
+
+    _varsww.assignValueOnly(*ads->get()) ;
+    if (_wgtVar && !newWeightVar && ads->isWeighted()) {
+      _wgtVar->setVal(ads->weight()) ;
+    }
+
+    // Check that all copied values are valid
+    Bool_t allValid=kTRUE ;
+    RooFIter destIter = _varsww.fwdIterator() ;
+    RooAbsArg* arg ;
+    while((arg=destIter.next())) {
+      if (!arg->isValid() || (rangeName && !arg->inRange(rangeName))) {
+	allValid=kFALSE ;
+	break ;
+      }
+    }
+    if (!allValid) {
+      continue ;
+    }
+
+    fill() ;
+  }
+
+  delete selectClone ;
+
+  SetTitle(ads->GetTitle());
+}
+
+
+
+////////////////////////////////////////////////////////////////////////////////
+/// Load the entries of the tree, optionally selecting events using 'select'.
+/// The branches are read directly into the columns, without making an
+/// in-memory copy of the tree. Variables without a branch in the tree keep
+/// their current value. The branch addresses of the tree are reset.
+
+void RooCompactDataStore::loadValues(TTree& t, const RooFormulaVar* select)
+{
+  // Clone list of variables and attach them to the branches of the tree
+  RooArgSet *sourceArgSet = (RooArgSet*) _varsww.snapshot(kFALSE) ;
+  RooFIter sourceIter = sourceArgSet->fwdIterator() ;
+  RooAbsArg* sourceArg ;
+  while ((sourceArg=sourceIter.next())) {
+    if (!t.GetBranch(sourceArg->cleanBranchName())) {
+      coutW(InputArguments) << "RooCompactDataStore::loadValues(" << GetName() << ") WARNING: tree " << t.GetName()
+			    << " has no branch " << sourceArg->GetName() << endl ;
+      continue ;
+    }
+    sourceArg->attachToTree(t) ;
+  }
+
+  // Redirect formula servers to sourceArgSet
+  RooFormulaVar* selectClone(0) ;
+  if (select) {
+    selectClone = (RooFormulaVar*) select->cloneTree() ;
+    selectClone->recursiveRedirectServers(*sourceArgSet) ;
+    selectClone->setOperMode(RooAbsArg::ADirty,kTRUE) ;
+  }
+
+  Int_t numInvalid(0) ;
+  Long64_t nevent = t.GetEntries() ;
+  reserve(numEntries() + nevent) ;
+  for(Long64_t i=0; i < nevent; ++i) {
+    Long64_t entryNumber = t.GetEntryNumber(i) ;
+    if (entryNumber<0) break ;
+    t.GetEntry(entryNumber,1) ;
+
+    // Copy from source to destination
+    RooFIter destIter = _varsww.fwdIterator() ;
+    RooFIter srcIter = sourceArgSet->fwdIterator() ;
+    RooAbsArg* destArg ;
+    Bool_t allOK(kTRUE) ;
+    while ((destArg = destIter.next())) {
+      sourceArg = srcIter.next() ;
+      destArg->copyCache(sourceArg) ;
+      sourceArg->copyCache(destArg) ;
+      if (!destArg->isValid()) {
+	numInvalid++ ;
+	allOK=kFALSE ;
+	break ;
+      }
+    }
+
+    // Does this event pass the cuts?
+    if (!allOK || (selectClone && selectClone->getVal()==0)) {
+      continue ;
+    }
+
+    fill() ;
+  }
+
+  if (numInvalid>0) {
+    coutI(Eval) << "RooCompactDataStore::loadValues(" << GetName() << ") Ignored " << numInvalid << " out of range events" << endl ;
+  }
+
+  t.ResetBranchAddresses() ;
+  SetTitle(t.GetTitle());
+
+  delete selectClone ;
+  delete sourceArgSet ;
+}
+
+
+
+////////////////////////////////////////////////////////////////////////////////
+/// The columns follow the renaming of the variables
+
+Bool_t RooCompactDataStore::changeObservableName(const char* /*from*/, const char* /*to*/)
+{
+  return kFALSE ;
+}
+
+
+
+////////////////////////////////////////////////////////////////////////////////
+/// Add a new column to the data set which holds the pre-calculated values
+/// of 'newVar'. See RooVectorDataStore::addColumn()
+
+RooAbsArg* RooCompactDataStore::addColumn(RooAbsArg& newVar, Bool_t /*adjustRange*/)
+{
+  // Create a fundamental object of the right type to hold newVar values
+  RooAbsArg* valHolder= newVar.createFundamental();
+  // Sanity check that the holder really is fundamental
+  if(!valHolder->isFundamental()) {
+    coutE(InputArguments) << GetName() << "::addColumn: holder argument is not fundamental: \""
+	 << valHolder->GetName() << "\"" << endl;
+    return 0;
+  }
+
+  // Clone variable and attach to cloned tree
+  RooAbsArg* newVarClone = newVar.cloneTree() ;
+  newVarClone->recursiveRedirectServers(_vars,kFALSE) ;
+
+  // Attach value place holder to this store
+  _vars.add(*valHolder) ;
+  _varsww.add(*valHolder) ;
+  addArg(valHolder) ;
+
+  // Fill values of of placeholder
+  RealColumn* rc = findReal(valHolder->GetName()) ;
+  CatColumn* cc = findCategory(valHolder->GetName()) ;
+  if (rc) rc->resize(numEntries()) ;
+  if (cc) cc->resize(numEntries()) ;
+
+  for (int i=0 ; i<numEntries() ; i++) {
+    getNative(i) ;
+
+    newVarClone->syncCache(&_vars) ;
+    valHolder->copyCache(newVarClone) ;
+
+    if (rc) rc->write(i) ;
+    if (cc) cc->write(i) ;
+  }
+
+  delete newVarClone ;
+  return valHolder ;
+}
+
+
+
+////////////////////////////////////////////////////////////////////////////////
+/// Utility function to add multiple columns in one call
+/// See addColumn() for details
+
+RooArgSet* RooCompactDataStore::addColumns(const RooArgList& varList)
+{
+  RooArgSet* holderSet = new RooArgSet ;
+  RooArgSet cloneSet ;
+  TList cloneSetList ;
+
+  RooFIter vIter = varList.fwdIterator() ;
+  RooAbsArg* var ;
+  while((var=vIter.next())) {
+    // Create a fundamental object of the right type to hold newVar values
+    RooAbsArg* valHolder= var->createFundamental();
+    holderSet->add(*valHolder) ;
+
+    // Sanity check that the holder really is fundamental
+    if(!valHolder->isFundamental()) {
+      coutE(InputArguments) << GetName() << "::addColumn: holder argument is not fundamental: \""
+	   << valHolder->GetName() << "\"" << endl;
+      return 0;
+    }
+
+    // Clone variable and attach to cloned tree
+    RooArgSet* newVarCloneList = (RooArgSet*) RooArgSet(*var).snapshot() ;
+    if (!newVarCloneList) {
+      coutE(InputArguments) << "RooCompactDataStore::addColumns(" << GetName()
+			    << ") Couldn't deep-clone variable " << var->GetName() << ", abort." << endl ;
+      return 0 ;
+    }
+    RooAbsArg* newVarClone = newVarCloneList->find(var->GetName()) ;
+    newVarClone->recursiveRedirectServers(_vars,kFALSE) ;
+    newVarClone->recursiveRedirectServers(*holderSet,kFALSE) ;
+
+    cloneSetList.Add(newVarCloneList) ;
+    cloneSet.add(*newVarClone) ;
+
+    _vars.add(*valHolder) ;
+    _varsww.add(*valHolder) ;
+    addArg(valHolder) ;
+    RealColumn* rc = findReal(valHolder->GetName()) ;
+    CatColumn* cc = findCategory(valHolder->GetName()) ;
+    if (rc) rc->resize(numEntries()) ;
+    if (cc) cc->resize(numEntries()) ;
+  }
+
+  // Fill values of of placeholder
+  for (int i=0 ; i<numEntries() ; i++) {
+    getNative(i) ;
+
+    RooFIter cIter = cloneSet.fwdIterator() ;
+    RooFIter hIter = holderSet->fwdIterator() ;
+    RooAbsArg *cloneArg, *holder ;
+    while((cloneArg=cIter.next())) {
+      holder = hIter.next() ;
+
+      cloneArg->syncCache(&_vars) ;
+      holder->copyCache(cloneArg) ;
+
+      RealColumn* rc = findReal(holder->GetName()) ;
+      if (rc) {
+	rc->write(i) ;
+      } else {
+	findCategory(holder->GetName())->write(i) ;
+      }
+    }
+  }
+
+  cloneSetList.Delete() ;
+  return holderSet ;
+}
+
+
+
+////////////////////////////////////////////////////////////////////////////////
+/// Merge columns of supplied data set(s) with this data set.  All
+/// data sets must have equal number of entries.  In case of
+/// duplicate columns the column of the last dataset in the list
+/// prevails
+
+RooAbsDataStore* RooCompactDataStore::merge(const RooArgSet& allVars, list<RooAbsDataStore*> dstoreList)
+{
+  RooCompactDataStore* mergedStore = new RooCompactDataStore("merged","merged",allVars) ;
+
+  Int_t nevt = dstoreList.front()->numEntries() ;
+  mergedStore->reserve(nevt);
+  for (int i=0 ; i<nevt ; i++) {
+
+    // Copy data from self
+    mergedStore->_vars = *get(i) ;
+
+    // Copy variables from merge sets
+    for (list<RooAbsDataStore*>::iterator iter = dstoreList.begin() ; iter!=dstoreList.end() ; ++iter) {
+      const RooArgSet* partSet = (*iter)->get(i) ;
+      mergedStore->_vars = *partSet ;
+    }
+
+    mergedStore->fill() ;
+  }
+  return mergedStore ;
+}
+
+
+
+////////////////////////////////////////////////////////////////////////////////
+
+void RooCompactDataStore::append(RooAbsDataStore& other)
+{
+  Int_t nevt = other.numEntries() ;
+  reserve(nevt + numEntries());
+  for (int i=0 ; i<nevt ; i++) {
+    _vars = *other.get(i) ;
+    if (_wgtVar) {
+      _wgtVar->setVal(other.weight()) ;
+    }
+
+    fill() ;
+  }
+}
+
+
+
+////////////////////////////////////////////////////////////////////////////////
+/// Take over the values of the column of var without copying them, e.g. the
+/// values returned by RDataFrame::Take<float>(). The column is stored in single
+/// precision. The store must not have entries yet: its entries become available
+/// once all the columns have the same size. Return kFALSE if the store has no
+/// real column for var.
+
+Bool_t RooCompactDataStore::adoptColumn(const RooAbsArg& var, std::vector<Float_t>&& values)
+{
+  RealColumn* rc = findReal(var.GetName()) ;
+  if (!rc || _nEntries>0) {
+    coutE(InputArguments) << "RooCompactDataStore::adoptColumn(" << GetName() << ") ERROR: cannot adopt values of "
+			  << var.GetName() << ", the store has no such column or already has entries" << endl ;
+    return kFALSE ;
+  }
+  rc->reset() ;
+  rc->_encoding = Float ;
+  rc->_fvec.swap(values) ;
+  rc->enableErrors(kFALSE,kFALSE) ;
+  checkColumnSizes() ;
+  return kTRUE ;
+}
+
+
+
+////////////////////////////////////////////////////////////////////////////////
+/// Take over the values of the column of var without copying them. The column
+/// is stored in double precision. See adoptColumn(const RooAbsArg&, std::vector<Float_t>&&)
+
+Bool_t RooCompactDataStore::adoptColumn(const RooAbsArg& var, std::vector<Double_t>&& values)
+{
+  RealColumn* rc = findReal(var.GetName()) ;
+  if (!rc || _nEntries>0) {
+    coutE(InputArguments) << "RooCompactDataStore::adoptColumn(" << GetName() << ") ERROR: cannot adopt values of "
+			  << var.GetName() << ", the store has no such column or already has entries" << endl ;
+    return kFALSE ;
+  }
+  rc->reset() ;
+  rc->_encoding = Double ;
+  rc->_dvec.swap(values) ;
+  checkColumnSizes() ;
+  return kTRUE ;
+}
+
+
+
+////////////////////////////////////////////////////////////////////////////////
+/// Set the states of the category column of var from their index values. The
+/// indices must be valid states of the category. See adoptColumn()
+
+Bool_t RooCompactDataStore::setCategoryColumn(const RooAbsArg& var, const std::vector<Int_t>& indices)
+{
+  CatColumn* cc = findCategory(var.GetName()) ;
+  if (!cc || _nEntries>0) {
+    coutE(InputArguments) << "RooCompactDataStore::setCategoryColumn(" << GetName() << ") ERROR: cannot set states of "
+			  << var.GetName() << ", the store has no such column or already has entries" << endl ;
+    return kFALSE ;
+  }
+  cc->reset() ;
+  cc->reserve(indices.size()) ;
+  for (auto index : indices) {
+    const RooCatType* type = cc->bufArg()->lookupType(index) ;
+    if (!type) {
+      coutE(InputArguments) << "RooCompactDataStore::setCategoryColumn(" << GetName() << ") ERROR: " << index
+			    << " is not a state of " << var.GetName() << endl ;
+      cc->reset() ;
+      return kFALSE ;
+    }
+    Int_t code = cc->code(*type) ;
+    if (code<0) {
+      cc->reset() ;
+      return kFALSE ;
+    }
+    cc->_codes.push_back(code) ;
+  }
+  checkColumnSizes() ;
+  return kTRUE ;
+}
+
+
+
+////////////////////////////////////////////////////////////////////////////////
+/// Make the entries available if all the columns have the same size, and
+/// return the number of entries
+
+Int_t RooCompactDataStore::checkColumnSizes()
+{
+  Int_t n = -1 ;
+  for (auto column : _realColumns) {
+    if (n>=0 && column->size()!=n) return 0 ;
+    n = column->size() ;
+  }
+  for (auto column : _catColumns) {
+    if (n>=0 && column->size()!=n) return 0 ;
+    n = column->size() ;
+  }
+  if (n<=0) return 0 ;
+
+  // Errors are not adopted
+  for (auto column : _realColumns) column->resize(n) ;
+
+  _nEntries = n ;
+  _sumWeight = _sumWeightCarry = 0 ;
+  for (Int_t i=0 ; i<n ; i++) {
+    Double_t y = (_wgtColumn ? _wgtColumn->value(i) : 1.) - _sumWeightCarry;
+    Double_t t = _sumWeight + y;
+    _sumWeightCarry = (t - _sumWeight) - y;
+    _sumWeight = t;
+  }
+  return n ;
+}
+
+
+
+////////////////////////////////////////////////////////////////////////////////
+
+void RooCompactDataStore::reset()
+{
+  _nEntries=0 ;
+  _sumWeight=_sumWeightCarry=0 ;
+  for (auto column : _realColumns) column->reset() ;
+  for (auto column : _catColumns) column->reset() ;
+}
+
+
+
+////////////////////////////////////////////////////////////////////////////////
+/// Return the size in bytes of the stored values, excluding the cache
+
+std::size_t RooCompactDataStore::memorySize() const
+{
+  std::size_t size = 0 ;
+  for (auto column : _realColumns) size += column->memorySize() ;
+  for (auto column : _catColumns) size += column->memorySize() ;
+  return size ;
+}
+
+
+
+////////////////////////////////////////////////////////////////////////////////
+/// Cache the values of the constant expressions in newVarSet for all the
+/// entries, in double precision. The values are loaded in the cached objects
+/// by get(). Other elements are removed from newVarSet: change tracking is only
+/// available with RooVectorDataStore.
+
+void RooCompactDataStore::cacheArgs(const RooAbsArg* owner, RooArgSet& newVarSet, const RooArgSet* nset, Bool_t skipZeroWeights)
+{
+  delete _cache ;
+  _cache = 0 ;
+  _cachedVars.removeAll() ;
+
+  RooArgSet newVarSetCopy(newVarSet) ;
+  RooFIter itern = newVarSetCopy.fwdIterator() ;
+  RooAbsArg* arg ;
+  RooArgSet cacheArgSet ;
+  while((arg=itern.next())) {
+    if (arg->getAttribute("ConstantExpression")) {
+      cacheArgSet.add(*arg) ;
+    } else {
+      newVarSet.remove(*arg) ;
+    }
+  }
+
+  _cacheOwner = (RooAbsArg*) owner ;
+  RooVectorDataStore* newCache = new RooVectorDataStore("cache","cache",cacheArgSet) ;
+
+  RooAbsArg::setDirtyInhibit(kTRUE) ;
+
+  newCache->reserve(numEntries()) ;
+  for (int i=0 ; i<numEntries() ; i++) {
+    getNative(i) ;
+    if (weight()!=0 || !skipZeroWeights) {
+      RooFIter iter = cacheArgSet.fwdIterator() ;
+      while ((arg=iter.next())) {
+	arg->setValueDirty() ;
+	arg->syncCache(nset) ;
+      }
+    }
+    newCache->fill() ;
+  }
+
+  RooAbsArg::setDirtyInhibit(kFALSE) ;
+
+  _cachedVars.add(cacheArgSet) ;
+  _cache = newCache ;
+  _cache->setDirtyProp(_doDirtyProp) ;
+}
+
+
+
+////////////////////////////////////////////////////////////////////////////////
+/// Attach the cached objects to the cache of this store
+
+void RooCompactDataStore::attachCache(const RooAbsArg* newOwner, const RooArgSet& cachedVarsIn)
+{
+  if (!_cache) return ;
+
+  _cache->attachBuffers(cachedVarsIn) ;
+  _cachedVars.removeAll() ;
+  _cachedVars.add(*(RooArgSet*)cachedVarsIn.selectCommon(*_cache->get())) ;
+  _cacheOwner = (RooAbsArg*) newOwner ;
+}
+
+
+
+////////////////////////////////////////////////////////////////////////////////
+
+void RooCompactDataStore::resetCache()
+{
+  delete _cache ;
+  _cache = 0 ;
+  _cacheOwner = 0 ;
+  _cachedVars.removeAll() ;
+}
+
+
+
+////////////////////////////////////////////////////////////////////////////////
+/// Disabling of columns is not implemented, loading a column is cheap
+
+void RooCompactDataStore::setArgStatus(const RooArgSet& /*set*/, Bool_t /*active*/)
+{
+  return ;
+}
+
+
+
+////////////////////////////////////////////////////////////////////////////////
+
+void RooCompactDataStore::setDirtyProp(Bool_t flag)
+{
+  _doDirtyProp = flag ;
+  if (_cache) {
+    _cache->setDirtyProp(flag) ;
+  }
+}
+
+
+
+////////////////////////////////////////////////////////////////////////////////
+/// Load the values of the columns in the objects of extObs with the same names
+
+void RooCompactDataStore::attachBuffers(const RooArgSet& extObs)
+{
+  RooFIter iter = _varsww.fwdIterator() ;
+  RooAbsArg* arg ;
+  while((arg=iter.next())) {
+    RooAbsArg* extArg = extObs.find(arg->GetName()) ;
+    if (extArg) {
+      attachArg(*extArg) ;
+    }
+  }
+}
+
+
+
+////////////////////////////////////////////////////////////////////////////////
+/// Load the values of the columns in the variables of this store
+
+void RooCompactDataStore::resetBuffers()
+{
+  _wgtColumn = _wgtVar ? findReal(_wgtVar->GetName()) : 0 ;
+
+  RooFIter iter = _varsww.fwdIterator() ;
+  RooAbsArg* arg ;
+  while((arg=iter.next())) {
+    attachArg(*arg) ;
+  }
+}
+
+
+
+////////////////////////////////////////////////////////////////////////////////
+
+void RooCompactDataStore::dump()
+{
+  cout << "RooCompactDataStore::dump()" << endl ;
+
+  cout << "_varsww = " << endl ; _varsww.Print("v") ;
+  for (auto column : _realColumns) {
+    cout << "RealColumn " << column->bufArg()->GetName() << " encoding = " << column->encoding()
+	 << " size = " << column->memorySize() << " bytes" << endl ;
+    cout << " values : " ;
+    Int_t imax = _nEntries>10 ? 10 : _nEntries ;
+    for (Int_t i=0 ; i<imax ; i++) {
+      cout << column->value(i) << " " ;
+    }
+    cout << endl ;
+  }
+  for (auto column : _catColumns) {
+    cout << "CatColumn " << column->bufArg()->GetName() << " states = " << column->_dict.size()
+	 << " size = " << column->memorySize() << " bytes" << endl ;
+  }
+}
+
+
+
+////////////////////////////////////////////////////////////////////////////////
+/// Stream an object of class RooCompactDataStore.
+
+void RooCompactDataStore::Streamer(TBuffer &R__b)
+{
+  if (R__b.IsReading()) {
+    R__b.ReadClassBuffer(RooCompactDataStore::Class(),this);
+    resetBuffers() ;
+  } else {
+    R__b.WriteClassBuffer(RooCompactDataStore::Class(),this);
+  }
+}
+
+
+
+////////////////////////////////////////////////////////////////////////////////
+
+RooCompactDataStore::RealColumn::RealColumn() :
+  _nativeReal(0), _encoding(Double), _offset(0), _step(1), _storeError(kFALSE), _storeAsymError(kFALSE),
+  _buf(0), _bufE(0), _bufEL(0), _bufEH(0), _nativeBuf(0), _nativeBufE(0), _nativeBufEL(0), _nativeBufEH(0)
+{
+}
+
+
+
+////////////////////////////////////////////////////////////////////////////////
+
+RooCompactDataStore::RealColumn::RealColumn(RooAbsReal* real, Int_t encoding) :
+  _nativeReal(real), _encoding(encoding), _offset(0), _step(1), _storeError(kFALSE), _storeAsymError(kFALSE),
+  _buf(0), _bufE(0), _bufEL(0), _bufEH(0), _nativeBuf(0), _nativeBufE(0), _nativeBufEL(0), _nativeBufEH(0)
+{
+}
+
+
+
+////////////////////////////////////////////////////////////////////////////////
+/// Copy ctor. The buffers must be set by the store
+
+RooCompactDataStore::RealColumn::RealColumn(const RealColumn& other, RooAbsReal* real) :
+  _nativeReal(real?real:other._nativeReal), _encoding(other._encoding), _offset(other._offset), _step(other._step),
+  _dvec(other._dvec), _fvec(other._fvec), _svec(other._svec),
+  _storeError(other._storeError), _storeAsymError(other._storeAsymError),
+  _vecE(other._vecE), _vecEL(other._vecEL), _vecEH(other._vecEH),
+  _buf(0), _bufE(0), _bufEL(0), _bufEH(0), _nativeBuf(0), _nativeBufE(0), _nativeBufEL(0), _nativeBufEH(0)
+{
+}
+
+
+
+////////////////////////////////////////////////////////////////////////////////
+/// Set the buffers loaded by get(). Error buffers that are null are replaced
+/// by internal buffers.
+
+void RooCompactDataStore::RealColumn::setBuffer(Double_t* buf, Double_t* bufE, Double_t* bufEL, Double_t* bufEH)
+{
+  _buf = buf ;
+  _bufE = bufE ? bufE : &_noError[0] ;
+  _bufEL = bufEL ? bufEL : &_noError[1] ;
+  _bufEH = bufEH ? bufEH : &_noError[2] ;
+  if (!_nativeBuf) setNativeBuffer() ;
+}
+
+
+
+////////////////////////////////////////////////////////////////////////////////
+/// Use the current buffers for getNative()
+
+void RooCompactDataStore::RealColumn::setNativeBuffer()
+{
+  _nativeBuf = _buf ;
+  _nativeBufE = _bufE ;
+  _nativeBufEL = _bufEL ;
+  _nativeBufEH = _bufEH ;
+}
+
+
+
+////////////////////////////////////////////////////////////////////////////////
+/// Return the fixed-point code of value
+
+Double_t RooCompactDataStore::RealColumn::encode(Double_t value) const
+{
+  Double_t code = std::floor((value-_offset)/_step+0.5) ;
+  if (code<0) return 0 ;
+  if (code>65535) return 65535 ;
+  return code ;
+}
+
+
+
+////////////////////////////////////////////////////////////////////////////////
+/// Create the columns of (asymmetric) errors, if they don't exist yet.
+
+void RooCompactDataStore::RealColumn::enableErrors(Bool_t symError, Bool_t asymError)
+{
+  if (symError && !_storeError) {
+    _storeError = kTRUE ;
+    _vecE.assign(size(),0) ;
+  }
+  if (asymError && !_storeAsymError) {
+    _storeAsymError = kTRUE ;
+    _vecEL.assign(size(),0) ;
+    _vecEH.assign(size(),0) ;
+  }
+}
+
+
+
+////////////////////////////////////////////////////////////////////////////////
+
+void RooCompactDataStore::RealColumn::fill()
+{
+  switch (_encoding) {
+  case Float: _fvec.push_back(*_buf) ; break ;
+  case Fixed16: _svec.push_back(UShort_t(encode(*_buf))) ; break ;
+  default: _dvec.push_back(*_buf) ;
+  }
+  if (_storeError) _vecE.push_back(*_bufE) ;
+  if (_storeAsymError) {
+    _vecEL.push_back(*_bufEL) ;
+    _vecEH.push_back(*_bufEH) ;
+  }
+}
+
+
+
+////////////////////////////////////////////////////////////////////////////////
+
+void RooCompactDataStore::RealColumn::write(Int_t i)
+{
+  switch (_encoding) {
+  case Float: _fvec[i] = *_buf ; break ;
+  case Fixed16: _svec[i] = UShort_t(encode(*_buf)) ; break ;
+  default: _dvec[i] = *_buf ;
+  }
+  if (_storeError) _vecE[i] = *_bufE ;
+  if (_storeAsymError) {
+    _vecEL[i] = *_bufEL ;
+    _vecEH[i] = *_bufEH ;
+  }
+}
+
+
+
+////////////////////////////////////////////////////////////////////////////////
+/// Remove all values and release the memory
+
+void RooCompactDataStore::RealColumn::reset()
+{
+  std::vector<Double_t>().swap(_dvec) ;
+  std::vector<Float_t>().swap(_fvec) ;
+  std::vector<UShort_t>().swap(_svec) ;
+  std::vector<Float_t>().swap(_vecE) ;
+  std::vector<Float_t>().swap(_vecEL) ;
+  std::vector<Float_t>().swap(_vecEH) ;
+}
+
+
+
+////////////////////////////////////////////////////////////////////////////////
+
+void RooCompactDataStore::RealColumn::reserve(Int_t siz)
+{
+  switch (_encoding) {
+  case Float: _fvec.reserve(siz) ; break ;
+  case Fixed16: _svec.reserve(siz) ; break ;
+  default: _dvec.reserve(siz) ;
+  }
+  if (_storeError) _vecE.reserve(siz) ;
+  if (_storeAsymError) {
+    _vecEL.reserve(siz) ;
+    _vecEH.reserve(siz) ;
+  }
+}
+
+
+
+////////////////////////////////////////////////////////////////////////////////
+
+void RooCompactDataStore::RealColumn::resize(Int_t siz)
+{
+  switch (_encoding) {
+  case Float: _fvec.resize(siz) ; break ;
+  case Fixed16: _svec.resize(siz) ; break ;
+  default: _dvec.resize(siz) ;
+  }
+  if (_storeError) _vecE.resize(siz) ;
+  if (_storeAsymError) {
+    _vecEL.resize(siz) ;
+    _vecEH.resize(siz) ;
+  }
+}
+
+
+
+////////////////////////////////////////////////////////////////////////////////
+
+Int_t RooCompactDataStore::RealColumn::size() const
+{
+  switch (_encoding) {
+  case Float: return _fvec.size() ;
+  case Fixed16: return _svec.size() ;
+  default: return _dvec.size() ;
+  }
+}
+
+
+
+////////////////////////////////////////////////////////////////////////////////
+
+std::size_t RooCompactDataStore::RealColumn::memorySize() const
+{
+  return _dvec.capacity()*sizeof(Double_t) + _fvec.capacity()*sizeof(Float_t) + _svec.capacity()*sizeof(UShort_t)
+    + (_vecE.capacity() + _vecEL.capacity() + _vecEH.capacity())*sizeof(Float_t) ;
+}
+
+
+
+////////////////////////////////////////////////////////////////////////////////
+
+RooCompactDataStore::CatColumn::CatColumn() :
+  _cat(0), _buf(0), _nativeBuf(0), _last(-1)
+{
+}
+
+
+
+////////////////////////////////////////////////////////////////////////////////
+
+RooCompactDataStore::CatColumn::CatColumn(RooAbsCategory* cat) :
+  _cat(cat), _buf(0), _nativeBuf(0), _last(-1)
+{
+}
+
+
+
+////////////////////////////////////////////////////////////////////////////////
+/// Copy ctor. The buffers must be set by the store
+
+RooCompactDataStore::CatColumn::CatColumn(const CatColumn& other, RooAbsCategory* cat) :
+  _cat(cat?cat:other._cat), _dict(other._dict), _codes(other._codes), _buf(0), _nativeBuf(0), _last(-1)
+{
+}
+
+
+
+////////////////////////////////////////////////////////////////////////////////
+
+void RooCompactDataStore::CatColumn::setBuffer(RooCatType* buf)
+{
+  _buf = buf ;
+  if (!_nativeBuf) _nativeBuf = buf ;
+}
+
+
+
+////////////////////////////////////////////////////////////////////////////////
+/// Return the position of the state in the list of distinct states, adding it
+/// if needed. Return -1 if the list is full.
+
+Int_t RooCompactDataStore::CatColumn::code(const RooCatType& type)
+{
+  if (_last>=0 && _dict[_last].getVal()==type.getVal()) return _last ;
+  for (UInt_t i=0 ; i<_dict.size() ; i++) {
+    if (_dict[i].getVal()==type.getVal()) {
+      _last = i ;
+      return _last ;
+    }
+  }
+  if (_dict.size()>65535) return -1 ;
+
+  // Store the state with its label
+  const RooCatType* state = _cat ? _cat->lookupType(type.getVal()) : 0 ;
+  _dict.push_back(state ? *state : type) ;
+  _last = _dict.size()-1 ;
+  return _last ;
+}
+
+
+
+////////////////////////////////////////////////////////////////////////////////
+
+Bool_t RooCompactDataStore::CatColumn::fill()
+{
+  Int_t c = code(*_buf) ;
+  if (c<0) return kFALSE ;
+  _codes.push_back(c) ;
+  return kTRUE ;
+}
+
+
+
+////////////////////////////////////////////////////////////////////////////////
+
+Bool_t RooCompactDataStore::CatColumn::write(Int_t i)
+{
+  Int_t c = code(*_buf) ;
+  if (c<0) return kFALSE ;
+  _codes[i] = c ;
+  return kTRUE ;
+}
+
+
+
+////////////////////////////////////////////////////////////////////////////////
+/// Remove all values and release the memory
+
+void RooCompactDataStore::CatColumn::reset()
+{
+  std::vector<UShort_t>().swap(_codes) ;
+  _dict.clear() ;
+  _last = -1 ;
+}
+
+
+
+////////////////////////////////////////////////////////////////////////////////
+
+std::size_t RooCompactDataStore::CatColumn::memorySize() const
+{
+  return _codes.capacity()*sizeof(UShort_t) + _dict.capacity()*sizeof(RooCatType) ;
+}
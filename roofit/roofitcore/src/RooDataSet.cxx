@@ -49,6 +49,7 @@ or RooStringVar objects
 #include "TFile.h"
 #include "RooTreeDataStore.h"
 #include "RooVectorDataStore.h"
+#include "RooCompactDataStore.h"
 #include "RooCompositeDataStore.h"
 #include "RooTreeData.h"
 #include "RooSentinel.h"
@@ -317,15 +318,20 @@ RooDataSet::RooDataSet(const char* name, const char* title, const RooArgSet& var
     if (defaultStorageType==Tree) {
       tstore = new RooTreeDataStore(name,title,_vars,wgtVarName) ;
       _dstore = tstore ;
-    } else if (defaultStorageType==Vector) {
+    } else if (defaultStorageType==Vector || defaultStorageType==Compact) {
       if (wgtVarName && newWeight) {
 	RooAbsArg* wgttmp = _vars.find(wgtVarName) ;
 	if (wgttmp) {
 	  wgttmp->setAttribute("NewWeight") ;
 	}
       }
-      vstore = new RooVectorDataStore(name,title,_vars,wgtVarName) ;
-      _dstore = vstore ;
+      if (defaultStorageType==Vector) {
+	vstore = new RooVectorDataStore(name,title,_vars,wgtVarName) ;
+	_dstore = vstore ;
+      } else {
+	_dstore = new RooCompactDataStore(name,title,_vars,wgtVarName) ;
+	storageType = RooAbsData::Compact ;
+      }
     } else {
       _dstore = 0 ;
     }
@@ -592,8 +598,10 @@ RooDataSet::RooDataSet(const char *name, const char *title, const RooArgSet& var
   RooAbsData(name,title,vars)
 {
 //   cout << "RooDataSet::ctor(" << this << ") storageType = " << ((defaultStorageType==Tree)?"Tree":"Vector") << endl ;
-  _dstore = (defaultStorageType==Tree) ? ((RooAbsDataStore*) new RooTreeDataStore(name,title,_vars,wgtVarName)) : 
+  _dstore = (defaultStorageType==Tree) ? ((RooAbsDataStore*) new RooTreeDataStore(name,title,_vars,wgtVarName)) :
+            (defaultStorageType==Compact) ? ((RooAbsDataStore*) new RooCompactDataStore(name,title,_vars,wgtVarName)) :
                                          ((RooAbsDataStore*) new RooVectorDataStore(name,title,_vars,wgtVarName)) ;
+  if (defaultStorageType==Compact) storageType = RooAbsData::Compact ;
 
   appendToDir(this,kTRUE) ;
   initialize(wgtVarName) ;
@@ -701,6 +709,16 @@ RooDataSet::RooDataSet(const char *name, const char *title, TTree *intree,
 		       const RooArgSet& vars, const RooFormulaVar& cutVar, const char* wgtVarName) :
   RooAbsData(name,title,vars)
 {
+  // Read the tree directly into a compact datastore
+  if (defaultStorageType==Compact) {
+    _dstore = new RooCompactDataStore(name,title,_vars,*intree,&cutVar,wgtVarName) ;
+    storageType = RooAbsData::Compact ;
+    appendToDir(this,kTRUE) ;
+    initialize(wgtVarName) ;
+    TRACE_CREATE
+    return ;
+  }
+
   // Create tree version of datastore 
   RooTreeDataStore* tstore = new RooTreeDataStore(name,title,_vars,*intree,cutVar,wgtVarName) ;
 
@@ -743,6 +761,18 @@ RooDataSet::RooDataSet(const char *name, const char *title, TTree *intree,
 		       const RooArgSet& vars, const char *selExpr, const char* wgtVarName) :
   RooAbsData(name,title,vars)
 {
+  // Read the tree directly into a compact datastore
+  if (defaultStorageType==Compact) {
+    RooFormulaVar* select = (selExpr && *selExpr) ? new RooFormulaVar(selExpr,selExpr,_vars) : 0 ;
+    _dstore = new RooCompactDataStore(name,title,_vars,*intree,select,wgtVarName) ;
+    storageType = RooAbsData::Compact ;
+    delete select ;
+    appendToDir(this,kTRUE) ;
+    initialize(wgtVarName) ;
+    TRACE_CREATE
+    return ;
+  }
+
   // Create tree version of datastore 
   RooTreeDataStore* tstore = new RooTreeDataStore(name,title,_vars,*intree,selExpr,wgtVarName) ;
 
@@ -789,6 +819,9 @@ RooDataSet::RooDataSet(const char *name, const char *title, RooDataSet *dset,
       (defaultStorageType == Tree)
          ? ((RooAbsDataStore *)new RooTreeDataStore(name, title, *dset->_dstore, _vars, cutVar, cutRange, nStart, nStop,
                                                     copyCache, wgtVarName))
+         : (defaultStorageType == Compact)
+         ? ((RooAbsDataStore *)new RooCompactDataStore(name, title, *dset->_dstore, _vars, cutVar, cutRange, nStart,
+                                                       nStop, copyCache, wgtVarName))
          : (
               //     ( dset->_dstore->IsA()==RooCompositeDataStore::Class() )?
               //      ((RooAbsDataStore*) new
@@ -796,6 +829,8 @@ RooDataSet::RooDataSet(const char *name, const char *title, RooDataSet *dset,
               //      :
               ((RooAbsDataStore *)new RooVectorDataStore(name, title, *dset->_dstore, _vars, cutVar, cutRange, nStart,
                                                          nStop, copyCache, wgtVarName)));
+   if (defaultStorageType == Compact)
+      storageType = RooAbsData::Compact;
 
    _cachedVars.add(_dstore->cachedVars());
 
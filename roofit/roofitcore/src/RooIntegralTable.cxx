@@ -0,0 +1,353 @@
+/*****************************************************************************
+ * Project: RooFit                                                           *
+ * Package: RooFitCore                                                       *
+ * @(#)root/roofitcore:$Id$
+ *                                                                           *
+ * Copyright (c) 2018, CERN                                                  *
+ *                                                                           *
+ * Redistribution and use in source and binary forms,                        *
+ * with or without modification, are permitted according to the terms        *
+ * listed in LICENSE (http://roofit.sourceforge.net/license.txt)             *
+ *****************************************************************************/
+
+/**
+\file RooIntegralTable.cxx
+\class RooIntegralTable
+\ingroup Roofitcore
+
+RooIntegralTable is an adaptive table of the values of a function of a few
+real-valued parameters, used by RooRealIntegral to tabulate numeric integrals
+as a function of the parameters of the integrand.
+
+The ranges of the parameters are divided in a base grid of cells, whose
+nodes are tabulated by fill(). When a value is requested in a cell, the exact
+value at the centre of the cell is compared with the multi-linear
+interpolation of the values at its corners. If they agree within the required
+relative precision, the values in the cell are interpolated from then on.
+Otherwise the cell is split in 2^n sub-cells, which are tested in the same
+way when they are used, up to a maximum number of splittings. Cells that are
+not precise enough at the maximum depth are not interpolated: the exact
+function is evaluated for each value requested in them.
+
+The nodes are shared between neighbouring cells and levels, and are only
+computed when needed. The table can be persisted, e.g. as part of the
+expensive object cache of a RooWorkspace.
+**/
+
+#include "RooFit.h"
+#include "RooIntegralTable.h"
+#include "RooAbsCollection.h"
+#include "RooAbsRealLValue.h"
+#include "RooMsgService.h"
+
+#include "Riostream.h"
+#include <cmath>
+
+using namespace std ;
+
+ClassImp(RooIntegralTable);
+
+
+
+////////////////////////////////////////////////////////////////////////////////
+/// Default constructor
+
+RooIntegralTable::RooIntegralTable() :
+  _nBins(0),
+  _maxDepth(0),
+  _precision(0),
+  _nLattice(0),
+  _valid(kFALSE),
+  _nExact(0)
+{
+}
+
+
+
+////////////////////////////////////////////////////////////////////////////////
+/// Construct a table over the ranges of the real-valued lvalues in params,
+/// with a base grid of nBins cells per parameter. The cells can be split
+/// maxDepth times, until the interpolation at their centre is within the
+/// given relative precision.
+
+RooIntegralTable::RooIntegralTable(const char* name, const RooAbsCollection& params, Int_t nBins, Int_t maxDepth, Double_t precision) :
+  TNamed(name,name),
+  _nBins(nBins),
+  _maxDepth(maxDepth),
+  _precision(precision),
+  _nLattice(0),
+  _valid(kFALSE),
+  _nExact(0)
+{
+  RooFIter iter = params.fwdIterator() ;
+  RooAbsArg* arg ;
+  while((arg=iter.next())) {
+    RooAbsRealLValue* lvalue = dynamic_cast<RooAbsRealLValue*>(arg) ;
+    if (!lvalue || !lvalue->hasMin() || !lvalue->hasMax()) {
+      coutE(InputArguments) << "RooIntegralTable::ctor(" << GetName() << ") ERROR: parameter " << arg->GetName()
+			    << " is not a real-valued lvalue with a finite range" << endl ;
+      return ;
+    }
+    _names.push_back(arg->GetName()) ;
+    _lo.push_back(lvalue->getMin()) ;
+    _hi.push_back(lvalue->getMax()) ;
+  }
+
+  if (_names.empty() || nBins<1 || maxDepth<0 || maxDepth>14) {
+    coutE(InputArguments) << "RooIntegralTable::ctor(" << GetName() << ") ERROR: invalid table settings" << endl ;
+    return ;
+  }
+
+  // The finest lattice holds the centres of the smallest cells
+  _nLattice = Long64_t(nBins) << (maxDepth+1) ;
+
+  // Check that the keys of the nodes and cells fit in 62 bits
+  if (_names.size()*log2(_nLattice+1.) + 4 > 62) {
+    coutE(InputArguments) << "RooIntegralTable::ctor(" << GetName() << ") ERROR: too many parameters or grid points for a table" << endl ;
+    return ;
+  }
+
+  _x.resize(_names.size()) ;
+  _valid = kTRUE ;
+}
+
+
+
+////////////////////////////////////////////////////////////////////////////////
+/// Copy constructor
+
+RooIntegralTable::RooIntegralTable(const RooIntegralTable& other) :
+  TNamed(other),
+  _names(other._names),
+  _lo(other._lo),
+  _hi(other._hi),
+  _nBins(other._nBins),
+  _maxDepth(other._maxDepth),
+  _precision(other._precision),
+  _nLattice(other._nLattice),
+  _valid(other._valid),
+  _nodes(other._nodes),
+  _cells(other._cells),
+  _x(other._x),
+  _nExact(0)
+{
+}
+
+
+
+////////////////////////////////////////////////////////////////////////////////
+/// Return true if the table was made for parameters with the same names and
+/// ranges as params, and the same settings
+
+Bool_t RooIntegralTable::matches(const RooAbsCollection& params, Int_t nBins, Int_t maxDepth, Double_t precision) const
+{
+  if (!_valid || nBins!=_nBins || maxDepth!=_maxDepth || precision!=_precision) return kFALSE ;
+  if ((Int_t)_names.size()!=params.getSize()) return kFALSE ;
+
+  RooFIter iter = params.fwdIterator() ;
+  RooAbsArg* arg ;
+  Int_t i(0) ;
+  while((arg=iter.next())) {
+    RooAbsRealLValue* lvalue = dynamic_cast<RooAbsRealLValue*>(arg) ;
+    if (!lvalue || _names[i]!=arg->GetName() || _lo[i]!=lvalue->getMin() || _hi[i]!=lvalue->getMax()) {
+      return kFALSE ;
+    }
+    i++ ;
+  }
+  return kTRUE ;
+}
+
+
+
+////////////////////////////////////////////////////////////////////////////////
+/// Return the key of the node at the given lattice coordinates
+
+Long64_t RooIntegralTable::nodeKey(const Long64_t* c) const
+{
+  Long64_t key(0) ;
+  for (Int_t i=_names.size()-1 ; i>=0 ; i--) {
+    key = key*(_nLattice+1) + c[i] ;
+  }
+  return key ;
+}
+
+
+
+////////////////////////////////////////////////////////////////////////////////
+/// Return the value at the given lattice coordinates, evaluating func if it
+/// is not tabulated yet
+
+Double_t RooIntegralTable::node(const Long64_t* c, const Function& func)
+{
+  Long64_t key = nodeKey(c) ;
+  auto iter = _nodes.find(key) ;
+  if (iter!=_nodes.end()) return iter->second ;
+
+  if (_x.size()!=_names.size()) _x.resize(_names.size()) ;
+  for (UInt_t i=0 ; i<_names.size() ; i++) {
+    _x[i] = _lo[i] + (_hi[i]-_lo[i])*c[i]/_nLattice ;
+  }
+  Double_t val = func(&_x[0]) ;
+  _nodes[key] = val ;
+  return val ;
+}
+
+
+
+////////////////////////////////////////////////////////////////////////////////
+/// Tabulate the function at the nodes of the base grid
+
+void RooIntegralTable::fill(const Function& func)
+{
+  if (!_valid) return ;
+
+  UInt_t n = _names.size() ;
+  Long64_t step = _nLattice/_nBins ;
+  vector<Long64_t> c(n,0) ;
+  while (true) {
+    node(&c[0],func) ;
+
+    // Next node of the base grid
+    UInt_t i(0) ;
+    while (i<n && c[i]==_nLattice) {
+      c[i] = 0 ;
+      i++ ;
+    }
+    if (i==n) break ;
+    c[i] += step ;
+  }
+}
+
+
+
+////////////////////////////////////////////////////////////////////////////////
+/// Compare the interpolation at the centre of a cell with the exact value,
+/// and return the status of the cell
+
+Int_t RooIntegralTable::testCell(const Long64_t* c, Long64_t size, Int_t depth, const Function& func)
+{
+  UInt_t n = _names.size() ;
+  vector<Long64_t> corner(n) ;
+
+  // The multi-linear interpolation at the centre is the mean of the corners
+  Double_t mean(0) ;
+  for (UInt_t mask=0 ; mask<(1u<<n) ; mask++) {
+    for (UInt_t i=0 ; i<n ; i++) {
+      corner[i] = c[i] + ((mask>>i)&1 ? size : 0) ;
+    }
+    mean += node(&corner[0],func) ;
+  }
+  mean /= (1u<<n) ;
+
+  for (UInt_t i=0 ; i<n ; i++) {
+    corner[i] = c[i] + size/2 ;
+  }
+  Double_t centre = node(&corner[0],func) ;
+
+  if (fabs(mean-centre) <= _precision*fabs(centre)) {
+    return Accepted ;
+  }
+  return depth<_maxDepth ? Split : Exact ;
+}
+
+
+
+////////////////////////////////////////////////////////////////////////////////
+/// Multi-linear interpolation in the cell at the lattice coordinates u
+
+Double_t RooIntegralTable::interpolate(const Long64_t* c, Long64_t size, const Double_t* u, const Function& func)
+{
+  UInt_t n = _names.size() ;
+  vector<Long64_t> corner(n) ;
+
+  Double_t ret(0) ;
+  for (UInt_t mask=0 ; mask<(1u<<n) ; mask++) {
+    Double_t w(1) ;
+    for (UInt_t i=0 ; i<n ; i++) {
+      Double_t t = (u[i]-c[i])/size ;
+      if ((mask>>i)&1) {
+	corner[i] = c[i] + size ;
+	w *= t ;
+      } else {
+	corner[i] = c[i] ;
+	w *= 1-t ;
+      }
+    }
+    if (w!=0) ret += w*node(&corner[0],func) ;
+  }
+  return ret ;
+}
+
+
+
+////////////////////////////////////////////////////////////////////////////////
+/// Return the value at the parameter values x. The value is interpolated if
+/// the cell containing x is precise enough, and evaluated with func otherwise.
+/// The cells are refined as needed.
+
+Double_t RooIntegralTable::value(const Double_t* x, const Function& func)
+{
+  if (!_valid) return func(x) ;
+
+  UInt_t n = _names.size() ;
+  vector<Double_t> u(n) ;
+  for (UInt_t i=0 ; i<n ; i++) {
+    u[i] = (x[i]-_lo[i])/(_hi[i]-_lo[i])*_nLattice ;
+    if (!(u[i]>=0 && u[i]<=_nLattice)) {
+      // Outside of the table
+      _nExact++ ;
+      return func(x) ;
+    }
+  }
+
+  // Find the base cell
+  Long64_t size = _nLattice/_nBins ;
+  vector<Long64_t> c(n) ;
+  for (UInt_t i=0 ; i<n ; i++) {
+    Long64_t bin = Long64_t(u[i]/size) ;
+    if (bin>=_nBins) bin = _nBins-1 ;
+    c[i] = bin*size ;
+  }
+
+  // Descend to the cell that is precise enough
+  Int_t depth(0) ;
+  while (true) {
+    Long64_t key = cellKey(&c[0],depth) ;
+    auto iter = _cells.find(key) ;
+    Int_t status ;
+    if (iter==_cells.end()) {
+      status = testCell(&c[0],size,depth,func) ;
+      _cells[key] = status ;
+    } else {
+      status = iter->second ;
+    }
+
+    if (status==Accepted) {
+      return interpolate(&c[0],size,&u[0],func) ;
+    } else if (status==Exact) {
+      _nExact++ ;
+      return func(x) ;
+    }
+
+    size /= 2 ;
+    depth++ ;
+    for (UInt_t i=0 ; i<n ; i++) {
+      if (u[i] >= c[i]+size) c[i] += size ;
+    }
+  }
+}
+
+
+
+////////////////////////////////////////////////////////////////////////////////
+/// Print the parameters and the size of the table
+
+void RooIntegralTable::Print(Option_t* /*options*/) const
+{
+  cout << "RooIntegralTable " << GetName() << " of " ;
+  for (UInt_t i=0 ; i<_names.size() ; i++) {
+    cout << (i?", ":"") << _names[i] << " [" << _lo[i] << "," << _hi[i] << "]" ;
+  }
+  cout << endl << "  " << _nBins << " bins per parameter, " << _maxDepth << " refinements, relative precision " << _precision
+       << endl << "  " << _nodes.size() << " nodes, " << _cells.size() << " cells, " << _nExact << " values outside the table" << endl ;
+}
@@ -59,6 +59,7 @@ automatic PDF optimization.
 #include "RooAbsReal.h"
 #include "RooAbsRealLValue.h"
 #include "RooRealVar.h"
+#include "RooRealIntegral.h"
 #include "RooAbsPdf.h"
 #include "RooSentinel.h"
 #include "RooMsgService.h"
@@ -384,10 +385,17 @@ Int_t RooMinimizer::hesse()
     RooAbsReal::setEvalErrorLoggingMode(RooAbsReal::CollectErrors) ;
     RooAbsReal::clearEvalErrorLog() ;
 
+    // The second derivatives need the exact values of tabulated integrals
+    Bool_t tabSuspended = RooRealIntegral::suspendTabulation(kTRUE) ;
+    setFloatParamsDirty() ;
+
     _theFitter->Config().SetMinimizer(_minimizerType.c_str());
     bool ret = _theFitter->CalculateHessErrors();
     _status = ((ret) ? _theFitter->Result().Status() : -1);
 
+    RooRealIntegral::suspendTabulation(tabSuspended) ;
+    setFloatParamsDirty() ;
+
     RooAbsReal::setEvalErrorLoggingMode(RooAbsReal::PrintErrors) ;
     profileStop() ;
     _fcn->BackProp(_theFitter->Result());
@@ -819,6 +827,22 @@ void RooMinimizer::profileStop()
 
 
 
+////////////////////////////////////////////////////////////////////////////////
+/// Force the re-evaluation of the function at the current parameter values,
+/// e.g. after a global change of the way integrals are computed
+
+void RooMinimizer::setFloatParamsDirty()
+{
+  RooAbsArg::registerConfigChange() ;
+  RooFIter iter = _fcn->GetFloatParamList()->fwdIterator() ;
+  RooAbsArg* arg ;
+  while((arg=iter.next())) {
+    arg->setValueDirty() ;
+  }
+}
+
+
+
 
 
 ////////////////////////////////////////////////////////////////////////////////
@@ -43,6 +43,8 @@ In extended mode, a (Nexpect - Nobserved*log(NExpected) term is added
 #include "RooRealSumPdf.h"
 #include "RooRealVar.h"
 #include "RooProdPdf.h"
+#include "RooDataSet.h"
+#include "RooVectorDataStore.h"
 
 ClassImp(RooNLLVar);
 ;
@@ -96,6 +98,7 @@ RooNLLVar::RooNLLVar(const char *name, const char* title, RooAbsPdf& pdf, RooAbs
   _offsetCarrySaveW2 = 0.;
 
   _binnedPdf = 0 ;
+  _batchEvaluations = kFALSE ;
 }
 
 
@@ -110,7 +113,8 @@ RooNLLVar::RooNLLVar(const char *name, const char *title, RooAbsPdf& pdf, RooAbs
   RooAbsOptTestStatistic(name,title,pdf,indata,RooArgSet(),rangeName,addCoefRangeName,nCPU,interleave,verbose,splitRange,cloneData),
   _extended(extended),
   _weightSq(kFALSE),
-  _first(kTRUE), _offsetSaveW2(0.), _offsetCarrySaveW2(0.)
+  _first(kTRUE), _offsetSaveW2(0.), _offsetCarrySaveW2(0.),
+  _batchEvaluations(kFALSE)
 {
   // If binned likelihood flag is set, pdf is a RooRealSumPdf representing a yield vector
   // for a binned likelihood calculation
@@ -155,7 +159,8 @@ RooNLLVar::RooNLLVar(const char *name, const char *title, RooAbsPdf& pdf, RooAbs
   RooAbsOptTestStatistic(name,title,pdf,indata,projDeps,rangeName,addCoefRangeName,nCPU,interleave,verbose,splitRange,cloneData),
   _extended(extended),
   _weightSq(kFALSE),
-  _first(kTRUE), _offsetSaveW2(0.), _offsetCarrySaveW2(0.)
+  _first(kTRUE), _offsetSaveW2(0.), _offsetCarrySaveW2(0.),
+  _batchEvaluations(kFALSE)
 {
   // If binned likelihood flag is set, pdf is a RooRealSumPdf representing a yield vector
   // for a binned likelihood calculation
@@ -196,7 +201,8 @@ RooNLLVar::RooNLLVar(const RooNLLVar& other, const char* name) :
   _weightSq(other._weightSq),
   _first(kTRUE), _offsetSaveW2(other._offsetSaveW2),
   _offsetCarrySaveW2(other._offsetCarrySaveW2),
-  _binw(other._binw) {
+  _binw(other._binw),
+  _batchEvaluations(other._batchEvaluations) {
   _binnedPdf = other._binnedPdf ? (RooRealSumPdf*)_funcClone : 0 ;
 }
 
@@ -223,6 +229,9 @@ void RooNLLVar::applyWeightSquared(Bool_t flag)
       std::swap(_offset, _offsetSaveW2);
       std::swap(_offsetCarry, _offsetCarrySaveW2);
     }
+    for (Int_t i=0 ; i<_nWorkers ; i++)
+      ((RooNLLVar*)_workerArray[i])->applyWeightSquared(flag);
+    clearStateCache();
     setValueDirty();
   } else if ( _gofOpMode==MPMaster) {
     for (Int_t i=0 ; i<_nCPU ; i++)
@@ -235,6 +244,100 @@ void RooNLLVar::applyWeightSquared(Bool_t flag)
 
 
 
+////////////////////////////////////////////////////////////////////////////////
+/// Enable or disable the evaluation of the p.d.f for batches of events of
+/// unbinned datasets (see RooAbsReal::getValBatch()). The p.d.f.s implementing
+/// RooAbsReal::evaluateBatch() then compute the likelihood terms of many events
+/// in one go, reading the observables directly from the dataset. With NumCPU(),
+/// the flag must be set before the first evaluation of the likelihood.
+
+void RooNLLVar::batchMode(Bool_t flag)
+{
+  _batchEvaluations = flag ;
+  if (_gofOpMode==SimMaster) {
+    for (Int_t i=0 ; i<_nGof ; i++) {
+      if (_gofArray[i]) ((RooNLLVar*)_gofArray[i])->batchMode(flag) ;
+    }
+  }
+  for (Int_t i=0 ; i<_nWorkers ; i++) {
+    ((RooNLLVar*)_workerArray[i])->batchMode(flag) ;
+  }
+  clearStateCache() ;
+  setValueDirty() ;
+}
+
+
+
+////////////////////////////////////////////////////////////////////////////////
+/// Calculate the likelihood terms of the events from firstEvent to lastEvent
+/// with the batch evaluation interface of the p.d.f, and add them and the
+/// event weights to the given Kahan sums. Return kFALSE without computing
+/// anything if the dataset does not support batch evaluations.
+
+Bool_t RooNLLVar::evaluateBatches(Int_t firstEvent, Int_t lastEvent, Double_t& result, Double_t& carry,
+				  Double_t& sumWeight, Double_t& sumWeightCarry) const
+{
+  RooDataSet* data = dynamic_cast<RooDataSet*>(_dataClone) ;
+  RooVectorDataStore* store = data ? dynamic_cast<RooVectorDataStore*>(data->store()) : 0 ;
+  if (!store || !store->attachBatchInputs()) return kFALSE ;
+
+  RooAbsPdf* pdfClone = (RooAbsPdf*) _funcClone ;
+
+  // Events are processed in batches small enough for the intermediate results to stay in cache
+  const Int_t maxBatchSize(4096) ;
+
+  for (Int_t begin=firstEvent ; begin<lastEvent ; begin+=maxBatchSize) {
+
+    const std::size_t batchSize = std::min(lastEvent-begin,maxBatchSize) ;
+    RooSpan<const double> prob = pdfClone->getValBatch(begin,batchSize,_normSet) ;
+    RooSpan<const double> weights = store->getWeightBatch(begin,batchSize) ;
+    const std::size_t mask = prob.size()>1 ? ~static_cast<std::size_t>(0) : 0 ;
+
+    for (std::size_t i=0 ; i<batchSize ; i++) {
+
+      Double_t eventWeight = weights.empty() ? 1. : weights[i] ;
+      if (0. == eventWeight * eventWeight) continue ;
+      if (_weightSq) eventWeight = eventWeight*eventWeight ;
+
+      // Same treatment of invalid values as in RooAbsPdf::getLogVal()
+      const Double_t p = prob[i & mask] ;
+      Double_t logProb ;
+      if (p>0 && p<=1e6) {
+	logProb = log(p) ;
+      } else if (p<0) {
+	pdfClone->logEvalError("getLogVal() top-level p.d.f evaluates to a negative number") ;
+	logProb = 0 ;
+      } else if (p==0) {
+	pdfClone->logEvalError("getLogVal() top-level p.d.f evaluates to zero") ;
+	logProb = log((double)0) ;
+      } else if (TMath::IsNaN(p)) {
+	pdfClone->logEvalError("getLogVal() top-level p.d.f evaluates to NaN") ;
+	logProb = log((double)0) ;
+      } else {
+	coutW(Eval) << "RooAbsPdf::getLogVal(" << pdfClone->GetName() << ") WARNING: large likelihood value: " << p << std::endl ;
+	logProb = log(p) ;
+      }
+
+      Double_t term = -eventWeight * logProb ;
+
+      Double_t y = eventWeight - sumWeightCarry;
+      Double_t t = sumWeight + y;
+      sumWeightCarry = (t - sumWeight) - y;
+      sumWeight = t;
+
+      y = term - carry;
+      t = result + y;
+      carry = (t - result) - y;
+      result = t;
+    }
+  }
+
+  store->attachBatchInputs(kFALSE) ;
+  return kTRUE ;
+}
+
+
+
 ////////////////////////////////////////////////////////////////////////////////
 /// Calculate and return likelihood on subset of data from firstEvent to lastEvent
 /// processed with a step size of 'stepSize'. If this an extended likelihood and
@@ -306,28 +409,32 @@ Double_t RooNLLVar::evaluatePartition(Int_t firstEvent, Int_t lastEvent, Int_t s
 
   } else {
 
-    for (i=firstEvent ; i<lastEvent ; i+=stepSize) {
+    if (!_batchEvaluations || stepSize!=1 ||
+	!evaluateBatches(firstEvent,lastEvent,result,carry,sumWeight,sumWeightCarry)) {
 
-      _dataClone->get(i) ;
+      for (i=firstEvent ; i<lastEvent ; i+=stepSize) {
 
-      if (!_dataClone->valid()) continue;
+	_dataClone->get(i) ;
 
-      Double_t eventWeight = _dataClone->weight();
-      if (0. == eventWeight * eventWeight) continue ;
-      if (_weightSq) eventWeight = _dataClone->weightSquared() ;
+	if (!_dataClone->valid()) continue;
 
-      Double_t term = -eventWeight * pdfClone->getLogVal(_normSet);
+	Double_t eventWeight = _dataClone->weight();
+	if (0. == eventWeight * eventWeight) continue ;
+	if (_weightSq) eventWeight = _dataClone->weightSquared() ;
 
+	Double_t term = -eventWeight * pdfClone->getLogVal(_normSet);
 
-      Double_t y = eventWeight - sumWeightCarry;
-      Double_t t = sumWeight + y;
-      sumWeightCarry = (t - sumWeight) - y;
-      sumWeight = t;
 
-      y = term - carry;
-      t = result + y;
-      carry = (t - result) - y;
-      result = t;
+	Double_t y = eventWeight - sumWeightCarry;
+	Double_t t = sumWeight + y;
+	sumWeightCarry = (t - sumWeight) - y;
+	sumWeight = t;
+
+	y = term - carry;
+	t = result + y;
+	carry = (t - result) - y;
+	result = t;
+      }
     }
 
     // include the extended maximum likelihood term, if requested
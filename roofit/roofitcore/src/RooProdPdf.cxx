@@ -57,6 +57,7 @@ have to appear in any specific place in the list.
 #include "RooCustomizer.h"
 #include "RooRealIntegral.h"
 #include "RooTrace.h"
+#include "BatchHelpers.h"
 
 #include <cstring>
 #include <sstream>
@@ -495,6 +496,76 @@ Double_t RooProdPdf::evaluate() const
 
 
 
+////////////////////////////////////////////////////////////////////////////////
+/// Return the values of the product for a batch of entries, see RooAbsReal::getValBatch()
+
+RooSpan<const double> RooProdPdf::getValBatch(std::size_t begin, std::size_t batchSize, const RooArgSet* normSet) const
+{
+  _curNormSet = (RooArgSet*)normSet ;
+  return RooAbsPdf::getValBatch(begin,batchSize,normSet) ;
+}
+
+
+
+////////////////////////////////////////////////////////////////////////////////
+/// Calculate the product for a batch of entries, see evaluate() and calculate().
+/// The terms are multiplied one after the other into the output.
+
+RooSpan<double> RooProdPdf::evaluateBatch(std::size_t begin, std::size_t batchSize) const
+{
+  using namespace BatchHelpers ;
+
+  Int_t code ;
+  CacheElem* cache = (CacheElem*) _cacheMgr.getObj(_curNormSet,0,&code) ;
+
+  // If cache doesn't have our configuration, recalculate here
+  if (!cache) {
+    RooArgList *plist(0) ;
+    RooLinkedList *nlist(0) ;
+    getPartIntList(_curNormSet,0,plist,nlist,code) ;
+    cache = (CacheElem*) _cacheMgr.getObj(_curNormSet,0,&code) ;
+  }
+
+  RooSpan<double> output = makeBatch(batchSize) ;
+
+  if (cache->_isRearranged) {
+    BracketAdapterWithMask num(cache->_rearrangedNum->getValBatch(begin,batchSize)) ;
+    for (std::size_t i=0 ; i<batchSize ; ++i) {
+      output[i] = num[i] ;
+    }
+    BracketAdapterWithMask den(cache->_rearrangedDen->getValBatch(begin,batchSize)) ;
+    for (std::size_t i=0 ; i<batchSize ; ++i) {
+      output[i] /= den[i] ;
+    }
+    return output ;
+  }
+
+  for (std::size_t i=0 ; i<batchSize ; ++i) {
+    output[i] = 1.0 ;
+  }
+
+  // An entry is not multiplied by the next terms once its value is below the cut-off,
+  // as in calculate()
+  RooAbsReal* partInt;
+  RooArgSet* normSet;
+  RooFIter plIter = cache->_partList.fwdIterator();
+  RooFIter nlIter = cache->_normList.fwdIterator();
+  for (partInt = (RooAbsReal*) plIter.next(),
+	 normSet = (RooArgSet*) nlIter.next(); partInt && normSet;
+       partInt = (RooAbsReal*) plIter.next(),
+	 normSet = (RooArgSet*) nlIter.next()) {
+    RooSpan<const double> piVal = partInt->getValBatch(begin,batchSize,normSet->getSize() > 0 ? normSet : 0) ;
+    BracketAdapterWithMask piValues(piVal) ;
+    for (std::size_t i=0 ; i<batchSize ; ++i) {
+      output[i] = output[i] > _cutOff ? output[i]*piValues[i] : output[i] ;
+    }
+  }
+
+  return output ;
+}
+
+
+
 ////////////////////////////////////////////////////////////////////////////////
 /// Calculate running product of pdfs terms, using the supplied
 /// normalization set in 'normSetList' for each component
@@ -49,8 +49,12 @@ integration is performed in the various implemenations of the RooAbsIntegrator b
 #include "RooExpensiveObjectCache.h"
 #include "RooConstVar.h"
 #include "RooDouble.h"
+#include "RooIntegralTable.h"
+#include "RooRealVar.h"
 #include "RooTrace.h"
 
+#include <mutex>
+
 using namespace std;
 
 ClassImp(RooRealIntegral); 
@@ -58,6 +62,17 @@ ClassImp(RooRealIntegral);
 
 
 Int_t RooRealIntegral::_cacheAllNDim(2) ;
+Bool_t RooRealIntegral::_tabulateAll(kFALSE) ;
+Int_t RooRealIntegral::_tabNBins(4) ;
+Int_t RooRealIntegral::_tabMaxDepth(5) ;
+Double_t RooRealIntegral::_tabPrecision(1e-5) ;
+Int_t RooRealIntegral::_tabMaxDim(3) ;
+Bool_t RooRealIntegral::_tabSuspended(kFALSE) ;
+
+namespace {
+  // Filling a table may evaluate other tabulated integrals, hence recursive
+  std::recursive_mutex& tableMutex() { static std::recursive_mutex mutex ; return mutex ; }
+}
 
 
 ////////////////////////////////////////////////////////////////////////////////
@@ -75,7 +90,11 @@ RooRealIntegral::RooRealIntegral() :
   _numIntegrand(0),
   _rangeName(0),
   _params(0),
-  _cacheNum(kFALSE)
+  _cacheNum(kFALSE),
+  _tabulateNum(kFALSE),
+  _tabLeaves(0),
+  _tabNodes(0),
+  _tabFill(kFALSE)
 {
   _facListIter = _facList.createIterator() ;
   _jacListIter = _jacList.createIterator() ;
@@ -119,7 +138,11 @@ RooRealIntegral::RooRealIntegral(const char *name, const char *title,
   _numIntegrand(0),
   _rangeName((TNamed*)RooNameReg::ptr(rangeName)),
   _params(0),
-  _cacheNum(kFALSE)
+  _cacheNum(kFALSE),
+  _tabulateNum(kFALSE),
+  _tabLeaves(0),
+  _tabNodes(0),
+  _tabFill(kFALSE)
 {
   //   A) Check that all dependents are lvalues 
   //
@@ -776,7 +799,11 @@ RooRealIntegral::RooRealIntegral(const RooRealIntegral& other, const char* name)
   _numIntegrand(0),
   _rangeName(other._rangeName),
   _params(0),
-  _cacheNum(kFALSE)
+  _cacheNum(kFALSE),
+  _tabulateNum(other._tabulateNum),
+  _tabLeaves(0),
+  _tabNodes(0),
+  _tabFill(kFALSE)
 {
  _funcNormSet = other._funcNormSet ? (RooArgSet*)other._funcNormSet->snapshot(kFALSE) : 0 ;
 
@@ -809,6 +836,8 @@ RooRealIntegral::~RooRealIntegral()
   delete _jacListIter ;
   if (_sumCatIter)  delete _sumCatIter ;
   if (_params) delete _params ;
+  delete _tabLeaves ;
+  delete _tabNodes ;
 
   TRACE_DESTROY
 }
@@ -900,6 +929,11 @@ Double_t RooRealIntegral::evaluate() const
     
   case Hybrid: 
     {      
+      // Interpolate numeric integrals tabulated in the parameters
+      if ((_tabulateNum || _tabulateAll) && !_tabSuspended && !_tabFill && _intList.getSize()>0 && tabulatedValue(retVal)) {
+        break ;
+      }
+
       // Cache numeric integrals in >1d expensive object cache
       RooDouble* cacheVal(0) ;
       if ((_cacheNum && _intList.getSize()>0) || _intList.getSize()>=_cacheAllNDim) {
@@ -1008,6 +1042,129 @@ Double_t RooRealIntegral::evaluate() const
 
 
 
+////////////////////////////////////////////////////////////////////////////////
+/// Compute the numeric integral by interpolation in a RooIntegralTable of its
+/// values as a function of the floating parameters of the integrand. The
+/// table is kept in the expensive object cache, and is valid for the current
+/// values of the other parameters. It is created on first use, tabulating
+/// the integral on a grid over the ranges of the floating parameters, and
+/// refined where the interpolation is not precise enough. The exact values
+/// are computed on a private copy of the integral and its servers, so that
+/// the parameters shared with other (possibly concurrent) evaluations are
+/// never modified.
+/// Return false if the integral cannot be tabulated, i.e. if a floating
+/// parameter has no finite range or if there are too many floating parameters.
+
+Bool_t RooRealIntegral::tabulatedValue(Double_t& retVal) const
+{
+  if (!_tabLeaves) {
+    _tabLeaves = _function.arg().getParameters(intVars()) ;
+  }
+
+  // Tabulate in the floating parameters, which must all have a finite range
+  RooArgList tabParams ;
+  RooArgSet fixParams ;
+  RooFIter iter = _tabLeaves->fwdIterator() ;
+  RooAbsArg* arg ;
+  while((arg=iter.next())) {
+    RooRealVar* var = dynamic_cast<RooRealVar*>(arg) ;
+    if (var && !var->isConstant()) {
+      if (!var->hasMin() || !var->hasMax()) {
+        return kFALSE ;
+      }
+      tabParams.add(*var) ;
+    } else {
+      fixParams.add(*arg) ;
+    }
+  }
+  Int_t n = tabParams.getSize() ;
+  if (n==0 || n>_tabMaxDim) {
+    return kFALSE ;
+  }
+
+  // The tables in the cache are shared by all evaluations
+  std::lock_guard<std::recursive_mutex> lock(tableMutex()) ;
+
+  // Private copy of the integral, synchronized with the current parameters
+  if (!_tabNodes) {
+    _tabNodes = (RooArgSet*) RooArgSet(*this).snapshot(kTRUE) ;
+    if (!_tabNodes) {
+      return kFALSE ;
+    }
+  }
+  RooRealIntegral* clone = (RooRealIntegral*) _tabNodes->find(GetName()) ;
+  clone->_tabFill = kTRUE ;
+  _tabNodes->assignValueOnly(*_tabLeaves) ;
+
+  std::vector<RooRealVar*> cloneParams(n) ;
+  std::vector<Double_t> paramVals(n) ;
+  for (Int_t i=0 ; i<n ; i++) {
+    RooRealVar& var = (RooRealVar&) tabParams[i] ;
+    cloneParams[i] = (RooRealVar*) _tabNodes->find(var.GetName()) ;
+    cloneParams[i]->setRange(var.getMin(),var.getMax()) ;
+    paramVals[i] = var.getVal() ;
+  }
+
+  if(!(clone->_valid = clone->initNumIntegrator())) {
+    return kFALSE ;
+  }
+
+  auto integral = [&](const Double_t* x) {
+    for (Int_t i=0 ; i<n ; i++) {
+      cloneParams[i]->setVal(x[i]) ;
+    }
+    return clone->numericValue() ;
+  } ;
+
+  TString tabName = Form("%s_table",GetName()) ;
+  RooIntegralTable* table = (RooIntegralTable*) expensiveObjectCache().retrieveObject(tabName,RooIntegralTable::Class(),fixParams) ;
+  if (!table || !table->matches(tabParams,_tabNBins,_tabMaxDepth,_tabPrecision)) {
+    coutI(Integration) << "RooRealIntegral::tabulatedValue(" << GetName() << ") tabulating integral in " << tabParams << endl ;
+    table = new RooIntegralTable(tabName,tabParams,_tabNBins,_tabMaxDepth,_tabPrecision) ;
+    if (table->isValid()) {
+      table->fill(integral) ;
+      expensiveObjectCache().registerObject(_function.arg().GetName(),tabName,*table,fixParams) ;
+    } else {
+      delete table ;
+      return kFALSE ;
+    }
+  }
+
+  retVal = table->value(&paramVals[0],integral) ;
+  return kTRUE ;
+}
+
+
+
+////////////////////////////////////////////////////////////////////////////////
+/// Compute the numeric sum/integral at the current values of the parameters,
+/// leaving the integration variables unchanged. The numeric integrator must
+/// have been initialized.
+
+Double_t RooRealIntegral::numericValue() const
+{
+  // Find any function dependents that are AClean
+  // and switch them temporarily to ADirty
+  Bool_t origState = inhibitDirty() ;
+  setDirtyInhibit(kTRUE) ;
+
+  // Save current integral dependent values
+  _saveInt = _intList ;
+  _saveSum = _sumList ;
+
+  Double_t retVal = sum() ;
+
+  // This must happen BEFORE restoring dependents, otherwise no dirty state propagation in restore step
+  setDirtyInhibit(origState) ;
+
+  _intList=_saveInt ;
+  _sumList=_saveSum ;
+
+  return retVal ;
+}
+
+
+
 ////////////////////////////////////////////////////////////////////////////////
 /// Return product of jacobian terms originating from analytical integration
 
@@ -1096,6 +1253,14 @@ Bool_t RooRealIntegral::redirectServersHook(const RooAbsCollection& /*newServerL
     delete _params ;
     _params = 0 ;
   }
+  if (_tabLeaves) {
+    delete _tabLeaves ;
+    _tabLeaves = 0 ;
+  }
+  if (_tabNodes) {
+    delete _tabNodes ;
+    _tabNodes = 0 ;
+  }
 
   return kFALSE ;
 }
@@ -1244,3 +1409,51 @@ Int_t RooRealIntegral::getCacheAllNumeric()
 }
 
 
+
+
+////////////////////////////////////////////////////////////////////////////////
+/// Global switch to tabulate all numeric integrals in the floating parameters
+/// of their integrand, see setTabulationConfig(). Integrals are tabulated
+/// if all their floating parameters have a finite range.
+
+void RooRealIntegral::setTabulateAllNumeric(Bool_t flag) {
+  _tabulateAll = flag ;
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+/// Return true if all numeric integrals are tabulated
+
+Bool_t RooRealIntegral::getTabulateAllNumeric()
+{
+  return _tabulateAll ;
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+/// Configure the tables of numeric integrals. The range of each floating
+/// parameter is divided in nBins bins. The cells of this grid are split up to
+/// maxDepth times, until the linear interpolation of the integral is within
+/// the given relative precision. Integrals with more than maxDim floating
+/// parameters are not tabulated.
+
+void RooRealIntegral::setTabulationConfig(Int_t nBins, Int_t maxDepth, Double_t precision, Int_t maxDim)
+{
+  _tabNBins = nBins ;
+  _tabMaxDepth = maxDepth ;
+  _tabPrecision = precision ;
+  _tabMaxDim = maxDim ;
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+/// Temporarily compute all tabulated integrals exactly, e.g. while the
+/// second derivatives of a likelihood are computed by HESSE, for which the
+/// interpolation is not smooth enough. Return the previous setting.
+
+Bool_t RooRealIntegral::suspendTabulation(Bool_t flag)
+{
+  Bool_t old = _tabSuspended ;
+  _tabSuspended = flag ;
+  return old ;
+}
@@ -49,6 +49,7 @@ In the present version \f$coef_i\f$ may not depend on x, but this limitation may
 #include "RooRealIntegral.h"
 #include "RooMsgService.h"
 #include "RooNameReg.h"
+#include "BatchHelpers.h"
 
 #include <algorithm>
 #include <memory>
@@ -278,6 +279,74 @@ Double_t RooRealSumPdf::evaluate() const
 
 
 
+////////////////////////////////////////////////////////////////////////////////
+/// Calculate the sum of the functions for a batch of entries, see evaluate().
+/// The coefficients must be constant in the batch, otherwise the entries are
+/// evaluated one by one.
+
+RooSpan<double> RooRealSumPdf::evaluateBatch(std::size_t begin, std::size_t batchSize) const
+{
+  using namespace BatchHelpers ;
+
+  RooSpan<double> output = makeBatch(batchSize) ;
+  for (std::size_t j=0 ; j<batchSize ; ++j) {
+    output[j] = 0 ;
+  }
+
+  // Do running sum of coef/func pairs, calculate lastCoef.
+  RooFIter funcIter = _funcList.fwdIterator() ;
+  RooFIter coefIter = _coefList.fwdIterator() ;
+  RooAbsReal* coef ;
+  RooAbsReal* func ;
+
+  // N funcs, N-1 coefficients
+  Double_t lastCoef(1) ;
+  while((coef=(RooAbsReal*)coefIter.next())) {
+    func = (RooAbsReal*)funcIter.next() ;
+    RooSpan<const double> coefBatch = coef->getValBatch(begin,batchSize) ;
+    if (isBatch(coefBatch)) return RooSpan<double>() ;
+    const Double_t coefVal = coefBatch[0] ;
+    if (coefVal) {
+      if (func->isSelectedComp()) {
+	BracketAdapterWithMask funcVal(func->getValBatch(begin,batchSize)) ;
+	for (std::size_t j=0 ; j<batchSize ; ++j) {
+	  output[j] += funcVal[j]*coefVal ;
+	}
+      }
+      lastCoef -= coefVal ;
+    }
+  }
+
+  if (!_haveLastCoef) {
+    // Add last func with correct coefficient
+    func = (RooAbsReal*) funcIter.next() ;
+    if (func->isSelectedComp()) {
+      BracketAdapterWithMask funcVal(func->getValBatch(begin,batchSize)) ;
+      for (std::size_t j=0 ; j<batchSize ; ++j) {
+	output[j] += funcVal[j]*lastCoef ;
+      }
+    }
+
+    // Warn about coefficient degeneration
+    if (lastCoef<0 || lastCoef>1) {
+      coutW(Eval) << "RooRealSumPdf::evaluate(" << GetName()
+		  << " WARNING: sum of FUNC coefficients not in range [0-1], value="
+		  << 1-lastCoef << endl ;
+    }
+  }
+
+  // Introduce floor if so requested
+  if (_doFloor || _doFloorGlobal) {
+    for (std::size_t j=0 ; j<batchSize ; ++j) {
+      if (output[j]<0) output[j] = 0 ;
+    }
+  }
+
+  return output ;
+}
+
+
+
 ////////////////////////////////////////////////////////////////////////////////
 /// Check if FUNC is valid for given normalization set.
 /// Coeffient and FUNC must be non-overlapping, but func-coefficient 
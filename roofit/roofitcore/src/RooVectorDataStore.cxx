@@ -805,6 +805,9 @@ void RooVectorDataStore::loadValues(const RooAbsDataStore *ads, const RooFormula
       }
     } else {
       _varsww.assignValueOnly(*ads->get()) ;
+      if (_wgtVar && !newWeightVar && ads->isWeighted()) {
+	_wgtVar->setVal(ads->weight()) ;
+      }
     }
 
     destIter->Reset() ;
@@ -1468,6 +1471,69 @@ void RooVectorDataStore::resetBuffers()
 
 
 
+////////////////////////////////////////////////////////////////////////////////
+/// Make the columns of real values of this store, including the columns cached
+/// by the constant term optimizer, available to the objects attached to them
+/// for batch evaluations (see RooAbsReal::getValBatch()). The objects then
+/// read their values for a range of entries directly from the columns.
+/// Return kFALSE and attach nothing if the store contains categories, whose
+/// values cannot be evaluated in batches. With attach=kFALSE, detach the
+/// columns again.
+
+Bool_t RooVectorDataStore::attachBatchInputs(Bool_t attach)
+{
+  if (attach) {
+    for (const RooVectorDataStore* store = this ; store ; store = store->_cache) {
+      if (store->_nCat>0) return kFALSE ;
+    }
+  }
+
+  for (RooVectorDataStore* store = this ; store ; store = store->_cache) {
+    for (Int_t i=0 ; i<store->_nReal ; i++) {
+      RealVector* rv = store->_firstReal[i] ;
+      if (!rv->_real || (_wgtVar && rv->bufArg()->namePtr()==_wgtVar->namePtr())) continue ;
+      rv->_real->_batchInput = attach ? rv->_vec0 : 0 ;
+    }
+    for (Int_t i=0 ; i<store->_nRealF ; i++) {
+      RealFullVector* rfv = store->_firstRealF[i] ;
+      if (!rfv->_real || (_wgtVar && rfv->bufArg()->namePtr()==_wgtVar->namePtr())) continue ;
+      rfv->_real->_batchInput = attach ? rfv->_vec0 : 0 ;
+    }
+  }
+
+  return kTRUE ;
+}
+
+
+
+////////////////////////////////////////////////////////////////////////////////
+/// Return the weights of the entries [first, first+batchSize), or an empty
+/// span if the store is not weighted.
+
+RooSpan<const double> RooVectorDataStore::getWeightBatch(std::size_t first, std::size_t batchSize) const
+{
+  if (_extWgtArray) {
+    return RooSpan<const double>(_extWgtArray+first,batchSize) ;
+  }
+
+  if (_wgtVar) {
+    for (Int_t i=0 ; i<_nReal ; i++) {
+      if (_firstReal[i]->bufArg()->namePtr()==_wgtVar->namePtr()) {
+	return RooSpan<const double>(_firstReal[i]->_vec0+first,batchSize) ;
+      }
+    }
+    for (Int_t i=0 ; i<_nRealF ; i++) {
+      if (_firstRealF[i]->bufArg()->namePtr()==_wgtVar->namePtr()) {
+	return RooSpan<const double>(_firstRealF[i]->_vec0+first,batchSize) ;
+      }
+    }
+  }
+
+  return RooSpan<const double>() ;
+}
+
+
+
 ////////////////////////////////////////////////////////////////////////////////
 
 void RooVectorDataStore::dump()
@@ -0,0 +1,140 @@
+// Tests of datasets with a RooCompactDataStore against datasets with a RooVectorDataStore
+
+#include "RooCategory.h"
+#include "RooCompactDataStore.h"
+#include "RooDataSet.h"
+#include "RooGlobalFunc.h"
+#include "RooRealVar.h"
+#include "RooVectorDataStore.h"
+#include "TTree.h"
+
+#include "gtest/gtest.h"
+
+#include <memory>
+#include <random>
+
+class CompactDataStore : public ::testing::Test {
+protected:
+   CompactDataStore()
+      : fX("x", "x", -5, 5), fY("y", "y", 0, 1), fW("w", "w", 0, 10), fCat("cat", "cat"),
+        fDefault(RooAbsData::getDefaultStorageType())
+   {
+      fCat.defineType("a");
+      fCat.defineType("b", 4);
+      fCat.defineType("c", 7);
+      // x and the weights are stored in single precision (the default encoding): they
+      // are filled with values which have an exact single precision representation
+      fY.setStringAttribute("StorageEncoding", "Double");
+   }
+
+   ~CompactDataStore() { RooAbsData::setDefaultStorageType(fDefault); }
+
+   // fill the same pseudo-random entries in a dataset
+   void Fill(RooDataSet &data, bool weighted)
+   {
+      std::mt19937 gen(42);
+      std::uniform_real_distribution<double> uniform(0, 1);
+      const char *states[] = {"a", "b", "c"};
+      for (int i = 0; i < kNEntries; ++i) {
+         fX.setVal(float(-5 + 10 * uniform(gen)));
+         fY.setVal(uniform(gen));
+         fCat.setLabel(states[gen() % 3]);
+         const double weight = float(0.5 + 2 * uniform(gen));
+         if (weighted)
+            data.add(RooArgSet(fX, fY, fCat), weight);
+         else
+            data.add(RooArgSet(fX, fY, fCat));
+      }
+   }
+
+   // convert a compact dataset to a vector store, and compare it with the reference
+   void ExpectConvertedEqual(RooAbsData &compact, const RooAbsData &reference)
+   {
+      ASSERT_NE(dynamic_cast<RooCompactDataStore *>(compact.store()), nullptr);
+      compact.convertToVectorStore();
+      ASSERT_NE(dynamic_cast<RooVectorDataStore *>(compact.store()), nullptr);
+
+      ASSERT_EQ(compact.numEntries(), reference.numEntries());
+      EXPECT_EQ(compact.isWeighted(), reference.isWeighted());
+      EXPECT_DOUBLE_EQ(compact.sumEntries(), reference.sumEntries());
+      for (int i = 0; i < reference.numEntries(); ++i) {
+         const RooArgSet *row = compact.get(i);
+         const double weight = compact.weight();
+         const RooArgSet *refRow = reference.get(i);
+         EXPECT_EQ(row->getRealValue("x"), refRow->getRealValue("x")) << i;
+         EXPECT_EQ(row->getRealValue("y"), refRow->getRealValue("y")) << i;
+         EXPECT_EQ(row->getCatIndex("cat"), refRow->getCatIndex("cat")) << i;
+         EXPECT_EQ(weight, reference.weight()) << i;
+      }
+   }
+
+   static const int kNEntries = 1000;
+
+   RooRealVar fX;
+   RooRealVar fY;
+   RooRealVar fW;
+   RooCategory fCat;
+   RooAbsData::StorageType fDefault;
+};
+
+TEST_F(CompactDataStore, ConvertToVectorStore)
+{
+   RooAbsData::setDefaultStorageType(RooAbsData::Vector);
+   RooDataSet reference("reference", "reference", RooArgSet(fX, fY, fCat));
+   Fill(reference, false);
+
+   RooAbsData::setDefaultStorageType(RooAbsData::Compact);
+   RooDataSet compact("compact", "compact", RooArgSet(fX, fY, fCat));
+   Fill(compact, false);
+   ExpectConvertedEqual(compact, reference);
+}
+
+TEST_F(CompactDataStore, ConvertWeighted)
+{
+   RooAbsData::setDefaultStorageType(RooAbsData::Vector);
+   RooDataSet reference("reference", "reference", RooArgSet(fX, fY, fCat, fW), RooFit::WeightVar(fW));
+   Fill(reference, true);
+   std::unique_ptr<RooAbsData> reducedReference(reference.reduce("x>0"));
+
+   RooAbsData::setDefaultStorageType(RooAbsData::Compact);
+   RooDataSet compact("compact", "compact", RooArgSet(fX, fY, fCat, fW), RooFit::WeightVar(fW));
+   Fill(compact, true);
+   ASSERT_TRUE(compact.isWeighted());
+
+   // a reduced compact dataset is compact too
+   std::unique_ptr<RooAbsData> reduced(compact.reduce("x>0"));
+   ExpectConvertedEqual(*reduced, *reducedReference);
+
+   ExpectConvertedEqual(compact, reference);
+}
+
+TEST_F(CompactDataStore, ConvertFromTree)
+{
+   TTree tree("tree", "tree");
+   double x, y;
+   tree.Branch("x", &x);
+   tree.Branch("y", &y);
+   std::mt19937 gen(42);
+   std::uniform_real_distribution<double> uniform(0, 1);
+   for (int i = 0; i < kNEntries; ++i) {
+      x = float(-5 + 10 * uniform(gen));
+      y = uniform(gen);
+      tree.Fill();
+   }
+
+   RooAbsData::setDefaultStorageType(RooAbsData::Vector);
+   RooDataSet reference("reference", "reference", &tree, RooArgSet(fX, fY), "y<0.5");
+
+   RooAbsData::setDefaultStorageType(RooAbsData::Compact);
+   RooDataSet compact("compact", "compact", &tree, RooArgSet(fX, fY), "y<0.5");
+   ASSERT_NE(dynamic_cast<RooCompactDataStore *>(compact.store()), nullptr);
+   compact.convertToVectorStore();
+   ASSERT_NE(dynamic_cast<RooVectorDataStore *>(compact.store()), nullptr);
+   ASSERT_EQ(compact.numEntries(), reference.numEntries());
+   for (int i = 0; i < reference.numEntries(); ++i) {
+      const double cx = compact.get(i)->getRealValue("x");
+      const double cy = compact.get(i)->getRealValue("y");
+      EXPECT_EQ(cx, reference.get(i)->getRealValue("x")) << i;
+      EXPECT_EQ(cy, reference.get(i)->getRealValue("y")) << i;
+   }
+}
@@ -0,0 +1,84 @@
+// Tests of numeric integrals tabulated in their parameters against the direct numeric integration
+
+#include "RooArgSet.h"
+#include "RooGenericPdf.h"
+#include "RooMsgService.h"
+#include "RooNumber.h"
+#include "RooRealIntegral.h"
+#include "RooRealVar.h"
+
+#include "gtest/gtest.h"
+
+#include <memory>
+
+class IntegralTable : public ::testing::Test {
+protected:
+   IntegralTable()
+      : fX("x", "x", -5, 5), fSigma("sigma", "sigma", 1, 0.5, 2), fA("a", "a", 0.5, 0, 1),
+        fPdf("pdf", "pdf", "exp(-0.5*x*x/(sigma*sigma))*(1+a*x*x)", RooArgSet(fX, fSigma, fA))
+   {
+      RooMsgService::instance().setGlobalKillBelow(RooFit::WARNING);
+   }
+
+   ~IntegralTable() { RooRealIntegral::suspendTabulation(kFALSE); }
+
+   // integral over x, tabulated in the floating parameters or not
+   std::unique_ptr<RooRealIntegral> Integral(RooAbsReal &func, bool tabulate)
+   {
+      std::unique_ptr<RooRealIntegral> integral(static_cast<RooRealIntegral *>(func.createIntegral(fX)));
+      integral->setTabulateNumeric(tabulate);
+      return integral;
+   }
+
+   RooRealVar fX;
+   RooRealVar fSigma;
+   RooRealVar fA;
+   RooGenericPdf fPdf;
+};
+
+TEST_F(IntegralTable, InsideAndAtEdges)
+{
+   auto tabulated = Integral(fPdf, true);
+   auto direct = Integral(fPdf, false);
+
+   const double sigmas[] = {0.5, 0.61, 1.0, 1.37, 1.9, 2.0};
+   const double as[] = {0.0, 0.13, 0.5, 0.77, 1.0};
+   for (double sigma : sigmas) {
+      for (double a : as) {
+         fSigma.setVal(sigma);
+         fA.setVal(a);
+         const double exact = direct->getVal();
+         EXPECT_NEAR(tabulated->getVal(), exact, 1e-4 * exact) << "sigma = " << sigma << ", a = " << a;
+         // the parameters are not changed by the tabulation
+         EXPECT_EQ(fSigma.getVal(), sigma);
+         EXPECT_EQ(fA.getVal(), a);
+         EXPECT_DOUBLE_EQ(direct->getVal(), exact);
+      }
+   }
+}
+
+TEST_F(IntegralTable, Suspended)
+{
+   auto tabulated = Integral(fPdf, true);
+   auto direct = Integral(fPdf, false);
+
+   fSigma.setVal(1.23);
+   tabulated->getVal();
+   RooRealIntegral::suspendTabulation(kTRUE);
+   fSigma.setVal(1.24);
+   EXPECT_DOUBLE_EQ(tabulated->getVal(), direct->getVal());
+}
+
+TEST_F(IntegralTable, UnboundedParameter)
+{
+   // with a floating parameter without range, the integral is computed directly
+   RooRealVar b("b", "b", 1, -RooNumber::infinity(), RooNumber::infinity());
+   RooGenericPdf pdf("pdfb", "pdfb", "exp(-0.5*x*x/(sigma*sigma))*(1+a*x*x+b*b*x*x*x*x)", RooArgSet(fX, fSigma, fA, b));
+   auto tabulated = Integral(pdf, true);
+   auto direct = Integral(pdf, false);
+
+   for (double value : {0.1, 0.3, 2.5}) {
+      b.setVal(value);
+      EXPECT_DOUBLE_EQ(tabulated->getVal(), direct->getVal());
+   }
+}
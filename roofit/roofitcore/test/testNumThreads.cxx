@@ -0,0 +1,164 @@
+// Tests of the multi-threaded calculation of test statistics against the single-threaded one
+
+#include "RooAddPdf.h"
+#include "RooCategory.h"
+#include "RooDataHist.h"
+#include "RooDataSet.h"
+#include "RooExponential.h"
+#include "RooFitResult.h"
+#include "RooGaussian.h"
+#include "RooGlobalFunc.h"
+#include "RooMsgService.h"
+#include "RooRandom.h"
+#include "RooRealVar.h"
+#include "RooSimultaneous.h"
+
+#include "gtest/gtest.h"
+
+#include <cmath>
+#include <memory>
+
+using namespace RooFit;
+
+// Sum of a Gaussian signal and an exponential background, with the data generated from it
+class TestStatisticThreads : public ::testing::Test {
+protected:
+   TestStatisticThreads()
+      : fX("x", "x", 0, 10), fMean("mean", "mean", 5, 2, 8), fSigma("sigma", "sigma", 0.7, 0.1, 2),
+        fGauss("gauss", "gauss", fX, fMean, fSigma), fC("c", "c", -0.3, -2, -0.01), fExpo("expo", "expo", fX, fC),
+        fFrac("frac", "frac", 0.3, 0, 1), fPdf("pdf", "pdf", fGauss, fExpo, fFrac)
+   {
+      RooMsgService::instance().setGlobalKillBelow(RooFit::WARNING);
+      RooRandom::randomGenerator()->SetSeed(4357);
+      fData.reset(fPdf.generate(fX, 20000));
+      fX.setBins(50);
+      fHist.reset(fData->binnedClone());
+   }
+
+   // move the parameters away from the generated values
+   void ShiftParameters()
+   {
+      fMean.setVal(5.3);
+      fSigma.setVal(0.9);
+      fC.setVal(-0.25);
+      fFrac.setVal(0.35);
+   }
+
+   void ExpectSameValues(RooAbsReal &serial, RooAbsReal &parallel)
+   {
+      EXPECT_NEAR(serial.getVal(), parallel.getVal(), 1e-10 * std::abs(serial.getVal()));
+      ShiftParameters();
+      EXPECT_NEAR(serial.getVal(), parallel.getVal(), 1e-10 * std::abs(serial.getVal()));
+   }
+
+   RooRealVar fX;
+   RooRealVar fMean;
+   RooRealVar fSigma;
+   RooGaussian fGauss;
+   RooRealVar fC;
+   RooExponential fExpo;
+   RooRealVar fFrac;
+   RooAddPdf fPdf;
+   std::unique_ptr<RooDataSet> fData;
+   std::unique_ptr<RooDataHist> fHist;
+};
+
+TEST_F(TestStatisticThreads, UnbinnedNLL)
+{
+   std::unique_ptr<RooAbsReal> nll(fPdf.createNLL(*fData, NumThreads(1)));
+   std::unique_ptr<RooAbsReal> nllThreads(fPdf.createNLL(*fData, NumThreads(4)));
+   ExpectSameValues(*nll, *nllThreads);
+}
+
+TEST_F(TestStatisticThreads, BinnedNLL)
+{
+   std::unique_ptr<RooAbsReal> nll(fPdf.createNLL(*fHist, NumThreads(1)));
+   std::unique_ptr<RooAbsReal> nllThreads(fPdf.createNLL(*fHist, NumThreads(4)));
+   ExpectSameValues(*nll, *nllThreads);
+}
+
+TEST_F(TestStatisticThreads, Chi2)
+{
+   std::unique_ptr<RooAbsReal> chi2(fPdf.createChi2(*fHist, NumThreads(1)));
+   std::unique_ptr<RooAbsReal> chi2Threads(fPdf.createChi2(*fHist, NumThreads(4)));
+   ExpectSameValues(*chi2, *chi2Threads);
+}
+
+TEST_F(TestStatisticThreads, Fit)
+{
+   ShiftParameters();
+   std::unique_ptr<RooArgSet> params(fPdf.getParameters(fX));
+   std::unique_ptr<RooArgSet> start(static_cast<RooArgSet *>(params->snapshot()));
+
+   std::unique_ptr<RooFitResult> result(fPdf.fitTo(*fData, Save(), PrintLevel(-1), NumThreads(1)));
+   *params = *start;
+   std::unique_ptr<RooFitResult> resultThreads(fPdf.fitTo(*fData, Save(), PrintLevel(-1), NumThreads(4)));
+   ASSERT_NE(result, nullptr);
+   ASSERT_NE(resultThreads, nullptr);
+   EXPECT_EQ(result->status(), 0);
+   EXPECT_EQ(resultThreads->status(), 0);
+   EXPECT_NEAR(result->minNll(), resultThreads->minNll(), 1e-9 * std::abs(result->minNll()));
+
+   RooFIter iter = result->floatParsFinal().fwdIterator();
+   while (RooAbsArg *param = iter.next()) {
+      auto var = static_cast<RooRealVar *>(param);
+      auto varThreads = static_cast<RooRealVar *>(resultThreads->floatParsFinal().find(var->GetName()));
+      ASSERT_NE(varThreads, nullptr);
+      EXPECT_NEAR(var->getVal(), varThreads->getVal(), 1e-3 * var->getError()) << var->GetName();
+      EXPECT_NEAR(var->getError(), varThreads->getError(), 1e-3 * var->getError()) << var->GetName();
+   }
+}
+
+// Only the channels depending on a changed parameter are recalculated, each of them in
+// parallel partitions in multi-threaded mode. The result must not depend on it, and must
+// not use stale values
+TEST(SimultaneousThreads, ChangedChannel)
+{
+   RooMsgService::instance().setGlobalKillBelow(RooFit::WARNING);
+   RooRandom::randomGenerator()->SetSeed(4357);
+
+   RooRealVar x("x", "x", -10, 10);
+   RooRealVar sigma("sigma", "sigma", 2, 0.1, 5);
+   RooRealVar meanA("meanA", "meanA", -1, -5, 5);
+   RooRealVar meanB("meanB", "meanB", 0.5, -5, 5);
+   RooRealVar meanC("meanC", "meanC", 2, -5, 5);
+   RooGaussian gaussA("gaussA", "gaussA", x, meanA, sigma);
+   RooGaussian gaussB("gaussB", "gaussB", x, meanB, sigma);
+   RooGaussian gaussC("gaussC", "gaussC", x, meanC, sigma);
+   std::unique_ptr<RooDataSet> dataA(gaussA.generate(x, 10000));
+   std::unique_ptr<RooDataSet> dataB(gaussB.generate(x, 4000));
+   std::unique_ptr<RooDataSet> dataC(gaussC.generate(x, 1000));
+
+   RooCategory channel("channel", "channel");
+   channel.defineType("A");
+   channel.defineType("B");
+   channel.defineType("C");
+   RooDataSet data("data", "data", x, Index(channel), Import("A", *dataA), Import("B", *dataB), Import("C", *dataC));
+   RooSimultaneous pdf("pdf", "pdf", channel);
+   pdf.addPdf(gaussA, "A");
+   pdf.addPdf(gaussB, "B");
+   pdf.addPdf(gaussC, "C");
+
+   std::unique_ptr<RooAbsReal> nll(pdf.createNLL(data, NumThreads(1)));
+   std::unique_ptr<RooAbsReal> nllThreads(pdf.createNLL(data, NumThreads(3)));
+   const double initial = nll->getVal();
+   EXPECT_NEAR(initial, nllThreads->getVal(), 1e-10 * std::abs(initial));
+
+   meanB.setVal(0.7);
+   std::unique_ptr<RooAbsReal> nllFresh(pdf.createNLL(data));
+   const double changed = nllFresh->getVal();
+   EXPECT_NE(initial, changed);
+   EXPECT_NEAR(changed, nll->getVal(), 1e-10 * std::abs(changed));
+   EXPECT_NEAR(changed, nllThreads->getVal(), 1e-10 * std::abs(changed));
+
+   sigma.setVal(2.1);
+   std::unique_ptr<RooAbsReal> nllFresh2(pdf.createNLL(data));
+   EXPECT_NEAR(nllFresh2->getVal(), nll->getVal(), 1e-10 * std::abs(changed));
+   EXPECT_NEAR(nllFresh2->getVal(), nllThreads->getVal(), 1e-10 * std::abs(changed));
+
+   // going back to a previous state
+   sigma.setVal(2);
+   meanB.setVal(0.5);
+   EXPECT_NEAR(initial, nll->getVal(), 1e-10 * std::abs(initial));
+   EXPECT_NEAR(initial, nllThreads->getVal(), 1e-10 * std::abs(initial));
+}
@@ -84,6 +84,7 @@ class ToyMCSampler: public TestStatSampler {
       virtual SamplingDistribution* GetSamplingDistribution(RooArgSet& paramPoint);
       virtual RooDataSet* GetSamplingDistributions(RooArgSet& paramPoint);
       virtual RooDataSet* GetSamplingDistributionsSingleWorker(RooArgSet& paramPoint);
+      virtual RooDataSet* GetSamplingDistributionsMultiProc(RooArgSet& paramPoint);
 
       virtual SamplingDistribution* AppendSamplingDistribution(
          RooArgSet& allParameters,
@@ -232,6 +233,17 @@ class ToyMCSampler: public TestStatSampler {
       // calling with argument or NULL deactivates proof
       void SetProofConfig(ProofConfig *pc = NULL) { fProofConfig = pc; }
 
+      // run the toys in nWorkers forked processes (nWorkers <= 1 deactivates it).
+      // Ignored when a ProofConfig is given.
+      void SetNWorkers(Int_t nWorkers) { fNWorkers = nWorkers; }
+      Int_t GetNWorkers() const { return fNWorkers; }
+
+      // seed the random generator before each toy from the given seed and the
+      // index of the toy, so that the toys do not depend on the number of
+      // workers (seed = 0 deactivates it)
+      void SetToySeed(UInt_t seed) { fToySeed = seed; fToyIndex = 0; }
+      UInt_t GetToySeed() const { return fToySeed; }
+
       void SetProtoData(const RooDataSet* d) { fProtoData = d; }
 
    protected:
@@ -277,6 +289,9 @@ class ToyMCSampler: public TestStatSampler {
       const RooDataSet *fProtoData; // in dev
 
       ProofConfig *fProofConfig;   //!
+      Int_t fNWorkers;             //! number of forked workers
+      UInt_t fToySeed;             //! seed for the per-toy seeding (0 = off)
+      Long64_t fToyIndex;          //! index of the next toy for the per-toy seeding
 
       mutable NuisanceParametersSampler *fNuisanceParametersSampler; //!
 
@@ -28,6 +28,19 @@ TestStatistic.
 For parallel runs, ToyMCSampler can be given an instance of ProofConfig
 and then run in parallel using proof or proof-lite. Internally, it uses
 ToyMCStudy with the RooStudyManager.
+
+Alternatively, the toys can be run on the local machine in forked processes
+with SetNWorkers(). Each worker works on a copy of the model made by the fork
+and runs a contiguous range of toys; the sampling distributions are sent back
+to the main process and merged in memory. The random generator is seeded
+before each toy from the seed given with SetToySeed() (or a seed drawn from
+RooRandom::randomGenerator()) and the index of the toy, therefore the toys
+do not depend on the number of workers:
+~~~ {.cpp}
+   ToyMCSampler *sampler = (ToyMCSampler *)calc.GetTestStatSampler();
+   sampler->SetNWorkers(8);
+   sampler->SetToySeed(1234);
+~~~
 */
 
 #include "RooStats/ToyMCSampler.h"
@@ -51,6 +64,11 @@ ToyMCStudy with the RooStudyManager.
 
 #include "TMath.h"
 
+#ifndef R__WIN32
+#include "ROOT/TProcessExecutor.hxx"
+#endif
+
+#include <algorithm>
 
 using namespace RooFit;
 using namespace std;
@@ -58,6 +76,25 @@ using namespace std;
 
 ClassImp(RooStats::ToyMCSampler);
 
+namespace {
+
+////////////////////////////////////////////////////////////////////////////////
+/// Seed of the random generator for a toy: the base seed and the index of the
+/// toy are mixed (splitmix64) so that neighbouring toys get unrelated seeds.
+/// Never returns 0, which would make TRandom3 use a time-dependent seed.
+
+UInt_t ToySeed(UInt_t seed, Long64_t toy)
+{
+   ULong64_t z = ((ULong64_t)seed << 32) + (ULong64_t)toy + 0x9E3779B97F4A7C15ULL;
+   z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+   z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+   z = z ^ (z >> 31);
+   UInt_t result = (UInt_t)(z ^ (z >> 32));
+   return result ? result : 1;
+}
+
+}
+
 namespace RooStats {
 
 ////////////////////////////////////////////////////////////////////////////////
@@ -176,6 +213,9 @@ ToyMCSampler::ToyMCSampler() : fSamplingDistName("SD"), fNToys(1)
    fProtoData = NULL;
 
    fProofConfig = NULL;
+   fNWorkers = 1;
+   fToySeed = 0;
+   fToyIndex = 0;
    fNuisanceParametersSampler = NULL;
 
    _allVars = NULL ;
@@ -216,6 +256,9 @@ ToyMCSampler::ToyMCSampler(TestStatistic &ts, Int_t ntoys) : fSamplingDistName(t
    fProtoData = NULL;
 
    fProofConfig = NULL;
+   fNWorkers = 1;
+   fToySeed = 0;
+   fToyIndex = 0;
    fNuisanceParametersSampler = NULL;
 
    _allVars = NULL ;
@@ -328,8 +371,10 @@ RooDataSet* ToyMCSampler::GetSamplingDistributions(RooArgSet& paramPointIn)
 {
 
    // ======= S I N G L E   R U N ? =======
-   if(!fProofConfig)
+   if(!fProofConfig) {
+      if (fNWorkers > 1) return GetSamplingDistributionsMultiProc(paramPointIn);
       return GetSamplingDistributionsSingleWorker(paramPointIn);
+   }
 
    // ======= P A R A L L E L   R U N =======
    if (!CheckConfig()){
@@ -371,6 +416,98 @@ RooDataSet* ToyMCSampler::GetSamplingDistributions(RooArgSet& paramPointIn)
    return output;
 }
 
+////////////////////////////////////////////////////////////////////////////////
+/// Run the toys in fNWorkers forked processes. This is called automatically
+/// from inside GetSamplingDistributions when SetNWorkers() was given more than
+/// one worker and no ProofConfig.
+///
+/// Each worker runs GetSamplingDistributionsSingleWorker for a contiguous range
+/// of toys on its own copy of the model. The toys are seeded individually (see
+/// SetToySeed()), so the result does not depend on the number of workers. When
+/// no toy seed is set, a new one is drawn from RooRandom::randomGenerator() at
+/// each call. The sampling distributions of the workers are merged in the order
+/// of the toys.
+
+RooDataSet* ToyMCSampler::GetSamplingDistributionsMultiProc(RooArgSet& paramPointIn)
+{
+#ifdef R__WIN32
+   oocoutW((TObject*)NULL, InputArguments)
+      << "ToyMCSampler: running the toys in forked workers is not supported on this platform."
+      << endl;
+   return GetSamplingDistributionsSingleWorker(paramPointIn);
+#else
+   if (!CheckConfig()){
+      oocoutE((TObject*)NULL, InputArguments)
+         << "Bad COnfiguration in ToyMCSampler "
+         << endl;
+      return nullptr;
+   }
+
+   // turn adaptive sampling off if given
+   if(fToysInTails) {
+      fToysInTails = 0;
+      oocoutW((TObject*)NULL, InputArguments)
+         << "Adaptive sampling in ToyMCSampler is not supported for parallel runs."
+         << endl;
+   }
+
+   const Int_t totToys = fNToys;
+   const UInt_t nWorkers = std::max(1, std::min(fNWorkers, totToys));
+   const UInt_t toySeed = fToySeed ? fToySeed : ToySeed(RooRandom::randomGenerator()->Integer(TMath::Limits<unsigned int>::Max()), 0);
+   const Long64_t firstToy = fToyIndex;
+
+   oocoutP((TObject*)NULL, Generation) << "ToyMCSampler: running " << totToys << " toys in "
+                                       << nWorkers << " workers" << endl;
+
+   // the workers modify their own copy of the sampler
+   auto runToys = [&](UInt_t iWorker) -> RooDataSet* {
+      const Int_t begin = (Int_t)(((Long64_t)totToys * iWorker) / nWorkers);
+      const Int_t end = (Int_t)(((Long64_t)totToys * (iWorker + 1)) / nWorkers);
+      fNToys = end - begin;
+      fToySeed = toySeed;
+      fToyIndex = firstToy + begin;
+      RooDataSet* result = GetSamplingDistributionsSingleWorker(paramPointIn);
+      // the results arrive in any order: tag them with the worker index
+      if (result) result->SetTitle(TString::Format("%u", iWorker));
+      return result;
+   };
+
+   ROOT::TProcessExecutor workers(nWorkers);
+   std::vector<RooDataSet*> results = workers.Map(runToys, ROOT::TSeqU(nWorkers));
+
+   // a given toy seed continues with the next toys at the next call
+   if (fToySeed) fToyIndex = firstToy + totToys;
+
+   if (results.size() != nWorkers) {
+      oocoutE((TObject*)NULL, Generation) << "ToyMCSampler: only " << results.size() << " out of "
+                                          << nWorkers << " workers returned a result" << endl;
+   }
+
+   // merge the sampling distributions in the order of the toys
+   std::vector<RooDataSet*> ordered(nWorkers, (RooDataSet*)NULL);
+   for (auto result : results) {
+      if (!result) continue;
+      UInt_t iWorker = TString(result->GetTitle()).Atoi();
+      if (iWorker < nWorkers && !ordered[iWorker]) ordered[iWorker] = result;
+      else delete result;
+   }
+
+   RooDataSet* output = NULL;
+   for (auto result : ordered) {
+      if (!result) continue;
+      if (!output) {
+         output = result;
+         output->SetTitle(fSamplingDistName.c_str());
+      } else {
+         output->append(*result);
+         delete result;
+      }
+   }
+
+   return output;
+#endif
+}
+
 ////////////////////////////////////////////////////////////////////////////////
 /// This is the main function for serial runs. It is called automatically
 /// from inside GetSamplingDistribution when no ProofConfig is given.
@@ -387,6 +524,13 @@ RooDataSet* ToyMCSampler::GetSamplingDistributionsSingleWorker(RooArgSet& paramP
 {
    ClearCache();
 
+   // with the per-toy seeding, the nuisance parameter points are generated
+   // for each toy after seeding it
+   if (fToySeed && fNuisanceParametersSampler) {
+      delete fNuisanceParametersSampler;
+      fNuisanceParametersSampler = NULL;
+   }
+
    if (!CheckConfig()){
       oocoutE((TObject*)NULL, InputArguments)
          << "Bad COnfiguration in ToyMCSampler "
@@ -411,6 +555,8 @@ RooDataSet* ToyMCSampler::GetSamplingDistributionsSingleWorker(RooArgSet& paramP
       // need to check at the beginning for case that zero toys are requested
       if (toysInTails >= fToysInTails  &&  i+1 > fNToys) break;
 
+      if (fToySeed) RooRandom::randomGenerator()->SetSeed(ToySeed(fToySeed, fToyIndex++));
+
       // status update
       if ( i% 500 == 0 && i>0 ) {
          oocoutP((TObject*)0,Generation) << "generated toys: " << i << " / " << fNToys;
@@ -550,7 +696,9 @@ RooAbsData* ToyMCSampler::GenerateToyData(RooArgSet& paramPoint, double& weight,
 
    // create nuisance parameter points
    if(!fNuisanceParametersSampler && fPriorNuisance && fNuisancePars) {
-      fNuisanceParametersSampler = new NuisanceParametersSampler(fPriorNuisance, fNuisancePars, fNToys, fExpectedNuisancePar);
+      // with the per-toy seeding, one randomized point is generated for each toy
+      Int_t nPoints = (fToySeed && !fExpectedNuisancePar) ? 1 : fNToys;
+      fNuisanceParametersSampler = new NuisanceParametersSampler(fPriorNuisance, fNuisancePars, nPoints, fExpectedNuisancePar);
       if ((fUseMultiGen || fgAlwaysUseMultiGen) &&  fNuisanceParametersSampler )
          oocoutI((TObject*)NULL,InputArguments) << "Cannot use multigen when nuisance parameters vary for every toy" << endl;
    }
@@ -0,0 +1,86 @@
+// Tests of the toys of ToyMCSampler run in forked workers
+
+#include "RooStats/MaxLikelihoodEstimateTestStat.h"
+#include "RooStats/SamplingDistribution.h"
+#include "RooStats/ToyMCSampler.h"
+
+#include "RooArgSet.h"
+#include "RooGaussian.h"
+#include "RooMsgService.h"
+#include "RooRandom.h"
+#include "RooRealVar.h"
+
+#include "gtest/gtest.h"
+
+#include <memory>
+#include <vector>
+
+using namespace RooStats;
+
+// Gaussian model of which the mean is estimated on each toy. The width can be a nuisance
+// parameter randomized for each toy.
+class ToyMCSamplerWorkers : public ::testing::Test {
+protected:
+   ToyMCSamplerWorkers()
+      : fX("x", "x", -5, 5), fMean("mean", "mean", 0.5, -3, 3), fSigma("sigma", "sigma", 1, 0.5, 1.5),
+        fModel("model", "model", fX, fMean, fSigma), fSigma0("sigma0", "sigma0", 1),
+        fSigmaWidth("sigmaWidth", "sigmaWidth", 0.1), fPrior("prior", "prior", fSigma, fSigma0, fSigmaWidth),
+        fTestStat(fModel, fMean), fObservables(fX), fPoint(fMean, fSigma), fNuisance(fSigma)
+   {
+      RooMsgService::instance().setGlobalKillBelow(RooFit::WARNING);
+   }
+
+   // values of the test statistic of nToys toys run in nWorkers workers
+   std::vector<double> Sample(Int_t nWorkers, bool randomizeNuisance, Int_t nToys = 30)
+   {
+      // the generator state must not matter
+      RooRandom::randomGenerator()->SetSeed(nWorkers);
+      fMean.setVal(0.5);
+      fSigma.setVal(1);
+
+      ToyMCSampler sampler(fTestStat, nToys);
+      sampler.SetPdf(fModel);
+      sampler.SetObservables(fObservables);
+      sampler.SetParametersForTestStat(RooArgSet(fMean));
+      sampler.SetNEventsPerToy(50);
+      if (randomizeNuisance) {
+         sampler.SetPriorNuisance(&fPrior);
+         sampler.SetNuisanceParameters(fNuisance);
+      }
+      sampler.SetNWorkers(nWorkers);
+      sampler.SetToySeed(1234);
+
+      std::unique_ptr<SamplingDistribution> dist(sampler.GetSamplingDistribution(fPoint));
+      if (!dist) return {};
+      return dist->GetSamplingDistribution();
+   }
+
+   RooRealVar fX;
+   RooRealVar fMean;
+   RooRealVar fSigma;
+   RooGaussian fModel;
+   RooRealVar fSigma0;
+   RooRealVar fSigmaWidth;
+   RooGaussian fPrior;
+   MaxLikelihoodEstimateTestStat fTestStat;
+   RooArgSet fObservables;
+   RooArgSet fPoint;
+   RooArgSet fNuisance;
+};
+
+TEST_F(ToyMCSamplerWorkers, SameToys)
+{
+   const std::vector<double> serial = Sample(1, false);
+   ASSERT_EQ(serial.size(), 30u);
+   // the toys differ from each other
+   EXPECT_NE(serial.front(), serial.back());
+   EXPECT_EQ(serial, Sample(3, false));
+}
+
+TEST_F(ToyMCSamplerWorkers, SameToysWithNuisance)
+{
+   const std::vector<double> serial = Sample(1, true);
+   ASSERT_EQ(serial.size(), 30u);
+   EXPECT_NE(serial, Sample(1, false));
+   EXPECT_EQ(serial, Sample(3, true));
+}
@@ -0,0 +1,216 @@
+// @(#)root/tmva/tmva/dnn:$Id$
+
+/**********************************************************************************
+ * Project: TMVA - a Root-integrated toolkit for multivariate data analysis       *
+ * Package: TMVA                                                                  *
+ * Class  : TQuantizedNet                                                         *
+ * Web    : http://tmva.sourceforge.net                                           *
+ *                                                                                *
+ * Description:                                                                   *
+ *      Inference-only copy of a trained neural network, with int8 weights and    *
+ *      int8 or bfloat16 activations                                              *
+ *                                                                                *
+ * Copyright (c) 2018:                                                            *
+ *      CERN, Switzerland                                                         *
+ *                                                                                *
+ * Redistribution and use in source and binary forms, with or without             *
+ * modification, are permitted according to the terms listed in LICENSE           *
+ * (http://tmva.sourceforge.net/LICENSE)                                          *
+ **********************************************************************************/
+
+#ifndef TMVA_DNN_QUANTIZEDNET
+#define TMVA_DNN_QUANTIZEDNET
+
+#include "TMVA/DNN/DeepNet.h"
+#include "TMVA/DNN/Net.h"
+
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+namespace TMVA {
+namespace DNN {
+
+/*! Enum representing the numerical precision of the inference */
+enum class EInferencePrecision
+{
+   kFloat    = 'F', ///< float weights and activations
+   kInt8     = 'I', ///< int8 weights and activations, int32 accumulation
+   kInt8BF16 = 'B'  ///< int8 weights, bfloat16 activations, float accumulation
+};
+
+/** \class TQuantizedNet
+
+    Inference-only copy of a trained neural network.
+
+    The weights of the dense and convolutional layers are stored as int8, with
+    one symmetric scale per output neuron or filter. With the precision kInt8,
+    the inputs of these layers are quantized to int8 for each event, with a
+    scale given by their maximum, and the products are accumulated with
+    integers. With kInt8BF16, the inputs are rounded to bfloat16 and the
+    products accumulated in float. kFloat keeps the weights as they are and
+    serves as reference.
+
+    The activations of an event are kept as a flat vector, the value of the
+    channel c at the pixel p being at c * height * width + p, as in the input
+    of MethodDL. Dense, convolutional, max-pooling and reshape layers are
+    supported. The network is read-only after its construction: Evaluate can
+    be called concurrently from several threads.
+*/
+class TQuantizedNet {
+
+public:
+   /*! Network evaluating nInputs input values per event. */
+   TQuantizedNet(size_t nInputs, EInferencePrecision precision, EOutputFunction f);
+
+   /*! Copy of a TDeepNet, or nullptr if the network has a layer which is not
+    *  supported (recurrent layers). */
+   template <typename Architecture_t, typename Layer_t>
+   static std::unique_ptr<TQuantizedNet> Create(const TDeepNet<Architecture_t, Layer_t> &net, EOutputFunction f,
+                                                EInferencePrecision precision);
+
+   /*! Copy of a TNet of fully-connected layers. */
+   template <typename Architecture_t, typename Layer_t>
+   static std::unique_ptr<TQuantizedNet> Create(const TNet<Architecture_t, Layer_t> &net, EOutputFunction f,
+                                                EInferencePrecision precision);
+
+   /*! Add a dense layer of width neurons, whose weights are given row by row
+    *  (width x number of inputs). Return false if the input of the layer does
+    *  not match the output of the network. */
+   bool AddDenseLayer(size_t width, const std::vector<Float_t> &weights, const std::vector<Float_t> &biases,
+                      EActivationFunction f);
+
+   /*! Add a convolutional layer of depth filters, whose weights are given
+    *  filter by filter, in the order channel, row, column of the input. */
+   bool AddConvLayer(size_t inputDepth, size_t inputHeight, size_t inputWidth, size_t depth, size_t filterHeight,
+                     size_t filterWidth, size_t strideRows, size_t strideCols, size_t paddingHeight,
+                     size_t paddingWidth, const std::vector<Float_t> &weights, const std::vector<Float_t> &biases,
+                     EActivationFunction f);
+
+   /*! Add a max-pooling layer. */
+   bool AddMaxPoolLayer(size_t inputDepth, size_t inputHeight, size_t inputWidth, size_t frameHeight,
+                        size_t frameWidth, size_t strideRows, size_t strideCols);
+
+   /*! Compute the outputs of nEvents events: the inputs of the event i are
+    *  input[i * GetNInputs()], ..., and its outputs are written to
+    *  output[i * GetNOutputs()], ... */
+   void Evaluate(const Float_t *input, size_t nEvents, Float_t *output) const;
+
+   size_t GetNInputs() const { return fNInputs; }
+   size_t GetNOutputs() const { return fNOutputs; }
+   size_t GetDepth() const { return fLayers.size(); }
+   EInferencePrecision GetPrecision() const { return fPrecision; }
+   EOutputFunction GetOutputFunction() const { return fOutputFunction; }
+
+   /*! Size of the weights and biases in memory, in bytes. */
+   size_t GetWeightsSize() const;
+
+   /*! Largest error on a weight introduced by the quantization, relative to
+    *  the largest weight of its neuron or filter. */
+   Float_t GetMaxWeightError() const { return fMaxWeightError; }
+
+private:
+   enum class ELayerType { kDense, kConv, kMaxPool };
+
+   struct TLayerInfo {
+      ELayerType fType;
+      size_t fInputDepth, fInputHeight, fInputWidth;
+      size_t fDepth, fHeight, fWidth;
+      size_t fFilterHeight, fFilterWidth;
+      size_t fStrideRows, fStrideCols;
+      size_t fPaddingHeight, fPaddingWidth;
+      size_t fNLocalViewPixels;             ///< number of weights of a neuron or filter
+      EActivationFunction fF;
+      std::vector<Float_t> fWeights;        ///< float weights (kFloat)
+      std::vector<std::int8_t> fQWeights;   ///< quantized weights (kInt8, kInt8BF16)
+      std::vector<Float_t> fScales;         ///< scale of the quantized weights of each neuron or filter
+      std::vector<Float_t> fBiases;
+   };
+
+   bool AddWeightedLayer(TLayerInfo &layer, const std::vector<Float_t> &weights, const std::vector<Float_t> &biases);
+
+   template <typename Weight_t, typename Input_t>
+   void ForwardWeighted(const TLayerInfo &layer, const Weight_t *weights, const Float_t *input, Float_t *output,
+                        size_t nEvents) const;
+   void ForwardMaxPool(const TLayerInfo &layer, const Float_t *input, Float_t *output, size_t nEvents) const;
+
+   size_t fNInputs;
+   size_t fNOutputs;                  ///< size of the output of the last layer
+   EInferencePrecision fPrecision;
+   EOutputFunction fOutputFunction;
+   Float_t fMaxWeightError;
+   std::vector<TLayerInfo> fLayers;
+};
+
+//______________________________________________________________________________
+template <typename Architecture_t, typename Layer_t>
+std::unique_ptr<TQuantizedNet> TQuantizedNet::Create(const TDeepNet<Architecture_t, Layer_t> &net, EOutputFunction f,
+                                                     EInferencePrecision precision)
+{
+   using Matrix_t = typename Architecture_t::Matrix_t;
+   auto toVector = [](const Matrix_t &A) {
+      std::vector<Float_t> v;
+      v.reserve(A.GetNrows() * A.GetNcols());
+      for (size_t i = 0; i < (size_t)A.GetNrows(); i++) {
+         for (size_t j = 0; j < (size_t)A.GetNcols(); j++) {
+            v.push_back(A(i, j));
+         }
+      }
+      return v;
+   };
+
+   std::unique_ptr<TQuantizedNet> qnet(
+      new TQuantizedNet(net.GetInputDepth() * net.GetInputHeight() * net.GetInputWidth(), precision, f));
+
+   for (size_t l = 0; l < net.GetDepth(); l++) {
+      const auto *layer = net.GetLayerAt(l);
+      bool ok = false;
+      // a max-pooling layer is a convolutional layer
+      if (auto pool = dynamic_cast<const CNN::TMaxPoolLayer<Architecture_t> *>(layer)) {
+         ok = qnet->AddMaxPoolLayer(pool->GetInputDepth(), pool->GetInputHeight(), pool->GetInputWidth(),
+                                    pool->GetFilterHeight(), pool->GetFilterWidth(), pool->GetStrideRows(),
+                                    pool->GetStrideCols());
+      } else if (auto conv = dynamic_cast<const CNN::TConvLayer<Architecture_t> *>(layer)) {
+         ok = qnet->AddConvLayer(conv->GetInputDepth(), conv->GetInputHeight(), conv->GetInputWidth(),
+                                 conv->GetDepth(), conv->GetFilterHeight(), conv->GetFilterWidth(),
+                                 conv->GetStrideRows(), conv->GetStrideCols(), conv->GetPaddingHeight(),
+                                 conv->GetPaddingWidth(), toVector(conv->GetWeightsAt(0)),
+                                 toVector(conv->GetBiasesAt(0)), conv->GetActivationFunction());
+      } else if (auto dense = dynamic_cast<const TDenseLayer<Architecture_t> *>(layer)) {
+         ok = qnet->AddDenseLayer(dense->GetWidth(), toVector(dense->GetWeightsAt(0)),
+                                  toVector(dense->GetBiasesAt(0)), dense->GetActivationFunction());
+      } else if (dynamic_cast<const TReshapeLayer<Architecture_t> *>(layer)) {
+         // the activations are stored in the same order before and after the reshaping
+         ok = (layer->GetDepth() * layer->GetHeight() * layer->GetWidth() == qnet->GetNOutputs());
+      }
+      if (!ok) return nullptr;
+   }
+   return qnet;
+}
+
+//______________________________________________________________________________
+template <typename Architecture_t, typename Layer_t>
+std::unique_ptr<TQuantizedNet> TQuantizedNet::Create(const TNet<Architecture_t, Layer_t> &net, EOutputFunction f,
+                                                     EInferencePrecision precision)
+{
+   std::unique_ptr<TQuantizedNet> qnet(new TQuantizedNet(net.GetInputWidth(), precision, f));
+   for (size_t l = 0; l < net.GetDepth(); l++) {
+      const auto &layer = net.GetLayer(l);
+      const auto &W = layer.GetWeights();
+      const auto &B = layer.GetBiases();
+      std::vector<Float_t> weights, biases;
+      for (size_t i = 0; i < (size_t)W.GetNrows(); i++) {
+         for (size_t j = 0; j < (size_t)W.GetNcols(); j++) {
+            weights.push_back(W(i, j));
+         }
+         biases.push_back(B(i, 0));
+      }
+      if (!qnet->AddDenseLayer(layer.GetWidth(), weights, biases, layer.GetActivationFunction())) return nullptr;
+   }
+   return qnet;
+}
+
+} // namespace DNN
+} // namespace TMVA
+
+#endif
@@ -0,0 +1,379 @@
+// @(#)root/tmva/tmva/dnn:$Id$
+
+/**********************************************************************************
+ * Project: TMVA - a Root-integrated toolkit for multivariate data analysis       *
+ * Package: TMVA                                                                  *
+ * Class  : TStreamingDataLoader                                                  *
+ * Web    : http://tmva.sourceforge.net                                           *
+ *                                                                                *
+ * Description:                                                                   *
+ *      Data loader streaming the training events from a TTree in chunks,         *
+ *      shuffled in a bounded buffer and prefetched in a background thread        *
+ *                                                                                *
+ * Copyright (c) 2018:                                                            *
+ *      CERN, Switzerland                                                         *
+ *                                                                                *
+ * Redistribution and use in source and binary forms, with or without             *
+ * modification, are permitted according to the terms listed in LICENSE           *
+ * (http://tmva.sourceforge.net/LICENSE)                                          *
+ **********************************************************************************/
+
+#ifndef TMVA_DNN_STREAMINGDATALOADER
+#define TMVA_DNN_STREAMINGDATALOADER
+
+#include "TMVA/DNN/DataLoader.h"
+
+#include <condition_variable>
+#include <exception>
+#include <mutex>
+#include <random>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+class TLeaf;
+class TTree;
+
+namespace TMVA {
+namespace DNN {
+
+/** TStreamingSource
+ *
+ * Interface of the sources of training events of a TStreamingDataLoader. A
+ * source delivers the input values, the output values (targets or class
+ * labels) and the weight of its events sequentially, chunk by chunk, and can
+ * be rewound for the next pass over the data.
+ */
+//______________________________________________________________________________
+class TStreamingSource
+{
+public:
+   virtual ~TStreamingSource() {}
+
+   virtual size_t GetNInputs() const = 0;
+   virtual size_t GetNOutputs() const = 0;
+   /** Number of events in one pass over the source. */
+   virtual size_t GetNEvents() const = 0;
+
+   /** Read the next nEvents events at most. The values of the event i are
+    *  written to inputs[i * GetNInputs() + j], outputs[i * GetNOutputs() + j]
+    *  and weights[i]. Returns the number of events read, 0 at the end of the
+    *  pass. */
+   virtual size_t Read(size_t nEvents, Float_t *inputs, Float_t *outputs, Float_t *weights) = 0;
+
+   /** Restart from the first event. */
+   virtual void Rewind() = 0;
+};
+
+/** TTreeStreamingSource
+ *
+ * Streaming source reading the events of a TTree or a TChain, e.g. the
+ * dataset of an RDataFrame, from a range of entries. The inputs, outputs and
+ * weight are numeric leaves of any type. The entries of a chunk are read by
+ * columns, one branch after the other, so that the baskets of each branch are
+ * read and decompressed sequentially, and the other branches are not read.
+ */
+//______________________________________________________________________________
+class TTreeStreamingSource : public TStreamingSource
+{
+public:
+   /** Stream the entries [firstEntry, lastEntry) of tree, all of them for
+    *  lastEntry < 0. All the events have unit weight if weight is empty. */
+   TTreeStreamingSource(TTree *tree, const std::vector<std::string> &inputs, const std::vector<std::string> &outputs,
+                        const std::string &weight = "", Long64_t firstEntry = 0, Long64_t lastEntry = -1);
+
+   size_t GetNInputs() const { return fInputs.size(); }
+   size_t GetNOutputs() const { return fOutputs.size(); }
+   size_t GetNEvents() const { return fLastEntry - fFirstEntry; }
+
+   size_t Read(size_t nEvents, Float_t *inputs, Float_t *outputs, Float_t *weights);
+   void Rewind() { fEntry = fFirstEntry; }
+
+private:
+   void UpdateLeaves();
+
+   TTree *fTree;
+   std::vector<std::string> fInputs;
+   std::vector<std::string> fOutputs;
+   std::string fWeight;
+   Long64_t fFirstEntry;
+   Long64_t fLastEntry;
+   Long64_t fEntry;                 ///< Next entry to be read.
+   Int_t fTreeNumber;               ///< Tree of the chain the leaves belong to.
+   std::vector<TLeaf *> fLeaves;    ///< Leaves of the inputs, outputs and weight.
+};
+
+template <typename AArchitecture> class TStreamingDataLoader;
+
+/** TStreamingBatchIterator
+ *
+ * Iterator over the batches of one epoch of a TStreamingDataLoader.
+ */
+//______________________________________________________________________________
+template <typename AArchitecture>
+class TStreamingBatchIterator
+{
+private:
+   TStreamingDataLoader<AArchitecture> &fDataLoader;
+   size_t fBatchIndex;
+
+public:
+   TStreamingBatchIterator(TStreamingDataLoader<AArchitecture> &dataLoader, size_t index = 0)
+      : fDataLoader(dataLoader), fBatchIndex(index)
+   {
+   }
+
+   TBatch<AArchitecture> operator*() { return fDataLoader.GetBatch(); }
+   TStreamingBatchIterator operator++()
+   {
+      fBatchIndex++;
+      return *this;
+   }
+   bool operator!=(const TStreamingBatchIterator &other) { return fBatchIndex != other.fBatchIndex; }
+};
+
+/** TStreamingDataLoader
+ *
+ * Data loader streaming the training events from a TStreamingSource, without
+ * holding the whole dataset in memory. The events are read in chunks and
+ * shuffled in a buffer of bounded size: each event of a batch is drawn at
+ * random from the buffer, and replaced by the next event of the source. With a
+ * buffer of one event, the batches follow the order of the source; with a
+ * buffer as large as the source, the shuffling is complete.
+ *
+ * The batches are filled in a background thread, directly in the column-major
+ * layout of the matrices of the architecture, while the previous ones are used
+ * for the training. The source is rewound at its end, so that the batches cycle
+ * over the data as with TDataLoader; an epoch is the number of batches
+ * required to go once through the source. When reading a TTree while other
+ * threads use ROOT, ROOT::EnableThreadSafety() must have been called.
+ *
+ * \tparam AArchitecture The achitecture class of the underlying architecture.
+ */
+//______________________________________________________________________________
+template <typename AArchitecture>
+class TStreamingDataLoader
+{
+private:
+   using HostBuffer_t    = typename AArchitecture::HostBuffer_t;
+   using DeviceBuffer_t  = typename AArchitecture::DeviceBuffer_t;
+   using Matrix_t        = typename AArchitecture::Matrix_t;
+   using BatchIterator_t = TStreamingBatchIterator<AArchitecture>;
+
+   TStreamingSource &fSource;
+
+   size_t fBatchSize;
+   size_t fNInputFeatures;
+   size_t fNOutputFeatures;
+   size_t fBatchIndex;
+
+   size_t fNStreams;                            ///< Number of buffer pairs.
+   std::vector<DeviceBuffer_t> fDeviceBuffers;
+   std::vector<HostBuffer_t>   fHostBuffers;
+
+   // State of the background thread.
+   size_t fBufferSize;                          ///< Number of events of the shuffle buffer.
+   size_t fChunkSize;                           ///< Number of events read at once from the source.
+   std::vector<Float_t> fBufferInputs, fBufferOutputs, fBufferWeights;
+   std::vector<Float_t> fChunkInputs, fChunkOutputs, fChunkWeights;
+   size_t fChunkEvents;                         ///< Number of events of the current chunk.
+   size_t fChunkPosition;                       ///< Next event of the current chunk.
+   std::mt19937 fRandom;
+
+   // Synchronization between the training and the background thread.
+   std::thread fThread;
+   std::mutex fMutex;
+   std::condition_variable fCondition;
+   std::vector<bool> fReady;                    ///< Host buffers filled by the background thread.
+   bool fStop;
+   std::exception_ptr fError;
+
+   void ReadEvent(Float_t *inputs, Float_t *outputs, Float_t *weight);
+   void FillBuffer(HostBuffer_t &buffer);
+   void Prefetch();
+
+public:
+   /** Stream the events of source by batches of batchSize events, shuffled in a
+    *  buffer of bufferSize events (at most the number of events of the source)
+    *  and read by chunks of chunkSize events. nStreams - 1 batches are prepared
+    *  in advance. */
+   TStreamingDataLoader(TStreamingSource &source, size_t batchSize, size_t bufferSize, size_t chunkSize = 4096,
+                        size_t nStreams = 3, UInt_t seed = 0);
+   TStreamingDataLoader(const TStreamingDataLoader &) = delete;
+   TStreamingDataLoader &operator=(const TStreamingDataLoader &) = delete;
+   ~TStreamingDataLoader();
+
+   /** Number of batches of one pass over the source. */
+   size_t GetNBatchesPerEpoch() const { return fSource.GetNEvents() / fBatchSize; }
+
+   BatchIterator_t begin() { return BatchIterator_t(*this); }
+   BatchIterator_t end() { return BatchIterator_t(*this, GetNBatchesPerEpoch()); }
+
+   /** Return the next batch. The matrices of a batch remain valid until
+    *  nStreams - 1 further batches have been requested. */
+   TBatch<AArchitecture> GetBatch();
+};
+
+//
+// TStreamingDataLoader Class.
+//______________________________________________________________________________
+template <typename AArchitecture>
+TStreamingDataLoader<AArchitecture>::TStreamingDataLoader(TStreamingSource &source, size_t batchSize,
+                                                          size_t bufferSize, size_t chunkSize, size_t nStreams,
+                                                          UInt_t seed)
+   : fSource(source), fBatchSize(batchSize), fNInputFeatures(source.GetNInputs()),
+     fNOutputFeatures(source.GetNOutputs()), fBatchIndex(0), fNStreams(std::max<size_t>(nStreams, 2)),
+     fDeviceBuffers(), fHostBuffers(), fBufferSize(std::max<size_t>(std::min(bufferSize, source.GetNEvents()), 1)),
+     fChunkSize(std::max<size_t>(chunkSize, 1)), fChunkEvents(0), fChunkPosition(0), fRandom(seed),
+     fReady(fNStreams, false), fStop(false)
+{
+   if (fSource.GetNEvents() < fBatchSize) {
+      throw std::runtime_error("TStreamingDataLoader: the source has less events than a batch");
+   }
+
+   size_t inputMatrixSize  = fBatchSize * fNInputFeatures;
+   size_t outputMatrixSize = fBatchSize * fNOutputFeatures;
+   size_t weightMatrixSize = fBatchSize;
+
+   for (size_t i = 0; i < fNStreams; i++) {
+      fHostBuffers.push_back(HostBuffer_t(inputMatrixSize + outputMatrixSize + weightMatrixSize));
+      fDeviceBuffers.push_back(DeviceBuffer_t(inputMatrixSize + outputMatrixSize + weightMatrixSize));
+   }
+
+   fChunkInputs.resize(fChunkSize * fNInputFeatures);
+   fChunkOutputs.resize(fChunkSize * fNOutputFeatures);
+   fChunkWeights.resize(fChunkSize);
+}
+
+//______________________________________________________________________________
+template <typename AArchitecture>
+TStreamingDataLoader<AArchitecture>::~TStreamingDataLoader()
+{
+   {
+      std::lock_guard<std::mutex> lock(fMutex);
+      fStop = true;
+   }
+   fCondition.notify_all();
+   if (fThread.joinable()) fThread.join();
+}
+
+//______________________________________________________________________________
+template <typename AArchitecture>
+void TStreamingDataLoader<AArchitecture>::ReadEvent(Float_t *inputs, Float_t *outputs, Float_t *weight)
+{
+   if (fChunkPosition == fChunkEvents) {
+      fChunkEvents = fSource.Read(fChunkSize, fChunkInputs.data(), fChunkOutputs.data(), fChunkWeights.data());
+      if (fChunkEvents == 0) {
+         fSource.Rewind();
+         fChunkEvents = fSource.Read(fChunkSize, fChunkInputs.data(), fChunkOutputs.data(), fChunkWeights.data());
+         if (fChunkEvents == 0) throw std::runtime_error("TStreamingDataLoader: no event read from the source");
+      }
+      fChunkPosition = 0;
+   }
+   std::copy_n(fChunkInputs.begin() + fChunkPosition * fNInputFeatures, fNInputFeatures, inputs);
+   std::copy_n(fChunkOutputs.begin() + fChunkPosition * fNOutputFeatures, fNOutputFeatures, outputs);
+   *weight = fChunkWeights[fChunkPosition];
+   fChunkPosition++;
+}
+
+//______________________________________________________________________________
+template <typename AArchitecture>
+void TStreamingDataLoader<AArchitecture>::FillBuffer(HostBuffer_t &buffer)
+{
+   if (fBufferWeights.empty()) {
+      fBufferInputs.resize(fBufferSize * fNInputFeatures);
+      fBufferOutputs.resize(fBufferSize * fNOutputFeatures);
+      fBufferWeights.resize(fBufferSize);
+      for (size_t j = 0; j < fBufferSize; j++) {
+         ReadEvent(&fBufferInputs[j * fNInputFeatures], &fBufferOutputs[j * fNOutputFeatures], &fBufferWeights[j]);
+      }
+   }
+
+   size_t outputOffset = fBatchSize * fNInputFeatures;
+   size_t weightOffset = outputOffset + fBatchSize * fNOutputFeatures;
+   std::uniform_int_distribution<size_t> draw(0, fBufferSize - 1);
+
+   for (size_t i = 0; i < fBatchSize; i++) {
+      size_t j = draw(fRandom);
+      Float_t *inputs  = &fBufferInputs[j * fNInputFeatures];
+      Float_t *outputs = &fBufferOutputs[j * fNOutputFeatures];
+      for (size_t k = 0; k < fNInputFeatures; k++) {
+         buffer[k * fBatchSize + i] = inputs[k];
+      }
+      for (size_t k = 0; k < fNOutputFeatures; k++) {
+         buffer[outputOffset + k * fBatchSize + i] = outputs[k];
+      }
+      buffer[weightOffset + i] = fBufferWeights[j];
+      ReadEvent(inputs, outputs, &fBufferWeights[j]);
+   }
+}
+
+//______________________________________________________________________________
+template <typename AArchitecture>
+void TStreamingDataLoader<AArchitecture>::Prefetch()
+{
+   try {
+      for (size_t slot = 0;; slot = (slot + 1) % fNStreams) {
+         {
+            std::unique_lock<std::mutex> lock(fMutex);
+            fCondition.wait(lock, [&] { return fStop || !fReady[slot]; });
+            if (fStop) return;
+         }
+         FillBuffer(fHostBuffers[slot]);
+         {
+            std::lock_guard<std::mutex> lock(fMutex);
+            fReady[slot] = true;
+         }
+         fCondition.notify_all();
+      }
+   } catch (...) {
+      {
+         std::lock_guard<std::mutex> lock(fMutex);
+         fError = std::current_exception();
+      }
+      fCondition.notify_all();
+   }
+}
+
+//______________________________________________________________________________
+template <typename AArchitecture>
+TBatch<AArchitecture> TStreamingDataLoader<AArchitecture>::GetBatch()
+{
+   if (!fThread.joinable()) fThread = std::thread(&TStreamingDataLoader::Prefetch, this);
+
+   size_t inputMatrixSize  = fBatchSize * fNInputFeatures;
+   size_t outputMatrixSize = fBatchSize * fNOutputFeatures;
+   size_t weightMatrixSize = fBatchSize;
+
+   size_t streamIndex = fBatchIndex % fNStreams;
+   {
+      std::unique_lock<std::mutex> lock(fMutex);
+      // the host buffer of the previous batch can be refilled now that it has
+      // been transferred
+      if (fBatchIndex > 0) fReady[(fBatchIndex - 1) % fNStreams] = false;
+      fCondition.notify_all();
+      fCondition.wait(lock, [&] { return fReady[streamIndex] || fError; });
+      if (fError) std::rethrow_exception(fError);
+   }
+
+   HostBuffer_t   & hostBuffer   = fHostBuffers[streamIndex];
+   DeviceBuffer_t & deviceBuffer = fDeviceBuffers[streamIndex];
+   deviceBuffer.CopyFrom(hostBuffer);
+
+   DeviceBuffer_t inputDeviceBuffer  = deviceBuffer.GetSubBuffer(0, inputMatrixSize);
+   DeviceBuffer_t outputDeviceBuffer = deviceBuffer.GetSubBuffer(inputMatrixSize, outputMatrixSize);
+   DeviceBuffer_t weightDeviceBuffer = deviceBuffer.GetSubBuffer(inputMatrixSize + outputMatrixSize, weightMatrixSize);
+
+   Matrix_t  inputMatrix(inputDeviceBuffer,  fBatchSize, fNInputFeatures);
+   Matrix_t outputMatrix(outputDeviceBuffer, fBatchSize, fNOutputFeatures);
+   Matrix_t weightMatrix(weightDeviceBuffer, fBatchSize, 1);
+
+   fBatchIndex++;
+   return TBatch<AArchitecture>(inputMatrix, outputMatrix, weightMatrix);
+}
+
+} // namespace DNN
+} // namespace TMVA
+
+#endif
@@ -42,6 +42,9 @@
 
 #include "TH2.h"
 
+#include <unordered_map>
+#include <vector>
+
 #include "TMVA/Types.h"
 #include "TMVA/DecisionTreeNode.h"
 #include "TMVA/BinaryTree.h"
@@ -104,6 +107,23 @@ namespace TMVA {
                         DecisionTreeNode *node = NULL);
       // determine the way how a node is split (which variable, which cut value)
 
+      // input variables of a training sample quantized in bins, for BuildTreeHist
+      struct BinnedSample {
+         std::vector< std::vector<Float_t> > fCuts;  // cut values between the bins of each variable
+         std::vector< std::vector<UChar_t> > fBins;  // bin of each event for each variable
+         std::unordered_map<const TMVA::Event*, UInt_t> fIndex; // position of the events in fBins
+
+         // fill with nBins (<= 256) quantiles of each variable
+         void Fill( const EventConstList & eventSample, UInt_t nVars, UInt_t nBins );
+         void Clear();
+         UInt_t GetNBins( UInt_t ivar ) const { return fCuts[ivar].size()+1; }
+      };
+
+      // building of a regression tree on the targets of the events with
+      // histograms of the binned variables (for gradient boosting)
+      UInt_t BuildTreeHist( const EventConstList & eventSample, const BinnedSample & binned,
+                            UInt_t targetIndex = 0, Bool_t logisticHessian = kFALSE );
+
       Double_t TrainNode( const EventConstList & eventSample,  DecisionTreeNode *node ) { return TrainNodeFast( eventSample, node ); }
       Double_t TrainNodeFast( const EventConstList & eventSample,  DecisionTreeNode *node );
       Double_t TrainNodeFull( const EventConstList & eventSample,  DecisionTreeNode *node );
@@ -201,6 +221,12 @@ namespace TMVA {
       // calculates the purity S/(S+B) of a given event sample
       Double_t SamplePurity(EventList eventSample);
 
+      // recursive node splitting of BuildTreeHist
+      struct HistTrainingData;
+      void BuildNodeHist( DecisionTreeNode *node, UInt_t begin, UInt_t end,
+                          std::vector<Double_t> & hist, HistTrainingData & data );
+      void FillNodeHist( UInt_t begin, UInt_t end, std::vector<Double_t> & hist, const HistTrainingData & data ) const;
+
       UInt_t    fNvars;          // number of variables used to separate S and B
       Int_t     fNCuts;          // number of grid point in variable cut scans
       Bool_t    fUseFisherCuts;  // use multivariate splits using the Fisher criterium
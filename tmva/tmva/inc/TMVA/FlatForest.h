@@ -0,0 +1,137 @@
+// @(#)root/tmva $Id$
+
+/**********************************************************************************
+ * Project: TMVA - a Root-integrated toolkit for multivariate data analysis       *
+ * Package: TMVA                                                                  *
+ * Class  : FlatForest                                                            *
+ *                                                                                *
+ * Description:                                                                   *
+ *      Forest of a trained BDT compiled into contiguous arrays, for the fast     *
+ *      evaluation of single events and of batches of events                     *
+ *                                                                                *
+ * Copyright (c) 2018:                                                            *
+ *      CERN, Switzerland                                                         *
+ *                                                                                *
+ * Redistribution and use in source and binary forms, with or without             *
+ * modification, are permitted according to the terms listed in LICENSE           *
+ * (http://tmva.sourceforge.net/LICENSE)                                          *
+ **********************************************************************************/
+
+#ifndef ROOT_TMVA_FlatForest
+#define ROOT_TMVA_FlatForest
+
+#include "Rtypes.h"
+#include "TString.h"
+
+#include <iosfwd>
+#include <memory>
+#include <stdexcept>
+#include <vector>
+
+namespace TMVA {
+
+   class DecisionTreeNode;
+   class MethodBDT;
+   class MsgLogger;
+
+   class FlatForest {
+
+   public:
+
+      // number of events evaluated together in the batch evaluation
+      static const UInt_t kBlockSize = 16;
+
+      FlatForest();
+      // with transformedInputs, the forest is evaluated on the input variables after the
+      // variable transformations of the BDT, which are then not required to be the identity
+      FlatForest( const MethodBDT& bdt, Bool_t transformedInputs = kFALSE );
+
+      // false if the BDT cannot be compiled (see the constructor)
+      Bool_t IsValid() const { return fValid; }
+
+      UInt_t GetNVariables() const { return fNVars; }
+      UInt_t GetNClasses()   const { return fNClasses; }
+      UInt_t GetNTrees()     const { return fRoot.size(); }
+      UInt_t GetNNodes()     const { return fCut.size(); }
+
+      // MVA value of one event, x holds the values of the input variables
+      Double_t Evaluate( const Float_t* x ) const;
+
+      // MVA values of nEvents events stored one after the other, stride
+      // values apart (default: the number of variables)
+      void Evaluate( const Float_t* x, UInt_t nEvents, Float_t* output, UInt_t stride = 0 ) const;
+
+      // class probabilities of one event for a multiclass BDT, output holds GetNClasses() values
+      void EvaluateMulticlass( const Float_t* x, Float_t* output ) const;
+
+      // write a standalone C++ function double funcName(const float* x)
+      // with the trees written out as nested conditions
+      void MakeCode( std::ostream& os, const TString& funcName ) const;
+
+      // functor with one argument per input variable, e.g. for
+      // RDataFrame::Define("bdt", forest.GetFunctor<float,float,float>(), {"x","y","z"})
+      template <typename... Ts> class Functor;
+      template <typename... Ts> Functor<Ts...> GetFunctor() const;
+
+   private:
+
+      Bool_t   AddNode( const DecisionTreeNode* node, Double_t weight, Bool_t useResponse, Bool_t useYesNoLeaf,
+                        UInt_t depth, UInt_t& maxDepth, UInt_t& index );
+      Double_t Finalize( Double_t sum, const Float_t* x ) const;
+      void     MakeNodeCode( std::ostream& os, UInt_t node ) const;
+
+      MsgLogger& Log() const;
+
+      // the nodes of all the trees; a leaf points twice to itself, so that
+      // the trees can be traversed for a fixed number of steps without tests
+      std::vector<UInt_t>   fVar;       // variable of the cut of the node
+      std::vector<Float_t>  fCut;       // the node goes to fChild[2*i+1] if x[fVar[i]] >= fCut[i]
+      std::vector<UInt_t>   fChild;     // the two daughters of each node
+      std::vector<Double_t> fValue;     // the (weighted) response of the leaves
+
+      std::vector<UInt_t>   fRoot;      // first node of each tree
+      std::vector<UInt_t>   fDepth;     // depth of each tree
+
+      // the automatic pre-selection cuts of the BDT (option DoPreselection)
+      struct PreselectionCut {
+         UInt_t   fVar;
+         Double_t fCut;
+         Bool_t   fLow;                 // x < cut (instead of x > cut)
+         Double_t fResult;              // MVA value returned by the cut
+      };
+      std::vector<PreselectionCut> fPreselection;
+
+      UInt_t   fNVars;
+      UInt_t   fNClasses;               // number of classes of a multiclass BDT, 1 otherwise
+      Bool_t   fGrad;                   // sum of the responses mapped to [-1,1] (gradient boost)
+      Double_t fNorm;                   // sum of the boost weights (other boost types)
+      Bool_t   fValid;
+   };
+
+   ////////////////////////////////////////////////////////////////////////////////
+   /// thread-safe functor evaluating a copy of the forest for the input
+   /// variables passed as separate arguments
+
+   template <typename... Ts>
+   class FlatForest::Functor {
+   public:
+      Functor( const FlatForest& forest ) : fForest(std::make_shared<const FlatForest>(forest))
+      {
+         if (forest.GetNVariables() != sizeof...(Ts))
+            throw std::runtime_error("TMVA::FlatForest::Functor: the number of arguments does not match the number of variables");
+      }
+      Float_t operator()( Ts... xs ) const
+      {
+         const Float_t x[] = { Float_t(xs)... };
+         return fForest->Evaluate(x);
+      }
+   private:
+      std::shared_ptr<const FlatForest> fForest;
+   };
+
+   template <typename... Ts>
+   FlatForest::Functor<Ts...> FlatForest::GetFunctor() const { return Functor<Ts...>(*this); }
+
+} // namespace TMVA
+
+#endif
@@ -142,6 +142,10 @@ namespace TMVA {
 
       virtual void MakeClassSpecific( std::ostream&, const TString& ) const;
 
+      // batch evaluation of the network, from the weights of the synapses
+      virtual Bool_t SupportsBatchMvaValues() const;
+      virtual void   ComputeBatchMvaValues( const Float_t* input, UInt_t nEvents, Float_t* output ) const;
+
       std::vector<Int_t>* ParseLayoutString( TString layerSpec );
       virtual void        BuildNetwork( std::vector<Int_t>* layout, std::vector<Double_t>* weights=NULL,
                                         Bool_t fromFile = kFALSE );
@@ -211,6 +215,9 @@ namespace TMVA {
       void DeleteNetwork();
       void DeleteNetworkLayer(TObjArray*& layer);
 
+      // copy the weights of the synapses for the batch evaluation
+      void CacheBatchWeights();
+
       // debugging utilities
       void PrintLayer(TObjArray* layer) const;
       void PrintNeuron(TNeuron* neuron) const;
@@ -220,6 +227,11 @@ namespace TMVA {
       std::vector<TNeuron*>   fOutputNeurons;   // cache this for fast access
       TString                 fLayerSpec;       // layout specification option
 
+      // network read from the weights, for the batch evaluation
+      std::vector< std::vector<Double_t> > fBatchWeights; //! [l][j*width[l-1]+i]: from the neuron i of the layer l-1 to the neuron j of the layer l
+      std::vector< std::vector<Char_t> >   fBatchIsBias;  //! bias neurons (value 1) of each layer
+      std::vector<Int_t>                   fBatchWidth;   //! number of neurons of each layer
+
       // some static flags
       static const Bool_t fgDEBUG      = kTRUE;  // debug flag
 
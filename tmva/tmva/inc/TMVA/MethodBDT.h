@@ -39,6 +39,7 @@
 //                                                                      //
 //////////////////////////////////////////////////////////////////////////
 
+#include <atomic>
 #include <vector>
 #include <memory>
 #include "TH2.h"
@@ -57,9 +58,12 @@
 namespace TMVA {
 
    class SeparationBase;
+   class FlatForest;
 
    class MethodBDT : public MethodBase {
 
+      friend class FlatForest; // compiles the forest for the fast evaluation
+
    public:
 
       // constructor for training and reading
@@ -114,6 +118,12 @@ namespace TMVA {
       Double_t PrivateGetMvaValue( const TMVA::Event *ev, Double_t* err=0, Double_t* errUpper=0, UInt_t useNTrees=0 );
       void     BoostMonitor(Int_t iTree);
 
+   protected:
+      // batch evaluation with the compiled forest
+      Bool_t SupportsBatchMvaValues() const;
+      void   ComputeBatchMvaValues( const Float_t* input, UInt_t nEvents, Float_t* output ) const;
+      const FlatForest* GetFlatForest() const;
+
    public:
       const std::vector<Float_t>& GetMulticlassValues();
 
@@ -273,6 +283,10 @@ namespace TMVA {
 
       Bool_t                           fSkipNormalization; // true for skipping normalization at initialization of trees
 
+      mutable std::atomic<FlatForest*> fFlatForest;      //! the forest compiled for the batch evaluation, on first use
+      Bool_t                           fHistTraining;    // grow the trees of gradient boost on pre-binned variables
+      DecisionTree::BinnedSample       fBinnedSample;    //! the pre-binned training events for fHistTraining
+
       std::vector<Double_t>            fVariableImportance; // the relative importance of the different variables
 
 
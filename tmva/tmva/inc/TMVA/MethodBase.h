@@ -198,10 +198,24 @@ namespace TMVA {
       // signal/background classification response
       Double_t GetMvaValue( const TMVA::Event* const ev, Double_t* err = 0, Double_t* errUpper = 0 );
 
+      // thread-safe classification response of nEvents events, whose (untransformed) input
+      // variables are stored one event after the other, for the methods providing it
+      Bool_t   HasBatchMvaValues() const;
+      void     GetBatchMvaValues( const Float_t* input, UInt_t nEvents, Float_t* output ) const;
+
+      // copy of the input variables of nEvents events with the variable transformations
+      // of the method applied, for the transformations that support it
+      void     TransformBatchInputs( const Float_t* input, UInt_t nEvents, std::vector<Float_t>& output, Int_t cls = -1 ) const;
+
    protected:
       // helper function to set errors to -1
       void NoErrorCalc(Double_t* const err, Double_t* const errUpper);
 
+      // batch evaluation, to be implemented as const and thread-safe by the methods
+      // supporting it; TransformBatchInputs applies the variable transformations
+      virtual Bool_t SupportsBatchMvaValues() const { return kFALSE; }
+      virtual void   ComputeBatchMvaValues( const Float_t* input, UInt_t nEvents, Float_t* output ) const;
+
       // signal/background classification response for all current set of data
       virtual std::vector<Double_t> GetMvaValues(Long64_t firstEvt = 0, Long64_t lastEvt = -1, Bool_t logProgress = false);
 
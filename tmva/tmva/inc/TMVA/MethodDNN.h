@@ -131,6 +131,10 @@ protected:
    void MakeClassSpecific( std::ostream&, const TString& ) const;
    void GetHelpMessage() const;
 
+   // batch evaluation, forward propagation of all the events at once
+   Bool_t SupportsBatchMvaValues() const;
+   void   ComputeBatchMvaValues( const Float_t* input, UInt_t nEvents, Float_t* output ) const;
+
 public:
 
    // Standard Constructors
@@ -169,6 +173,9 @@ public:
    // ranking of input variables
    const Ranking* CreateRanking();
 
+   const Net_t & GetNet() const { return fNet; }
+   DNN::EOutputFunction GetOutputFunction() const { return fOutputFunction; }
+
 };
 
 inline void MethodDNN::WriteMatrixXML(void *parent,
@@ -110,6 +110,10 @@ namespace TMVA {
       // get help message text
       void GetHelpMessage() const;
 
+      // batch evaluation from the reference histograms of the PDFs
+      Bool_t SupportsBatchMvaValues() const;
+      void   ComputeBatchMvaValues( const Float_t* input, UInt_t nEvents, Float_t* output ) const;
+
    private:
 
       // returns transformed or non-transformed output
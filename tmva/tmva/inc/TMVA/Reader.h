@@ -92,6 +92,10 @@ namespace TMVA {
       Double_t EvaluateMVA( MethodBase* method,           Double_t aux = 0 );
       Double_t EvaluateMVA( const TString& methodTag,     Double_t aux = 0 );
 
+      // returns the MVA responses of nEvents events, whose input variables are stored
+      // one event after the other in input
+      void     EvaluateMVA( const TString& methodTag, const Float_t* input, UInt_t nEvents, Float_t* output, Double_t aux = 0 );
+
       // returns error on MVA response for given event
       // NOTE: must be called AFTER "EvaluateMVA(...)" call !
       Double_t GetMVAError() const { return fMvaEventError; }
@@ -0,0 +1,98 @@
+// @(#)root/tmva $Id$
+
+/**********************************************************************************
+ * Project: TMVA - a Root-integrated toolkit for multivariate data analysis       *
+ * Package: TMVA                                                                  *
+ * Class  : ReaderModel                                                           *
+ *                                                                                *
+ * Description:                                                                   *
+ *      Trained method loaded once from its weight file, evaluated for batches    *
+ *      of events and shareable between threads                                   *
+ *                                                                                *
+ * Copyright (c) 2018:                                                            *
+ *      CERN, Switzerland                                                         *
+ *                                                                                *
+ * Redistribution and use in source and binary forms, with or without             *
+ * modification, are permitted according to the terms listed in LICENSE           *
+ * (http://tmva.sourceforge.net/LICENSE)                                          *
+ **********************************************************************************/
+
+#ifndef ROOT_TMVA_ReaderModel
+#define ROOT_TMVA_ReaderModel
+
+#include "Rtypes.h"
+#include "TString.h"
+
+#include <cstddef>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+namespace TMVA {
+
+   class MethodBase;
+   class MsgLogger;
+   class Reader;
+   namespace DNN { class TQuantizedNet; }
+
+   class ReaderModel {
+
+   public:
+
+      // difference between the MVA values computed with reduced precision and in float
+      struct AccuracyDelta {
+         std::size_t fNEvents;   // number of events compared
+         Double_t    fMaxAbs;    // largest absolute difference
+         Double_t    fMeanAbs;   // mean absolute difference
+         Double_t    fRMS;       // root mean square of the differences
+      };
+
+      // book the method of the weight file (.xml), whose input variables and
+      // spectators are declared as in the file; option "Precision=Int8" or
+      // "Precision=Int8BF16" evaluates the DNN and DL methods with int8 weights
+      ReaderModel( const TString& weightFile, const TString& options = "" );
+      ~ReaderModel();
+
+      ReaderModel( const ReaderModel& ) = delete;
+      ReaderModel& operator=( const ReaderModel& ) = delete;
+
+      UInt_t GetNVariables() const { return fVariables.size(); }
+      const std::vector<TString>& GetVariables() const { return fVariables; }
+      const TString& GetMethodName() const { return fMethodName; }
+
+      // true if the method evaluates batches natively and concurrently,
+      // false if the events are evaluated one by one under a lock
+      Bool_t IsNative() const { return fNative || IsQuantized(); }
+
+      // true if the network is evaluated with int8 weights
+      Bool_t IsQuantized() const { return fQuantizedNet != nullptr; }
+
+      // MVA values of nEvents events: the input variables of the event i are
+      // inputs[i*nVar], ..., inputs[i*nVar+nVar-1], its value is written to out[i]
+      void Compute( const Float_t* inputs, std::size_t nEvents, Float_t* out ) const;
+      std::vector<Float_t> Compute( const std::vector<Float_t>& inputs ) const;
+
+      // compare the MVA values of nEvents events computed with reduced precision
+      // to the float ones, and print the result
+      AccuracyDelta CompareToFloat( const Float_t* inputs, std::size_t nEvents ) const;
+
+   private:
+
+      void Evaluate( const Float_t* inputs, std::size_t nEvents, Float_t* out, Bool_t quantized ) const;
+      void Quantize( const TString& precision );
+
+      MsgLogger& Log() const;
+
+      std::unique_ptr<Reader> fReader;       // the reader owning the method
+      MethodBase*             fMethod;       // the booked method
+      TString                 fMethodName;   // name (tag) of the method in the weight file
+      std::vector<TString>    fVariables;    // expressions of the input variables
+      std::vector<Float_t>    fBuffer;       // addresses of the variables and spectators given to fReader
+      Bool_t                  fNative;       // the method provides MethodBase::GetBatchMvaValues
+      std::unique_ptr<DNN::TQuantizedNet> fQuantizedNet; // copy of the network with int8 weights, if requested
+      mutable std::mutex      fMutex;        // serializes the event-by-event evaluation
+   };
+
+} // namespace TMVA
+
+#endif
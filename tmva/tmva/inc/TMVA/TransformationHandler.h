@@ -71,6 +71,11 @@ namespace TMVA {
       const Event* Transform(const Event*) const;
       const Event* InverseTransform(const Event*, Bool_t suppressIfNoTargets=true  ) const;
 
+      // thread-safe in-place transformation of the input variables of nEvents events (see
+      // VariableTransformBase::TransformBatch), with the reference class cls if cls >= 0
+      Bool_t       CanTransformBatch() const;
+      void         TransformBatch( Float_t* values, UInt_t nEvents, Int_t cls = -1 ) const;
+
       // overrides the reference classes of all added transformations. Handle with care!!!
       void         SetTransformationReferenceClass( Int_t cls );
 
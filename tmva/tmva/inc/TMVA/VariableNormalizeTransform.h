@@ -58,6 +58,9 @@ namespace TMVA {
       virtual const Event* Transform(const Event* const, Int_t cls ) const;
       virtual const Event* InverseTransform( const Event* const, Int_t cls ) const;
 
+      virtual Bool_t CanTransformBatch() const { return IsCreated(); }
+      virtual void   TransformBatch( Float_t* values, UInt_t nEvents, UInt_t nVars, Int_t cls ) const;
+
       void WriteTransformationToStream ( std::ostream& ) const;
       void ReadTransformationFromStream( std::istream&, const TString& );
       void BuildTransformationFromVarInfo( const std::vector<TMVA::VariableInfo>& var );
@@ -66,6 +66,11 @@ namespace TMVA {
       virtual const Event* Transform       ( const Event* const, Int_t cls ) const = 0;
       virtual const Event* InverseTransform( const Event* const, Int_t cls ) const = 0;
 
+      // thread-safe in-place transformation of the input variables of nEvents events, stored
+      // one after the other (nVars values each), for the transformations supporting it
+      virtual Bool_t       CanTransformBatch() const { return kFALSE; }
+      virtual void         TransformBatch( Float_t* /*values*/, UInt_t /*nEvents*/, UInt_t /*nVars*/, Int_t /*cls*/ ) const {}
+
       // accessors
       void   SetEnabled  ( Bool_t e ) { fEnabled = e; }
       void   SetNormalise( Bool_t n ) { fNormalise = n; }
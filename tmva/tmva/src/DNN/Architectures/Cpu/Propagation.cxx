@@ -18,6 +18,14 @@
 #include "TMVA/DNN/Architectures/Cpu.h"
 #include "TMVA/DNN/Architectures/Cpu/Blas.h"
 
+#include <algorithm>
+#include <cmath>
+#include <vector>
+
+#ifndef TANH_IMPL_X
+#define TANH_IMPL_X    tanh(x)
+#endif
+
 namespace TMVA {
 namespace DNN {
 
@@ -289,6 +297,146 @@ size_t TCpu<AFloat>::calculateDimension(size_t imgDim, size_t fltDim, size_t pad
    return temp / stride + 1;
 }
 
+
+//____________________________________________________________________________
+//
+// Blocked convolution kernels
+//____________________________________________________________________________
+//
+// The images are (depth x height * width) column-major matrices, so that the
+// values of all the channels of a pixel are contiguous. The local views of the
+// output are processed by tiles, whose im2col matrix (nLocalViewPixels x
+// tileSize) is built in a per-thread buffer small enough to stay in the cache,
+// multiplied with the weights and written directly into the output, where the
+// biases and the activation function are applied while the tile is hot.
+
+namespace {
+
+struct TConvGeometry {
+   int inputDepth, inputHeight, inputWidth;
+   int filterHeight, filterWidth;
+   int strideRows, strideCols;
+   int paddingHeight, paddingWidth;
+   int height, width; // of the output
+
+   size_t NLocalViews() const { return (size_t)height * width; }
+   size_t NLocalViewPixels() const { return (size_t)inputDepth * filterHeight * filterWidth; }
+};
+
+/// number of local views per tile, for a tile of about 128 kB
+template <typename AFloat>
+size_t ConvTileSize(const TConvGeometry &g)
+{
+   size_t n = (128 * 1024 / sizeof(AFloat)) / g.NLocalViewPixels();
+   return std::max<size_t>(1, std::min(n, g.NLocalViews()));
+}
+
+/// per-thread work space of the kernels, reused between the calls
+template <typename AFloat>
+AFloat *ConvWorkspace(size_t n)
+{
+   thread_local std::vector<AFloat> buffer;
+   if (buffer.size() < n) buffer.resize(n);
+   return buffer.data();
+}
+
+/// im2col of the local views [first, first + n) of the image x into the
+/// (nLocalViewPixels x n) column-major matrix tile
+template <typename AFloat>
+void Im2colTile(AFloat *tile, const AFloat *x, const TConvGeometry &g, size_t first, size_t n)
+{
+   for (size_t v = first; v < first + n; v++) {
+      const int ih0 = int(v / g.width) * g.strideRows - g.paddingHeight;
+      const int iw0 = int(v % g.width) * g.strideCols - g.paddingWidth;
+      for (int m = 0; m < g.inputDepth; m++) {
+         for (int kh = 0; kh < g.filterHeight; kh++) {
+            const int ih = ih0 + kh;
+            const bool rowInside = ih >= 0 && ih < g.inputHeight;
+            for (int kw = 0; kw < g.filterWidth; kw++) {
+               const int iw = iw0 + kw;
+               *tile++ = (rowInside && iw >= 0 && iw < g.inputWidth) ? x[(ih * g.inputWidth + iw) * g.inputDepth + m] : 0;
+            }
+         }
+      }
+   }
+}
+
+/// col2im: add the (nLocalViewPixels x n) matrix tile of the local views
+/// [first, first + n) to the pixels of the image dx they come from
+template <typename AFloat>
+void Col2imTile(AFloat *dx, const AFloat *tile, const TConvGeometry &g, size_t first, size_t n)
+{
+   for (size_t v = first; v < first + n; v++) {
+      const int ih0 = int(v / g.width) * g.strideRows - g.paddingHeight;
+      const int iw0 = int(v % g.width) * g.strideCols - g.paddingWidth;
+      for (int m = 0; m < g.inputDepth; m++) {
+         for (int kh = 0; kh < g.filterHeight; kh++) {
+            const int ih = ih0 + kh;
+            const bool rowInside = ih >= 0 && ih < g.inputHeight;
+            for (int kw = 0; kw < g.filterWidth; kw++, tile++) {
+               const int iw = iw0 + kw;
+               if (rowInside && iw >= 0 && iw < g.inputWidth) dx[(ih * g.inputWidth + iw) * g.inputDepth + m] += *tile;
+            }
+         }
+      }
+   }
+}
+
+/// apply the activation function to the n values a, and write its
+/// derivative to df, as evaluate and evaluateDerivative
+template <typename AFloat>
+void ActivateTile(AFloat *a, AFloat *df, size_t n, EActivationFunction f)
+{
+   switch (f) {
+   case EActivationFunction::kIdentity:
+      for (size_t j = 0; j < n; j++) df[j] = 1;
+      break;
+   case EActivationFunction::kRelu:
+      for (size_t j = 0; j < n; j++) {
+         df[j] = (a[j] < 0.0) ? 0.0 : 1.0;
+         a[j] = (a[j] < 0.0) ? 0.0 : a[j];
+      }
+      break;
+   case EActivationFunction::kSigmoid:
+      for (size_t j = 0; j < n; j++) {
+         AFloat sig = 1.0 / (1.0 + exp(-a[j]));
+         df[j] = sig * (1.0 - sig);
+         a[j] = sig;
+      }
+      break;
+   case EActivationFunction::kTanh:
+      for (size_t j = 0; j < n; j++) {
+         AFloat x = a[j];
+         AFloat t = TANH_IMPL_X;
+         df[j] = 1 - t * t;
+         a[j] = t;
+      }
+      break;
+   case EActivationFunction::kSymmRelu:
+      for (size_t j = 0; j < n; j++) {
+         df[j] = (a[j] < 0.0) ? -1.0 : 1.0;
+         a[j] = fabs(a[j]);
+      }
+      break;
+   case EActivationFunction::kSoftSign:
+      for (size_t j = 0; j < n; j++) {
+         AFloat d = 1.0 + fabs(a[j]);
+         df[j] = 1.0 / (d * d);
+         a[j] = a[j] / d;
+      }
+      break;
+   case EActivationFunction::kGauss:
+      for (size_t j = 0; j < n; j++) {
+         AFloat e = exp(-a[j] * a[j]);
+         df[j] = -2.0 * a[j] * e;
+         a[j] = e;
+      }
+      break;
+   }
+}
+
+} // namespace
+
 //____________________________________________________________________________
 template <typename AFloat>
 void TCpu<AFloat>::ConvLayerForward(std::vector<TCpuMatrix<AFloat>> & output,
@@ -300,40 +448,62 @@ void TCpu<AFloat>::ConvLayerForward(std::vector<TCpuMatrix<AFloat>> & output,
 {
    size_t height = calculateDimension(params.inputHeight, params.filterHeight, params.paddingHeight, params.strideRows);
    size_t width = calculateDimension(params.inputWidth, params.filterWidth, params.paddingWidth, params.strideCols);
-   size_t nLocalViews = height * width;
-   size_t nLocalViewPixels = params.inputDepth * params.filterHeight * params.filterWidth;
 
    R__ASSERT( input.size() > 0);
-   std::vector<int> forwardIndices(nLocalViews * nLocalViewPixels);
-   Im2colIndices(forwardIndices, input[0], nLocalViews, params.inputHeight, params.inputWidth, params.filterHeight,
-                 params.filterWidth, params.strideRows, params.strideCols, params.paddingHeight, params.paddingWidth);
-
-   //this should fix multi-thread inizializations of arrays
-   TCpuMatrix<AFloat>::InitializeOneVector(nLocalViews);
-   TCpuMatrix<AFloat>::InitializeOneVector(output[0].GetNcols());   // since it is used in AddCOnvBiases
-
-
-   auto f = [&] (UInt_t i)
+   const TConvGeometry g = {(int)params.inputDepth,   (int)params.inputHeight,  (int)params.inputWidth,
+                            (int)params.filterHeight, (int)params.filterWidth,  (int)params.strideRows,
+                            (int)params.strideCols,   (int)params.paddingHeight, (int)params.paddingWidth,
+                            (int)height,              (int)width};
+   const size_t nLocalViews = g.NLocalViews();
+   const size_t nLocalViewPixels = g.NLocalViewPixels();
+   const size_t nFilters = weights.GetNrows();
+   const size_t batchSize = input.size();
+   R__ASSERT(weights.GetNcols() == nLocalViewPixels);
+   R__ASSERT(output[0].GetNrows() == nFilters && output[0].GetNcols() == nLocalViews);
+
+   // the work is split in tiles of local views of each event, and in blocks of
+   // filters when there are not enough tiles to occupy all the threads
+   const size_t tileSize = ConvTileSize<AFloat>(g);
+   const size_t nTiles = (nLocalViews + tileSize - 1) / tileSize;
+   const size_t nCpu = TMVA::Config::Instance().GetNCpu();
+   size_t nFilterBlocks = 1;
+   if (batchSize * nTiles < nCpu) nFilterBlocks = std::min(nFilters, (nCpu + batchSize * nTiles - 1) / (batchSize * nTiles));
+   const size_t filterBlockSize = (nFilters + nFilterBlocks - 1) / nFilterBlocks;
+
+   const AFloat *w = weights.GetRawDataPointer();
+   const AFloat *b = biases.GetRawDataPointer();
+
+   auto f = [&] (UInt_t workItem)
    {
-       // dropout not yet implemented for CNN
-       // if (applyDropout && (dropoutProbability != 1.0)) {
-       //    Dropout(input[i], dropoutProbability);
-       // }
-
-       TCpuMatrix<AFloat> inputTr(nLocalViews, nLocalViewPixels);
-       //inputTr.Zero();   // this is not thread safe
-
-       Im2colFast(inputTr, input[i], forwardIndices);
-
-       MultiplyTranspose(output[i], weights, inputTr);
-       AddConvBiases(output[i], biases);
-
-       evaluateDerivative<TCpu<AFloat>>(derivatives[i], activFunc, output[i]);
-       evaluate<TCpu<AFloat>>(output[i], activFunc);
-
+      const size_t i = workItem / (nTiles * nFilterBlocks);
+      const size_t first = (workItem / nFilterBlocks) % nTiles * tileSize;
+      const size_t f0 = workItem % nFilterBlocks * filterBlockSize;
+      if (f0 >= nFilters) return;
+
+      int m = std::min(filterBlockSize, nFilters - f0);
+      int n = std::min(tileSize, nLocalViews - first);
+      int k = nLocalViewPixels;
+      int ldw = nFilters;
+
+      AFloat *tile = ConvWorkspace<AFloat>(nLocalViewPixels * n);
+      Im2colTile(tile, input[i].GetRawDataPointer(), g, first, n);
+
+      char transa = 'N';
+      char transb = 'N';
+      AFloat alpha = 1.0;
+      AFloat beta = 0.0;
+      AFloat *out = output[i].GetRawDataPointer() + first * nFilters + f0;
+      ::TMVA::DNN::Blas::Gemm(&transa, &transb, &m, &n, &k, &alpha, w + f0, &ldw, tile, &k, &beta, out, &ldw);
+
+      AFloat *df = derivatives[i].GetRawDataPointer() + first * nFilters + f0;
+      for (int v = 0; v < n; v++) {
+         AFloat *a = out + v * nFilters;
+         for (int j = 0; j < m; j++) a[j] += b[f0 + j];
+         ActivateTile(a, df + v * nFilters, m, activFunc);
+      }
    };
 
-   TCpuMatrix<AFloat>::GetThreadExecutor().Foreach(f, ROOT::TSeqI(input.size()));
+   TCpuMatrix<AFloat>::GetThreadExecutor().Foreach(f, ROOT::TSeqI(batchSize * nTiles * nFilterBlocks));
 }
 
 //____________________________________________________________________________
@@ -347,26 +517,87 @@ void TCpu<AFloat>::ConvLayerBackward(std::vector<TCpuMatrix<AFloat>> &activation
                                      size_t inputHeight, size_t inputWidth, size_t depth, size_t height, size_t width,
                                      size_t filterDepth, size_t filterHeight, size_t filterWidth, size_t nLocalViews)
 {
-   // Update derivatives
-   //    size_t m, n;
-   //    m = activationGradients[0].GetNrows();
-   //    n = activationGradients[0].GetNcols();
+   // only unit strides are supported: the zero paddings follow from the sizes
+   const TConvGeometry g = {(int)filterDepth,  (int)inputHeight, (int)inputWidth, (int)filterHeight,
+                            (int)filterWidth,  1,                1,
+                            (int)(height - inputHeight + filterHeight - 1) / 2,
+                            (int)(width - inputWidth + filterWidth - 1) / 2,
+                            (int)height,       (int)width};
+   R__ASSERT(nLocalViews == g.NLocalViews());
+   const size_t nLocalViewPixels = g.NLocalViewPixels();
+   const size_t inputSize = (size_t)filterDepth * inputHeight * inputWidth;
+   const bool computeActivationGradients = activationGradientsBackward.size() > 0;
+   R__ASSERT(weightGradients.GetNrows() == depth && weightGradients.GetNcols() == nLocalViewPixels);
+
+   const size_t tileSize = ConvTileSize<AFloat>(g);
+
+   // the events are processed in chunks, each accumulating its own weight and
+   // bias gradients, which are summed at the end in a fixed order
+   const size_t nChunks = std::min<size_t>(batchSize, TMVA::Config::Instance().GetNCpu());
+   const size_t chunkSize = (batchSize + nChunks - 1) / nChunks;
+   const size_t nWeights = depth * nLocalViewPixels;
+   std::vector<AFloat> partialGradients(nChunks * (nWeights + depth), 0.0);
+
+   const AFloat *w = weights.GetRawDataPointer();
+
+   auto f = [&] (UInt_t chunk)
+   {
+      AFloat *dw = partialGradients.data() + chunk * (nWeights + depth);
+      AFloat *db = dw + nWeights;
+
+      for (size_t i = chunk * chunkSize; i < std::min(batchSize, (chunk + 1) * chunkSize); i++) {
+         AFloat *dfi = df[i].GetRawDataPointer();
+         const AFloat *grad = activationGradients[i].GetRawDataPointer();
+         for (size_t j = 0; j < depth * nLocalViews; j++) dfi[j] *= grad[j];
+
+         AFloat *dx = nullptr;
+         if (computeActivationGradients) {
+            dx = activationGradientsBackward[i].GetRawDataPointer();
+            std::fill(dx, dx + inputSize, 0.0);
+         }
 
-   for (size_t i = 0; i < batchSize; i++) {
-      // Compute element-wise product.
-      Hadamard(df[i], activationGradients[i]);
-   }
+         for (size_t first = 0; first < nLocalViews; first += tileSize) {
+            int m = depth;
+            int n = std::min(tileSize, nLocalViews - first);
+            int k = nLocalViewPixels;
+            AFloat alpha = 1.0;
+            AFloat beta = 1.0;
+            AFloat zero = 0.0;
+            const AFloat *dfTile = dfi + first * depth;
+            AFloat *tile = ConvWorkspace<AFloat>(nLocalViewPixels * n);
+
+            // weight gradients: dW += df_tile * im2col(x)_tile^T
+            char transa = 'N';
+            char transb = 'T';
+            Im2colTile(tile, activationsBackward[i].GetRawDataPointer(), g, first, n);
+            ::TMVA::DNN::Blas::Gemm(&transa, &transb, &m, &k, &n, &alpha, dfTile, &m, tile, &k, &beta, dw, &m);
+
+            // bias gradients
+            for (int v = 0; v < n; v++) {
+               for (int j = 0; j < m; j++) db[j] += dfTile[v * depth + j];
+            }
 
-   // Calculate the activation gradients of the previous layer
-   CalculateConvActivationGradients(activationGradientsBackward, df, weights, batchSize, inputHeight, inputWidth, depth,
-                                    height, width, filterDepth, filterHeight, filterWidth);
+            // activation gradients: dx += col2im(W^T * df_tile)
+            if (computeActivationGradients) {
+               transa = 'T';
+               transb = 'N';
+               ::TMVA::DNN::Blas::Gemm(&transa, &transb, &k, &n, &m, &alpha, w, &m, dfTile, &m, &zero, tile, &k);
+               Col2imTile(dx, tile, g, first, n);
+            }
+         }
+      }
+   };
 
-   // Calculate the weight gradients
-   CalculateConvWeightGradients(weightGradients, df, activationsBackward, batchSize, inputHeight, inputWidth, depth,
-                                height, width, filterDepth, filterHeight, filterWidth, nLocalViews);
+   TCpuMatrix<AFloat>::GetThreadExecutor().Foreach(f, ROOT::TSeqI(nChunks));
 
-   // Calculate the bias gradients
-   CalculateConvBiasGradients(biasGradients, df, batchSize, depth, nLocalViews);
+   weightGradients.Zero();
+   biasGradients.Zero();
+   AFloat *weightGradientData = weightGradients.GetRawDataPointer();
+   for (size_t chunk = 0; chunk < nChunks; chunk++) {
+      const AFloat *dw = partialGradients.data() + chunk * (nWeights + depth);
+      for (size_t j = 0; j < nWeights; j++) weightGradientData[j] += dw[j];
+      for (size_t j = 0; j < depth; j++) biasGradients(j, 0) += dw[nWeights + j];
+   }
 }
 
 //____________________________________________________________________________
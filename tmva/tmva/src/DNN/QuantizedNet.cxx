@@ -0,0 +1,440 @@
+// @(#)root/tmva/tmva/dnn:$Id$
+
+/**********************************************************************************
+ * Project: TMVA - a Root-integrated toolkit for multivariate data analysis       *
+ * Package: TMVA                                                                  *
+ * Class  : TQuantizedNet                                                         *
+ * Web    : http://tmva.sourceforge.net                                           *
+ *                                                                                *
+ * Description:                                                                   *
+ *      Inference-only copy of a trained neural network, with int8 weights and    *
+ *      int8 or bfloat16 activations                                              *
+ *                                                                                *
+ * Copyright (c) 2018:                                                            *
+ *      CERN, Switzerland                                                         *
+ *                                                                                *
+ * Redistribution and use in source and binary forms, with or without             *
+ * modification, are permitted according to the terms listed in LICENSE           *
+ * (http://tmva.sourceforge.net/LICENSE)                                          *
+ **********************************************************************************/
+
+#include "TMVA/DNN/QuantizedNet.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <limits>
+
+namespace TMVA {
+namespace DNN {
+
+namespace {
+
+/// Number of events whose dense layers are computed together, each row of
+/// weights being used for all of them while it is in the cache.
+constexpr size_t kEventBlock = 16;
+
+/// Size in bytes of the im2col patches of a convolution computed for all the
+/// filters before moving to the next ones.
+constexpr size_t kPatchTileSize = 32 * 1024;
+
+/// bfloat16: upper half of a float, rounded to the nearest even.
+inline std::uint16_t FloatToBF16(Float_t x)
+{
+   std::uint32_t u;
+   std::memcpy(&u, &x, sizeof(u));
+   if ((u & 0x7fffffff) > 0x7f800000) return (u >> 16) | 0x40; // quiet NaN
+   u += 0x7fff + ((u >> 16) & 1);
+   return u >> 16;
+}
+
+inline Float_t ToFloat(Float_t x) { return x; }
+inline Float_t ToFloat(std::int8_t x) { return x; }
+inline Float_t ToFloat(std::uint16_t x)
+{
+   std::uint32_t u = std::uint32_t(x) << 16;
+   Float_t f;
+   std::memcpy(&f, &u, sizeof(f));
+   return f;
+}
+
+/// Float dot product, with eight independent partial sums so that the loop
+/// can be vectorized without reordering the additions.
+template <typename Weight_t, typename Input_t>
+inline Float_t Dot(const Weight_t *w, const Input_t *x, size_t n)
+{
+   Float_t acc[8] = {0, 0, 0, 0, 0, 0, 0, 0};
+   size_t i = 0;
+   for (; i + 8 <= n; i += 8) {
+      for (size_t k = 0; k < 8; k++) {
+         acc[k] += ToFloat(w[i + k]) * ToFloat(x[i + k]);
+      }
+   }
+   for (; i < n; i++) acc[0] += ToFloat(w[i]) * ToFloat(x[i]);
+   return ((acc[0] + acc[1]) + (acc[2] + acc[3])) + ((acc[4] + acc[5]) + (acc[6] + acc[7]));
+}
+
+/// Integer dot product of int8 vectors, accumulated in int32 by blocks short
+/// enough not to overflow (127 * 127 * 2^16 < 2^31).
+inline Float_t Dot(const std::int8_t *w, const std::int8_t *x, size_t n)
+{
+   std::int64_t sum = 0;
+   for (size_t first = 0; first < n; first += 65536) {
+      const size_t last = std::min(n, first + 65536);
+      std::int32_t acc = 0;
+      for (size_t i = first; i < last; i++) {
+         acc += std::int32_t(w[i]) * std::int32_t(x[i]);
+      }
+      sum += acc;
+   }
+   return sum;
+}
+
+/// Conversion of the n inputs of a layer to the type of its products; returns
+/// the scale of the converted values.
+inline Float_t Convert(const Float_t *x, size_t n, Float_t *y)
+{
+   std::copy(x, x + n, y);
+   return 1;
+}
+
+inline Float_t Convert(const Float_t *x, size_t n, std::uint16_t *y)
+{
+   for (size_t i = 0; i < n; i++) y[i] = FloatToBF16(x[i]);
+   return 1;
+}
+
+inline Float_t Convert(const Float_t *x, size_t n, std::int8_t *y)
+{
+   Float_t maximum = 0;
+   for (size_t i = 0; i < n; i++) maximum = std::max(maximum, std::abs(x[i]));
+   if (maximum == 0 || !std::isfinite(maximum)) {
+      std::fill(y, y + n, 0);
+      return 0;
+   }
+   const Float_t inv = 127 / maximum;
+   for (size_t i = 0; i < n; i++) {
+      Float_t v = x[i] * inv;
+      // the NaN are mapped to zero
+      y[i] = (v == v) ? std::int8_t(v + (v < 0 ? -0.5f : 0.5f)) : 0;
+   }
+   return maximum / 127;
+}
+
+//______________________________________________________________________________
+inline void Activate(Float_t *x, size_t n, EActivationFunction f)
+{
+   switch (f) {
+   case EActivationFunction::kIdentity: break;
+   case EActivationFunction::kRelu:
+      for (size_t i = 0; i < n; i++) x[i] = std::max(Float_t(0), x[i]);
+      break;
+   case EActivationFunction::kSigmoid:
+      for (size_t i = 0; i < n; i++) x[i] = 1 / (1 + std::exp(-x[i]));
+      break;
+   case EActivationFunction::kTanh:
+      for (size_t i = 0; i < n; i++) x[i] = std::tanh(x[i]);
+      break;
+   case EActivationFunction::kSymmRelu:
+      for (size_t i = 0; i < n; i++) x[i] = std::abs(x[i]);
+      break;
+   case EActivationFunction::kSoftSign:
+      for (size_t i = 0; i < n; i++) x[i] = x[i] / (1 + std::abs(x[i]));
+      break;
+   case EActivationFunction::kGauss:
+      for (size_t i = 0; i < n; i++) x[i] = std::exp(-x[i] * x[i]);
+      break;
+   }
+}
+
+//______________________________________________________________________________
+inline size_t OutputDimension(size_t imgDim, size_t fltDim, size_t padding, size_t stride)
+{
+   return (imgDim - fltDim + 2 * padding) / stride + 1;
+}
+
+} // namespace
+
+//______________________________________________________________________________
+TQuantizedNet::TQuantizedNet(size_t nInputs, EInferencePrecision precision, EOutputFunction f)
+   : fNInputs(nInputs), fNOutputs(nInputs), fPrecision(precision), fOutputFunction(f), fMaxWeightError(0), fLayers()
+{
+}
+
+//______________________________________________________________________________
+bool TQuantizedNet::AddDenseLayer(size_t width, const std::vector<Float_t> &weights,
+                                  const std::vector<Float_t> &biases, EActivationFunction f)
+{
+   TLayerInfo layer;
+   layer.fType = ELayerType::kDense;
+   layer.fInputDepth = 1;
+   layer.fInputHeight = 1;
+   layer.fInputWidth = fNOutputs;
+   layer.fDepth = width;
+   layer.fHeight = 1;
+   layer.fWidth = 1;
+   layer.fFilterHeight = layer.fFilterWidth = 1;
+   layer.fStrideRows = layer.fStrideCols = 1;
+   layer.fPaddingHeight = layer.fPaddingWidth = 0;
+   layer.fNLocalViewPixels = fNOutputs;
+   layer.fF = f;
+   return AddWeightedLayer(layer, weights, biases);
+}
+
+//______________________________________________________________________________
+bool TQuantizedNet::AddConvLayer(size_t inputDepth, size_t inputHeight, size_t inputWidth, size_t depth,
+                                 size_t filterHeight, size_t filterWidth, size_t strideRows, size_t strideCols,
+                                 size_t paddingHeight, size_t paddingWidth, const std::vector<Float_t> &weights,
+                                 const std::vector<Float_t> &biases, EActivationFunction f)
+{
+   if (inputDepth * inputHeight * inputWidth != fNOutputs || strideRows == 0 || strideCols == 0 ||
+       inputHeight + 2 * paddingHeight < filterHeight || inputWidth + 2 * paddingWidth < filterWidth) {
+      return false;
+   }
+   TLayerInfo layer;
+   layer.fType = ELayerType::kConv;
+   layer.fInputDepth = inputDepth;
+   layer.fInputHeight = inputHeight;
+   layer.fInputWidth = inputWidth;
+   layer.fDepth = depth;
+   layer.fHeight = OutputDimension(inputHeight, filterHeight, paddingHeight, strideRows);
+   layer.fWidth = OutputDimension(inputWidth, filterWidth, paddingWidth, strideCols);
+   layer.fFilterHeight = filterHeight;
+   layer.fFilterWidth = filterWidth;
+   layer.fStrideRows = strideRows;
+   layer.fStrideCols = strideCols;
+   layer.fPaddingHeight = paddingHeight;
+   layer.fPaddingWidth = paddingWidth;
+   layer.fNLocalViewPixels = inputDepth * filterHeight * filterWidth;
+   layer.fF = f;
+   return AddWeightedLayer(layer, weights, biases);
+}
+
+//______________________________________________________________________________
+bool TQuantizedNet::AddMaxPoolLayer(size_t inputDepth, size_t inputHeight, size_t inputWidth, size_t frameHeight,
+                                    size_t frameWidth, size_t strideRows, size_t strideCols)
+{
+   if (inputDepth * inputHeight * inputWidth != fNOutputs || strideRows == 0 || strideCols == 0 ||
+       inputHeight < frameHeight || inputWidth < frameWidth) {
+      return false;
+   }
+   TLayerInfo layer;
+   layer.fType = ELayerType::kMaxPool;
+   layer.fInputDepth = inputDepth;
+   layer.fInputHeight = inputHeight;
+   layer.fInputWidth = inputWidth;
+   layer.fDepth = inputDepth;
+   layer.fHeight = OutputDimension(inputHeight, frameHeight, 0, strideRows);
+   layer.fWidth = OutputDimension(inputWidth, frameWidth, 0, strideCols);
+   layer.fFilterHeight = frameHeight;
+   layer.fFilterWidth = frameWidth;
+   layer.fStrideRows = strideRows;
+   layer.fStrideCols = strideCols;
+   layer.fPaddingHeight = layer.fPaddingWidth = 0;
+   layer.fNLocalViewPixels = frameHeight * frameWidth;
+   layer.fF = EActivationFunction::kIdentity;
+
+   fNOutputs = layer.fDepth * layer.fHeight * layer.fWidth;
+   fLayers.push_back(std::move(layer));
+   return true;
+}
+
+//______________________________________________________________________________
+bool TQuantizedNet::AddWeightedLayer(TLayerInfo &layer, const std::vector<Float_t> &weights,
+                                     const std::vector<Float_t> &biases)
+{
+   const size_t n = layer.fNLocalViewPixels;
+   if (n == 0 || weights.size() != layer.fDepth * n || biases.size() != layer.fDepth) return false;
+
+   layer.fBiases = biases;
+   if (fPrecision == EInferencePrecision::kFloat) {
+      layer.fWeights = weights;
+      layer.fScales.assign(layer.fDepth, 1);
+   } else {
+      // symmetric quantization of each neuron or filter
+      layer.fQWeights.resize(weights.size());
+      layer.fScales.resize(layer.fDepth);
+      for (size_t i = 0; i < layer.fDepth; i++) {
+         const Float_t *w = &weights[i * n];
+         Float_t maximum = 0;
+         for (size_t j = 0; j < n; j++) maximum = std::max(maximum, std::abs(w[j]));
+         const Float_t scale = (maximum > 0) ? maximum / 127 : 1;
+         layer.fScales[i] = scale;
+         for (size_t j = 0; j < n; j++) {
+            const Float_t q = std::round(w[j] / scale);
+            layer.fQWeights[i * n + j] = std::int8_t(q);
+            if (maximum > 0) fMaxWeightError = std::max(fMaxWeightError, std::abs(q * scale - w[j]) / maximum);
+         }
+      }
+   }
+
+   fNOutputs = layer.fDepth * layer.fHeight * layer.fWidth;
+   fLayers.push_back(std::move(layer));
+   return true;
+}
+
+//______________________________________________________________________________
+size_t TQuantizedNet::GetWeightsSize() const
+{
+   size_t size = 0;
+   for (const auto &layer : fLayers) {
+      size += layer.fWeights.size() * sizeof(Float_t) + layer.fQWeights.size() * sizeof(std::int8_t);
+      if (fPrecision != EInferencePrecision::kFloat) size += layer.fScales.size() * sizeof(Float_t);
+      size += layer.fBiases.size() * sizeof(Float_t);
+   }
+   return size;
+}
+
+//______________________________________________________________________________
+template <typename Weight_t, typename Input_t>
+void TQuantizedNet::ForwardWeighted(const TLayerInfo &layer, const Weight_t *weights, const Float_t *input,
+                                    Float_t *output, size_t nEvents) const
+{
+   const size_t n = layer.fNLocalViewPixels;
+   const size_t nIn = layer.fInputDepth * layer.fInputHeight * layer.fInputWidth;
+   const size_t nOut = layer.fDepth * layer.fHeight * layer.fWidth;
+
+   if (layer.fType == ELayerType::kDense) {
+      // the events of the block are the columns of the product
+      std::vector<Input_t> x(nEvents * n);
+      Float_t scales[kEventBlock];
+      for (size_t e = 0; e < nEvents; e++) {
+         scales[e] = Convert(input + e * nIn, n, &x[e * n]);
+      }
+      for (size_t i = 0; i < layer.fDepth; i++) {
+         const Weight_t *w = weights + i * n;
+         for (size_t e = 0; e < nEvents; e++) {
+            output[e * nOut + i] = Dot(w, &x[e * n], n) * (layer.fScales[i] * scales[e]) + layer.fBiases[i];
+         }
+      }
+   } else {
+      const size_t nViews = layer.fHeight * layer.fWidth;
+      const size_t inputHeight = layer.fInputHeight;
+      const size_t inputWidth = layer.fInputWidth;
+      const size_t tile = std::max<size_t>(1, kPatchTileSize / (n * sizeof(Input_t)));
+      std::vector<Input_t> x(nIn);
+      std::vector<Input_t> patches(nViews * n);
+
+      for (size_t e = 0; e < nEvents; e++) {
+         const Float_t scale = Convert(input + e * nIn, nIn, x.data());
+
+         // im2col, the padding being zero in all the representations
+         Input_t *p = patches.data();
+         for (size_t oh = 0; oh < layer.fHeight; oh++) {
+            for (size_t ow = 0; ow < layer.fWidth; ow++) {
+               for (size_t c = 0; c < layer.fInputDepth; c++) {
+                  const Input_t *xc = &x[c * inputHeight * inputWidth];
+                  for (size_t kh = 0; kh < layer.fFilterHeight; kh++) {
+                     const Long64_t ih = Long64_t(oh * layer.fStrideRows + kh) - Long64_t(layer.fPaddingHeight);
+                     const bool rowInside = ih >= 0 && ih < Long64_t(inputHeight);
+                     for (size_t kw = 0; kw < layer.fFilterWidth; kw++) {
+                        const Long64_t iw = Long64_t(ow * layer.fStrideCols + kw) - Long64_t(layer.fPaddingWidth);
+                        *p++ = (rowInside && iw >= 0 && iw < Long64_t(inputWidth)) ? xc[ih * inputWidth + iw]
+                                                                                   : Input_t(0);
+                     }
+                  }
+               }
+            }
+         }
+
+         Float_t *y = output + e * nOut;
+         for (size_t first = 0; first < nViews; first += tile) {
+            const size_t last = std::min(nViews, first + tile);
+            for (size_t i = 0; i < layer.fDepth; i++) {
+               const Weight_t *w = weights + i * n;
+               const Float_t s = layer.fScales[i] * scale;
+               for (size_t v = first; v < last; v++) {
+                  y[i * nViews + v] = Dot(w, &patches[v * n], n) * s + layer.fBiases[i];
+               }
+            }
+         }
+      }
+   }
+
+   for (size_t e = 0; e < nEvents; e++) {
+      Activate(output + e * nOut, nOut, layer.fF);
+   }
+}
+
+//______________________________________________________________________________
+void TQuantizedNet::ForwardMaxPool(const TLayerInfo &layer, const Float_t *input, Float_t *output,
+                                   size_t nEvents) const
+{
+   const size_t nIn = layer.fInputDepth * layer.fInputHeight * layer.fInputWidth;
+   const size_t nOut = layer.fDepth * layer.fHeight * layer.fWidth;
+   for (size_t e = 0; e < nEvents; e++) {
+      for (size_t c = 0; c < layer.fDepth; c++) {
+         const Float_t *x = input + e * nIn + c * layer.fInputHeight * layer.fInputWidth;
+         Float_t *y = output + e * nOut + c * layer.fHeight * layer.fWidth;
+         for (size_t oh = 0; oh < layer.fHeight; oh++) {
+            for (size_t ow = 0; ow < layer.fWidth; ow++) {
+               Float_t value = -std::numeric_limits<Float_t>::max();
+               for (size_t kh = 0; kh < layer.fFilterHeight; kh++) {
+                  const Float_t *row = x + (oh * layer.fStrideRows + kh) * layer.fInputWidth + ow * layer.fStrideCols;
+                  for (size_t kw = 0; kw < layer.fFilterWidth; kw++) {
+                     value = std::max(value, row[kw]);
+                  }
+               }
+               y[oh * layer.fWidth + ow] = value;
+            }
+         }
+      }
+   }
+}
+
+//______________________________________________________________________________
+void TQuantizedNet::Evaluate(const Float_t *input, size_t nEvents, Float_t *output) const
+{
+   size_t maxSize = fNInputs;
+   for (const auto &layer : fLayers) {
+      maxSize = std::max(maxSize, layer.fDepth * layer.fHeight * layer.fWidth);
+   }
+   std::vector<Float_t> current(kEventBlock * maxSize);
+   std::vector<Float_t> next(kEventBlock * maxSize);
+
+   for (size_t first = 0; first < nEvents; first += kEventBlock) {
+      const size_t n = std::min(kEventBlock, nEvents - first);
+      std::copy(input + first * fNInputs, input + (first + n) * fNInputs, current.begin());
+
+      for (const auto &layer : fLayers) {
+         if (layer.fType == ELayerType::kMaxPool) {
+            ForwardMaxPool(layer, current.data(), next.data(), n);
+         } else {
+            switch (fPrecision) {
+            case EInferencePrecision::kFloat:
+               ForwardWeighted<Float_t, Float_t>(layer, layer.fWeights.data(), current.data(), next.data(), n);
+               break;
+            case EInferencePrecision::kInt8:
+               ForwardWeighted<std::int8_t, std::int8_t>(layer, layer.fQWeights.data(), current.data(), next.data(),
+                                                         n);
+               break;
+            case EInferencePrecision::kInt8BF16:
+               ForwardWeighted<std::int8_t, std::uint16_t>(layer, layer.fQWeights.data(), current.data(),
+                                                           next.data(), n);
+               break;
+            }
+         }
+         std::swap(current, next);
+      }
+
+      for (size_t e = 0; e < n; e++) {
+         const Float_t *x = &current[e * fNOutputs];
+         Float_t *y = output + (first + e) * fNOutputs;
+         switch (fOutputFunction) {
+         case EOutputFunction::kIdentity: std::copy(x, x + fNOutputs, y); break;
+         case EOutputFunction::kSigmoid:
+            for (size_t i = 0; i < fNOutputs; i++) y[i] = 1 / (1 + std::exp(-x[i]));
+            break;
+         case EOutputFunction::kSoftmax: {
+            Float_t sum = 0;
+            for (size_t i = 0; i < fNOutputs; i++) sum += std::exp(x[i]);
+            for (size_t i = 0; i < fNOutputs; i++) y[i] = std::exp(x[i]) / sum;
+            break;
+         }
+         }
+      }
+   }
+}
+
+} // namespace DNN
+} // namespace TMVA
@@ -0,0 +1,113 @@
+// @(#)root/tmva/tmva/dnn:$Id$
+
+/**********************************************************************************
+ * Project: TMVA - a Root-integrated toolkit for multivariate data analysis       *
+ * Package: TMVA                                                                  *
+ * Class  : TTreeStreamingSource                                                  *
+ * Web    : http://tmva.sourceforge.net                                           *
+ *                                                                                *
+ * Description:                                                                   *
+ *      Streaming source of training events reading a TTree                       *
+ *                                                                                *
+ * Copyright (c) 2018:                                                            *
+ *      CERN, Switzerland                                                         *
+ *                                                                                *
+ * Redistribution and use in source and binary forms, with or without             *
+ * modification, are permitted according to the terms listed in LICENSE           *
+ * (http://tmva.sourceforge.net/LICENSE)                                          *
+ **********************************************************************************/
+
+#include "TMVA/DNN/StreamingDataLoader.h"
+
+#include "TBranch.h"
+#include "TLeaf.h"
+#include "TTree.h"
+
+#include <algorithm>
+
+namespace TMVA {
+namespace DNN {
+
+//______________________________________________________________________________
+TTreeStreamingSource::TTreeStreamingSource(TTree *tree, const std::vector<std::string> &inputs,
+                                           const std::vector<std::string> &outputs, const std::string &weight,
+                                           Long64_t firstEntry, Long64_t lastEntry)
+   : fTree(tree), fInputs(inputs), fOutputs(outputs), fWeight(weight), fFirstEntry(firstEntry),
+     fLastEntry(lastEntry), fEntry(firstEntry), fTreeNumber(-1)
+{
+   if (fTree == nullptr) {
+      throw std::runtime_error("TTreeStreamingSource: no tree given");
+   }
+   Long64_t nEntries = fTree->GetEntries();
+   if (fLastEntry < 0 || fLastEntry > nEntries) fLastEntry = nEntries;
+   if (fFirstEntry < 0) fFirstEntry = 0;
+   if (fFirstEntry > fLastEntry) fFirstEntry = fLastEntry;
+   fEntry = fFirstEntry;
+}
+
+//______________________________________________________________________________
+void TTreeStreamingSource::UpdateLeaves()
+{
+   fTreeNumber = fTree->GetTreeNumber();
+   TTree *tree = fTree->GetTree();
+
+   std::vector<std::string> names(fInputs);
+   names.insert(names.end(), fOutputs.begin(), fOutputs.end());
+   if (!fWeight.empty()) names.push_back(fWeight);
+
+   fLeaves.clear();
+   for (const std::string &name : names) {
+      TLeaf *leaf = tree->GetLeaf(name.c_str());
+      if (leaf == nullptr) {
+         throw std::runtime_error("TTreeStreamingSource: no leaf " + name + " in tree " + tree->GetName());
+      }
+      fLeaves.push_back(leaf);
+   }
+}
+
+//______________________________________________________________________________
+size_t TTreeStreamingSource::Read(size_t nEvents, Float_t *inputs, Float_t *outputs, Float_t *weights)
+{
+   size_t nInputs  = fInputs.size();
+   size_t nOutputs = fOutputs.size();
+
+   size_t n = 0;
+   while (n < nEvents && fEntry < fLastEntry) {
+      Long64_t localEntry = fTree->LoadTree(fEntry);
+      if (localEntry < 0) {
+         throw std::runtime_error("TTreeStreamingSource: cannot load entry " + std::to_string(fEntry));
+      }
+      if (fTree->GetTreeNumber() != fTreeNumber) UpdateLeaves();
+
+      // the entries of the chunk in the current tree of the chain
+      Long64_t nTreeEntries = fTree->GetTree()->GetEntries() - localEntry;
+      size_t nRead = std::min<Long64_t>(std::min<Long64_t>(nEvents - n, fLastEntry - fEntry), nTreeEntries);
+
+      // read them by columns, one branch after the other
+      for (size_t j = 0; j < fLeaves.size(); j++) {
+         Float_t *column = weights + n;
+         size_t stride = 1;
+         if (j < nInputs) {
+            column = inputs + n * nInputs + j;
+            stride = nInputs;
+         } else if (j < nInputs + nOutputs) {
+            column = outputs + n * nOutputs + j - nInputs;
+            stride = nOutputs;
+         }
+         TLeaf *leaf = fLeaves[j];
+         TBranch *branch = leaf->GetBranch();
+         for (size_t i = 0; i < nRead; i++) {
+            branch->GetEntry(localEntry + i);
+            column[i * stride] = leaf->GetValue(0);
+         }
+      }
+      if (fWeight.empty()) std::fill(weights + n, weights + n + nRead, 1.0);
+
+      n += nRead;
+      fEntry += nRead;
+   }
+   return n;
+}
+
+} // namespace DNN
+} // namespace TMVA
@@ -876,6 +876,341 @@ UInt_t TMVA::DecisionTree::BuildTree( const std::vector<const TMVA::Event*> & ev
 
 #endif
 
+////////////////////////////////////////////////////////////////////////////////
+/// call func(ivar) for all the variables, in parallel if multi-threading is enabled
+
+template <class F>
+static void ForEachVariable( F func, UInt_t nVars )
+{
+#ifdef R__USE_IMT
+   TMVA::Config::Instance().GetThreadExecutor().Foreach(func, ROOT::TSeqU(nVars));
+#else
+   for (UInt_t ivar=0; ivar<nVars; ivar++) func(ivar);
+#endif
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// quantize the input variables of the events in nBins (at most 256) bins
+/// containing similar numbers of events. The bin of a value is the number
+/// of cut values smaller than or equal to it, hence a cut between the bins
+/// k and k+1 corresponds to the cut value fCuts[k] of a DecisionTreeNode.
+
+void TMVA::DecisionTree::BinnedSample::Fill( const EventConstList & eventSample, UInt_t nVars, UInt_t nBins )
+{
+   UInt_t nEvents = eventSample.size();
+   if (nBins > 256) nBins = 256;
+   if (nBins < 2) nBins = 2;
+
+   fIndex.clear();
+   fIndex.reserve(nEvents);
+   for (UInt_t iev=0; iev<nEvents; iev++) fIndex[eventSample[iev]] = iev;
+
+   fCuts.assign(nVars, std::vector<Float_t>());
+   fBins.assign(nVars, std::vector<UChar_t>(nEvents));
+
+   auto fillVariable = [this, &eventSample, nEvents, nBins](UInt_t ivar) {
+      std::vector<Float_t> values(nEvents);
+      for (UInt_t iev=0; iev<nEvents; iev++) values[iev] = eventSample[iev]->GetValueFast(ivar);
+      std::vector<Float_t> sorted(values);
+      std::sort(sorted.begin(), sorted.end());
+
+      // quantiles, without duplicates and without a cut below the smallest value
+      std::vector<Float_t> & cuts = fCuts[ivar];
+      for (UInt_t ibin=1; ibin<nBins; ibin++) {
+         Float_t cut = sorted[(ULong64_t)ibin*nEvents/nBins];
+         if (cut > sorted.front() && (cuts.empty() || cut > cuts.back())) cuts.push_back(cut);
+      }
+
+      std::vector<UChar_t> & bins = fBins[ivar];
+      for (UInt_t iev=0; iev<nEvents; iev++) {
+         bins[iev] = std::upper_bound(cuts.begin(), cuts.end(), values[iev]) - cuts.begin();
+      }
+      return 0;
+   };
+   ForEachVariable(fillVariable, nVars);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// release the memory of the binned sample
+
+void TMVA::DecisionTree::BinnedSample::Clear()
+{
+   std::vector< std::vector<Float_t> >().swap(fCuts);
+   std::vector< std::vector<UChar_t> >().swap(fBins);
+   std::unordered_map<const TMVA::Event*, UInt_t>().swap(fIndex);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// event information used in the node splitting of BuildTreeHist.
+/// The histograms of a node hold for each bin of each variable the sums of
+/// the gradients, the hessians, the weights and the number of events.
+
+struct TMVA::DecisionTree::HistTrainingData {
+   const BinnedSample* fBinned;
+   std::vector<UInt_t> fOrder;        // events (in the event sample) ordered by node
+   std::vector<UInt_t> fIndex;        // position of the events in the binned sample
+   std::vector<Double_t> fGrad;       // weight * target
+   std::vector<Double_t> fHess;       // weight * second derivative of the loss
+   std::vector<Double_t> fWeight;
+   std::vector<Double_t> fOrgWeight;
+   std::vector<Double_t> fTarget;
+   std::vector<Bool_t> fIsSignal;
+   std::vector<UInt_t> fOffset;       // position of the variables in the histograms
+   UInt_t fNHist;                     // size of the histograms
+};
+
+static const UInt_t kNHistQuantities = 4;
+
+////////////////////////////////////////////////////////////////////////////////
+/// build a regression tree on the target targetIndex of the events, using the
+/// pre-binned variables of the sample. This is the tree growing of gradient
+/// boosting with histograms (BDT option UseHistTraining):
+///
+///  - the node splitting maximizes the gain G_L^2/H_L + G_R^2/H_R - G^2/H, where
+///    G and H are the sums of the gradients (weight*target) and of the hessians
+///    of the events on each side. The hessian is the weight for a quadratic loss,
+///    or weight*|target|*(1-|target|) for the logistic loss of gradient boosted
+///    classification (logisticHessian)
+///  - the histograms of G, H and of the weights in each bin of each variable are
+///    only built for the smaller daughter of a node, the histograms of the larger
+///    daughter are obtained by subtracting them from the histograms of the mother
+///  - the histograms are built and the best cut is searched in parallel for the
+///    variables.
+///
+/// The events must be in the binned sample (see BinnedSample::Fill). Fisher cuts
+/// are not supported.
+
+UInt_t TMVA::DecisionTree::BuildTreeHist( const EventConstList & eventSample, const BinnedSample & binned,
+                                          UInt_t targetIndex, Bool_t logisticHessian )
+{
+   UInt_t nevents = eventSample.size();
+   if (nevents == 0) Log() << kFATAL << ":<BuildTreeHist> eventsample Size == 0 " << Endl;
+
+   DecisionTreeNode *node = new TMVA::DecisionTreeNode();
+   fNNodes = 1;
+   this->SetRoot(node);
+   this->GetRoot()->SetPos('s');
+   this->GetRoot()->SetDepth(0);
+   this->GetRoot()->SetParentTree(this);
+   fMinSize = fMinNodeSize/100. * nevents;
+
+   fNvars = binned.fCuts.size();
+   fVariableImportance.resize(fNvars);
+
+   HistTrainingData data;
+   data.fBinned = &binned;
+   data.fOrder.resize(nevents);
+   data.fIndex.resize(nevents);
+   data.fGrad.resize(nevents);
+   data.fHess.resize(nevents);
+   data.fWeight.resize(nevents);
+   data.fOrgWeight.resize(nevents);
+   data.fTarget.resize(nevents);
+   data.fIsSignal.resize(nevents);
+   for (UInt_t iev=0; iev<nevents; iev++) {
+      const TMVA::Event* evt = eventSample[iev];
+      const Double_t weight = evt->GetWeight();
+      const Double_t target = evt->GetTarget(targetIndex);
+      data.fOrder[iev]     = iev;
+      data.fIndex[iev]     = binned.fIndex.at(evt);
+      data.fWeight[iev]    = weight;
+      data.fOrgWeight[iev] = evt->GetOriginalWeight();
+      data.fTarget[iev]    = target;
+      data.fGrad[iev]      = weight*target;
+      data.fHess[iev]      = logisticHessian ? weight*fabs(target)*(1-fabs(target)) : weight;
+      data.fIsSignal[iev]  = (evt->GetClass() == fSigClass);
+   }
+
+   data.fOffset.resize(fNvars);
+   data.fNHist = 0;
+   for (UInt_t ivar=0; ivar<fNvars; ivar++) {
+      data.fOffset[ivar] = data.fNHist;
+      data.fNHist += kNHistQuantities*binned.GetNBins(ivar);
+   }
+
+   std::vector<Double_t> hist(data.fNHist);
+   FillNodeHist(0, nevents, hist, data);
+   BuildNodeHist(node, 0, nevents, hist, data);
+
+   return fNNodes;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// fill the histograms with the events at the positions [begin,end) of the node ordering
+
+void TMVA::DecisionTree::FillNodeHist( UInt_t begin, UInt_t end, std::vector<Double_t> & hist,
+                                       const HistTrainingData & data ) const
+{
+   auto fillVariable = [&hist, &data, begin, end](UInt_t ivar) {
+      Double_t* h = &hist[data.fOffset[ivar]];
+      const UInt_t nBins = data.fBinned->GetNBins(ivar);
+      std::fill(h, h + kNHistQuantities*nBins, 0.);
+      const UChar_t* bins = &data.fBinned->fBins[ivar][0];
+      for (UInt_t i=begin; i<end; i++) {
+         const UInt_t iev = data.fOrder[i];
+         Double_t* hb = h + kNHistQuantities*bins[data.fIndex[iev]];
+         hb[0] += data.fGrad[iev];
+         hb[1] += data.fHess[iev];
+         hb[2] += data.fWeight[iev];
+         hb[3] += 1;
+      }
+      return 0;
+   };
+   ForEachVariable(fillVariable, fNvars);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// split the node holding the events [begin,end) of the node ordering, whose
+/// histograms are given, and continue with its daughters. The histograms are
+/// overwritten.
+
+void TMVA::DecisionTree::BuildNodeHist( DecisionTreeNode *node, UInt_t begin, UInt_t end,
+                                        std::vector<Double_t> & hist, HistTrainingData & data )
+{
+   // totals of the node
+   Double_t s=0, b=0, suw=0, buw=0, sub=0, bub=0, target=0, target2=0;
+   for (UInt_t i=begin; i<end; i++) {
+      const UInt_t iev = data.fOrder[i];
+      const Double_t weight = data.fWeight[iev];
+      if (data.fIsSignal[iev]) {
+         s += weight; suw += 1; sub += data.fOrgWeight[iev];
+      }
+      else {
+         b += weight; buw += 1; bub += data.fOrgWeight[iev];
+      }
+      target  += weight*data.fTarget[iev];
+      target2 += weight*data.fTarget[iev]*data.fTarget[iev];
+   }
+   Double_t G=0, H=0;
+   for (UInt_t ibin=0; ibin<data.fBinned->GetNBins(0); ibin++) {
+      G += hist[kNHistQuantities*ibin];
+      H += hist[kNHistQuantities*ibin+1];
+   }
+
+   node->SetNSigEvents(s);
+   node->SetNBkgEvents(b);
+   node->SetNSigEvents_unweighted(suw);
+   node->SetNBkgEvents_unweighted(buw);
+   node->SetNSigEvents_unboosted(sub);
+   node->SetNBkgEvents_unboosted(bub);
+   node->SetPurity();
+   node->SetNEvents(s+b);
+   node->SetNEvents_unweighted(suw+buw);
+   node->SetNEvents_unboosted(sub+bub);
+
+   // find the best cut
+   Int_t mxVar = -1;
+   UInt_t cutBin = 0;
+   Double_t separationGainTotal = 0;
+   const Double_t minHess = 1e-30;
+   if ((end-begin) >= 2*fMinSize && s+b >= 2*fMinSize && node->GetDepth() < fMaxDepth && s+b != 0) {
+
+      std::vector<Char_t> useVariable(fNvars, kTRUE);
+      if (fRandomisedTree) {
+         Bool_t *useVar = new Bool_t[fNvars];
+         UInt_t *mapVar = new UInt_t[fNvars];
+         UInt_t nVars = 0;
+         GetRandomisedVariables(useVar, mapVar, nVars);
+         for (UInt_t ivar=0; ivar<fNvars; ivar++) useVariable[ivar] = useVar[ivar];
+         delete [] useVar;
+         delete [] mapVar;
+      }
+
+      std::vector<Double_t> separationGain(fNvars, 0.);
+      std::vector<UInt_t> cutIndex(fNvars, 0);
+      const Double_t gainNode = G*G/std::max(H, minHess);
+      const Double_t minSize = fMinSize;
+      auto scanVariable = [&](UInt_t ivar) {
+         if (!useVariable[ivar]) return 0;
+         const Double_t* h = &hist[data.fOffset[ivar]];
+         const UInt_t nBins = data.fBinned->GetNBins(ivar);
+         Double_t GL=0, HL=0, WL=0, NL=0;
+         for (UInt_t ibin=0; ibin+1<nBins; ibin++) {
+            GL += h[kNHistQuantities*ibin];
+            HL += h[kNHistQuantities*ibin+1];
+            WL += h[kNHistQuantities*ibin+2];
+            NL += h[kNHistQuantities*ibin+3];
+            const Double_t NR = (end-begin) - NL;
+            const Double_t WR = (s+b) - WL;
+            if (NL < minSize || NR < minSize || WL < minSize || WR < minSize) continue;
+            const Double_t GR = G - GL;
+            const Double_t HR = H - HL;
+            const Double_t gain = GL*GL/std::max(HL, minHess) + GR*GR/std::max(HR, minHess) - gainNode;
+            if (gain > separationGain[ivar]) {
+               separationGain[ivar] = gain;
+               cutIndex[ivar] = ibin;
+            }
+         }
+         return 0;
+      };
+      ForEachVariable(scanVariable, fNvars);
+
+      for (UInt_t ivar=0; ivar<fNvars; ivar++) {
+         if (useVariable[ivar] && separationGain[ivar] > separationGainTotal) {
+            separationGainTotal = separationGain[ivar];
+            mxVar = ivar;
+            cutBin = cutIndex[ivar];
+         }
+      }
+   }
+
+   if (mxVar < 0 || separationGainTotal < std::numeric_limits<double>::epsilon()) {
+      // it is a leaf node
+      if (DoRegression()) {
+         node->SetSeparationIndex(fRegType->GetSeparationIndex(s+b,target,target2));
+         node->SetResponse(target/(s+b));
+         if ( almost_equal_double(target2/(s+b), target/(s+b)*target/(s+b)) ) {
+            node->SetRMS(0);
+         }else{
+            node->SetRMS(TMath::Sqrt(target2/(s+b) - target/(s+b)*target/(s+b)));
+         }
+      }
+      else {
+         node->SetSeparationIndex(fSepType->GetSeparationIndex(s,b));
+         if (node->GetPurity() > fNodePurityLimit) node->SetNodeType(1);
+         else node->SetNodeType(-1);
+      }
+      if (node->GetDepth() > this->GetTotalTreeDepth()) this->SetTotalTreeDepth(node->GetDepth());
+      return;
+   }
+
+   node->SetSelector((UInt_t)mxVar);
+   node->SetCutValue(data.fBinned->fCuts[mxVar][cutBin]);
+   node->SetCutType(kTRUE);
+   node->SetSeparationGain(separationGainTotal);
+   node->SetNFisherCoeff(0);
+   fVariableImportance[mxVar] += separationGainTotal*separationGainTotal;
+
+   // move the events of the left daughter to the front
+   const UChar_t* bins = &data.fBinned->fBins[mxVar][0];
+   auto middle = std::partition(data.fOrder.begin()+begin, data.fOrder.begin()+end,
+                                [bins, cutBin, &data](UInt_t iev) { return bins[data.fIndex[iev]] <= cutBin; });
+   UInt_t mid = middle - data.fOrder.begin();
+
+   // histograms of the smaller daughter from its events, of the larger one by subtraction
+   Bool_t leftIsSmaller = (mid-begin) < (end-mid);
+   std::vector<Double_t> smallHist(data.fNHist);
+   if (leftIsSmaller) FillNodeHist(begin, mid, smallHist, data);
+   else               FillNodeHist(mid, end, smallHist, data);
+   for (UInt_t i=0; i<data.fNHist; i++) hist[i] -= smallHist[i];
+
+   TMVA::DecisionTreeNode *rightNode = new TMVA::DecisionTreeNode(node,'r');
+   TMVA::DecisionTreeNode *leftNode = new TMVA::DecisionTreeNode(node,'l');
+   fNNodes += 2;
+   node->SetNodeType(0);
+   node->SetLeft(leftNode);
+   node->SetRight(rightNode);
+
+   if (leftIsSmaller) {
+      BuildNodeHist(rightNode, mid, end, hist, data);
+      BuildNodeHist(leftNode, begin, mid, smallHist, data);
+   }
+   else {
+      BuildNodeHist(rightNode, mid, end, smallHist, data);
+      BuildNodeHist(leftNode, begin, mid, hist, data);
+   }
+}
+
 ////////////////////////////////////////////////////////////////////////////////
 /// fill the existing the decision tree structure by filling event
 /// in from the top node and see where they happen to end up
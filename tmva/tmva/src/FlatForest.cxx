@@ -0,0 +1,348 @@
+// @(#)root/tmva $Id$
+
+/**********************************************************************************
+ * Project: TMVA - a Root-integrated toolkit for multivariate data analysis       *
+ * Package: TMVA                                                                  *
+ * Class  : FlatForest                                                            *
+ *                                                                                *
+ * Description:                                                                   *
+ *      Forest of a trained BDT compiled into contiguous arrays, for the fast     *
+ *      evaluation of single events and of batches of events                     *
+ *                                                                                *
+ * Copyright (c) 2018:                                                            *
+ *      CERN, Switzerland                                                         *
+ *                                                                                *
+ * Redistribution and use in source and binary forms, with or without             *
+ * modification, are permitted according to the terms listed in LICENSE           *
+ * (http://tmva.sourceforge.net/LICENSE)                                          *
+ **********************************************************************************/
+
+/*! \class TMVA::FlatForest
+\ingroup TMVA
+
+The forest of a trained BDT (MethodBDT), compiled into contiguous arrays
+for its fast evaluation.
+
+The nodes of all the trees are stored in flat arrays holding the variable
+and the value of the cut of each node, the positions of its two daughters
+and the response of the leaves. The leaves point twice to themselves, so
+that a tree is evaluated by a fixed number of steps (its depth)
+~~~{.cpp}
+   node = child[2*node + (x[var[node]] >= cut[node])];
+~~~
+without any test or virtual call. In the batch evaluation, the trees are
+traversed for blocks of events at a time, which keeps the nodes in the
+cache and lets the compiler vectorize the traversal over the events.
+
+The output is identical to MethodBDT::GetMvaValue for the classification
+with any boost type, including the pre-selection cuts, and to
+MethodBDT::GetMulticlassValues for multi-class BDTs (EvaluateMulticlass).
+Regression BDTs, BDTs with Fisher cuts and BDTs with input variable
+transformations other than the identity are not supported (IsValid()
+returns false), unless the forest is built for transformed inputs, as done
+by MethodBDT for its batch evaluation. The evaluation is const and
+thread-safe.
+
+A FlatForest can also write a standalone C++ function with the trees
+written out as nested conditions (MakeCode), and provides functors taking
+the input variables as separate arguments, e.g. for RDataFrame:
+~~~{.cpp}
+   TMVA::FlatForest forest(*bdt);
+   auto df2 = df.Define("bdt", forest.GetFunctor<float, float, float>(), {"x", "y", "z"});
+~~~
+*/
+
+#include "TMVA/FlatForest.h"
+
+#include "TMVA/DecisionTree.h"
+#include "TMVA/DecisionTreeNode.h"
+#include "TMVA/MethodBDT.h"
+#include "TMVA/MsgLogger.h"
+#include "TMVA/TransformationHandler.h"
+#include "TMVA/VariableIdentityTransform.h"
+
+#include "ThreadLocalStorage.h"
+#include "TList.h"
+
+#include <algorithm>
+#include <cmath>
+#include <iomanip>
+#include <iostream>
+#include <limits>
+
+////////////////////////////////////////////////////////////////////////////////
+/// default constructor: empty, invalid forest
+
+TMVA::FlatForest::FlatForest()
+   : fNVars(0), fNClasses(1), fGrad(kFALSE), fNorm(0), fValid(kFALSE)
+{
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// compile the forest of a trained (or read) BDT
+
+TMVA::FlatForest::FlatForest( const MethodBDT& bdt, Bool_t transformedInputs )
+   : fNVars(bdt.GetNvar()), fNClasses(1), fGrad(bdt.fBoostType=="Grad"), fNorm(0), fValid(kFALSE)
+{
+   if (bdt.GetAnalysisType() == Types::kMulticlass) {
+      fNClasses = bdt.DataInfo().GetNClasses();
+   }
+   else if (bdt.GetAnalysisType() != Types::kClassification) {
+      Log() << kWARNING << "<FlatForest> only classification BDTs can be compiled, not \"" << bdt.GetMethodName() << "\"" << Endl;
+      return;
+   }
+   if (!transformedInputs) {
+      TIter next(&bdt.GetTransformationHandler().GetTransformationList());
+      while (TObject* trf = next()) {
+         if (!dynamic_cast<VariableIdentityTransform*>(trf)) {
+            Log() << kWARNING << "<FlatForest> BDT \"" << bdt.GetMethodName()
+                  << "\" uses input variable transformations, it cannot be compiled" << Endl;
+            return;
+         }
+      }
+   }
+
+   const std::vector<DecisionTree*>& forest = bdt.GetForest();
+   const std::vector<double>& boostWeights = bdt.GetBoostWeights();
+   fRoot.reserve(forest.size());
+   fDepth.reserve(forest.size());
+   for (UInt_t itree=0; itree<forest.size(); itree++) {
+      // gradient boost sums the responses, the other boost types
+      // take the mean of the leaf values weighted with the boost weights
+      const Double_t weight = fGrad ? 1. : boostWeights[itree];
+      if (!fGrad) fNorm += weight;
+
+      UInt_t maxDepth = 0, root = 0;
+      if (!forest[itree]->GetRoot() ||
+          !AddNode(forest[itree]->GetRoot(), weight, forest[itree]->DoRegression(), bdt.fUseYesNoLeaf, 0, maxDepth, root)) {
+         Log() << kWARNING << "<FlatForest> tree " << itree << " of BDT \"" << bdt.GetMethodName()
+               << "\" cannot be compiled (Fisher cuts or inconsistent tree structure)" << Endl;
+         return;
+      }
+      fRoot.push_back(root);
+      fDepth.push_back(maxDepth);
+   }
+
+   if (bdt.fDoPreselection) {
+      // same order as in MethodBDT::ApplyPreselectionCuts, the last cut passed wins
+      for (UInt_t ivar=0; ivar<fNVars; ivar++) {
+         if (bdt.fIsLowBkgCut[ivar])  fPreselection.push_back({ivar, bdt.fLowBkgCut[ivar],  kTRUE,  -1});
+         if (bdt.fIsLowSigCut[ivar])  fPreselection.push_back({ivar, bdt.fLowSigCut[ivar],  kTRUE,   1});
+         if (bdt.fIsHighBkgCut[ivar]) fPreselection.push_back({ivar, bdt.fHighBkgCut[ivar], kFALSE, -1});
+         if (bdt.fIsHighSigCut[ivar]) fPreselection.push_back({ivar, bdt.fHighSigCut[ivar], kFALSE,  1});
+      }
+   }
+
+   fValid = kTRUE;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// append the node and its daughters to the arrays, the position of the node
+/// is returned in index. Returns false if the node cannot be compiled.
+
+Bool_t TMVA::FlatForest::AddNode( const DecisionTreeNode* node, Double_t weight, Bool_t useResponse, Bool_t useYesNoLeaf,
+                                  UInt_t depth, UInt_t& maxDepth, UInt_t& index )
+{
+   index = fCut.size();
+   fVar.push_back(0);
+   fCut.push_back(0);
+   fChild.push_back(index);
+   fChild.push_back(index);
+   fValue.push_back(0);
+
+   // leaf, as in DecisionTree::CheckEvent
+   if (node->GetNodeType() != 0) {
+      Double_t value;
+      if (useResponse)       value = node->GetResponse();
+      else if (useYesNoLeaf) value = node->GetNodeType();
+      else                   value = node->GetPurity();
+      fValue[index] = weight*value;
+      maxDepth = std::max(maxDepth, depth);
+      return kTRUE;
+   }
+
+   const DecisionTreeNode* left  = static_cast<const DecisionTreeNode*>(node->GetLeft());
+   const DecisionTreeNode* right = static_cast<const DecisionTreeNode*>(node->GetRight());
+   if (!left || !right || node->GetNFisherCoeff() != 0) return kFALSE;
+
+   fVar[index] = node->GetSelector();
+   fCut[index] = node->GetCutValue();
+
+   UInt_t iLeft = 0, iRight = 0;
+   if (!AddNode(left,  weight, useResponse, useYesNoLeaf, depth+1, maxDepth, iLeft))  return kFALSE;
+   if (!AddNode(right, weight, useResponse, useYesNoLeaf, depth+1, maxDepth, iRight)) return kFALSE;
+
+   // x >= cut goes right, unless the cut type is inverted
+   const Bool_t cutType = node->GetCutType();
+   fChild[2*index]   = cutType ? iLeft  : iRight;
+   fChild[2*index+1] = cutType ? iRight : iLeft;
+   return kTRUE;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// MVA value from the sum of the leaf values of the trees
+
+Double_t TMVA::FlatForest::Finalize( Double_t sum, const Float_t* x ) const
+{
+   if (!fPreselection.empty()) {
+      Double_t result = 0;
+      for (const PreselectionCut& cut : fPreselection) {
+         if (cut.fLow ? x[cut.fVar] < cut.fCut : x[cut.fVar] > cut.fCut) result = cut.fResult;
+      }
+      if (std::abs(result) > 0.05) return result;
+   }
+
+   if (fGrad) return 2.0/(1.0+std::exp(-2.0*sum))-1;
+   return (fNorm > std::numeric_limits<double>::epsilon()) ? sum/fNorm : 0;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// MVA value of one event
+
+Double_t TMVA::FlatForest::Evaluate( const Float_t* x ) const
+{
+   const UInt_t*   var   = fVar.data();
+   const Float_t*  cut   = fCut.data();
+   const UInt_t*   child = fChild.data();
+
+   Double_t sum = 0;
+   for (UInt_t itree=0; itree<fRoot.size(); itree++) {
+      UInt_t node = fRoot[itree];
+      for (UInt_t d=0; d<fDepth[itree]; d++) node = child[2*node + (x[var[node]] >= cut[node])];
+      sum += fValue[node];
+   }
+   return Finalize(sum, x);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// MVA values of nEvents events. The values of the input variables of the
+/// event i start at x[i*stride]; by default stride is the number of variables.
+
+void TMVA::FlatForest::Evaluate( const Float_t* x, UInt_t nEvents, Float_t* output, UInt_t stride ) const
+{
+   if (stride == 0) stride = fNVars;
+
+   const UInt_t*   var   = fVar.data();
+   const Float_t*  cut   = fCut.data();
+   const UInt_t*   child = fChild.data();
+   const Double_t* value = fValue.data();
+
+   UInt_t   node[kBlockSize];
+   Double_t sum[kBlockSize];
+   for (UInt_t first=0; first<nEvents; first+=kBlockSize) {
+      const UInt_t n = std::min(kBlockSize, nEvents-first);
+      const Float_t* xb = x + (ULong64_t)first*stride;
+      std::fill(sum, sum+n, 0.);
+
+      for (UInt_t itree=0; itree<fRoot.size(); itree++) {
+         const UInt_t root = fRoot[itree];
+         for (UInt_t k=0; k<n; k++) node[k] = root;
+         for (UInt_t d=0; d<fDepth[itree]; d++) {
+            for (UInt_t k=0; k<n; k++) {
+               const UInt_t i = node[k];
+               node[k] = child[2*i + (xb[k*stride + var[i]] >= cut[i])];
+            }
+         }
+         for (UInt_t k=0; k<n; k++) sum[k] += value[node[k]];
+      }
+
+      for (UInt_t k=0; k<n; k++) output[first+k] = Finalize(sum[k], xb + k*stride);
+   }
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// class probabilities of one event for a multiclass BDT, as in
+/// MethodBDT::GetMulticlassValues: the trees itree, itree+nClasses, ... give
+/// the score of the class itree, and the probabilities are the softmax of
+/// the scores. For other BDTs, the output is the MVA value.
+
+void TMVA::FlatForest::EvaluateMulticlass( const Float_t* x, Float_t* output ) const
+{
+   if (fNClasses < 2) {
+      output[0] = Evaluate(x);
+      return;
+   }
+
+   const UInt_t*   var   = fVar.data();
+   const Float_t*  cut   = fCut.data();
+   const UInt_t*   child = fChild.data();
+
+   std::vector<Double_t> score(fNClasses, 0.);
+   for (UInt_t itree=0; itree<fRoot.size(); itree++) {
+      UInt_t node = fRoot[itree];
+      for (UInt_t d=0; d<fDepth[itree]; d++) node = child[2*node + (x[var[node]] >= cut[node])];
+      score[itree % fNClasses] += fValue[node];
+   }
+
+   Double_t sum = 0;
+   for (UInt_t icls=0; icls<fNClasses; icls++) {
+      score[icls] = std::exp(score[icls]);
+      sum += score[icls];
+   }
+   for (UInt_t icls=0; icls<fNClasses; icls++) output[icls] = score[icls]/sum;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// write the condition of the node and of its daughters
+
+void TMVA::FlatForest::MakeNodeCode( std::ostream& os, UInt_t node ) const
+{
+   if (fChild[2*node] == node) {
+      os << fValue[node];
+      return;
+   }
+   // 9 digits and a decimal point for an exact float literal
+   os << "(x[" << fVar[node] << "] >= " << std::setprecision(9) << std::showpoint << fCut[node] << "f ? ";
+   os << std::setprecision(17) << std::noshowpoint;
+   MakeNodeCode(os, fChild[2*node+1]);
+   os << " : ";
+   MakeNodeCode(os, fChild[2*node]);
+   os << ")";
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// write a standalone C++ function double funcName(const float* x) computing
+/// the same MVA value as Evaluate, with the trees written out as nested
+/// conditions that the compiler can specialize
+
+void TMVA::FlatForest::MakeCode( std::ostream& os, const TString& funcName ) const
+{
+   if (!fValid) {
+      Log() << kWARNING << "<MakeCode> the forest is not valid, no code written" << Endl;
+      return;
+   }
+
+   const std::streamsize precision = os.precision();
+   os << std::setprecision(17);
+   os << "// MVA function of a BDT with " << GetNTrees() << " trees and " << fNVars << " input variables," << std::endl;
+   os << "// generated by TMVA::FlatForest::MakeCode" << std::endl;
+   os << "#include <cmath>" << std::endl << std::endl;
+   os << "double " << funcName << "(const float* x)" << std::endl;
+   os << "{" << std::endl;
+   if (!fPreselection.empty()) {
+      os << "   double presel = 0;" << std::endl;
+      for (const PreselectionCut& cut : fPreselection) {
+         os << "   if (x[" << cut.fVar << "] " << (cut.fLow ? "<" : ">") << " " << cut.fCut << ") presel = " << cut.fResult << ";" << std::endl;
+      }
+      os << "   if (std::abs(presel) > 0.05) return presel;" << std::endl;
+   }
+   os << "   double sum = 0;" << std::endl;
+   for (UInt_t itree=0; itree<fRoot.size(); itree++) {
+      os << "   sum += ";
+      MakeNodeCode(os, fRoot[itree]);
+      os << ";" << std::endl;
+   }
+   if (fGrad) os << "   return 2.0/(1.0+std::exp(-2.0*sum))-1;" << std::endl;
+   else if (fNorm > std::numeric_limits<double>::epsilon()) os << "   return sum/" << fNorm << ";" << std::endl;
+   else os << "   return 0;" << std::endl;
+   os << "}" << std::endl;
+   os.precision(precision);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+TMVA::MsgLogger& TMVA::FlatForest::Log() const
+{
+   TTHREAD_TLS_DECL_ARG(MsgLogger,logger,"FlatForest");
+   return logger;
+}
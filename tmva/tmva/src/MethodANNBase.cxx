@@ -51,6 +51,9 @@ Base class for all TMVA methods using artificial neural networks.
 #include "TMVA/Types.h"
 #include "TMVA/Tools.h"
 #include "TMVA/TNeuronInputChooser.h"
+#include "TMVA/TNeuronInputAbs.h"
+#include "TMVA/TNeuronInputSqSum.h"
+#include "TMVA/TNeuronInputSum.h"
 #include "TMVA/Ranking.h"
 #include "TMVA/Version.h"
 
@@ -305,6 +308,9 @@ void TMVA::MethodANNBase::BuildNetwork( std::vector<Int_t>* layout, std::vector<
 
    DeleteNetwork();
    InitANNBase();
+   fBatchWeights.clear();
+   fBatchIsBias.clear();
+   fBatchWidth.clear();
 
    // set activation and input functions
    TActivationChooser aChooser;
@@ -619,6 +625,102 @@ Double_t TMVA::MethodANNBase::GetMvaValue( Double_t* err, Double_t* errUpper )
    return neuron->GetActivationValue();
 }
 
+////////////////////////////////////////////////////////////////////////////////
+/// copy the weights of the synapses of the network read from the weight file
+/// into matrices for the batch evaluation. Networks which are not fully
+/// connected are not cached, and are not evaluated in batch.
+
+void TMVA::MethodANNBase::CacheBatchWeights()
+{
+   const Int_t numLayers = fNetwork ? fNetwork->GetEntriesFast() : 0;
+   fBatchWeights.assign(numLayers, std::vector<Double_t>());
+   fBatchIsBias.assign(numLayers, std::vector<Char_t>());
+   fBatchWidth.assign(numLayers, 0);
+   for (Int_t l = 0; l < numLayers; l++) {
+      TObjArray* layer = (TObjArray*)fNetwork->At(l);
+      fBatchWidth[l] = layer->GetEntriesFast();
+      fBatchIsBias[l].assign(fBatchWidth[l], kFALSE);
+      if (l == 0) {
+         for (Int_t j = GetNvar(); j < fBatchWidth[l]; j++) fBatchIsBias[l][j] = kTRUE;
+         continue;
+      }
+      fBatchWeights[l].assign(fBatchWidth[l]*fBatchWidth[l-1], 0);
+      for (Int_t j = 0; j < fBatchWidth[l]; j++) {
+         TNeuron* neuron = (TNeuron*)layer->At(j);
+         if (neuron->NumPreLinks() == 0) {
+            fBatchIsBias[l][j] = kTRUE;
+            continue;
+         }
+         if (neuron->NumPreLinks() != fBatchWidth[l-1]) {
+            fBatchWeights.clear();
+            fBatchIsBias.clear();
+            fBatchWidth.clear();
+            return;
+         }
+         for (Int_t i = 0; i < fBatchWidth[l-1]; i++) fBatchWeights[l][j*fBatchWidth[l-1]+i] = neuron->PreLinkAt(i)->GetWeight();
+      }
+   }
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// the batch evaluation is available for the fully connected networks read
+/// from a weight file, whose neurons sum the weighted activations, their
+/// squares or their absolute values
+
+Bool_t TMVA::MethodANNBase::SupportsBatchMvaValues() const
+{
+   if (fBatchWidth.size() < 2) return kFALSE;
+   return dynamic_cast<TNeuronInputSum*>(fInputCalculator) || dynamic_cast<TNeuronInputSqSum*>(fInputCalculator)
+      || dynamic_cast<TNeuronInputAbs*>(fInputCalculator);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// MVA values of a batch of events, computed layer by layer from the weights
+/// cached at reading, without using the state of the neurons (thread-safe)
+
+void TMVA::MethodANNBase::ComputeBatchMvaValues( const Float_t* input, UInt_t nEvents, Float_t* output ) const
+{
+   std::vector<Float_t> values;
+   TransformBatchInputs(input, nEvents, values);
+
+   const Int_t inputType = dynamic_cast<TNeuronInputSum*>(fInputCalculator) ? 0 :
+                           dynamic_cast<TNeuronInputSqSum*>(fInputCalculator) ? 1 : 2;
+
+   const Int_t numLayers = fBatchWidth.size();
+   const std::vector<Int_t>& width = fBatchWidth;
+   const std::vector< std::vector<Char_t> >& isBias = fBatchIsBias;
+   const std::vector< std::vector<Double_t> >& weights = fBatchWeights;
+
+   std::vector<Double_t> prev, cur;
+   for (UInt_t ievt = 0; ievt < nEvents; ievt++) {
+      const Float_t* x = values.data() + (ULong64_t)ievt*GetNvar();
+      prev.resize(width[0]);
+      for (Int_t j = 0; j < width[0]; j++) prev[j] = isBias[0][j] ? 1. : x[j];
+
+      for (Int_t l = 1; l < numLayers; l++) {
+         TActivation* activation = (l == numLayers-1) ? fOutput : fActivation;
+         cur.resize(width[l]);
+         for (Int_t j = 0; j < width[l]; j++) {
+            if (isBias[l][j]) {
+               cur[j] = 1.;
+               continue;
+            }
+            const Double_t* w = &weights[l][j*width[l-1]];
+            Double_t sum = 0;
+            for (Int_t i = 0; i < width[l-1]; i++) {
+               const Double_t val = w[i]*prev[i];
+               if      (inputType == 0) sum += val;
+               else if (inputType == 1) sum += val*val;
+               else                     sum += TMath::Abs(val);
+            }
+            cur[j] = activation->Eval(sum);
+         }
+         prev.swap(cur);
+      }
+      output[ievt] = prev[0];
+   }
+}
+
 ////////////////////////////////////////////////////////////////////////////////
 /// get the regression value generated by the NN
 
@@ -840,6 +942,8 @@ void TMVA::MethodANNBase::ReadWeightsFromXML( void* wghtnode )
 
    delete layout;
 
+   CacheBatchWeights();
+
    void* xmlInvHessian = NULL;
    xmlInvHessian = gTools().GetChild(wghtnode, "InverseHessian");
    if( !xmlInvHessian )
@@ -907,7 +1011,7 @@ void TMVA::MethodANNBase::ReadWeightsFromStream( std::istream & istr)
    while (istr>> dummy >> weight) weights->push_back(weight); // use w/ slower write-out
 
    ForceWeights(weights);
-
+   CacheBatchWeights();
 
    delete weights;
 }
@@ -117,6 +117,7 @@ the selection.
 #include "TMVA/CrossEntropy.h"
 #include "TMVA/DecisionTree.h"
 #include "TMVA/DataSet.h"
+#include "TMVA/FlatForest.h"
 #include "TMVA/GiniIndex.h"
 #include "TMVA/GiniIndexWithLaplace.h"
 #include "TMVA/Interval.h"
@@ -210,6 +211,8 @@ TMVA::MethodBDT::MethodBDT( const TString& jobName,
    , fCbb(0)
    , fDoPreselection(kFALSE)
    , fSkipNormalization(kFALSE)
+   , fFlatForest(0)
+   , fHistTraining(kFALSE)
    , fHistoricBool(kFALSE)
 {
    fMonitorNtuple = NULL;
@@ -265,6 +268,8 @@ TMVA::MethodBDT::MethodBDT( DataSetInfo& theData,
    , fCbb(0)
    , fDoPreselection(kFALSE)
    , fSkipNormalization(kFALSE)
+   , fFlatForest(0)
+   , fHistTraining(kFALSE)
    , fHistoricBool(kFALSE)
 {
    fMonitorNtuple = NULL;
@@ -439,6 +444,8 @@ void TMVA::MethodBDT::DeclareOptions()
 
    DeclareOptionRef(fSkipNormalization=kFALSE, "SkipNormalization", "Skip normalization at initialization, to keep expectation value of BDT output according to the fraction of events");
 
+   DeclareOptionRef(fHistTraining=kFALSE, "UseHistTraining", "BoostType=Grad only: grow the trees on variables pre-binned in nCuts+1 quantiles (at most 256), using the histograms of the gradients in the node splitting (faster for large training samples)");
+
     // deprecated options, still kept for the moment:
    DeclareOptionRef(fMinNodeEvents=0, "nEventsMin", "deprecated: Use MinNodeSize (in % of training events) instead");
 
@@ -655,6 +662,22 @@ void TMVA::MethodBDT::ProcessOptions()
       Log() << kWARNING << "You have specified a deprecated option *UseBaggedGrad* --> please use  *UseBaggedBoost* instead" << Endl;
    }
 
+   if (fHistTraining) {
+      if (fBoostType!="Grad") {
+         Log() << kWARNING << "The option UseHistTraining is only available for BoostType=Grad, I will ignore it!" << Endl;
+         fHistTraining = kFALSE;
+      }
+      else if (fUseFisherCuts) {
+         Log() << kWARNING << "UseFisherCuts is not available with UseHistTraining, I will ignore it!" << Endl;
+         fUseFisherCuts = kFALSE;
+      }
+      if (fNCuts < 1 || fNCuts > 255) {
+         Log() << kWARNING << "With UseHistTraining, nCuts must be between 1 and 255 --> I switch to nCuts = "
+               << (fNCuts < 1 ? 20 : 255) << Endl;
+         fNCuts = (fNCuts < 1 ? 20 : 255);
+      }
+   }
+
 }
 
 ////////////////////////////////////////////////////////////////////////////////
@@ -732,6 +755,7 @@ void TMVA::MethodBDT::Reset( void )
    // remove all the trees
    for (UInt_t i=0; i<fForest.size();           i++) delete fForest[i];
    fForest.clear();
+   delete fFlatForest.exchange(0);
 
    fBoostWeights.clear();
    if (fMonitorNtuple) { fMonitorNtuple->Delete(); fMonitorNtuple=NULL; }
@@ -755,6 +779,7 @@ void TMVA::MethodBDT::Reset( void )
 TMVA::MethodBDT::~MethodBDT( void )
 {
    for (UInt_t i=0; i<fForest.size();           i++) delete fForest[i];
+   delete fFlatForest.load();
 }
 
 ////////////////////////////////////////////////////////////////////////////////
@@ -1264,6 +1289,7 @@ void TMVA::MethodBDT::Train()
 
    if(fBoostType=="Grad"){
       InitGradBoost(fEventSample);
+      if (fHistTraining) fBinnedSample.Fill(fEventSample, GetNvar(), fNCuts+1);
    }
 
    Int_t itree=0;
@@ -1306,7 +1332,8 @@ void TMVA::MethodBDT::Train()
             }
             // the minimum linear correlation between two variables demanded for use in fisher criterion in node splitting
 
-            nNodesBeforePruning = fForest.back()->BuildTree(*fTrainSample);
+            if (fHistTraining) nNodesBeforePruning = fForest.back()->BuildTreeHist(*fTrainSample, fBinnedSample, i, kTRUE);
+            else               nNodesBeforePruning = fForest.back()->BuildTree(*fTrainSample);
             Double_t bw = this->Boost(*fTrainSample, fForest.back(),i);
             if (bw > 0) {
                fBoostWeights.push_back(bw);
@@ -1332,7 +1359,8 @@ void TMVA::MethodBDT::Train()
             fForest.back()->SetUseExclusiveVars(fUseExclusiveVars);
          }
          
-         nNodesBeforePruning = fForest.back()->BuildTree(*fTrainSample);
+         if (fHistTraining) nNodesBeforePruning = fForest.back()->BuildTreeHist(*fTrainSample, fBinnedSample, 0, !DoRegression());
+         else               nNodesBeforePruning = fForest.back()->BuildTree(*fTrainSample);
          
          if (fUseYesNoLeaf && !DoRegression() && fBoostType!="Grad") { // remove leaf nodes where both daughter nodes are of same type
             nNodesBeforePruning = fForest.back()->CleanTree();
@@ -1411,6 +1439,7 @@ void TMVA::MethodBDT::Train()
    for (UInt_t i=0; i<fValidationSample.size(); i++) delete fValidationSample[i];
    fEventSample.clear();
    fValidationSample.clear();
+   fBinnedSample.Clear();
 
    if (!fExitFromTraining) fIPyMaxIter = fIPyCurrentIter;
    ExitFromTraining();
@@ -2402,6 +2431,46 @@ void TMVA::MethodBDT::ReadWeightsFromXML(void* parent) {
       fBoostWeights.push_back(boostWeight);
       ch = gTools().GetNextChild(ch);
    }
+
+   // the forest is compiled again for the next batch evaluation
+   delete fFlatForest.exchange(0);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// the forest compiled for the batch evaluation, built on the first call;
+/// if several threads compile it at the same time, only one forest is kept
+
+const TMVA::FlatForest* TMVA::MethodBDT::GetFlatForest() const
+{
+   if (!fFlatForest) {
+      FlatForest* tmp = new FlatForest(*this, kTRUE);
+      FlatForest* expected = 0;
+      if (!fFlatForest.compare_exchange_strong(expected, tmp)) {
+         // another thread already did it
+         delete tmp;
+      }
+   }
+   return fFlatForest;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// the batch evaluation is available for the classification BDTs whose
+/// forest can be compiled (see FlatForest)
+
+Bool_t TMVA::MethodBDT::SupportsBatchMvaValues() const
+{
+   if (GetAnalysisType() != Types::kClassification || fForest.empty()) return kFALSE;
+   return GetFlatForest()->IsValid();
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// MVA values of a batch of events, from the compiled forest
+
+void TMVA::MethodBDT::ComputeBatchMvaValues( const Float_t* input, UInt_t nEvents, Float_t* output ) const
+{
+   std::vector<Float_t> values;
+   TransformBatchInputs(input, nEvents, values);
+   GetFlatForest()->Evaluate(values.data(), nEvents, output);
 }
 
 ////////////////////////////////////////////////////////////////////////////////
@@ -2419,6 +2488,7 @@ void  TMVA::MethodBDT::ReadWeightsFromStream( std::istream& istr )
 
    for (UInt_t i=0;i<fForest.size();i++) delete fForest[i];
    fForest.clear();
+   delete fFlatForest.exchange(0);
    fBoostWeights.clear();
    Int_t iTree;
    Double_t boostWeight;
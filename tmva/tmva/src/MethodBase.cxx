@@ -894,6 +894,48 @@ void TMVA::MethodBase::AddClassifierOutput( Types::ETreeType type )
    }
 }
 
+////////////////////////////////////////////////////////////////////////////////
+/// true if the method can compute the MVA values of batches of events in a
+/// thread-safe way (GetBatchMvaValues), including its variable transformations
+
+Bool_t TMVA::MethodBase::HasBatchMvaValues() const
+{
+   return SupportsBatchMvaValues() && GetTransformationHandler().CanTransformBatch();
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// thread-safe classification response of nEvents events: the input variables
+/// of the event i are input[i*nVar], ..., input[i*nVar+nVar-1], and its MVA value
+/// is written to output[i]. The method must provide it (see HasBatchMvaValues).
+
+void TMVA::MethodBase::GetBatchMvaValues( const Float_t* input, UInt_t nEvents, Float_t* output ) const
+{
+   if (!HasBatchMvaValues()) {
+      Log() << kFATAL << "<GetBatchMvaValues> method " << GetMethodName()
+            << " does not support the batch evaluation" << Endl;
+   }
+   ComputeBatchMvaValues(input, nEvents, output);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// batch evaluation of the methods that support it (see SupportsBatchMvaValues)
+
+void TMVA::MethodBase::ComputeBatchMvaValues( const Float_t* /*input*/, UInt_t /*nEvents*/, Float_t* /*output*/ ) const
+{
+   Log() << kFATAL << "<ComputeBatchMvaValues> not implemented for method " << GetMethodName() << Endl;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// copy the input variables of nEvents events to output and apply the variable
+/// transformations of the method, with the reference class cls if cls >= 0
+
+void TMVA::MethodBase::TransformBatchInputs( const Float_t* input, UInt_t nEvents, std::vector<Float_t>& output, Int_t cls ) const
+{
+   const ULong64_t n = (ULong64_t)nEvents*GetNvar();
+   output.assign(input, input + n);
+   GetTransformationHandler().TransformBatch(output.data(), nEvents, cls);
+}
+
 ////////////////////////////////////////////////////////////////////////////////
 /// get all the MVA values for the events of the current Data type
 std::vector<Double_t> TMVA::MethodBase::GetMvaValues(Long64_t firstEvt, Long64_t lastEvt, Bool_t logProgress)
@@ -1285,6 +1285,48 @@ Double_t TMVA::MethodDNN::GetMvaValue( Double_t* /*errLower*/, Double_t* /*errUp
    return YHat(0,0);
 }
 
+////////////////////////////////////////////////////////////////////////////////
+/// the network can be evaluated in batches once it has been set up
+
+Bool_t TMVA::MethodDNN::SupportsBatchMvaValues() const
+{
+   return fNet.GetDepth() > 0;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// forward propagation of the nEvents events through the layers of the
+/// network, with local matrices so that fNet is not modified
+
+void TMVA::MethodDNN::ComputeBatchMvaValues( const Float_t* input, UInt_t nEvents, Float_t* output ) const
+{
+   if (nEvents == 0) return;
+
+   std::vector<Float_t> values;
+   TransformBatchInputs(input, nEvents, values);
+
+   const UInt_t nVariables = GetNvar();
+   Matrix_t X(nEvents, nVariables);
+   for (UInt_t ievt = 0; ievt < nEvents; ievt++) {
+      for (UInt_t ivar = 0; ivar < nVariables; ivar++) {
+         X(ievt, ivar) = values[ievt*nVariables + ivar];
+      }
+   }
+
+   for (size_t i = 0; i < fNet.GetDepth(); i++) {
+      const auto& layer = fNet.GetLayer(i);
+      Matrix_t out(nEvents, layer.GetWidth());
+      Architecture_t::MultiplyTranspose(out, X, layer.GetWeights());
+      Architecture_t::AddRowWise(out, layer.GetBiases());
+      DNN::evaluate<Architecture_t>(out, layer.GetActivationFunction());
+      X.ResizeTo(out);
+      X = out;
+   }
+
+   Matrix_t YHat(nEvents, X.GetNcols());
+   DNN::evaluate<Architecture_t>(YHat, fOutputFunction, X);
+   for (UInt_t ievt = 0; ievt < nEvents; ievt++) output[ievt] = YHat(ievt, 0);
+}
+
 ////////////////////////////////////////////////////////////////////////////////
 
 const std::vector<Float_t> & TMVA::MethodDNN::GetRegressionValues()
@@ -531,6 +531,73 @@ Double_t TMVA::MethodLikelihood::GetMvaValue( Double_t* err, Double_t* errUpper
    return TransformLikelihoodOutput( ps, pb );
 }
 
+////////////////////////////////////////////////////////////////////////////////
+/// the batch evaluation needs the signal and background PDFs
+
+Bool_t TMVA::MethodLikelihood::SupportsBatchMvaValues() const
+{
+   return fPDFSig != 0 && fPDFBgd != 0;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// likelihood ratio of nEvents events, computed as in GetMvaValue; the input
+/// variables are transformed once with the signal and once with the
+/// background as reference class
+
+void TMVA::MethodLikelihood::ComputeBatchMvaValues( const Float_t* input, UInt_t nEvents, Float_t* output ) const
+{
+   const UInt_t nvar = GetNvar();
+   std::vector<Float_t> values[2];
+   TransformBatchInputs( input, nEvents, values[0], fSignalClass );
+   TransformBatchInputs( input, nEvents, values[1], fBackgroundClass );
+
+   for (UInt_t ievt = 0; ievt < nEvents; ievt++) {
+      Double_t ps(1), pb(1), p(0);
+      for (UInt_t ivar = 0; ivar < nvar; ivar++) {
+
+         // drop one variable (this is ONLY used for internal variable ranking !)
+         if ((Int_t)ivar == fDropVariable) continue;
+
+         PDF* pdfSig = (*fPDFSig)[ivar];
+         for (UInt_t itype = 0; itype < 2; itype++) {
+            Double_t x = values[itype][ievt*nvar + ivar];
+
+            // verify limits
+            if      (x >= pdfSig->GetXmax()) x = pdfSig->GetXmax() - 1.0e-10;
+            else if (x <  pdfSig->GetXmin()) x = pdfSig->GetXmin();
+
+            PDF* pdf = (itype == 0) ? (*fPDFSig)[ivar] : (*fPDFBgd)[ivar];
+            if (pdf == 0) Log() << kFATAL << "<ComputeBatchMvaValues> Reference histograms don't exist" << Endl;
+            const TH1* hist = pdf->GetPDFHist();
+
+            // FindFixBin does not modify the histogram
+            Int_t bin = hist->FindFixBin(x);
+
+            if (pdfSig->GetInterpolMethod() == TMVA::PDF::kSpline0 ||
+                DataInfo().GetVariableInfo(ivar).GetVarType() == 'N') {
+               p = TMath::Max( hist->GetBinContent(bin), fEpsilon );
+            } else {
+               Int_t nextbin = bin;
+               if ((x > hist->GetBinCenter(bin) && bin != hist->GetNbinsX()) || bin == 1)
+                  nextbin++;
+               else
+                  nextbin--;
+
+               Double_t dx   = hist->GetBinCenter(bin)  - hist->GetBinCenter(nextbin);
+               Double_t dy   = hist->GetBinContent(bin) - hist->GetBinContent(nextbin);
+               Double_t like = hist->GetBinContent(bin) + (x - hist->GetBinCenter(bin)) * dy/dx;
+
+               p = TMath::Max( like, fEpsilon );
+            }
+
+            if (itype == 0) ps *= p;
+            else            pb *= p;
+         }
+      }
+      output[ievt] = TransformLikelihoodOutput( ps, pb );
+   }
+}
+
 ////////////////////////////////////////////////////////////////////////////////
 /// returns transformed or non-transformed output
 
@@ -114,6 +114,7 @@
 #include "TXMLEngine.h"
 #include "TMath.h"
 
+#include <algorithm>
 #include <cstdlib>
 
 #include <string>
@@ -525,6 +526,45 @@ Double_t TMVA::Reader::EvaluateMVA( const std::vector<Double_t>& inputVec, const
    return EvaluateMVA( fTmpEvalVec, methodTag, aux );
 }
 
+////////////////////////////////////////////////////////////////////////////////
+/// Evaluate the MVA of a given method for nEvents events. The values of the input
+/// variables of the event i are input[i*nVar], ..., input[i*nVar+nVar-1], nVar being
+/// the number of variables of the reader, and its MVA value is written to output[i].
+/// The methods providing a batch evaluation (MethodBase::HasBatchMvaValues) evaluate
+/// all the events at once; the other methods are evaluated event by event.
+/// The parameter aux is obligatory for the cuts method where it represents the efficiency cutoff
+
+void TMVA::Reader::EvaluateMVA( const TString& methodTag, const Float_t* input, UInt_t nEvents, Float_t* output, Double_t aux )
+{
+   IMethod* imeth = FindMVA( methodTag );
+   MethodBase* meth = dynamic_cast<TMVA::MethodBase*>(imeth);
+   if (meth==0) {
+      std::fill(output, output+nEvents, 0.f);
+      return;
+   }
+   const UInt_t nVar = DataInfo().GetNVariables();
+
+   if (meth->HasBatchMvaValues()) {
+      meth->GetBatchMvaValues( input, nEvents, output );
+      for (UInt_t ievt=0; ievt<nEvents; ievt++) {
+         for (UInt_t i=0; i<nVar; i++) {
+            if (TMath::IsNaN(input[(ULong64_t)ievt*nVar+i])) {
+               Log() << kERROR << i << "-th variable of the event is NaN --> return MVA value -999, \n that's all I can do, please fix or remove this event." << Endl;
+               output[ievt] = -999;
+               break;
+            }
+         }
+      }
+      return;
+   }
+
+   std::vector<Float_t> inputVec(nVar);
+   for (UInt_t ievt=0; ievt<nEvents; ievt++) {
+      std::copy(input + (ULong64_t)ievt*nVar, input + (ULong64_t)(ievt+1)*nVar, inputVec.begin());
+      output[ievt] = EvaluateMVA( inputVec, methodTag, aux );
+   }
+}
+
 ////////////////////////////////////////////////////////////////////////////////
 /// evaluates MVA for given set of input variables
 
@@ -0,0 +1,290 @@
+// @(#)root/tmva $Id$
+
+/**********************************************************************************
+ * Project: TMVA - a Root-integrated toolkit for multivariate data analysis       *
+ * Package: TMVA                                                                  *
+ * Class  : ReaderModel                                                           *
+ *                                                                                *
+ * Description:                                                                   *
+ *      Trained method loaded once from its weight file, evaluated for batches    *
+ *      of events and shareable between threads                                   *
+ *                                                                                *
+ * Copyright (c) 2018:                                                            *
+ *      CERN, Switzerland                                                         *
+ *                                                                                *
+ * Redistribution and use in source and binary forms, with or without             *
+ * modification, are permitted according to the terms listed in LICENSE           *
+ * (http://tmva.sourceforge.net/LICENSE)                                          *
+ **********************************************************************************/
+
+/*! \class TMVA::ReaderModel
+\ingroup TMVA
+
+A trained classifier loaded once from its XML weight file, and evaluated
+for batches of events whose input variables are stored one event after
+the other:
+~~~{.cpp}
+   TMVA::ReaderModel model("dataset/weights/TMVAClassification_BDT.weights.xml");
+   std::vector<float> x(nEvents * model.GetNVariables());
+   std::vector<float> mva(nEvents);
+   model.Compute(x.data(), nEvents, mva.data());
+~~~
+Contrary to the TMVA::Reader, no variable is bound by address and Compute
+is const: a single model can be shared by all the threads, e.g. by all the
+slots of an RDataFrame.
+
+The DNN and DL methods can be evaluated with reduced precision, by a copy of
+their network with int8 weights (TMVA::DNN::TQuantizedNet):
+~~~{.cpp}
+   TMVA::ReaderModel model("dataset/weights/TMVAClassification_DL.weights.xml", "Precision=Int8");
+   model.CompareToFloat(x.data(), nEvents);  // prints the differences to the float values
+~~~
+With "Precision=Int8", the layer inputs are quantized to int8 as well; with
+"Precision=Int8BF16", they are rounded to bfloat16.
+
+The input variables and spectators are declared as in the weight file.
+The methods providing a batch evaluation (MethodBase::HasBatchMvaValues:
+BDT, MLP, DNN and Likelihood, with the identity or normalisation variable
+transformations) are evaluated concurrently from all the threads. The other
+methods are evaluated event by event with an internal Reader, one thread at
+a time.
+*/
+
+#include "TMVA/ReaderModel.h"
+
+#include "TMVA/DNN/QuantizedNet.h"
+#include "TMVA/MethodBase.h"
+#include "TMVA/MethodDL.h"
+#include "TMVA/MethodDNN.h"
+#include "TMVA/MsgLogger.h"
+#include "TMVA/Reader.h"
+#include "TMVA/Tools.h"
+
+#include "ThreadLocalStorage.h"
+#include "TMath.h"
+#include "TObjArray.h"
+#include "TObjString.h"
+#include "TXMLEngine.h"
+
+#include <algorithm>
+#include <cmath>
+
+////////////////////////////////////////////////////////////////////////////////
+/// read the variables and spectators declared in the weight file and book
+/// its method in an internal, silent Reader
+
+TMVA::ReaderModel::ReaderModel( const TString& weightFile, const TString& options )
+   : fReader(new Reader("!Color:Silent")), fMethod(0), fNative(kFALSE)
+{
+   TString precision = "Float";
+   TObjArray* tokens = options.Tokenize(":");
+   for (Int_t i = 0; i < tokens->GetEntriesFast(); i++) {
+      TString option = ((TObjString*)tokens->At(i))->GetString();
+      if (option.BeginsWith("Precision=", TString::kIgnoreCase)) {
+         precision = option(10, option.Length());
+      } else {
+         Log() << kFATAL << "<ReaderModel> unknown option " << option << Endl;
+      }
+   }
+   delete tokens;
+
+   if (!weightFile.EndsWith(".xml")) {
+      Log() << kFATAL << "<ReaderModel> only XML weight files are supported: " << weightFile << Endl;
+   }
+
+   void* doc = gTools().xmlengine().ParseFile(weightFile, gTools().xmlenginebuffersize());
+   if (doc == 0) {
+      Log() << kFATAL << "<ReaderModel> unable to read the weight file " << weightFile << Endl;
+   }
+   void* rootnode = gTools().xmlengine().DocGetRootElement(doc); // node "MethodSetup"
+   TString fullMethodName;
+   gTools().ReadAttr(rootnode, "Method", fullMethodName);
+   fMethodName = fullMethodName(fullMethodName.Index("::") + 2, fullMethodName.Length());
+
+   std::vector<TString> spectators;
+   for (void* ch = gTools().GetChild(rootnode); ch != 0; ch = gTools().GetNextChild(ch)) {
+      TString nodeName = gTools().GetName(ch);
+      if (nodeName != "Variables" && nodeName != "Spectators") continue;
+      std::vector<TString>& list = (nodeName == "Variables") ? fVariables : spectators;
+      for (void* varnode = gTools().GetChild(ch); varnode != 0; varnode = gTools().GetNextChild(varnode)) {
+         TString expression;
+         gTools().ReadAttr(varnode, "Expression", expression);
+         list.push_back(expression);
+      }
+   }
+   gTools().xmlengine().FreeDoc(doc);
+
+   // the addresses are only used by the Reader for its evaluation from them,
+   // so the buffer must not be resized after this point
+   fBuffer.resize(fVariables.size() + spectators.size());
+   for (UInt_t i = 0; i < fVariables.size(); i++) fReader->AddVariable(fVariables[i], &fBuffer[i]);
+   for (UInt_t i = 0; i < spectators.size(); i++) fReader->AddSpectator(spectators[i], &fBuffer[fVariables.size() + i]);
+
+   fMethod = dynamic_cast<MethodBase*>(fReader->BookMVA(fMethodName, weightFile));
+   if (fMethod == 0) {
+      Log() << kFATAL << "<ReaderModel> unable to book the method of " << weightFile << Endl;
+   }
+   fNative = fMethod->HasBatchMvaValues();
+
+   Quantize(precision);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// copy the network of the DNN and DL methods with the requested precision;
+/// the other methods, and the networks with layers or variable transformations
+/// not supported by the copy, remain evaluated in float
+
+void TMVA::ReaderModel::Quantize( const TString& precision )
+{
+   DNN::EInferencePrecision p;
+   if (precision.CompareTo("Float", TString::kIgnoreCase) == 0) {
+      return;
+   } else if (precision.CompareTo("Int8", TString::kIgnoreCase) == 0) {
+      p = DNN::EInferencePrecision::kInt8;
+   } else if (precision.CompareTo("Int8BF16", TString::kIgnoreCase) == 0) {
+      p = DNN::EInferencePrecision::kInt8BF16;
+   } else {
+      Log() << kFATAL << "<ReaderModel> unknown precision " << precision
+            << ", available are Float, Int8 and Int8BF16" << Endl;
+      return;
+   }
+
+   if (MethodDNN* dnn = dynamic_cast<MethodDNN*>(fMethod)) {
+      fQuantizedNet = DNN::TQuantizedNet::Create(dnn->GetNet(), dnn->GetOutputFunction(), p);
+   } else if (MethodDL* dl = dynamic_cast<MethodDL*>(fMethod)) {
+      fQuantizedNet = DNN::TQuantizedNet::Create(dl->GetDeepNet(), dl->GetOutputFunction(), p);
+   } else {
+      Log() << kWARNING << "<ReaderModel> the precision " << precision << " is only available for the DNN and DL methods, "
+            << fMethodName << " is evaluated in float" << Endl;
+      return;
+   }
+
+   if (!fQuantizedNet || fQuantizedNet->GetNInputs() != fVariables.size()) {
+      Log() << kWARNING << "<ReaderModel> the network of " << fMethodName
+            << " has layers which cannot be quantized, it is evaluated in float" << Endl;
+      fQuantizedNet.reset();
+      return;
+   }
+   if (!fMethod->GetTransformationHandler().CanTransformBatch()) {
+      Log() << kWARNING << "<ReaderModel> the variable transformations of " << fMethodName
+            << " cannot be applied to batches of events, it is evaluated in float" << Endl;
+      fQuantizedNet.reset();
+      return;
+   }
+
+   Log() << kINFO << "<ReaderModel> " << fMethodName << " evaluated with int8 weights ("
+         << (p == DNN::EInferencePrecision::kInt8 ? "int8" : "bfloat16") << " activations): "
+         << fQuantizedNet->GetDepth() << " layers, " << fQuantizedNet->GetWeightsSize() << " bytes of weights"
+         << ", largest relative error on a weight " << fQuantizedNet->GetMaxWeightError() << Endl;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// destructor
+
+TMVA::ReaderModel::~ReaderModel()
+{
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// MVA values of nEvents events; events with a NaN input variable get -999,
+/// as with the Reader
+
+void TMVA::ReaderModel::Compute( const Float_t* inputs, std::size_t nEvents, Float_t* out ) const
+{
+   Evaluate(inputs, nEvents, out, IsQuantized());
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// MVA values computed with the quantized network or with the method
+
+void TMVA::ReaderModel::Evaluate( const Float_t* inputs, std::size_t nEvents, Float_t* out, Bool_t quantized ) const
+{
+   const UInt_t nVar = fVariables.size();
+
+   // the Reader interfaces count the events with UInt_t
+   const std::size_t maxChunk = 1u << 30;
+   for (std::size_t first = 0; first < nEvents; first += maxChunk) {
+      const UInt_t n = std::min(nEvents - first, maxChunk);
+      const Float_t* x = inputs + first*nVar;
+      Float_t* y = out + first;
+
+      if (quantized) {
+         std::vector<Float_t> values;
+         fMethod->TransformBatchInputs(x, n, values);
+         const std::size_t nOut = fQuantizedNet->GetNOutputs();
+         std::vector<Float_t> outputs(n * nOut);
+         fQuantizedNet->Evaluate(values.data(), n, outputs.data());
+         for (UInt_t ievt = 0; ievt < n; ievt++) y[ievt] = outputs[ievt * nOut];
+      } else if (fNative) {
+         fMethod->GetBatchMvaValues(x, n, y);
+      } else {
+         std::lock_guard<std::mutex> lock(fMutex);
+         fReader->EvaluateMVA(fMethodName, x, n, y);
+         continue;
+      }
+
+      for (UInt_t ievt = 0; ievt < n; ievt++) {
+         for (UInt_t i = 0; i < nVar; i++) {
+            if (TMath::IsNaN(x[(std::size_t)ievt*nVar + i])) {
+               y[ievt] = -999;
+               break;
+            }
+         }
+      }
+   }
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// MVA values of the events whose input variables are stored one after the
+/// other in inputs
+
+std::vector<Float_t> TMVA::ReaderModel::Compute( const std::vector<Float_t>& inputs ) const
+{
+   const std::size_t nVar = fVariables.size();
+   if (nVar == 0 || inputs.size() % nVar != 0) {
+      Log() << kFATAL << "<Compute> the size of the input (" << inputs.size()
+            << ") is not a multiple of the number of variables (" << nVar << ")" << Endl;
+   }
+   std::vector<Float_t> out(inputs.size() / nVar);
+   Compute(inputs.data(), out.size(), out.data());
+   return out;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// differences between the MVA values of nEvents events computed with the
+/// quantized network and with the method in float; zero if the model is not
+/// quantized
+
+TMVA::ReaderModel::AccuracyDelta TMVA::ReaderModel::CompareToFloat( const Float_t* inputs, std::size_t nEvents ) const
+{
+   AccuracyDelta delta = { 0, 0., 0., 0. };
+   if (!IsQuantized() || nEvents == 0) return delta;
+
+   std::vector<Float_t> reference(nEvents);
+   std::vector<Float_t> quantized(nEvents);
+   Evaluate(inputs, nEvents, reference.data(), kFALSE);
+   Evaluate(inputs, nEvents, quantized.data(), kTRUE);
+
+   Double_t sum = 0, sum2 = 0;
+   for (std::size_t i = 0; i < nEvents; i++) {
+      const Double_t d = std::abs(Double_t(quantized[i]) - reference[i]);
+      delta.fMaxAbs = std::max(delta.fMaxAbs, d);
+      sum += d;
+      sum2 += d * d;
+   }
+   delta.fNEvents = nEvents;
+   delta.fMeanAbs = sum / nEvents;
+   delta.fRMS = std::sqrt(sum2 / nEvents);
+
+   Log() << kINFO << "<CompareToFloat> " << fMethodName << ", " << nEvents << " events: largest difference "
+         << delta.fMaxAbs << ", mean absolute difference " << delta.fMeanAbs << ", RMS " << delta.fRMS << Endl;
+   return delta;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+TMVA::MsgLogger& TMVA::ReaderModel::Log() const
+{
+   TTHREAD_TLS_DECL_ARG(MsgLogger,logger,"ReaderModel");
+   return logger;
+}
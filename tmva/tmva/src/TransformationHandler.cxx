@@ -162,6 +162,35 @@ const TMVA::Event* TMVA::TransformationHandler::Transform( const Event* ev ) con
    return trEv;
 }
 
+////////////////////////////////////////////////////////////////////////////////
+/// true if all the transformations can transform batches of events
+
+Bool_t TMVA::TransformationHandler::CanTransformBatch() const
+{
+   TListIter trIt(&fTransformations);
+   while (VariableTransformBase *trf = (VariableTransformBase*) trIt()) {
+      if (!trf->CanTransformBatch()) return kFALSE;
+   }
+   return kTRUE;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// thread-safe in-place transformation of the input variables of nEvents events,
+/// stored one event after the other. The reference classes of the transformations
+/// are used, unless a class cls >= 0 is given.
+
+void TMVA::TransformationHandler::TransformBatch( Float_t* values, UInt_t nEvents, Int_t cls ) const
+{
+   const UInt_t nVars = fDataSetInfo.GetNVariables();
+   TListIter trIt(&fTransformations);
+   std::vector<Int_t>::const_iterator rClsIt = fTransformationsReferenceClasses.begin();
+   while (VariableTransformBase *trf = (VariableTransformBase*) trIt()) {
+      if (rClsIt == fTransformationsReferenceClasses.end()) Log() << kFATAL<< "invalid read in TransformationHandler::TransformBatch " <<Endl;
+      trf->TransformBatch(values, nEvents, nVars, cls >= 0 ? cls : (*rClsIt));
+      ++rClsIt;
+   }
+}
+
 ////////////////////////////////////////////////////////////////////////////////
 
 const TMVA::Event* TMVA::TransformationHandler::InverseTransform( const Event* ev, Bool_t suppressIfNoTargets ) const
@@ -159,6 +159,32 @@ const TMVA::Event* TMVA::VariableNormalizeTransform::Transform( const TMVA::Even
    return fTransformedEvent;
 }
 
+////////////////////////////////////////////////////////////////////////////////
+/// thread-safe in-place normalization of the input variables of nEvents events,
+/// identical to Transform. The targets and spectators selected for the
+/// transformation are not available in the application, they are skipped.
+
+void TMVA::VariableNormalizeTransform::TransformBatch( Float_t* values, UInt_t nEvents, UInt_t nVars, Int_t cls ) const
+{
+   if (cls < 0 || cls >= (int) fMin.size()) cls = fMin.size()-1;
+   const FloatVector& minVector = fMin.at(cls);
+   const FloatVector& maxVector = fMax.at(cls);
+
+   std::vector<UInt_t>  index;
+   std::vector<Float_t> offset, scale;
+   for (UInt_t iidx=0; iidx<fGet.size(); iidx++) {
+      if (fGet[iidx].first != 'v') continue;
+      index.push_back(fGet[iidx].second);
+      offset.push_back(minVector.at(iidx));
+      scale.push_back(1.0/(maxVector.at(iidx)-minVector.at(iidx)));
+   }
+
+   for (UInt_t ievt=0; ievt<nEvents; ievt++) {
+      Float_t* x = values + (ULong64_t)ievt*nVars;
+      for (UInt_t i=0; i<index.size(); i++) x[index[i]] = (x[index[i]]-offset[i])*scale[i] * 2 - 1;
+   }
+}
+
 ////////////////////////////////////////////////////////////////////////////////
 /// apply the inverse transformation
 
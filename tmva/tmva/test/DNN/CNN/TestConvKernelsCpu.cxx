@@ -0,0 +1,220 @@
+// @(#)root/tmva/tmva/cnn:$Id$
+
+/**********************************************************************************
+ * Project: TMVA - a Root-integrated toolkit for multivariate data analysis       *
+ * Package: TMVA                                                                  *
+ * Class  :                                                                       *
+ * Web    : http://tmva.sourceforge.net                                           *
+ *                                                                                *
+ * Description:                                                                   *
+ *      Testing the blocked convolution kernels on a CPU architecture             *
+ *                                                                                *
+ * Copyright (c) 2005-2015:                                                       *
+ *      CERN, Switzerland                                                         *
+ *      U. of Victoria, Canada                                                    *
+ *      MPI-K Heidelberg, Germany                                                 *
+ *      U. of Bonn, Germany                                                       *
+ *                                                                                *
+ * Redistribution and use in source and binary forms, with or without             *
+ * modification, are permitted according to the terms listed in LICENSE           *
+ * (http://tmva.sourceforge.net/LICENSE)                                          *
+ **********************************************************************************/
+
+////////////////////////////////////////////////////////////////////
+// Testing ConvLayerForward and ConvLayerBackward, which process  //
+// the images by tiles of local views, against the reference      //
+// computation with the im2col matrix of the whole images         //
+////////////////////////////////////////////////////////////////////
+
+#include <algorithm>
+#include <iostream>
+#include <vector>
+
+#include "TROOT.h"
+#include "TMVA/Config.h"
+#include "TMVA/DNN/Architectures/Cpu.h"
+#include "../Utility.h"
+
+using namespace TMVA::DNN;
+using namespace TMVA::DNN::CNN;
+
+using Scalar_t = Double_t;
+using Architecture_t = TCpu<Scalar_t>;
+using Matrix_t = TCpuMatrix<Scalar_t>;
+
+namespace {
+
+// the kernels sum the products in a different order
+const Double_t kTolerance = 1e-10;
+
+// batch of random matrices
+std::vector<Matrix_t> makeRandomBatch(size_t batchSize, size_t nRows, size_t nCols)
+{
+   std::vector<Matrix_t> batch;
+   for (size_t i = 0; i < batchSize; i++) {
+      batch.emplace_back(nRows, nCols);
+      randomMatrix(batch.back());
+   }
+   return batch;
+}
+
+std::vector<Matrix_t> copyBatch(const std::vector<Matrix_t> &batch)
+{
+   std::vector<Matrix_t> copy;
+   for (const auto &x : batch) {
+      copy.emplace_back(x.GetNrows(), x.GetNcols());
+      copyMatrix(copy.back(), x);
+   }
+   return copy;
+}
+
+bool checkBatch(const std::vector<Matrix_t> &X, const std::vector<Matrix_t> &Y, const char *what)
+{
+   Double_t error = 0;
+   for (size_t i = 0; i < X.size(); i++) error = std::max(error, maximumRelativeError(X[i], Y[i]));
+   if (error > kTolerance) {
+      std::cerr << "ERROR - " << what << ": maximum relative error " << error << std::endl;
+      return false;
+   }
+   return true;
+}
+
+bool checkMatrix(const Matrix_t &X, const Matrix_t &Y, const char *what)
+{
+   Double_t error = maximumRelativeError(X, Y);
+   if (error > kTolerance) {
+      std::cerr << "ERROR - " << what << ": maximum relative error " << error << std::endl;
+      return false;
+   }
+   return true;
+}
+
+/** Forward propagation of the events through ConvLayerForward, compared with
+ *  the im2col matrix of the whole events multiplied with the weights. */
+bool testForward(const TConvParams &params)
+{
+   const size_t height = Architecture_t::calculateDimension(params.inputHeight, params.filterHeight,
+                                                            params.paddingHeight, params.strideRows);
+   const size_t width = Architecture_t::calculateDimension(params.inputWidth, params.filterWidth,
+                                                           params.paddingWidth, params.strideCols);
+   const size_t nLocalViews = height * width;
+   const size_t nLocalViewPixels = params.inputDepth * params.filterHeight * params.filterWidth;
+
+   std::vector<Matrix_t> input = makeRandomBatch(params.batchSize, params.inputDepth,
+                                                 params.inputHeight * params.inputWidth);
+   Matrix_t weights(params.numberFilters, nLocalViewPixels);
+   Matrix_t biases(params.numberFilters, 1);
+   randomMatrix(weights);
+   randomMatrix(biases);
+
+   std::vector<Matrix_t> output = makeRandomBatch(params.batchSize, params.numberFilters, nLocalViews);
+   std::vector<Matrix_t> derivatives = makeRandomBatch(params.batchSize, params.numberFilters, nLocalViews);
+   std::vector<Matrix_t> forwardMatrices;
+   Architecture_t::ConvLayerForward(output, derivatives, input, weights, biases, params,
+                                    EActivationFunction::kTanh, forwardMatrices);
+
+   Matrix_t::InitializeOneVector(nLocalViews);
+   std::vector<Matrix_t> expectedOutput = makeRandomBatch(params.batchSize, params.numberFilters, nLocalViews);
+   std::vector<Matrix_t> expectedDerivatives = makeRandomBatch(params.batchSize, params.numberFilters, nLocalViews);
+   for (size_t i = 0; i < params.batchSize; i++) {
+      Matrix_t inputTr(nLocalViews, nLocalViewPixels);
+      Architecture_t::Im2col(inputTr, input[i], params.inputHeight, params.inputWidth, params.filterHeight,
+                             params.filterWidth, params.strideRows, params.strideCols, params.paddingHeight,
+                             params.paddingWidth);
+      Architecture_t::MultiplyTranspose(expectedOutput[i], weights, inputTr);
+      Architecture_t::AddConvBiases(expectedOutput[i], biases);
+      evaluateDerivative<Architecture_t>(expectedDerivatives[i], EActivationFunction::kTanh, expectedOutput[i]);
+      evaluate<Architecture_t>(expectedOutput[i], EActivationFunction::kTanh);
+   }
+
+   return checkBatch(output, expectedOutput, "output") &&
+          checkBatch(derivatives, expectedDerivatives, "derivatives");
+}
+
+/** Backward propagation through ConvLayerBackward, compared with the
+ *  CalculateConv*Gradients functions. Only unit strides are supported. */
+bool testBackward(size_t batchSize, size_t inputDepth, size_t inputHeight, size_t inputWidth, size_t depth,
+                  size_t filterSize, size_t padding)
+{
+   const size_t height = Architecture_t::calculateDimension(inputHeight, filterSize, padding, 1);
+   const size_t width = Architecture_t::calculateDimension(inputWidth, filterSize, padding, 1);
+   const size_t nLocalViews = height * width;
+   const size_t nLocalViewPixels = inputDepth * filterSize * filterSize;
+
+   std::vector<Matrix_t> activationsBackward = makeRandomBatch(batchSize, inputDepth, inputHeight * inputWidth);
+   std::vector<Matrix_t> activationGradients = makeRandomBatch(batchSize, depth, nLocalViews);
+   std::vector<Matrix_t> df = makeRandomBatch(batchSize, depth, nLocalViews);
+   std::vector<Matrix_t> expectedDf = copyBatch(df);
+   Matrix_t weights(depth, nLocalViewPixels);
+   randomMatrix(weights);
+
+   std::vector<Matrix_t> activationGradientsBackward = makeRandomBatch(batchSize, inputDepth, inputHeight * inputWidth);
+   Matrix_t weightGradients(depth, nLocalViewPixels);
+   Matrix_t biasGradients(depth, 1);
+   Architecture_t::ConvLayerBackward(activationGradientsBackward, weightGradients, biasGradients, df,
+                                     activationGradients, weights, activationsBackward, batchSize, inputHeight,
+                                     inputWidth, depth, height, width, inputDepth, filterSize, filterSize, nLocalViews);
+
+   std::vector<Matrix_t> expectedActivationGradientsBackward =
+      makeRandomBatch(batchSize, inputDepth, inputHeight * inputWidth);
+   Matrix_t expectedWeightGradients(depth, nLocalViewPixels);
+   Matrix_t expectedBiasGradients(depth, 1);
+   for (size_t i = 0; i < batchSize; i++) Architecture_t::Hadamard(expectedDf[i], activationGradients[i]);
+   Architecture_t::CalculateConvActivationGradients(expectedActivationGradientsBackward, expectedDf, weights,
+                                                    batchSize, inputHeight, inputWidth, depth, height, width,
+                                                    inputDepth, filterSize, filterSize);
+   Architecture_t::CalculateConvWeightGradients(expectedWeightGradients, expectedDf, activationsBackward, batchSize,
+                                                inputHeight, inputWidth, depth, height, width, inputDepth, filterSize,
+                                                filterSize, nLocalViews);
+   Architecture_t::CalculateConvBiasGradients(expectedBiasGradients, expectedDf, batchSize, depth, nLocalViews);
+
+   return checkBatch(df, expectedDf, "df") &&
+          checkBatch(activationGradientsBackward, expectedActivationGradientsBackward, "activation gradients") &&
+          checkMatrix(weightGradients, expectedWeightGradients, "weight gradients") &&
+          checkMatrix(biasGradients, expectedBiasGradients, "bias gradients");
+}
+
+} // namespace
+
+int main()
+{
+   // the work is split according to the number of CPUs of the TMVA configuration
+   ROOT::EnableImplicitMT(4);
+   if (TMVA::Config::Instance().GetNCpu() != 4) {
+      std::cerr << "ERROR - cannot use 4 threads" << std::endl;
+      return -1;
+   }
+
+   std::cout << "Testing the blocked convolution kernels on the CPU:" << std::endl;
+
+   // 27 pixels per local view: a tile of 128 kB holds 606 local views,
+   // the 33 x 21 = 693 local views of the output make 2 tiles
+   std::cout << "Test Forward-Propagation with strides and padding: " << std::endl;
+   if (!testForward(TConvParams(3, 3, 65, 61, 5, 3, 3, 2, 3, 1, 1))) {
+      std::cerr << "ERROR - Forward-Propagation with strides and padding failed " << std::endl;
+      return -1;
+   }
+
+   // 1 event x 2 tiles for 4 CPUs: the 5 filters are split in 2 blocks
+   std::cout << "Test Forward-Propagation with blocks of filters: " << std::endl;
+   if (!testForward(TConvParams(1, 3, 65, 61, 5, 3, 3, 2, 3, 1, 1))) {
+      std::cerr << "ERROR - Forward-Propagation with blocks of filters failed " << std::endl;
+      return -1;
+   }
+
+   // 40 x 36 = 1440 local views in 3 tiles, 5 events in 3 chunks of 2 events
+   std::cout << "Test Backward-Propagation: " << std::endl;
+   if (!testBackward(5, 3, 40, 36, 4, 3, 1)) {
+      std::cerr << "ERROR - Backward-Propagation failed " << std::endl;
+      return -1;
+   }
+
+   // the output is smaller than the input
+   std::cout << "Test Backward-Propagation with a larger filter: " << std::endl;
+   if (!testBackward(5, 3, 40, 36, 4, 5, 1)) {
+      std::cerr << "ERROR - Backward-Propagation with a larger filter failed " << std::endl;
+      return -1;
+   }
+
+   std::cout << "All tests passed!" << std::endl;
+}
@@ -0,0 +1,94 @@
+// @(#)root/tmva/tmva/cnn:$Id$
+
+/*************************************************************************
+ * Copyright (C) 2018, CERN                                              *
+ * All rights reserved.                                                  *
+ *                                                                       *
+ * For the licensing terms see $ROOTSYS/LICENSE.                         *
+ * For the list of contributors see $ROOTSYS/README/CREDITS.             *
+ *************************************************************************/
+
+//////////////////////////////////////////////////////////////
+// Generic test of the quantized copy of a convolutional    //
+// network: its outputs are compared to the predictions of  //
+// the network.                                             //
+//////////////////////////////////////////////////////////////
+
+#ifndef TMVA_TEST_DNN_TEST_CNN_TEST_QUANTIZED_NET_H
+#define TMVA_TEST_DNN_TEST_CNN_TEST_QUANTIZED_NET_H
+
+#include "../Utility.h"
+
+#include "TMVA/DNN/DeepNet.h"
+#include "TMVA/DNN/QuantizedNet.h"
+
+using namespace TMVA::DNN;
+using namespace TMVA::DNN::CNN;
+
+/** Maximum difference between the softmax outputs of a network with
+ *  convolutional, pooling, reshape and dense layers and of its copy with the
+ *  given precision. */
+//______________________________________________________________________________
+template <typename Architecture_t>
+auto testQuantizedNet(EInferencePrecision precision) -> typename Architecture_t::Scalar_t
+{
+   using Scalar_t = typename Architecture_t::Scalar_t;
+   using Matrix_t = typename Architecture_t::Matrix_t;
+   using Net_t = TDeepNet<Architecture_t>;
+
+   size_t batchSize = 20;
+   size_t imgDepth = 3;
+   size_t imgHeight = 10;
+   size_t imgWidth = 9;
+
+   Net_t net(batchSize, imgDepth, imgHeight, imgWidth, batchSize, imgDepth, imgHeight * imgWidth,
+             ELossFunction::kMeanSquaredError, EInitialization::kGauss);
+   net.AddConvLayer(4, 3, 3, 1, 1, 1, 1, EActivationFunction::kRelu);
+   net.AddMaxPoolLayer(2, 2, 2, 2);
+   net.AddConvLayer(6, 3, 3, 2, 2, 0, 0, EActivationFunction::kTanh);
+   net.AddReshapeLayer(0, 0, 0, true);
+   net.AddDenseLayer(10, EActivationFunction::kSigmoid);
+   net.AddDenseLayer(3, EActivationFunction::kIdentity);
+   net.Initialize();
+   for (size_t l = 0; l < net.GetDepth(); l++) {
+      for (auto &biases : net.GetLayerAt(l)->GetBiases()) {
+         randomMatrix(biases, 0.0, 0.1);
+      }
+   }
+
+   std::vector<Matrix_t> X;
+   for (size_t i = 0; i < batchSize; i++) {
+      X.emplace_back(imgDepth, imgHeight * imgWidth);
+      randomMatrix(X[i]);
+   }
+   Matrix_t Y(batchSize, net.GetOutputWidth());
+   net.Prediction(Y, X, EOutputFunction::kSoftmax);
+
+   auto qnet = TQuantizedNet::Create(net, EOutputFunction::kSoftmax, precision);
+   if (!qnet || qnet->GetNInputs() != imgDepth * imgHeight * imgWidth || qnet->GetNOutputs() != 3) {
+      return 1.0;
+   }
+
+   // the inputs of an event are stored channel after channel
+   size_t nInputs = qnet->GetNInputs();
+   std::vector<Float_t> x(batchSize * nInputs);
+   for (size_t i = 0; i < batchSize; i++) {
+      for (size_t c = 0; c < imgDepth; c++) {
+         for (size_t p = 0; p < imgHeight * imgWidth; p++) {
+            x[i * nInputs + c * imgHeight * imgWidth + p] = X[i](c, p);
+         }
+      }
+   }
+   std::vector<Float_t> y(batchSize * 3);
+   qnet->Evaluate(x.data(), batchSize, y.data());
+
+   Scalar_t maximumError = 0.0;
+   for (size_t i = 0; i < batchSize; i++) {
+      for (size_t j = 0; j < 3; j++) {
+         maximumError = std::max(maximumError, std::abs(Scalar_t(y[i * 3 + j]) - Y(i, j)));
+      }
+   }
+   return maximumError;
+}
+
+#endif
@@ -0,0 +1,39 @@
+// @(#)root/tmva/tmva/cnn:$Id$
+
+/*************************************************************************
+ * Copyright (C) 2018, CERN                                              *
+ * All rights reserved.                                                  *
+ *                                                                       *
+ * For the licensing terms see $ROOTSYS/LICENSE.                         *
+ * For the list of contributors see $ROOTSYS/README/CREDITS.             *
+ *************************************************************************/
+
+////////////////////////////////////////////////////////////////////
+// Testing the quantized network against the CPU implementation. //
+////////////////////////////////////////////////////////////////////
+
+#include "TMVA/DNN/Architectures/Cpu.h"
+#include "TestQuantizedNet.h"
+
+#include <iostream>
+
+int main()
+{
+   using Scalar_t = Float_t;
+
+   std::cout << "Testing quantized network:" << std::endl;
+
+   Scalar_t error = testQuantizedNet<TCpu<Scalar_t>>(EInferencePrecision::kFloat);
+   std::cout << "Float:        Maximum absolute error = " << error << std::endl;
+   if (error > 1e-4) return 1;
+
+   error = testQuantizedNet<TCpu<Scalar_t>>(EInferencePrecision::kInt8);
+   std::cout << "Int8:         Maximum absolute error = " << error << std::endl;
+   if (error > 5e-2) return 1;
+
+   error = testQuantizedNet<TCpu<Scalar_t>>(EInferencePrecision::kInt8BF16);
+   std::cout << "Int8, BF16:   Maximum absolute error = " << error << std::endl;
+   if (error > 5e-2) return 1;
+
+   return 0;
+}
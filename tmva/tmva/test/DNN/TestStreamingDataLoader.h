@@ -0,0 +1,118 @@
+// @(#)root/tmva/tmva/dnn:$Id$
+
+/*************************************************************************
+ * Copyright (C) 2018, CERN                                              *
+ * All rights reserved.                                                  *
+ *                                                                       *
+ * For the licensing terms see $ROOTSYS/LICENSE.                         *
+ * For the list of contributors see $ROOTSYS/README/CREDITS.             *
+ *************************************************************************/
+
+////////////////////////////////////////////////////////////
+// Generic tests for the streaming data loader, reading a //
+// TTree in memory.                                       //
+////////////////////////////////////////////////////////////
+
+#include "TMVA/DNN/StreamingDataLoader.h"
+#include "TTree.h"
+
+#include <cmath>
+#include <memory>
+
+namespace TMVA
+{
+namespace DNN
+{
+
+/** Tree whose entry i holds x = i, y = 2 * i, label = i % 2 and w = i / 4. */
+//______________________________________________________________________________
+inline std::unique_ptr<TTree> createStreamingTree(Int_t nEntries)
+{
+   std::unique_ptr<TTree> tree(new TTree("streaming", "streaming"));
+   tree->SetDirectory(nullptr);
+   Float_t x, w;
+   Int_t y;
+   Double_t label;
+   tree->Branch("x", &x, "x/F");
+   tree->Branch("y", &y, "y/I");
+   tree->Branch("label", &label, "label/D");
+   tree->Branch("w", &w, "w/F");
+   for (Int_t i = 0; i < nEntries; i++) {
+      x = i;
+      y = 2 * i;
+      label = i % 2;
+      w = 0.25 * i;
+      tree->Fill();
+   }
+   return tree;
+}
+
+/** With a shuffle buffer of one event, the batches must hold the entries of the
+ *  tree in order, cycling over the tree, in the right columns. */
+//______________________________________________________________________________
+template <typename Architecture_t>
+auto testStreamingOrder()
+    -> typename Architecture_t::Scalar_t
+{
+   using Scalar_t = typename Architecture_t::Scalar_t;
+
+   Int_t nEntries = 1003;
+   auto tree = createStreamingTree(nEntries);
+   TTreeStreamingSource source(tree.get(), {"x", "y"}, {"label"}, "w");
+   TStreamingDataLoader<Architecture_t> loader(source, 10, 1, 64);
+
+   Scalar_t maximumError = 0.0;
+   size_t event = 0;
+   for (size_t epoch = 0; epoch < 3; epoch++) {
+      for (auto b : loader) {
+         for (size_t i = 0; i < 10; i++, event++) {
+            Scalar_t e = event % nEntries;
+            maximumError = std::max(maximumError, std::abs(b.GetInput()(i, 0) - e));
+            maximumError = std::max(maximumError, std::abs(b.GetInput()(i, 1) - 2 * e));
+            maximumError = std::max(maximumError, std::abs(b.GetOutput()(i, 0) - (Scalar_t)(event % nEntries % 2)));
+            maximumError = std::max(maximumError, std::abs(b.GetWeights()(i, 0) - Scalar_t(0.25) * e));
+         }
+      }
+   }
+   return maximumError;
+}
+
+/** With a shuffle buffer, the events of the batches must still be consistent,
+ *  and all the entries must be used. */
+//______________________________________________________________________________
+template <typename Architecture_t>
+auto testStreamingShuffle()
+    -> typename Architecture_t::Scalar_t
+{
+   using Scalar_t = typename Architecture_t::Scalar_t;
+
+   Int_t nEntries = 1000;
+   auto tree = createStreamingTree(nEntries);
+   TTreeStreamingSource source(tree.get(), {"x", "y"}, {"label"}, "w");
+   TStreamingDataLoader<Architecture_t> loader(source, 20, 100, 50);
+
+   Scalar_t maximumError = 0.0;
+   std::vector<int> seen(nEntries, 0);
+   size_t inOrder = 0;
+   for (size_t epoch = 0; epoch < 5; epoch++) {
+      for (auto b : loader) {
+         for (size_t i = 0; i < 20; i++) {
+            Scalar_t x = b.GetInput()(i, 0);
+            maximumError = std::max(maximumError, std::abs(b.GetInput()(i, 1) - 2 * x));
+            maximumError = std::max(maximumError, std::abs(b.GetOutput()(i, 0) - std::fmod(x, Scalar_t(2))));
+            maximumError = std::max(maximumError, std::abs(b.GetWeights()(i, 0) - Scalar_t(0.25) * x));
+            if (x >= 0 && x < nEntries) seen[(int)x] = 1;
+            if (i > 0 && x == b.GetInput()(i - 1, 0) + 1) inOrder++;
+         }
+      }
+   }
+   for (int s : seen) {
+      if (!s) maximumError = std::max(maximumError, Scalar_t(1));
+   }
+   // the events must have been shuffled
+   if (inOrder > 5 * 50 * 19 / 2) maximumError = std::max(maximumError, Scalar_t(1));
+   return maximumError;
+}
+
+} // namespace DNN
+} // namespace TMVA
@@ -0,0 +1,40 @@
+// @(#)root/tmva/tmva/dnn:$Id$
+
+/*************************************************************************
+ * Copyright (C) 2018, CERN                                              *
+ * All rights reserved.                                                  *
+ *                                                                       *
+ * For the licensing terms see $ROOTSYS/LICENSE.                         *
+ * For the list of contributors see $ROOTSYS/README/CREDITS.             *
+ *************************************************************************/
+
+/////////////////////////////////////////////////////////////////
+// Test the streaming data loader with the CPU implementation. //
+/////////////////////////////////////////////////////////////////
+
+#include "TMVA/DNN/Architectures/Cpu.h"
+#include "TestStreamingDataLoader.h"
+
+#include <iostream>
+
+using namespace TMVA::DNN;
+
+int main ()
+{
+   using Scalar_t = Real_t;
+
+   std::cout << "Testing streaming data loader:" << std::endl;
+
+   Scalar_t maximumError = 0.0;
+
+   Scalar_t error = testStreamingOrder<TCpu<Scalar_t>>();
+   std::cout << "Order:   Maximum absolute error = " << error << std::endl;
+   maximumError = std::max(error, maximumError);
+   error = testStreamingShuffle<TCpu<Scalar_t>>();
+   std::cout << "Shuffle: Maximum absolute error = " << error << std::endl;
+   maximumError = std::max(error, maximumError);
+
+   if (maximumError > 1e-3) {
+      return 1;
+   }
+}
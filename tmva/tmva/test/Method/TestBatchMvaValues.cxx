@@ -0,0 +1,175 @@
+// Tests of the batch evaluation of the methods (MethodBase::GetBatchMvaValues)
+// and of TMVA::ReaderModel against the event by event evaluation of the Reader
+
+#include "gtest/gtest.h"
+
+#include "TMVA/DataLoader.h"
+#include "TMVA/Factory.h"
+#include "TMVA/MethodBase.h"
+#include "TMVA/Reader.h"
+#include "TMVA/ReaderModel.h"
+#include "TMVA/Types.h"
+
+#include <algorithm>
+#include <cmath>
+#include <random>
+#include <thread>
+#include <vector>
+
+namespace {
+
+const UInt_t kNVars = 3;
+const UInt_t kNTrain = 1000;
+const UInt_t kNTest = 500;
+const char *kJobName = "TestBatchMvaValues";
+
+// signal and background in alternance, two correlated gaussians with different
+// means and scales for the variables, to make the normalisation non trivial
+std::vector<std::vector<Float_t>> Generate(UInt_t nEvents, UInt_t seed)
+{
+   std::mt19937 gen(seed);
+   std::normal_distribution<Float_t> gaus(0, 1);
+   std::vector<std::vector<Float_t>> events(nEvents, std::vector<Float_t>(kNVars));
+   for (UInt_t i = 0; i < nEvents; ++i) {
+      const Float_t mean = (i % 2 == 0) ? 0.7 : -0.7;
+      const Float_t common = gaus(gen);
+      for (UInt_t ivar = 0; ivar < kNVars; ++ivar)
+         events[i][ivar] = (ivar + 1) * (mean + 0.5 * common + gaus(gen)) + 10 * ivar;
+   }
+   return events;
+}
+
+TString WeightFile(const TString &methodName)
+{
+   return TString("dataset") + kJobName + "/weights/" + kJobName + "_" + methodName + ".weights.xml";
+}
+
+} // namespace
+
+class BatchMvaValues : public ::testing::Test {
+protected:
+   // the methods are trained once for all the tests
+   static void SetUpTestCase()
+   {
+      fTest = Generate(kNTest, 2);
+      for (const auto &x : fTest)
+         fInput.insert(fInput.end(), x.begin(), x.end());
+
+      const std::vector<std::vector<Float_t>> train = Generate(kNTrain, 1);
+      TMVA::Factory factory(kJobName, "Silent:!DrawProgressBar:AnalysisType=Classification");
+      TMVA::DataLoader loader(TString("dataset") + kJobName);
+      for (UInt_t ivar = 0; ivar < kNVars; ++ivar)
+         loader.AddVariable(Form("x%d", ivar), 'F');
+      for (UInt_t i = 0; i < kNTrain; ++i)
+         loader.AddEvent(i % 2 == 0 ? "Signal" : "Background", TMVA::Types::kTraining,
+                         std::vector<Double_t>(train[i].begin(), train[i].end()), 1.0);
+      for (UInt_t i = 0; i < kNTest; ++i)
+         loader.AddEvent(i % 2 == 0 ? "Signal" : "Background", TMVA::Types::kTesting,
+                         std::vector<Double_t>(fTest[i].begin(), fTest[i].end()), 1.0);
+      loader.PrepareTrainingAndTestTree("", "SplitMode=Block:NormMode=None:!V");
+
+      const std::vector<std::pair<TMVA::Types::EMVA, TString>> methods = {
+         {TMVA::Types::kBDT, "BDT:!H:!V:NTrees=30:MaxDepth=3:BoostType=AdaBoost"},
+         {TMVA::Types::kBDT, "BDTG:!H:!V:NTrees=30:MaxDepth=3:BoostType=Grad:Shrinkage=0.2"},
+         {TMVA::Types::kMLP, "MLP:!H:!V:NCycles=20:HiddenLayers=N+2:NeuronType=tanh"},
+         {TMVA::Types::kLikelihood, "Likelihood:!H:!V:NSmooth=1:NAvEvtPerBin=20"}};
+      for (const auto &method : methods) {
+         const TString name = method.second(0, method.second.Index(":"));
+         const TString options = method.second(method.second.Index(":") + 1, method.second.Length());
+         factory.BookMethod(&loader, method.first, name, options + ":VarTransform=None");
+         factory.BookMethod(&loader, method.first, name + "_N", options + ":VarTransform=N");
+      }
+      factory.BookMethod(&loader, TMVA::Types::kFisher, "Fisher", "!H:!V");
+      factory.TrainAllMethods();
+   }
+
+   BatchMvaValues() : fX(kNVars)
+   {
+      for (UInt_t ivar = 0; ivar < kNVars; ++ivar)
+         fReader.AddVariable(Form("x%d", ivar), &fX[ivar]);
+   }
+
+   // compare the batch evaluation of the method with EvaluateMVA, event by event
+   void ExpectSameAsReader(const TString &methodName)
+   {
+      fReader.BookMVA(methodName, WeightFile(methodName));
+      auto method = dynamic_cast<TMVA::MethodBase *>(fReader.FindMVA(methodName));
+      ASSERT_NE(method, nullptr);
+      ASSERT_TRUE(method->HasBatchMvaValues()) << methodName;
+
+      std::vector<Float_t> output(kNTest);
+      method->GetBatchMvaValues(fInput.data(), kNTest, output.data());
+      for (UInt_t i = 0; i < kNTest; ++i) {
+         const Double_t expected = fReader.EvaluateMVA(fTest[i], methodName);
+         EXPECT_NEAR(output[i], expected, 1e-5 * std::max(1., std::abs(expected)))
+            << methodName << ", event " << i;
+      }
+   }
+
+   // evaluate the model concurrently from several threads
+   void ExpectSameConcurrently(const TString &methodName, Bool_t native)
+   {
+      TMVA::ReaderModel model(WeightFile(methodName));
+      EXPECT_EQ(model.IsNative(), native) << methodName;
+
+      fReader.BookMVA(methodName, WeightFile(methodName));
+      std::vector<Float_t> reference(kNTest);
+      model.Compute(fInput.data(), kNTest, reference.data());
+      for (UInt_t i = 0; i < kNTest; ++i) {
+         const Double_t expected = fReader.EvaluateMVA(fTest[i], methodName);
+         EXPECT_NEAR(reference[i], expected, 1e-5 * std::max(1., std::abs(expected)))
+            << methodName << ", event " << i;
+      }
+
+      const UInt_t nThreads = 4;
+      std::vector<std::vector<Float_t>> outputs(nThreads, std::vector<Float_t>(kNTest));
+      std::vector<std::thread> threads;
+      for (UInt_t t = 0; t < nThreads; ++t) {
+         threads.emplace_back([&model, &outputs, t]() {
+            for (UInt_t repeat = 0; repeat < 10; ++repeat)
+               model.Compute(fInput.data(), kNTest, outputs[t].data());
+         });
+      }
+      for (auto &thread : threads)
+         thread.join();
+      for (UInt_t t = 0; t < nThreads; ++t)
+         EXPECT_EQ(outputs[t], reference) << methodName << ", thread " << t;
+   }
+
+   static std::vector<std::vector<Float_t>> fTest;
+   static std::vector<Float_t> fInput;
+   std::vector<Float_t> fX;
+   TMVA::Reader fReader{"!Color:Silent"};
+};
+
+std::vector<std::vector<Float_t>> BatchMvaValues::fTest;
+std::vector<Float_t> BatchMvaValues::fInput;
+
+TEST_F(BatchMvaValues, BDT)
+{
+   ExpectSameAsReader("BDT");
+   ExpectSameAsReader("BDT_N");
+   ExpectSameAsReader("BDTG");
+   ExpectSameAsReader("BDTG_N");
+}
+
+TEST_F(BatchMvaValues, MLP)
+{
+   ExpectSameAsReader("MLP");
+   ExpectSameAsReader("MLP_N");
+}
+
+TEST_F(BatchMvaValues, Likelihood)
+{
+   ExpectSameAsReader("Likelihood");
+   ExpectSameAsReader("Likelihood_N");
+}
+
+TEST_F(BatchMvaValues, ReaderModelConcurrent)
+{
+   ExpectSameConcurrently("BDTG_N", kTRUE);
+   ExpectSameConcurrently("MLP_N", kTRUE);
+   ExpectSameConcurrently("Likelihood", kTRUE);
+   // evaluated event by event under a lock
+   ExpectSameConcurrently("Fisher", kFALSE);
+}
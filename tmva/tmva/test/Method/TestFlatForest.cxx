@@ -0,0 +1,167 @@
+// Tests of the evaluation of BDTs compiled into a TMVA::FlatForest against MethodBDT
+
+#include "gtest/gtest.h"
+
+#include "TMVA/DataLoader.h"
+#include "TMVA/Factory.h"
+#include "TMVA/FlatForest.h"
+#include "TMVA/MethodBDT.h"
+#include "TMVA/Reader.h"
+#include "TMVA/Types.h"
+
+#include <random>
+#include <vector>
+
+namespace {
+
+const UInt_t kNVars = 3;
+const UInt_t kNTrain = 1000;
+const UInt_t kNTest = 500;
+
+// events of nClasses classes in alternance, gaussians centred at different
+// (correlated) positions for each class
+std::vector<std::vector<Float_t>> Generate(UInt_t nEvents, UInt_t nClasses, UInt_t seed)
+{
+   std::mt19937 gen(seed);
+   std::normal_distribution<Float_t> gaus(0, 1);
+   std::vector<std::vector<Float_t>> events(nEvents, std::vector<Float_t>(kNVars));
+   for (UInt_t i = 0; i < nEvents; ++i) {
+      const UInt_t cls = i % nClasses;
+      const Float_t common = gaus(gen);
+      for (UInt_t ivar = 0; ivar < kNVars; ++ivar)
+         events[i][ivar] = (ivar == cls % kNVars ? 1.5 : -0.5) + common + 0.5 * gaus(gen);
+   }
+   return events;
+}
+
+// train the BDTs booked by book, and write their weight files
+template <class F>
+void Train(const TString &jobName, const TString &analysisType, const std::vector<TString> &classNames,
+           const std::vector<std::vector<Float_t>> &train, const std::vector<std::vector<Float_t>> &test, F book)
+{
+   TMVA::Factory factory(jobName, "Silent:!DrawProgressBar:AnalysisType=" + analysisType);
+   TMVA::DataLoader loader("dataset" + jobName);
+   for (UInt_t ivar = 0; ivar < kNVars; ++ivar)
+      loader.AddVariable(Form("x%d", ivar), 'F');
+   for (UInt_t i = 0; i < train.size(); ++i)
+      loader.AddEvent(classNames[i % classNames.size()], TMVA::Types::kTraining,
+                      std::vector<Double_t>(train[i].begin(), train[i].end()), 1.0);
+   for (UInt_t i = 0; i < test.size(); ++i)
+      loader.AddEvent(classNames[i % classNames.size()], TMVA::Types::kTesting,
+                      std::vector<Double_t>(test[i].begin(), test[i].end()), 1.0);
+   loader.PrepareTrainingAndTestTree("", "SplitMode=Block:NormMode=None:!V");
+   book(factory, loader);
+   factory.TrainAllMethods();
+}
+
+} // namespace
+
+class FlatForestTest : public ::testing::Test {
+protected:
+   static void SetUpTestCase()
+   {
+      fTest = Generate(kNTest, 2, 2);
+      Train("TestFlatForest", "Classification", {"Signal", "Background"}, Generate(kNTrain, 2, 1), fTest,
+            [](TMVA::Factory &factory, TMVA::DataLoader &loader) {
+               const TString options = "!H:!V:NTrees=30:MaxDepth=3:nCuts=20";
+               factory.BookMethod(&loader, TMVA::Types::kBDT, "BDT", options + ":BoostType=AdaBoost");
+               factory.BookMethod(&loader, TMVA::Types::kBDT, "BDTG", options + ":BoostType=Grad:Shrinkage=0.2");
+               factory.BookMethod(&loader, TMVA::Types::kBDT, "BDTF",
+                                  options + ":BoostType=AdaBoost:UseFisherCuts:MinLinCorrForFisher=0");
+            });
+
+      fTestMulti = Generate(kNTest, 3, 4);
+      Train("TestFlatForestMulti", "Multiclass", {"A", "B", "C"}, Generate(kNTrain, 3, 3), fTestMulti,
+            [](TMVA::Factory &factory, TMVA::DataLoader &loader) {
+               factory.BookMethod(&loader, TMVA::Types::kBDT, "BDTG",
+                                  "!H:!V:NTrees=20:MaxDepth=3:nCuts=20:BoostType=Grad:Shrinkage=0.2");
+            });
+   }
+
+   FlatForestTest() : fX(kNVars)
+   {
+      for (UInt_t ivar = 0; ivar < kNVars; ++ivar)
+         fReader.AddVariable(Form("x%d", ivar), &fX[ivar]);
+   }
+
+   TMVA::MethodBDT *Book(const TString &jobName, const TString &methodName)
+   {
+      fReader.BookMVA(methodName, "dataset" + jobName + "/weights/" + jobName + "_" + methodName + ".weights.xml");
+      return dynamic_cast<TMVA::MethodBDT *>(fReader.FindMVA(methodName));
+   }
+
+   // compare the single event and batch evaluation of the forest with MethodBDT::GetMvaValue
+   void ExpectSameAsBDT(const TString &methodName)
+   {
+      TMVA::MethodBDT *bdt = Book("TestFlatForest", methodName);
+      ASSERT_NE(bdt, nullptr);
+      TMVA::FlatForest forest(*bdt);
+      ASSERT_TRUE(forest.IsValid());
+
+      std::vector<Float_t> input;
+      for (const auto &x : fTest)
+         input.insert(input.end(), x.begin(), x.end());
+      std::vector<Float_t> output(kNTest);
+      forest.Evaluate(input.data(), kNTest, output.data());
+
+      for (UInt_t i = 0; i < kNTest; ++i) {
+         const Double_t expected = fReader.EvaluateMVA(fTest[i], methodName);
+         EXPECT_DOUBLE_EQ(forest.Evaluate(fTest[i].data()), expected) << methodName << ", event " << i;
+         EXPECT_FLOAT_EQ(output[i], expected) << methodName << ", event " << i;
+      }
+   }
+
+   static std::vector<std::vector<Float_t>> fTest;
+   static std::vector<std::vector<Float_t>> fTestMulti;
+   std::vector<Float_t> fX;
+   TMVA::Reader fReader{"!Color:Silent"};
+};
+
+std::vector<std::vector<Float_t>> FlatForestTest::fTest;
+std::vector<std::vector<Float_t>> FlatForestTest::fTestMulti;
+
+TEST_F(FlatForestTest, AdaBoost)
+{
+   ExpectSameAsBDT("BDT");
+}
+
+TEST_F(FlatForestTest, Grad)
+{
+   ExpectSameAsBDT("BDTG");
+}
+
+TEST_F(FlatForestTest, Multiclass)
+{
+   TMVA::MethodBDT *bdt = Book("TestFlatForestMulti", "BDTG");
+   ASSERT_NE(bdt, nullptr);
+   TMVA::FlatForest forest(*bdt);
+   ASSERT_TRUE(forest.IsValid());
+   ASSERT_EQ(forest.GetNClasses(), 3u);
+
+   std::vector<Float_t> output(3);
+   for (UInt_t i = 0; i < kNTest; ++i) {
+      fX = fTestMulti[i];
+      const std::vector<Float_t> &expected = fReader.EvaluateMulticlass("BDTG");
+      ASSERT_EQ(expected.size(), 3u);
+      forest.EvaluateMulticlass(fTestMulti[i].data(), output.data());
+      for (UInt_t icls = 0; icls < 3; ++icls)
+         EXPECT_FLOAT_EQ(output[icls], expected[icls]) << "event " << i << ", class " << icls;
+   }
+}
+
+TEST_F(FlatForestTest, FisherCutsFallBack)
+{
+   // a forest with Fisher cuts cannot be compiled, the batch evaluation of
+   // the Reader falls back to the regular evaluation of the BDT
+   TMVA::MethodBDT *bdt = Book("TestFlatForest", "BDTF");
+   ASSERT_NE(bdt, nullptr);
+   EXPECT_FALSE(TMVA::FlatForest(*bdt).IsValid());
+
+   std::vector<Float_t> input;
+   for (const auto &x : fTest)
+      input.insert(input.end(), x.begin(), x.end());
+   std::vector<Float_t> output(kNTest);
+   fReader.EvaluateMVA("BDTF", input.data(), kNTest, output.data());
+   for (UInt_t i = 0; i < kNTest; ++i)
+      EXPECT_FLOAT_EQ(output[i], fReader.EvaluateMVA(fTest[i], "BDTF")) << "event " << i;
+}
@@ -0,0 +1,155 @@
+// Tests of the histogram-based growing of the trees of gradient boosted BDTs
+// (option UseHistTraining) against the exact growing of the trees
+
+#include "gtest/gtest.h"
+
+#include "TMVA/DataLoader.h"
+#include "TMVA/DecisionTree.h"
+#include "TMVA/DecisionTreeNode.h"
+#include "TMVA/Event.h"
+#include "TMVA/Factory.h"
+#include "TMVA/MethodBDT.h"
+#include "TMVA/ROCCurve.h"
+#include "TMVA/Reader.h"
+#include "TMVA/Types.h"
+
+#include <algorithm>
+#include <memory>
+#include <random>
+#include <vector>
+
+namespace {
+
+const UInt_t kNVars = 3;
+const UInt_t kNTrain = 2000;
+const UInt_t kNTest = 2000;
+const Int_t kNCuts = 63;
+
+// signal and background in alternance: two gaussians centred at +-0.8 in all variables
+std::vector<std::vector<Float_t>> Generate(UInt_t nEvents, UInt_t seed)
+{
+   std::mt19937 gen(seed);
+   std::normal_distribution<Float_t> gaus(0, 1);
+   std::vector<std::vector<Float_t>> events(nEvents, std::vector<Float_t>(kNVars));
+   for (UInt_t i = 0; i < nEvents; ++i) {
+      const Float_t mean = (i % 2 == 0) ? 0.8 : -0.8;
+      for (UInt_t ivar = 0; ivar < kNVars; ++ivar)
+         events[i][ivar] = mean + gaus(gen);
+   }
+   return events;
+}
+
+Bool_t IsSignal(UInt_t i)
+{
+   return i % 2 == 0;
+}
+
+// collect the cuts of the intermediate nodes
+void CollectCuts(const TMVA::DecisionTreeNode *node, std::vector<std::pair<UInt_t, Float_t>> &cuts)
+{
+   if (!node || node->GetNodeType() != 0)
+      return;
+   cuts.emplace_back(node->GetSelector(), node->GetCutValue());
+   CollectCuts(static_cast<const TMVA::DecisionTreeNode *>(node->GetLeft()), cuts);
+   CollectCuts(static_cast<const TMVA::DecisionTreeNode *>(node->GetRight()), cuts);
+}
+
+} // namespace
+
+class BDTHistTraining : public ::testing::Test {
+protected:
+   // the BDTs are trained once for all the tests
+   static void SetUpTestCase()
+   {
+      fTrain = Generate(kNTrain, 1);
+      fTest = Generate(kNTest, 2);
+      fFactory = new TMVA::Factory("TestBDTHistTraining", "Silent:!DrawProgressBar:AnalysisType=Classification");
+      fLoader = new TMVA::DataLoader("datasetBDTHist");
+      for (UInt_t ivar = 0; ivar < kNVars; ++ivar)
+         fLoader->AddVariable(Form("x%d", ivar), 'F');
+      for (UInt_t i = 0; i < kNTrain; ++i)
+         fLoader->AddEvent(IsSignal(i) ? "Signal" : "Background", TMVA::Types::kTraining,
+                           std::vector<Double_t>(fTrain[i].begin(), fTrain[i].end()), 1.0);
+      for (UInt_t i = 0; i < kNTest; ++i)
+         fLoader->AddEvent(IsSignal(i) ? "Signal" : "Background", TMVA::Types::kTesting,
+                           std::vector<Double_t>(fTest[i].begin(), fTest[i].end()), 1.0);
+      fLoader->PrepareTrainingAndTestTree("", "SplitMode=Block:NormMode=None:!V");
+
+      const TString options = "!H:!V:NTrees=50:BoostType=Grad:Shrinkage=0.2:MaxDepth=3:MinNodeSize=2.5%";
+      fFactory->BookMethod(fLoader, TMVA::Types::kBDT, "BDTG", options + ":nCuts=-1");
+      fFactory->BookMethod(fLoader, TMVA::Types::kBDT, "BDTGHist", options + Form(":nCuts=%d:UseHistTraining", kNCuts));
+      fFactory->TrainAllMethods();
+   }
+
+   static void TearDownTestCase()
+   {
+      delete fFactory;
+      delete fLoader;
+   }
+
+   // ROC integral of the method on the test events
+   static Double_t GetROCIntegral(const TString &methodName)
+   {
+      TMVA::Reader reader("!Color:Silent");
+      std::vector<Float_t> x(kNVars);
+      for (UInt_t ivar = 0; ivar < kNVars; ++ivar)
+         reader.AddVariable(Form("x%d", ivar), &x[ivar]);
+      reader.BookMVA(methodName, "datasetBDTHist/weights/TestBDTHistTraining_" + methodName + ".weights.xml");
+
+      std::vector<Float_t> mvaValues(kNTest);
+      std::vector<Bool_t> targets(kNTest);
+      for (UInt_t i = 0; i < kNTest; ++i) {
+         mvaValues[i] = reader.EvaluateMVA(fTest[i], methodName);
+         targets[i] = IsSignal(i);
+      }
+      return TMVA::ROCCurve(mvaValues, targets).GetROCIntegral();
+   }
+
+   static std::vector<std::vector<Float_t>> fTrain;
+   static std::vector<std::vector<Float_t>> fTest;
+   static TMVA::Factory *fFactory;
+   static TMVA::DataLoader *fLoader;
+};
+
+std::vector<std::vector<Float_t>> BDTHistTraining::fTrain;
+std::vector<std::vector<Float_t>> BDTHistTraining::fTest;
+TMVA::Factory *BDTHistTraining::fFactory = nullptr;
+TMVA::DataLoader *BDTHistTraining::fLoader = nullptr;
+
+TEST_F(BDTHistTraining, Separation)
+{
+   const Double_t rocExact = GetROCIntegral("BDTG");
+   const Double_t rocHist = GetROCIntegral("BDTGHist");
+   EXPECT_GT(rocExact, 0.9);
+   EXPECT_NEAR(rocHist, rocExact, 0.01);
+}
+
+TEST_F(BDTHistTraining, CutsOnBinEdges)
+{
+   // the same binning as in the training
+   std::vector<std::unique_ptr<TMVA::Event>> events;
+   TMVA::DecisionTree::EventConstList eventList;
+   for (UInt_t i = 0; i < kNTrain; ++i) {
+      events.emplace_back(new TMVA::Event(fTrain[i], IsSignal(i) ? 0 : 1));
+      eventList.push_back(events.back().get());
+   }
+   TMVA::DecisionTree::BinnedSample binned;
+   binned.Fill(eventList, kNVars, kNCuts + 1);
+
+   auto bdt = dynamic_cast<TMVA::MethodBDT *>(fFactory->GetMethod("datasetBDTHist", "BDTGHist"));
+   ASSERT_NE(bdt, nullptr);
+   ASSERT_FALSE(bdt->GetForest().empty());
+   UInt_t nCuts = 0;
+   for (const TMVA::DecisionTree *tree : bdt->GetForest()) {
+      std::vector<std::pair<UInt_t, Float_t>> cuts;
+      CollectCuts(static_cast<const TMVA::DecisionTreeNode *>(tree->GetRoot()), cuts);
+      for (const auto &cut : cuts) {
+         ASSERT_LT(cut.first, kNVars);
+         const std::vector<Float_t> &edges = binned.fCuts[cut.first];
+         EXPECT_NE(std::find(edges.begin(), edges.end(), cut.second), edges.end())
+            << "cut " << cut.second << " on x" << cut.first << " is not a bin edge";
+      }
+      nCuts += cuts.size();
+   }
+   EXPECT_GT(nCuts, 0u);
+}